@@ -17,6 +17,7 @@
 #define LIBDIVIDE_VERSION_MINOR 3
 #define LIBDIVIDE_VERSION_PATCH 0
 
+#include <stddef.h>
 #include <stdint.h>
 
 #if !defined(__AVR__) && __STDC_HOSTED__ != 0
@@ -32,14 +33,84 @@
 #endif
 #endif
 
-#if defined(LIBDIVIDE_SSE2)
+// LIBDIVIDE_RUNTIME_DISPATCH compiles all x86 vector kernels using function
+// specific target options, independent of the compiler flags, and lets the
+// bulk (array) functions pick the widest kernel supported by the CPU at
+// runtime. This requires GCC or Clang.
+#if defined(LIBDIVIDE_RUNTIME_DISPATCH) && (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define LIBDIVIDE_X86_DISPATCH
+#endif
+
+#if defined(LIBDIVIDE_SSE2) && !defined(LIBDIVIDE_X86_DISPATCH)
 #include <emmintrin.h>
 #endif
 
-#if defined(LIBDIVIDE_AVX2) || defined(LIBDIVIDE_AVX512)
+#if defined(LIBDIVIDE_AVX2) || defined(LIBDIVIDE_AVX512) || defined(LIBDIVIDE_X86_DISPATCH)
 #include <immintrin.h>
 #endif
 
+// The vector kernels are compiled if the instruction set is enabled at
+// compile time or if runtime dispatch is used. The C++ vector overloads
+// of divider::divide() still require LIBDIVIDE_SSE2/AVX2/AVX512, only
+// those guarantee that the caller has been compiled for the same target.
+#if defined(LIBDIVIDE_SSE2) || defined(LIBDIVIDE_X86_DISPATCH)
+#define LIBDIVIDE_SSE2_KERNELS
+#endif
+
+#if defined(LIBDIVIDE_AVX2) || defined(LIBDIVIDE_X86_DISPATCH)
+#define LIBDIVIDE_AVX2_KERNELS
+#endif
+
+#if defined(LIBDIVIDE_AVX512) || defined(LIBDIVIDE_X86_DISPATCH)
+#define LIBDIVIDE_AVX512_KERNELS
+#endif
+
+// Enable the instruction set for all functions between PUSH and POP, unless
+// it is already enabled at compile time.
+#if defined(LIBDIVIDE_X86_DISPATCH) && !defined(LIBDIVIDE_SSE2)
+#if defined(__clang__)
+#define LIBDIVIDE_SSE2_TARGET_PUSH \
+    _Pragma("clang attribute push(__attribute__((target(\"sse2\"))), apply_to = function)")
+#define LIBDIVIDE_SSE2_TARGET_POP _Pragma("clang attribute pop")
+#else
+#define LIBDIVIDE_SSE2_TARGET_PUSH _Pragma("GCC push_options") _Pragma("GCC target(\"sse2\")")
+#define LIBDIVIDE_SSE2_TARGET_POP _Pragma("GCC pop_options")
+#endif
+#else
+#define LIBDIVIDE_SSE2_TARGET_PUSH
+#define LIBDIVIDE_SSE2_TARGET_POP
+#endif
+
+#if defined(LIBDIVIDE_X86_DISPATCH) && !defined(LIBDIVIDE_AVX2)
+#if defined(__clang__)
+#define LIBDIVIDE_AVX2_TARGET_PUSH \
+    _Pragma("clang attribute push(__attribute__((target(\"avx2\"))), apply_to = function)")
+#define LIBDIVIDE_AVX2_TARGET_POP _Pragma("clang attribute pop")
+#else
+#define LIBDIVIDE_AVX2_TARGET_PUSH _Pragma("GCC push_options") _Pragma("GCC target(\"avx2\")")
+#define LIBDIVIDE_AVX2_TARGET_POP _Pragma("GCC pop_options")
+#endif
+#else
+#define LIBDIVIDE_AVX2_TARGET_PUSH
+#define LIBDIVIDE_AVX2_TARGET_POP
+#endif
+
+#if defined(LIBDIVIDE_X86_DISPATCH) && !defined(LIBDIVIDE_AVX512)
+#if defined(__clang__)
+#define LIBDIVIDE_AVX512_TARGET_PUSH \
+    _Pragma("clang attribute push(__attribute__((target(\"avx512f\"))), apply_to = function)")
+#define LIBDIVIDE_AVX512_TARGET_POP _Pragma("clang attribute pop")
+#else
+#define LIBDIVIDE_AVX512_TARGET_PUSH \
+    _Pragma("GCC push_options") _Pragma("GCC target(\"avx512f\")")
+#define LIBDIVIDE_AVX512_TARGET_POP _Pragma("GCC pop_options")
+#endif
+#else
+#define LIBDIVIDE_AVX512_TARGET_PUSH
+#define LIBDIVIDE_AVX512_TARGET_POP
+#endif
+
 #if defined(LIBDIVIDE_NEON)
 #include <arm_neon.h>
 #endif
@@ -209,6 +280,16 @@ static LIBDIVIDE_CONSTEXPR_INLINE int __builtin_clzll(unsigned long long x) {
 // by up to 10% because of reduced memory bandwidth.
 #pragma pack(push, 1)
 
+struct libdivide_u8_t {
+    uint8_t magic;
+    uint8_t more;
+};
+
+struct libdivide_s8_t {
+    int8_t magic;
+    uint8_t more;
+};
+
 struct libdivide_u16_t {
     uint16_t magic;
     uint8_t more;
@@ -239,6 +320,16 @@ struct libdivide_s64_t {
     uint8_t more;
 };
 
+struct libdivide_u8_branchfree_t {
+    uint8_t magic;
+    uint8_t more;
+};
+
+struct libdivide_s8_branchfree_t {
+    int8_t magic;
+    uint8_t more;
+};
+
 struct libdivide_u16_branchfree_t {
     uint16_t magic;
     uint8_t more;
@@ -269,6 +360,283 @@ struct libdivide_s64_branchfree_t {
     uint8_t more;
 };
 
+#if defined(HAS_INT128_T)
+// 128-bit shifts need 7 bits, so "more" is 16 bits wide, see below.
+struct libdivide_u128_t {
+    __uint128_t magic;
+    uint16_t more;
+};
+
+struct libdivide_s128_t {
+    __int128_t magic;
+    uint16_t more;
+};
+
+struct libdivide_u128_branchfree_t {
+    __uint128_t magic;
+    uint16_t more;
+};
+
+struct libdivide_s128_branchfree_t {
+    __int128_t magic;
+    uint16_t more;
+};
+#endif
+
+// fastmod dividers compute remainders directly from the fractional part of
+// n * magic, with magic = ceil(2^64 / d). d is the absolute value of the
+// divisor for s32.
+struct libdivide_u32_fastmod_t {
+    uint64_t magic;
+    uint32_t d;
+};
+
+struct libdivide_s32_fastmod_t {
+    uint64_t magic;
+    uint32_t d;
+};
+
+// exact dividers only divide multiples of the divisor d = d_odd << shift,
+// inverse is the multiplicative inverse of d_odd modulo 2^w.
+struct libdivide_u16_exact_t {
+    uint16_t inverse;
+    uint8_t shift;
+};
+
+struct libdivide_s16_exact_t {
+    int16_t inverse;
+    uint8_t shift;
+};
+
+struct libdivide_u32_exact_t {
+    uint32_t inverse;
+    uint8_t shift;
+};
+
+struct libdivide_s32_exact_t {
+    int32_t inverse;
+    uint8_t shift;
+};
+
+struct libdivide_u64_exact_t {
+    uint64_t inverse;
+    uint8_t shift;
+};
+
+struct libdivide_s64_exact_t {
+    int64_t inverse;
+    uint8_t shift;
+};
+
+// Rounding dividers store the unsigned magic number of the absolute value
+// of the divisor, round holds the LIBDIVIDE_ROUND_* bits below.
+struct libdivide_u16_round_t {
+    uint16_t magic;
+    uint8_t more;
+    uint8_t round;
+};
+
+struct libdivide_s16_round_t {
+    uint16_t magic;
+    uint8_t more;
+    uint8_t round;
+};
+
+struct libdivide_u32_round_t {
+    uint32_t magic;
+    uint8_t more;
+    uint8_t round;
+};
+
+struct libdivide_s32_round_t {
+    uint32_t magic;
+    uint8_t more;
+    uint8_t round;
+};
+
+struct libdivide_u64_round_t {
+    uint64_t magic;
+    uint8_t more;
+    uint8_t round;
+};
+
+struct libdivide_s64_round_t {
+    uint64_t magic;
+    uint8_t more;
+    uint8_t round;
+};
+
+struct libdivide_u16_round_branchfree_t {
+    uint16_t magic;
+    uint8_t more;
+    uint8_t round;
+};
+
+struct libdivide_s16_round_branchfree_t {
+    uint16_t magic;
+    uint8_t more;
+    uint8_t round;
+};
+
+struct libdivide_u32_round_branchfree_t {
+    uint32_t magic;
+    uint8_t more;
+    uint8_t round;
+};
+
+struct libdivide_s32_round_branchfree_t {
+    uint32_t magic;
+    uint8_t more;
+    uint8_t round;
+};
+
+struct libdivide_u64_round_branchfree_t {
+    uint64_t magic;
+    uint8_t more;
+    uint8_t round;
+};
+
+struct libdivide_s64_round_branchfree_t {
+    uint64_t magic;
+    uint8_t more;
+    uint8_t round;
+};
+
+// Divides 128-bit numerators {numhi, numlo} with numhi < d by a 64-bit d:
+// d is normalized (shifted left until its high bit is set) and reciprocal
+// is floor((2^128 - 1) / (d << shift)) - 2^64.
+struct libdivide_u128_u64_t {
+    uint64_t d;
+    uint64_t reciprocal;
+    uint8_t shift;
+};
+
+// muldiv dividers compute a * b / c from the 128-bit product of a and b,
+// denom is the 128-by-64 divider by |c|. round holds the LIBDIVIDE_MULDIV_*
+// bits below.
+struct libdivide_u64_muldiv_t {
+    struct libdivide_u128_u64_t denom;
+    uint8_t round;
+};
+
+struct libdivide_s64_muldiv_t {
+    struct libdivide_u128_u64_t denom;
+    uint8_t round;
+};
+
+// Scalers compute x * num / den for a fixed fraction num / den: whole is
+// num / den, the rest (x * (num % den) + bias) / den is computed as
+// (x * magic + offset) >> (w + shift) with double width magic and offset,
+// see RATIONAL SCALING. saturate is 1 if quotients that don't fit are
+// clamped to the maximum instead of wrapping.
+struct libdivide_u32_scaler_t {
+    uint64_t magic;
+    uint64_t offset;
+    uint32_t whole;
+    uint8_t shift;
+    uint8_t saturate;
+};
+
+struct libdivide_u64_scaler_t {
+    uint64_t magic_lo;
+    uint64_t magic_hi;
+    uint64_t offset_lo;
+    uint64_t offset_hi;
+    uint64_t whole;
+    uint8_t shift;
+    uint8_t saturate;
+};
+
+// Fixed-point dividers compute the Q-format quotients (n << k) / d modulo
+// 2^w of w-bit numerators: magic is ceil(2^(2w + k) / d) modulo 2^3w,
+// split into w-bit words for u32 and u64, see FIXED POINT DIVISION.
+struct libdivide_u16_fixed_t {
+    uint64_t magic;
+};
+
+struct libdivide_u32_fixed_t {
+    uint64_t magic_lo;
+    uint32_t magic_hi;
+};
+
+struct libdivide_u64_fixed_t {
+    uint64_t magic_lo;
+    uint64_t magic_mid;
+    uint64_t magic_hi;
+};
+
+// Reducers compute remainders modulo m of double width numbers, e.g. the
+// products of modular multiplications. For u32 barrett is
+// floor((2^64 - 1) / m), u64 divides by m using the reciprocal of
+// libdivide_u128_u64_gen(). If m is odd, inverse is m^-1 modulo 2^w and r2
+// is 2^(2w) mod m, the constants of Montgomery multiplication, otherwise
+// they are 0.
+struct libdivide_u32_reducer_t {
+    uint64_t barrett;
+    uint32_t m;
+    uint32_t inverse;
+    uint32_t r2;
+};
+
+struct libdivide_u64_reducer_t {
+    struct libdivide_u128_u64_t barrett;
+    uint64_t m;
+    uint64_t inverse;
+    uint64_t r2;
+};
+
+// fp dividers hold the reciprocal of d rounded up by a small margin, in
+// float precision for 16-bit and in double precision for 32-bit integers,
+// see FLOATING POINT RECIPROCAL below.
+struct libdivide_u16_fp_t {
+    float recip;
+};
+
+struct libdivide_s16_fp_t {
+    float recip;
+};
+
+struct libdivide_u32_fp_t {
+    double recip;
+};
+
+struct libdivide_s32_fp_t {
+    double recip;
+};
+
+// Dictionaries of up to 16 branchfree dividers that are selected per
+// element by a code, for columns of divisors with few distinct values.
+// The magic numbers and the more fields are stored in separate arrays that
+// the vector kernels keep in registers. The 16-bit dictionaries hold 32-bit
+// dividers, their numerators are divided as 32-bit integers.
+struct libdivide_u32_branchfree_dict_t {
+    uint32_t magic[16];
+    uint8_t more[16];
+};
+
+struct libdivide_s32_branchfree_dict_t {
+    int32_t magic[16];
+    uint8_t more[16];
+};
+
+struct libdivide_u64_branchfree_dict_t {
+    uint64_t magic[16];
+    uint8_t more[16];
+};
+
+struct libdivide_s64_branchfree_dict_t {
+    int64_t magic[16];
+    uint8_t more[16];
+};
+
+struct libdivide_u16_branchfree_dict_t {
+    struct libdivide_u32_branchfree_dict_t wide;
+};
+
+struct libdivide_s16_branchfree_dict_t {
+    struct libdivide_s32_branchfree_dict_t wide;
+};
+
 #pragma pack(pop)
 
 // Explanation of the "more" field:
@@ -280,6 +648,17 @@ struct libdivide_s64_branchfree_t {
 //   create a bitmask with all bits set to 1 (if the divisor is negative)
 //   or 0 (if the divisor is positive).
 //
+// u8:  [0-2] shift value
+//      [3-5] ignored
+//      [6] add indicator
+//      magic number of 0 indicates shift path
+//
+// s8:  [0-2] shift value
+//      [3-5] ignored
+//      [6] add indicator
+//      [7] indicates negative divisor
+//      magic number of 0 indicates shift path
+//
 // u32: [0-4] shift value
 //      [5] ignored
 //      [6] add indicator
@@ -293,6 +672,8 @@ struct libdivide_s64_branchfree_t {
 //
 // u64: [0-5] shift value
 //      [6] add indicator
+//      [7] indicates narrow numerators, only set by libdivide_u64_gen_bounded():
+//          all numerators are < 2^32 and magic is m * 2^32 with a 32-bit m
 //      magic number of 0 indicates shift path
 //
 // s64: [0-5] shift value
@@ -300,17 +681,70 @@ struct libdivide_s64_branchfree_t {
 //      [7] indicates negative divisor
 //      magic number of 0 indicates shift path
 //
+// u128: [0-6] shift value
+//       [7] add indicator
+//       magic number of 0 indicates shift path
+//
+// s128: [0-6] shift value
+//       [7] add indicator
+//       [8] indicates negative divisor
+//       magic number of 0 indicates shift path
+//
 // In s32 and s64 branchfree modes, the magic number is negated according to
 // whether the divisor is negated. In branchfree strategy, it is not negated.
 
 enum {
+    LIBDIVIDE_8_SHIFT_MASK = 0x07,
     LIBDIVIDE_16_SHIFT_MASK = 0x1F,
     LIBDIVIDE_32_SHIFT_MASK = 0x1F,
     LIBDIVIDE_64_SHIFT_MASK = 0x3F,
     LIBDIVIDE_ADD_MARKER = 0x40,
-    LIBDIVIDE_NEGATIVE_DIVISOR = 0x80
+    LIBDIVIDE_NEGATIVE_DIVISOR = 0x80,
+    LIBDIVIDE_NARROW_MARKER = 0x80
+};
+
+enum {
+    LIBDIVIDE_128_SHIFT_MASK = 0x7F,
+    LIBDIVIDE_128_ADD_MARKER = 0x80,
+    LIBDIVIDE_128_NEGATIVE_DIVISOR = 0x100
+};
+
+// Rounding modes of the libdivide_*_round_t dividers. For unsigned
+// integers floor and Euclidean division are the same as truncation.
+enum libdivide_rounding {
+    LIBDIVIDE_ROUND_FLOOR,   // toward -infinity
+    LIBDIVIDE_ROUND_CEIL,    // toward +infinity
+    LIBDIVIDE_ROUND_EUCLID,  // such that the remainder is >= 0
+    LIBDIVIDE_ROUND_NEAREST  // halfway cases away from zero, muldiv and scalers only
+};
+
+// Explanation of the "round" field of the rounding dividers:
+//
+// * Bit 0 (BIAS): subtract 1 from the numerators before the division.
+// * Bit 1 (INCREMENT): add 1 to the quotients.
+// * Bit 7 is set if the divisor is negative, like in the "more" field.
+enum {
+    LIBDIVIDE_ROUND_BIAS = 0x01,
+    LIBDIVIDE_ROUND_INCREMENT = 0x02
+};
+
+// Explanation of the "round" field of the muldiv dividers, the magnitude of
+// the truncated quotient is incremented:
+//
+// * Bit 0 (UP_NEGATIVE): if the remainder is nonzero and the quotient is
+//   negative.
+// * Bit 1 (UP_POSITIVE): if the remainder is nonzero and the quotient is
+//   positive.
+// * Bit 2 (NEAREST): if the remainder is at least half of |c|.
+// * Bit 7 is set if c is negative, like in the "more" field.
+enum {
+    LIBDIVIDE_MULDIV_UP_NEGATIVE = 0x01,
+    LIBDIVIDE_MULDIV_UP_POSITIVE = 0x02,
+    LIBDIVIDE_MULDIV_NEAREST = 0x04
 };
 
+static LIBDIVIDE_INLINE struct libdivide_s8_t libdivide_s8_gen(int8_t d);
+static LIBDIVIDE_INLINE struct libdivide_u8_t libdivide_u8_gen(uint8_t d);
 static LIBDIVIDE_INLINE struct libdivide_s16_t libdivide_s16_gen(int16_t d);
 static LIBDIVIDE_INLINE struct libdivide_u16_t libdivide_u16_gen(uint16_t d);
 static LIBDIVIDE_INLINE struct libdivide_s32_t libdivide_s32_gen(int32_t d);
@@ -318,6 +752,16 @@ static LIBDIVIDE_INLINE struct libdivide_u32_t libdivide_u32_gen(uint32_t d);
 static LIBDIVIDE_INLINE struct libdivide_s64_t libdivide_s64_gen(int64_t d);
 static LIBDIVIDE_INLINE struct libdivide_u64_t libdivide_u64_gen(uint64_t d);
 
+// Dividers for numerators <= max_numer, see libdivide_u32_gen_bounded()
+static LIBDIVIDE_INLINE struct libdivide_u16_t libdivide_u16_gen_bounded(
+    uint16_t d, uint16_t max_numer);
+static LIBDIVIDE_INLINE struct libdivide_u32_t libdivide_u32_gen_bounded(
+    uint32_t d, uint32_t max_numer);
+static LIBDIVIDE_INLINE struct libdivide_u64_t libdivide_u64_gen_bounded(
+    uint64_t d, uint64_t max_numer);
+
+static LIBDIVIDE_INLINE struct libdivide_s8_branchfree_t libdivide_s8_branchfree_gen(int8_t d);
+static LIBDIVIDE_INLINE struct libdivide_u8_branchfree_t libdivide_u8_branchfree_gen(uint8_t d);
 static LIBDIVIDE_INLINE struct libdivide_s16_branchfree_t libdivide_s16_branchfree_gen(int16_t d);
 static LIBDIVIDE_INLINE struct libdivide_u16_branchfree_t libdivide_u16_branchfree_gen(uint16_t d);
 static LIBDIVIDE_INLINE struct libdivide_s32_branchfree_t libdivide_s32_branchfree_gen(int32_t d);
@@ -325,6 +769,14 @@ static LIBDIVIDE_INLINE struct libdivide_u32_branchfree_t libdivide_u32_branchfr
 static LIBDIVIDE_INLINE struct libdivide_s64_branchfree_t libdivide_s64_branchfree_gen(int64_t d);
 static LIBDIVIDE_INLINE struct libdivide_u64_branchfree_t libdivide_u64_branchfree_gen(uint64_t d);
 
+static LIBDIVIDE_INLINE int8_t libdivide_s8_do_raw(
+    int8_t numer, int8_t magic, uint8_t more);
+static LIBDIVIDE_INLINE int8_t libdivide_s8_do(
+    int8_t numer, const struct libdivide_s8_t *denom);
+static LIBDIVIDE_INLINE uint8_t libdivide_u8_do_raw(
+    uint8_t numer, uint8_t magic, uint8_t more);
+static LIBDIVIDE_INLINE uint8_t libdivide_u8_do(
+    uint8_t numer, const struct libdivide_u8_t *denom);
 static LIBDIVIDE_INLINE int16_t libdivide_s16_do_raw(
     int16_t numer, int16_t magic, uint8_t more);
 static LIBDIVIDE_INLINE int16_t libdivide_s16_do(
@@ -350,6 +802,10 @@ static LIBDIVIDE_INLINE uint64_t libdivide_u64_do_raw(
 static LIBDIVIDE_INLINE uint64_t libdivide_u64_do(
     uint64_t numer, const struct libdivide_u64_t *denom);
 
+static LIBDIVIDE_INLINE int8_t libdivide_s8_branchfree_do(
+    int8_t numer, const struct libdivide_s8_branchfree_t *denom);
+static LIBDIVIDE_INLINE uint8_t libdivide_u8_branchfree_do(
+    uint8_t numer, const struct libdivide_u8_branchfree_t *denom);
 static LIBDIVIDE_INLINE int16_t libdivide_s16_branchfree_do(
     int16_t numer, const struct libdivide_s16_branchfree_t *denom);
 static LIBDIVIDE_INLINE uint16_t libdivide_u16_branchfree_do(
@@ -363,6 +819,8 @@ static LIBDIVIDE_INLINE int64_t libdivide_s64_branchfree_do(
 static LIBDIVIDE_INLINE uint64_t libdivide_u64_branchfree_do(
     uint64_t numer, const struct libdivide_u64_branchfree_t *denom);
 
+static LIBDIVIDE_INLINE int8_t libdivide_s8_recover(const struct libdivide_s8_t *denom);
+static LIBDIVIDE_INLINE uint8_t libdivide_u8_recover(const struct libdivide_u8_t *denom);
 static LIBDIVIDE_INLINE int16_t libdivide_s16_recover(const struct libdivide_s16_t *denom);
 static LIBDIVIDE_INLINE uint16_t libdivide_u16_recover(const struct libdivide_u16_t *denom);
 static LIBDIVIDE_INLINE int32_t libdivide_s32_recover(const struct libdivide_s32_t *denom);
@@ -370,6 +828,10 @@ static LIBDIVIDE_INLINE uint32_t libdivide_u32_recover(const struct libdivide_u3
 static LIBDIVIDE_INLINE int64_t libdivide_s64_recover(const struct libdivide_s64_t *denom);
 static LIBDIVIDE_INLINE uint64_t libdivide_u64_recover(const struct libdivide_u64_t *denom);
 
+static LIBDIVIDE_INLINE int8_t libdivide_s8_branchfree_recover(
+    const struct libdivide_s8_branchfree_t *denom);
+static LIBDIVIDE_INLINE uint8_t libdivide_u8_branchfree_recover(
+    const struct libdivide_u8_branchfree_t *denom);
 static LIBDIVIDE_INLINE int16_t libdivide_s16_branchfree_recover(
     const struct libdivide_s16_branchfree_t *denom);
 static LIBDIVIDE_INLINE uint16_t libdivide_u16_branchfree_recover(
@@ -383,8 +845,714 @@ static LIBDIVIDE_INLINE int64_t libdivide_s64_branchfree_recover(
 static LIBDIVIDE_INLINE uint64_t libdivide_u64_branchfree_recover(
     const struct libdivide_u64_branchfree_t *denom);
 
+#if defined(HAS_INT128_T)
+static LIBDIVIDE_INLINE struct libdivide_s128_t libdivide_s128_gen(__int128_t d);
+static LIBDIVIDE_INLINE struct libdivide_u128_t libdivide_u128_gen(__uint128_t d);
+static LIBDIVIDE_INLINE struct libdivide_s128_branchfree_t libdivide_s128_branchfree_gen(
+    __int128_t d);
+static LIBDIVIDE_INLINE struct libdivide_u128_branchfree_t libdivide_u128_branchfree_gen(
+    __uint128_t d);
+
+static LIBDIVIDE_INLINE __int128_t libdivide_s128_do_raw(
+    __int128_t numer, __int128_t magic, uint16_t more);
+static LIBDIVIDE_INLINE __int128_t libdivide_s128_do(
+    __int128_t numer, const struct libdivide_s128_t *denom);
+static LIBDIVIDE_INLINE __uint128_t libdivide_u128_do_raw(
+    __uint128_t numer, __uint128_t magic, uint16_t more);
+static LIBDIVIDE_INLINE __uint128_t libdivide_u128_do(
+    __uint128_t numer, const struct libdivide_u128_t *denom);
+static LIBDIVIDE_INLINE __int128_t libdivide_s128_branchfree_do(
+    __int128_t numer, const struct libdivide_s128_branchfree_t *denom);
+static LIBDIVIDE_INLINE __uint128_t libdivide_u128_branchfree_do(
+    __uint128_t numer, const struct libdivide_u128_branchfree_t *denom);
+
+static LIBDIVIDE_INLINE __int128_t libdivide_s128_recover(const struct libdivide_s128_t *denom);
+static LIBDIVIDE_INLINE __uint128_t libdivide_u128_recover(const struct libdivide_u128_t *denom);
+static LIBDIVIDE_INLINE __int128_t libdivide_s128_branchfree_recover(
+    const struct libdivide_s128_branchfree_t *denom);
+static LIBDIVIDE_INLINE __uint128_t libdivide_u128_branchfree_recover(
+    const struct libdivide_u128_branchfree_t *denom);
+#endif
+
+static LIBDIVIDE_INLINE void libdivide_u8_do_array(
+    const uint8_t *numers, uint8_t *quots, size_t count, const struct libdivide_u8_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s8_do_array(
+    const int8_t *numers, int8_t *quots, size_t count, const struct libdivide_s8_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u16_do_array(
+    const uint16_t *numers, uint16_t *quots, size_t count, const struct libdivide_u16_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s16_do_array(
+    const int16_t *numers, int16_t *quots, size_t count, const struct libdivide_s16_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u32_do_array(
+    const uint32_t *numers, uint32_t *quots, size_t count, const struct libdivide_u32_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s32_do_array(
+    const int32_t *numers, int32_t *quots, size_t count, const struct libdivide_s32_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u64_do_array(
+    const uint64_t *numers, uint64_t *quots, size_t count, const struct libdivide_u64_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s64_do_array(
+    const int64_t *numers, int64_t *quots, size_t count, const struct libdivide_s64_t *denom);
+
+static LIBDIVIDE_INLINE void libdivide_u8_do_runs(const uint8_t *numers, uint8_t *quots,
+    const uint32_t *lengths, const uint8_t *denoms, size_t run_count);
+static LIBDIVIDE_INLINE void libdivide_s8_do_runs(const int8_t *numers, int8_t *quots,
+    const uint32_t *lengths, const int8_t *denoms, size_t run_count);
+static LIBDIVIDE_INLINE void libdivide_u16_do_runs(const uint16_t *numers, uint16_t *quots,
+    const uint32_t *lengths, const uint16_t *denoms, size_t run_count);
+static LIBDIVIDE_INLINE void libdivide_s16_do_runs(const int16_t *numers, int16_t *quots,
+    const uint32_t *lengths, const int16_t *denoms, size_t run_count);
+static LIBDIVIDE_INLINE void libdivide_u32_do_runs(const uint32_t *numers, uint32_t *quots,
+    const uint32_t *lengths, const uint32_t *denoms, size_t run_count);
+static LIBDIVIDE_INLINE void libdivide_s32_do_runs(const int32_t *numers, int32_t *quots,
+    const uint32_t *lengths, const int32_t *denoms, size_t run_count);
+static LIBDIVIDE_INLINE void libdivide_u64_do_runs(const uint64_t *numers, uint64_t *quots,
+    const uint32_t *lengths, const uint64_t *denoms, size_t run_count);
+static LIBDIVIDE_INLINE void libdivide_s64_do_runs(const int64_t *numers, int64_t *quots,
+    const uint32_t *lengths, const int64_t *denoms, size_t run_count);
+
+static LIBDIVIDE_INLINE void libdivide_u8_iota_divmod(uint8_t start, uint8_t step, size_t count,
+    uint8_t d, uint8_t *quots, uint8_t *rems);
+static LIBDIVIDE_INLINE void libdivide_u16_iota_divmod(uint16_t start, uint16_t step,
+    size_t count, uint16_t d, uint16_t *quots, uint16_t *rems);
+static LIBDIVIDE_INLINE void libdivide_u32_iota_divmod(uint32_t start, uint32_t step,
+    size_t count, uint32_t d, uint32_t *quots, uint32_t *rems);
+static LIBDIVIDE_INLINE void libdivide_u64_iota_divmod(uint64_t start, uint64_t step,
+    size_t count, uint64_t d, uint64_t *quots, uint64_t *rems);
+
+static LIBDIVIDE_INLINE void libdivide_u32_decompose(uint32_t index, const uint32_t *extents,
+    const struct libdivide_u32_t *denoms, size_t rank, uint32_t *coords);
+static LIBDIVIDE_INLINE void libdivide_u64_decompose(uint64_t index, const uint64_t *extents,
+    const struct libdivide_u64_t *denoms, size_t rank, uint64_t *coords);
+static LIBDIVIDE_INLINE void libdivide_u32_decompose_array(const uint32_t *indices, size_t count,
+    const uint32_t *extents, const struct libdivide_u32_t *denoms, size_t rank,
+    uint32_t *const *coords);
+static LIBDIVIDE_INLINE void libdivide_u64_decompose_array(const uint64_t *indices, size_t count,
+    const uint64_t *extents, const struct libdivide_u64_t *denoms, size_t rank,
+    uint64_t *const *coords);
+static LIBDIVIDE_INLINE void libdivide_u32_remap_array(const uint32_t *indices, size_t count,
+    const uint32_t *extents, const struct libdivide_u32_t *denoms, size_t rank,
+    const uint32_t *strides, uint32_t *out);
+static LIBDIVIDE_INLINE void libdivide_u64_remap_array(const uint64_t *indices, size_t count,
+    const uint64_t *extents, const struct libdivide_u64_t *denoms, size_t rank,
+    const uint64_t *strides, uint64_t *out);
+
+static LIBDIVIDE_INLINE void libdivide_u32_mulmod_array(const uint32_t *a, const uint32_t *b,
+    uint32_t *c, size_t count, const struct libdivide_u32_reducer_t *reducer);
+static LIBDIVIDE_INLINE void libdivide_u64_mulmod_array(const uint64_t *a, const uint64_t *b,
+    uint64_t *c, size_t count, const struct libdivide_u64_reducer_t *reducer);
+static LIBDIVIDE_INLINE void libdivide_u32_addmod_array(const uint32_t *a, const uint32_t *b,
+    uint32_t *c, size_t count, const struct libdivide_u32_reducer_t *reducer);
+static LIBDIVIDE_INLINE void libdivide_u64_addmod_array(const uint64_t *a, const uint64_t *b,
+    uint64_t *c, size_t count, const struct libdivide_u64_reducer_t *reducer);
+static LIBDIVIDE_INLINE void libdivide_u32_submod_array(const uint32_t *a, const uint32_t *b,
+    uint32_t *c, size_t count, const struct libdivide_u32_reducer_t *reducer);
+static LIBDIVIDE_INLINE void libdivide_u64_submod_array(const uint64_t *a, const uint64_t *b,
+    uint64_t *c, size_t count, const struct libdivide_u64_reducer_t *reducer);
+static LIBDIVIDE_INLINE void libdivide_u32_powmod_array(const uint32_t *bases, uint32_t *powers,
+    size_t count, uint64_t exp, const struct libdivide_u32_reducer_t *reducer);
+static LIBDIVIDE_INLINE void libdivide_u64_powmod_array(const uint64_t *bases, uint64_t *powers,
+    size_t count, uint64_t exp, const struct libdivide_u64_reducer_t *reducer);
+
+static LIBDIVIDE_INLINE void libdivide_u64_muldiv_array(const uint64_t *a, uint64_t b,
+    uint64_t *results, size_t count, const struct libdivide_u64_muldiv_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s64_muldiv_array(const int64_t *a, int64_t b,
+    int64_t *results, size_t count, const struct libdivide_s64_muldiv_t *denom);
+
+static LIBDIVIDE_INLINE void libdivide_u32_scaler_do_array(const uint32_t *x, uint32_t *results,
+    size_t count, const struct libdivide_u32_scaler_t *scaler);
+static LIBDIVIDE_INLINE void libdivide_u64_scaler_do_array(const uint64_t *x, uint64_t *results,
+    size_t count, const struct libdivide_u64_scaler_t *scaler);
+
+static LIBDIVIDE_INLINE void libdivide_u8_branchfree_do_array(const uint8_t *numers,
+    uint8_t *quots, size_t count, const struct libdivide_u8_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s8_branchfree_do_array(const int8_t *numers,
+    int8_t *quots, size_t count, const struct libdivide_s8_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u16_branchfree_do_array(const uint16_t *numers,
+    uint16_t *quots, size_t count, const struct libdivide_u16_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s16_branchfree_do_array(const int16_t *numers,
+    int16_t *quots, size_t count, const struct libdivide_s16_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u32_branchfree_do_array(const uint32_t *numers,
+    uint32_t *quots, size_t count, const struct libdivide_u32_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s32_branchfree_do_array(const int32_t *numers,
+    int32_t *quots, size_t count, const struct libdivide_s32_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u64_branchfree_do_array(const uint64_t *numers,
+    uint64_t *quots, size_t count, const struct libdivide_u64_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s64_branchfree_do_array(const int64_t *numers,
+    int64_t *quots, size_t count, const struct libdivide_s64_branchfree_t *denom);
+
+static LIBDIVIDE_INLINE void libdivide_u8_branchfree_do_each(const uint8_t *numers,
+    uint8_t *quots, size_t count, const struct libdivide_u8_branchfree_t *denoms);
+static LIBDIVIDE_INLINE void libdivide_s8_branchfree_do_each(const int8_t *numers,
+    int8_t *quots, size_t count, const struct libdivide_s8_branchfree_t *denoms);
+static LIBDIVIDE_INLINE void libdivide_u16_branchfree_do_each(const uint16_t *numers,
+    uint16_t *quots, size_t count, const struct libdivide_u16_branchfree_t *denoms);
+static LIBDIVIDE_INLINE void libdivide_s16_branchfree_do_each(const int16_t *numers,
+    int16_t *quots, size_t count, const struct libdivide_s16_branchfree_t *denoms);
+static LIBDIVIDE_INLINE void libdivide_u32_branchfree_do_each(const uint32_t *numers,
+    uint32_t *quots, size_t count, const struct libdivide_u32_branchfree_t *denoms);
+static LIBDIVIDE_INLINE void libdivide_s32_branchfree_do_each(const int32_t *numers,
+    int32_t *quots, size_t count, const struct libdivide_s32_branchfree_t *denoms);
+static LIBDIVIDE_INLINE void libdivide_u64_branchfree_do_each(const uint64_t *numers,
+    uint64_t *quots, size_t count, const struct libdivide_u64_branchfree_t *denoms);
+static LIBDIVIDE_INLINE void libdivide_s64_branchfree_do_each(const int64_t *numers,
+    int64_t *quots, size_t count, const struct libdivide_s64_branchfree_t *denoms);
+
+static LIBDIVIDE_INLINE void libdivide_u8_branchfree_do_each_strided(const uint8_t *numers,
+    uint8_t *quots, size_t count, const struct libdivide_u8_branchfree_t *denoms, size_t stride);
+static LIBDIVIDE_INLINE void libdivide_s8_branchfree_do_each_strided(const int8_t *numers,
+    int8_t *quots, size_t count, const struct libdivide_s8_branchfree_t *denoms, size_t stride);
+static LIBDIVIDE_INLINE void libdivide_u16_branchfree_do_each_strided(const uint16_t *numers,
+    uint16_t *quots, size_t count, const struct libdivide_u16_branchfree_t *denoms, size_t stride);
+static LIBDIVIDE_INLINE void libdivide_s16_branchfree_do_each_strided(const int16_t *numers,
+    int16_t *quots, size_t count, const struct libdivide_s16_branchfree_t *denoms, size_t stride);
+static LIBDIVIDE_INLINE void libdivide_u32_branchfree_do_each_strided(const uint32_t *numers,
+    uint32_t *quots, size_t count, const struct libdivide_u32_branchfree_t *denoms, size_t stride);
+static LIBDIVIDE_INLINE void libdivide_s32_branchfree_do_each_strided(const int32_t *numers,
+    int32_t *quots, size_t count, const struct libdivide_s32_branchfree_t *denoms, size_t stride);
+static LIBDIVIDE_INLINE void libdivide_u64_branchfree_do_each_strided(const uint64_t *numers,
+    uint64_t *quots, size_t count, const struct libdivide_u64_branchfree_t *denoms, size_t stride);
+static LIBDIVIDE_INLINE void libdivide_s64_branchfree_do_each_strided(const int64_t *numers,
+    int64_t *quots, size_t count, const struct libdivide_s64_branchfree_t *denoms, size_t stride);
+
+static LIBDIVIDE_INLINE void libdivide_u8_branchfree_do_by_each(uint8_t numer, uint8_t *quots,
+    size_t count, const struct libdivide_u8_branchfree_t *denoms);
+static LIBDIVIDE_INLINE void libdivide_s8_branchfree_do_by_each(int8_t numer, int8_t *quots,
+    size_t count, const struct libdivide_s8_branchfree_t *denoms);
+static LIBDIVIDE_INLINE void libdivide_u16_branchfree_do_by_each(uint16_t numer, uint16_t *quots,
+    size_t count, const struct libdivide_u16_branchfree_t *denoms);
+static LIBDIVIDE_INLINE void libdivide_s16_branchfree_do_by_each(int16_t numer, int16_t *quots,
+    size_t count, const struct libdivide_s16_branchfree_t *denoms);
+static LIBDIVIDE_INLINE void libdivide_u32_branchfree_do_by_each(uint32_t numer, uint32_t *quots,
+    size_t count, const struct libdivide_u32_branchfree_t *denoms);
+static LIBDIVIDE_INLINE void libdivide_s32_branchfree_do_by_each(int32_t numer, int32_t *quots,
+    size_t count, const struct libdivide_s32_branchfree_t *denoms);
+static LIBDIVIDE_INLINE void libdivide_u64_branchfree_do_by_each(uint64_t numer, uint64_t *quots,
+    size_t count, const struct libdivide_u64_branchfree_t *denoms);
+static LIBDIVIDE_INLINE void libdivide_s64_branchfree_do_by_each(int64_t numer, int64_t *quots,
+    size_t count, const struct libdivide_s64_branchfree_t *denoms);
+
+static LIBDIVIDE_INLINE void libdivide_u8_branchfree_do_by_each_strided(uint8_t numer,
+    uint8_t *quots, size_t count, const struct libdivide_u8_branchfree_t *denoms, size_t stride);
+static LIBDIVIDE_INLINE void libdivide_s8_branchfree_do_by_each_strided(int8_t numer,
+    int8_t *quots, size_t count, const struct libdivide_s8_branchfree_t *denoms, size_t stride);
+static LIBDIVIDE_INLINE void libdivide_u16_branchfree_do_by_each_strided(uint16_t numer,
+    uint16_t *quots, size_t count, const struct libdivide_u16_branchfree_t *denoms, size_t stride);
+static LIBDIVIDE_INLINE void libdivide_s16_branchfree_do_by_each_strided(int16_t numer,
+    int16_t *quots, size_t count, const struct libdivide_s16_branchfree_t *denoms, size_t stride);
+static LIBDIVIDE_INLINE void libdivide_u32_branchfree_do_by_each_strided(uint32_t numer,
+    uint32_t *quots, size_t count, const struct libdivide_u32_branchfree_t *denoms, size_t stride);
+static LIBDIVIDE_INLINE void libdivide_s32_branchfree_do_by_each_strided(int32_t numer,
+    int32_t *quots, size_t count, const struct libdivide_s32_branchfree_t *denoms, size_t stride);
+static LIBDIVIDE_INLINE void libdivide_u64_branchfree_do_by_each_strided(uint64_t numer,
+    uint64_t *quots, size_t count, const struct libdivide_u64_branchfree_t *denoms, size_t stride);
+static LIBDIVIDE_INLINE void libdivide_s64_branchfree_do_by_each_strided(int64_t numer,
+    int64_t *quots, size_t count, const struct libdivide_s64_branchfree_t *denoms, size_t stride);
+
+static LIBDIVIDE_INLINE void libdivide_u8_do_table_array(const uint8_t *numers,
+    const uint32_t *indices, uint8_t *quots, size_t count, const uint8_t *magics,
+    const uint8_t *mores);
+static LIBDIVIDE_INLINE void libdivide_s8_do_table_array(const int8_t *numers,
+    const uint32_t *indices, int8_t *quots, size_t count, const int8_t *magics,
+    const uint8_t *mores);
+static LIBDIVIDE_INLINE void libdivide_u16_do_table_array(const uint16_t *numers,
+    const uint32_t *indices, uint16_t *quots, size_t count, const uint16_t *magics,
+    const uint8_t *mores);
+static LIBDIVIDE_INLINE void libdivide_s16_do_table_array(const int16_t *numers,
+    const uint32_t *indices, int16_t *quots, size_t count, const int16_t *magics,
+    const uint8_t *mores);
+static LIBDIVIDE_INLINE void libdivide_u32_do_table_array(const uint32_t *numers,
+    const uint32_t *indices, uint32_t *quots, size_t count, const uint32_t *magics,
+    const uint8_t *mores);
+static LIBDIVIDE_INLINE void libdivide_s32_do_table_array(const int32_t *numers,
+    const uint32_t *indices, int32_t *quots, size_t count, const int32_t *magics,
+    const uint8_t *mores);
+static LIBDIVIDE_INLINE void libdivide_u64_do_table_array(const uint64_t *numers,
+    const uint32_t *indices, uint64_t *quots, size_t count, const uint64_t *magics,
+    const uint8_t *mores);
+static LIBDIVIDE_INLINE void libdivide_s64_do_table_array(const int64_t *numers,
+    const uint32_t *indices, int64_t *quots, size_t count, const int64_t *magics,
+    const uint8_t *mores);
+
+static LIBDIVIDE_INLINE void libdivide_u8_branchfree_do_table_array(const uint8_t *numers,
+    const uint32_t *indices, uint8_t *quots, size_t count, const uint8_t *magics,
+    const uint8_t *mores);
+static LIBDIVIDE_INLINE void libdivide_s8_branchfree_do_table_array(const int8_t *numers,
+    const uint32_t *indices, int8_t *quots, size_t count, const int8_t *magics,
+    const uint8_t *mores);
+static LIBDIVIDE_INLINE void libdivide_u16_branchfree_do_table_array(const uint16_t *numers,
+    const uint32_t *indices, uint16_t *quots, size_t count, const uint16_t *magics,
+    const uint8_t *mores);
+static LIBDIVIDE_INLINE void libdivide_s16_branchfree_do_table_array(const int16_t *numers,
+    const uint32_t *indices, int16_t *quots, size_t count, const int16_t *magics,
+    const uint8_t *mores);
+static LIBDIVIDE_INLINE void libdivide_u32_branchfree_do_table_array(const uint32_t *numers,
+    const uint32_t *indices, uint32_t *quots, size_t count, const uint32_t *magics,
+    const uint8_t *mores);
+static LIBDIVIDE_INLINE void libdivide_s32_branchfree_do_table_array(const int32_t *numers,
+    const uint32_t *indices, int32_t *quots, size_t count, const int32_t *magics,
+    const uint8_t *mores);
+static LIBDIVIDE_INLINE void libdivide_u64_branchfree_do_table_array(const uint64_t *numers,
+    const uint32_t *indices, uint64_t *quots, size_t count, const uint64_t *magics,
+    const uint8_t *mores);
+static LIBDIVIDE_INLINE void libdivide_s64_branchfree_do_table_array(const int64_t *numers,
+    const uint32_t *indices, int64_t *quots, size_t count, const int64_t *magics,
+    const uint8_t *mores);
+
+static LIBDIVIDE_INLINE void libdivide_u8_gen_array(
+    const uint8_t *divisors, uint8_t *magics, uint8_t *mores, size_t count);
+static LIBDIVIDE_INLINE void libdivide_s8_gen_array(
+    const int8_t *divisors, int8_t *magics, uint8_t *mores, size_t count);
+static LIBDIVIDE_INLINE void libdivide_u16_gen_array(
+    const uint16_t *divisors, uint16_t *magics, uint8_t *mores, size_t count);
+static LIBDIVIDE_INLINE void libdivide_s16_gen_array(
+    const int16_t *divisors, int16_t *magics, uint8_t *mores, size_t count);
+static LIBDIVIDE_INLINE void libdivide_u32_gen_array(
+    const uint32_t *divisors, uint32_t *magics, uint8_t *mores, size_t count);
+static LIBDIVIDE_INLINE void libdivide_s32_gen_array(
+    const int32_t *divisors, int32_t *magics, uint8_t *mores, size_t count);
+static LIBDIVIDE_INLINE void libdivide_u64_gen_array(
+    const uint64_t *divisors, uint64_t *magics, uint8_t *mores, size_t count);
+static LIBDIVIDE_INLINE void libdivide_s64_gen_array(
+    const int64_t *divisors, int64_t *magics, uint8_t *mores, size_t count);
+
+static LIBDIVIDE_INLINE void libdivide_u8_branchfree_gen_array(
+    const uint8_t *divisors, uint8_t *magics, uint8_t *mores, size_t count);
+static LIBDIVIDE_INLINE void libdivide_s8_branchfree_gen_array(
+    const int8_t *divisors, int8_t *magics, uint8_t *mores, size_t count);
+static LIBDIVIDE_INLINE void libdivide_u16_branchfree_gen_array(
+    const uint16_t *divisors, uint16_t *magics, uint8_t *mores, size_t count);
+static LIBDIVIDE_INLINE void libdivide_s16_branchfree_gen_array(
+    const int16_t *divisors, int16_t *magics, uint8_t *mores, size_t count);
+static LIBDIVIDE_INLINE void libdivide_u32_branchfree_gen_array(
+    const uint32_t *divisors, uint32_t *magics, uint8_t *mores, size_t count);
+static LIBDIVIDE_INLINE void libdivide_s32_branchfree_gen_array(
+    const int32_t *divisors, int32_t *magics, uint8_t *mores, size_t count);
+static LIBDIVIDE_INLINE void libdivide_u64_branchfree_gen_array(
+    const uint64_t *divisors, uint64_t *magics, uint8_t *mores, size_t count);
+static LIBDIVIDE_INLINE void libdivide_s64_branchfree_gen_array(
+    const int64_t *divisors, int64_t *magics, uint8_t *mores, size_t count);
+
+static LIBDIVIDE_INLINE int8_t libdivide_s8_remainder(
+    int8_t numer, int8_t d, const struct libdivide_s8_t *denom);
+static LIBDIVIDE_INLINE int8_t libdivide_s8_divmod(
+    int8_t numer, int8_t d, const struct libdivide_s8_t *denom, int8_t *rem);
+static LIBDIVIDE_INLINE uint8_t libdivide_u8_remainder(
+    uint8_t numer, uint8_t d, const struct libdivide_u8_t *denom);
+static LIBDIVIDE_INLINE uint8_t libdivide_u8_divmod(
+    uint8_t numer, uint8_t d, const struct libdivide_u8_t *denom, uint8_t *rem);
+static LIBDIVIDE_INLINE int16_t libdivide_s16_remainder(
+    int16_t numer, int16_t d, const struct libdivide_s16_t *denom);
+static LIBDIVIDE_INLINE int16_t libdivide_s16_divmod(
+    int16_t numer, int16_t d, const struct libdivide_s16_t *denom, int16_t *rem);
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_remainder(
+    uint16_t numer, uint16_t d, const struct libdivide_u16_t *denom);
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_divmod(
+    uint16_t numer, uint16_t d, const struct libdivide_u16_t *denom, uint16_t *rem);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_remainder(
+    int32_t numer, int32_t d, const struct libdivide_s32_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_divmod(
+    int32_t numer, int32_t d, const struct libdivide_s32_t *denom, int32_t *rem);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_remainder(
+    uint32_t numer, uint32_t d, const struct libdivide_u32_t *denom);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_divmod(
+    uint32_t numer, uint32_t d, const struct libdivide_u32_t *denom, uint32_t *rem);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_remainder(
+    int64_t numer, int64_t d, const struct libdivide_s64_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_divmod(
+    int64_t numer, int64_t d, const struct libdivide_s64_t *denom, int64_t *rem);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_remainder(
+    uint64_t numer, uint64_t d, const struct libdivide_u64_t *denom);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_divmod(
+    uint64_t numer, uint64_t d, const struct libdivide_u64_t *denom, uint64_t *rem);
+
+static LIBDIVIDE_INLINE int8_t libdivide_s8_branchfree_remainder(
+    int8_t numer, int8_t d, const struct libdivide_s8_branchfree_t *denom);
+static LIBDIVIDE_INLINE int8_t libdivide_s8_branchfree_divmod(
+    int8_t numer, int8_t d, const struct libdivide_s8_branchfree_t *denom, int8_t *rem);
+static LIBDIVIDE_INLINE uint8_t libdivide_u8_branchfree_remainder(
+    uint8_t numer, uint8_t d, const struct libdivide_u8_branchfree_t *denom);
+static LIBDIVIDE_INLINE uint8_t libdivide_u8_branchfree_divmod(
+    uint8_t numer, uint8_t d, const struct libdivide_u8_branchfree_t *denom, uint8_t *rem);
+static LIBDIVIDE_INLINE int16_t libdivide_s16_branchfree_remainder(
+    int16_t numer, int16_t d, const struct libdivide_s16_branchfree_t *denom);
+static LIBDIVIDE_INLINE int16_t libdivide_s16_branchfree_divmod(
+    int16_t numer, int16_t d, const struct libdivide_s16_branchfree_t *denom, int16_t *rem);
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_branchfree_remainder(
+    uint16_t numer, uint16_t d, const struct libdivide_u16_branchfree_t *denom);
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_branchfree_divmod(
+    uint16_t numer, uint16_t d, const struct libdivide_u16_branchfree_t *denom, uint16_t *rem);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_branchfree_remainder(
+    int32_t numer, int32_t d, const struct libdivide_s32_branchfree_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_branchfree_divmod(
+    int32_t numer, int32_t d, const struct libdivide_s32_branchfree_t *denom, int32_t *rem);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_branchfree_remainder(
+    uint32_t numer, uint32_t d, const struct libdivide_u32_branchfree_t *denom);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_branchfree_divmod(
+    uint32_t numer, uint32_t d, const struct libdivide_u32_branchfree_t *denom, uint32_t *rem);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_branchfree_remainder(
+    int64_t numer, int64_t d, const struct libdivide_s64_branchfree_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_branchfree_divmod(
+    int64_t numer, int64_t d, const struct libdivide_s64_branchfree_t *denom, int64_t *rem);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_branchfree_remainder(
+    uint64_t numer, uint64_t d, const struct libdivide_u64_branchfree_t *denom);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_branchfree_divmod(
+    uint64_t numer, uint64_t d, const struct libdivide_u64_branchfree_t *denom, uint64_t *rem);
+
+static LIBDIVIDE_INLINE void libdivide_s8_remainder_array(const int8_t *numers, int8_t *rems,
+    size_t count, int8_t d, const struct libdivide_s8_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s8_divmod_array(const int8_t *numers, int8_t *quots,
+    int8_t *rems, size_t count, int8_t d, const struct libdivide_s8_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u8_remainder_array(const uint8_t *numers, uint8_t *rems,
+    size_t count, uint8_t d, const struct libdivide_u8_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u8_divmod_array(const uint8_t *numers, uint8_t *quots,
+    uint8_t *rems, size_t count, uint8_t d, const struct libdivide_u8_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s16_remainder_array(const int16_t *numers, int16_t *rems,
+    size_t count, int16_t d, const struct libdivide_s16_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s16_divmod_array(const int16_t *numers, int16_t *quots,
+    int16_t *rems, size_t count, int16_t d, const struct libdivide_s16_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u16_remainder_array(const uint16_t *numers, uint16_t *rems,
+    size_t count, uint16_t d, const struct libdivide_u16_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u16_divmod_array(const uint16_t *numers, uint16_t *quots,
+    uint16_t *rems, size_t count, uint16_t d, const struct libdivide_u16_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s32_remainder_array(const int32_t *numers, int32_t *rems,
+    size_t count, int32_t d, const struct libdivide_s32_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s32_divmod_array(const int32_t *numers, int32_t *quots,
+    int32_t *rems, size_t count, int32_t d, const struct libdivide_s32_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u32_remainder_array(const uint32_t *numers, uint32_t *rems,
+    size_t count, uint32_t d, const struct libdivide_u32_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u32_divmod_array(const uint32_t *numers, uint32_t *quots,
+    uint32_t *rems, size_t count, uint32_t d, const struct libdivide_u32_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s64_remainder_array(const int64_t *numers, int64_t *rems,
+    size_t count, int64_t d, const struct libdivide_s64_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s64_divmod_array(const int64_t *numers, int64_t *quots,
+    int64_t *rems, size_t count, int64_t d, const struct libdivide_s64_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u64_remainder_array(const uint64_t *numers, uint64_t *rems,
+    size_t count, uint64_t d, const struct libdivide_u64_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u64_divmod_array(const uint64_t *numers, uint64_t *quots,
+    uint64_t *rems, size_t count, uint64_t d, const struct libdivide_u64_t *denom);
+
+static LIBDIVIDE_INLINE void libdivide_s8_branchfree_remainder_array(const int8_t *numers,
+    int8_t *rems, size_t count, int8_t d, const struct libdivide_s8_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s8_branchfree_divmod_array(const int8_t *numers,
+    int8_t *quots, int8_t *rems, size_t count, int8_t d,
+    const struct libdivide_s8_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u8_branchfree_remainder_array(const uint8_t *numers,
+    uint8_t *rems, size_t count, uint8_t d, const struct libdivide_u8_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u8_branchfree_divmod_array(const uint8_t *numers,
+    uint8_t *quots, uint8_t *rems, size_t count, uint8_t d,
+    const struct libdivide_u8_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s16_branchfree_remainder_array(const int16_t *numers,
+    int16_t *rems, size_t count, int16_t d, const struct libdivide_s16_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s16_branchfree_divmod_array(const int16_t *numers,
+    int16_t *quots, int16_t *rems, size_t count, int16_t d,
+    const struct libdivide_s16_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u16_branchfree_remainder_array(const uint16_t *numers,
+    uint16_t *rems, size_t count, uint16_t d, const struct libdivide_u16_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u16_branchfree_divmod_array(const uint16_t *numers,
+    uint16_t *quots, uint16_t *rems, size_t count, uint16_t d,
+    const struct libdivide_u16_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s32_branchfree_remainder_array(const int32_t *numers,
+    int32_t *rems, size_t count, int32_t d, const struct libdivide_s32_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s32_branchfree_divmod_array(const int32_t *numers,
+    int32_t *quots, int32_t *rems, size_t count, int32_t d,
+    const struct libdivide_s32_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u32_branchfree_remainder_array(const uint32_t *numers,
+    uint32_t *rems, size_t count, uint32_t d, const struct libdivide_u32_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u32_branchfree_divmod_array(const uint32_t *numers,
+    uint32_t *quots, uint32_t *rems, size_t count, uint32_t d,
+    const struct libdivide_u32_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s64_branchfree_remainder_array(const int64_t *numers,
+    int64_t *rems, size_t count, int64_t d, const struct libdivide_s64_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_s64_branchfree_divmod_array(const int64_t *numers,
+    int64_t *quots, int64_t *rems, size_t count, int64_t d,
+    const struct libdivide_s64_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u64_branchfree_remainder_array(const uint64_t *numers,
+    uint64_t *rems, size_t count, uint64_t d, const struct libdivide_u64_branchfree_t *denom);
+static LIBDIVIDE_INLINE void libdivide_u64_branchfree_divmod_array(const uint64_t *numers,
+    uint64_t *quots, uint64_t *rems, size_t count, uint64_t d,
+    const struct libdivide_u64_branchfree_t *denom);
+
+static LIBDIVIDE_INLINE struct libdivide_u32_fastmod_t libdivide_u32_fastmod_gen(uint32_t d);
+static LIBDIVIDE_INLINE struct libdivide_s32_fastmod_t libdivide_s32_fastmod_gen(int32_t d);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_fastmod_mod(
+    uint32_t numer, const struct libdivide_u32_fastmod_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_fastmod_mod(
+    int32_t numer, const struct libdivide_s32_fastmod_t *denom);
+static LIBDIVIDE_INLINE int libdivide_u32_fastmod_is_divisible(
+    uint32_t numer, const struct libdivide_u32_fastmod_t *denom);
+static LIBDIVIDE_INLINE int libdivide_s32_fastmod_is_divisible(
+    int32_t numer, const struct libdivide_s32_fastmod_t *denom);
+
+static LIBDIVIDE_INLINE struct libdivide_u16_exact_t libdivide_u16_exact_gen(uint16_t d);
+static LIBDIVIDE_INLINE struct libdivide_s16_exact_t libdivide_s16_exact_gen(int16_t d);
+static LIBDIVIDE_INLINE struct libdivide_u32_exact_t libdivide_u32_exact_gen(uint32_t d);
+static LIBDIVIDE_INLINE struct libdivide_s32_exact_t libdivide_s32_exact_gen(int32_t d);
+static LIBDIVIDE_INLINE struct libdivide_u64_exact_t libdivide_u64_exact_gen(uint64_t d);
+static LIBDIVIDE_INLINE struct libdivide_s64_exact_t libdivide_s64_exact_gen(int64_t d);
+
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_exact_do(
+    uint16_t numer, const struct libdivide_u16_exact_t *denom);
+static LIBDIVIDE_INLINE int16_t libdivide_s16_exact_do(
+    int16_t numer, const struct libdivide_s16_exact_t *denom);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_exact_do(
+    uint32_t numer, const struct libdivide_u32_exact_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_exact_do(
+    int32_t numer, const struct libdivide_s32_exact_t *denom);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_exact_do(
+    uint64_t numer, const struct libdivide_u64_exact_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_exact_do(
+    int64_t numer, const struct libdivide_s64_exact_t *denom);
+
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_exact_recover(
+    const struct libdivide_u16_exact_t *denom);
+static LIBDIVIDE_INLINE int16_t libdivide_s16_exact_recover(
+    const struct libdivide_s16_exact_t *denom);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_exact_recover(
+    const struct libdivide_u32_exact_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_exact_recover(
+    const struct libdivide_s32_exact_t *denom);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_exact_recover(
+    const struct libdivide_u64_exact_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_exact_recover(
+    const struct libdivide_s64_exact_t *denom);
+
+static LIBDIVIDE_INLINE struct libdivide_u16_round_t libdivide_u16_round_gen(
+    uint16_t d, enum libdivide_rounding rounding);
+static LIBDIVIDE_INLINE struct libdivide_s16_round_t libdivide_s16_round_gen(
+    int16_t d, enum libdivide_rounding rounding);
+static LIBDIVIDE_INLINE struct libdivide_u32_round_t libdivide_u32_round_gen(
+    uint32_t d, enum libdivide_rounding rounding);
+static LIBDIVIDE_INLINE struct libdivide_s32_round_t libdivide_s32_round_gen(
+    int32_t d, enum libdivide_rounding rounding);
+static LIBDIVIDE_INLINE struct libdivide_u64_round_t libdivide_u64_round_gen(
+    uint64_t d, enum libdivide_rounding rounding);
+static LIBDIVIDE_INLINE struct libdivide_s64_round_t libdivide_s64_round_gen(
+    int64_t d, enum libdivide_rounding rounding);
+
+static LIBDIVIDE_INLINE struct libdivide_u16_round_branchfree_t libdivide_u16_round_branchfree_gen(
+    uint16_t d, enum libdivide_rounding rounding);
+static LIBDIVIDE_INLINE struct libdivide_s16_round_branchfree_t libdivide_s16_round_branchfree_gen(
+    int16_t d, enum libdivide_rounding rounding);
+static LIBDIVIDE_INLINE struct libdivide_u32_round_branchfree_t libdivide_u32_round_branchfree_gen(
+    uint32_t d, enum libdivide_rounding rounding);
+static LIBDIVIDE_INLINE struct libdivide_s32_round_branchfree_t libdivide_s32_round_branchfree_gen(
+    int32_t d, enum libdivide_rounding rounding);
+static LIBDIVIDE_INLINE struct libdivide_u64_round_branchfree_t libdivide_u64_round_branchfree_gen(
+    uint64_t d, enum libdivide_rounding rounding);
+static LIBDIVIDE_INLINE struct libdivide_s64_round_branchfree_t libdivide_s64_round_branchfree_gen(
+    int64_t d, enum libdivide_rounding rounding);
+
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_round_do(
+    uint16_t numer, const struct libdivide_u16_round_t *denom);
+static LIBDIVIDE_INLINE int16_t libdivide_s16_round_do(
+    int16_t numer, const struct libdivide_s16_round_t *denom);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_round_do(
+    uint32_t numer, const struct libdivide_u32_round_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_round_do(
+    int32_t numer, const struct libdivide_s32_round_t *denom);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_round_do(
+    uint64_t numer, const struct libdivide_u64_round_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_round_do(
+    int64_t numer, const struct libdivide_s64_round_t *denom);
+
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_round_branchfree_do(
+    uint16_t numer, const struct libdivide_u16_round_branchfree_t *denom);
+static LIBDIVIDE_INLINE int16_t libdivide_s16_round_branchfree_do(
+    int16_t numer, const struct libdivide_s16_round_branchfree_t *denom);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_round_branchfree_do(
+    uint32_t numer, const struct libdivide_u32_round_branchfree_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_round_branchfree_do(
+    int32_t numer, const struct libdivide_s32_round_branchfree_t *denom);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_round_branchfree_do(
+    uint64_t numer, const struct libdivide_u64_round_branchfree_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_round_branchfree_do(
+    int64_t numer, const struct libdivide_s64_round_branchfree_t *denom);
+
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_round_recover(
+    const struct libdivide_u16_round_t *denom);
+static LIBDIVIDE_INLINE int16_t libdivide_s16_round_recover(
+    const struct libdivide_s16_round_t *denom);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_round_recover(
+    const struct libdivide_u32_round_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_round_recover(
+    const struct libdivide_s32_round_t *denom);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_round_recover(
+    const struct libdivide_u64_round_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_round_recover(
+    const struct libdivide_s64_round_t *denom);
+
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_round_branchfree_recover(
+    const struct libdivide_u16_round_branchfree_t *denom);
+static LIBDIVIDE_INLINE int16_t libdivide_s16_round_branchfree_recover(
+    const struct libdivide_s16_round_branchfree_t *denom);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_round_branchfree_recover(
+    const struct libdivide_u32_round_branchfree_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_round_branchfree_recover(
+    const struct libdivide_s32_round_branchfree_t *denom);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_round_branchfree_recover(
+    const struct libdivide_u64_round_branchfree_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_round_branchfree_recover(
+    const struct libdivide_s64_round_branchfree_t *denom);
+
+static LIBDIVIDE_INLINE struct libdivide_u128_u64_t libdivide_u128_u64_gen(uint64_t d);
+static LIBDIVIDE_INLINE uint64_t libdivide_u128_u64_do(
+    uint64_t numhi, uint64_t numlo, const struct libdivide_u128_u64_t *denom, uint64_t *r);
+static LIBDIVIDE_INLINE uint64_t libdivide_u128_u64_recover(
+    const struct libdivide_u128_u64_t *denom);
+
+static LIBDIVIDE_INLINE struct libdivide_u64_muldiv_t libdivide_u64_muldiv_gen(
+    uint64_t c, enum libdivide_rounding rounding);
+static LIBDIVIDE_INLINE struct libdivide_s64_muldiv_t libdivide_s64_muldiv_gen(
+    int64_t c, enum libdivide_rounding rounding);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_muldiv_do(
+    uint64_t a, uint64_t b, const struct libdivide_u64_muldiv_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_muldiv_do(
+    int64_t a, int64_t b, const struct libdivide_s64_muldiv_t *denom);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_muldiv_recover(
+    const struct libdivide_u64_muldiv_t *denom);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_muldiv_recover(
+    const struct libdivide_s64_muldiv_t *denom);
+
+static LIBDIVIDE_INLINE struct libdivide_u32_scaler_t libdivide_u32_scaler_gen(
+    uint32_t num, uint32_t den, enum libdivide_rounding rounding, int saturate);
+static LIBDIVIDE_INLINE struct libdivide_u64_scaler_t libdivide_u64_scaler_gen(
+    uint64_t num, uint64_t den, enum libdivide_rounding rounding, int saturate);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_scaler_do(
+    uint32_t x, const struct libdivide_u32_scaler_t *scaler);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_scaler_do(
+    uint64_t x, const struct libdivide_u64_scaler_t *scaler);
+
+static LIBDIVIDE_INLINE struct libdivide_u16_fixed_t libdivide_u16_fixed_gen(
+    uint16_t d, int frac_bits);
+static LIBDIVIDE_INLINE struct libdivide_u32_fixed_t libdivide_u32_fixed_gen(
+    uint32_t d, int frac_bits);
+static LIBDIVIDE_INLINE struct libdivide_u64_fixed_t libdivide_u64_fixed_gen(
+    uint64_t d, int frac_bits);
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_fixed_do(
+    uint16_t numer, const struct libdivide_u16_fixed_t *denom);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_fixed_do(
+    uint32_t numer, const struct libdivide_u32_fixed_t *denom);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_fixed_do(
+    uint64_t numer, const struct libdivide_u64_fixed_t *denom);
+
+static LIBDIVIDE_INLINE struct libdivide_u32_reducer_t libdivide_u32_reducer_gen(uint32_t m);
+static LIBDIVIDE_INLINE struct libdivide_u64_reducer_t libdivide_u64_reducer_gen(uint64_t m);
+
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_reduce(
+    uint64_t numer, const struct libdivide_u32_reducer_t *reducer);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_reduce(
+    uint64_t numhi, uint64_t numlo, const struct libdivide_u64_reducer_t *reducer);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_mulmod(
+    uint32_t a, uint32_t b, const struct libdivide_u32_reducer_t *reducer);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_mulmod(
+    uint64_t a, uint64_t b, const struct libdivide_u64_reducer_t *reducer);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_powmod(
+    uint32_t base, uint64_t exp, const struct libdivide_u32_reducer_t *reducer);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_powmod(
+    uint64_t base, uint64_t exp, const struct libdivide_u64_reducer_t *reducer);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_addmod(
+    uint32_t a, uint32_t b, const struct libdivide_u32_reducer_t *reducer);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_addmod(
+    uint64_t a, uint64_t b, const struct libdivide_u64_reducer_t *reducer);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_submod(
+    uint32_t a, uint32_t b, const struct libdivide_u32_reducer_t *reducer);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_submod(
+    uint64_t a, uint64_t b, const struct libdivide_u64_reducer_t *reducer);
+
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_montgomery_reduce(
+    uint64_t numer, const struct libdivide_u32_reducer_t *reducer);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_montgomery_reduce(
+    uint64_t numhi, uint64_t numlo, const struct libdivide_u64_reducer_t *reducer);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_to_montgomery(
+    uint32_t a, const struct libdivide_u32_reducer_t *reducer);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_to_montgomery(
+    uint64_t a, const struct libdivide_u64_reducer_t *reducer);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_from_montgomery(
+    uint32_t a, const struct libdivide_u32_reducer_t *reducer);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_from_montgomery(
+    uint64_t a, const struct libdivide_u64_reducer_t *reducer);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_montgomery_mul(
+    uint32_t a, uint32_t b, const struct libdivide_u32_reducer_t *reducer);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_montgomery_mul(
+    uint64_t a, uint64_t b, const struct libdivide_u64_reducer_t *reducer);
+
+static LIBDIVIDE_INLINE struct libdivide_u16_fp_t libdivide_u16_fp_gen(uint16_t d);
+static LIBDIVIDE_INLINE struct libdivide_s16_fp_t libdivide_s16_fp_gen(int16_t d);
+static LIBDIVIDE_INLINE struct libdivide_u32_fp_t libdivide_u32_fp_gen(uint32_t d);
+static LIBDIVIDE_INLINE struct libdivide_s32_fp_t libdivide_s32_fp_gen(int32_t d);
+
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_fp_do(
+    uint16_t numer, const struct libdivide_u16_fp_t *denom);
+static LIBDIVIDE_INLINE int16_t libdivide_s16_fp_do(
+    int16_t numer, const struct libdivide_s16_fp_t *denom);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_fp_do(
+    uint32_t numer, const struct libdivide_u32_fp_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_fp_do(
+    int32_t numer, const struct libdivide_s32_fp_t *denom);
+
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_fp_recover(const struct libdivide_u16_fp_t *denom);
+static LIBDIVIDE_INLINE int16_t libdivide_s16_fp_recover(const struct libdivide_s16_fp_t *denom);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_fp_recover(const struct libdivide_u32_fp_t *denom);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_fp_recover(const struct libdivide_s32_fp_t *denom);
+
+static LIBDIVIDE_INLINE struct libdivide_u16_branchfree_dict_t libdivide_u16_branchfree_dict_gen(
+    const uint16_t *denoms, size_t count);
+static LIBDIVIDE_INLINE struct libdivide_s16_branchfree_dict_t libdivide_s16_branchfree_dict_gen(
+    const int16_t *denoms, size_t count);
+static LIBDIVIDE_INLINE struct libdivide_u32_branchfree_dict_t libdivide_u32_branchfree_dict_gen(
+    const uint32_t *denoms, size_t count);
+static LIBDIVIDE_INLINE struct libdivide_s32_branchfree_dict_t libdivide_s32_branchfree_dict_gen(
+    const int32_t *denoms, size_t count);
+static LIBDIVIDE_INLINE struct libdivide_u64_branchfree_dict_t libdivide_u64_branchfree_dict_gen(
+    const uint64_t *denoms, size_t count);
+static LIBDIVIDE_INLINE struct libdivide_s64_branchfree_dict_t libdivide_s64_branchfree_dict_gen(
+    const int64_t *denoms, size_t count);
+
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_branchfree_dict_do(
+    uint16_t numer, uint8_t code, const struct libdivide_u16_branchfree_dict_t *dict);
+static LIBDIVIDE_INLINE int16_t libdivide_s16_branchfree_dict_do(
+    int16_t numer, uint8_t code, const struct libdivide_s16_branchfree_dict_t *dict);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_branchfree_dict_do(
+    uint32_t numer, uint8_t code, const struct libdivide_u32_branchfree_dict_t *dict);
+static LIBDIVIDE_INLINE int32_t libdivide_s32_branchfree_dict_do(
+    int32_t numer, uint8_t code, const struct libdivide_s32_branchfree_dict_t *dict);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_branchfree_dict_do(
+    uint64_t numer, uint8_t code, const struct libdivide_u64_branchfree_dict_t *dict);
+static LIBDIVIDE_INLINE int64_t libdivide_s64_branchfree_dict_do(
+    int64_t numer, uint8_t code, const struct libdivide_s64_branchfree_dict_t *dict);
+
+static LIBDIVIDE_INLINE void libdivide_u16_branchfree_dict_do_array(const uint16_t *numers,
+    const uint8_t *codes, uint16_t *quots, size_t count,
+    const struct libdivide_u16_branchfree_dict_t *dict);
+static LIBDIVIDE_INLINE void libdivide_s16_branchfree_dict_do_array(const int16_t *numers,
+    const uint8_t *codes, int16_t *quots, size_t count,
+    const struct libdivide_s16_branchfree_dict_t *dict);
+static LIBDIVIDE_INLINE void libdivide_u32_branchfree_dict_do_array(const uint32_t *numers,
+    const uint8_t *codes, uint32_t *quots, size_t count,
+    const struct libdivide_u32_branchfree_dict_t *dict);
+static LIBDIVIDE_INLINE void libdivide_s32_branchfree_dict_do_array(const int32_t *numers,
+    const uint8_t *codes, int32_t *quots, size_t count,
+    const struct libdivide_s32_branchfree_dict_t *dict);
+static LIBDIVIDE_INLINE void libdivide_u64_branchfree_dict_do_array(const uint64_t *numers,
+    const uint8_t *codes, uint64_t *quots, size_t count,
+    const struct libdivide_u64_branchfree_dict_t *dict);
+static LIBDIVIDE_INLINE void libdivide_s64_branchfree_dict_do_array(const int64_t *numers,
+    const uint8_t *codes, int64_t *quots, size_t count,
+    const struct libdivide_s64_branchfree_dict_t *dict);
+
 //////// Internal Utility Functions
 
+static LIBDIVIDE_INLINE uint8_t libdivide_mullhi_u8(uint8_t x, uint8_t y) {
+    uint16_t xl = x, yl = y;
+    uint16_t rl = (uint16_t)(xl * yl);
+    return (uint8_t)(rl >> 8);
+}
+
+static LIBDIVIDE_INLINE int8_t libdivide_mullhi_s8(int8_t x, int8_t y) {
+    int16_t xl = x, yl = y;
+    int16_t rl = (int16_t)(xl * yl);
+    // needs to be arithmetic shift
+    return (int8_t)(rl >> 8);
+}
+
 static LIBDIVIDE_INLINE uint16_t libdivide_mullhi_u16(uint16_t x, uint16_t y) {
     uint32_t xl = x, yl = y;
     uint32_t rl = xl * yl;
@@ -459,6 +1627,34 @@ static LIBDIVIDE_INLINE int64_t libdivide_mullhi_s64(int64_t x, int64_t y) {
 #endif
 }
 
+#if defined(HAS_INT128_T)
+
+// High half of the 256-bit product, built from four 64x64->128 bit
+// multiplications (mul or mulx on x86-64).
+static LIBDIVIDE_INLINE __uint128_t libdivide_mullhi_u128(__uint128_t x, __uint128_t y) {
+    uint64_t x0 = (uint64_t)x, x1 = (uint64_t)(x >> 64);
+    uint64_t y0 = (uint64_t)y, y1 = (uint64_t)(y >> 64);
+    __uint128_t x0y0 = (__uint128_t)x0 * y0;
+    __uint128_t x0y1 = (__uint128_t)x0 * y1;
+    __uint128_t x1y0 = (__uint128_t)x1 * y0;
+    __uint128_t x1y1 = (__uint128_t)x1 * y1;
+    // At most 3 * (2^64 - 1), cannot overflow
+    __uint128_t mid = (x0y0 >> 64) + (uint64_t)x0y1 + (uint64_t)x1y0;
+    return x1y1 + (x0y1 >> 64) + (x1y0 >> 64) + (mid >> 64);
+}
+
+static LIBDIVIDE_INLINE __int128_t libdivide_mullhi_s128(__int128_t x, __int128_t y) {
+    // Signed high half from the unsigned one: subtract y if x < 0 and x
+    // if y < 0 (modulo 2^128).
+    __uint128_t p = libdivide_mullhi_u128((__uint128_t)x, (__uint128_t)y);
+    __uint128_t x_sign = (__uint128_t)(x >> 127);
+    __uint128_t y_sign = (__uint128_t)(y >> 127);
+    p -= (x_sign & (__uint128_t)y) + (y_sign & (__uint128_t)x);
+    return (__int128_t)p;
+}
+
+#endif
+
 static LIBDIVIDE_INLINE int16_t libdivide_count_leading_zeros16(uint16_t val) {
 #if defined(__AVR__)
     // Fast way to count leading zeros
@@ -483,6 +1679,10 @@ static LIBDIVIDE_INLINE int16_t libdivide_count_leading_zeros16(uint16_t val) {
 #endif
 }
 
+static LIBDIVIDE_INLINE int16_t libdivide_count_leading_zeros8(uint8_t val) {
+    return (int16_t)(libdivide_count_leading_zeros16(val) - 8);
+}
+
 static LIBDIVIDE_INLINE int32_t libdivide_count_leading_zeros32(uint32_t val) {
 #if defined(__AVR__)
     // Fast way to count leading zeros
@@ -518,6 +1718,25 @@ static LIBDIVIDE_INLINE int32_t libdivide_count_leading_zeros64(uint64_t val) {
 #endif
 }
 
+#if defined(HAS_INT128_T)
+static LIBDIVIDE_INLINE int32_t libdivide_count_leading_zeros128(__uint128_t val) {
+    uint64_t hi = (uint64_t)(val >> 64);
+    if (hi != 0) return libdivide_count_leading_zeros64(hi);
+    return 64 + libdivide_count_leading_zeros64((uint64_t)val);
+}
+#endif
+
+// libdivide_16_div_8_to_8: divides a 16-bit uint {u1, u0} by an 8-bit
+// uint {v}. The result must fit in 8 bits.
+// Returns the quotient directly and the remainder in *r
+static LIBDIVIDE_INLINE uint8_t libdivide_16_div_8_to_8(
+    uint8_t u1, uint8_t u0, uint8_t v, uint8_t *r) {
+    uint16_t n = (uint16_t)(((uint16_t)u1 << 8) | u0);
+    uint8_t result = (uint8_t)(n / v);
+    *r = (uint8_t)(n - result * (uint16_t)v);
+    return result;
+}
+
 // libdivide_32_div_16_to_16: divides a 32-bit uint {u1, u0} by a 16-bit
 // uint {v}. The result must fit in 16 bits.
 // Returns the quotient directly and the remainder in *r
@@ -771,16 +1990,50 @@ static LIBDIVIDE_INLINE uint64_t libdivide_128_div_128_to_64(
 #endif
 }
 
-////////// UINT16
+#if defined(HAS_INT128_T)
+
+// libdivide_256_div_129_to_128: divides a 256-bit uint {numhi, numlo} by the
+// 129-bit uint {den_hi, den_lo} where den_hi is 0 or 1. numhi must be less
+// than the divisor so that the quotient fits in 128 bits. Returns the
+// quotient and stores the (129-bit) remainder in {*r_hi, *r_lo}.
+// This only runs in the gen and recover functions, so a simple restoring
+// division is good enough (and avoids the slow 128-bit division routines).
+static LIBDIVIDE_INLINE __uint128_t libdivide_256_div_129_to_128(__uint128_t numhi,
+    __uint128_t numlo, int den_hi, __uint128_t den_lo, int *r_hi, __uint128_t *r_lo) {
+    // {rem_hi, rem_lo} is less than the divisor before shifting in the
+    // next bit, so rem_hi fits in 2 bits.
+    int rem_hi = 0;
+    __uint128_t rem_lo = numhi;
+    __uint128_t q = 0;
+    int i;
+    for (i = 0; i < 128; i++) {
+        rem_hi = (rem_hi << 1) | (int)(rem_lo >> 127);
+        rem_lo = (rem_lo << 1) | (numlo >> 127);
+        numlo <<= 1;
+        q <<= 1;
+        if (rem_hi > den_hi || (rem_hi == den_hi && rem_lo >= den_lo)) {
+            rem_hi -= den_hi + (rem_lo < den_lo);
+            rem_lo -= den_lo;
+            q |= 1;
+        }
+    }
+    *r_hi = rem_hi;
+    *r_lo = rem_lo;
+    return q;
+}
 
-static LIBDIVIDE_INLINE struct libdivide_u16_t libdivide_internal_u16_gen(
-    uint16_t d, int branchfree) {
+#endif
+
+////////// UINT8
+
+static LIBDIVIDE_INLINE struct libdivide_u8_t libdivide_internal_u8_gen(
+    uint8_t d, int branchfree) {
     if (d == 0) {
         LIBDIVIDE_ERROR("divider must be != 0");
     }
 
-    struct libdivide_u16_t result;
-    uint8_t floor_log_2_d = (uint8_t)(15 - libdivide_count_leading_zeros16(d));
+    struct libdivide_u8_t result;
+    uint8_t floor_log_2_d = (uint8_t)(7 - libdivide_count_leading_zeros8(d));
 
     // Power of 2
     if ((d & (d - 1)) == 0) {
@@ -792,28 +2045,28 @@ static LIBDIVIDE_INLINE struct libdivide_u16_t libdivide_internal_u16_gen(
         result.more = (uint8_t)(floor_log_2_d - (branchfree != 0));
     } else {
         uint8_t more;
-        uint16_t rem, proposed_m;
-        proposed_m = libdivide_32_div_16_to_16((uint16_t)1 << floor_log_2_d, 0, d, &rem);
+        uint8_t rem, proposed_m;
+        proposed_m = libdivide_16_div_8_to_8((uint8_t)(1 << floor_log_2_d), 0, d, &rem);
 
         LIBDIVIDE_ASSERT(rem > 0 && rem < d);
-        const uint16_t e = d - rem;
+        const uint8_t e = (uint8_t)(d - rem);
 
         // This power works if e < 2**floor_log_2_d.
-        if (!branchfree && (e < ((uint16_t)1 << floor_log_2_d))) {
+        if (!branchfree && (e < (1 << floor_log_2_d))) {
             // This power works
             more = floor_log_2_d;
         } else {
-            // We have to use the general 17-bit algorithm.  We need to compute
+            // We have to use the general 9-bit algorithm.  We need to compute
             // (2**power) / d. However, we already have (2**(power-1))/d and
             // its remainder.  By doubling both, and then correcting the
             // remainder, we can compute the larger division.
             // don't care about overflow here - in fact, we expect it
-            proposed_m += proposed_m;
-            const uint16_t twice_rem = rem + rem;
+            proposed_m = (uint8_t)(proposed_m + proposed_m);
+            const uint8_t twice_rem = (uint8_t)(rem + rem);
             if (twice_rem >= d || twice_rem < rem) proposed_m += 1;
             more = floor_log_2_d | LIBDIVIDE_ADD_MARKER;
         }
-        result.magic = 1 + proposed_m;
+        result.magic = (uint8_t)(1 + proposed_m);
         result.more = more;
         // result.more's shift should in general be ceil_log_2_d. But if we
         // used the smaller power, we subtract one from the shift because we're
@@ -824,69 +2077,264 @@ static LIBDIVIDE_INLINE struct libdivide_u16_t libdivide_internal_u16_gen(
     return result;
 }
 
-static LIBDIVIDE_INLINE struct libdivide_u16_t libdivide_u16_gen(uint16_t d) {
-    return libdivide_internal_u16_gen(d, 0);
+static LIBDIVIDE_INLINE struct libdivide_u8_t libdivide_u8_gen(uint8_t d) {
+    return libdivide_internal_u8_gen(d, 0);
 }
 
-static LIBDIVIDE_INLINE struct libdivide_u16_branchfree_t libdivide_u16_branchfree_gen(uint16_t d) {
+static LIBDIVIDE_INLINE struct libdivide_u8_branchfree_t libdivide_u8_branchfree_gen(uint8_t d) {
     if (d == 1) {
         LIBDIVIDE_ERROR("branchfree divider must be != 1");
     }
-    struct libdivide_u16_t tmp = libdivide_internal_u16_gen(d, 1);
-    struct libdivide_u16_branchfree_t ret = {
-        tmp.magic, (uint8_t)(tmp.more & LIBDIVIDE_16_SHIFT_MASK)};
+    struct libdivide_u8_t tmp = libdivide_internal_u8_gen(d, 1);
+    struct libdivide_u8_branchfree_t ret = {
+        tmp.magic, (uint8_t)(tmp.more & LIBDIVIDE_8_SHIFT_MASK)};
     return ret;
 }
 
-// The original libdivide_u16_do takes a const pointer. However, this cannot be used
-// with a compile time constant libdivide_u16_t: it will generate a warning about
+// The original libdivide_u8_do takes a const pointer. However, this cannot be used
+// with a compile time constant libdivide_u8_t: it will generate a warning about
 // taking the address of a temporary. Hence this overload.
-static LIBDIVIDE_INLINE uint16_t libdivide_u16_do_raw(uint16_t numer, uint16_t magic, uint8_t more) {
+static LIBDIVIDE_INLINE uint8_t libdivide_u8_do_raw(uint8_t numer, uint8_t magic, uint8_t more) {
     if (!magic) {
-        return numer >> more;
+        return (uint8_t)(numer >> more);
     } else {
-        uint16_t q = libdivide_mullhi_u16(numer, magic);
+        uint8_t q = libdivide_mullhi_u8(numer, magic);
         if (more & LIBDIVIDE_ADD_MARKER) {
-            uint16_t t = ((numer - q) >> 1) + q;
-            return t >> (more & LIBDIVIDE_16_SHIFT_MASK);
+            uint8_t t = (uint8_t)(((numer - q) >> 1) + q);
+            return (uint8_t)(t >> (more & LIBDIVIDE_8_SHIFT_MASK));
         } else {
             // All upper bits are 0,
             // don't need to mask them off.
-            return q >> more;
+            return (uint8_t)(q >> more);
         }
     }
 }
 
-static LIBDIVIDE_INLINE uint16_t libdivide_u16_do(uint16_t numer, const struct libdivide_u16_t *denom) {
-    return libdivide_u16_do_raw(numer, denom->magic, denom->more);
+static LIBDIVIDE_INLINE uint8_t libdivide_u8_do(uint8_t numer, const struct libdivide_u8_t *denom) {
+    return libdivide_u8_do_raw(numer, denom->magic, denom->more);
 }
 
-static LIBDIVIDE_INLINE uint16_t libdivide_u16_branchfree_do(
-    uint16_t numer, const struct libdivide_u16_branchfree_t *denom) {
-    uint16_t q = libdivide_mullhi_u16(numer, denom->magic);
-    uint16_t t = ((numer - q) >> 1) + q;
-    return t >> denom->more;
+static LIBDIVIDE_INLINE uint8_t libdivide_u8_branchfree_do(
+    uint8_t numer, const struct libdivide_u8_branchfree_t *denom) {
+    uint8_t q = libdivide_mullhi_u8(numer, denom->magic);
+    uint8_t t = (uint8_t)(((numer - q) >> 1) + q);
+    return (uint8_t)(t >> denom->more);
 }
 
-static LIBDIVIDE_INLINE uint16_t libdivide_u16_recover(const struct libdivide_u16_t *denom) {
+static LIBDIVIDE_INLINE uint8_t libdivide_u8_recover(const struct libdivide_u8_t *denom) {
     uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+    uint8_t shift = more & LIBDIVIDE_8_SHIFT_MASK;
 
     if (!denom->magic) {
-        return (uint16_t)1 << shift;
+        return (uint8_t)(1 << shift);
     } else if (!(more & LIBDIVIDE_ADD_MARKER)) {
-        // We compute q = n/d = n*m / 2^(16 + shift)
-        // Therefore we have d = 2^(16 + shift) / m
+        // We compute q = n/d = n*m / 2^(8 + shift)
+        // Therefore we have d = 2^(8 + shift) / m
         // We need to ceil it.
         // We know d is not a power of 2, so m is not a power of 2,
         // so we can just add 1 to the floor
-        uint16_t hi_dividend = (uint16_t)1 << shift;
-        uint16_t rem_ignored;
-        return 1 + libdivide_32_div_16_to_16(hi_dividend, 0, denom->magic, &rem_ignored);
+        uint8_t hi_dividend = (uint8_t)(1 << shift);
+        uint8_t rem_ignored;
+        return (uint8_t)(1 + libdivide_16_div_8_to_8(hi_dividend, 0, denom->magic, &rem_ignored));
     } else {
-        // Here we wish to compute d = 2^(16+shift+1)/(m+2^16).
-        // Notice (m + 2^16) is a 17 bit number. Use 32 bit division for now
-        // Also note that shift may be as high as 15, so shift + 1 will
+        // Here we wish to compute d = 2^(8+shift+1)/(m+2^8).
+        // Notice (m + 2^8) is a 9 bit number. Use 16 bit division for now
+        // Also note that shift may be as high as 7, so shift + 1 will
+        // overflow. So we have to compute it as 2^(8+shift)/(m+2^8), and
+        // then double the quotient and remainder.
+        uint16_t half_n = (uint16_t)(1 << (8 + shift));
+        uint16_t d = (uint16_t)((1 << 8) | denom->magic);
+        // Note that the quotient is guaranteed <= 8 bits, but the remainder
+        // may need 9!
+        uint8_t half_q = (uint8_t)(half_n / d);
+        uint16_t rem = half_n % d;
+        // We computed 2^(8+shift)/(m+2^8)
+        // Need to double it, and then add 1 to the quotient if doubling th
+        // remainder would increase the quotient.
+        // Note that rem<<1 cannot overflow, since rem < d and d is 9 bits
+        uint8_t full_q = (uint8_t)(half_q + half_q + ((rem << 1) >= d));
+
+        // We rounded down in gen (hence +1)
+        return (uint8_t)(full_q + 1);
+    }
+}
+
+static LIBDIVIDE_INLINE uint8_t libdivide_u8_branchfree_recover(const struct libdivide_u8_branchfree_t *denom) {
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_8_SHIFT_MASK;
+
+    if (!denom->magic) {
+        return (uint8_t)(1 << (shift + 1));
+    } else {
+        // Here we wish to compute d = 2^(8+shift+1)/(m+2^8).
+        // Notice (m + 2^8) is a 9 bit number. Use 16 bit division for now
+        // Also note that shift may be as high as 7, so shift + 1 will
+        // overflow. So we have to compute it as 2^(8+shift)/(m+2^8), and
+        // then double the quotient and remainder.
+        uint16_t half_n = (uint16_t)(1 << (8 + shift));
+        uint16_t d = (uint16_t)((1 << 8) | denom->magic);
+        // Note that the quotient is guaranteed <= 8 bits, but the remainder
+        // may need 9!
+        uint8_t half_q = (uint8_t)(half_n / d);
+        uint16_t rem = half_n % d;
+        // We computed 2^(8+shift)/(m+2^8)
+        // Need to double it, and then add 1 to the quotient if doubling th
+        // remainder would increase the quotient.
+        // Note that rem<<1 cannot overflow, since rem < d and d is 9 bits
+        uint8_t full_q = (uint8_t)(half_q + half_q + ((rem << 1) >= d));
+
+        // We rounded down in gen (hence +1)
+        return (uint8_t)(full_q + 1);
+    }
+}
+
+////////// UINT16
+
+static LIBDIVIDE_INLINE struct libdivide_u16_t libdivide_internal_u16_gen(
+    uint16_t d, int branchfree) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+
+    struct libdivide_u16_t result;
+    uint8_t floor_log_2_d = (uint8_t)(15 - libdivide_count_leading_zeros16(d));
+
+    // Power of 2
+    if ((d & (d - 1)) == 0) {
+        // We need to subtract 1 from the shift value in case of an unsigned
+        // branchfree divider because there is a hardcoded right shift by 1
+        // in its division algorithm. Because of this we also need to add back
+        // 1 in its recovery algorithm.
+        result.magic = 0;
+        result.more = (uint8_t)(floor_log_2_d - (branchfree != 0));
+    } else {
+        uint8_t more;
+        uint16_t rem, proposed_m;
+        proposed_m = libdivide_32_div_16_to_16((uint16_t)1 << floor_log_2_d, 0, d, &rem);
+
+        LIBDIVIDE_ASSERT(rem > 0 && rem < d);
+        const uint16_t e = d - rem;
+
+        // This power works if e < 2**floor_log_2_d.
+        if (!branchfree && (e < ((uint16_t)1 << floor_log_2_d))) {
+            // This power works
+            more = floor_log_2_d;
+        } else {
+            // We have to use the general 17-bit algorithm.  We need to compute
+            // (2**power) / d. However, we already have (2**(power-1))/d and
+            // its remainder.  By doubling both, and then correcting the
+            // remainder, we can compute the larger division.
+            // don't care about overflow here - in fact, we expect it
+            proposed_m += proposed_m;
+            const uint16_t twice_rem = rem + rem;
+            if (twice_rem >= d || twice_rem < rem) proposed_m += 1;
+            more = floor_log_2_d | LIBDIVIDE_ADD_MARKER;
+        }
+        result.magic = 1 + proposed_m;
+        result.more = more;
+        // result.more's shift should in general be ceil_log_2_d. But if we
+        // used the smaller power, we subtract one from the shift because we're
+        // using the smaller power. If we're using the larger power, we
+        // subtract one from the shift because it's taken care of by the add
+        // indicator. So floor_log_2_d happens to be correct in both cases.
+    }
+    return result;
+}
+
+static LIBDIVIDE_INLINE struct libdivide_u16_t libdivide_u16_gen(uint16_t d) {
+    return libdivide_internal_u16_gen(d, 0);
+}
+
+static LIBDIVIDE_INLINE struct libdivide_u16_branchfree_t libdivide_u16_branchfree_gen(uint16_t d) {
+    if (d == 1) {
+        LIBDIVIDE_ERROR("branchfree divider must be != 1");
+    }
+    struct libdivide_u16_t tmp = libdivide_internal_u16_gen(d, 1);
+    struct libdivide_u16_branchfree_t ret = {
+        tmp.magic, (uint8_t)(tmp.more & LIBDIVIDE_16_SHIFT_MASK)};
+    return ret;
+}
+
+static LIBDIVIDE_INLINE struct libdivide_u16_t libdivide_u16_gen_bounded(
+    uint16_t d, uint16_t max_numer) {
+    struct libdivide_u16_t result = libdivide_internal_u16_gen(d, 0);
+    if (result.more & LIBDIVIDE_ADD_MARKER) {
+        // See libdivide_u32_gen_bounded()
+        uint8_t floor_log_2_d = result.more & LIBDIVIDE_16_SHIFT_MASK;
+        uint16_t rem;
+        uint16_t proposed_m = libdivide_32_div_16_to_16((uint16_t)1 << floor_log_2_d, 0, d, &rem);
+        uint32_t bound = max_numer > d ? max_numer : d;
+        if (bound * (uint32_t)(d - rem) < ((uint32_t)1 << (16 + floor_log_2_d))) {
+            result.magic = 1 + proposed_m;
+            result.more = floor_log_2_d;
+        }
+    }
+    LIBDIVIDE_ASSERT(libdivide_u16_do(max_numer, &result) == max_numer / d);
+    return result;
+}
+
+// The "round down" alternative to the add marker path, see
+// doc/divide_by_constants_codegen_reference.c. If a divisor needs the add
+// marker, then r = 2^(16 + shift) % d is < 2^shift, so the rounded down
+// magic m_down = floor(2^(16 + shift) / d) is exact in the form
+// q = ((n + 1) * m_down) >> (16 + shift) for all 16-bit n. The add marker
+// magic is 2 * m_down + 1 - 2^16, we recover m_down with a shift instead of
+// storing a second magic number. (n + 1) * m_down = n * m_down + m_down
+// doesn't overflow in 32 bits. Vector code may use a saturating increment
+// instead: n = 2^16 - 1 is never a multiple of these divisors, because the
+// divisors of 2^16 - 1 don't need the add marker. The kernels use whichever
+// sequence was faster in test/benchmark_round_down.cpp.
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_round_down_magic(uint16_t magic) {
+    return (uint16_t)((magic >> 1) | (1U << 15));
+}
+
+// The original libdivide_u16_do takes a const pointer. However, this cannot be used
+// with a compile time constant libdivide_u16_t: it will generate a warning about
+// taking the address of a temporary. Hence this overload.
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_do_raw(uint16_t numer, uint16_t magic, uint8_t more) {
+    if (!magic) {
+        return numer >> more;
+    } else if (more & LIBDIVIDE_ADD_MARKER) {
+        uint32_t m_down = libdivide_u16_round_down_magic(magic);
+        return (uint16_t)(((uint32_t)numer * m_down + m_down) >>
+                          (16 + (more & LIBDIVIDE_16_SHIFT_MASK)));
+    } else {
+        // All upper bits are 0,
+        // don't need to mask them off.
+        return libdivide_mullhi_u16(numer, magic) >> more;
+    }
+}
+
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_do(uint16_t numer, const struct libdivide_u16_t *denom) {
+    return libdivide_u16_do_raw(numer, denom->magic, denom->more);
+}
+
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_branchfree_do(
+    uint16_t numer, const struct libdivide_u16_branchfree_t *denom) {
+    uint16_t q = libdivide_mullhi_u16(numer, denom->magic);
+    uint16_t t = ((numer - q) >> 1) + q;
+    return t >> denom->more;
+}
+
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_recover(const struct libdivide_u16_t *denom) {
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+
+    if (!denom->magic) {
+        return (uint16_t)1 << shift;
+    } else if (!(more & LIBDIVIDE_ADD_MARKER)) {
+        // We compute q = n/d = n*m / 2^(16 + shift)
+        // Therefore we have d = 2^(16 + shift) / m
+        // We need to ceil it.
+        // We know d is not a power of 2, so m is not a power of 2,
+        // so we can just add 1 to the floor
+        uint16_t hi_dividend = (uint16_t)1 << shift;
+        uint16_t rem_ignored;
+        return 1 + libdivide_32_div_16_to_16(hi_dividend, 0, denom->magic, &rem_ignored);
+    } else {
+        // Here we wish to compute d = 2^(16+shift+1)/(m+2^16).
+        // Notice (m + 2^16) is a 17 bit number. Use 32 bit division for now
+        // Also note that shift may be as high as 15, so shift + 1 will
         // overflow. So we have to compute it as 2^(16+shift)/(m+2^16), and
         // then double the quotient and remainder.
         uint32_t half_n = (uint32_t)1 << (16 + shift);
@@ -1002,19 +2450,48 @@ static LIBDIVIDE_INLINE struct libdivide_u32_branchfree_t libdivide_u32_branchfr
     return ret;
 }
 
+// Generates a divider that is only exact for numerators <= max_numer.
+// libdivide_internal_u32_gen() uses the 32-bit magic
+// m = ceil(2^(32 + floor_log_2_d) / d) only if it is exact for all
+// numerators. With the error e = m * d - 2^(32 + floor_log_2_d) we have
+// n * m / 2^(32 + floor_log_2_d) = n / d + n * e / (d * 2^(32 + floor_log_2_d)),
+// so the quotient is exact as long as n * e < 2^(32 + floor_log_2_d). For
+// small numerators this holds for many divisors that otherwise need the
+// slower add marker path. The bound is raised to d so that
+// libdivide_u32_recover() still works.
+static LIBDIVIDE_INLINE struct libdivide_u32_t libdivide_u32_gen_bounded(
+    uint32_t d, uint32_t max_numer) {
+    struct libdivide_u32_t result = libdivide_internal_u32_gen(d, 0);
+    if (result.more & LIBDIVIDE_ADD_MARKER) {
+        uint8_t floor_log_2_d = result.more & LIBDIVIDE_32_SHIFT_MASK;
+        uint32_t rem;
+        uint32_t proposed_m = libdivide_64_div_32_to_32((uint32_t)1 << floor_log_2_d, 0, d, &rem);
+        uint64_t bound = max_numer > d ? max_numer : d;
+        if (bound * (d - rem) < ((uint64_t)1 << (32 + floor_log_2_d))) {
+            result.magic = 1 + proposed_m;
+            result.more = floor_log_2_d;
+        }
+    }
+    LIBDIVIDE_ASSERT(libdivide_u32_do(max_numer, &result) == max_numer / d);
+    return result;
+}
+
+// See libdivide_u16_round_down_magic()
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_round_down_magic(uint32_t magic) {
+    return (magic >> 1) | ((uint32_t)1 << 31);
+}
+
 static LIBDIVIDE_INLINE uint32_t libdivide_u32_do_raw(uint32_t numer, uint32_t magic, uint8_t more) {
     if (!magic) {
         return numer >> more;
+    } else if (more & LIBDIVIDE_ADD_MARKER) {
+        uint64_t m_down = libdivide_u32_round_down_magic(magic);
+        return (uint32_t)(((uint64_t)numer * m_down + m_down) >>
+                          (32 + (more & LIBDIVIDE_32_SHIFT_MASK)));
     } else {
-        uint32_t q = libdivide_mullhi_u32(numer, magic);
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            uint32_t t = ((numer - q) >> 1) + q;
-            return t >> (more & LIBDIVIDE_32_SHIFT_MASK);
-        } else {
-            // All upper bits are 0,
-            // don't need to mask them off.
-            return q >> more;
-        }
+        // All upper bits are 0,
+        // don't need to mask them off.
+        return libdivide_mullhi_u32(numer, magic) >> more;
     }
 }
 
@@ -1165,6 +2642,48 @@ static LIBDIVIDE_INLINE struct libdivide_u64_branchfree_t libdivide_u64_branchfr
     return ret;
 }
 
+// See libdivide_u32_gen_bounded(). Additionally, if all numerators are
+// < 2^32 and m = ceil(2^(32 + floor_log_2_d) / d) is exact for them, the
+// divider uses the magic m * 2^32 and sets LIBDIVIDE_NARROW_MARKER. The
+// scalar code divides as usual, the x86 vector code only needs a single
+// 32 x 32 -> 64 bit multiplication (_mm256_mul_epu32() etc.) per quotient
+// instead of the emulated 64-bit high multiplication.
+static LIBDIVIDE_INLINE struct libdivide_u64_t libdivide_u64_gen_bounded(
+    uint64_t d, uint64_t max_numer) {
+    struct libdivide_u64_t result = libdivide_internal_u64_gen(d, 0);
+    uint64_t bound = max_numer > d ? max_numer : d;
+    if (result.magic != 0 && (bound >> 32) == 0) {
+        // d < 2^32, so m < 2^32 and floor_log_2_d <= 31
+        uint8_t floor_log_2_d = result.more & LIBDIVIDE_64_SHIFT_MASK;
+        uint64_t dividend = (uint64_t)1 << (32 + floor_log_2_d);
+        uint64_t m = dividend / d + 1;
+        if (bound * (m * d - dividend) < dividend) {
+            result.magic = m << 32;
+            result.more = (uint8_t)(floor_log_2_d | LIBDIVIDE_NARROW_MARKER);
+        }
+    }
+    if (result.more & LIBDIVIDE_ADD_MARKER) {
+        uint8_t floor_log_2_d = result.more & LIBDIVIDE_64_SHIFT_MASK;
+        uint64_t rem;
+        uint64_t proposed_m =
+            libdivide_128_div_64_to_64((uint64_t)1 << floor_log_2_d, 0, d, &rem);
+        uint64_t e = d - rem;
+        // bound * e < 2^(64 + floor_log_2_d)
+        if ((libdivide_mullhi_u64(bound, e) >> floor_log_2_d) == 0) {
+            result.magic = 1 + proposed_m;
+            result.more = floor_log_2_d;
+        }
+    }
+    LIBDIVIDE_ASSERT(libdivide_u64_do(max_numer, &result) == max_numer / d);
+    return result;
+}
+
+// See libdivide_u16_round_down_magic(). The scalar 64-bit division keeps the
+// add marker sequence, which is faster than the 128-bit n * m_down + m_down.
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_round_down_magic(uint64_t magic) {
+    return (magic >> 1) | ((uint64_t)1 << 63);
+}
+
 static LIBDIVIDE_INLINE uint64_t libdivide_u64_do_raw(uint64_t numer, uint64_t magic, uint8_t more) {
    if (!magic) {
         return numer >> more;
@@ -1174,9 +2693,10 @@ static LIBDIVIDE_INLINE uint64_t libdivide_u64_do_raw(uint64_t numer, uint64_t m
             uint64_t t = ((numer - q) >> 1) + q;
             return t >> (more & LIBDIVIDE_64_SHIFT_MASK);
         } else {
-            // All upper bits are 0,
-            // don't need to mask them off.
-            return q >> more;
+            // Mask off LIBDIVIDE_NARROW_MARKER, the narrow magic
+            // m * 2^32 divides like any other magic.
+            LIBDIVIDE_ASSERT(!(more & LIBDIVIDE_NARROW_MARKER) || (numer >> 32) == 0);
+            return q >> (more & LIBDIVIDE_64_SHIFT_MASK);
         }
     }
 }
@@ -1271,15 +2791,15 @@ static LIBDIVIDE_INLINE uint64_t libdivide_u64_branchfree_recover(const struct l
     }
 }
 
-////////// SINT16
+////////// SINT8
 
-static LIBDIVIDE_INLINE struct libdivide_s16_t libdivide_internal_s16_gen(
-    int16_t d, int branchfree) {
+static LIBDIVIDE_INLINE struct libdivide_s8_t libdivide_internal_s8_gen(
+    int8_t d, int branchfree) {
     if (d == 0) {
         LIBDIVIDE_ERROR("divider must be != 0");
     }
 
-    struct libdivide_s16_t result;
+    struct libdivide_s8_t result;
 
     // If d is a power of 2, or negative a power of 2, we have to use a shift.
     // This is especially important because the magic algorithm fails for -1.
@@ -1287,9 +2807,9 @@ static LIBDIVIDE_INLINE struct libdivide_s16_t libdivide_internal_s16_gen(
     // whether its absolute value has exactly one bit set. This works even for
     // INT_MIN, because abs(INT_MIN) == INT_MIN, and INT_MIN has one bit set
     // and is a power of 2.
-    uint16_t ud = (uint16_t)d;
-    uint16_t absD = (d < 0) ? -ud : ud;
-    uint16_t floor_log_2_d = 15 - libdivide_count_leading_zeros16(absD);
+    uint8_t ud = (uint8_t)d;
+    uint8_t absD = (uint8_t)((d < 0) ? -ud : ud);
+    uint8_t floor_log_2_d = (uint8_t)(7 - libdivide_count_leading_zeros8(absD));
     // check if exactly one bit is set,
     // don't care if absD is 0 since that's divide by zero
     if ((absD & (absD - 1)) == 0) {
@@ -1300,36 +2820,36 @@ static LIBDIVIDE_INLINE struct libdivide_s16_t libdivide_internal_s16_gen(
         LIBDIVIDE_ASSERT(floor_log_2_d >= 1);
 
         uint8_t more;
-        // the dividend here is 2**(floor_log_2_d + 31), so the low 16 bit word
+        // the dividend here is 2**(floor_log_2_d + 7), so the low 8 bit word
         // is 0 and the high word is floor_log_2_d - 1
-        uint16_t rem, proposed_m;
-        proposed_m = libdivide_32_div_16_to_16((uint16_t)1 << (floor_log_2_d - 1), 0, absD, &rem);
-        const uint16_t e = absD - rem;
+        uint8_t rem, proposed_m;
+        proposed_m = libdivide_16_div_8_to_8((uint8_t)(1 << (floor_log_2_d - 1)), 0, absD, &rem);
+        const uint8_t e = (uint8_t)(absD - rem);
 
         // We are going to start with a power of floor_log_2_d - 1.
         // This works if works if e < 2**floor_log_2_d.
-        if (!branchfree && e < ((uint16_t)1 << floor_log_2_d)) {
+        if (!branchfree && e < (1 << floor_log_2_d)) {
             // This power works
             more = (uint8_t)(floor_log_2_d - 1);
         } else {
             // We need to go one higher. This should not make proposed_m
             // overflow, but it will make it negative when interpreted as an
-            // int16_t.
-            proposed_m += proposed_m;
-            const uint16_t twice_rem = rem + rem;
+            // int8_t.
+            proposed_m = (uint8_t)(proposed_m + proposed_m);
+            const uint8_t twice_rem = (uint8_t)(rem + rem);
             if (twice_rem >= absD || twice_rem < rem) proposed_m += 1;
             more = (uint8_t)(floor_log_2_d | LIBDIVIDE_ADD_MARKER);
         }
 
         proposed_m += 1;
-        int16_t magic = (int16_t)proposed_m;
+        int8_t magic = (int8_t)proposed_m;
 
         // Mark if we are negative. Note we only negate the magic number in the
         // branchfull case.
         if (d < 0) {
             more |= LIBDIVIDE_NEGATIVE_DIVISOR;
             if (!branchfree) {
-                magic = -magic;
+                magic = (int8_t)-magic;
             }
         }
 
@@ -1339,83 +2859,82 @@ static LIBDIVIDE_INLINE struct libdivide_s16_t libdivide_internal_s16_gen(
     return result;
 }
 
-static LIBDIVIDE_INLINE struct libdivide_s16_t libdivide_s16_gen(int16_t d) {
-    return libdivide_internal_s16_gen(d, 0);
+static LIBDIVIDE_INLINE struct libdivide_s8_t libdivide_s8_gen(int8_t d) {
+    return libdivide_internal_s8_gen(d, 0);
 }
 
-static LIBDIVIDE_INLINE struct libdivide_s16_branchfree_t libdivide_s16_branchfree_gen(int16_t d) {
-    struct libdivide_s16_t tmp = libdivide_internal_s16_gen(d, 1);
-    struct libdivide_s16_branchfree_t result = {tmp.magic, tmp.more};
+static LIBDIVIDE_INLINE struct libdivide_s8_branchfree_t libdivide_s8_branchfree_gen(int8_t d) {
+    struct libdivide_s8_t tmp = libdivide_internal_s8_gen(d, 1);
+    struct libdivide_s8_branchfree_t result = {tmp.magic, tmp.more};
     return result;
 }
 
-// The original libdivide_s16_do takes a const pointer. However, this cannot be used
-// with a compile time constant libdivide_s16_t: it will generate a warning about
+// The original libdivide_s8_do takes a const pointer. However, this cannot be used
+// with a compile time constant libdivide_s8_t: it will generate a warning about
 // taking the address of a temporary. Hence this overload.
-static LIBDIVIDE_INLINE int16_t libdivide_s16_do_raw(int16_t numer, int16_t magic, uint8_t more) {
-    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+static LIBDIVIDE_INLINE int8_t libdivide_s8_do_raw(int8_t numer, int8_t magic, uint8_t more) {
+    uint8_t shift = more & LIBDIVIDE_8_SHIFT_MASK;
 
     if (!magic) {
-        uint16_t sign = (int8_t)more >> 7;
-        uint16_t mask = ((uint16_t)1 << shift) - 1;
-        uint16_t uq = numer + ((numer >> 15) & mask);
-        int16_t q = (int16_t)uq;
-        q >>= shift;
-        q = (q ^ sign) - sign;
+        int8_t sign = (int8_t)((int8_t)more >> 7);
+        uint8_t mask = (uint8_t)((1 << shift) - 1);
+        uint8_t uq = (uint8_t)(numer + ((numer >> 7) & mask));
+        int8_t q = (int8_t)uq;
+        q = (int8_t)(q >> shift);
+        q = (int8_t)((q ^ sign) - sign);
         return q;
     } else {
-        uint16_t uq = (uint16_t)libdivide_mullhi_s16(numer, magic);
+        uint8_t uq = (uint8_t)libdivide_mullhi_s8(numer, magic);
         if (more & LIBDIVIDE_ADD_MARKER) {
             // must be arithmetic shift and then sign extend
-            int16_t sign = (int8_t)more >> 7;
+            int8_t sign = (int8_t)((int8_t)more >> 7);
             // q += (more < 0 ? -numer : numer)
             // cast required to avoid UB
-            uq += ((uint16_t)numer ^ sign) - sign;
+            uq = (uint8_t)(uq + ((numer ^ sign) - sign));
         }
-        int16_t q = (int16_t)uq;
-        q >>= shift;
-        q += (q < 0);
+        int8_t q = (int8_t)uq;
+        q = (int8_t)(q >> shift);
+        q = (int8_t)(q + (q < 0));
         return q;
     }
 }
 
-static LIBDIVIDE_INLINE int16_t libdivide_s16_do(int16_t numer, const struct libdivide_s16_t *denom) {
-    return libdivide_s16_do_raw(numer, denom->magic, denom->more);
+static LIBDIVIDE_INLINE int8_t libdivide_s8_do(int8_t numer, const struct libdivide_s8_t *denom) {
+    return libdivide_s8_do_raw(numer, denom->magic, denom->more);
 }
 
-static LIBDIVIDE_INLINE int16_t libdivide_s16_branchfree_do(int16_t numer, const struct libdivide_s16_branchfree_t *denom) {
+static LIBDIVIDE_INLINE int8_t libdivide_s8_branchfree_do(int8_t numer, const struct libdivide_s8_branchfree_t *denom) {
     uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+    uint8_t shift = more & LIBDIVIDE_8_SHIFT_MASK;
     // must be arithmetic shift and then sign extend
-    int16_t sign = (int8_t)more >> 7;
-    int16_t magic = denom->magic;
-    int16_t q = libdivide_mullhi_s16(numer, magic);
-    q += numer;
+    int8_t sign = (int8_t)((int8_t)more >> 7);
+    int8_t magic = denom->magic;
+    int8_t q = (int8_t)(libdivide_mullhi_s8(numer, magic) + numer);
 
     // If q is non-negative, we have nothing to do
     // If q is negative, we want to add either (2**shift)-1 if d is a power of
     // 2, or (2**shift) if it is not a power of 2
-    uint16_t is_power_of_2 = (magic == 0);
-    uint16_t q_sign = (uint16_t)(q >> 15);
-    q += q_sign & (((uint16_t)1 << shift) - is_power_of_2);
+    uint8_t is_power_of_2 = (magic == 0);
+    uint8_t q_sign = (uint8_t)(q >> 7);
+    q = (int8_t)(q + (q_sign & ((1 << shift) - is_power_of_2)));
 
     // Now arithmetic right shift
-    q >>= shift;
+    q = (int8_t)(q >> shift);
     // Negate if needed
-    q = (q ^ sign) - sign;
+    q = (int8_t)((q ^ sign) - sign);
 
     return q;
 }
 
-static LIBDIVIDE_INLINE int16_t libdivide_s16_recover(const struct libdivide_s16_t *denom) {
+static LIBDIVIDE_INLINE int8_t libdivide_s8_recover(const struct libdivide_s8_t *denom) {
     uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+    uint8_t shift = more & LIBDIVIDE_8_SHIFT_MASK;
     if (!denom->magic) {
-        uint16_t absD = (uint16_t)1 << shift;
+        uint8_t absD = (uint8_t)(1 << shift);
         if (more & LIBDIVIDE_NEGATIVE_DIVISOR) {
-            absD = -absD;
+            absD = (uint8_t)-absD;
         }
-        return (int16_t)absD;
+        return (int8_t)absD;
     } else {
         // Unsigned math is much easier
         // We negate the magic number only in the branchfull case, and we don't
@@ -1427,35 +2946,28 @@ static LIBDIVIDE_INLINE int16_t libdivide_s16_recover(const struct libdivide_s16
         int negative_divisor = (more & LIBDIVIDE_NEGATIVE_DIVISOR);
         int magic_was_negated = (more & LIBDIVIDE_ADD_MARKER) ? denom->magic > 0 : denom->magic < 0;
 
-        // Handle the power of 2 case (including branchfree)
-        if (denom->magic == 0) {
-            int16_t result = (uint16_t)1 << shift;
-            return negative_divisor ? -result : result;
-        }
-
-        uint16_t d = (uint16_t)(magic_was_negated ? -denom->magic : denom->magic);
-        uint32_t n = (uint32_t)1 << (16 + shift);  // this shift cannot exceed 30
-        uint16_t q = (uint16_t)(n / d);
-        int16_t result = (int16_t)q;
-        result += 1;
-        return negative_divisor ? -result : result;
+        uint8_t d = (uint8_t)(magic_was_negated ? -denom->magic : denom->magic);
+        uint16_t n = (uint16_t)(1 << (8 + shift));  // this shift cannot exceed 14
+        uint8_t q = (uint8_t)(n / d);
+        int8_t result = (int8_t)(q + 1);
+        return (int8_t)(negative_divisor ? -result : result);
     }
 }
 
-static LIBDIVIDE_INLINE int16_t libdivide_s16_branchfree_recover(const struct libdivide_s16_branchfree_t *denom) {
-    const struct libdivide_s16_t den = {denom->magic, denom->more};
-    return libdivide_s16_recover(&den);
+static LIBDIVIDE_INLINE int8_t libdivide_s8_branchfree_recover(const struct libdivide_s8_branchfree_t *denom) {
+    const struct libdivide_s8_t den = {denom->magic, denom->more};
+    return libdivide_s8_recover(&den);
 }
 
-////////// SINT32
+////////// SINT16
 
-static LIBDIVIDE_INLINE struct libdivide_s32_t libdivide_internal_s32_gen(
-    int32_t d, int branchfree) {
+static LIBDIVIDE_INLINE struct libdivide_s16_t libdivide_internal_s16_gen(
+    int16_t d, int branchfree) {
     if (d == 0) {
         LIBDIVIDE_ERROR("divider must be != 0");
     }
 
-    struct libdivide_s32_t result;
+    struct libdivide_s16_t result;
 
     // If d is a power of 2, or negative a power of 2, we have to use a shift.
     // This is especially important because the magic algorithm fails for -1.
@@ -1463,9 +2975,9 @@ static LIBDIVIDE_INLINE struct libdivide_s32_t libdivide_internal_s32_gen(
     // whether its absolute value has exactly one bit set. This works even for
     // INT_MIN, because abs(INT_MIN) == INT_MIN, and INT_MIN has one bit set
     // and is a power of 2.
-    uint32_t ud = (uint32_t)d;
-    uint32_t absD = (d < 0) ? -ud : ud;
-    uint32_t floor_log_2_d = 31 - libdivide_count_leading_zeros32(absD);
+    uint16_t ud = (uint16_t)d;
+    uint16_t absD = (d < 0) ? -ud : ud;
+    uint16_t floor_log_2_d = 15 - libdivide_count_leading_zeros16(absD);
     // check if exactly one bit is set,
     // don't care if absD is 0 since that's divide by zero
     if ((absD & (absD - 1)) == 0) {
@@ -1476,21 +2988,197 @@ static LIBDIVIDE_INLINE struct libdivide_s32_t libdivide_internal_s32_gen(
         LIBDIVIDE_ASSERT(floor_log_2_d >= 1);
 
         uint8_t more;
-        // the dividend here is 2**(floor_log_2_d + 31), so the low 32 bit word
+        // the dividend here is 2**(floor_log_2_d + 31), so the low 16 bit word
         // is 0 and the high word is floor_log_2_d - 1
-        uint32_t rem, proposed_m;
-        proposed_m = libdivide_64_div_32_to_32((uint32_t)1 << (floor_log_2_d - 1), 0, absD, &rem);
-        const uint32_t e = absD - rem;
+        uint16_t rem, proposed_m;
+        proposed_m = libdivide_32_div_16_to_16((uint16_t)1 << (floor_log_2_d - 1), 0, absD, &rem);
+        const uint16_t e = absD - rem;
 
         // We are going to start with a power of floor_log_2_d - 1.
         // This works if works if e < 2**floor_log_2_d.
-        if (!branchfree && e < ((uint32_t)1 << floor_log_2_d)) {
+        if (!branchfree && e < ((uint16_t)1 << floor_log_2_d)) {
             // This power works
             more = (uint8_t)(floor_log_2_d - 1);
         } else {
             // We need to go one higher. This should not make proposed_m
             // overflow, but it will make it negative when interpreted as an
-            // int32_t.
+            // int16_t.
+            proposed_m += proposed_m;
+            const uint16_t twice_rem = rem + rem;
+            if (twice_rem >= absD || twice_rem < rem) proposed_m += 1;
+            more = (uint8_t)(floor_log_2_d | LIBDIVIDE_ADD_MARKER);
+        }
+
+        proposed_m += 1;
+        int16_t magic = (int16_t)proposed_m;
+
+        // Mark if we are negative. Note we only negate the magic number in the
+        // branchfull case.
+        if (d < 0) {
+            more |= LIBDIVIDE_NEGATIVE_DIVISOR;
+            if (!branchfree) {
+                magic = -magic;
+            }
+        }
+
+        result.more = more;
+        result.magic = magic;
+    }
+    return result;
+}
+
+static LIBDIVIDE_INLINE struct libdivide_s16_t libdivide_s16_gen(int16_t d) {
+    return libdivide_internal_s16_gen(d, 0);
+}
+
+static LIBDIVIDE_INLINE struct libdivide_s16_branchfree_t libdivide_s16_branchfree_gen(int16_t d) {
+    struct libdivide_s16_t tmp = libdivide_internal_s16_gen(d, 1);
+    struct libdivide_s16_branchfree_t result = {tmp.magic, tmp.more};
+    return result;
+}
+
+// The original libdivide_s16_do takes a const pointer. However, this cannot be used
+// with a compile time constant libdivide_s16_t: it will generate a warning about
+// taking the address of a temporary. Hence this overload.
+static LIBDIVIDE_INLINE int16_t libdivide_s16_do_raw(int16_t numer, int16_t magic, uint8_t more) {
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+
+    if (!magic) {
+        uint16_t sign = (int8_t)more >> 7;
+        uint16_t mask = ((uint16_t)1 << shift) - 1;
+        uint16_t uq = numer + ((numer >> 15) & mask);
+        int16_t q = (int16_t)uq;
+        q >>= shift;
+        q = (q ^ sign) - sign;
+        return q;
+    } else {
+        uint16_t uq = (uint16_t)libdivide_mullhi_s16(numer, magic);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift and then sign extend
+            int16_t sign = (int8_t)more >> 7;
+            // q += (more < 0 ? -numer : numer)
+            // cast required to avoid UB
+            uq += ((uint16_t)numer ^ sign) - sign;
+        }
+        int16_t q = (int16_t)uq;
+        q >>= shift;
+        q += (q < 0);
+        return q;
+    }
+}
+
+static LIBDIVIDE_INLINE int16_t libdivide_s16_do(int16_t numer, const struct libdivide_s16_t *denom) {
+    return libdivide_s16_do_raw(numer, denom->magic, denom->more);
+}
+
+static LIBDIVIDE_INLINE int16_t libdivide_s16_branchfree_do(int16_t numer, const struct libdivide_s16_branchfree_t *denom) {
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+    // must be arithmetic shift and then sign extend
+    int16_t sign = (int8_t)more >> 7;
+    int16_t magic = denom->magic;
+    int16_t q = libdivide_mullhi_s16(numer, magic);
+    q += numer;
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is a power of
+    // 2, or (2**shift) if it is not a power of 2
+    uint16_t is_power_of_2 = (magic == 0);
+    uint16_t q_sign = (uint16_t)(q >> 15);
+    q += q_sign & (((uint16_t)1 << shift) - is_power_of_2);
+
+    // Now arithmetic right shift
+    q >>= shift;
+    // Negate if needed
+    q = (q ^ sign) - sign;
+
+    return q;
+}
+
+static LIBDIVIDE_INLINE int16_t libdivide_s16_recover(const struct libdivide_s16_t *denom) {
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+    if (!denom->magic) {
+        uint16_t absD = (uint16_t)1 << shift;
+        if (more & LIBDIVIDE_NEGATIVE_DIVISOR) {
+            absD = -absD;
+        }
+        return (int16_t)absD;
+    } else {
+        // Unsigned math is much easier
+        // We negate the magic number only in the branchfull case, and we don't
+        // know which case we're in. However we have enough information to
+        // determine the correct sign of the magic number. The divisor was
+        // negative if LIBDIVIDE_NEGATIVE_DIVISOR is set. If ADD_MARKER is set,
+        // the magic number's sign is opposite that of the divisor.
+        // We want to compute the positive magic number.
+        int negative_divisor = (more & LIBDIVIDE_NEGATIVE_DIVISOR);
+        int magic_was_negated = (more & LIBDIVIDE_ADD_MARKER) ? denom->magic > 0 : denom->magic < 0;
+
+        // Handle the power of 2 case (including branchfree)
+        if (denom->magic == 0) {
+            int16_t result = (uint16_t)1 << shift;
+            return negative_divisor ? -result : result;
+        }
+
+        uint16_t d = (uint16_t)(magic_was_negated ? -denom->magic : denom->magic);
+        uint32_t n = (uint32_t)1 << (16 + shift);  // this shift cannot exceed 30
+        uint16_t q = (uint16_t)(n / d);
+        int16_t result = (int16_t)q;
+        result += 1;
+        return negative_divisor ? -result : result;
+    }
+}
+
+static LIBDIVIDE_INLINE int16_t libdivide_s16_branchfree_recover(const struct libdivide_s16_branchfree_t *denom) {
+    const struct libdivide_s16_t den = {denom->magic, denom->more};
+    return libdivide_s16_recover(&den);
+}
+
+////////// SINT32
+
+static LIBDIVIDE_INLINE struct libdivide_s32_t libdivide_internal_s32_gen(
+    int32_t d, int branchfree) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+
+    struct libdivide_s32_t result;
+
+    // If d is a power of 2, or negative a power of 2, we have to use a shift.
+    // This is especially important because the magic algorithm fails for -1.
+    // To check if d is a power of 2 or its inverse, it suffices to check
+    // whether its absolute value has exactly one bit set. This works even for
+    // INT_MIN, because abs(INT_MIN) == INT_MIN, and INT_MIN has one bit set
+    // and is a power of 2.
+    uint32_t ud = (uint32_t)d;
+    uint32_t absD = (d < 0) ? -ud : ud;
+    uint32_t floor_log_2_d = 31 - libdivide_count_leading_zeros32(absD);
+    // check if exactly one bit is set,
+    // don't care if absD is 0 since that's divide by zero
+    if ((absD & (absD - 1)) == 0) {
+        // Branchfree and normal paths are exactly the same
+        result.magic = 0;
+        result.more = (uint8_t)(floor_log_2_d | (d < 0 ? LIBDIVIDE_NEGATIVE_DIVISOR : 0));
+    } else {
+        LIBDIVIDE_ASSERT(floor_log_2_d >= 1);
+
+        uint8_t more;
+        // the dividend here is 2**(floor_log_2_d + 31), so the low 32 bit word
+        // is 0 and the high word is floor_log_2_d - 1
+        uint32_t rem, proposed_m;
+        proposed_m = libdivide_64_div_32_to_32((uint32_t)1 << (floor_log_2_d - 1), 0, absD, &rem);
+        const uint32_t e = absD - rem;
+
+        // We are going to start with a power of floor_log_2_d - 1.
+        // This works if works if e < 2**floor_log_2_d.
+        if (!branchfree && e < ((uint32_t)1 << floor_log_2_d)) {
+            // This power works
+            more = (uint8_t)(floor_log_2_d - 1);
+        } else {
+            // We need to go one higher. This should not make proposed_m
+            // overflow, but it will make it negative when interpreted as an
+            // int32_t.
             proposed_m += proposed_m;
             const uint32_t twice_rem = rem + rem;
             if (twice_rem >= absD || twice_rem < rem) proposed_m += 1;
@@ -1785,1902 +3473,9063 @@ static LIBDIVIDE_INLINE int64_t libdivide_s64_branchfree_recover(const struct li
     return libdivide_s64_recover(&den);
 }
 
-// Simplest possible vector type division: treat the vector type as an array
-// of underlying native type.
-//
-// Use a union to read a vector via pointer-to-integer, without violating strict
-// aliasing.
-#define SIMPLE_VECTOR_DIVISION(IntT, VecT, Algo)                          \
-    const size_t count = sizeof(VecT) / sizeof(IntT);                     \
-    union type_pun_vec {                                                  \
-        VecT vec;                                                         \
-        IntT arr[sizeof(VecT) / sizeof(IntT)];                            \
-    };                                                                    \
-    union type_pun_vec result;                                            \
-    union type_pun_vec input;                                             \
-    input.vec = numers;                                                   \
-    for (size_t loop = 0; loop < count; ++loop) {                         \
-        result.arr[loop] = libdivide_##Algo##_do(input.arr[loop], denom); \
-    }                                                                     \
-    return result.vec;
 
-#if defined(LIBDIVIDE_NEON)
+////////// UINT128
 
-static LIBDIVIDE_INLINE uint16x8_t libdivide_u16_do_vec128(
-    uint16x8_t numers, const struct libdivide_u16_t *denom);
-static LIBDIVIDE_INLINE int16x8_t libdivide_s16_do_vec128(
-    int16x8_t numers, const struct libdivide_s16_t *denom);
-static LIBDIVIDE_INLINE uint32x4_t libdivide_u32_do_vec128(
-    uint32x4_t numers, const struct libdivide_u32_t *denom);
-static LIBDIVIDE_INLINE int32x4_t libdivide_s32_do_vec128(
-    int32x4_t numers, const struct libdivide_s32_t *denom);
-static LIBDIVIDE_INLINE uint64x2_t libdivide_u64_do_vec128(
-    uint64x2_t numers, const struct libdivide_u64_t *denom);
-static LIBDIVIDE_INLINE int64x2_t libdivide_s64_do_vec128(
-    int64x2_t numers, const struct libdivide_s64_t *denom);
+#if defined(HAS_INT128_T)
 
-static LIBDIVIDE_INLINE uint16x8_t libdivide_u16_branchfree_do_vec128(
-    uint16x8_t numers, const struct libdivide_u16_branchfree_t *denom);
-static LIBDIVIDE_INLINE int16x8_t libdivide_s16_branchfree_do_vec128(
-    int16x8_t numers, const struct libdivide_s16_branchfree_t *denom);
-static LIBDIVIDE_INLINE uint32x4_t libdivide_u32_branchfree_do_vec128(
-    uint32x4_t numers, const struct libdivide_u32_branchfree_t *denom);
-static LIBDIVIDE_INLINE int32x4_t libdivide_s32_branchfree_do_vec128(
-    int32x4_t numers, const struct libdivide_s32_branchfree_t *denom);
-static LIBDIVIDE_INLINE uint64x2_t libdivide_u64_branchfree_do_vec128(
-    uint64x2_t numers, const struct libdivide_u64_branchfree_t *denom);
-static LIBDIVIDE_INLINE int64x2_t libdivide_s64_branchfree_do_vec128(
-    int64x2_t numers, const struct libdivide_s64_branchfree_t *denom);
+static LIBDIVIDE_INLINE struct libdivide_u128_t libdivide_internal_u128_gen(
+    __uint128_t d, int branchfree) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
 
-//////// Internal Utility Functions
+    struct libdivide_u128_t result;
+    uint32_t floor_log_2_d = 127 - libdivide_count_leading_zeros128(d);
 
-// Logical right shift by runtime value.
-// NEON implements right shift as left shits by negative values.
-static LIBDIVIDE_INLINE uint32x4_t libdivide_u32_neon_srl(uint32x4_t v, uint8_t amt) {
-    int32_t wamt = (int32_t)(amt);
-    return vshlq_u32(v, vdupq_n_s32(-wamt));
-}
+    // Power of 2
+    if ((d & (d - 1)) == 0) {
+        // See libdivide_internal_u64_gen for the branchfree shift.
+        result.magic = 0;
+        result.more = (uint16_t)(floor_log_2_d - (branchfree != 0));
+    } else {
+        __uint128_t proposed_m, rem;
+        int rem_hi;
+        uint16_t more;
+        // (1 << (128 + floor_log_2_d)) / d
+        proposed_m = libdivide_256_div_129_to_128(
+            (__uint128_t)1 << floor_log_2_d, 0, 0, d, &rem_hi, &rem);
 
-static LIBDIVIDE_INLINE uint64x2_t libdivide_u64_neon_srl(uint64x2_t v, uint8_t amt) {
-    int64_t wamt = (int64_t)(amt);
-    return vshlq_u64(v, vdupq_n_s64(-wamt));
-}
+        LIBDIVIDE_ASSERT(rem > 0 && rem < d);
+        const __uint128_t e = d - rem;
 
-// Arithmetic right shift by runtime value.
-static LIBDIVIDE_INLINE int32x4_t libdivide_s32_neon_sra(int32x4_t v, uint8_t amt) {
-    int32_t wamt = (int32_t)(amt);
-    return vshlq_s32(v, vdupq_n_s32(-wamt));
+        // This power works if e < 2**floor_log_2_d.
+        if (!branchfree && e < ((__uint128_t)1 << floor_log_2_d)) {
+            more = (uint16_t)floor_log_2_d;
+        } else {
+            // The general 129-bit algorithm, see libdivide_internal_u64_gen.
+            proposed_m += proposed_m;
+            const __uint128_t twice_rem = rem + rem;
+            if (twice_rem >= d || twice_rem < rem) proposed_m += 1;
+            more = (uint16_t)(floor_log_2_d | LIBDIVIDE_128_ADD_MARKER);
+        }
+        result.magic = 1 + proposed_m;
+        result.more = more;
+    }
+    return result;
 }
 
-static LIBDIVIDE_INLINE int64x2_t libdivide_s64_neon_sra(int64x2_t v, uint8_t amt) {
-    int64_t wamt = (int64_t)(amt);
-    return vshlq_s64(v, vdupq_n_s64(-wamt));
+static LIBDIVIDE_INLINE struct libdivide_u128_t libdivide_u128_gen(__uint128_t d) {
+    return libdivide_internal_u128_gen(d, 0);
 }
 
-static LIBDIVIDE_INLINE int64x2_t libdivide_s64_signbits(int64x2_t v) { return vshrq_n_s64(v, 63); }
-
-static LIBDIVIDE_INLINE uint32x4_t libdivide_mullhi_u32_vec128(uint32x4_t a, uint32_t b) {
-    // Desire is [x0, x1, x2, x3]
-    uint32x4_t w1 = vreinterpretq_u32_u64(vmull_n_u32(vget_low_u32(a), b));  // [_, x0, _, x1]
-    uint32x4_t w2 = vreinterpretq_u32_u64(vmull_high_n_u32(a, b));           //[_, x2, _, x3]
-    return vuzp2q_u32(w1, w2);                                               // [x0, x1, x2, x3]
+static LIBDIVIDE_INLINE struct libdivide_u128_branchfree_t libdivide_u128_branchfree_gen(
+    __uint128_t d) {
+    if (d == 1) {
+        LIBDIVIDE_ERROR("branchfree divider must be != 1");
+    }
+    struct libdivide_u128_t tmp = libdivide_internal_u128_gen(d, 1);
+    struct libdivide_u128_branchfree_t ret = {
+        tmp.magic, (uint16_t)(tmp.more & LIBDIVIDE_128_SHIFT_MASK)};
+    return ret;
 }
 
-static LIBDIVIDE_INLINE int32x4_t libdivide_mullhi_s32_vec128(int32x4_t a, int32_t b) {
-    int32x4_t w1 = vreinterpretq_s32_s64(vmull_n_s32(vget_low_s32(a), b));  // [_, x0, _, x1]
-    int32x4_t w2 = vreinterpretq_s32_s64(vmull_high_n_s32(a, b));           //[_, x2, _, x3]
-    return vuzp2q_s32(w1, w2);                                              // [x0, x1, x2, x3]
+static LIBDIVIDE_INLINE __uint128_t libdivide_u128_do_raw(
+    __uint128_t numer, __uint128_t magic, uint16_t more) {
+    if (!magic) {
+        return numer >> more;
+    } else {
+        __uint128_t q = libdivide_mullhi_u128(numer, magic);
+        if (more & LIBDIVIDE_128_ADD_MARKER) {
+            __uint128_t t = ((numer - q) >> 1) + q;
+            return t >> (more & LIBDIVIDE_128_SHIFT_MASK);
+        } else {
+            return q >> more;
+        }
+    }
 }
 
-static LIBDIVIDE_INLINE uint64x2_t libdivide_mullhi_u64_vec128(uint64x2_t x, uint64_t sy) {
-    // full 128 bits product is:
-    // x0*y0 + (x0*y1 << 32) + (x1*y0 << 32) + (x1*y1 << 64)
-    // Note x0,y0,x1,y1 are all conceptually uint32, products are 32x32->64.
-
-    // Get low and high words. x0 contains low 32 bits, x1 is high 32 bits.
-    uint64x2_t y = vdupq_n_u64(sy);
-    uint32x2_t x0 = vmovn_u64(x);
-    uint32x2_t y0 = vmovn_u64(y);
-    uint32x2_t x1 = vshrn_n_u64(x, 32);
-    uint32x2_t y1 = vshrn_n_u64(y, 32);
-
-    // Compute x0*y0.
-    uint64x2_t x0y0 = vmull_u32(x0, y0);
-    uint64x2_t x0y0_hi = vshrq_n_u64(x0y0, 32);
-
-    // Compute other intermediate products.
-    uint64x2_t temp = vmlal_u32(x0y0_hi, x1, y0);  // temp = x0y0_hi + x1*y0;
-    // We want to split temp into its low 32 bits and high 32 bits, both
-    // in the low half of 64 bit registers.
-    // Use shifts to avoid needing a reg for the mask.
-    uint64x2_t temp_lo = vshrq_n_u64(vshlq_n_u64(temp, 32), 32);  // temp_lo = temp & 0xFFFFFFFF;
-    uint64x2_t temp_hi = vshrq_n_u64(temp, 32);                   // temp_hi = temp >> 32;
-
-    temp_lo = vmlal_u32(temp_lo, x0, y1);  // temp_lo += x0*y0
-    temp_lo = vshrq_n_u64(temp_lo, 32);    // temp_lo >>= 32
-    temp_hi = vmlal_u32(temp_hi, x1, y1);  // temp_hi += x1*y1
-    uint64x2_t result = vaddq_u64(temp_hi, temp_lo);
-    return result;
+static LIBDIVIDE_INLINE __uint128_t libdivide_u128_do(
+    __uint128_t numer, const struct libdivide_u128_t *denom) {
+    return libdivide_u128_do_raw(numer, denom->magic, denom->more);
 }
 
-static LIBDIVIDE_INLINE int64x2_t libdivide_mullhi_s64_vec128(int64x2_t x, int64_t sy) {
-    int64x2_t p = vreinterpretq_s64_u64(
-        libdivide_mullhi_u64_vec128(vreinterpretq_u64_s64(x), (uint64_t)(sy)));
-    int64x2_t y = vdupq_n_s64(sy);
-    int64x2_t t1 = vandq_s64(libdivide_s64_signbits(x), y);
-    int64x2_t t2 = vandq_s64(libdivide_s64_signbits(y), x);
-    p = vsubq_s64(p, t1);
-    p = vsubq_s64(p, t2);
-    return p;
+static LIBDIVIDE_INLINE __uint128_t libdivide_u128_branchfree_do(
+    __uint128_t numer, const struct libdivide_u128_branchfree_t *denom) {
+    __uint128_t q = libdivide_mullhi_u128(numer, denom->magic);
+    __uint128_t t = ((numer - q) >> 1) + q;
+    return t >> denom->more;
 }
 
-////////// UINT16
+// Recovers d from magic and shift, see libdivide_u64_recover.
+static LIBDIVIDE_INLINE __uint128_t libdivide_u128_recover_magic(
+    __uint128_t magic, uint32_t shift, int add_marker) {
+    int r_hi;
+    __uint128_t r_lo;
+    if (!add_marker) {
+        // d = 2^(128 + shift) / m, rounded up
+        return 1 + libdivide_256_div_129_to_128((__uint128_t)1 << shift, 0, 0, magic, &r_hi, &r_lo);
+    }
+    // d = 2^(128 + shift + 1) / (m + 2^128), rounded up. The dividend may
+    // need 257 bits, so compute 2^(128 + shift) / (m + 2^128) and double.
+    __uint128_t half_q =
+        libdivide_256_div_129_to_128((__uint128_t)1 << shift, 0, 1, magic, &r_hi, &r_lo);
+    int dr_hi = r_hi + r_hi + (int)(r_lo >> 127);
+    __uint128_t dr_lo = r_lo + r_lo;
+    int dr_exceeds_d = (dr_hi > 1) || (dr_hi == 1 && dr_lo >= magic);
+    return half_q + half_q + (dr_exceeds_d ? 1 : 0) + 1;
+}
 
-uint16x8_t libdivide_u16_do_vec128(uint16x8_t numers, const struct libdivide_u16_t *denom){
-    SIMPLE_VECTOR_DIVISION(uint16_t, uint16x8_t, u16)}
+static LIBDIVIDE_INLINE __uint128_t libdivide_u128_recover(const struct libdivide_u128_t *denom) {
+    uint16_t more = denom->more;
+    uint32_t shift = more & LIBDIVIDE_128_SHIFT_MASK;
 
-uint16x8_t libdivide_u16_branchfree_do_vec128(
-    uint16x8_t numers, const struct libdivide_u16_branchfree_t *denom){
-    SIMPLE_VECTOR_DIVISION(uint16_t, uint16x8_t, u16_branchfree)}
+    if (!denom->magic) {
+        return (__uint128_t)1 << shift;
+    }
+    return libdivide_u128_recover_magic(
+        denom->magic, shift, (more & LIBDIVIDE_128_ADD_MARKER) != 0);
+}
 
-////////// UINT32
+static LIBDIVIDE_INLINE __uint128_t libdivide_u128_branchfree_recover(
+    const struct libdivide_u128_branchfree_t *denom) {
+    uint32_t shift = denom->more & LIBDIVIDE_128_SHIFT_MASK;
 
-uint32x4_t libdivide_u32_do_vec128(uint32x4_t numers, const struct libdivide_u32_t *denom) {
-    uint8_t more = denom->more;
     if (!denom->magic) {
-        return libdivide_u32_neon_srl(numers, more);
-    } else {
-        uint32x4_t q = libdivide_mullhi_u32_vec128(numers, denom->magic);
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // uint32_t t = ((numer - q) >> 1) + q;
-            // return t >> denom->shift;
-            // Note we can use halving-subtract to avoid the shift.
-            uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-            uint32x4_t t = vaddq_u32(vhsubq_u32(numers, q), q);
-            return libdivide_u32_neon_srl(t, shift);
-        } else {
-            return libdivide_u32_neon_srl(q, more);
-        }
+        return (__uint128_t)1 << (shift + 1);
     }
+    return libdivide_u128_recover_magic(denom->magic, shift, 1);
 }
 
-uint32x4_t libdivide_u32_branchfree_do_vec128(
-    uint32x4_t numers, const struct libdivide_u32_branchfree_t *denom) {
-    uint32x4_t q = libdivide_mullhi_u32_vec128(numers, denom->magic);
-    uint32x4_t t = vaddq_u32(vhsubq_u32(numers, q), q);
-    return libdivide_u32_neon_srl(t, denom->more);
-}
+#endif
 
-////////// UINT64
+////////// SINT128
 
-uint64x2_t libdivide_u64_do_vec128(uint64x2_t numers, const struct libdivide_u64_t *denom) {
-    uint8_t more = denom->more;
-    if (!denom->magic) {
-        return libdivide_u64_neon_srl(numers, more);
+#if defined(HAS_INT128_T)
+
+static LIBDIVIDE_INLINE struct libdivide_s128_t libdivide_internal_s128_gen(
+    __int128_t d, int branchfree) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+
+    struct libdivide_s128_t result;
+
+    // See libdivide_internal_s64_gen.
+    __uint128_t ud = (__uint128_t)d;
+    __uint128_t absD = (d < 0) ? -ud : ud;
+    uint32_t floor_log_2_d = 127 - libdivide_count_leading_zeros128(absD);
+    if ((absD & (absD - 1)) == 0) {
+        // Branchfree and non-branchfree cases are the same
+        result.magic = 0;
+        result.more = (uint16_t)(floor_log_2_d | (d < 0 ? LIBDIVIDE_128_NEGATIVE_DIVISOR : 0));
     } else {
-        uint64x2_t q = libdivide_mullhi_u64_vec128(numers, denom->magic);
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // uint32_t t = ((numer - q) >> 1) + q;
-            // return t >> denom->shift;
-            // No 64-bit halving subtracts in NEON :(
-            uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-            uint64x2_t t = vaddq_u64(vshrq_n_u64(vsubq_u64(numers, q), 1), q);
-            return libdivide_u64_neon_srl(t, shift);
+        uint16_t more;
+        int rem_hi;
+        __uint128_t rem, proposed_m;
+        proposed_m = libdivide_256_div_129_to_128(
+            (__uint128_t)1 << (floor_log_2_d - 1), 0, 0, absD, &rem_hi, &rem);
+        const __uint128_t e = absD - rem;
+
+        if (!branchfree && e < ((__uint128_t)1 << floor_log_2_d)) {
+            // This power works
+            more = (uint16_t)(floor_log_2_d - 1);
         } else {
-            return libdivide_u64_neon_srl(q, more);
+            proposed_m += proposed_m;
+            const __uint128_t twice_rem = rem + rem;
+            if (twice_rem >= absD || twice_rem < rem) proposed_m += 1;
+            more = (uint16_t)(floor_log_2_d | LIBDIVIDE_128_ADD_MARKER);
+        }
+        proposed_m += 1;
+        __int128_t magic = (__int128_t)proposed_m;
+
+        // Mark if we are negative
+        if (d < 0) {
+            more |= LIBDIVIDE_128_NEGATIVE_DIVISOR;
+            if (!branchfree) {
+                magic = -magic;
+            }
         }
+
+        result.more = more;
+        result.magic = magic;
     }
+    return result;
 }
 
-uint64x2_t libdivide_u64_branchfree_do_vec128(
-    uint64x2_t numers, const struct libdivide_u64_branchfree_t *denom) {
-    uint64x2_t q = libdivide_mullhi_u64_vec128(numers, denom->magic);
-    uint64x2_t t = vaddq_u64(vshrq_n_u64(vsubq_u64(numers, q), 1), q);
-    return libdivide_u64_neon_srl(t, denom->more);
+static LIBDIVIDE_INLINE struct libdivide_s128_t libdivide_s128_gen(__int128_t d) {
+    return libdivide_internal_s128_gen(d, 0);
 }
 
-////////// SINT16
-
-int16x8_t libdivide_s16_do_vec128(int16x8_t numers, const struct libdivide_s16_t *denom){
-    SIMPLE_VECTOR_DIVISION(int16_t, int16x8_t, s16)}
-
-int16x8_t libdivide_s16_branchfree_do_vec128(
-    int16x8_t numers, const struct libdivide_s16_branchfree_t *denom){
-    SIMPLE_VECTOR_DIVISION(int16_t, int16x8_t, s16_branchfree)}
+static LIBDIVIDE_INLINE struct libdivide_s128_branchfree_t libdivide_s128_branchfree_gen(
+    __int128_t d) {
+    struct libdivide_s128_t tmp = libdivide_internal_s128_gen(d, 1);
+    struct libdivide_s128_branchfree_t ret = {tmp.magic, tmp.more};
+    return ret;
+}
 
-////////// SINT32
+static LIBDIVIDE_INLINE __int128_t libdivide_s128_do_raw(
+    __int128_t numer, __int128_t magic, uint16_t more) {
+    uint32_t shift = more & LIBDIVIDE_128_SHIFT_MASK;
+    // -1 if the divisor is negative, 0 otherwise
+    __int128_t sign = -(__int128_t)(more >> 8);
 
-int32x4_t libdivide_s32_do_vec128(int32x4_t numers, const struct libdivide_s32_t *denom) {
-    uint8_t more = denom->more;
-    if (!denom->magic) {
-        uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-        uint32_t mask = ((uint32_t)1 << shift) - 1;
-        int32x4_t roundToZeroTweak = vdupq_n_s32((int)mask);
-        // q = numer + ((numer >> 31) & roundToZeroTweak);
-        int32x4_t q = vaddq_s32(numers, vandq_s32(vshrq_n_s32(numers, 31), roundToZeroTweak));
-        q = libdivide_s32_neon_sra(q, shift);
-        int32x4_t sign = vdupq_n_s32((int8_t)more >> 7);
-        // q = (q ^ sign) - sign;
-        q = vsubq_s32(veorq_s32(q, sign), sign);
+    if (!magic) {  // shift path
+        __uint128_t mask = ((__uint128_t)1 << shift) - 1;
+        __uint128_t uq = (__uint128_t)numer + ((__uint128_t)(numer >> 127) & mask);
+        __int128_t q = (__int128_t)uq;
+        q >>= shift;
+        q = (q ^ sign) - sign;
         return q;
     } else {
-        int32x4_t q = libdivide_mullhi_s32_vec128(numers, denom->magic);
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // must be arithmetic shift
-            int32x4_t sign = vdupq_n_s32((int8_t)more >> 7);
-            // q += ((numer ^ sign) - sign);
-            q = vaddq_s32(q, vsubq_s32(veorq_s32(numers, sign), sign));
+        __uint128_t uq = (__uint128_t)libdivide_mullhi_s128(numer, magic);
+        if (more & LIBDIVIDE_128_ADD_MARKER) {
+            // q += (more < 0 ? -numer : numer)
+            uq += ((__uint128_t)numer ^ (__uint128_t)sign) - (__uint128_t)sign;
         }
-        // q >>= shift
-        q = libdivide_s32_neon_sra(q, more & LIBDIVIDE_32_SHIFT_MASK);
-        q = vaddq_s32(
-            q, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(q), 31)));  // q += (q < 0)
+        __int128_t q = (__int128_t)uq;
+        q >>= shift;
+        q += (q < 0);
         return q;
     }
 }
 
-int32x4_t libdivide_s32_branchfree_do_vec128(
-    int32x4_t numers, const struct libdivide_s32_branchfree_t *denom) {
-    int32_t magic = denom->magic;
-    uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-    // must be arithmetic shift
-    int32x4_t sign = vdupq_n_s32((int8_t)more >> 7);
-    int32x4_t q = libdivide_mullhi_s32_vec128(numers, magic);
-    q = vaddq_s32(q, numers);  // q += numers
+static LIBDIVIDE_INLINE __int128_t libdivide_s128_do(
+    __int128_t numer, const struct libdivide_s128_t *denom) {
+    return libdivide_s128_do_raw(numer, denom->magic, denom->more);
+}
+
+static LIBDIVIDE_INLINE __int128_t libdivide_s128_branchfree_do(
+    __int128_t numer, const struct libdivide_s128_branchfree_t *denom) {
+    uint16_t more = denom->more;
+    uint32_t shift = more & LIBDIVIDE_128_SHIFT_MASK;
+    __int128_t sign = -(__int128_t)(more >> 8);
+    __int128_t magic = denom->magic;
+    __int128_t q = (__int128_t)((__uint128_t)libdivide_mullhi_s128(numer, magic) + (__uint128_t)numer);
+
+    // See libdivide_s64_branchfree_do.
+    __uint128_t is_power_of_2 = (magic == 0);
+    __uint128_t q_sign = (__uint128_t)(q >> 127);
+    q = (__int128_t)((__uint128_t)q + (q_sign & (((__uint128_t)1 << shift) - is_power_of_2)));
+
+    // Arithmetic right shift
+    q >>= shift;
+    // Negate if needed
+    q = (q ^ sign) - sign;
 
-    // If q is non-negative, we have nothing to do
-    // If q is negative, we want to add either (2**shift)-1 if d is
-    // a power of 2, or (2**shift) if it is not a power of 2
-    uint32_t is_power_of_2 = (magic == 0);
-    int32x4_t q_sign = vshrq_n_s32(q, 31);  // q_sign = q >> 31
-    int32x4_t mask = vdupq_n_s32(((uint32_t)1 << shift) - is_power_of_2);
-    q = vaddq_s32(q, vandq_s32(q_sign, mask));  // q = q + (q_sign & mask)
-    q = libdivide_s32_neon_sra(q, shift);       // q >>= shift
-    q = vsubq_s32(veorq_s32(q, sign), sign);    // q = (q ^ sign) - sign
     return q;
 }
 
-////////// SINT64
-
-int64x2_t libdivide_s64_do_vec128(int64x2_t numers, const struct libdivide_s64_t *denom) {
-    uint8_t more = denom->more;
-    int64_t magic = denom->magic;
-    if (magic == 0) {  // shift path
-        uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-        uint64_t mask = ((uint64_t)1 << shift) - 1;
-        int64x2_t roundToZeroTweak = vdupq_n_s64(mask);  // TODO: no need to sign extend
-        // q = numer + ((numer >> 63) & roundToZeroTweak);
-        int64x2_t q =
-            vaddq_s64(numers, vandq_s64(libdivide_s64_signbits(numers), roundToZeroTweak));
-        q = libdivide_s64_neon_sra(q, shift);
-        // q = (q ^ sign) - sign;
-        int64x2_t sign = vreinterpretq_s64_s8(vdupq_n_s8((int8_t)more >> 7));
-        q = vsubq_s64(veorq_s64(q, sign), sign);
-        return q;
+static LIBDIVIDE_INLINE __int128_t libdivide_s128_recover(const struct libdivide_s128_t *denom) {
+    uint16_t more = denom->more;
+    uint32_t shift = more & LIBDIVIDE_128_SHIFT_MASK;
+    if (denom->magic == 0) {  // shift path
+        __uint128_t absD = (__uint128_t)1 << shift;
+        if (more & LIBDIVIDE_128_NEGATIVE_DIVISOR) {
+            absD = -absD;
+        }
+        return (__int128_t)absD;
     } else {
-        int64x2_t q = libdivide_mullhi_s64_vec128(numers, magic);
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // must be arithmetic shift
-            int64x2_t sign = vdupq_n_s64((int8_t)more >> 7);  // TODO: no need to widen
-            // q += ((numer ^ sign) - sign);
-            q = vaddq_s64(q, vsubq_s64(veorq_s64(numers, sign), sign));
+        // Unsigned math is much easier
+        int negative_divisor = (more & LIBDIVIDE_128_NEGATIVE_DIVISOR);
+        int magic_was_negated =
+            (more & LIBDIVIDE_128_ADD_MARKER) ? denom->magic > 0 : denom->magic < 0;
+
+        __uint128_t d = (__uint128_t)(magic_was_negated ? -denom->magic : denom->magic);
+        int rem_hi_ignored;
+        __uint128_t rem_lo_ignored;
+        __uint128_t q = libdivide_256_div_129_to_128(
+            (__uint128_t)1 << shift, 0, 0, d, &rem_hi_ignored, &rem_lo_ignored);
+        __uint128_t result = q + 1;
+        if (negative_divisor) {
+            result = -result;
         }
-        // q >>= denom->mult_path.shift
-        q = libdivide_s64_neon_sra(q, more & LIBDIVIDE_64_SHIFT_MASK);
-        q = vaddq_s64(
-            q, vreinterpretq_s64_u64(vshrq_n_u64(vreinterpretq_u64_s64(q), 63)));  // q += (q < 0)
-        return q;
+        return (__int128_t)result;
     }
 }
 
-int64x2_t libdivide_s64_branchfree_do_vec128(
-    int64x2_t numers, const struct libdivide_s64_branchfree_t *denom) {
-    int64_t magic = denom->magic;
-    uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-    // must be arithmetic shift
-    int64x2_t sign = vdupq_n_s64((int8_t)more >> 7);  // TODO: avoid sign extend
-
-    // libdivide_mullhi_s64(numers, magic);
-    int64x2_t q = libdivide_mullhi_s64_vec128(numers, magic);
-    q = vaddq_s64(q, numers);  // q += numers
-
-    // If q is non-negative, we have nothing to do.
-    // If q is negative, we want to add either (2**shift)-1 if d is
-    // a power of 2, or (2**shift) if it is not a power of 2.
-    uint32_t is_power_of_2 = (magic == 0);
-    int64x2_t q_sign = libdivide_s64_signbits(q);  // q_sign = q >> 63
-    int64x2_t mask = vdupq_n_s64(((uint64_t)1 << shift) - is_power_of_2);
-    q = vaddq_s64(q, vandq_s64(q_sign, mask));  // q = q + (q_sign & mask)
-    q = libdivide_s64_neon_sra(q, shift);       // q >>= shift
-    q = vsubq_s64(veorq_s64(q, sign), sign);    // q = (q ^ sign) - sign
-    return q;
+static LIBDIVIDE_INLINE __int128_t libdivide_s128_branchfree_recover(
+    const struct libdivide_s128_branchfree_t *denom) {
+    const struct libdivide_s128_t den = {denom->magic, denom->more};
+    return libdivide_s128_recover(&den);
 }
 
 #endif
 
-#if defined(LIBDIVIDE_SVE)
+////////// REMAINDER
+
+// The remainder is computed as numer - q * d using unsigned arithmetic, so
+// that it cannot overflow. The divisor d must be the value the divider has
+// been generated from, it is not stored in libdivide's structs.
+#define LIBDIVIDE_DIVMOD_GEN(ALGO, IntT, UIntT)                                    \
+    static LIBDIVIDE_INLINE IntT libdivide_##ALGO##_divmod(                        \
+        IntT numer, IntT d, const struct libdivide_##ALGO##_t *denom, IntT *rem) { \
+        IntT q = libdivide_##ALGO##_do(numer, denom);                              \
+        *rem = (IntT)((UIntT)numer - (UIntT)q * (UIntT)d);                         \
+        return q;                                                                  \
+    }                                                                              \
+    static LIBDIVIDE_INLINE IntT libdivide_##ALGO##_remainder(                     \
+        IntT numer, IntT d, const struct libdivide_##ALGO##_t *denom) {            \
+        IntT q = libdivide_##ALGO##_do(numer, denom);                              \
+        return (IntT)((UIntT)numer - (UIntT)q * (UIntT)d);                         \
+    }
 
-static LIBDIVIDE_INLINE svuint16_t libdivide_u16_do_sve(
-    svuint16_t numers, const struct libdivide_u16_t *denom);
-static LIBDIVIDE_INLINE svint16_t libdivide_s16_do_sve(
-    svint16_t numers, const struct libdivide_s16_t *denom);
-static LIBDIVIDE_INLINE svuint32_t libdivide_u32_do_sve(
-    svuint32_t numers, const struct libdivide_u32_t *denom);
-static LIBDIVIDE_INLINE svint32_t libdivide_s32_do_sve(
-    svint32_t numers, const struct libdivide_s32_t *denom);
-static LIBDIVIDE_INLINE svuint64_t libdivide_u64_do_sve(
-    svuint64_t numers, const struct libdivide_u64_t *denom);
-static LIBDIVIDE_INLINE svint64_t libdivide_s64_do_sve(
-    svint64_t numers, const struct libdivide_s64_t *denom);
+// 16-bit products are computed using uint32_t as uint16_t would be
+// promoted to (signed) int.
+LIBDIVIDE_DIVMOD_GEN(u8, uint8_t, uint32_t)
+LIBDIVIDE_DIVMOD_GEN(s8, int8_t, uint32_t)
+LIBDIVIDE_DIVMOD_GEN(u16, uint16_t, uint32_t)
+LIBDIVIDE_DIVMOD_GEN(s16, int16_t, uint32_t)
+LIBDIVIDE_DIVMOD_GEN(u32, uint32_t, uint32_t)
+LIBDIVIDE_DIVMOD_GEN(s32, int32_t, uint32_t)
+LIBDIVIDE_DIVMOD_GEN(u64, uint64_t, uint64_t)
+LIBDIVIDE_DIVMOD_GEN(s64, int64_t, uint64_t)
+LIBDIVIDE_DIVMOD_GEN(u8_branchfree, uint8_t, uint32_t)
+LIBDIVIDE_DIVMOD_GEN(s8_branchfree, int8_t, uint32_t)
+LIBDIVIDE_DIVMOD_GEN(u16_branchfree, uint16_t, uint32_t)
+LIBDIVIDE_DIVMOD_GEN(s16_branchfree, int16_t, uint32_t)
+LIBDIVIDE_DIVMOD_GEN(u32_branchfree, uint32_t, uint32_t)
+LIBDIVIDE_DIVMOD_GEN(s32_branchfree, int32_t, uint32_t)
+LIBDIVIDE_DIVMOD_GEN(u64_branchfree, uint64_t, uint64_t)
+LIBDIVIDE_DIVMOD_GEN(s64_branchfree, int64_t, uint64_t)
+#if defined(HAS_INT128_T)
+LIBDIVIDE_DIVMOD_GEN(u128, __uint128_t, __uint128_t)
+LIBDIVIDE_DIVMOD_GEN(s128, __int128_t, __uint128_t)
+LIBDIVIDE_DIVMOD_GEN(u128_branchfree, __uint128_t, __uint128_t)
+LIBDIVIDE_DIVMOD_GEN(s128_branchfree, __int128_t, __uint128_t)
+#endif
 
-static LIBDIVIDE_INLINE svuint16_t libdivide_u16_branchfree_do_sve(
-    svuint16_t numers, const struct libdivide_u16_branchfree_t *denom);
-static LIBDIVIDE_INLINE svint16_t libdivide_s16_branchfree_do_sve(
-    svint16_t numers, const struct libdivide_s16_branchfree_t *denom);
-static LIBDIVIDE_INLINE svuint32_t libdivide_u32_branchfree_do_sve(
-    svuint32_t numers, const struct libdivide_u32_branchfree_t *denom);
-static LIBDIVIDE_INLINE svint32_t libdivide_s32_branchfree_do_sve(
-    svint32_t numers, const struct libdivide_s32_branchfree_t *denom);
-static LIBDIVIDE_INLINE svuint64_t libdivide_u64_branchfree_do_sve(
-    svuint64_t numers, const struct libdivide_u64_branchfree_t *denom);
-static LIBDIVIDE_INLINE svint64_t libdivide_s64_branchfree_do_sve(
-    svint64_t numers, const struct libdivide_s64_branchfree_t *denom);
+////////// FASTMOD
 
-//////// Internal Utility Functions
+// Lemire, Kaser & Kurz, "Faster Remainder by Direct Computation" (2019):
+// with magic = ceil(2^64 / d), the low 64 bits of numer * magic are the
+// fraction numer / d scaled by 2^64, multiplying them by d yields
+// numer % d in the high 64 bits. numer is a multiple of d iff the
+// fraction is smaller than magic.
 
-// logical shift right
-static LIBDIVIDE_INLINE svuint16_t libdivide_u16_sve_srl(svuint16_t v, uint8_t amt) {
-    return svlsr_wide_u16_x(svptrue_b16(), v, svdup_n_u64(amt));
+static LIBDIVIDE_INLINE struct libdivide_u32_fastmod_t libdivide_u32_fastmod_gen(uint32_t d) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+    struct libdivide_u32_fastmod_t result;
+    // Wraps to 0 for d == 1, which yields the correct results.
+    result.magic = UINT64_C(0xFFFFFFFFFFFFFFFF) / d + 1;
+    result.d = d;
+    return result;
 }
 
-static LIBDIVIDE_INLINE svuint32_t libdivide_u32_sve_srl(svuint32_t v, uint8_t amt) {
-    return svlsr_wide_u32_x(svptrue_b32(), v, svdup_n_u64(amt));
+static LIBDIVIDE_INLINE struct libdivide_s32_fastmod_t libdivide_s32_fastmod_gen(int32_t d) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+    struct libdivide_s32_fastmod_t result;
+    // Also handles INT32_MIN
+    uint32_t abs_d = d < 0 ? -(uint32_t)d : (uint32_t)d;
+    result.magic = UINT64_C(0xFFFFFFFFFFFFFFFF) / abs_d + 1;
+    // Powers of 2 (except 1, whose magic number wraps to 0) need a magic
+    // number rounded up once more so that the fraction of negative
+    // numerators is not truncated to 0.
+    if (abs_d > 1 && (abs_d & (abs_d - 1)) == 0) {
+        result.magic += 1;
+    }
+    result.d = abs_d;
+    return result;
 }
 
-static LIBDIVIDE_INLINE svuint64_t libdivide_u64_sve_srl(svuint64_t v, uint8_t amt) {
-    return svlsr_n_u64_x(svptrue_b64(), v, amt);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_fastmod_mod(
+    uint32_t numer, const struct libdivide_u32_fastmod_t *denom) {
+    uint64_t lowbits = denom->magic * numer;
+    return (uint32_t)libdivide_mullhi_u64(lowbits, denom->d);
 }
 
-// arithmetic shift right
-static LIBDIVIDE_INLINE svint16_t libdivide_s16_sve_sra(svint16_t v, uint8_t amt) {
-    return svasr_wide_s16_x(svptrue_b16(), v, svdup_n_u64(amt));
+static LIBDIVIDE_INLINE int32_t libdivide_s32_fastmod_mod(
+    int32_t numer, const struct libdivide_s32_fastmod_t *denom) {
+    uint64_t lowbits = denom->magic * (uint64_t)(int64_t)numer;
+    uint32_t highbits = (uint32_t)libdivide_mullhi_u64(lowbits, denom->d);
+    // For negative numerators highbits is the remainder + d - 1
+    uint32_t sign = (uint32_t)(numer >> 31);
+    return (int32_t)(highbits - ((denom->d - 1) & sign));
 }
 
-static LIBDIVIDE_INLINE svint32_t libdivide_s32_sve_sra(svint32_t v, uint8_t amt) {
-    return svasr_wide_s32_x(svptrue_b32(), v, svdup_n_u64(amt));
+static LIBDIVIDE_INLINE int libdivide_u32_fastmod_is_divisible(
+    uint32_t numer, const struct libdivide_u32_fastmod_t *denom) {
+    return numer * denom->magic <= denom->magic - 1;
 }
 
-static LIBDIVIDE_INLINE svint64_t libdivide_s64_sve_sra(svint64_t v, uint8_t amt) {
-    return svasr_n_s64_x(svptrue_b64(), v, amt);
+static LIBDIVIDE_INLINE int libdivide_s32_fastmod_is_divisible(
+    int32_t numer, const struct libdivide_s32_fastmod_t *denom) {
+    uint32_t sign = (uint32_t)(numer >> 31);
+    uint32_t abs_numer = ((uint32_t)numer ^ sign) - sign;
+    return abs_numer * denom->magic <= denom->magic - 1;
 }
 
-// unsigned halving add: (x + y) >> 1
-static LIBDIVIDE_INLINE svuint16_t libdivide_u16_sve_hadd(svuint16_t x, svuint16_t y) {
-    svbool_t pg = svptrue_b16();
-#if defined(LIBDIVIDE_SVE2)
-    return svhadd_u16_x(pg, x, y);
-#else
-    return svadd_u16_x(pg, svlsr_n_u16_x(pg, svsub_u16_x(pg, x, y), 1), y);
-#endif
-}
+////////// EXACT DIVISION
 
-static LIBDIVIDE_INLINE svuint32_t libdivide_u32_sve_hadd(svuint32_t x, svuint32_t y) {
-    svbool_t pg = svptrue_b32();
-#if defined(LIBDIVIDE_SVE2)
-    return svhadd_u32_x(pg, x, y);
-#else
-    return svadd_u32_x(pg, svlsr_n_u32_x(pg, svsub_u32_x(pg, x, y), 1), y);
-#endif
-}
+// If numer is known to be a multiple of d = d_odd << shift, then
+// numer / d = (numer >> shift) * inverse modulo 2^w, where inverse is the
+// multiplicative inverse of d_odd modulo 2^w (Granlund & Montgomery,
+// "Division by Invariant Integers using Multiplication", section 9).
+// Signed dividers use an arithmetic shift and the inverse of the (signed)
+// odd part of d. The result is meaningless if numer is not a multiple of
+// d, this is checked if LIBDIVIDE_ASSERTIONS_ON is defined.
 
-static LIBDIVIDE_INLINE svuint64_t libdivide_u64_sve_hadd(svuint64_t x, svuint64_t y) {
-    svbool_t pg = svptrue_b64();
-    // SVE2 has svhadd_u64_x, but it was neutral to slower on Graviton4.
-    // Keep the base SVE sequence for the 64-bit add-marker path.
-    return svadd_u64_x(pg, svlsr_n_u64_x(pg, svsub_u64_x(pg, x, y), 1), y);
-}
+// Inverse of the odd number d modulo 2^64 using Newton's iteration:
+// d * d == 1 (mod 8) and each step doubles the number of correct bits.
+// The low bits of the result are the inverse modulo smaller powers of 2.
+static LIBDIVIDE_INLINE uint64_t libdivide_inverse_u64(uint64_t d) {
+    uint64_t inverse = d;
+    for (int i = 0; i < 5; i++) {
+        inverse *= 2 - d * inverse;
+    }
+    return inverse;
+}
+
+// MulT is the type used for products, as uint16_t would be promoted to
+// (signed) int. exact_do() asserts that numer is a multiple of d, d = -1
+// is skipped since INT_MIN % -1 is undefined behavior.
+#define LIBDIVIDE_EXACT_GEN(ALGO, IntT, UIntT, MulT)                                        \
+    static LIBDIVIDE_INLINE struct libdivide_##ALGO##_exact_t libdivide_##ALGO##_exact_gen( \
+        IntT d) {                                                                           \
+        if (d == 0) {                                                                       \
+            LIBDIVIDE_ERROR("divider must be != 0");                                        \
+        }                                                                                   \
+        struct libdivide_##ALGO##_exact_t result;                                           \
+        uint64_t lowest_bit = (uint64_t)(UIntT)d & (0 - (uint64_t)(UIntT)d);                \
+        result.shift = (uint8_t)(63 - libdivide_count_leading_zeros64(lowest_bit));         \
+        result.inverse = (IntT)libdivide_inverse_u64((uint64_t)(UIntT)(d >> result.shift)); \
+        return result;                                                                      \
+    }                                                                                       \
+    static LIBDIVIDE_INLINE IntT libdivide_##ALGO##_exact_recover(                          \
+        const struct libdivide_##ALGO##_exact_t *denom) {                                   \
+        UIntT d_odd = (UIntT)libdivide_inverse_u64((uint64_t)(UIntT)denom->inverse);        \
+        return (IntT)((MulT)d_odd << denom->shift);                                         \
+    }                                                                                       \
+    static LIBDIVIDE_INLINE IntT libdivide_##ALGO##_exact_do(                               \
+        IntT numer, const struct libdivide_##ALGO##_exact_t *denom) {                       \
+        IntT q = (IntT)((MulT)(UIntT)(numer >> denom->shift) * (UIntT)denom->inverse);      \
+        LIBDIVIDE_ASSERT(libdivide_##ALGO##_exact_recover(denom) == (IntT)-1 ||             \
+                         numer % libdivide_##ALGO##_exact_recover(denom) == 0);             \
+        return q;                                                                           \
+    }
 
-// sign mask: 0 for non-negative lanes, -1 for negative lanes
-static LIBDIVIDE_INLINE svint16_t libdivide_s16_sve_signbits(svint16_t v) {
-    return svasr_n_s16_x(svptrue_b16(), v, 15);
-}
+LIBDIVIDE_EXACT_GEN(u16, uint16_t, uint16_t, uint32_t)
+LIBDIVIDE_EXACT_GEN(s16, int16_t, uint16_t, uint32_t)
+LIBDIVIDE_EXACT_GEN(u32, uint32_t, uint32_t, uint32_t)
+LIBDIVIDE_EXACT_GEN(s32, int32_t, uint32_t, uint32_t)
+LIBDIVIDE_EXACT_GEN(u64, uint64_t, uint64_t, uint64_t)
+LIBDIVIDE_EXACT_GEN(s64, int64_t, uint64_t, uint64_t)
 
-static LIBDIVIDE_INLINE svint32_t libdivide_s32_sve_signbits(svint32_t v) {
-    return svasr_n_s32_x(svptrue_b32(), v, 31);
-}
+////////// ROUNDING
 
-static LIBDIVIDE_INLINE svint64_t libdivide_s64_sve_signbits(svint64_t v) {
-    return svasr_n_s64_x(svptrue_b64(), v, 63);
-}
+// Division rounding toward -infinity (floor), toward +infinity (ceiling)
+// or such that the remainder is non-negative (Euclidean division).
+//
+// Instead of fixing up a truncated quotient by comparing the remainder,
+// the rounding is folded into the magic number sequence: all of them are
+// expressed as trunc(n' / |d|) with a numerator n' >= 0 and a sign
+// correction, computed with the unsigned magic number of |d|:
+//
+//     b = n - bias                       (bias is 0 or 1)
+//     s = sign mask of b                 (0 or -1, from n | b, b may wrap)
+//     q = (udiv(b ^ s) ^ s ^ sign(d)) + increment
+//
+// b ^ s = |b| - (s & 1) <= 2^(w-1), so the unsigned algorithm never needs
+// the add indicator for this numerator range. The bias and increment bits
+// depend on the rounding mode and the sign of d only:
+//
+//     floor:  bias = d < 0, increment = 0
+//     ceil:   bias = d > 0, increment = 1
+//     euclid: bias = 0,     increment = d < 0
+//
+// Unsigned ceiling division is udiv(n - c) + c with c = (n != 0), floor
+// and Euclidean division are the same as truncation.
+//
+// Since b ^ s <= 2^(w-1) the signed branchfree dividers use the shorter
+// sequence (n' + mulhi(n', magic)) >> shift: the branchfree magic number
+// of |d| with the shift increased by 1 (or magic 0 for powers of 2).
+
+static LIBDIVIDE_INLINE uint8_t libdivide_round_bits(int negative, enum libdivide_rounding rounding) {
+    uint8_t round = negative ? (uint8_t)LIBDIVIDE_NEGATIVE_DIVISOR : (uint8_t)0;
+    if (rounding == LIBDIVIDE_ROUND_FLOOR) {
+        round |= negative ? (uint8_t)LIBDIVIDE_ROUND_BIAS : (uint8_t)0;
+    } else if (rounding == LIBDIVIDE_ROUND_CEIL) {
+        round |= negative ? (uint8_t)0 : (uint8_t)LIBDIVIDE_ROUND_BIAS;
+        round |= (uint8_t)LIBDIVIDE_ROUND_INCREMENT;
+    } else if (rounding == LIBDIVIDE_ROUND_EUCLID) {
+        round |= negative ? (uint8_t)LIBDIVIDE_ROUND_INCREMENT : (uint8_t)0;
+    } else {
+        LIBDIVIDE_ERROR("invalid rounding mode");
+    }
+    return round;
+}
+
+#define LIBDIVIDE_ROUND_GEN(W, UIntT, IntT)                                                   \
+    static LIBDIVIDE_INLINE struct libdivide_u##W##_round_t libdivide_u##W##_round_gen(       \
+        UIntT d, enum libdivide_rounding rounding) {                                          \
+        struct libdivide_u##W##_t tmp = libdivide_u##W##_gen(d);                              \
+        struct libdivide_u##W##_round_t result;                                               \
+        result.magic = tmp.magic;                                                             \
+        result.more = tmp.more;                                                               \
+        result.round = (uint8_t)(libdivide_round_bits(0, rounding) & LIBDIVIDE_ROUND_BIAS);   \
+        return result;                                                                        \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE struct libdivide_u##W##_round_branchfree_t                        \
+        libdivide_u##W##_round_branchfree_gen(UIntT d, enum libdivide_rounding rounding) {    \
+        struct libdivide_u##W##_round_t tmp = libdivide_u##W##_round_gen(d, rounding);       \
+        struct libdivide_u##W##_branchfree_t bf = libdivide_u##W##_branchfree_gen(d);         \
+        struct libdivide_u##W##_round_branchfree_t result;                                    \
+        result.magic = bf.magic;                                                              \
+        result.more = bf.more;                                                                \
+        result.round = tmp.round;                                                             \
+        return result;                                                                        \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE UIntT libdivide_u##W##_round_do(                                  \
+        UIntT numer, const struct libdivide_u##W##_round_t *denom) {                          \
+        UIntT c = (UIntT)((numer != 0) & denom->round);                                       \
+        return (UIntT)(libdivide_u##W##_do_raw((UIntT)(numer - c), denom->magic, denom->more) + \
+                       c);                                                                    \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE UIntT libdivide_u##W##_round_branchfree_do(                       \
+        UIntT numer, const struct libdivide_u##W##_round_branchfree_t *denom) {               \
+        const struct libdivide_u##W##_branchfree_t bf = {denom->magic, denom->more};          \
+        UIntT c = (UIntT)((numer != 0) & denom->round);                                       \
+        return (UIntT)(libdivide_u##W##_branchfree_do((UIntT)(numer - c), &bf) + c);          \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE UIntT libdivide_u##W##_round_recover(                             \
+        const struct libdivide_u##W##_round_t *denom) {                                       \
+        const struct libdivide_u##W##_t tmp = {denom->magic, denom->more};                    \
+        return libdivide_u##W##_recover(&tmp);                                                \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE UIntT libdivide_u##W##_round_branchfree_recover(                  \
+        const struct libdivide_u##W##_round_branchfree_t *denom) {                            \
+        const struct libdivide_u##W##_branchfree_t bf = {denom->magic, denom->more};          \
+        return libdivide_u##W##_branchfree_recover(&bf);                                      \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE struct libdivide_s##W##_round_t libdivide_s##W##_round_gen(       \
+        IntT d, enum libdivide_rounding rounding) {                                           \
+        UIntT abs_d = d < 0 ? (UIntT)(0 - (UIntT)d) : (UIntT)d;                               \
+        struct libdivide_u##W##_t tmp = libdivide_u##W##_gen(abs_d);                          \
+        struct libdivide_s##W##_round_t result;                                               \
+        result.magic = tmp.magic;                                                             \
+        result.more = tmp.more;                                                               \
+        result.round = libdivide_round_bits(d < 0, rounding);                                 \
+        return result;                                                                        \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE struct libdivide_s##W##_round_branchfree_t                        \
+        libdivide_s##W##_round_branchfree_gen(IntT d, enum libdivide_rounding rounding) {     \
+        UIntT abs_d = d < 0 ? (UIntT)(0 - (UIntT)d) : (UIntT)d;                               \
+        struct libdivide_s##W##_round_branchfree_t result;                                    \
+        result.round = libdivide_round_bits(d < 0, rounding);                                 \
+        if (abs_d == 1) {                                                                     \
+            result.magic = 0;                                                                 \
+            result.more = 0;                                                                  \
+        } else {                                                                              \
+            struct libdivide_u##W##_branchfree_t tmp = libdivide_u##W##_branchfree_gen(abs_d); \
+            result.magic = tmp.magic;                                                         \
+            result.more = (uint8_t)(tmp.more + 1);                                            \
+        }                                                                                     \
+        return result;                                                                        \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE IntT libdivide_s##W##_round_do(                                   \
+        IntT numer, const struct libdivide_s##W##_round_t *denom) {                           \
+        uint8_t round = denom->round;                                                         \
+        UIntT sign = (UIntT)((int8_t)round >> 7);                                             \
+        UIntT biased = (UIntT)((UIntT)numer - (round & LIBDIVIDE_ROUND_BIAS));                \
+        UIntT s = (UIntT)((IntT)((UIntT)numer | biased) >> (W - 1));                          \
+        UIntT q = libdivide_u##W##_do_raw((UIntT)(biased ^ s), denom->magic, denom->more);    \
+        return (IntT)(UIntT)((UIntT)(q ^ s ^ sign) + ((round & LIBDIVIDE_ROUND_INCREMENT) >> 1)); \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE IntT libdivide_s##W##_round_branchfree_do(                        \
+        IntT numer, const struct libdivide_s##W##_round_branchfree_t *denom) {                \
+        uint8_t round = denom->round;                                                         \
+        UIntT sign = (UIntT)((int8_t)round >> 7);                                             \
+        UIntT biased = (UIntT)((UIntT)numer - (round & LIBDIVIDE_ROUND_BIAS));                \
+        UIntT s = (UIntT)((IntT)((UIntT)numer | biased) >> (W - 1));                          \
+        UIntT v = (UIntT)(biased ^ s);                                                        \
+        UIntT q = (UIntT)((UIntT)(v + libdivide_mullhi_u##W(v, denom->magic)) >> denom->more); \
+        return (IntT)(UIntT)((UIntT)(q ^ s ^ sign) + ((round & LIBDIVIDE_ROUND_INCREMENT) >> 1)); \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE IntT libdivide_s##W##_round_recover(                              \
+        const struct libdivide_s##W##_round_t *denom) {                                       \
+        const struct libdivide_u##W##_t tmp = {denom->magic, denom->more};                    \
+        UIntT abs_d = libdivide_u##W##_recover(&tmp);                                         \
+        return (IntT)((denom->round & LIBDIVIDE_NEGATIVE_DIVISOR) ? (UIntT)(0 - abs_d) : abs_d); \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE IntT libdivide_s##W##_round_branchfree_recover(                   \
+        const struct libdivide_s##W##_round_branchfree_t *denom) {                            \
+        UIntT abs_d;                                                                          \
+        if (denom->magic == 0) {                                                              \
+            abs_d = (UIntT)((UIntT)1 << denom->more);                                         \
+        } else {                                                                              \
+            const struct libdivide_u##W##_branchfree_t bf = {                                 \
+                denom->magic, (uint8_t)(denom->more - 1)};                                    \
+            abs_d = libdivide_u##W##_branchfree_recover(&bf);                                 \
+        }                                                                                     \
+        return (IntT)((denom->round & LIBDIVIDE_NEGATIVE_DIVISOR) ? (UIntT)(0 - abs_d) : abs_d); \
+    }
 
-////////// UINT16
+LIBDIVIDE_ROUND_GEN(16, uint16_t, int16_t)
+LIBDIVIDE_ROUND_GEN(32, uint32_t, int32_t)
+LIBDIVIDE_ROUND_GEN(64, uint64_t, int64_t)
 
-svuint16_t libdivide_u16_do_sve(svuint16_t numers, const struct libdivide_u16_t *denom) {
-    svbool_t pg = svptrue_b16();
-    uint8_t more = denom->more;
+////////// 128-BY-64 DIVISION
 
-    // power of 2 path
-    if (!denom->magic) {
-        return libdivide_u16_sve_srl(numers, more);
+// libdivide_128_div_64_to_64() computes a new quotient estimate on every
+// call. When many 128-bit numerators are divided by the same 64-bit d it
+// pays off to precompute the reciprocal of the normalized divisor once,
+// see Moller & Granlund, "Improved division by invariant integers",
+// algorithm 4: the quotient costs two multiplications and at most two
+// corrections (the second one is very unlikely).
+
+static LIBDIVIDE_INLINE struct libdivide_u128_u64_t libdivide_u128_u64_gen(uint64_t d) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
     }
+    struct libdivide_u128_u64_t result;
+    uint64_t rem_ignored;
+    result.shift = (uint8_t)libdivide_count_leading_zeros64(d);
+    result.d = d << result.shift;
+    // (2^128 - 1) / d - 2^64 = {~d, 2^64 - 1} / d, the quotient fits in
+    // 64 bits since ~d < d.
+    result.reciprocal = libdivide_128_div_64_to_64(~result.d, ~(uint64_t)0, result.d, &rem_ignored);
+    return result;
+}
 
-    svuint16_t q = svmulh_n_u16_x(pg, numers, denom->magic);
-    if (more & LIBDIVIDE_ADD_MARKER) {
-        // t = (numers + q) >> 1
-        uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
-        svuint16_t t = libdivide_u16_sve_hadd(numers, q);
-        return libdivide_u16_sve_srl(t, shift);
+// Returns {numhi, numlo} / d, stores the remainder in *r unless r is NULL.
+// The quotient must fit in 64 bits, i.e. numhi < d.
+static LIBDIVIDE_INLINE uint64_t libdivide_u128_u64_do(
+    uint64_t numhi, uint64_t numlo, const struct libdivide_u128_u64_t *denom, uint64_t *r) {
+    uint64_t d = denom->d;
+    int shift = denom->shift;
+    LIBDIVIDE_ASSERT(numhi < (d >> shift));
+
+    // Normalize the numerator like d, see libdivide_128_div_64_to_64()
+    // for the handling of shift == 0. numhi < d still holds.
+    uint64_t u1 = (numhi << shift) | ((numlo >> (-shift & 63)) & (uint64_t)(-(int64_t)shift >> 63));
+    uint64_t u0 = numlo << shift;
+
+    // {q1, q0} = reciprocal * u1 + {u1 + 1, u0}
+    uint64_t q0 = denom->reciprocal * u1;
+    uint64_t q1 = libdivide_mullhi_u64(denom->reciprocal, u1);
+    q0 += u0;
+    q1 += u1 + 1 + (q0 < u0);
+
+    // q1 is the quotient or one too large, the remainder is computed modulo
+    // 2^64 and compared with q0 to tell the two cases apart. The comparison
+    // is hard to predict, so the correction is applied using a mask.
+    uint64_t rem = u0 - q1 * d;
+    uint64_t mask = (uint64_t)0 - (uint64_t)(rem > q0);
+    q1 += mask;
+    rem += mask & d;
+    if (rem >= d) {
+        q1++;
+        rem -= d;
     }
+    if (r) {
+        *r = rem >> shift;
+    }
+    return q1;
+}
 
-    return libdivide_u16_sve_srl(q, more);
+static LIBDIVIDE_INLINE uint64_t libdivide_u128_u64_recover(
+    const struct libdivide_u128_u64_t *denom) {
+    return denom->d >> denom->shift;
 }
 
-svuint16_t libdivide_u16_branchfree_do_sve(
-    svuint16_t numers, const struct libdivide_u16_branchfree_t *denom) {
-    svbool_t pg = svptrue_b16();
-    // branchfree always uses the add-marker correction
-    svuint16_t q = svmulh_n_u16_x(pg, numers, denom->magic);
-    svuint16_t t = libdivide_u16_sve_hadd(numers, q);
-    return libdivide_u16_sve_srl(t, denom->more);
+////////// MODULAR MULTIPLICATION
+
+// Barrett reduction: for u32, q = mulhi(numer, floor((2^64 - 1) / m)) is
+// the quotient numer / m or one less, so one conditional subtraction
+// yields the remainder of any 64-bit numer. The 128-bit numerators of u64
+// are divided using libdivide_u128_u64_do(), whose reciprocal is the
+// Barrett constant of the normalized m.
+//
+// Montgomery reduction of t < m * 2^w for odd m: with u = t * m^-1 modulo
+// 2^w the low halves of t and u * m are equal, so (t - u * m) / 2^w is the
+// difference of the high halves, which lies in (-m, m) and is congruent
+// to t * 2^-w modulo m. Subtracting instead of adding u * m cannot
+// overflow for any m. Numbers in Montgomery form a * 2^w mod m are
+// multiplied using one product and one reduction.
+
+static LIBDIVIDE_INLINE struct libdivide_u32_reducer_t libdivide_u32_reducer_gen(uint32_t m) {
+    if (m == 0) {
+        LIBDIVIDE_ERROR("modulus must be != 0");
+    }
+    struct libdivide_u32_reducer_t result;
+    result.barrett = ~(uint64_t)0 / m;
+    result.m = m;
+    result.inverse = 0;
+    result.r2 = 0;
+    if (m & 1) {
+        result.inverse = (uint32_t)libdivide_inverse_u64(m);
+        result.r2 = libdivide_u32_reduce(~(uint64_t)0, &result) + 1;
+        result.r2 = result.r2 == m ? 0 : result.r2;
+    }
+    return result;
 }
 
-////////// UINT32
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_reduce(
+    uint64_t numer, const struct libdivide_u32_reducer_t *reducer) {
+    uint64_t q = libdivide_mullhi_u64(numer, reducer->barrett);
+    uint64_t rem = numer - q * reducer->m;
+    return (uint32_t)(rem >= reducer->m ? rem - reducer->m : rem);
+}
 
-svuint32_t libdivide_u32_do_sve(svuint32_t numers, const struct libdivide_u32_t *denom) {
-    svbool_t pg = svptrue_b32();
-    uint8_t more = denom->more;
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_mulmod(
+    uint32_t a, uint32_t b, const struct libdivide_u32_reducer_t *reducer) {
+    return libdivide_u32_reduce((uint64_t)a * b, reducer);
+}
 
-    // power of 2 path
-    if (!denom->magic) {
-        return libdivide_u32_sve_srl(numers, more);
-    }
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_montgomery_reduce(
+    uint64_t numer, const struct libdivide_u32_reducer_t *reducer) {
+    LIBDIVIDE_ASSERT(reducer->m & 1);
+    uint32_t u = (uint32_t)numer * reducer->inverse;
+    uint32_t hi = (uint32_t)(numer >> 32);
+    uint32_t um_hi = libdivide_mullhi_u32(u, reducer->m);
+    uint32_t rem = hi - um_hi;
+    return hi < um_hi ? rem + reducer->m : rem;
+}
 
-    svuint32_t q = svmulh_n_u32_x(pg, numers, denom->magic);
-    if (more & LIBDIVIDE_ADD_MARKER) {
-        // t = (numers + q) >> 1
-        uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-        svuint32_t t = libdivide_u32_sve_hadd(numers, q);
-        return libdivide_u32_sve_srl(t, shift);
-    }
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_to_montgomery(
+    uint32_t a, const struct libdivide_u32_reducer_t *reducer) {
+    return libdivide_u32_montgomery_reduce((uint64_t)a * reducer->r2, reducer);
+}
 
-    return libdivide_u32_sve_srl(q, more);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_from_montgomery(
+    uint32_t a, const struct libdivide_u32_reducer_t *reducer) {
+    return libdivide_u32_montgomery_reduce(a, reducer);
 }
 
-svuint32_t libdivide_u32_branchfree_do_sve(
-    svuint32_t numers, const struct libdivide_u32_branchfree_t *denom) {
-    svbool_t pg = svptrue_b32();
-    // branchfree always uses the add-marker correction
-    svuint32_t q = svmulh_n_u32_x(pg, numers, denom->magic);
-    svuint32_t t = libdivide_u32_sve_hadd(numers, q);
-    return libdivide_u32_sve_srl(t, denom->more);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_montgomery_mul(
+    uint32_t a, uint32_t b, const struct libdivide_u32_reducer_t *reducer) {
+    return libdivide_u32_montgomery_reduce((uint64_t)a * b, reducer);
 }
 
-////////// UINT64
+static LIBDIVIDE_INLINE struct libdivide_u64_reducer_t libdivide_u64_reducer_gen(uint64_t m) {
+    if (m == 0) {
+        LIBDIVIDE_ERROR("modulus must be != 0");
+    }
+    struct libdivide_u64_reducer_t result;
+    result.barrett = libdivide_u128_u64_gen(m);
+    result.m = m;
+    result.inverse = 0;
+    result.r2 = 0;
+    if (m & 1) {
+        // 2^64 mod m, squared
+        uint64_t r = (0 - m) % m;
+        result.inverse = libdivide_inverse_u64(m);
+        result.r2 = libdivide_u64_reduce(libdivide_mullhi_u64(r, r), r * r, &result);
+    }
+    return result;
+}
 
-svuint64_t libdivide_u64_do_sve(svuint64_t numers, const struct libdivide_u64_t *denom) {
-    svbool_t pg = svptrue_b64();
-    uint8_t more = denom->more;
+// The remainder of {numhi, numlo} by m, numhi may be >= m
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_reduce(
+    uint64_t numhi, uint64_t numlo, const struct libdivide_u64_reducer_t *reducer) {
+    uint64_t rem;
+    if (numhi >= reducer->m) {
+        libdivide_u128_u64_do(0, numhi, &reducer->barrett, &numhi);
+    }
+    libdivide_u128_u64_do(numhi, numlo, &reducer->barrett, &rem);
+    return rem;
+}
+
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_mulmod(
+    uint64_t a, uint64_t b, const struct libdivide_u64_reducer_t *reducer) {
+    return libdivide_u64_reduce(libdivide_mullhi_u64(a, b), a * b, reducer);
+}
+
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_montgomery_reduce(
+    uint64_t numhi, uint64_t numlo, const struct libdivide_u64_reducer_t *reducer) {
+    LIBDIVIDE_ASSERT(reducer->m & 1);
+    uint64_t u = numlo * reducer->inverse;
+    uint64_t um_hi = libdivide_mullhi_u64(u, reducer->m);
+    uint64_t rem = numhi - um_hi;
+    return numhi < um_hi ? rem + reducer->m : rem;
+}
+
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_to_montgomery(
+    uint64_t a, const struct libdivide_u64_reducer_t *reducer) {
+    return libdivide_u64_montgomery_reduce(
+        libdivide_mullhi_u64(a, reducer->r2), a * reducer->r2, reducer);
+}
+
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_from_montgomery(
+    uint64_t a, const struct libdivide_u64_reducer_t *reducer) {
+    return libdivide_u64_montgomery_reduce(0, a, reducer);
+}
+
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_montgomery_mul(
+    uint64_t a, uint64_t b, const struct libdivide_u64_reducer_t *reducer) {
+    return libdivide_u64_montgomery_reduce(libdivide_mullhi_u64(a, b), a * b, reducer);
+}
+
+// Square and multiply, in Montgomery form if m is odd
+#define LIBDIVIDE_POWMOD_GEN(ALGO, IntT)                                               \
+    static LIBDIVIDE_INLINE IntT libdivide_##ALGO##_powmod(                            \
+        IntT base, uint64_t exp, const struct libdivide_##ALGO##_reducer_t *reducer) { \
+        if (reducer->m & 1) {                                                          \
+            IntT x = libdivide_##ALGO##_to_montgomery(base, reducer);                  \
+            IntT result = libdivide_##ALGO##_to_montgomery(1, reducer);                \
+            for (; exp != 0; exp >>= 1) {                                              \
+                if (exp & 1) {                                                         \
+                    result = libdivide_##ALGO##_montgomery_mul(result, x, reducer);    \
+                }                                                                      \
+                x = libdivide_##ALGO##_montgomery_mul(x, x, reducer);                  \
+            }                                                                          \
+            return libdivide_##ALGO##_from_montgomery(result, reducer);                \
+        }                                                                              \
+        IntT x = libdivide_##ALGO##_mulmod(base, 1, reducer);                          \
+        IntT result = libdivide_##ALGO##_mulmod(1, 1, reducer);                        \
+        for (; exp != 0; exp >>= 1) {                                                  \
+            if (exp & 1) {                                                             \
+                result = libdivide_##ALGO##_mulmod(result, x, reducer);                \
+            }                                                                          \
+            x = libdivide_##ALGO##_mulmod(x, x, reducer);                              \
+        }                                                                              \
+        return result;                                                                 \
+    }
 
-    // power of 2 path
-    if (!denom->magic) {
-        return libdivide_u64_sve_srl(numers, more);
+LIBDIVIDE_POWMOD_GEN(u32, uint32_t)
+LIBDIVIDE_POWMOD_GEN(u64, uint64_t)
+
+// a + b and a - b modulo m for a, b < m. a + b may not fit in IntT, hence
+// a is compared with m - b instead.
+#define LIBDIVIDE_ADDMOD_GEN(ALGO, IntT)                                      \
+    static LIBDIVIDE_INLINE IntT libdivide_##ALGO##_addmod(                   \
+        IntT a, IntT b, const struct libdivide_##ALGO##_reducer_t *reducer) { \
+        IntT m_minus_b = (IntT)(reducer->m - b);                              \
+        return (IntT)(a >= m_minus_b ? a - m_minus_b : a + b);                \
+    }                                                                         \
+    static LIBDIVIDE_INLINE IntT libdivide_##ALGO##_submod(                   \
+        IntT a, IntT b, const struct libdivide_##ALGO##_reducer_t *reducer) { \
+        return (IntT)(a >= b ? a - b : a - b + reducer->m);                   \
     }
 
-    svuint64_t q = svmulh_n_u64_x(pg, numers, denom->magic);
-    if (more & LIBDIVIDE_ADD_MARKER) {
-        // t = (numers + q) >> 1
-        uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-        svuint64_t t = libdivide_u64_sve_hadd(numers, q);
-        return libdivide_u64_sve_srl(t, shift);
+LIBDIVIDE_ADDMOD_GEN(u32, uint32_t)
+LIBDIVIDE_ADDMOD_GEN(u64, uint64_t)
+
+////////// MULDIV
+
+// a * b / c without overflow of the product, e.g. to rescale timestamps
+// between clock rates. The 128-bit product is divided by |c| using the
+// reciprocal of libdivide_u128_u64_gen() instead of
+// libdivide_128_div_64_to_64(), the quotient must fit in 64 bits. The
+// rounding is applied to the magnitude of the truncated quotient using the
+// remainder, which also avoids adding c / 2 to the 128-bit product:
+//
+//     floor:   increment if rem != 0 and the quotient is negative
+//     ceil:    increment if rem != 0 and the quotient is positive
+//     euclid:  floor if c > 0, ceil if c < 0
+//     nearest: increment if rem >= |c| - rem
+
+static LIBDIVIDE_INLINE uint8_t libdivide_muldiv_bits(
+    int negative, enum libdivide_rounding rounding) {
+    uint8_t round = negative ? (uint8_t)LIBDIVIDE_NEGATIVE_DIVISOR : (uint8_t)0;
+    if (rounding == LIBDIVIDE_ROUND_FLOOR) {
+        round |= (uint8_t)LIBDIVIDE_MULDIV_UP_NEGATIVE;
+    } else if (rounding == LIBDIVIDE_ROUND_CEIL) {
+        round |= (uint8_t)LIBDIVIDE_MULDIV_UP_POSITIVE;
+    } else if (rounding == LIBDIVIDE_ROUND_EUCLID) {
+        round |= negative ? (uint8_t)LIBDIVIDE_MULDIV_UP_POSITIVE
+                          : (uint8_t)LIBDIVIDE_MULDIV_UP_NEGATIVE;
+    } else if (rounding == LIBDIVIDE_ROUND_NEAREST) {
+        round |= (uint8_t)LIBDIVIDE_MULDIV_NEAREST;
+    } else {
+        LIBDIVIDE_ERROR("invalid rounding mode");
     }
+    return round;
+}
 
-    return libdivide_u64_sve_srl(q, more);
+// Returns 1 if the magnitude of the truncated quotient is to be
+// incremented, negative is 1 if the quotient is negative.
+static LIBDIVIDE_INLINE uint64_t libdivide_muldiv_increment(
+    uint64_t rem, uint64_t abs_c, int negative, uint8_t round) {
+    uint64_t up = (uint64_t)(round >> (negative ? 0 : 1)) & (uint64_t)(rem != 0);
+    uint64_t nearest = (uint64_t)(round >> 2) & (uint64_t)(rem >= abs_c - rem);
+    return (up | nearest) & 1;
 }
 
-svuint64_t libdivide_u64_branchfree_do_sve(
-    svuint64_t numers, const struct libdivide_u64_branchfree_t *denom) {
-    svbool_t pg = svptrue_b64();
-    // branchfree always uses the add-marker correction
-    svuint64_t q = svmulh_n_u64_x(pg, numers, denom->magic);
-    svuint64_t t = libdivide_u64_sve_hadd(numers, q);
-    return libdivide_u64_sve_srl(t, denom->more);
+static LIBDIVIDE_INLINE struct libdivide_u64_muldiv_t libdivide_u64_muldiv_gen(
+    uint64_t c, enum libdivide_rounding rounding) {
+    struct libdivide_u64_muldiv_t result;
+    result.denom = libdivide_u128_u64_gen(c);
+    result.round = libdivide_muldiv_bits(0, rounding);
+    return result;
 }
 
-////////// SINT16
+static LIBDIVIDE_INLINE struct libdivide_s64_muldiv_t libdivide_s64_muldiv_gen(
+    int64_t c, enum libdivide_rounding rounding) {
+    struct libdivide_s64_muldiv_t result;
+    result.denom = libdivide_u128_u64_gen(c < 0 ? 0 - (uint64_t)c : (uint64_t)c);
+    result.round = libdivide_muldiv_bits(c < 0, rounding);
+    return result;
+}
 
-svint16_t libdivide_s16_do_sve(svint16_t numers, const struct libdivide_s16_t *denom) {
-    svbool_t pg = svptrue_b16();
-    uint8_t more = denom->more;
+// a * b / c, the rounded quotient must fit in uint64_t
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_muldiv_do(
+    uint64_t a, uint64_t b, const struct libdivide_u64_muldiv_t *denom) {
+    uint64_t rem;
+    uint64_t q = libdivide_u128_u64_do(libdivide_mullhi_u64(a, b), a * b, &denom->denom, &rem);
+    return q + libdivide_muldiv_increment(
+                   rem, libdivide_u128_u64_recover(&denom->denom), 0, denom->round);
+}
 
-    // power of 2 path
-    if (!denom->magic) {
-        uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
-        uint16_t mask = ((uint16_t)1 << shift) - 1;
+// a * b / c, the rounded quotient must fit in int64_t
+static LIBDIVIDE_INLINE int64_t libdivide_s64_muldiv_do(
+    int64_t a, int64_t b, const struct libdivide_s64_muldiv_t *denom) {
+    uint64_t abs_a = a < 0 ? 0 - (uint64_t)a : (uint64_t)a;
+    uint64_t abs_b = b < 0 ? 0 - (uint64_t)b : (uint64_t)b;
+    uint64_t rem;
+    uint64_t q = libdivide_u128_u64_do(
+        libdivide_mullhi_u64(abs_a, abs_b), abs_a * abs_b, &denom->denom, &rem);
+    // Sign mask of the quotient, if a * b is 0 so is the remainder
+    uint64_t sign = (uint64_t)((a ^ b) >> 63) ^ (uint64_t)((int8_t)denom->round >> 7);
+    q += libdivide_muldiv_increment(
+        rem, libdivide_u128_u64_recover(&denom->denom), (int)(sign & 1), denom->round);
+    return (int64_t)((q ^ sign) - sign);
+}
 
-        // q = (numers + ((numers < 0) ? mask : 0)) >> shift
-        svint16_t q =
-            svadd_s16_m(svcmplt_n_s16(pg, numers, 0), numers, svdup_n_s16((int16_t)mask));
-        q = libdivide_s16_sve_sra(q, shift);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_muldiv_recover(
+    const struct libdivide_u64_muldiv_t *denom) {
+    return libdivide_u128_u64_recover(&denom->denom);
+}
 
-        // flip sign if divisor was negative
-        svint16_t sign = svdup_n_s16((int8_t)more >> 7);
-        return svsub_s16_x(pg, sveor_s16_x(pg, q, sign), sign);
-    }
+static LIBDIVIDE_INLINE int64_t libdivide_s64_muldiv_recover(
+    const struct libdivide_s64_muldiv_t *denom) {
+    uint64_t abs_c = libdivide_u128_u64_recover(&denom->denom);
+    return (int64_t)((denom->round & LIBDIVIDE_NEGATIVE_DIVISOR) ? 0 - abs_c : abs_c);
+}
 
-    // magic multiply-high path
-    svint16_t q = svmulh_n_s16_x(pg, numers, denom->magic);
-    if (more & LIBDIVIDE_ADD_MARKER) {
-        // add numers back, adjusted for divisor sign
-        svint16_t sign = svdup_n_s16((int8_t)more >> 7);
-        q = svadd_s16_x(pg, q, svsub_s16_x(pg, sveor_s16_x(pg, numers, sign), sign));
+// results[i] = a[i] * b / c for i < count, results may be the same array
+// as a
+static LIBDIVIDE_INLINE void libdivide_u64_muldiv_array(const uint64_t *a, uint64_t b,
+    uint64_t *results, size_t count, const struct libdivide_u64_muldiv_t *denom) {
+    size_t i;
+    for (i = 0; i < count; i++) {
+        results[i] = libdivide_u64_muldiv_do(a[i], b, denom);
     }
-    q = libdivide_s16_sve_sra(q, more & LIBDIVIDE_16_SHIFT_MASK);
-    // round toward zero
-    return svsub_s16_x(pg, q, libdivide_s16_sve_signbits(q));
 }
 
-svint16_t libdivide_s16_branchfree_do_sve(
-    svint16_t numers, const struct libdivide_s16_branchfree_t *denom) {
-    svbool_t pg = svptrue_b16();
-    int16_t magic = denom->magic;
-    uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
-    svint16_t sign = svdup_n_s16((int8_t)more >> 7);
-    // branchfree starts with q = mullhi(numers, magic) + numers
-    svint16_t q = svmulh_n_s16_x(pg, numers, magic);
-    q = svadd_s16_x(pg, q, numers);
-    uint32_t is_power_of_2 = (magic == 0);
-    uint32_t mask = ((uint32_t)1 << shift) - is_power_of_2;
-    svint16_t mask_vec = svdup_n_s16((int16_t)mask);
-    // negative q needs a bias before arithmetic shift
-    q = svadd_s16_m(svcmplt_n_s16(pg, q, 0), q, mask_vec);
-    q = libdivide_s16_sve_sra(q, shift);
-    return svsub_s16_x(pg, sveor_s16_x(pg, q, sign), sign);
+static LIBDIVIDE_INLINE void libdivide_s64_muldiv_array(const int64_t *a, int64_t b,
+    int64_t *results, size_t count, const struct libdivide_s64_muldiv_t *denom) {
+    size_t i;
+    for (i = 0; i < count; i++) {
+        results[i] = libdivide_s64_muldiv_do(a[i], b, denom);
+    }
 }
 
-////////// SINT32
+////////// RATIONAL SCALING
 
-svint32_t libdivide_s32_do_sve(svint32_t numers, const struct libdivide_s32_t *denom) {
-    svbool_t pg = svptrue_b32();
-    uint8_t more = denom->more;
+// x * num / den for a fixed fraction, e.g. to convert sample rates or
+// units of whole arrays. With num = whole * den + rest the quotient is
+// x * whole + (x * rest + bias) / den, where bias is 0 for floor, den - 1
+// for ceil and den / 2 for round to nearest. Like the libdivide dividers
+// the second term is a multiplication by a rounded up reciprocal, with
+// k = w + shift and 2^shift >= den:
+//
+//     magic = ceil(2^k * rest / den), offset = ceil(2^k * bias / den)
+//     x * magic + offset = 2^k * (x * rest + bias) / den + e
+//
+// where 0 <= e < x + 1 <= 2^w <= 2^k / den, so shifting the left side right
+// by k yields the exact quotient for any w-bit x. magic and offset have 2w
+// bits, the products are assembled from w-bit by w-bit multiplications,
+// which the vector kernels have too.
+
+static LIBDIVIDE_INLINE uint64_t libdivide_scaler_bias(
+    uint64_t den, enum libdivide_rounding rounding) {
+    uint64_t bias = 0;
+    if (rounding == LIBDIVIDE_ROUND_CEIL) {
+        bias = den - 1;
+    } else if (rounding == LIBDIVIDE_ROUND_NEAREST) {
+        bias = den / 2;
+    } else if (rounding != LIBDIVIDE_ROUND_FLOOR && rounding != LIBDIVIDE_ROUND_EUCLID) {
+        LIBDIVIDE_ERROR("invalid rounding mode");
+    }
+    return bias;
+}
 
-    // power of 2 path
-    if (!denom->magic) {
-        uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-        uint32_t mask = ((uint32_t)1 << shift) - 1;
+// ceil(n * 2^(32 + shift) / d) for n < d and shift <= 32
+static LIBDIVIDE_INLINE uint64_t libdivide_u32_scaler_magic(uint64_t n, uint64_t d, int shift) {
+    uint64_t rem;
+    uint64_t numhi = n >> (32 - shift);
+    uint64_t numlo = shift == 32 ? 0 : n << (32 + shift);
+    uint64_t q = libdivide_128_div_64_to_64(numhi, numlo, d, &rem);
+    return q + (rem != 0);
+}
+
+// ceil(n * 2^(64 + shift) / d) for n < d and shift <= 64, returns the low
+// half and stores the high half in *hi
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_scaler_magic(
+    uint64_t n, uint64_t d, int shift, uint64_t *hi) {
+    uint64_t rem_hi, rem_lo;
+    uint64_t numhi = shift == 0 ? 0 : n >> (64 - shift);
+    uint64_t numlo = shift == 64 ? 0 : n << shift;
+    *hi = libdivide_128_div_64_to_64(numhi, numlo, d, &rem_hi);
+    uint64_t lo = libdivide_128_div_64_to_64(rem_hi, 0, d, &rem_lo) + (rem_lo != 0);
+    *hi += (uint64_t)(lo == 0 && rem_lo != 0);
+    return lo;
+}
+
+static LIBDIVIDE_INLINE struct libdivide_u32_scaler_t libdivide_u32_scaler_gen(
+    uint32_t num, uint32_t den, enum libdivide_rounding rounding, int saturate) {
+    if (den == 0) {
+        LIBDIVIDE_ERROR("denominator must be != 0");
+    }
+    struct libdivide_u32_scaler_t result;
+    int shift = den == 1 ? 0 : 32 - libdivide_count_leading_zeros32(den - 1);
+    result.magic = libdivide_u32_scaler_magic(num % den, den, shift);
+    result.offset = libdivide_u32_scaler_magic(libdivide_scaler_bias(den, rounding), den, shift);
+    result.whole = num / den;
+    result.shift = (uint8_t)shift;
+    result.saturate = saturate ? 1 : 0;
+    return result;
+}
 
-        // q = (numers + ((numers < 0) ? mask : 0)) >> shift
-        svint32_t q =
-            svadd_s32_m(svcmplt_n_s32(pg, numers, 0), numers, svdup_n_s32((int32_t)mask));
-        q = libdivide_s32_sve_sra(q, shift);
-
-        // flip sign if divisor was negative
-        svint32_t sign = svdup_n_s32((int8_t)more >> 7);
-        return svsub_s32_x(pg, sveor_s32_x(pg, q, sign), sign);
-    }
-
-    // magic multiply-high path
-    svint32_t q = svmulh_n_s32_x(pg, numers, denom->magic);
-    if (more & LIBDIVIDE_ADD_MARKER) {
-        // add numers back, adjusted for divisor sign
-        svint32_t sign = svdup_n_s32((int8_t)more >> 7);
-        q = svadd_s32_x(pg, q, svsub_s32_x(pg, sveor_s32_x(pg, numers, sign), sign));
+static LIBDIVIDE_INLINE struct libdivide_u64_scaler_t libdivide_u64_scaler_gen(
+    uint64_t num, uint64_t den, enum libdivide_rounding rounding, int saturate) {
+    if (den == 0) {
+        LIBDIVIDE_ERROR("denominator must be != 0");
     }
-    q = libdivide_s32_sve_sra(q, more & LIBDIVIDE_32_SHIFT_MASK);
-    // round toward zero
-    return svsub_s32_x(pg, q, libdivide_s32_sve_signbits(q));
+    struct libdivide_u64_scaler_t result;
+    int shift = den == 1 ? 0 : 64 - libdivide_count_leading_zeros64(den - 1);
+    result.magic_lo = libdivide_u64_scaler_magic(num % den, den, shift, &result.magic_hi);
+    result.offset_lo = libdivide_u64_scaler_magic(
+        libdivide_scaler_bias(den, rounding), den, shift, &result.offset_hi);
+    result.whole = num / den;
+    result.shift = (uint8_t)shift;
+    result.saturate = saturate ? 1 : 0;
+    return result;
 }
 
-svint32_t libdivide_s32_branchfree_do_sve(
-    svint32_t numers, const struct libdivide_s32_branchfree_t *denom) {
-    svbool_t pg = svptrue_b32();
-    int32_t magic = denom->magic;
-    uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-    svint32_t sign = svdup_n_s32((int8_t)more >> 7);
-    // branchfree starts with q = mullhi(numers, magic) + numers
-    svint32_t q = svmulh_n_s32_x(pg, numers, magic);
-    q = svadd_s32_x(pg, q, numers);
-    uint32_t is_power_of_2 = (magic == 0);
-    uint32_t mask = ((uint32_t)1 << shift) - is_power_of_2;
-    svint32_t mask_vec = svdup_n_s32((int32_t)mask);
-    // negative q needs a bias before arithmetic shift
-    q = svadd_s32_m(svcmplt_n_s32(pg, q, 0), q, mask_vec);
-    q = libdivide_s32_sve_sra(q, shift);
-    return svsub_s32_x(pg, sveor_s32_x(pg, q, sign), sign);
+// x * num / den, the quotient wraps modulo 2^32 or saturates
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_scaler_do(
+    uint32_t x, const struct libdivide_u32_scaler_t *scaler) {
+    // t = (x * magic + offset) >> 32, which fits in 64 bits
+    uint64_t p_lo = (uint64_t)x * (uint32_t)scaler->magic;
+    uint64_t p_hi = (uint64_t)x * (scaler->magic >> 32);
+    uint64_t low = ((p_lo & 0xFFFFFFFF) + (scaler->offset & 0xFFFFFFFF)) >> 32;
+    uint64_t t = p_hi + (p_lo >> 32) + (scaler->offset >> 32) + low;
+    // Less than 2^64 as the fraction is at most x
+    uint64_t q = (uint64_t)x * scaler->whole + (t >> scaler->shift);
+    uint64_t over = (uint64_t)0 - (uint64_t)(scaler->saturate & (q > 0xFFFFFFFF));
+    return (uint32_t)(q | over);
+}
+
+// x * num / den, the quotient wraps modulo 2^64 or saturates
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_scaler_do(
+    uint64_t x, const struct libdivide_u64_scaler_t *scaler) {
+#if defined(HAS_INT128_T)
+    // t = (x * magic + offset) >> 64, neither sum overflows
+    __uint128_t t = ((__uint128_t)x * scaler->magic_lo + scaler->offset_lo) >> 64;
+    t += (__uint128_t)x * scaler->magic_hi + scaler->offset_hi;
+    __uint128_t q = (__uint128_t)x * scaler->whole + (uint64_t)(t >> scaler->shift);
+    uint64_t over = (uint64_t)0 - (uint64_t)(scaler->saturate & ((q >> 64) != 0));
+    return (uint64_t)q | over;
+#else
+    // {t_hi, t_lo} = (x * magic + offset) >> 64
+    uint64_t lo0 = x * scaler->magic_lo;
+    uint64_t sum0 = lo0 + scaler->offset_lo;
+    uint64_t hi0 = libdivide_mullhi_u64(x, scaler->magic_lo) + (sum0 < lo0);
+    uint64_t u = hi0 + scaler->offset_hi;
+    uint64_t lo1 = x * scaler->magic_hi;
+    uint64_t t_lo = u + lo1;
+    uint64_t t_hi = libdivide_mullhi_u64(x, scaler->magic_hi) + (u < hi0) + (t_lo < lo1);
+    int shift = scaler->shift;
+    uint64_t frac = shift == 64 ? t_hi : (t_lo >> shift) | ((t_hi << (63 - shift)) << 1);
+    uint64_t prod = x * scaler->whole;
+    uint64_t q = prod + frac;
+    uint64_t over = libdivide_mullhi_u64(x, scaler->whole) | (uint64_t)(q < prod);
+    over = (uint64_t)0 - (uint64_t)(scaler->saturate & (over != 0));
+    return q | over;
+#endif
 }
 
-////////// SINT64
-
-svint64_t libdivide_s64_do_sve(svint64_t numers, const struct libdivide_s64_t *denom) {
-    svbool_t pg = svptrue_b64();
-    uint8_t more = denom->more;
-    int64_t magic = denom->magic;
-
-    // power of 2 path
-    if (magic == 0) {
-        uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-        uint64_t mask = ((uint64_t)1 << shift) - 1;
-
-        // q = (numers + ((numers < 0) ? mask : 0)) >> shift
-        svint64_t q =
-            svadd_s64_m(svcmplt_n_s64(pg, numers, 0), numers, svdup_n_s64((int64_t)mask));
-        q = libdivide_s64_sve_sra(q, shift);
+////////// FIXED POINT DIVISION
 
-        // flip sign if divisor was negative
-        svint64_t sign = svdup_n_s64((int8_t)more >> 7);
-        return svsub_s64_x(pg, sveor_s64_x(pg, q, sign), sign);
+// (n << k) / d for a fixed number of fraction bits k <= w, e.g. Q16.16
+// ratios or Q0.32 fractions, without the wider numerator n << k. The
+// factor 2^k is folded into the magic number: with
+//
+//     magic = ceil(2^(2w + k) / d) = 2^2w * 2^k / d + e, 0 <= e < 1
+//     n * magic / 2^2w = n * 2^k / d + n * e / 2^2w
+//
+// the error n * e / 2^2w < 2^-w < 1 / d is less than the distance of
+// n * 2^k / d to the next larger integer, so the high part of the product
+// is the exact quotient. The quotients wrap modulo 2^w like n << k, the
+// bits of magic from 2^3w on only add multiples of 2^w and are dropped.
+// There is no shift: u16 takes one 64-bit multiplication, u32 the high
+// half of a 64-bit product plus a 32-bit one.
+
+static LIBDIVIDE_INLINE struct libdivide_u16_fixed_t libdivide_u16_fixed_gen(
+    uint16_t d, int frac_bits) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
     }
-
-    // magic multiply-high path
-    svint64_t q = svmulh_n_s64_x(pg, numers, magic);
-    if (more & LIBDIVIDE_ADD_MARKER) {
-        // add numers back, adjusted for divisor sign
-        svint64_t sign = svdup_n_s64((int8_t)more >> 7);
-        q = svadd_s64_x(pg, q, svsub_s64_x(pg, sveor_s64_x(pg, numers, sign), sign));
+    if (frac_bits < 0 || frac_bits > 16) {
+        LIBDIVIDE_ERROR("frac_bits must be between 0 and 16");
     }
-    q = libdivide_s64_sve_sra(q, more & LIBDIVIDE_64_SHIFT_MASK);
-    // round toward zero
-    return svsub_s64_x(pg, q, libdivide_s64_sve_signbits(q));
+    struct libdivide_u16_fixed_t result;
+    uint64_t numer = (uint64_t)1 << (32 + frac_bits);
+    result.magic = ((numer - 1) / d + 1) & UINT64_C(0xFFFFFFFFFFFF);
+    return result;
 }
 
-svint64_t libdivide_s64_branchfree_do_sve(
-    svint64_t numers, const struct libdivide_s64_branchfree_t *denom) {
-    svbool_t pg = svptrue_b64();
-    int64_t magic = denom->magic;
-    uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-    svint64_t sign = svdup_n_s64((int8_t)more >> 7);
-    // branchfree starts with q = mullhi(numers, magic) + numers
-    svint64_t q = svmulh_n_s64_x(pg, numers, magic);
-    q = svadd_s64_x(pg, q, numers);
-    uint64_t is_power_of_2 = (magic == 0);
-    svint64_t mask = svdup_n_s64((int64_t)(((uint64_t)1 << shift) - is_power_of_2));
-    // negative q needs a bias before arithmetic shift
-    q = svadd_s64_m(svcmplt_n_s64(pg, q, 0), q, mask);
-    q = libdivide_s64_sve_sra(q, shift);
-    return svsub_s64_x(pg, sveor_s64_x(pg, q, sign), sign);
+static LIBDIVIDE_INLINE struct libdivide_u32_fixed_t libdivide_u32_fixed_gen(
+    uint32_t d, int frac_bits) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+    if (frac_bits < 0 || frac_bits > 32) {
+        LIBDIVIDE_ERROR("frac_bits must be between 0 and 32");
+    }
+    struct libdivide_u32_fixed_t result;
+    // Long division of 2^(64 + frac_bits) by d, rounded up
+    uint64_t rem;
+    uint64_t pow = (uint64_t)1 << frac_bits;
+    uint64_t lo = libdivide_128_div_64_to_64(pow % d, 0, d, &rem) + (rem != 0);
+    result.magic_lo = lo;
+    result.magic_hi = (uint32_t)(pow / d + (lo == 0 && rem != 0));
+    return result;
 }
 
-#endif
-
-#if defined(LIBDIVIDE_AVX512)
-
-static LIBDIVIDE_INLINE __m512i libdivide_u16_do_vec512(
-    __m512i numers, const struct libdivide_u16_t *denom);
-static LIBDIVIDE_INLINE __m512i libdivide_s16_do_vec512(
-    __m512i numers, const struct libdivide_s16_t *denom);
-static LIBDIVIDE_INLINE __m512i libdivide_u32_do_vec512(
-    __m512i numers, const struct libdivide_u32_t *denom);
-static LIBDIVIDE_INLINE __m512i libdivide_s32_do_vec512(
-    __m512i numers, const struct libdivide_s32_t *denom);
-static LIBDIVIDE_INLINE __m512i libdivide_u64_do_vec512(
-    __m512i numers, const struct libdivide_u64_t *denom);
-static LIBDIVIDE_INLINE __m512i libdivide_s64_do_vec512(
-    __m512i numers, const struct libdivide_s64_t *denom);
-
-static LIBDIVIDE_INLINE __m512i libdivide_u16_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_u16_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m512i libdivide_s16_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_s16_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m512i libdivide_u32_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_u32_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m512i libdivide_s32_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_s32_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m512i libdivide_u64_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_u64_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m512i libdivide_s64_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_s64_branchfree_t *denom);
-
-//////// Internal Utility Functions
-
-static LIBDIVIDE_INLINE __m512i libdivide_s64_signbits_vec512(__m512i v) {
-    ;
-    return _mm512_srai_epi64(v, 63);
+static LIBDIVIDE_INLINE struct libdivide_u64_fixed_t libdivide_u64_fixed_gen(
+    uint64_t d, int frac_bits) {
+    if (d == 0) {
+        LIBDIVIDE_ERROR("divider must be != 0");
+    }
+    if (frac_bits < 0 || frac_bits > 64) {
+        LIBDIVIDE_ERROR("frac_bits must be between 0 and 64");
+    }
+    struct libdivide_u64_fixed_t result;
+    // Long division of 2^(128 + frac_bits) by d, rounded up. For
+    // frac_bits = 64 the quotient 2^192 / d of the leading word is dropped.
+    uint64_t rem;
+    uint64_t numhi = frac_bits == 64 ? 1 % d : 0;
+    uint64_t numlo = frac_bits == 64 ? 0 : (uint64_t)1 << frac_bits;
+    uint64_t hi = libdivide_128_div_64_to_64(numhi, numlo, d, &rem);
+    uint64_t mid = libdivide_128_div_64_to_64(rem, 0, d, &rem);
+    uint64_t lo = libdivide_128_div_64_to_64(rem, 0, d, &rem);
+    uint64_t carry = (uint64_t)(rem != 0);
+    lo += carry;
+    carry &= (uint64_t)(lo == 0);
+    mid += carry;
+    carry &= (uint64_t)(mid == 0);
+    result.magic_lo = lo;
+    result.magic_mid = mid;
+    result.magic_hi = hi + carry;
+    return result;
 }
 
-static LIBDIVIDE_INLINE __m512i libdivide_s64_shift_right_vec512(__m512i v, int amt) {
-    return _mm512_srai_epi64(v, amt);
+static LIBDIVIDE_INLINE uint16_t libdivide_u16_fixed_do(
+    uint16_t numer, const struct libdivide_u16_fixed_t *denom) {
+    return (uint16_t)(((uint64_t)numer * denom->magic) >> 32);
 }
 
-// Here, b is assumed to contain one 32-bit value repeated.
-static LIBDIVIDE_INLINE __m512i libdivide_mullhi_u32_vec512(__m512i a, __m512i b) {
-    __m512i hi_product_0Z2Z = _mm512_srli_epi64(_mm512_mul_epu32(a, b), 32);
-    __m512i a1X3X = _mm512_srli_epi64(a, 32);
-    __m512i mask = _mm512_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0);
-    __m512i hi_product_Z1Z3 = _mm512_and_si512(_mm512_mul_epu32(a1X3X, b), mask);
-    return _mm512_or_si512(hi_product_0Z2Z, hi_product_Z1Z3);
+static LIBDIVIDE_INLINE uint32_t libdivide_u32_fixed_do(
+    uint32_t numer, const struct libdivide_u32_fixed_t *denom) {
+    return (uint32_t)libdivide_mullhi_u64(numer, denom->magic_lo) + numer * denom->magic_hi;
 }
 
-// b is one 32-bit value repeated.
-static LIBDIVIDE_INLINE __m512i libdivide_mullhi_s32_vec512(__m512i a, __m512i b) {
-    __m512i hi_product_0Z2Z = _mm512_srli_epi64(_mm512_mul_epi32(a, b), 32);
-    __m512i a1X3X = _mm512_srli_epi64(a, 32);
-    __m512i mask = _mm512_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0);
-    __m512i hi_product_Z1Z3 = _mm512_and_si512(_mm512_mul_epi32(a1X3X, b), mask);
-    return _mm512_or_si512(hi_product_0Z2Z, hi_product_Z1Z3);
+static LIBDIVIDE_INLINE uint64_t libdivide_u64_fixed_do(
+    uint64_t numer, const struct libdivide_u64_fixed_t *denom) {
+#if defined(HAS_INT128_T)
+    // Neither sum overflows
+    __uint128_t t = ((__uint128_t)numer * denom->magic_lo) >> 64;
+    t += (__uint128_t)numer * denom->magic_mid;
+    return (uint64_t)(t >> 64) + numer * denom->magic_hi;
+#else
+    uint64_t lo = numer * denom->magic_mid;
+    uint64_t sum = lo + libdivide_mullhi_u64(numer, denom->magic_lo);
+    return numer * denom->magic_hi + libdivide_mullhi_u64(numer, denom->magic_mid) +
+           (uint64_t)(sum < lo);
+#endif
 }
 
-// Here, y is assumed to contain one 64-bit value repeated.
-static LIBDIVIDE_INLINE __m512i libdivide_mullhi_u64_vec512(__m512i x, __m512i y) {
-    // see m128i variant for comments.
-    __m512i x0y0 = _mm512_mul_epu32(x, y);
-    __m512i x0y0_hi = _mm512_srli_epi64(x0y0, 32);
+////////// FLOATING POINT RECIPROCAL
 
-    __m512i x1 = _mm512_shuffle_epi32(x, (_MM_PERM_ENUM)_MM_SHUFFLE(3, 3, 1, 1));
-    __m512i y1 = _mm512_shuffle_epi32(y, (_MM_PERM_ENUM)_MM_SHUFFLE(3, 3, 1, 1));
+// x86 vector ISAs lack a high multiplication of 32-bit lanes, the
+// integer algorithm emulates it with two mul_epu32 and shuffles. The fp
+// dividers instead convert the numerators to double (float for 16-bit
+// integers), multiply by recip = (1 + delta) / d and truncate. test/benchmark.h
+// compares both vector algorithms, neither is always faster.
+//
+// delta is 2^-50 (2^-21 for float) +- the rounding of the division, so
+// 0 < delta < 2^-49 (2^-20). With n, d >= 0 (the signed case is the same
+// for the absolute values), n < 2^w and p the precision of the floating
+// point type (w = 32, p = 53 or w = 16, p = 24):
+//
+// * n * recip >= n / d. If n is a multiple of d the rounded product is not
+//   below the representable integer n / d, otherwise n / d is at least 1 / d
+//   above floor(n / d), far more than the rounding error.
+// * n * recip - n / d < 2^w * delta / d and rounding the product adds about
+//   2^(w - p) / d. Both together are less than 1 / d, the smallest distance
+//   between n / d and the next larger integer.
+//
+// So truncation always yields the exact quotient and no correction step
+// is needed. The s32 quotient INT32_MIN / -1 wraps like the integer
+// algorithm, which is why the conversion goes through the wider WideT.
+
+#define LIBDIVIDE_FP_GEN(ALGO, IntT, FloatT, WideT, ONE_PLUS_DELTA)                       \
+    static LIBDIVIDE_INLINE struct libdivide_##ALGO##_fp_t libdivide_##ALGO##_fp_gen(IntT d) { \
+        if (d == 0) {                                                                     \
+            LIBDIVIDE_ERROR("divider must be != 0");                                      \
+        }                                                                                 \
+        struct libdivide_##ALGO##_fp_t result;                                            \
+        result.recip = (FloatT)(ONE_PLUS_DELTA / (FloatT)d);                              \
+        return result;                                                                    \
+    }                                                                                     \
+    static LIBDIVIDE_INLINE IntT libdivide_##ALGO##_fp_do(                                \
+        IntT numer, const struct libdivide_##ALGO##_fp_t *denom) {                        \
+        return (IntT)(WideT)((FloatT)numer * denom->recip);                               \
+    }                                                                                     \
+    static LIBDIVIDE_INLINE IntT libdivide_##ALGO##_fp_recover(                           \
+        const struct libdivide_##ALGO##_fp_t *denom) {                                    \
+        double d = 1.0 / (double)denom->recip;                                            \
+        return (IntT)(WideT)(d < 0 ? d - 0.5 : d + 0.5);                                  \
+    }
 
-    __m512i x0y1 = _mm512_mul_epu32(x, y1);
-    __m512i x1y0 = _mm512_mul_epu32(x1, y);
-    __m512i x1y1 = _mm512_mul_epu32(x1, y1);
+LIBDIVIDE_FP_GEN(u16, uint16_t, float, int32_t, (1.0f + 1.0f / 2097152.0f))
+LIBDIVIDE_FP_GEN(s16, int16_t, float, int32_t, (1.0f + 1.0f / 2097152.0f))
+LIBDIVIDE_FP_GEN(u32, uint32_t, double, int64_t, (1.0 + 1.0 / 1125899906842624.0))
+LIBDIVIDE_FP_GEN(s32, int32_t, double, int64_t, (1.0 + 1.0 / 1125899906842624.0))
+
+////////// DICTIONARY DIVIDERS
+
+// A dictionary holds the dividers of denoms[0], ..., denoms[count - 1],
+// count must be between 1 and 16. The unused codes repeat the first
+// divider so that the vector kernels, which only use the low 4 bits of
+// the codes, never select an invalid divider. dict_do() masks the code the
+// same way, so a code >= 16 divides by the same divider on every path.
+#define LIBDIVIDE_DICT_GEN(ALGO, IntT)                                                             \
+    static LIBDIVIDE_INLINE struct libdivide_##ALGO##_dict_t libdivide_##ALGO##_dict_gen(          \
+        const IntT *denoms, size_t count) {                                                        \
+        struct libdivide_##ALGO##_dict_t dict;                                                     \
+        if (count == 0 || count > 16) {                                                            \
+            LIBDIVIDE_ERROR("dictionary must hold 1 to 16 dividers");                              \
+        }                                                                                          \
+        for (size_t k = 0; k < 16; k++) {                                                          \
+            struct libdivide_##ALGO##_t denom = libdivide_##ALGO##_gen(denoms[k < count ? k : 0]); \
+            dict.magic[k] = denom.magic;                                                           \
+            dict.more[k] = denom.more;                                                             \
+        }                                                                                          \
+        return dict;                                                                               \
+    }                                                                                              \
+    static LIBDIVIDE_INLINE IntT libdivide_##ALGO##_dict_do(                                       \
+        IntT numer, uint8_t code, const struct libdivide_##ALGO##_dict_t *dict) {                  \
+        struct libdivide_##ALGO##_t denom;                                                         \
+        denom.magic = dict->magic[code & 15];                                                      \
+        denom.more = dict->more[code & 15];                                                        \
+        return libdivide_##ALGO##_do(numer, &denom);                                               \
+    }
 
-    __m512i mask = _mm512_set1_epi64(0xFFFFFFFF);
-    __m512i temp = _mm512_add_epi64(x1y0, x0y0_hi);
-    __m512i temp_lo = _mm512_and_si512(temp, mask);
-    __m512i temp_hi = _mm512_srli_epi64(temp, 32);
+// The 16-bit dictionaries divide by the 32-bit dividers of the same
+// denominators, the s16 quotient INT16_MIN / -1 wraps when it is truncated.
+#define LIBDIVIDE_DICT16_GEN(ALGO, IntT, WALGO, WideT)                                    \
+    static LIBDIVIDE_INLINE struct libdivide_##ALGO##_dict_t libdivide_##ALGO##_dict_gen( \
+        const IntT *denoms, size_t count) {                                               \
+        struct libdivide_##ALGO##_dict_t dict;                                            \
+        WideT wide[16];                                                                   \
+        for (size_t k = 0; k < count && k < 16; k++) {                                    \
+            wide[k] = denoms[k];                                                          \
+        }                                                                                 \
+        dict.wide = libdivide_##WALGO##_dict_gen(wide, count);                            \
+        return dict;                                                                      \
+    }                                                                                     \
+    static LIBDIVIDE_INLINE IntT libdivide_##ALGO##_dict_do(                              \
+        IntT numer, uint8_t code, const struct libdivide_##ALGO##_dict_t *dict) {         \
+        return (IntT)libdivide_##WALGO##_dict_do(numer, code, &dict->wide);               \
+    }
 
-    temp_lo = _mm512_srli_epi64(_mm512_add_epi64(temp_lo, x0y1), 32);
-    temp_hi = _mm512_add_epi64(x1y1, temp_hi);
-    return _mm512_add_epi64(temp_lo, temp_hi);
-}
+LIBDIVIDE_DICT_GEN(u32_branchfree, uint32_t)
+LIBDIVIDE_DICT_GEN(s32_branchfree, int32_t)
+LIBDIVIDE_DICT_GEN(u64_branchfree, uint64_t)
+LIBDIVIDE_DICT_GEN(s64_branchfree, int64_t)
+LIBDIVIDE_DICT16_GEN(u16_branchfree, uint16_t, u32_branchfree, uint32_t)
+LIBDIVIDE_DICT16_GEN(s16_branchfree, int16_t, s32_branchfree, int32_t)
 
-// y is one 64-bit value repeated.
-static LIBDIVIDE_INLINE __m512i libdivide_mullhi_s64_vec512(__m512i x, __m512i y) {
-    __m512i p = libdivide_mullhi_u64_vec512(x, y);
-    __m512i t1 = _mm512_and_si512(libdivide_s64_signbits_vec512(x), y);
-    __m512i t2 = _mm512_and_si512(libdivide_s64_signbits_vec512(y), x);
-    p = _mm512_sub_epi64(p, t1);
-    p = _mm512_sub_epi64(p, t2);
-    return p;
-}
+// Simplest possible vector type division: treat the vector type as an array
+// of underlying native type.
+//
+// Use a union to read a vector via pointer-to-integer, without violating strict
+// aliasing.
+#define SIMPLE_VECTOR_DIVISION(IntT, VecT, Algo)                          \
+    const size_t count = sizeof(VecT) / sizeof(IntT);                     \
+    union type_pun_vec {                                                  \
+        VecT vec;                                                         \
+        IntT arr[sizeof(VecT) / sizeof(IntT)];                            \
+    };                                                                    \
+    union type_pun_vec result;                                            \
+    union type_pun_vec input;                                             \
+    input.vec = numers;                                                   \
+    for (size_t loop = 0; loop < count; ++loop) {                         \
+        result.arr[loop] = libdivide_##Algo##_do(input.arr[loop], denom); \
+    }                                                                     \
+    return result.vec;
 
-////////// UINT16
+// Generates libdivide_<ALGO>_remainder_<SUFFIX>() on top of the vector
+// divmod function.
+#define LIBDIVIDE_REMAINDER_VEC_GEN(ALGO, IntT, VecT, SUFFIX)            \
+    static LIBDIVIDE_INLINE VecT libdivide_##ALGO##_remainder_##SUFFIX(  \
+        VecT numers, IntT d, const struct libdivide_##ALGO##_t *denom) { \
+        VecT rem;                                                        \
+        libdivide_##ALGO##_divmod_##SUFFIX(numers, d, denom, &rem);      \
+        return rem;                                                      \
+    }
 
-__m512i libdivide_u16_do_vec512(__m512i numers, const struct libdivide_u16_t *denom){
-    SIMPLE_VECTOR_DIVISION(uint16_t, __m512i, u16)}
+// Generates the vector divmod and remainder functions, the remainders are
+// numers - q * d computed using the vector instructions SET1, MULLO
+// (low half of the product) and SUB.
+#define LIBDIVIDE_DIVMOD_VEC_GEN(ALGO, IntT, VecT, SUFFIX, SET1, MULLO, SUB)        \
+    static LIBDIVIDE_INLINE VecT libdivide_##ALGO##_divmod_##SUFFIX(                \
+        VecT numers, IntT d, const struct libdivide_##ALGO##_t *denom, VecT *rem) { \
+        VecT q = libdivide_##ALGO##_do_##SUFFIX(numers, denom);                     \
+        *rem = SUB(numers, MULLO(q, SET1(d)));                                      \
+        return q;                                                                   \
+    }                                                                               \
+    LIBDIVIDE_REMAINDER_VEC_GEN(ALGO, IntT, VecT, SUFFIX)
+
+// Like SIMPLE_VECTOR_DIVISION, for vector types without a suitable
+// multiplication instruction.
+#define LIBDIVIDE_DIVMOD_VEC_SIMPLE_GEN(ALGO, IntT, VecT, SUFFIX)                      \
+    static LIBDIVIDE_INLINE VecT libdivide_##ALGO##_divmod_##SUFFIX(                   \
+        VecT numers, IntT d, const struct libdivide_##ALGO##_t *denom, VecT *rem) {    \
+        union type_pun_vec {                                                           \
+            VecT vec;                                                                  \
+            IntT arr[sizeof(VecT) / sizeof(IntT)];                                     \
+        };                                                                             \
+        union type_pun_vec quots;                                                      \
+        union type_pun_vec rems;                                                       \
+        union type_pun_vec input;                                                      \
+        input.vec = numers;                                                            \
+        for (size_t loop = 0; loop < sizeof(VecT) / sizeof(IntT); ++loop) {            \
+            quots.arr[loop] =                                                          \
+                libdivide_##ALGO##_divmod(input.arr[loop], d, denom, &rems.arr[loop]); \
+        }                                                                              \
+        *rem = rems.vec;                                                               \
+        return quots.vec;                                                              \
+    }                                                                                  \
+    LIBDIVIDE_REMAINDER_VEC_GEN(ALGO, IntT, VecT, SUFFIX)
+
+// The vector functions check the numerators lane by lane using the
+// scalar function, which asserts that they are multiples of d.
+#if defined(LIBDIVIDE_ASSERTIONS_ON)
+#define LIBDIVIDE_EXACT_VEC_ASSERT(ALGO, IntT, VecT)                        \
+    {                                                                       \
+        union {                                                             \
+            VecT vec;                                                       \
+            IntT arr[sizeof(VecT) / sizeof(IntT)];                          \
+        } check;                                                            \
+        check.vec = numers;                                                 \
+        for (size_t loop = 0; loop < sizeof(VecT) / sizeof(IntT); ++loop) { \
+            (void)libdivide_##ALGO##_exact_do(check.arr[loop], denom);      \
+        }                                                                   \
+    }
+#else
+#define LIBDIVIDE_EXACT_VEC_ASSERT(ALGO, IntT, VecT)
+#endif
 
-__m512i libdivide_u16_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_u16_branchfree_t *denom){
-    SIMPLE_VECTOR_DIVISION(uint16_t, __m512i, u16_branchfree)}
+// Generates libdivide_<ALGO>_exact_do_<SUFFIX>() using the vector
+// instructions SHIFT (right shift by a scalar, arithmetic for signed
+// types), SET1 and MULLO (low half of the product).
+#define LIBDIVIDE_EXACT_VEC_GEN(ALGO, IntT, VecT, SUFFIX, SHIFT, SET1, MULLO) \
+    static LIBDIVIDE_INLINE VecT libdivide_##ALGO##_exact_do_##SUFFIX(        \
+        VecT numers, const struct libdivide_##ALGO##_exact_t *denom) {        \
+        LIBDIVIDE_EXACT_VEC_ASSERT(ALGO, IntT, VecT)                          \
+        return MULLO(SHIFT(numers, denom->shift), SET1(denom->inverse));      \
+    }
 
-////////// UINT32
+// Like SIMPLE_VECTOR_DIVISION, for vector types without a suitable
+// multiplication instruction.
+#define LIBDIVIDE_EXACT_VEC_SIMPLE_GEN(ALGO, IntT, VecT, SUFFIX)       \
+    static LIBDIVIDE_INLINE VecT libdivide_##ALGO##_exact_do_##SUFFIX( \
+        VecT numers, const struct libdivide_##ALGO##_exact_t *denom) { \
+        SIMPLE_VECTOR_DIVISION(IntT, VecT, ALGO##_exact)               \
+    }
 
-__m512i libdivide_u32_do_vec512(__m512i numers, const struct libdivide_u32_t *denom) {
-    uint8_t more = denom->more;
-    if (!denom->magic) {
-        return _mm512_srli_epi32(numers, more);
-    } else {
-        __m512i q = libdivide_mullhi_u32_vec512(numers, _mm512_set1_epi32(denom->magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // uint32_t t = ((numer - q) >> 1) + q;
-            // return t >> denom->shift;
-            uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-            __m512i t = _mm512_add_epi32(_mm512_srli_epi32(_mm512_sub_epi32(numers, q), 1), q);
-            return _mm512_srli_epi32(t, shift);
-        } else {
-            return _mm512_srli_epi32(q, more);
-        }
+// Generates the vector rounding division functions for W bit integers on
+// top of the unsigned vector division, see ROUNDING above. SRLI and SRAI
+// are logical and arithmetic right shifts, MULHI_U is the high half of
+// the unsigned product.
+#define LIBDIVIDE_ROUND_VEC_GEN(                                                             \
+    W, VecT, SUFFIX, SET1, ADD, SUB, XOR, OR, AND, SRLI, SRAI, MULHI_U)                      \
+    static LIBDIVIDE_INLINE VecT libdivide_u##W##_round_do_##SUFFIX(                         \
+        VecT numers, const struct libdivide_u##W##_round_t *denom) {                         \
+        const struct libdivide_u##W##_t udenom = {denom->magic, denom->more};                \
+        VecT c = AND(SRLI(OR(numers, SUB(SET1(0), numers)), W - 1),                          \
+            SET1((int##W##_t)(denom->round & LIBDIVIDE_ROUND_BIAS)));                        \
+        return ADD(libdivide_u##W##_do_##SUFFIX(SUB(numers, c), &udenom), c);                \
+    }                                                                                        \
+    static LIBDIVIDE_INLINE VecT libdivide_u##W##_round_branchfree_do_##SUFFIX(              \
+        VecT numers, const struct libdivide_u##W##_round_branchfree_t *denom) {              \
+        const struct libdivide_u##W##_branchfree_t udenom = {denom->magic, denom->more};     \
+        VecT c = AND(SRLI(OR(numers, SUB(SET1(0), numers)), W - 1),                          \
+            SET1((int##W##_t)(denom->round & LIBDIVIDE_ROUND_BIAS)));                        \
+        return ADD(libdivide_u##W##_branchfree_do_##SUFFIX(SUB(numers, c), &udenom), c);     \
+    }                                                                                        \
+    static LIBDIVIDE_INLINE VecT libdivide_s##W##_round_do_##SUFFIX(                         \
+        VecT numers, const struct libdivide_s##W##_round_t *denom) {                         \
+        const struct libdivide_u##W##_t udenom = {denom->magic, denom->more};                \
+        uint8_t round = denom->round;                                                        \
+        VecT biased = SUB(numers, SET1((int##W##_t)(round & LIBDIVIDE_ROUND_BIAS)));         \
+        VecT s = SRAI(OR(numers, biased), W - 1);                                            \
+        VecT q = libdivide_u##W##_do_##SUFFIX(XOR(biased, s), &udenom);                      \
+        q = XOR(q, XOR(s, SET1((int##W##_t)((int8_t)round >> 7))));                          \
+        return ADD(q, SET1((int##W##_t)((round & LIBDIVIDE_ROUND_INCREMENT) >> 1)));         \
+    }                                                                                        \
+    static LIBDIVIDE_INLINE VecT libdivide_s##W##_round_branchfree_do_##SUFFIX(              \
+        VecT numers, const struct libdivide_s##W##_round_branchfree_t *denom) {              \
+        uint8_t round = denom->round;                                                        \
+        VecT biased = SUB(numers, SET1((int##W##_t)(round & LIBDIVIDE_ROUND_BIAS)));         \
+        VecT s = SRAI(OR(numers, biased), W - 1);                                            \
+        VecT v = XOR(biased, s);                                                             \
+        VecT q = SRLI(ADD(v, MULHI_U(v, SET1((int##W##_t)denom->magic))), denom->more);      \
+        q = XOR(q, XOR(s, SET1((int##W##_t)((int8_t)round >> 7))));                          \
+        return ADD(q, SET1((int##W##_t)((round & LIBDIVIDE_ROUND_INCREMENT) >> 1)));         \
     }
-}
 
-__m512i libdivide_u32_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_u32_branchfree_t *denom) {
-    __m512i q = libdivide_mullhi_u32_vec512(numers, _mm512_set1_epi32(denom->magic));
-    __m512i t = _mm512_add_epi32(_mm512_srli_epi32(_mm512_sub_epi32(numers, q), 1), q);
-    return _mm512_srli_epi32(t, denom->more);
-}
+// Like SIMPLE_VECTOR_DIVISION, for vector types without a suitable
+// multiplication instruction.
+#define LIBDIVIDE_ROUND_VEC_SIMPLE_GEN(W, VecT, SUFFIX)                          \
+    static LIBDIVIDE_INLINE VecT libdivide_u##W##_round_do_##SUFFIX(             \
+        VecT numers, const struct libdivide_u##W##_round_t *denom) {             \
+        SIMPLE_VECTOR_DIVISION(uint##W##_t, VecT, u##W##_round)                  \
+    }                                                                            \
+    static LIBDIVIDE_INLINE VecT libdivide_u##W##_round_branchfree_do_##SUFFIX(  \
+        VecT numers, const struct libdivide_u##W##_round_branchfree_t *denom) {  \
+        SIMPLE_VECTOR_DIVISION(uint##W##_t, VecT, u##W##_round_branchfree)       \
+    }                                                                            \
+    static LIBDIVIDE_INLINE VecT libdivide_s##W##_round_do_##SUFFIX(             \
+        VecT numers, const struct libdivide_s##W##_round_t *denom) {             \
+        SIMPLE_VECTOR_DIVISION(int##W##_t, VecT, s##W##_round)                   \
+    }                                                                            \
+    static LIBDIVIDE_INLINE VecT libdivide_s##W##_round_branchfree_do_##SUFFIX(  \
+        VecT numers, const struct libdivide_s##W##_round_branchfree_t *denom) {  \
+        SIMPLE_VECTOR_DIVISION(int##W##_t, VecT, s##W##_round_branchfree)        \
+    }
 
-////////// UINT64
+// Generates the vector modular arithmetic functions of ALGO = u32 or u64,
+// see MODULAR MULTIPLICATION above. MULLO and MULHI are the low and high
+// halves of the lane-wise products, SUB_FIX(a, b, m) computes a - b plus m
+// in the lanes where a < b. The operands must be less than m. mulmod()
+// computes in Montgomery form and requires an odd m: the second Montgomery
+// multiplication by r2 = 2^2w mod m cancels the factor 2^-w of the first.
+#define LIBDIVIDE_MODMUL_VEC_GEN(ALGO, VecT, SUFFIX, SET1, SetT, SUB, MULLO, MULHI, SUB_FIX)     \
+    static LIBDIVIDE_INLINE VecT libdivide_##ALGO##_addmod_##SUFFIX(                             \
+        VecT a, VecT b, const struct libdivide_##ALGO##_reducer_t *reducer) {                    \
+        VecT m = SET1((SetT)reducer->m);                                                         \
+        return SUB_FIX(a, SUB(m, b), m);                                                         \
+    }                                                                                            \
+    static LIBDIVIDE_INLINE VecT libdivide_##ALGO##_submod_##SUFFIX(                             \
+        VecT a, VecT b, const struct libdivide_##ALGO##_reducer_t *reducer) {                    \
+        return SUB_FIX(a, b, SET1((SetT)reducer->m));                                            \
+    }                                                                                            \
+    static LIBDIVIDE_INLINE VecT libdivide_##ALGO##_montgomery_mul_##SUFFIX(                     \
+        VecT a, VecT b, const struct libdivide_##ALGO##_reducer_t *reducer) {                    \
+        VecT m = SET1((SetT)reducer->m);                                                         \
+        VecT u = MULLO(MULLO(a, b), SET1((SetT)reducer->inverse));                               \
+        return SUB_FIX(MULHI(a, b), MULHI(u, m), m);                                             \
+    }                                                                                            \
+    static LIBDIVIDE_INLINE VecT libdivide_##ALGO##_mulmod_##SUFFIX(                             \
+        VecT a, VecT b, const struct libdivide_##ALGO##_reducer_t *reducer) {                    \
+        VecT ab = libdivide_##ALGO##_montgomery_mul_##SUFFIX(a, b, reducer);                     \
+        return libdivide_##ALGO##_montgomery_mul_##SUFFIX(ab, SET1((SetT)reducer->r2), reducer); \
+    }
 
-__m512i libdivide_u64_do_vec512(__m512i numers, const struct libdivide_u64_t *denom) {
-    uint8_t more = denom->more;
-    if (!denom->magic) {
-        return _mm512_srli_epi64(numers, more);
-    } else {
-        __m512i q = libdivide_mullhi_u64_vec512(numers, _mm512_set1_epi64(denom->magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // uint32_t t = ((numer - q) >> 1) + q;
-            // return t >> denom->shift;
-            uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-            __m512i t = _mm512_add_epi64(_mm512_srli_epi64(_mm512_sub_epi64(numers, q), 1), q);
-            return _mm512_srli_epi64(t, shift);
-        } else {
-            return _mm512_srli_epi64(q, more);
-        }
+// Generates libdivide_u32_scaler_do_<SUFFIX>() and
+// libdivide_u64_scaler_do_<SUFFIX>(), see RATIONAL SCALING above. The u32
+// kernel computes the even and the odd lanes in 64-bit lanes using
+// MUL_EPU32. The u64 carries are the top bits of (a & b) | ((a | b) & ~sum)
+// as SSE2 and AVX2 lack unsigned 64-bit comparisons. SRL and SLL shift by
+// the count in an __m128i, counts of 64 yield 0.
+#define LIBDIVIDE_SCALER_VEC_GEN(                                                                  \
+    VecT, SUFFIX, SET1, ADD, SUB, AND, OR, ANDNOT, SRLI, SLLI, SRL, SLL, MUL_EPU32, MULLO, MULHI)  \
+    static LIBDIVIDE_INLINE VecT libdivide_scaler_carry_##SUFFIX(VecT a, VecT b, VecT sum) {       \
+        return SRLI(OR(AND(a, b), ANDNOT(sum, OR(a, b))), 63);                                     \
+    }                                                                                              \
+    static LIBDIVIDE_INLINE VecT libdivide_u32_scaler_lanes_##SUFFIX(                              \
+        VecT x, const struct libdivide_u32_scaler_t *scaler) {                                     \
+        VecT lo32 = SET1((int64_t)0xFFFFFFFF);                                                     \
+        VecT offset = SET1((int64_t)scaler->offset);                                               \
+        VecT p_lo = MUL_EPU32(x, SET1((int64_t)scaler->magic));                                    \
+        VecT p_hi = MUL_EPU32(x, SET1((int64_t)(scaler->magic >> 32)));                            \
+        VecT low = SRLI(ADD(AND(p_lo, lo32), AND(offset, lo32)), 32);                              \
+        VecT t = ADD(ADD(p_hi, SRLI(p_lo, 32)), ADD(SRLI(offset, 32), low));                       \
+        VecT frac = SRL(t, _mm_cvtsi32_si128(scaler->shift));                                      \
+        VecT q = ADD(MUL_EPU32(x, SET1((int64_t)scaler->whole)), frac);                            \
+        VecT over = SUB(SET1(0), SRLI(ADD(SRLI(q, 32), lo32), 32));                                \
+        return OR(q, AND(over, SET1(-(int64_t)scaler->saturate)));                                 \
+    }                                                                                              \
+    static LIBDIVIDE_INLINE VecT libdivide_u32_scaler_do_##SUFFIX(                                 \
+        VecT x, const struct libdivide_u32_scaler_t *scaler) {                                     \
+        VecT even = libdivide_u32_scaler_lanes_##SUFFIX(x, scaler);                                \
+        VecT odd = libdivide_u32_scaler_lanes_##SUFFIX(SRLI(x, 32), scaler);                       \
+        return OR(AND(even, SET1((int64_t)0xFFFFFFFF)), SLLI(odd, 32));                            \
+    }                                                                                              \
+    static LIBDIVIDE_INLINE VecT libdivide_u64_scaler_do_##SUFFIX(                                 \
+        VecT x, const struct libdivide_u64_scaler_t *scaler) {                                     \
+        VecT magic_lo = SET1((int64_t)scaler->magic_lo);                                           \
+        VecT magic_hi = SET1((int64_t)scaler->magic_hi);                                           \
+        VecT offset_lo = SET1((int64_t)scaler->offset_lo);                                         \
+        VecT offset_hi = SET1((int64_t)scaler->offset_hi);                                         \
+        VecT whole = SET1((int64_t)scaler->whole);                                                 \
+        VecT lo0 = MULLO(x, magic_lo);                                                             \
+        VecT sum0 = ADD(lo0, offset_lo);                                                           \
+        VecT hi0 = ADD(MULHI(x, magic_lo), libdivide_scaler_carry_##SUFFIX(lo0, offset_lo, sum0)); \
+        VecT u = ADD(hi0, offset_hi);                                                              \
+        VecT lo1 = MULLO(x, magic_hi);                                                             \
+        VecT t_lo = ADD(u, lo1);                                                                   \
+        VecT carries = ADD(libdivide_scaler_carry_##SUFFIX(hi0, offset_hi, u),                     \
+            libdivide_scaler_carry_##SUFFIX(u, lo1, t_lo));                                        \
+        VecT t_hi = ADD(MULHI(x, magic_hi), carries);                                              \
+        VecT frac = OR(SRL(t_lo, _mm_cvtsi32_si128(scaler->shift)),                                \
+            SLL(t_hi, _mm_cvtsi32_si128(64 - scaler->shift)));                                     \
+        VecT prod = MULLO(x, whole);                                                               \
+        VecT q = ADD(prod, frac);                                                                  \
+        VecT over = OR(MULHI(x, whole), libdivide_scaler_carry_##SUFFIX(prod, frac, q));           \
+        over = SUB(SET1(0), SRLI(OR(over, SUB(SET1(0), over)), 63));                               \
+        return OR(q, AND(over, SET1(-(int64_t)scaler->saturate)));                                 \
     }
-}
 
-__m512i libdivide_u64_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_u64_branchfree_t *denom) {
-    __m512i q = libdivide_mullhi_u64_vec512(numers, _mm512_set1_epi64(denom->magic));
-    __m512i t = _mm512_add_epi64(_mm512_srli_epi64(_mm512_sub_epi64(numers, q), 1), q);
-    return _mm512_srli_epi64(t, denom->more);
+// Generates libdivide_u16_fixed_do_<SUFFIX>() from 16-bit lane
+// multiplications, see FIXED POINT DIVISION above: the quotient is
+// n * magic_2 + the high word of n * magic_1 + the carry of adding the
+// high word of n * magic_0 to its low word. The carry is the top bit of
+// (a & b) | ((a | b) & ~sum).
+#define LIBDIVIDE_FIXED16_VEC_GEN(VecT, SUFFIX, SET1, ADD, AND, OR, ANDNOT, SRLI, MULLO, MULHI) \
+    static LIBDIVIDE_INLINE VecT libdivide_u16_fixed_do_##SUFFIX(                               \
+        VecT numers, const struct libdivide_u16_fixed_t *denom) {                               \
+        VecT lo = MULHI(numers, SET1((int16_t)denom->magic));                                   \
+        VecT mid_lo = MULLO(numers, SET1((int16_t)(denom->magic >> 16)));                       \
+        VecT mid_hi = MULHI(numers, SET1((int16_t)(denom->magic >> 16)));                       \
+        VecT sum = ADD(mid_lo, lo);                                                             \
+        VecT carry = SRLI(OR(AND(mid_lo, lo), ANDNOT(sum, OR(mid_lo, lo))), 15);                \
+        VecT q = ADD(MULLO(numers, SET1((int16_t)(denom->magic >> 32))), mid_hi);               \
+        return ADD(q, carry);                                                                   \
+    }
+
+// Generates libdivide_u32_fixed_do_<SUFFIX>() and
+// libdivide_u64_fixed_do_<SUFFIX>(). The u32 kernel computes the even and
+// the odd lanes in 64-bit lanes using MUL_EPU32: (lo >> 32) + mid fits in
+// 64 bits and the quotient is its high half plus the low half of hi. u64
+// uses the carry of the rational scaling kernels.
+#define LIBDIVIDE_FIXED_VEC_GEN(                                                          \
+    VecT, SUFFIX, SET1, ADD, AND, OR, SRLI, SLLI, MUL_EPU32, MULLO, MULHI)                \
+    static LIBDIVIDE_INLINE VecT libdivide_u32_fixed_lanes_##SUFFIX(                      \
+        VecT x, const struct libdivide_u32_fixed_t *denom) {                              \
+        VecT lo = MUL_EPU32(x, SET1((int64_t)denom->magic_lo));                           \
+        VecT mid = MUL_EPU32(x, SET1((int64_t)(denom->magic_lo >> 32)));                  \
+        VecT hi = MUL_EPU32(x, SET1((int64_t)denom->magic_hi));                           \
+        return ADD(ADD(SRLI(lo, 32), mid), SLLI(hi, 32));                                 \
+    }                                                                                     \
+    static LIBDIVIDE_INLINE VecT libdivide_u32_fixed_do_##SUFFIX(                         \
+        VecT numers, const struct libdivide_u32_fixed_t *denom) {                         \
+        VecT even = libdivide_u32_fixed_lanes_##SUFFIX(numers, denom);                    \
+        VecT odd = libdivide_u32_fixed_lanes_##SUFFIX(SRLI(numers, 32), denom);           \
+        return OR(SRLI(even, 32), AND(odd, SET1((int64_t)UINT64_C(0xFFFFFFFF00000000)))); \
+    }                                                                                     \
+    static LIBDIVIDE_INLINE VecT libdivide_u64_fixed_do_##SUFFIX(                         \
+        VecT numers, const struct libdivide_u64_fixed_t *denom) {                         \
+        VecT lo = MULHI(numers, SET1((int64_t)denom->magic_lo));                          \
+        VecT mid_lo = MULLO(numers, SET1((int64_t)denom->magic_mid));                     \
+        VecT mid_hi = MULHI(numers, SET1((int64_t)denom->magic_mid));                     \
+        VecT sum = ADD(mid_lo, lo);                                                       \
+        VecT q = ADD(MULLO(numers, SET1((int64_t)denom->magic_hi)), mid_hi);              \
+        return ADD(q, libdivide_scaler_carry_##SUFFIX(mid_lo, lo, sum));                  \
+    }
+
+// Generates libdivide_u16_fp_do_<SUFFIX>() and libdivide_s16_fp_do_<SUFFIX>():
+// the low and high halves of the 32-bit lanes are converted to float
+// separately, see FLOATING POINT RECIPROCAL above. Only the low 16 bits
+// of the 32-bit quotients are kept, so INT16_MIN / -1 wraps.
+#define LIBDIVIDE_FP16_VEC_GEN(                                                    \
+    VecT, FloatVecT, SUFFIX, SET1_EPI32, SET1_PS, AND, OR, SLLI, SRLI, SRAI, CVT, CVTT, MUL) \
+    static LIBDIVIDE_INLINE VecT libdivide_u16_fp_do_##SUFFIX(                     \
+        VecT numers, const struct libdivide_u16_fp_t *denom) {                     \
+        FloatVecT recip = SET1_PS(denom->recip);                                   \
+        VecT mask = SET1_EPI32(0xFFFF);                                            \
+        VecT lo = CVTT(MUL(CVT(AND(numers, mask)), recip));                        \
+        VecT hi = CVTT(MUL(CVT(SRLI(numers, 16)), recip));                         \
+        return OR(lo, SLLI(hi, 16));                                               \
+    }                                                                              \
+    static LIBDIVIDE_INLINE VecT libdivide_s16_fp_do_##SUFFIX(                     \
+        VecT numers, const struct libdivide_s16_fp_t *denom) {                     \
+        FloatVecT recip = SET1_PS(denom->recip);                                   \
+        VecT lo = CVTT(MUL(CVT(SRAI(SLLI(numers, 16), 16)), recip));               \
+        VecT hi = CVTT(MUL(CVT(SRAI(numers, 16)), recip));                         \
+        return OR(AND(lo, SET1_EPI32(0xFFFF)), SLLI(hi, 16));                      \
+    }
+
+#if defined(LIBDIVIDE_NEON)
+
+static LIBDIVIDE_INLINE uint16x8_t libdivide_u16_do_vec128(
+    uint16x8_t numers, const struct libdivide_u16_t *denom);
+static LIBDIVIDE_INLINE int16x8_t libdivide_s16_do_vec128(
+    int16x8_t numers, const struct libdivide_s16_t *denom);
+static LIBDIVIDE_INLINE uint32x4_t libdivide_u32_do_vec128(
+    uint32x4_t numers, const struct libdivide_u32_t *denom);
+static LIBDIVIDE_INLINE int32x4_t libdivide_s32_do_vec128(
+    int32x4_t numers, const struct libdivide_s32_t *denom);
+static LIBDIVIDE_INLINE uint64x2_t libdivide_u64_do_vec128(
+    uint64x2_t numers, const struct libdivide_u64_t *denom);
+static LIBDIVIDE_INLINE int64x2_t libdivide_s64_do_vec128(
+    int64x2_t numers, const struct libdivide_s64_t *denom);
+
+static LIBDIVIDE_INLINE uint16x8_t libdivide_u16_branchfree_do_vec128(
+    uint16x8_t numers, const struct libdivide_u16_branchfree_t *denom);
+static LIBDIVIDE_INLINE int16x8_t libdivide_s16_branchfree_do_vec128(
+    int16x8_t numers, const struct libdivide_s16_branchfree_t *denom);
+static LIBDIVIDE_INLINE uint32x4_t libdivide_u32_branchfree_do_vec128(
+    uint32x4_t numers, const struct libdivide_u32_branchfree_t *denom);
+static LIBDIVIDE_INLINE int32x4_t libdivide_s32_branchfree_do_vec128(
+    int32x4_t numers, const struct libdivide_s32_branchfree_t *denom);
+static LIBDIVIDE_INLINE uint64x2_t libdivide_u64_branchfree_do_vec128(
+    uint64x2_t numers, const struct libdivide_u64_branchfree_t *denom);
+static LIBDIVIDE_INLINE int64x2_t libdivide_s64_branchfree_do_vec128(
+    int64x2_t numers, const struct libdivide_s64_branchfree_t *denom);
+
+//////// Internal Utility Functions
+
+// Logical right shift by runtime value.
+// NEON implements right shift as left shits by negative values.
+static LIBDIVIDE_INLINE uint32x4_t libdivide_u32_neon_srl(uint32x4_t v, uint8_t amt) {
+    int32_t wamt = (int32_t)(amt);
+    return vshlq_u32(v, vdupq_n_s32(-wamt));
+}
+
+static LIBDIVIDE_INLINE uint64x2_t libdivide_u64_neon_srl(uint64x2_t v, uint8_t amt) {
+    int64_t wamt = (int64_t)(amt);
+    return vshlq_u64(v, vdupq_n_s64(-wamt));
+}
+
+// Arithmetic right shift by runtime value.
+static LIBDIVIDE_INLINE int32x4_t libdivide_s32_neon_sra(int32x4_t v, uint8_t amt) {
+    int32_t wamt = (int32_t)(amt);
+    return vshlq_s32(v, vdupq_n_s32(-wamt));
+}
+
+static LIBDIVIDE_INLINE int64x2_t libdivide_s64_neon_sra(int64x2_t v, uint8_t amt) {
+    int64_t wamt = (int64_t)(amt);
+    return vshlq_s64(v, vdupq_n_s64(-wamt));
+}
+
+static LIBDIVIDE_INLINE int64x2_t libdivide_s64_signbits(int64x2_t v) { return vshrq_n_s64(v, 63); }
+
+static LIBDIVIDE_INLINE uint32x4_t libdivide_mullhi_u32_vec128(uint32x4_t a, uint32_t b) {
+    // Desire is [x0, x1, x2, x3]
+    uint32x4_t w1 = vreinterpretq_u32_u64(vmull_n_u32(vget_low_u32(a), b));  // [_, x0, _, x1]
+    uint32x4_t w2 = vreinterpretq_u32_u64(vmull_high_n_u32(a, b));           //[_, x2, _, x3]
+    return vuzp2q_u32(w1, w2);                                               // [x0, x1, x2, x3]
+}
+
+static LIBDIVIDE_INLINE int32x4_t libdivide_mullhi_s32_vec128(int32x4_t a, int32_t b) {
+    int32x4_t w1 = vreinterpretq_s32_s64(vmull_n_s32(vget_low_s32(a), b));  // [_, x0, _, x1]
+    int32x4_t w2 = vreinterpretq_s32_s64(vmull_high_n_s32(a, b));           //[_, x2, _, x3]
+    return vuzp2q_s32(w1, w2);                                              // [x0, x1, x2, x3]
+}
+
+static LIBDIVIDE_INLINE uint64x2_t libdivide_mullhi_u64_vec128(uint64x2_t x, uint64_t sy) {
+    // full 128 bits product is:
+    // x0*y0 + (x0*y1 << 32) + (x1*y0 << 32) + (x1*y1 << 64)
+    // Note x0,y0,x1,y1 are all conceptually uint32, products are 32x32->64.
+
+    // Get low and high words. x0 contains low 32 bits, x1 is high 32 bits.
+    uint64x2_t y = vdupq_n_u64(sy);
+    uint32x2_t x0 = vmovn_u64(x);
+    uint32x2_t y0 = vmovn_u64(y);
+    uint32x2_t x1 = vshrn_n_u64(x, 32);
+    uint32x2_t y1 = vshrn_n_u64(y, 32);
+
+    // Compute x0*y0.
+    uint64x2_t x0y0 = vmull_u32(x0, y0);
+    uint64x2_t x0y0_hi = vshrq_n_u64(x0y0, 32);
+
+    // Compute other intermediate products.
+    uint64x2_t temp = vmlal_u32(x0y0_hi, x1, y0);  // temp = x0y0_hi + x1*y0;
+    // We want to split temp into its low 32 bits and high 32 bits, both
+    // in the low half of 64 bit registers.
+    // Use shifts to avoid needing a reg for the mask.
+    uint64x2_t temp_lo = vshrq_n_u64(vshlq_n_u64(temp, 32), 32);  // temp_lo = temp & 0xFFFFFFFF;
+    uint64x2_t temp_hi = vshrq_n_u64(temp, 32);                   // temp_hi = temp >> 32;
+
+    temp_lo = vmlal_u32(temp_lo, x0, y1);  // temp_lo += x0*y0
+    temp_lo = vshrq_n_u64(temp_lo, 32);    // temp_lo >>= 32
+    temp_hi = vmlal_u32(temp_hi, x1, y1);  // temp_hi += x1*y1
+    uint64x2_t result = vaddq_u64(temp_hi, temp_lo);
+    return result;
+}
+
+static LIBDIVIDE_INLINE int64x2_t libdivide_mullhi_s64_vec128(int64x2_t x, int64_t sy) {
+    int64x2_t p = vreinterpretq_s64_u64(
+        libdivide_mullhi_u64_vec128(vreinterpretq_u64_s64(x), (uint64_t)(sy)));
+    int64x2_t y = vdupq_n_s64(sy);
+    int64x2_t t1 = vandq_s64(libdivide_s64_signbits(x), y);
+    int64x2_t t2 = vandq_s64(libdivide_s64_signbits(y), x);
+    p = vsubq_s64(p, t1);
+    p = vsubq_s64(p, t2);
+    return p;
+}
+
+////////// UINT16
+
+uint16x8_t libdivide_u16_do_vec128(uint16x8_t numers, const struct libdivide_u16_t *denom){
+    SIMPLE_VECTOR_DIVISION(uint16_t, uint16x8_t, u16)}
+
+uint16x8_t libdivide_u16_branchfree_do_vec128(
+    uint16x8_t numers, const struct libdivide_u16_branchfree_t *denom){
+    SIMPLE_VECTOR_DIVISION(uint16_t, uint16x8_t, u16_branchfree)}
+
+////////// UINT32
+
+uint32x4_t libdivide_u32_do_vec128(uint32x4_t numers, const struct libdivide_u32_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return libdivide_u32_neon_srl(numers, more);
+    } else {
+        uint32x4_t q = libdivide_mullhi_u32_vec128(numers, denom->magic);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint32_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            // Note we can use halving-subtract to avoid the shift.
+            uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+            uint32x4_t t = vaddq_u32(vhsubq_u32(numers, q), q);
+            return libdivide_u32_neon_srl(t, shift);
+        } else {
+            return libdivide_u32_neon_srl(q, more);
+        }
+    }
+}
+
+uint32x4_t libdivide_u32_branchfree_do_vec128(
+    uint32x4_t numers, const struct libdivide_u32_branchfree_t *denom) {
+    uint32x4_t q = libdivide_mullhi_u32_vec128(numers, denom->magic);
+    uint32x4_t t = vaddq_u32(vhsubq_u32(numers, q), q);
+    return libdivide_u32_neon_srl(t, denom->more);
+}
+
+////////// UINT64
+
+uint64x2_t libdivide_u64_do_vec128(uint64x2_t numers, const struct libdivide_u64_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return libdivide_u64_neon_srl(numers, more);
+    } else {
+        uint64x2_t q = libdivide_mullhi_u64_vec128(numers, denom->magic);
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint32_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            // No 64-bit halving subtracts in NEON :(
+            uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+            uint64x2_t t = vaddq_u64(vshrq_n_u64(vsubq_u64(numers, q), 1), q);
+            return libdivide_u64_neon_srl(t, shift);
+        } else {
+            // Masks off LIBDIVIDE_NARROW_MARKER
+            return libdivide_u64_neon_srl(q, more & LIBDIVIDE_64_SHIFT_MASK);
+        }
+    }
+}
+
+uint64x2_t libdivide_u64_branchfree_do_vec128(
+    uint64x2_t numers, const struct libdivide_u64_branchfree_t *denom) {
+    uint64x2_t q = libdivide_mullhi_u64_vec128(numers, denom->magic);
+    uint64x2_t t = vaddq_u64(vshrq_n_u64(vsubq_u64(numers, q), 1), q);
+    return libdivide_u64_neon_srl(t, denom->more);
 }
 
 ////////// SINT16
 
-__m512i libdivide_s16_do_vec512(__m512i numers, const struct libdivide_s16_t *denom){
-    SIMPLE_VECTOR_DIVISION(int16_t, __m512i, s16)}
+int16x8_t libdivide_s16_do_vec128(int16x8_t numers, const struct libdivide_s16_t *denom){
+    SIMPLE_VECTOR_DIVISION(int16_t, int16x8_t, s16)}
 
-__m512i libdivide_s16_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_s16_branchfree_t *denom){
-    SIMPLE_VECTOR_DIVISION(int16_t, __m512i, s16_branchfree)}
+int16x8_t libdivide_s16_branchfree_do_vec128(
+    int16x8_t numers, const struct libdivide_s16_branchfree_t *denom){
+    SIMPLE_VECTOR_DIVISION(int16_t, int16x8_t, s16_branchfree)}
 
 ////////// SINT32
 
-__m512i libdivide_s32_do_vec512(__m512i numers, const struct libdivide_s32_t *denom) {
+int32x4_t libdivide_s32_do_vec128(int32x4_t numers, const struct libdivide_s32_t *denom) {
     uint8_t more = denom->more;
     if (!denom->magic) {
-        uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+        uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
         uint32_t mask = ((uint32_t)1 << shift) - 1;
-        __m512i roundToZeroTweak = _mm512_set1_epi32(mask);
+        int32x4_t roundToZeroTweak = vdupq_n_s32((int)mask);
         // q = numer + ((numer >> 31) & roundToZeroTweak);
-        __m512i q = _mm512_add_epi32(
-            numers, _mm512_and_si512(_mm512_srai_epi32(numers, 31), roundToZeroTweak));
-        q = _mm512_srai_epi32(q, shift);
-        __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
+        int32x4_t q = vaddq_s32(numers, vandq_s32(vshrq_n_s32(numers, 31), roundToZeroTweak));
+        q = libdivide_s32_neon_sra(q, shift);
+        int32x4_t sign = vdupq_n_s32((int8_t)more >> 7);
         // q = (q ^ sign) - sign;
-        q = _mm512_sub_epi32(_mm512_xor_si512(q, sign), sign);
+        q = vsubq_s32(veorq_s32(q, sign), sign);
         return q;
     } else {
-        __m512i q = libdivide_mullhi_s32_vec512(numers, _mm512_set1_epi32(denom->magic));
+        int32x4_t q = libdivide_mullhi_s32_vec128(numers, denom->magic);
         if (more & LIBDIVIDE_ADD_MARKER) {
             // must be arithmetic shift
-            __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
+            int32x4_t sign = vdupq_n_s32((int8_t)more >> 7);
             // q += ((numer ^ sign) - sign);
-            q = _mm512_add_epi32(q, _mm512_sub_epi32(_mm512_xor_si512(numers, sign), sign));
+            q = vaddq_s32(q, vsubq_s32(veorq_s32(numers, sign), sign));
         }
         // q >>= shift
-        q = _mm512_srai_epi32(q, more & LIBDIVIDE_32_SHIFT_MASK);
-        q = _mm512_add_epi32(q, _mm512_srli_epi32(q, 31));  // q += (q < 0)
+        q = libdivide_s32_neon_sra(q, more & LIBDIVIDE_32_SHIFT_MASK);
+        q = vaddq_s32(
+            q, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(q), 31)));  // q += (q < 0)
         return q;
     }
 }
 
-__m512i libdivide_s32_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_s32_branchfree_t *denom) {
+int32x4_t libdivide_s32_branchfree_do_vec128(
+    int32x4_t numers, const struct libdivide_s32_branchfree_t *denom) {
     int32_t magic = denom->magic;
     uint8_t more = denom->more;
     uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
     // must be arithmetic shift
-    __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
-    __m512i q = libdivide_mullhi_s32_vec512(numers, _mm512_set1_epi32(magic));
-    q = _mm512_add_epi32(q, numers);  // q += numers
+    int32x4_t sign = vdupq_n_s32((int8_t)more >> 7);
+    int32x4_t q = libdivide_mullhi_s32_vec128(numers, magic);
+    q = vaddq_s32(q, numers);  // q += numers
 
     // If q is non-negative, we have nothing to do
     // If q is negative, we want to add either (2**shift)-1 if d is
     // a power of 2, or (2**shift) if it is not a power of 2
     uint32_t is_power_of_2 = (magic == 0);
-    __m512i q_sign = _mm512_srai_epi32(q, 31);  // q_sign = q >> 31
-    __m512i mask = _mm512_set1_epi32(((uint32_t)1 << shift) - is_power_of_2);
-    q = _mm512_add_epi32(q, _mm512_and_si512(q_sign, mask));  // q = q + (q_sign & mask)
-    q = _mm512_srai_epi32(q, shift);                          // q >>= shift
-    q = _mm512_sub_epi32(_mm512_xor_si512(q, sign), sign);    // q = (q ^ sign) - sign
+    int32x4_t q_sign = vshrq_n_s32(q, 31);  // q_sign = q >> 31
+    int32x4_t mask = vdupq_n_s32(((uint32_t)1 << shift) - is_power_of_2);
+    q = vaddq_s32(q, vandq_s32(q_sign, mask));  // q = q + (q_sign & mask)
+    q = libdivide_s32_neon_sra(q, shift);       // q >>= shift
+    q = vsubq_s32(veorq_s32(q, sign), sign);    // q = (q ^ sign) - sign
     return q;
 }
 
 ////////// SINT64
 
-__m512i libdivide_s64_do_vec512(__m512i numers, const struct libdivide_s64_t *denom) {
+int64x2_t libdivide_s64_do_vec128(int64x2_t numers, const struct libdivide_s64_t *denom) {
     uint8_t more = denom->more;
     int64_t magic = denom->magic;
     if (magic == 0) {  // shift path
-        uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+        uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
         uint64_t mask = ((uint64_t)1 << shift) - 1;
-        __m512i roundToZeroTweak = _mm512_set1_epi64(mask);
+        int64x2_t roundToZeroTweak = vdupq_n_s64(mask);  // TODO: no need to sign extend
         // q = numer + ((numer >> 63) & roundToZeroTweak);
-        __m512i q = _mm512_add_epi64(
-            numers, _mm512_and_si512(libdivide_s64_signbits_vec512(numers), roundToZeroTweak));
-        q = libdivide_s64_shift_right_vec512(q, shift);
-        __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
+        int64x2_t q =
+            vaddq_s64(numers, vandq_s64(libdivide_s64_signbits(numers), roundToZeroTweak));
+        q = libdivide_s64_neon_sra(q, shift);
         // q = (q ^ sign) - sign;
-        q = _mm512_sub_epi64(_mm512_xor_si512(q, sign), sign);
+        int64x2_t sign = vreinterpretq_s64_s8(vdupq_n_s8((int8_t)more >> 7));
+        q = vsubq_s64(veorq_s64(q, sign), sign);
         return q;
     } else {
-        __m512i q = libdivide_mullhi_s64_vec512(numers, _mm512_set1_epi64(magic));
+        int64x2_t q = libdivide_mullhi_s64_vec128(numers, magic);
         if (more & LIBDIVIDE_ADD_MARKER) {
             // must be arithmetic shift
-            __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
+            int64x2_t sign = vdupq_n_s64((int8_t)more >> 7);  // TODO: no need to widen
             // q += ((numer ^ sign) - sign);
-            q = _mm512_add_epi64(q, _mm512_sub_epi64(_mm512_xor_si512(numers, sign), sign));
+            q = vaddq_s64(q, vsubq_s64(veorq_s64(numers, sign), sign));
         }
         // q >>= denom->mult_path.shift
-        q = libdivide_s64_shift_right_vec512(q, more & LIBDIVIDE_64_SHIFT_MASK);
-        q = _mm512_add_epi64(q, _mm512_srli_epi64(q, 63));  // q += (q < 0)
+        q = libdivide_s64_neon_sra(q, more & LIBDIVIDE_64_SHIFT_MASK);
+        q = vaddq_s64(
+            q, vreinterpretq_s64_u64(vshrq_n_u64(vreinterpretq_u64_s64(q), 63)));  // q += (q < 0)
         return q;
     }
 }
 
-__m512i libdivide_s64_branchfree_do_vec512(
-    __m512i numers, const struct libdivide_s64_branchfree_t *denom) {
+int64x2_t libdivide_s64_branchfree_do_vec128(
+    int64x2_t numers, const struct libdivide_s64_branchfree_t *denom) {
     int64_t magic = denom->magic;
     uint8_t more = denom->more;
     uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
     // must be arithmetic shift
-    __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
+    int64x2_t sign = vdupq_n_s64((int8_t)more >> 7);  // TODO: avoid sign extend
 
     // libdivide_mullhi_s64(numers, magic);
-    __m512i q = libdivide_mullhi_s64_vec512(numers, _mm512_set1_epi64(magic));
-    q = _mm512_add_epi64(q, numers);  // q += numers
+    int64x2_t q = libdivide_mullhi_s64_vec128(numers, magic);
+    q = vaddq_s64(q, numers);  // q += numers
 
     // If q is non-negative, we have nothing to do.
     // If q is negative, we want to add either (2**shift)-1 if d is
     // a power of 2, or (2**shift) if it is not a power of 2.
     uint32_t is_power_of_2 = (magic == 0);
-    __m512i q_sign = libdivide_s64_signbits_vec512(q);  // q_sign = q >> 63
-    __m512i mask = _mm512_set1_epi64(((uint64_t)1 << shift) - is_power_of_2);
-    q = _mm512_add_epi64(q, _mm512_and_si512(q_sign, mask));  // q = q + (q_sign & mask)
-    q = libdivide_s64_shift_right_vec512(q, shift);           // q >>= shift
-    q = _mm512_sub_epi64(_mm512_xor_si512(q, sign), sign);    // q = (q ^ sign) - sign
+    int64x2_t q_sign = libdivide_s64_signbits(q);  // q_sign = q >> 63
+    int64x2_t mask = vdupq_n_s64(((uint64_t)1 << shift) - is_power_of_2);
+    q = vaddq_s64(q, vandq_s64(q_sign, mask));  // q = q + (q_sign & mask)
+    q = libdivide_s64_neon_sra(q, shift);       // q >>= shift
+    q = vsubq_s64(veorq_s64(q, sign), sign);    // q = (q ^ sign) - sign
     return q;
 }
 
+////////// REMAINDER
+
+// NEON has no 64-bit multiplication, 64-bit remainders are computed per lane.
+LIBDIVIDE_DIVMOD_VEC_GEN(u16, uint16_t, uint16x8_t, vec128, vdupq_n_u16, vmulq_u16, vsubq_u16)
+LIBDIVIDE_DIVMOD_VEC_GEN(s16, int16_t, int16x8_t, vec128, vdupq_n_s16, vmulq_s16, vsubq_s16)
+LIBDIVIDE_DIVMOD_VEC_GEN(u32, uint32_t, uint32x4_t, vec128, vdupq_n_u32, vmulq_u32, vsubq_u32)
+LIBDIVIDE_DIVMOD_VEC_GEN(s32, int32_t, int32x4_t, vec128, vdupq_n_s32, vmulq_s32, vsubq_s32)
+LIBDIVIDE_DIVMOD_VEC_SIMPLE_GEN(u64, uint64_t, uint64x2_t, vec128)
+LIBDIVIDE_DIVMOD_VEC_SIMPLE_GEN(s64, int64_t, int64x2_t, vec128)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u16_branchfree, uint16_t, uint16x8_t, vec128, vdupq_n_u16, vmulq_u16, vsubq_u16)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s16_branchfree, int16_t, int16x8_t, vec128, vdupq_n_s16, vmulq_s16, vsubq_s16)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u32_branchfree, uint32_t, uint32x4_t, vec128, vdupq_n_u32, vmulq_u32, vsubq_u32)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s32_branchfree, int32_t, int32x4_t, vec128, vdupq_n_s32, vmulq_s32, vsubq_s32)
+LIBDIVIDE_DIVMOD_VEC_SIMPLE_GEN(u64_branchfree, uint64_t, uint64x2_t, vec128)
+LIBDIVIDE_DIVMOD_VEC_SIMPLE_GEN(s64_branchfree, int64_t, int64x2_t, vec128)
+
+////////// EXACT DIVISION
+
+static LIBDIVIDE_INLINE uint16x8_t libdivide_u16_neon_srl(uint16x8_t v, uint8_t amt) {
+    int16_t wamt = (int16_t)(amt);
+    return vshlq_u16(v, vdupq_n_s16(-wamt));
+}
+
+static LIBDIVIDE_INLINE int16x8_t libdivide_s16_neon_sra(int16x8_t v, uint8_t amt) {
+    int16_t wamt = (int16_t)(amt);
+    return vshlq_s16(v, vdupq_n_s16(-wamt));
+}
+
+LIBDIVIDE_EXACT_VEC_GEN(
+    u16, uint16_t, uint16x8_t, vec128, libdivide_u16_neon_srl, vdupq_n_u16, vmulq_u16)
+LIBDIVIDE_EXACT_VEC_GEN(
+    s16, int16_t, int16x8_t, vec128, libdivide_s16_neon_sra, vdupq_n_s16, vmulq_s16)
+LIBDIVIDE_EXACT_VEC_GEN(
+    u32, uint32_t, uint32x4_t, vec128, libdivide_u32_neon_srl, vdupq_n_u32, vmulq_u32)
+LIBDIVIDE_EXACT_VEC_GEN(
+    s32, int32_t, int32x4_t, vec128, libdivide_s32_neon_sra, vdupq_n_s32, vmulq_s32)
+LIBDIVIDE_EXACT_VEC_SIMPLE_GEN(u64, uint64_t, uint64x2_t, vec128)
+LIBDIVIDE_EXACT_VEC_SIMPLE_GEN(s64, int64_t, int64x2_t, vec128)
+
 #endif
 
-#if defined(LIBDIVIDE_AVX2)
+#if defined(LIBDIVIDE_SVE)
 
-static LIBDIVIDE_INLINE __m256i libdivide_u16_do_vec256(
-    __m256i numers, const struct libdivide_u16_t *denom);
-static LIBDIVIDE_INLINE __m256i libdivide_s16_do_vec256(
-    __m256i numers, const struct libdivide_s16_t *denom);
-static LIBDIVIDE_INLINE __m256i libdivide_u32_do_vec256(
-    __m256i numers, const struct libdivide_u32_t *denom);
-static LIBDIVIDE_INLINE __m256i libdivide_s32_do_vec256(
-    __m256i numers, const struct libdivide_s32_t *denom);
-static LIBDIVIDE_INLINE __m256i libdivide_u64_do_vec256(
-    __m256i numers, const struct libdivide_u64_t *denom);
-static LIBDIVIDE_INLINE __m256i libdivide_s64_do_vec256(
-    __m256i numers, const struct libdivide_s64_t *denom);
+static LIBDIVIDE_INLINE svuint16_t libdivide_u16_do_sve(
+    svuint16_t numers, const struct libdivide_u16_t *denom);
+static LIBDIVIDE_INLINE svint16_t libdivide_s16_do_sve(
+    svint16_t numers, const struct libdivide_s16_t *denom);
+static LIBDIVIDE_INLINE svuint32_t libdivide_u32_do_sve(
+    svuint32_t numers, const struct libdivide_u32_t *denom);
+static LIBDIVIDE_INLINE svint32_t libdivide_s32_do_sve(
+    svint32_t numers, const struct libdivide_s32_t *denom);
+static LIBDIVIDE_INLINE svuint64_t libdivide_u64_do_sve(
+    svuint64_t numers, const struct libdivide_u64_t *denom);
+static LIBDIVIDE_INLINE svint64_t libdivide_s64_do_sve(
+    svint64_t numers, const struct libdivide_s64_t *denom);
 
-static LIBDIVIDE_INLINE __m256i libdivide_u16_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_u16_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m256i libdivide_s16_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_s16_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m256i libdivide_u32_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_u32_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m256i libdivide_s32_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_s32_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m256i libdivide_u64_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_u64_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m256i libdivide_s64_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_s64_branchfree_t *denom);
+static LIBDIVIDE_INLINE svuint16_t libdivide_u16_branchfree_do_sve(
+    svuint16_t numers, const struct libdivide_u16_branchfree_t *denom);
+static LIBDIVIDE_INLINE svint16_t libdivide_s16_branchfree_do_sve(
+    svint16_t numers, const struct libdivide_s16_branchfree_t *denom);
+static LIBDIVIDE_INLINE svuint32_t libdivide_u32_branchfree_do_sve(
+    svuint32_t numers, const struct libdivide_u32_branchfree_t *denom);
+static LIBDIVIDE_INLINE svint32_t libdivide_s32_branchfree_do_sve(
+    svint32_t numers, const struct libdivide_s32_branchfree_t *denom);
+static LIBDIVIDE_INLINE svuint64_t libdivide_u64_branchfree_do_sve(
+    svuint64_t numers, const struct libdivide_u64_branchfree_t *denom);
+static LIBDIVIDE_INLINE svint64_t libdivide_s64_branchfree_do_sve(
+    svint64_t numers, const struct libdivide_s64_branchfree_t *denom);
 
 //////// Internal Utility Functions
 
-// Implementation of _mm256_srai_epi64(v, 63) (from AVX512).
-static LIBDIVIDE_INLINE __m256i libdivide_s64_signbits_vec256(__m256i v) {
-    __m256i hiBitsDuped = _mm256_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 1, 1));
-    __m256i signBits = _mm256_srai_epi32(hiBitsDuped, 31);
-    return signBits;
+// logical shift right
+static LIBDIVIDE_INLINE svuint16_t libdivide_u16_sve_srl(svuint16_t v, uint8_t amt) {
+    return svlsr_wide_u16_x(svptrue_b16(), v, svdup_n_u64(amt));
 }
 
-// Implementation of _mm256_srai_epi64 (from AVX512).
-static LIBDIVIDE_INLINE __m256i libdivide_s64_shift_right_vec256(__m256i v, int amt) {
-    const int b = 64 - amt;
-    __m256i m = _mm256_set1_epi64x((uint64_t)1 << (b - 1));
-    __m256i x = _mm256_srli_epi64(v, amt);
-    __m256i result = _mm256_sub_epi64(_mm256_xor_si256(x, m), m);
-    return result;
+static LIBDIVIDE_INLINE svuint32_t libdivide_u32_sve_srl(svuint32_t v, uint8_t amt) {
+    return svlsr_wide_u32_x(svptrue_b32(), v, svdup_n_u64(amt));
 }
 
-// Here, b is assumed to contain one 32-bit value repeated.
-static LIBDIVIDE_INLINE __m256i libdivide_mullhi_u32_vec256(__m256i a, __m256i b) {
-    __m256i hi_product_0Z2Z = _mm256_srli_epi64(_mm256_mul_epu32(a, b), 32);
-    __m256i a1X3X = _mm256_srli_epi64(a, 32);
-    __m256i mask = _mm256_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0);
-    __m256i hi_product_Z1Z3 = _mm256_and_si256(_mm256_mul_epu32(a1X3X, b), mask);
-    return _mm256_or_si256(hi_product_0Z2Z, hi_product_Z1Z3);
+static LIBDIVIDE_INLINE svuint64_t libdivide_u64_sve_srl(svuint64_t v, uint8_t amt) {
+    return svlsr_n_u64_x(svptrue_b64(), v, amt);
 }
 
-// b is one 32-bit value repeated.
-static LIBDIVIDE_INLINE __m256i libdivide_mullhi_s32_vec256(__m256i a, __m256i b) {
-    __m256i hi_product_0Z2Z = _mm256_srli_epi64(_mm256_mul_epi32(a, b), 32);
-    __m256i a1X3X = _mm256_srli_epi64(a, 32);
-    __m256i mask = _mm256_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0);
-    __m256i hi_product_Z1Z3 = _mm256_and_si256(_mm256_mul_epi32(a1X3X, b), mask);
-    return _mm256_or_si256(hi_product_0Z2Z, hi_product_Z1Z3);
+// arithmetic shift right
+static LIBDIVIDE_INLINE svint16_t libdivide_s16_sve_sra(svint16_t v, uint8_t amt) {
+    return svasr_wide_s16_x(svptrue_b16(), v, svdup_n_u64(amt));
 }
 
-// Here, y is assumed to contain one 64-bit value repeated.
-static LIBDIVIDE_INLINE __m256i libdivide_mullhi_u64_vec256(__m256i x, __m256i y) {
-    // see m128i variant for comments.
-    __m256i x0y0 = _mm256_mul_epu32(x, y);
-    __m256i x0y0_hi = _mm256_srli_epi64(x0y0, 32);
+static LIBDIVIDE_INLINE svint32_t libdivide_s32_sve_sra(svint32_t v, uint8_t amt) {
+    return svasr_wide_s32_x(svptrue_b32(), v, svdup_n_u64(amt));
+}
 
-    __m256i x1 = _mm256_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 1, 1));
-    __m256i y1 = _mm256_shuffle_epi32(y, _MM_SHUFFLE(3, 3, 1, 1));
+static LIBDIVIDE_INLINE svint64_t libdivide_s64_sve_sra(svint64_t v, uint8_t amt) {
+    return svasr_n_s64_x(svptrue_b64(), v, amt);
+}
 
-    __m256i x0y1 = _mm256_mul_epu32(x, y1);
-    __m256i x1y0 = _mm256_mul_epu32(x1, y);
-    __m256i x1y1 = _mm256_mul_epu32(x1, y1);
+// unsigned halving add: (x + y) >> 1
+static LIBDIVIDE_INLINE svuint16_t libdivide_u16_sve_hadd(svuint16_t x, svuint16_t y) {
+    svbool_t pg = svptrue_b16();
+#if defined(LIBDIVIDE_SVE2)
+    return svhadd_u16_x(pg, x, y);
+#else
+    return svadd_u16_x(pg, svlsr_n_u16_x(pg, svsub_u16_x(pg, x, y), 1), y);
+#endif
+}
 
-    __m256i mask = _mm256_set1_epi64x(0xFFFFFFFF);
-    __m256i temp = _mm256_add_epi64(x1y0, x0y0_hi);
-    __m256i temp_lo = _mm256_and_si256(temp, mask);
-    __m256i temp_hi = _mm256_srli_epi64(temp, 32);
+static LIBDIVIDE_INLINE svuint32_t libdivide_u32_sve_hadd(svuint32_t x, svuint32_t y) {
+    svbool_t pg = svptrue_b32();
+#if defined(LIBDIVIDE_SVE2)
+    return svhadd_u32_x(pg, x, y);
+#else
+    return svadd_u32_x(pg, svlsr_n_u32_x(pg, svsub_u32_x(pg, x, y), 1), y);
+#endif
+}
 
-    temp_lo = _mm256_srli_epi64(_mm256_add_epi64(temp_lo, x0y1), 32);
-    temp_hi = _mm256_add_epi64(x1y1, temp_hi);
-    return _mm256_add_epi64(temp_lo, temp_hi);
+static LIBDIVIDE_INLINE svuint64_t libdivide_u64_sve_hadd(svuint64_t x, svuint64_t y) {
+    svbool_t pg = svptrue_b64();
+    // SVE2 has svhadd_u64_x, but it was neutral to slower on Graviton4.
+    // Keep the base SVE sequence for the 64-bit add-marker path.
+    return svadd_u64_x(pg, svlsr_n_u64_x(pg, svsub_u64_x(pg, x, y), 1), y);
 }
 
-// y is one 64-bit value repeated.
-static LIBDIVIDE_INLINE __m256i libdivide_mullhi_s64_vec256(__m256i x, __m256i y) {
-    __m256i p = libdivide_mullhi_u64_vec256(x, y);
-    __m256i t1 = _mm256_and_si256(libdivide_s64_signbits_vec256(x), y);
-    __m256i t2 = _mm256_and_si256(libdivide_s64_signbits_vec256(y), x);
-    p = _mm256_sub_epi64(p, t1);
-    p = _mm256_sub_epi64(p, t2);
-    return p;
+// sign mask: 0 for non-negative lanes, -1 for negative lanes
+static LIBDIVIDE_INLINE svint16_t libdivide_s16_sve_signbits(svint16_t v) {
+    return svasr_n_s16_x(svptrue_b16(), v, 15);
+}
+
+static LIBDIVIDE_INLINE svint32_t libdivide_s32_sve_signbits(svint32_t v) {
+    return svasr_n_s32_x(svptrue_b32(), v, 31);
+}
+
+static LIBDIVIDE_INLINE svint64_t libdivide_s64_sve_signbits(svint64_t v) {
+    return svasr_n_s64_x(svptrue_b64(), v, 63);
 }
 
 ////////// UINT16
 
-__m256i libdivide_u16_do_vec256(__m256i numers, const struct libdivide_u16_t *denom) {
+svuint16_t libdivide_u16_do_sve(svuint16_t numers, const struct libdivide_u16_t *denom) {
+    svbool_t pg = svptrue_b16();
     uint8_t more = denom->more;
+
+    // power of 2 path
     if (!denom->magic) {
-        return _mm256_srli_epi16(numers, more);
-    } else {
-        __m256i q = _mm256_mulhi_epu16(numers, _mm256_set1_epi16(denom->magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            __m256i t = _mm256_adds_epu16(_mm256_srli_epi16(_mm256_subs_epu16(numers, q), 1), q);
-            return _mm256_srli_epi16(t, (more & LIBDIVIDE_16_SHIFT_MASK));
-        } else {
-            return _mm256_srli_epi16(q, more);
-        }
+        return libdivide_u16_sve_srl(numers, more);
+    }
+
+    svuint16_t q = svmulh_n_u16_x(pg, numers, denom->magic);
+    if (more & LIBDIVIDE_ADD_MARKER) {
+        // t = (numers + q) >> 1
+        uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+        svuint16_t t = libdivide_u16_sve_hadd(numers, q);
+        return libdivide_u16_sve_srl(t, shift);
     }
+
+    return libdivide_u16_sve_srl(q, more);
 }
 
-__m256i libdivide_u16_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_u16_branchfree_t *denom) {
-    __m256i q = _mm256_mulhi_epu16(numers, _mm256_set1_epi16(denom->magic));
-    __m256i t = _mm256_adds_epu16(_mm256_srli_epi16(_mm256_subs_epu16(numers, q), 1), q);
-    return _mm256_srli_epi16(t, denom->more);
+svuint16_t libdivide_u16_branchfree_do_sve(
+    svuint16_t numers, const struct libdivide_u16_branchfree_t *denom) {
+    svbool_t pg = svptrue_b16();
+    // branchfree always uses the add-marker correction
+    svuint16_t q = svmulh_n_u16_x(pg, numers, denom->magic);
+    svuint16_t t = libdivide_u16_sve_hadd(numers, q);
+    return libdivide_u16_sve_srl(t, denom->more);
 }
 
 ////////// UINT32
 
-__m256i libdivide_u32_do_vec256(__m256i numers, const struct libdivide_u32_t *denom) {
+svuint32_t libdivide_u32_do_sve(svuint32_t numers, const struct libdivide_u32_t *denom) {
+    svbool_t pg = svptrue_b32();
     uint8_t more = denom->more;
+
+    // power of 2 path
     if (!denom->magic) {
-        return _mm256_srli_epi32(numers, more);
-    } else {
-        __m256i q = libdivide_mullhi_u32_vec256(numers, _mm256_set1_epi32(denom->magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // uint32_t t = ((numer - q) >> 1) + q;
-            // return t >> denom->shift;
-            uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-            __m256i t = _mm256_add_epi32(_mm256_srli_epi32(_mm256_sub_epi32(numers, q), 1), q);
-            return _mm256_srli_epi32(t, shift);
-        } else {
-            return _mm256_srli_epi32(q, more);
-        }
+        return libdivide_u32_sve_srl(numers, more);
+    }
+
+    svuint32_t q = svmulh_n_u32_x(pg, numers, denom->magic);
+    if (more & LIBDIVIDE_ADD_MARKER) {
+        // t = (numers + q) >> 1
+        uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+        svuint32_t t = libdivide_u32_sve_hadd(numers, q);
+        return libdivide_u32_sve_srl(t, shift);
     }
+
+    return libdivide_u32_sve_srl(q, more);
 }
 
-__m256i libdivide_u32_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_u32_branchfree_t *denom) {
-    __m256i q = libdivide_mullhi_u32_vec256(numers, _mm256_set1_epi32(denom->magic));
-    __m256i t = _mm256_add_epi32(_mm256_srli_epi32(_mm256_sub_epi32(numers, q), 1), q);
-    return _mm256_srli_epi32(t, denom->more);
+svuint32_t libdivide_u32_branchfree_do_sve(
+    svuint32_t numers, const struct libdivide_u32_branchfree_t *denom) {
+    svbool_t pg = svptrue_b32();
+    // branchfree always uses the add-marker correction
+    svuint32_t q = svmulh_n_u32_x(pg, numers, denom->magic);
+    svuint32_t t = libdivide_u32_sve_hadd(numers, q);
+    return libdivide_u32_sve_srl(t, denom->more);
 }
 
 ////////// UINT64
 
-__m256i libdivide_u64_do_vec256(__m256i numers, const struct libdivide_u64_t *denom) {
+svuint64_t libdivide_u64_do_sve(svuint64_t numers, const struct libdivide_u64_t *denom) {
+    svbool_t pg = svptrue_b64();
     uint8_t more = denom->more;
+
+    // power of 2 path
     if (!denom->magic) {
-        return _mm256_srli_epi64(numers, more);
-    } else {
-        __m256i q = libdivide_mullhi_u64_vec256(numers, _mm256_set1_epi64x(denom->magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // uint32_t t = ((numer - q) >> 1) + q;
-            // return t >> denom->shift;
-            uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-            __m256i t = _mm256_add_epi64(_mm256_srli_epi64(_mm256_sub_epi64(numers, q), 1), q);
-            return _mm256_srli_epi64(t, shift);
-        } else {
-            return _mm256_srli_epi64(q, more);
-        }
+        return libdivide_u64_sve_srl(numers, more);
+    }
+
+    svuint64_t q = svmulh_n_u64_x(pg, numers, denom->magic);
+    if (more & LIBDIVIDE_ADD_MARKER) {
+        // t = (numers + q) >> 1
+        uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+        svuint64_t t = libdivide_u64_sve_hadd(numers, q);
+        return libdivide_u64_sve_srl(t, shift);
     }
+
+    // Masks off LIBDIVIDE_NARROW_MARKER
+    return libdivide_u64_sve_srl(q, more & LIBDIVIDE_64_SHIFT_MASK);
 }
 
-__m256i libdivide_u64_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_u64_branchfree_t *denom) {
-    __m256i q = libdivide_mullhi_u64_vec256(numers, _mm256_set1_epi64x(denom->magic));
-    __m256i t = _mm256_add_epi64(_mm256_srli_epi64(_mm256_sub_epi64(numers, q), 1), q);
-    return _mm256_srli_epi64(t, denom->more);
+svuint64_t libdivide_u64_branchfree_do_sve(
+    svuint64_t numers, const struct libdivide_u64_branchfree_t *denom) {
+    svbool_t pg = svptrue_b64();
+    // branchfree always uses the add-marker correction
+    svuint64_t q = svmulh_n_u64_x(pg, numers, denom->magic);
+    svuint64_t t = libdivide_u64_sve_hadd(numers, q);
+    return libdivide_u64_sve_srl(t, denom->more);
 }
 
 ////////// SINT16
 
-__m256i libdivide_s16_do_vec256(__m256i numers, const struct libdivide_s16_t *denom) {
+svint16_t libdivide_s16_do_sve(svint16_t numers, const struct libdivide_s16_t *denom) {
+    svbool_t pg = svptrue_b16();
     uint8_t more = denom->more;
+
+    // power of 2 path
     if (!denom->magic) {
-        uint16_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+        uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
         uint16_t mask = ((uint16_t)1 << shift) - 1;
-        __m256i roundToZeroTweak = _mm256_set1_epi16(mask);
-        // q = numer + ((numer >> 15) & roundToZeroTweak);
-        __m256i q = _mm256_add_epi16(
-            numers, _mm256_and_si256(_mm256_srai_epi16(numers, 15), roundToZeroTweak));
-        q = _mm256_srai_epi16(q, shift);
-        __m256i sign = _mm256_set1_epi16((int8_t)more >> 7);
-        // q = (q ^ sign) - sign;
-        q = _mm256_sub_epi16(_mm256_xor_si256(q, sign), sign);
-        return q;
-    } else {
-        __m256i q = _mm256_mulhi_epi16(numers, _mm256_set1_epi16(denom->magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // must be arithmetic shift
-            __m256i sign = _mm256_set1_epi16((int8_t)more >> 7);
-            // q += ((numer ^ sign) - sign);
-            q = _mm256_add_epi16(q, _mm256_sub_epi16(_mm256_xor_si256(numers, sign), sign));
-        }
-        // q >>= shift
-        q = _mm256_srai_epi16(q, more & LIBDIVIDE_16_SHIFT_MASK);
-        q = _mm256_add_epi16(q, _mm256_srli_epi16(q, 15));  // q += (q < 0)
-        return q;
+
+        // q = (numers + ((numers < 0) ? mask : 0)) >> shift
+        svint16_t q =
+            svadd_s16_m(svcmplt_n_s16(pg, numers, 0), numers, svdup_n_s16((int16_t)mask));
+        q = libdivide_s16_sve_sra(q, shift);
+
+        // flip sign if divisor was negative
+        svint16_t sign = svdup_n_s16((int8_t)more >> 7);
+        return svsub_s16_x(pg, sveor_s16_x(pg, q, sign), sign);
+    }
+
+    // magic multiply-high path
+    svint16_t q = svmulh_n_s16_x(pg, numers, denom->magic);
+    if (more & LIBDIVIDE_ADD_MARKER) {
+        // add numers back, adjusted for divisor sign
+        svint16_t sign = svdup_n_s16((int8_t)more >> 7);
+        q = svadd_s16_x(pg, q, svsub_s16_x(pg, sveor_s16_x(pg, numers, sign), sign));
     }
+    q = libdivide_s16_sve_sra(q, more & LIBDIVIDE_16_SHIFT_MASK);
+    // round toward zero
+    return svsub_s16_x(pg, q, libdivide_s16_sve_signbits(q));
 }
 
-__m256i libdivide_s16_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_s16_branchfree_t *denom) {
+svint16_t libdivide_s16_branchfree_do_sve(
+    svint16_t numers, const struct libdivide_s16_branchfree_t *denom) {
+    svbool_t pg = svptrue_b16();
     int16_t magic = denom->magic;
     uint8_t more = denom->more;
     uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
-    // must be arithmetic shift
-    __m256i sign = _mm256_set1_epi16((int8_t)more >> 7);
-    __m256i q = _mm256_mulhi_epi16(numers, _mm256_set1_epi16(magic));
-    q = _mm256_add_epi16(q, numers);  // q += numers
-
-    // If q is non-negative, we have nothing to do
-    // If q is negative, we want to add either (2**shift)-1 if d is
-    // a power of 2, or (2**shift) if it is not a power of 2
-    uint16_t is_power_of_2 = (magic == 0);
-    __m256i q_sign = _mm256_srai_epi16(q, 15);  // q_sign = q >> 15
-    __m256i mask = _mm256_set1_epi16(((uint16_t)1 << shift) - is_power_of_2);
-    q = _mm256_add_epi16(q, _mm256_and_si256(q_sign, mask));  // q = q + (q_sign & mask)
-    q = _mm256_srai_epi16(q, shift);                          // q >>= shift
-    q = _mm256_sub_epi16(_mm256_xor_si256(q, sign), sign);    // q = (q ^ sign) - sign
-    return q;
+    svint16_t sign = svdup_n_s16((int8_t)more >> 7);
+    // branchfree starts with q = mullhi(numers, magic) + numers
+    svint16_t q = svmulh_n_s16_x(pg, numers, magic);
+    q = svadd_s16_x(pg, q, numers);
+    uint32_t is_power_of_2 = (magic == 0);
+    uint32_t mask = ((uint32_t)1 << shift) - is_power_of_2;
+    svint16_t mask_vec = svdup_n_s16((int16_t)mask);
+    // negative q needs a bias before arithmetic shift
+    q = svadd_s16_m(svcmplt_n_s16(pg, q, 0), q, mask_vec);
+    q = libdivide_s16_sve_sra(q, shift);
+    return svsub_s16_x(pg, sveor_s16_x(pg, q, sign), sign);
 }
 
 ////////// SINT32
 
-__m256i libdivide_s32_do_vec256(__m256i numers, const struct libdivide_s32_t *denom) {
+svint32_t libdivide_s32_do_sve(svint32_t numers, const struct libdivide_s32_t *denom) {
+    svbool_t pg = svptrue_b32();
     uint8_t more = denom->more;
+
+    // power of 2 path
     if (!denom->magic) {
-        uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+        uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
         uint32_t mask = ((uint32_t)1 << shift) - 1;
-        __m256i roundToZeroTweak = _mm256_set1_epi32(mask);
-        // q = numer + ((numer >> 31) & roundToZeroTweak);
-        __m256i q = _mm256_add_epi32(
-            numers, _mm256_and_si256(_mm256_srai_epi32(numers, 31), roundToZeroTweak));
-        q = _mm256_srai_epi32(q, shift);
-        __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
-        // q = (q ^ sign) - sign;
-        q = _mm256_sub_epi32(_mm256_xor_si256(q, sign), sign);
-        return q;
-    } else {
-        __m256i q = libdivide_mullhi_s32_vec256(numers, _mm256_set1_epi32(denom->magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // must be arithmetic shift
-            __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
-            // q += ((numer ^ sign) - sign);
-            q = _mm256_add_epi32(q, _mm256_sub_epi32(_mm256_xor_si256(numers, sign), sign));
-        }
-        // q >>= shift
-        q = _mm256_srai_epi32(q, more & LIBDIVIDE_32_SHIFT_MASK);
-        q = _mm256_add_epi32(q, _mm256_srli_epi32(q, 31));  // q += (q < 0)
-        return q;
+
+        // q = (numers + ((numers < 0) ? mask : 0)) >> shift
+        svint32_t q =
+            svadd_s32_m(svcmplt_n_s32(pg, numers, 0), numers, svdup_n_s32((int32_t)mask));
+        q = libdivide_s32_sve_sra(q, shift);
+
+        // flip sign if divisor was negative
+        svint32_t sign = svdup_n_s32((int8_t)more >> 7);
+        return svsub_s32_x(pg, sveor_s32_x(pg, q, sign), sign);
+    }
+
+    // magic multiply-high path
+    svint32_t q = svmulh_n_s32_x(pg, numers, denom->magic);
+    if (more & LIBDIVIDE_ADD_MARKER) {
+        // add numers back, adjusted for divisor sign
+        svint32_t sign = svdup_n_s32((int8_t)more >> 7);
+        q = svadd_s32_x(pg, q, svsub_s32_x(pg, sveor_s32_x(pg, numers, sign), sign));
     }
+    q = libdivide_s32_sve_sra(q, more & LIBDIVIDE_32_SHIFT_MASK);
+    // round toward zero
+    return svsub_s32_x(pg, q, libdivide_s32_sve_signbits(q));
 }
 
-__m256i libdivide_s32_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_s32_branchfree_t *denom) {
+svint32_t libdivide_s32_branchfree_do_sve(
+    svint32_t numers, const struct libdivide_s32_branchfree_t *denom) {
+    svbool_t pg = svptrue_b32();
     int32_t magic = denom->magic;
     uint8_t more = denom->more;
     uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-    // must be arithmetic shift
-    __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
-    __m256i q = libdivide_mullhi_s32_vec256(numers, _mm256_set1_epi32(magic));
-    q = _mm256_add_epi32(q, numers);  // q += numers
-
-    // If q is non-negative, we have nothing to do
-    // If q is negative, we want to add either (2**shift)-1 if d is
-    // a power of 2, or (2**shift) if it is not a power of 2
+    svint32_t sign = svdup_n_s32((int8_t)more >> 7);
+    // branchfree starts with q = mullhi(numers, magic) + numers
+    svint32_t q = svmulh_n_s32_x(pg, numers, magic);
+    q = svadd_s32_x(pg, q, numers);
     uint32_t is_power_of_2 = (magic == 0);
-    __m256i q_sign = _mm256_srai_epi32(q, 31);  // q_sign = q >> 31
-    __m256i mask = _mm256_set1_epi32(((uint32_t)1 << shift) - is_power_of_2);
-    q = _mm256_add_epi32(q, _mm256_and_si256(q_sign, mask));  // q = q + (q_sign & mask)
-    q = _mm256_srai_epi32(q, shift);                          // q >>= shift
-    q = _mm256_sub_epi32(_mm256_xor_si256(q, sign), sign);    // q = (q ^ sign) - sign
-    return q;
+    uint32_t mask = ((uint32_t)1 << shift) - is_power_of_2;
+    svint32_t mask_vec = svdup_n_s32((int32_t)mask);
+    // negative q needs a bias before arithmetic shift
+    q = svadd_s32_m(svcmplt_n_s32(pg, q, 0), q, mask_vec);
+    q = libdivide_s32_sve_sra(q, shift);
+    return svsub_s32_x(pg, sveor_s32_x(pg, q, sign), sign);
 }
 
 ////////// SINT64
 
-__m256i libdivide_s64_do_vec256(__m256i numers, const struct libdivide_s64_t *denom) {
+svint64_t libdivide_s64_do_sve(svint64_t numers, const struct libdivide_s64_t *denom) {
+    svbool_t pg = svptrue_b64();
     uint8_t more = denom->more;
     int64_t magic = denom->magic;
-    if (magic == 0) {  // shift path
-        uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+
+    // power of 2 path
+    if (magic == 0) {
+        uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
         uint64_t mask = ((uint64_t)1 << shift) - 1;
-        __m256i roundToZeroTweak = _mm256_set1_epi64x(mask);
-        // q = numer + ((numer >> 63) & roundToZeroTweak);
-        __m256i q = _mm256_add_epi64(
-            numers, _mm256_and_si256(libdivide_s64_signbits_vec256(numers), roundToZeroTweak));
-        q = libdivide_s64_shift_right_vec256(q, shift);
-        __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
-        // q = (q ^ sign) - sign;
-        q = _mm256_sub_epi64(_mm256_xor_si256(q, sign), sign);
-        return q;
-    } else {
-        __m256i q = libdivide_mullhi_s64_vec256(numers, _mm256_set1_epi64x(magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // must be arithmetic shift
-            __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
-            // q += ((numer ^ sign) - sign);
-            q = _mm256_add_epi64(q, _mm256_sub_epi64(_mm256_xor_si256(numers, sign), sign));
-        }
-        // q >>= denom->mult_path.shift
-        q = libdivide_s64_shift_right_vec256(q, more & LIBDIVIDE_64_SHIFT_MASK);
-        q = _mm256_add_epi64(q, _mm256_srli_epi64(q, 63));  // q += (q < 0)
-        return q;
+
+        // q = (numers + ((numers < 0) ? mask : 0)) >> shift
+        svint64_t q =
+            svadd_s64_m(svcmplt_n_s64(pg, numers, 0), numers, svdup_n_s64((int64_t)mask));
+        q = libdivide_s64_sve_sra(q, shift);
+
+        // flip sign if divisor was negative
+        svint64_t sign = svdup_n_s64((int8_t)more >> 7);
+        return svsub_s64_x(pg, sveor_s64_x(pg, q, sign), sign);
+    }
+
+    // magic multiply-high path
+    svint64_t q = svmulh_n_s64_x(pg, numers, magic);
+    if (more & LIBDIVIDE_ADD_MARKER) {
+        // add numers back, adjusted for divisor sign
+        svint64_t sign = svdup_n_s64((int8_t)more >> 7);
+        q = svadd_s64_x(pg, q, svsub_s64_x(pg, sveor_s64_x(pg, numers, sign), sign));
     }
+    q = libdivide_s64_sve_sra(q, more & LIBDIVIDE_64_SHIFT_MASK);
+    // round toward zero
+    return svsub_s64_x(pg, q, libdivide_s64_sve_signbits(q));
 }
 
-__m256i libdivide_s64_branchfree_do_vec256(
-    __m256i numers, const struct libdivide_s64_branchfree_t *denom) {
+svint64_t libdivide_s64_branchfree_do_sve(
+    svint64_t numers, const struct libdivide_s64_branchfree_t *denom) {
+    svbool_t pg = svptrue_b64();
     int64_t magic = denom->magic;
     uint8_t more = denom->more;
     uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-    // must be arithmetic shift
-    __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
-
-    // libdivide_mullhi_s64(numers, magic);
-    __m256i q = libdivide_mullhi_s64_vec256(numers, _mm256_set1_epi64x(magic));
-    q = _mm256_add_epi64(q, numers);  // q += numers
-
-    // If q is non-negative, we have nothing to do.
-    // If q is negative, we want to add either (2**shift)-1 if d is
-    // a power of 2, or (2**shift) if it is not a power of 2.
-    uint32_t is_power_of_2 = (magic == 0);
-    __m256i q_sign = libdivide_s64_signbits_vec256(q);  // q_sign = q >> 63
-    __m256i mask = _mm256_set1_epi64x(((uint64_t)1 << shift) - is_power_of_2);
-    q = _mm256_add_epi64(q, _mm256_and_si256(q_sign, mask));  // q = q + (q_sign & mask)
-    q = libdivide_s64_shift_right_vec256(q, shift);           // q >>= shift
-    q = _mm256_sub_epi64(_mm256_xor_si256(q, sign), sign);    // q = (q ^ sign) - sign
-    return q;
+    svint64_t sign = svdup_n_s64((int8_t)more >> 7);
+    // branchfree starts with q = mullhi(numers, magic) + numers
+    svint64_t q = svmulh_n_s64_x(pg, numers, magic);
+    q = svadd_s64_x(pg, q, numers);
+    uint64_t is_power_of_2 = (magic == 0);
+    svint64_t mask = svdup_n_s64((int64_t)(((uint64_t)1 << shift) - is_power_of_2));
+    // negative q needs a bias before arithmetic shift
+    q = svadd_s64_m(svcmplt_n_s64(pg, q, 0), q, mask);
+    q = libdivide_s64_sve_sra(q, shift);
+    return svsub_s64_x(pg, sveor_s64_x(pg, q, sign), sign);
 }
 
 #endif
 
-#if defined(LIBDIVIDE_SSE2)
+#if defined(LIBDIVIDE_AVX512_KERNELS)
 
-static LIBDIVIDE_INLINE __m128i libdivide_u16_do_vec128(
-    __m128i numers, const struct libdivide_u16_t *denom);
-static LIBDIVIDE_INLINE __m128i libdivide_s16_do_vec128(
-    __m128i numers, const struct libdivide_s16_t *denom);
-static LIBDIVIDE_INLINE __m128i libdivide_u32_do_vec128(
-    __m128i numers, const struct libdivide_u32_t *denom);
-static LIBDIVIDE_INLINE __m128i libdivide_s32_do_vec128(
-    __m128i numers, const struct libdivide_s32_t *denom);
-static LIBDIVIDE_INLINE __m128i libdivide_u64_do_vec128(
-    __m128i numers, const struct libdivide_u64_t *denom);
-static LIBDIVIDE_INLINE __m128i libdivide_s64_do_vec128(
-    __m128i numers, const struct libdivide_s64_t *denom);
+LIBDIVIDE_AVX512_TARGET_PUSH
 
-static LIBDIVIDE_INLINE __m128i libdivide_u16_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_u16_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m128i libdivide_s16_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_s16_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m128i libdivide_u32_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_u32_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m128i libdivide_s32_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_s32_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m128i libdivide_u64_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_u64_branchfree_t *denom);
-static LIBDIVIDE_INLINE __m128i libdivide_s64_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_s64_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_u8_do_vec512(
+    __m512i numers, const struct libdivide_u8_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_s8_do_vec512(
+    __m512i numers, const struct libdivide_s8_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_u16_do_vec512(
+    __m512i numers, const struct libdivide_u16_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_s16_do_vec512(
+    __m512i numers, const struct libdivide_s16_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_u32_do_vec512(
+    __m512i numers, const struct libdivide_u32_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_s32_do_vec512(
+    __m512i numers, const struct libdivide_s32_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_u64_do_vec512(
+    __m512i numers, const struct libdivide_u64_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_s64_do_vec512(
+    __m512i numers, const struct libdivide_s64_t *denom);
+
+static LIBDIVIDE_INLINE __m512i libdivide_u8_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_u8_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_s8_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_s8_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_u16_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_u16_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_s16_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_s16_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_u32_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_u32_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_s32_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_s32_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_u64_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_u64_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m512i libdivide_s64_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_s64_branchfree_t *denom);
 
 //////// Internal Utility Functions
 
-// Implementation of _mm_srai_epi64(v, 63) (from AVX512).
-static LIBDIVIDE_INLINE __m128i libdivide_s64_signbits_vec128(__m128i v) {
-    __m128i hiBitsDuped = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 1, 1));
-    __m128i signBits = _mm_srai_epi32(hiBitsDuped, 31);
-    return signBits;
+static LIBDIVIDE_INLINE __m512i libdivide_s64_signbits_vec512(__m512i v) {
+    ;
+    return _mm512_srai_epi64(v, 63);
 }
 
-// Implementation of _mm_srai_epi64 (from AVX512).
-static LIBDIVIDE_INLINE __m128i libdivide_s64_shift_right_vec128(__m128i v, int amt) {
-    const int b = 64 - amt;
-    __m128i m = _mm_set1_epi64x((uint64_t)1 << (b - 1));
-    __m128i x = _mm_srli_epi64(v, amt);
-    __m128i result = _mm_sub_epi64(_mm_xor_si128(x, m), m);
-    return result;
+static LIBDIVIDE_INLINE __m512i libdivide_s64_shift_right_vec512(__m512i v, int amt) {
+    return _mm512_srai_epi64(v, amt);
 }
 
 // Here, b is assumed to contain one 32-bit value repeated.
-static LIBDIVIDE_INLINE __m128i libdivide_mullhi_u32_vec128(__m128i a, __m128i b) {
-    __m128i hi_product_0Z2Z = _mm_srli_epi64(_mm_mul_epu32(a, b), 32);
-    __m128i a1X3X = _mm_srli_epi64(a, 32);
-    __m128i mask = _mm_set_epi32(-1, 0, -1, 0);
-    __m128i hi_product_Z1Z3 = _mm_and_si128(_mm_mul_epu32(a1X3X, b), mask);
-    return _mm_or_si128(hi_product_0Z2Z, hi_product_Z1Z3);
+static LIBDIVIDE_INLINE __m512i libdivide_mullhi_u32_vec512(__m512i a, __m512i b) {
+    __m512i hi_product_0Z2Z = _mm512_srli_epi64(_mm512_mul_epu32(a, b), 32);
+    __m512i a1X3X = _mm512_srli_epi64(a, 32);
+    __m512i mask = _mm512_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0);
+    __m512i hi_product_Z1Z3 = _mm512_and_si512(_mm512_mul_epu32(a1X3X, b), mask);
+    return _mm512_or_si512(hi_product_0Z2Z, hi_product_Z1Z3);
 }
 
-// SSE2 does not have a signed multiplication instruction, but we can convert
-// unsigned to signed pretty efficiently. Again, b is just a 32 bit value
-// repeated four times.
-static LIBDIVIDE_INLINE __m128i libdivide_mullhi_s32_vec128(__m128i a, __m128i b) {
-    __m128i p = libdivide_mullhi_u32_vec128(a, b);
-    // t1 = (a >> 31) & y, arithmetic shift
-    __m128i t1 = _mm_and_si128(_mm_srai_epi32(a, 31), b);
-    __m128i t2 = _mm_and_si128(_mm_srai_epi32(b, 31), a);
-    p = _mm_sub_epi32(p, t1);
-    p = _mm_sub_epi32(p, t2);
-    return p;
+// b is one 32-bit value repeated.
+static LIBDIVIDE_INLINE __m512i libdivide_mullhi_s32_vec512(__m512i a, __m512i b) {
+    __m512i hi_product_0Z2Z = _mm512_srli_epi64(_mm512_mul_epi32(a, b), 32);
+    __m512i a1X3X = _mm512_srli_epi64(a, 32);
+    __m512i mask = _mm512_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0);
+    __m512i hi_product_Z1Z3 = _mm512_and_si512(_mm512_mul_epi32(a1X3X, b), mask);
+    return _mm512_or_si512(hi_product_0Z2Z, hi_product_Z1Z3);
 }
 
 // Here, y is assumed to contain one 64-bit value repeated.
-static LIBDIVIDE_INLINE __m128i libdivide_mullhi_u64_vec128(__m128i x, __m128i y) {
-    // full 128 bits product is:
-    // x0*y0 + (x0*y1 << 32) + (x1*y0 << 32) + (x1*y1 << 64)
-    // Note x0,y0,x1,y1 are all conceptually uint32, products are 32x32->64.
-
-    // Compute x0*y0.
-    // Note x1, y1 are ignored by mul_epu32.
-    __m128i x0y0 = _mm_mul_epu32(x, y);
-    __m128i x0y0_hi = _mm_srli_epi64(x0y0, 32);
+static LIBDIVIDE_INLINE __m512i libdivide_mullhi_u64_vec512(__m512i x, __m512i y) {
+    // see m128i variant for comments.
+    __m512i x0y0 = _mm512_mul_epu32(x, y);
+    __m512i x0y0_hi = _mm512_srli_epi64(x0y0, 32);
 
-    // Get x1, y1 in the low bits.
-    // We could shuffle or right shift. Shuffles are preferred as they preserve
-    // the source register for the next computation.
-    __m128i x1 = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 1, 1));
-    __m128i y1 = _mm_shuffle_epi32(y, _MM_SHUFFLE(3, 3, 1, 1));
+    __m512i x1 = _mm512_shuffle_epi32(x, (_MM_PERM_ENUM)_MM_SHUFFLE(3, 3, 1, 1));
+    __m512i y1 = _mm512_shuffle_epi32(y, (_MM_PERM_ENUM)_MM_SHUFFLE(3, 3, 1, 1));
 
-    // No need to mask off top 32 bits for mul_epu32.
-    __m128i x0y1 = _mm_mul_epu32(x, y1);
-    __m128i x1y0 = _mm_mul_epu32(x1, y);
-    __m128i x1y1 = _mm_mul_epu32(x1, y1);
+    __m512i x0y1 = _mm512_mul_epu32(x, y1);
+    __m512i x1y0 = _mm512_mul_epu32(x1, y);
+    __m512i x1y1 = _mm512_mul_epu32(x1, y1);
 
-    // Mask here selects low bits only.
-    __m128i mask = _mm_set1_epi64x(0xFFFFFFFF);
-    __m128i temp = _mm_add_epi64(x1y0, x0y0_hi);
-    __m128i temp_lo = _mm_and_si128(temp, mask);
-    __m128i temp_hi = _mm_srli_epi64(temp, 32);
+    __m512i mask = _mm512_set1_epi64(0xFFFFFFFF);
+    __m512i temp = _mm512_add_epi64(x1y0, x0y0_hi);
+    __m512i temp_lo = _mm512_and_si512(temp, mask);
+    __m512i temp_hi = _mm512_srli_epi64(temp, 32);
 
-    temp_lo = _mm_srli_epi64(_mm_add_epi64(temp_lo, x0y1), 32);
-    temp_hi = _mm_add_epi64(x1y1, temp_hi);
-    return _mm_add_epi64(temp_lo, temp_hi);
+    temp_lo = _mm512_srli_epi64(_mm512_add_epi64(temp_lo, x0y1), 32);
+    temp_hi = _mm512_add_epi64(x1y1, temp_hi);
+    return _mm512_add_epi64(temp_lo, temp_hi);
 }
 
 // y is one 64-bit value repeated.
-static LIBDIVIDE_INLINE __m128i libdivide_mullhi_s64_vec128(__m128i x, __m128i y) {
-    __m128i p = libdivide_mullhi_u64_vec128(x, y);
-    __m128i t1 = _mm_and_si128(libdivide_s64_signbits_vec128(x), y);
-    __m128i t2 = _mm_and_si128(libdivide_s64_signbits_vec128(y), x);
-    p = _mm_sub_epi64(p, t1);
-    p = _mm_sub_epi64(p, t2);
+static LIBDIVIDE_INLINE __m512i libdivide_mullhi_s64_vec512(__m512i x, __m512i y) {
+    __m512i p = libdivide_mullhi_u64_vec512(x, y);
+    __m512i t1 = _mm512_and_si512(libdivide_s64_signbits_vec512(x), y);
+    __m512i t2 = _mm512_and_si512(libdivide_s64_signbits_vec512(y), x);
+    p = _mm512_sub_epi64(p, t1);
+    p = _mm512_sub_epi64(p, t2);
     return p;
 }
 
-////////// UINT16
+// 8-bit lanes: 8-bit and 16-bit multiplications require AVX512BW, so the
+// 64 bytes are widened to 32-bit lanes 16 at a time (vpmovzxbd/vpmovsxbd),
+// divided with the 8-bit algorithm in 32-bit arithmetic and narrowed back
+// (vpmovdb). LANES(n, denom) divides 16 widened numerators.
+#define LIBDIVIDE_8_WIDEN_VEC512(LANES, CVT, numers, denom)                                \
+    {                                                                                      \
+        __m512i q = _mm512_castsi128_si512(_mm512_cvtepi32_epi8(                           \
+            LANES(CVT(_mm512_castsi512_si128(numers)), denom)));                           \
+        q = _mm512_inserti32x4(q,                                                          \
+            _mm512_cvtepi32_epi8(LANES(CVT(_mm512_extracti32x4_epi32(numers, 1)), denom)), \
+            1);                                                                            \
+        q = _mm512_inserti32x4(q,                                                          \
+            _mm512_cvtepi32_epi8(LANES(CVT(_mm512_extracti32x4_epi32(numers, 2)), denom)), \
+            2);                                                                            \
+        q = _mm512_inserti32x4(q,                                                          \
+            _mm512_cvtepi32_epi8(LANES(CVT(_mm512_extracti32x4_epi32(numers, 3)), denom)), \
+            3);                                                                            \
+        return q;                                                                          \
+    }
 
-__m128i libdivide_u16_do_vec128(__m128i numers, const struct libdivide_u16_t *denom) {
+// n holds zero extended 8-bit numerators, magic < 2^8 so the products fit
+// in 32 bits.
+static LIBDIVIDE_INLINE __m512i libdivide_mullhi_u8_lanes_vec512(__m512i n, uint8_t magic) {
+    return _mm512_srli_epi32(_mm512_mullo_epi32(n, _mm512_set1_epi32(magic)), 8);
+}
+
+// n holds sign extended 8-bit numerators.
+static LIBDIVIDE_INLINE __m512i libdivide_mullhi_s8_lanes_vec512(__m512i n, int8_t magic) {
+    return _mm512_srai_epi32(_mm512_mullo_epi32(n, _mm512_set1_epi32(magic)), 8);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_u8_lanes_vec512(
+    __m512i n, const struct libdivide_u8_t *denom) {
     uint8_t more = denom->more;
     if (!denom->magic) {
-        return _mm_srli_epi16(numers, more);
-    } else {
-        __m128i q = _mm_mulhi_epu16(numers, _mm_set1_epi16(denom->magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            __m128i t = _mm_adds_epu16(_mm_srli_epi16(_mm_subs_epu16(numers, q), 1), q);
-            return _mm_srli_epi16(t, (more & LIBDIVIDE_16_SHIFT_MASK));
-        } else {
-            return _mm_srli_epi16(q, more);
-        }
+        return _mm512_srli_epi32(n, more);
+    }
+    __m512i q = libdivide_mullhi_u8_lanes_vec512(n, denom->magic);
+    if (more & LIBDIVIDE_ADD_MARKER) {
+        // t = ((n - q) >> 1) + q, which does not exceed n
+        __m512i t = _mm512_add_epi32(_mm512_srli_epi32(_mm512_sub_epi32(n, q), 1), q);
+        return _mm512_srli_epi32(t, more & LIBDIVIDE_8_SHIFT_MASK);
     }
+    return _mm512_srli_epi32(q, more);
 }
 
-__m128i libdivide_u16_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_u16_branchfree_t *denom) {
-    __m128i q = _mm_mulhi_epu16(numers, _mm_set1_epi16(denom->magic));
-    __m128i t = _mm_adds_epu16(_mm_srli_epi16(_mm_subs_epu16(numers, q), 1), q);
-    return _mm_srli_epi16(t, denom->more);
+static LIBDIVIDE_INLINE __m512i libdivide_u8_branchfree_lanes_vec512(
+    __m512i n, const struct libdivide_u8_branchfree_t *denom) {
+    __m512i q = libdivide_mullhi_u8_lanes_vec512(n, denom->magic);
+    __m512i t = _mm512_add_epi32(_mm512_srli_epi32(_mm512_sub_epi32(n, q), 1), q);
+    return _mm512_srli_epi32(t, denom->more);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_s8_lanes_vec512(
+    __m512i n, const struct libdivide_s8_t *denom) {
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_8_SHIFT_MASK;
+    __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
+    if (!denom->magic) {
+        // q = n + ((n >> 7) & mask), then q = ((q >> shift) ^ sign) - sign
+        __m512i mask = _mm512_set1_epi32((1 << shift) - 1);
+        __m512i q = _mm512_add_epi32(n, _mm512_and_si512(_mm512_srai_epi32(n, 31), mask));
+        q = _mm512_srai_epi32(q, shift);
+        return _mm512_sub_epi32(_mm512_xor_si512(q, sign), sign);
+    }
+    __m512i q = libdivide_mullhi_s8_lanes_vec512(n, denom->magic);
+    if (more & LIBDIVIDE_ADD_MARKER) {
+        // q += ((n ^ sign) - sign), the sum does not leave the int8_t range
+        q = _mm512_add_epi32(q, _mm512_sub_epi32(_mm512_xor_si512(n, sign), sign));
+    }
+    q = _mm512_srai_epi32(q, shift);
+    return _mm512_add_epi32(q, _mm512_srli_epi32(q, 31));  // q += (q < 0)
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_s8_branchfree_lanes_vec512(
+    __m512i n, const struct libdivide_s8_branchfree_t *denom) {
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_8_SHIFT_MASK;
+    __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
+    // q = n + mullhi(n, magic), which does not leave the int8_t range
+    __m512i q = _mm512_add_epi32(libdivide_mullhi_s8_lanes_vec512(n, denom->magic), n);
+    // Add (2**shift) - is_power_of_2 to the negative q
+    __m512i mask = _mm512_set1_epi32((1 << shift) - (denom->magic == 0));
+    q = _mm512_add_epi32(q, _mm512_and_si512(_mm512_srai_epi32(q, 31), mask));
+    q = _mm512_srai_epi32(q, shift);
+    return _mm512_sub_epi32(_mm512_xor_si512(q, sign), sign);  // q = (q ^ sign) - sign
+}
+
+////////// UINT8
+
+__m512i libdivide_u8_do_vec512(__m512i numers, const struct libdivide_u8_t *denom) {
+    LIBDIVIDE_8_WIDEN_VEC512(libdivide_u8_lanes_vec512, _mm512_cvtepu8_epi32, numers, denom)
+}
+
+__m512i libdivide_u8_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_u8_branchfree_t *denom) {
+    LIBDIVIDE_8_WIDEN_VEC512(
+        libdivide_u8_branchfree_lanes_vec512, _mm512_cvtepu8_epi32, numers, denom)
 }
 
+////////// UINT16
+
+__m512i libdivide_u16_do_vec512(__m512i numers, const struct libdivide_u16_t *denom){
+    SIMPLE_VECTOR_DIVISION(uint16_t, __m512i, u16)}
+
+__m512i libdivide_u16_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_u16_branchfree_t *denom){
+    SIMPLE_VECTOR_DIVISION(uint16_t, __m512i, u16_branchfree)}
+
 ////////// UINT32
 
-__m128i libdivide_u32_do_vec128(__m128i numers, const struct libdivide_u32_t *denom) {
+__m512i libdivide_u32_do_vec512(__m512i numers, const struct libdivide_u32_t *denom) {
     uint8_t more = denom->more;
     if (!denom->magic) {
-        return _mm_srli_epi32(numers, more);
+        return _mm512_srli_epi32(numers, more);
+    } else if (more & LIBDIVIDE_ADD_MARKER) {
+        // Round down: q = (n + 1) * m_down >> 32 with a masked saturating
+        // increment, see libdivide_u16_round_down_magic()
+        uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+        __m512i ones = _mm512_set1_epi32(1);
+        __mmask16 below_max = _mm512_cmpneq_epu32_mask(numers, _mm512_set1_epi32(-1));
+        __m512i n = _mm512_mask_add_epi32(numers, below_max, numers, ones);
+        __m512i m_down = _mm512_set1_epi32(libdivide_u32_round_down_magic(denom->magic));
+        return _mm512_srli_epi32(libdivide_mullhi_u32_vec512(n, m_down), shift);
     } else {
-        __m128i q = libdivide_mullhi_u32_vec128(numers, _mm_set1_epi32(denom->magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // uint32_t t = ((numer - q) >> 1) + q;
-            // return t >> denom->shift;
-            uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
-            __m128i t = _mm_add_epi32(_mm_srli_epi32(_mm_sub_epi32(numers, q), 1), q);
-            return _mm_srli_epi32(t, shift);
-        } else {
-            return _mm_srli_epi32(q, more);
-        }
+        __m512i q = libdivide_mullhi_u32_vec512(numers, _mm512_set1_epi32(denom->magic));
+        return _mm512_srli_epi32(q, more);
     }
 }
 
-__m128i libdivide_u32_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_u32_branchfree_t *denom) {
-    __m128i q = libdivide_mullhi_u32_vec128(numers, _mm_set1_epi32(denom->magic));
-    __m128i t = _mm_add_epi32(_mm_srli_epi32(_mm_sub_epi32(numers, q), 1), q);
-    return _mm_srli_epi32(t, denom->more);
+__m512i libdivide_u32_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_u32_branchfree_t *denom) {
+    __m512i q = libdivide_mullhi_u32_vec512(numers, _mm512_set1_epi32(denom->magic));
+    __m512i t = _mm512_add_epi32(_mm512_srli_epi32(_mm512_sub_epi32(numers, q), 1), q);
+    return _mm512_srli_epi32(t, denom->more);
 }
 
 ////////// UINT64
 
-__m128i libdivide_u64_do_vec128(__m128i numers, const struct libdivide_u64_t *denom) {
+__m512i libdivide_u64_do_vec512(__m512i numers, const struct libdivide_u64_t *denom) {
     uint8_t more = denom->more;
     if (!denom->magic) {
-        return _mm_srli_epi64(numers, more);
+        return _mm512_srli_epi64(numers, more);
+    } else if (more & LIBDIVIDE_NARROW_MARKER) {
+        // The numerators are < 2^32 and magic is m * 2^32
+        __m512i q = _mm512_mul_epu32(numers, _mm512_set1_epi64(denom->magic >> 32));
+        return _mm512_srli_epi64(q, 32 + (more & LIBDIVIDE_64_SHIFT_MASK));
     } else {
-        __m128i q = libdivide_mullhi_u64_vec128(numers, _mm_set1_epi64x(denom->magic));
+        __m512i q = libdivide_mullhi_u64_vec512(numers, _mm512_set1_epi64(denom->magic));
         if (more & LIBDIVIDE_ADD_MARKER) {
             // uint32_t t = ((numer - q) >> 1) + q;
             // return t >> denom->shift;
             uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
-            __m128i t = _mm_add_epi64(_mm_srli_epi64(_mm_sub_epi64(numers, q), 1), q);
-            return _mm_srli_epi64(t, shift);
+            __m512i t = _mm512_add_epi64(_mm512_srli_epi64(_mm512_sub_epi64(numers, q), 1), q);
+            return _mm512_srli_epi64(t, shift);
         } else {
-            return _mm_srli_epi64(q, more);
+            return _mm512_srli_epi64(q, more);
         }
     }
 }
 
-__m128i libdivide_u64_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_u64_branchfree_t *denom) {
-    __m128i q = libdivide_mullhi_u64_vec128(numers, _mm_set1_epi64x(denom->magic));
-    __m128i t = _mm_add_epi64(_mm_srli_epi64(_mm_sub_epi64(numers, q), 1), q);
-    return _mm_srli_epi64(t, denom->more);
-}
-
-////////// SINT16
-
-__m128i libdivide_s16_do_vec128(__m128i numers, const struct libdivide_s16_t *denom) {
-    uint8_t more = denom->more;
-    if (!denom->magic) {
-        uint16_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
-        uint16_t mask = ((uint16_t)1 << shift) - 1;
-        __m128i roundToZeroTweak = _mm_set1_epi16(mask);
-        // q = numer + ((numer >> 15) & roundToZeroTweak);
-        __m128i q =
-            _mm_add_epi16(numers, _mm_and_si128(_mm_srai_epi16(numers, 15), roundToZeroTweak));
-        q = _mm_srai_epi16(q, shift);
-        __m128i sign = _mm_set1_epi16((int8_t)more >> 7);
-        // q = (q ^ sign) - sign;
-        q = _mm_sub_epi16(_mm_xor_si128(q, sign), sign);
-        return q;
-    } else {
-        __m128i q = _mm_mulhi_epi16(numers, _mm_set1_epi16(denom->magic));
-        if (more & LIBDIVIDE_ADD_MARKER) {
-            // must be arithmetic shift
-            __m128i sign = _mm_set1_epi16((int8_t)more >> 7);
-            // q += ((numer ^ sign) - sign);
-            q = _mm_add_epi16(q, _mm_sub_epi16(_mm_xor_si128(numers, sign), sign));
-        }
-        // q >>= shift
-        q = _mm_srai_epi16(q, more & LIBDIVIDE_16_SHIFT_MASK);
-        q = _mm_add_epi16(q, _mm_srli_epi16(q, 15));  // q += (q < 0)
-        return q;
-    }
+__m512i libdivide_u64_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_u64_branchfree_t *denom) {
+    __m512i q = libdivide_mullhi_u64_vec512(numers, _mm512_set1_epi64(denom->magic));
+    __m512i t = _mm512_add_epi64(_mm512_srli_epi64(_mm512_sub_epi64(numers, q), 1), q);
+    return _mm512_srli_epi64(t, denom->more);
 }
 
-__m128i libdivide_s16_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_s16_branchfree_t *denom) {
-    int16_t magic = denom->magic;
-    uint8_t more = denom->more;
-    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
-    // must be arithmetic shift
-    __m128i sign = _mm_set1_epi16((int8_t)more >> 7);
-    __m128i q = _mm_mulhi_epi16(numers, _mm_set1_epi16(magic));
-    q = _mm_add_epi16(q, numers);  // q += numers
+////////// SINT8
 
-    // If q is non-negative, we have nothing to do
-    // If q is negative, we want to add either (2**shift)-1 if d is
-    // a power of 2, or (2**shift) if it is not a power of 2
-    uint16_t is_power_of_2 = (magic == 0);
-    __m128i q_sign = _mm_srai_epi16(q, 15);  // q_sign = q >> 15
-    __m128i mask = _mm_set1_epi16(((uint16_t)1 << shift) - is_power_of_2);
-    q = _mm_add_epi16(q, _mm_and_si128(q_sign, mask));  // q = q + (q_sign & mask)
-    q = _mm_srai_epi16(q, shift);                       // q >>= shift
-    q = _mm_sub_epi16(_mm_xor_si128(q, sign), sign);    // q = (q ^ sign) - sign
-    return q;
+__m512i libdivide_s8_do_vec512(__m512i numers, const struct libdivide_s8_t *denom) {
+    LIBDIVIDE_8_WIDEN_VEC512(libdivide_s8_lanes_vec512, _mm512_cvtepi8_epi32, numers, denom)
 }
 
+__m512i libdivide_s8_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_s8_branchfree_t *denom) {
+    LIBDIVIDE_8_WIDEN_VEC512(
+        libdivide_s8_branchfree_lanes_vec512, _mm512_cvtepi8_epi32, numers, denom)
+}
+
+////////// SINT16
+
+__m512i libdivide_s16_do_vec512(__m512i numers, const struct libdivide_s16_t *denom){
+    SIMPLE_VECTOR_DIVISION(int16_t, __m512i, s16)}
+
+__m512i libdivide_s16_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_s16_branchfree_t *denom){
+    SIMPLE_VECTOR_DIVISION(int16_t, __m512i, s16_branchfree)}
+
 ////////// SINT32
 
-__m128i libdivide_s32_do_vec128(__m128i numers, const struct libdivide_s32_t *denom) {
+__m512i libdivide_s32_do_vec512(__m512i numers, const struct libdivide_s32_t *denom) {
     uint8_t more = denom->more;
     if (!denom->magic) {
         uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
         uint32_t mask = ((uint32_t)1 << shift) - 1;
-        __m128i roundToZeroTweak = _mm_set1_epi32(mask);
+        __m512i roundToZeroTweak = _mm512_set1_epi32(mask);
         // q = numer + ((numer >> 31) & roundToZeroTweak);
-        __m128i q =
-            _mm_add_epi32(numers, _mm_and_si128(_mm_srai_epi32(numers, 31), roundToZeroTweak));
-        q = _mm_srai_epi32(q, shift);
-        __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
+        __m512i q = _mm512_add_epi32(
+            numers, _mm512_and_si512(_mm512_srai_epi32(numers, 31), roundToZeroTweak));
+        q = _mm512_srai_epi32(q, shift);
+        __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
         // q = (q ^ sign) - sign;
-        q = _mm_sub_epi32(_mm_xor_si128(q, sign), sign);
+        q = _mm512_sub_epi32(_mm512_xor_si512(q, sign), sign);
         return q;
     } else {
-        __m128i q = libdivide_mullhi_s32_vec128(numers, _mm_set1_epi32(denom->magic));
+        __m512i q = libdivide_mullhi_s32_vec512(numers, _mm512_set1_epi32(denom->magic));
         if (more & LIBDIVIDE_ADD_MARKER) {
             // must be arithmetic shift
-            __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
+            __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
             // q += ((numer ^ sign) - sign);
-            q = _mm_add_epi32(q, _mm_sub_epi32(_mm_xor_si128(numers, sign), sign));
+            q = _mm512_add_epi32(q, _mm512_sub_epi32(_mm512_xor_si512(numers, sign), sign));
         }
         // q >>= shift
-        q = _mm_srai_epi32(q, more & LIBDIVIDE_32_SHIFT_MASK);
-        q = _mm_add_epi32(q, _mm_srli_epi32(q, 31));  // q += (q < 0)
+        q = _mm512_srai_epi32(q, more & LIBDIVIDE_32_SHIFT_MASK);
+        q = _mm512_add_epi32(q, _mm512_srli_epi32(q, 31));  // q += (q < 0)
         return q;
     }
 }
 
-__m128i libdivide_s32_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_s32_branchfree_t *denom) {
+__m512i libdivide_s32_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_s32_branchfree_t *denom) {
     int32_t magic = denom->magic;
     uint8_t more = denom->more;
     uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
     // must be arithmetic shift
-    __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
-    __m128i q = libdivide_mullhi_s32_vec128(numers, _mm_set1_epi32(magic));
-    q = _mm_add_epi32(q, numers);  // q += numers
+    __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
+    __m512i q = libdivide_mullhi_s32_vec512(numers, _mm512_set1_epi32(magic));
+    q = _mm512_add_epi32(q, numers);  // q += numers
 
     // If q is non-negative, we have nothing to do
     // If q is negative, we want to add either (2**shift)-1 if d is
     // a power of 2, or (2**shift) if it is not a power of 2
     uint32_t is_power_of_2 = (magic == 0);
-    __m128i q_sign = _mm_srai_epi32(q, 31);  // q_sign = q >> 31
-    __m128i mask = _mm_set1_epi32(((uint32_t)1 << shift) - is_power_of_2);
-    q = _mm_add_epi32(q, _mm_and_si128(q_sign, mask));  // q = q + (q_sign & mask)
-    q = _mm_srai_epi32(q, shift);                       // q >>= shift
-    q = _mm_sub_epi32(_mm_xor_si128(q, sign), sign);    // q = (q ^ sign) - sign
+    __m512i q_sign = _mm512_srai_epi32(q, 31);  // q_sign = q >> 31
+    __m512i mask = _mm512_set1_epi32(((uint32_t)1 << shift) - is_power_of_2);
+    q = _mm512_add_epi32(q, _mm512_and_si512(q_sign, mask));  // q = q + (q_sign & mask)
+    q = _mm512_srai_epi32(q, shift);                          // q >>= shift
+    q = _mm512_sub_epi32(_mm512_xor_si512(q, sign), sign);    // q = (q ^ sign) - sign
     return q;
 }
 
 ////////// SINT64
 
-__m128i libdivide_s64_do_vec128(__m128i numers, const struct libdivide_s64_t *denom) {
+__m512i libdivide_s64_do_vec512(__m512i numers, const struct libdivide_s64_t *denom) {
     uint8_t more = denom->more;
     int64_t magic = denom->magic;
     if (magic == 0) {  // shift path
         uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
         uint64_t mask = ((uint64_t)1 << shift) - 1;
-        __m128i roundToZeroTweak = _mm_set1_epi64x(mask);
+        __m512i roundToZeroTweak = _mm512_set1_epi64(mask);
         // q = numer + ((numer >> 63) & roundToZeroTweak);
-        __m128i q = _mm_add_epi64(
-            numers, _mm_and_si128(libdivide_s64_signbits_vec128(numers), roundToZeroTweak));
-        q = libdivide_s64_shift_right_vec128(q, shift);
-        __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
+        __m512i q = _mm512_add_epi64(
+            numers, _mm512_and_si512(libdivide_s64_signbits_vec512(numers), roundToZeroTweak));
+        q = libdivide_s64_shift_right_vec512(q, shift);
+        __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
         // q = (q ^ sign) - sign;
-        q = _mm_sub_epi64(_mm_xor_si128(q, sign), sign);
+        q = _mm512_sub_epi64(_mm512_xor_si512(q, sign), sign);
         return q;
     } else {
-        __m128i q = libdivide_mullhi_s64_vec128(numers, _mm_set1_epi64x(magic));
+        __m512i q = libdivide_mullhi_s64_vec512(numers, _mm512_set1_epi64(magic));
         if (more & LIBDIVIDE_ADD_MARKER) {
             // must be arithmetic shift
-            __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
+            __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
             // q += ((numer ^ sign) - sign);
-            q = _mm_add_epi64(q, _mm_sub_epi64(_mm_xor_si128(numers, sign), sign));
+            q = _mm512_add_epi64(q, _mm512_sub_epi64(_mm512_xor_si512(numers, sign), sign));
         }
         // q >>= denom->mult_path.shift
-        q = libdivide_s64_shift_right_vec128(q, more & LIBDIVIDE_64_SHIFT_MASK);
-        q = _mm_add_epi64(q, _mm_srli_epi64(q, 63));  // q += (q < 0)
+        q = libdivide_s64_shift_right_vec512(q, more & LIBDIVIDE_64_SHIFT_MASK);
+        q = _mm512_add_epi64(q, _mm512_srli_epi64(q, 63));  // q += (q < 0)
         return q;
     }
 }
 
-__m128i libdivide_s64_branchfree_do_vec128(
-    __m128i numers, const struct libdivide_s64_branchfree_t *denom) {
+__m512i libdivide_s64_branchfree_do_vec512(
+    __m512i numers, const struct libdivide_s64_branchfree_t *denom) {
     int64_t magic = denom->magic;
     uint8_t more = denom->more;
     uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
     // must be arithmetic shift
-    __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
+    __m512i sign = _mm512_set1_epi32((int8_t)more >> 7);
 
     // libdivide_mullhi_s64(numers, magic);
-    __m128i q = libdivide_mullhi_s64_vec128(numers, _mm_set1_epi64x(magic));
-    q = _mm_add_epi64(q, numers);  // q += numers
+    __m512i q = libdivide_mullhi_s64_vec512(numers, _mm512_set1_epi64(magic));
+    q = _mm512_add_epi64(q, numers);  // q += numers
 
     // If q is non-negative, we have nothing to do.
     // If q is negative, we want to add either (2**shift)-1 if d is
     // a power of 2, or (2**shift) if it is not a power of 2.
     uint32_t is_power_of_2 = (magic == 0);
-    __m128i q_sign = libdivide_s64_signbits_vec128(q);  // q_sign = q >> 63
-    __m128i mask = _mm_set1_epi64x(((uint64_t)1 << shift) - is_power_of_2);
-    q = _mm_add_epi64(q, _mm_and_si128(q_sign, mask));  // q = q + (q_sign & mask)
-    q = libdivide_s64_shift_right_vec128(q, shift);     // q >>= shift
-    q = _mm_sub_epi64(_mm_xor_si128(q, sign), sign);    // q = (q ^ sign) - sign
+    __m512i q_sign = libdivide_s64_signbits_vec512(q);  // q_sign = q >> 63
+    __m512i mask = _mm512_set1_epi64(((uint64_t)1 << shift) - is_power_of_2);
+    q = _mm512_add_epi64(q, _mm512_and_si512(q_sign, mask));  // q = q + (q_sign & mask)
+    q = libdivide_s64_shift_right_vec512(q, shift);           // q >>= shift
+    q = _mm512_sub_epi64(_mm512_xor_si512(q, sign), sign);    // q = (q ^ sign) - sign
     return q;
 }
 
+////////// REMAINDER
+
+// Low 64 bits of the products, _mm512_mullo_epi64 requires AVX512DQ.
+static LIBDIVIDE_INLINE __m512i libdivide_mullo_u64_vec512(__m512i x, __m512i y) {
+#if defined(__AVX512DQ__)
+    return _mm512_mullo_epi64(x, y);
+#else
+    __m512i x0y0 = _mm512_mul_epu32(x, y);
+    __m512i x0y1 = _mm512_mul_epu32(x, _mm512_srli_epi64(y, 32));
+    __m512i x1y0 = _mm512_mul_epu32(_mm512_srli_epi64(x, 32), y);
+    __m512i cross = _mm512_slli_epi64(_mm512_add_epi64(x0y1, x1y0), 32);
+    return _mm512_add_epi64(x0y0, cross);
 #endif
+}
 
-////////// C++ stuff
+LIBDIVIDE_DIVMOD_VEC_SIMPLE_GEN(u8, uint8_t, __m512i, vec512)
+LIBDIVIDE_DIVMOD_VEC_SIMPLE_GEN(s8, int8_t, __m512i, vec512)
+LIBDIVIDE_DIVMOD_VEC_SIMPLE_GEN(u16, uint16_t, __m512i, vec512)
+LIBDIVIDE_DIVMOD_VEC_SIMPLE_GEN(s16, int16_t, __m512i, vec512)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u32, uint32_t, __m512i, vec512, _mm512_set1_epi32, _mm512_mullo_epi32, _mm512_sub_epi32)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s32, int32_t, __m512i, vec512, _mm512_set1_epi32, _mm512_mullo_epi32, _mm512_sub_epi32)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u64, uint64_t, __m512i, vec512, _mm512_set1_epi64, libdivide_mullo_u64_vec512, _mm512_sub_epi64)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s64, int64_t, __m512i, vec512, _mm512_set1_epi64, libdivide_mullo_u64_vec512, _mm512_sub_epi64)
+LIBDIVIDE_DIVMOD_VEC_SIMPLE_GEN(u8_branchfree, uint8_t, __m512i, vec512)
+LIBDIVIDE_DIVMOD_VEC_SIMPLE_GEN(s8_branchfree, int8_t, __m512i, vec512)
+LIBDIVIDE_DIVMOD_VEC_SIMPLE_GEN(u16_branchfree, uint16_t, __m512i, vec512)
+LIBDIVIDE_DIVMOD_VEC_SIMPLE_GEN(s16_branchfree, int16_t, __m512i, vec512)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u32_branchfree, uint32_t, __m512i, vec512,
+    _mm512_set1_epi32, _mm512_mullo_epi32, _mm512_sub_epi32)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s32_branchfree, int32_t, __m512i, vec512,
+    _mm512_set1_epi32, _mm512_mullo_epi32, _mm512_sub_epi32)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u64_branchfree, uint64_t, __m512i, vec512,
+    _mm512_set1_epi64, libdivide_mullo_u64_vec512, _mm512_sub_epi64)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s64_branchfree, int64_t, __m512i, vec512,
+    _mm512_set1_epi64, libdivide_mullo_u64_vec512, _mm512_sub_epi64)
+
+////////// FASTMOD
+
+// The 64-bit products are computed in the 64-bit lanes, for the even
+// (low 32 bits) numerators and then for the odd ones.
+
+// Low 64 bits of magic * numer for the numerators in the low 32 bits of
+// each 64-bit lane.
+static LIBDIVIDE_INLINE __m512i libdivide_u32_fastmod_lowbits_vec512(
+    __m512i numers, __m512i magic_lo, __m512i magic_hi) {
+    __m512i hi = _mm512_slli_epi64(_mm512_mul_epu32(numers, magic_hi), 32);
+    return _mm512_add_epi64(_mm512_mul_epu32(numers, magic_lo), hi);
+}
+
+// Same as above with the numerators sign extended to 64 bits, i.e.
+// magic << 32 is subtracted for negative numerators.
+static LIBDIVIDE_INLINE __m512i libdivide_s32_fastmod_lowbits_vec512(
+    __m512i numers, __m512i magic_lo, __m512i magic_hi) {
+    __m512i fix = _mm512_and_si512(_mm512_srai_epi32(numers, 31), magic_lo);
+    __m512i hi = _mm512_sub_epi32(_mm512_mul_epu32(numers, magic_hi), fix);
+    hi = _mm512_slli_epi64(hi, 32);
+    return _mm512_add_epi64(_mm512_mul_epu32(numers, magic_lo), hi);
+}
+
+// (lowbits * d) >> 64, returned in the high 32 bits of each 64-bit lane
+static LIBDIVIDE_INLINE __m512i libdivide_fastmod_highbits_vec512(__m512i lowbits, __m512i d) {
+    __m512i lo = _mm512_srli_epi64(_mm512_mul_epu32(lowbits, d), 32);
+    return _mm512_add_epi64(_mm512_mul_epu32(_mm512_srli_epi64(lowbits, 32), d), lo);
+}
+
+// Moves the results in the high 32 bits of the even and odd lanes back
+// into their 32-bit lanes.
+static LIBDIVIDE_INLINE __m512i libdivide_fastmod_merge_vec512(__m512i even, __m512i odd) {
+    return _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(even, 32), odd);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_u32_fastmod_mod_vec512(
+    __m512i numers, const struct libdivide_u32_fastmod_t *denom) {
+    __m512i magic_lo = _mm512_set1_epi32((int32_t)denom->magic);
+    __m512i magic_hi = _mm512_set1_epi32((int32_t)(denom->magic >> 32));
+    __m512i d = _mm512_set1_epi32((int32_t)denom->d);
+    __m512i even = libdivide_u32_fastmod_lowbits_vec512(numers, magic_lo, magic_hi);
+    __m512i odd =
+        libdivide_u32_fastmod_lowbits_vec512(_mm512_srli_epi64(numers, 32), magic_lo, magic_hi);
+    even = libdivide_fastmod_highbits_vec512(even, d);
+    odd = libdivide_fastmod_highbits_vec512(odd, d);
+    return libdivide_fastmod_merge_vec512(even, odd);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_s32_fastmod_mod_vec512(
+    __m512i numers, const struct libdivide_s32_fastmod_t *denom) {
+    __m512i magic_lo = _mm512_set1_epi32((int32_t)denom->magic);
+    __m512i magic_hi = _mm512_set1_epi32((int32_t)(denom->magic >> 32));
+    __m512i d = _mm512_set1_epi32((int32_t)denom->d);
+    __m512i even = libdivide_s32_fastmod_lowbits_vec512(numers, magic_lo, magic_hi);
+    __m512i odd =
+        libdivide_s32_fastmod_lowbits_vec512(_mm512_srli_epi64(numers, 32), magic_lo, magic_hi);
+    even = libdivide_fastmod_highbits_vec512(even, d);
+    odd = libdivide_fastmod_highbits_vec512(odd, d);
+    __m512i rems = libdivide_fastmod_merge_vec512(even, odd);
+    // rems -= (d - 1) & (numers >> 31)
+    __m512i fix =
+        _mm512_and_si512(_mm512_set1_epi32((int32_t)(denom->d - 1)), _mm512_srai_epi32(numers, 31));
+    return _mm512_sub_epi32(rems, fix);
+}
+
+// Returns a mask with all bits set in the lanes of the multiples of d,
+// i.e. where the low 64 bits of numer * magic are <= magic - 1.
+static LIBDIVIDE_INLINE __m512i libdivide_u32_fastmod_is_divisible_vec512(
+    __m512i numers, const struct libdivide_u32_fastmod_t *denom) {
+    __m512i magic_lo = _mm512_set1_epi32((int32_t)denom->magic);
+    __m512i magic_hi = _mm512_set1_epi32((int32_t)(denom->magic >> 32));
+    __m512i limit = _mm512_set1_epi64((int64_t)(denom->magic - 1));
+    __m512i even = libdivide_u32_fastmod_lowbits_vec512(numers, magic_lo, magic_hi);
+    __m512i odd =
+        libdivide_u32_fastmod_lowbits_vec512(_mm512_srli_epi64(numers, 32), magic_lo, magic_hi);
+    __mmask8 even_mask = _mm512_cmple_epu64_mask(even, limit);
+    __mmask8 odd_mask = _mm512_cmple_epu64_mask(odd, limit);
+    even = _mm512_maskz_set1_epi64(even_mask, 0xFFFFFFFF);
+    return _mm512_mask_blend_epi32(0xAAAA, even, _mm512_maskz_set1_epi64(odd_mask, -1));
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_s32_fastmod_is_divisible_vec512(
+    __m512i numers, const struct libdivide_s32_fastmod_t *denom) {
+    // The unsigned test works with the magic number of the absolute value.
+    const struct libdivide_u32_fastmod_t abs_denom = {denom->magic, denom->d};
+    __m512i abs_numers = _mm512_abs_epi32(numers);
+    return libdivide_u32_fastmod_is_divisible_vec512(abs_numers, &abs_denom);
+}
+
+////////// EXACT DIVISION
+
+LIBDIVIDE_EXACT_VEC_SIMPLE_GEN(u16, uint16_t, __m512i, vec512)
+LIBDIVIDE_EXACT_VEC_SIMPLE_GEN(s16, int16_t, __m512i, vec512)
+LIBDIVIDE_EXACT_VEC_GEN(
+    u32, uint32_t, __m512i, vec512, _mm512_srli_epi32, _mm512_set1_epi32, _mm512_mullo_epi32)
+LIBDIVIDE_EXACT_VEC_GEN(
+    s32, int32_t, __m512i, vec512, _mm512_srai_epi32, _mm512_set1_epi32, _mm512_mullo_epi32)
+LIBDIVIDE_EXACT_VEC_GEN(u64, uint64_t, __m512i, vec512, _mm512_srli_epi64, _mm512_set1_epi64,
+    libdivide_mullo_u64_vec512)
+LIBDIVIDE_EXACT_VEC_GEN(s64, int64_t, __m512i, vec512, libdivide_s64_shift_right_vec512,
+    _mm512_set1_epi64, libdivide_mullo_u64_vec512)
+
+////////// ROUNDING
+
+LIBDIVIDE_ROUND_VEC_SIMPLE_GEN(16, __m512i, vec512)
+LIBDIVIDE_ROUND_VEC_GEN(32, __m512i, vec512, _mm512_set1_epi32, _mm512_add_epi32,
+    _mm512_sub_epi32, _mm512_xor_si512, _mm512_or_si512, _mm512_and_si512, _mm512_srli_epi32,
+    _mm512_srai_epi32, libdivide_mullhi_u32_vec512)
+LIBDIVIDE_ROUND_VEC_GEN(64, __m512i, vec512, _mm512_set1_epi64, _mm512_add_epi64,
+    _mm512_sub_epi64, _mm512_xor_si512, _mm512_or_si512, _mm512_and_si512, _mm512_srli_epi64,
+    _mm512_srai_epi64, libdivide_mullhi_u64_vec512)
+
+////////// FLOATING POINT RECIPROCAL
+
+LIBDIVIDE_FP16_VEC_GEN(__m512i, __m512, vec512, _mm512_set1_epi32, _mm512_set1_ps,
+    _mm512_and_si512, _mm512_or_si512, _mm512_slli_epi32, _mm512_srli_epi32, _mm512_srai_epi32,
+    _mm512_cvtepi32_ps, _mm512_cvttps_epi32, _mm512_mul_ps)
+
+// AVX512F converts unsigned 32-bit lanes directly.
+static LIBDIVIDE_INLINE __m512i libdivide_u32_fp_do_vec512(
+    __m512i numers, const struct libdivide_u32_fp_t *denom) {
+    __m512d recip = _mm512_set1_pd(denom->recip);
+    __m256i lo = _mm512_cvttpd_epu32(
+        _mm512_mul_pd(_mm512_cvtepu32_pd(_mm512_castsi512_si256(numers)), recip));
+    __m256i hi = _mm512_cvttpd_epu32(
+        _mm512_mul_pd(_mm512_cvtepu32_pd(_mm512_extracti64x4_epi64(numers, 1)), recip));
+    return _mm512_inserti64x4(_mm512_castsi256_si512(lo), hi, 1);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_s32_fp_do_vec512(
+    __m512i numers, const struct libdivide_s32_fp_t *denom) {
+    __m512d recip = _mm512_set1_pd(denom->recip);
+    __m256i lo = _mm512_cvttpd_epi32(
+        _mm512_mul_pd(_mm512_cvtepi32_pd(_mm512_castsi512_si256(numers)), recip));
+    __m256i hi = _mm512_cvttpd_epi32(
+        _mm512_mul_pd(_mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(numers, 1)), recip));
+    return _mm512_inserti64x4(_mm512_castsi256_si512(lo), hi, 1);
+}
+
+////////// PER-LANE DIVISORS
+
+// The do_lanes kernels divide each lane of numers by a different branchfree
+// divider: magics holds the magic numbers and mores the (zero-extended) more
+// fields of the dividers, see libdivide_u32_branchfree_do_each() for loading
+// them from an array of dividers. libdivide_mullhi_u64_vec512() and
+// libdivide_mullhi_s64_vec512() already compute the products lane-wise.
+
+// Like libdivide_mullhi_u32_vec512() but b holds one value per lane.
+static LIBDIVIDE_INLINE __m512i libdivide_mullhi_u32_lanes_vec512(__m512i a, __m512i b) {
+    __m512i hi_product_0Z2Z = _mm512_srli_epi64(_mm512_mul_epu32(a, b), 32);
+    __m512i a1X3X = _mm512_srli_epi64(a, 32);
+    __m512i b1X3X = _mm512_srli_epi64(b, 32);
+    __m512i mask = _mm512_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0);
+    __m512i hi_product_Z1Z3 = _mm512_and_si512(_mm512_mul_epu32(a1X3X, b1X3X), mask);
+    return _mm512_or_si512(hi_product_0Z2Z, hi_product_Z1Z3);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_mullhi_s32_lanes_vec512(__m512i a, __m512i b) {
+    __m512i hi_product_0Z2Z = _mm512_srli_epi64(_mm512_mul_epi32(a, b), 32);
+    __m512i a1X3X = _mm512_srli_epi64(a, 32);
+    __m512i b1X3X = _mm512_srli_epi64(b, 32);
+    __m512i mask = _mm512_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0);
+    __m512i hi_product_Z1Z3 = _mm512_and_si512(_mm512_mul_epi32(a1X3X, b1X3X), mask);
+    return _mm512_or_si512(hi_product_0Z2Z, hi_product_Z1Z3);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_u32_branchfree_do_lanes_vec512(
+    __m512i numers, __m512i magics, __m512i mores) {
+    __m512i q = libdivide_mullhi_u32_lanes_vec512(numers, magics);
+    __m512i t = _mm512_add_epi32(_mm512_srli_epi32(_mm512_sub_epi32(numers, q), 1), q);
+    return _mm512_srlv_epi32(t, mores);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_u64_branchfree_do_lanes_vec512(
+    __m512i numers, __m512i magics, __m512i mores) {
+    __m512i q = libdivide_mullhi_u64_vec512(numers, magics);
+    __m512i t = _mm512_add_epi64(_mm512_srli_epi64(_mm512_sub_epi64(numers, q), 1), q);
+    return _mm512_srlv_epi64(t, mores);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_s32_branchfree_do_lanes_vec512(
+    __m512i numers, __m512i magics, __m512i mores) {
+    __m512i one = _mm512_set1_epi32(1);
+    __m512i shifts = _mm512_and_si512(mores, _mm512_set1_epi32(LIBDIVIDE_32_SHIFT_MASK));
+    // must be arithmetic shift
+    __m512i sign = _mm512_srai_epi32(_mm512_slli_epi32(mores, 24), 31);
+    __m512i q = libdivide_mullhi_s32_lanes_vec512(numers, magics);
+    q = _mm512_add_epi32(q, numers);  // q += numers
+
+    // mask = (1 << shift) - is_power_of_2
+    __m512i mask = _mm512_sllv_epi32(one, shifts);
+    __mmask16 is_power_of_2 = _mm512_cmpeq_epi32_mask(magics, _mm512_setzero_si512());
+    mask = _mm512_mask_sub_epi32(mask, is_power_of_2, mask, one);
+    __m512i q_sign = _mm512_srai_epi32(q, 31);                // q_sign = q >> 31
+    q = _mm512_add_epi32(q, _mm512_and_si512(q_sign, mask));  // q = q + (q_sign & mask)
+    q = _mm512_srav_epi32(q, shifts);                         // q >>= shift
+    q = _mm512_sub_epi32(_mm512_xor_si512(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_s64_branchfree_do_lanes_vec512(
+    __m512i numers, __m512i magics, __m512i mores) {
+    __m512i one = _mm512_set1_epi64(1);
+    __m512i shifts = _mm512_and_si512(mores, _mm512_set1_epi64(LIBDIVIDE_64_SHIFT_MASK));
+    // must be arithmetic shift
+    __m512i sign = _mm512_srai_epi64(_mm512_slli_epi64(mores, 56), 63);
+    __m512i q = libdivide_mullhi_s64_vec512(numers, magics);
+    q = _mm512_add_epi64(q, numers);  // q += numers
+
+    // mask = (1 << shift) - is_power_of_2
+    __m512i mask = _mm512_sllv_epi64(one, shifts);
+    __mmask8 is_power_of_2 = _mm512_cmpeq_epi64_mask(magics, _mm512_setzero_si512());
+    mask = _mm512_mask_sub_epi64(mask, is_power_of_2, mask, one);
+    __m512i q_sign = _mm512_srai_epi64(q, 63);                // q_sign = q >> 63
+    q = _mm512_add_epi64(q, _mm512_and_si512(q_sign, mask));  // q = q + (q_sign & mask)
+    q = _mm512_srav_epi64(q, shifts);                         // q >>= shift
+    q = _mm512_sub_epi64(_mm512_xor_si512(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+// The do_table kernels divide lane i of numers by the branchfree divider
+// number indices[i] of a table stored as separate arrays of magic numbers
+// and more fields (see libdivide::divider_table). The indices are 32-bit
+// integers less than 2^31, the gathers sign extend them. For 64-bit
+// integers they fill half a vector. The more fields are gathered as lane
+// sized words, so mores must be readable for 3 (resp. 7) bytes past the
+// last divider.
+#define LIBDIVIDE_TABLE_VEC512_GEN(ALGO, MagicT, IdxT, GATHER, SET1)                          \
+    static LIBDIVIDE_INLINE __m512i libdivide_##ALGO##_do_table_vec512(                       \
+        __m512i numers, IdxT indices, const MagicT *magics, const uint8_t *mores) {           \
+        __m512i m = GATHER(indices, (const void *)magics, sizeof(MagicT));                    \
+        __m512i more = _mm512_and_si512(GATHER(indices, (const void *)mores, 1), SET1(0xFF)); \
+        return libdivide_##ALGO##_do_lanes_vec512(numers, m, more);                           \
+    }
+
+LIBDIVIDE_TABLE_VEC512_GEN(
+    u32_branchfree, uint32_t, __m512i, _mm512_i32gather_epi32, _mm512_set1_epi32)
+LIBDIVIDE_TABLE_VEC512_GEN(
+    s32_branchfree, int32_t, __m512i, _mm512_i32gather_epi32, _mm512_set1_epi32)
+LIBDIVIDE_TABLE_VEC512_GEN(
+    u64_branchfree, uint64_t, __m256i, _mm512_i32gather_epi64, _mm512_set1_epi64)
+LIBDIVIDE_TABLE_VEC512_GEN(
+    s64_branchfree, int64_t, __m256i, _mm512_i32gather_epi64, _mm512_set1_epi64)
+
+////////// MODULAR MULTIPLICATION
+
+static LIBDIVIDE_INLINE __m512i libdivide_u32_sub_fix_vec512(__m512i a, __m512i b, __m512i m) {
+    __m512i diff = _mm512_sub_epi32(a, b);
+    return _mm512_mask_add_epi32(diff, _mm512_cmplt_epu32_mask(a, b), diff, m);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_u64_sub_fix_vec512(__m512i a, __m512i b, __m512i m) {
+    __m512i diff = _mm512_sub_epi64(a, b);
+    return _mm512_mask_add_epi64(diff, _mm512_cmplt_epu64_mask(a, b), diff, m);
+}
+
+LIBDIVIDE_MODMUL_VEC_GEN(u32, __m512i, vec512, _mm512_set1_epi32, int32_t, _mm512_sub_epi32,
+    _mm512_mullo_epi32, libdivide_mullhi_u32_lanes_vec512, libdivide_u32_sub_fix_vec512)
+LIBDIVIDE_MODMUL_VEC_GEN(u64, __m512i, vec512, _mm512_set1_epi64, int64_t, _mm512_sub_epi64,
+    libdivide_mullo_u64_vec512, libdivide_mullhi_u64_vec512, libdivide_u64_sub_fix_vec512)
+
+////////// RATIONAL SCALING
+
+LIBDIVIDE_SCALER_VEC_GEN(__m512i, vec512, _mm512_set1_epi64, _mm512_add_epi64, _mm512_sub_epi64,
+    _mm512_and_si512, _mm512_or_si512, _mm512_andnot_si512, _mm512_srli_epi64, _mm512_slli_epi64,
+    _mm512_srl_epi64, _mm512_sll_epi64, _mm512_mul_epu32, libdivide_mullo_u64_vec512,
+    libdivide_mullhi_u64_vec512)
+
+////////// FIXED POINT DIVISION
+
+// 16-bit multiplications require AVX512BW, so the low and the high
+// halves of the 32-bit lanes are computed separately from the 16-bit
+// words of magic: with n < 2^16 each partial product fits in 32 bits.
+static LIBDIVIDE_INLINE __m512i libdivide_u16_fixed_lanes_vec512(
+    __m512i n, const struct libdivide_u16_fixed_t *denom) {
+    __m512i m0 = _mm512_set1_epi32((int32_t)(denom->magic & 0xFFFF));
+    __m512i m1 = _mm512_set1_epi32((int32_t)((denom->magic >> 16) & 0xFFFF));
+    __m512i m2 = _mm512_set1_epi32((int32_t)(denom->magic >> 32));
+    __m512i t = _mm512_add_epi32(
+        _mm512_mullo_epi32(n, m1), _mm512_srli_epi32(_mm512_mullo_epi32(n, m0), 16));
+    return _mm512_add_epi32(_mm512_mullo_epi32(n, m2), _mm512_srli_epi32(t, 16));
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_u16_fixed_do_vec512(
+    __m512i numers, const struct libdivide_u16_fixed_t *denom) {
+    __m512i mask = _mm512_set1_epi32(0xFFFF);
+    __m512i lo = libdivide_u16_fixed_lanes_vec512(_mm512_and_si512(numers, mask), denom);
+    __m512i hi = libdivide_u16_fixed_lanes_vec512(_mm512_srli_epi32(numers, 16), denom);
+    return _mm512_or_si512(_mm512_and_si512(lo, mask), _mm512_slli_epi32(hi, 16));
+}
+
+LIBDIVIDE_FIXED_VEC_GEN(__m512i, vec512, _mm512_set1_epi64, _mm512_add_epi64, _mm512_and_si512,
+    _mm512_or_si512, _mm512_srli_epi64, _mm512_slli_epi64, _mm512_mul_epu32,
+    libdivide_mullo_u64_vec512, libdivide_mullhi_u64_vec512)
+
+////////// DIVIDER GENERATION
+
+// Generates the dividers of the 8 divisors in divisors, none of which may
+// be 0, with the same results as libdivide_internal_u32_gen(). The magic
+// numbers are returned and the more fields are stored to the low 8 bytes
+// of *mores. floor_log_2_d is the exponent of d converted to double, and
+// the double precision quotient 2^(32 + floor_log_2_d) / d is < 2^32 - 1
+// and off by at most one after truncation, the remainder corrects it.
+static LIBDIVIDE_INLINE __m256i libdivide_internal_u32_gen_vec512(
+    __m256i divisors, int branchfree, __m128i *mores) {
+    __m512i one = _mm512_set1_epi64(1);
+    __m512i d = _mm512_cvtepu32_epi64(divisors);
+    __m512d d_pd = _mm512_cvtepu32_pd(divisors);
+    __m512i exponent =
+        _mm512_and_si512(_mm512_castpd_si512(d_pd), _mm512_set1_epi64(0x7FF0000000000000));
+    __m512i floor_log_2_d =
+        _mm512_sub_epi64(_mm512_srli_epi64(exponent, 52), _mm512_set1_epi64(1023));
+    __m512d power =
+        _mm512_castsi512_pd(_mm512_add_epi64(exponent, _mm512_set1_epi64((int64_t)32 << 52)));
+
+    __m512i proposed_m = _mm512_cvtepu32_epi64(_mm512_cvttpd_epu32(_mm512_div_pd(power, d_pd)));
+    __m512i rem = _mm512_sub_epi64(
+        _mm512_sllv_epi64(one, _mm512_add_epi64(floor_log_2_d, _mm512_set1_epi64(32))),
+        _mm512_mul_epu32(proposed_m, d));
+    __mmask8 fix = _mm512_cmplt_epi64_mask(rem, _mm512_setzero_si512());
+    proposed_m = _mm512_mask_sub_epi64(proposed_m, fix, proposed_m, one);
+    rem = _mm512_mask_add_epi64(rem, fix, rem, d);
+    fix = _mm512_cmpge_epi64_mask(rem, d);
+    proposed_m = _mm512_mask_add_epi64(proposed_m, fix, proposed_m, one);
+    rem = _mm512_mask_sub_epi64(rem, fix, rem, d);
+
+    // The general 33-bit algorithm: 1 + 2 * proposed_m, plus 1 if
+    // 2 * rem >= d. This power works instead if e = d - rem is
+    // < 2^floor_log_2_d.
+    __m512i more = floor_log_2_d;
+    __m512i magic = _mm512_add_epi64(_mm512_add_epi64(proposed_m, proposed_m), one);
+    magic = _mm512_mask_add_epi64(
+        magic, _mm512_cmpge_epi64_mask(_mm512_add_epi64(rem, rem), d), magic, one);
+    if (!branchfree) {
+        __mmask8 works = _mm512_cmplt_epi64_mask(
+            _mm512_sub_epi64(d, rem), _mm512_sllv_epi64(one, floor_log_2_d));
+        magic = _mm512_mask_add_epi64(magic, works, proposed_m, one);
+        more = _mm512_mask_or_epi64(
+            more, (__mmask8)~works, more, _mm512_set1_epi64(LIBDIVIDE_ADD_MARKER));
+    }
+
+    // Power of 2
+    __mmask8 pow2 = _mm512_testn_epi64_mask(d, _mm512_sub_epi64(d, one));
+    magic = _mm512_maskz_mov_epi64((__mmask8)~pow2, magic);
+    more = _mm512_mask_sub_epi64(
+        more, pow2, floor_log_2_d, _mm512_set1_epi64(branchfree != 0));
+    *mores = _mm512_cvtepi64_epi8(more);
+    return _mm512_cvtepi64_epi32(magic);
+}
+
+LIBDIVIDE_AVX512_TARGET_POP
+
+#endif
+
+#if defined(LIBDIVIDE_AVX2_KERNELS)
+
+LIBDIVIDE_AVX2_TARGET_PUSH
+
+static LIBDIVIDE_INLINE __m256i libdivide_u8_do_vec256(
+    __m256i numers, const struct libdivide_u8_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_s8_do_vec256(
+    __m256i numers, const struct libdivide_s8_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_u16_do_vec256(
+    __m256i numers, const struct libdivide_u16_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_s16_do_vec256(
+    __m256i numers, const struct libdivide_s16_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_u32_do_vec256(
+    __m256i numers, const struct libdivide_u32_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_s32_do_vec256(
+    __m256i numers, const struct libdivide_s32_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_u64_do_vec256(
+    __m256i numers, const struct libdivide_u64_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_s64_do_vec256(
+    __m256i numers, const struct libdivide_s64_t *denom);
+
+static LIBDIVIDE_INLINE __m256i libdivide_u8_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_u8_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_s8_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_s8_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_u16_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_u16_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_s16_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_s16_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_u32_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_u32_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_s32_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_s32_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_u64_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_u64_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m256i libdivide_s64_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_s64_branchfree_t *denom);
+
+//////// Internal Utility Functions
+
+// Implementation of _mm256_srai_epi64(v, 63) (from AVX512).
+static LIBDIVIDE_INLINE __m256i libdivide_s64_signbits_vec256(__m256i v) {
+    __m256i hiBitsDuped = _mm256_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 1, 1));
+    __m256i signBits = _mm256_srai_epi32(hiBitsDuped, 31);
+    return signBits;
+}
+
+// Implementation of _mm256_srai_epi64 (from AVX512).
+static LIBDIVIDE_INLINE __m256i libdivide_s64_shift_right_vec256(__m256i v, int amt) {
+    const int b = 64 - amt;
+    __m256i m = _mm256_set1_epi64x((uint64_t)1 << (b - 1));
+    __m256i x = _mm256_srli_epi64(v, amt);
+    __m256i result = _mm256_sub_epi64(_mm256_xor_si256(x, m), m);
+    return result;
+}
+
+// Here, b is assumed to contain one 32-bit value repeated.
+static LIBDIVIDE_INLINE __m256i libdivide_mullhi_u32_vec256(__m256i a, __m256i b) {
+    __m256i hi_product_0Z2Z = _mm256_srli_epi64(_mm256_mul_epu32(a, b), 32);
+    __m256i a1X3X = _mm256_srli_epi64(a, 32);
+    __m256i mask = _mm256_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0);
+    __m256i hi_product_Z1Z3 = _mm256_and_si256(_mm256_mul_epu32(a1X3X, b), mask);
+    return _mm256_or_si256(hi_product_0Z2Z, hi_product_Z1Z3);
+}
+
+// b is one 32-bit value repeated.
+static LIBDIVIDE_INLINE __m256i libdivide_mullhi_s32_vec256(__m256i a, __m256i b) {
+    __m256i hi_product_0Z2Z = _mm256_srli_epi64(_mm256_mul_epi32(a, b), 32);
+    __m256i a1X3X = _mm256_srli_epi64(a, 32);
+    __m256i mask = _mm256_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0);
+    __m256i hi_product_Z1Z3 = _mm256_and_si256(_mm256_mul_epi32(a1X3X, b), mask);
+    return _mm256_or_si256(hi_product_0Z2Z, hi_product_Z1Z3);
+}
+
+// Here, y is assumed to contain one 64-bit value repeated.
+static LIBDIVIDE_INLINE __m256i libdivide_mullhi_u64_vec256(__m256i x, __m256i y) {
+    // see m128i variant for comments.
+    __m256i x0y0 = _mm256_mul_epu32(x, y);
+    __m256i x0y0_hi = _mm256_srli_epi64(x0y0, 32);
+
+    __m256i x1 = _mm256_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 1, 1));
+    __m256i y1 = _mm256_shuffle_epi32(y, _MM_SHUFFLE(3, 3, 1, 1));
+
+    __m256i x0y1 = _mm256_mul_epu32(x, y1);
+    __m256i x1y0 = _mm256_mul_epu32(x1, y);
+    __m256i x1y1 = _mm256_mul_epu32(x1, y1);
+
+    __m256i mask = _mm256_set1_epi64x(0xFFFFFFFF);
+    __m256i temp = _mm256_add_epi64(x1y0, x0y0_hi);
+    __m256i temp_lo = _mm256_and_si256(temp, mask);
+    __m256i temp_hi = _mm256_srli_epi64(temp, 32);
+
+    temp_lo = _mm256_srli_epi64(_mm256_add_epi64(temp_lo, x0y1), 32);
+    temp_hi = _mm256_add_epi64(x1y1, temp_hi);
+    return _mm256_add_epi64(temp_lo, temp_hi);
+}
+
+// The high halves of x * y + y, see libdivide_mullhi_add_u64_vec128().
+static LIBDIVIDE_INLINE __m256i libdivide_mullhi_add_u64_vec256(__m256i x, __m256i y) {
+    __m256i mask = _mm256_set1_epi64x(0xFFFFFFFF);
+    __m256i x1 = _mm256_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 1, 1));
+    __m256i y1 = _mm256_srli_epi64(y, 32);
+
+    __m256i x0y0 = _mm256_add_epi64(_mm256_mul_epu32(x, y), _mm256_and_si256(y, mask));
+    __m256i x0y0_hi = _mm256_srli_epi64(x0y0, 32);
+    __m256i x0y1 = _mm256_add_epi64(_mm256_mul_epu32(x, y1), y1);
+    __m256i x1y0 = _mm256_mul_epu32(x1, y);
+    __m256i x1y1 = _mm256_mul_epu32(x1, y1);
+
+    __m256i temp = _mm256_add_epi64(x1y0, x0y0_hi);
+    __m256i temp_lo = _mm256_and_si256(temp, mask);
+    __m256i temp_hi = _mm256_srli_epi64(temp, 32);
+
+    temp_lo = _mm256_srli_epi64(_mm256_add_epi64(temp_lo, x0y1), 32);
+    temp_hi = _mm256_add_epi64(x1y1, temp_hi);
+    return _mm256_add_epi64(temp_lo, temp_hi);
+}
+
+// y is one 64-bit value repeated.
+static LIBDIVIDE_INLINE __m256i libdivide_mullhi_s64_vec256(__m256i x, __m256i y) {
+    __m256i p = libdivide_mullhi_u64_vec256(x, y);
+    __m256i t1 = _mm256_and_si256(libdivide_s64_signbits_vec256(x), y);
+    __m256i t2 = _mm256_and_si256(libdivide_s64_signbits_vec256(y), x);
+    p = _mm256_sub_epi64(p, t1);
+    p = _mm256_sub_epi64(p, t2);
+    return p;
+}
+
+// 8-bit lanes: x86 has no 8-bit multiplications or shifts. The numerators
+// are unpacked into the high bytes of 16-bit lanes, so that the high half
+// of the 16-bit products with the magic number (y, one 16-bit value
+// repeated) is the high byte of the 8-bit products.
+static LIBDIVIDE_INLINE __m256i libdivide_mullhi_u8_vec256(__m256i x, __m256i y) {
+    __m256i zero = _mm256_setzero_si256();
+    __m256i lo = _mm256_mulhi_epu16(_mm256_unpacklo_epi8(zero, x), y);
+    __m256i hi = _mm256_mulhi_epu16(_mm256_unpackhi_epi8(zero, x), y);
+    return _mm256_packus_epi16(lo, hi);
+}
+
+// y is one sign extended 8-bit value repeated in the 16-bit lanes.
+static LIBDIVIDE_INLINE __m256i libdivide_mullhi_s8_vec256(__m256i x, __m256i y) {
+    __m256i zero = _mm256_setzero_si256();
+    __m256i lo = _mm256_mulhi_epi16(_mm256_unpacklo_epi8(zero, x), y);
+    __m256i hi = _mm256_mulhi_epi16(_mm256_unpackhi_epi8(zero, x), y);
+    return _mm256_packs_epi16(lo, hi);
+}
+
+// Logical right shift of 8-bit lanes: shift 16-bit lanes and clear the
+// bits shifted in from the neighbouring byte.
+static LIBDIVIDE_INLINE __m256i libdivide_u8_shift_right_vec256(__m256i v, int amt) {
+    return _mm256_and_si256(_mm256_srli_epi16(v, amt), _mm256_set1_epi8((char)(0xFF >> amt)));
+}
+
+// Arithmetic right shift of 8-bit lanes.
+static LIBDIVIDE_INLINE __m256i libdivide_s8_shift_right_vec256(__m256i v, int amt) {
+    __m256i m = _mm256_set1_epi8((char)(0x80 >> amt));
+    __m256i x = libdivide_u8_shift_right_vec256(v, amt);
+    return _mm256_sub_epi8(_mm256_xor_si256(x, m), m);
+}
+
+// All bits set in the negative 8-bit lanes.
+static LIBDIVIDE_INLINE __m256i libdivide_s8_signbits_vec256(__m256i v) {
+    return _mm256_cmpgt_epi8(_mm256_setzero_si256(), v);
+}
+
+////////// UINT8
+
+__m256i libdivide_u8_do_vec256(__m256i numers, const struct libdivide_u8_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return libdivide_u8_shift_right_vec256(numers, more);
+    } else {
+        __m256i q = libdivide_mullhi_u8_vec256(numers, _mm256_set1_epi16(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            __m256i t = _mm256_adds_epu8(libdivide_u8_shift_right_vec256(_mm256_subs_epu8(numers, q), 1), q);
+            return libdivide_u8_shift_right_vec256(t, (more & LIBDIVIDE_8_SHIFT_MASK));
+        } else {
+            return libdivide_u8_shift_right_vec256(q, more);
+        }
+    }
+}
+
+__m256i libdivide_u8_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_u8_branchfree_t *denom) {
+    __m256i q = libdivide_mullhi_u8_vec256(numers, _mm256_set1_epi16(denom->magic));
+    __m256i t = _mm256_adds_epu8(libdivide_u8_shift_right_vec256(_mm256_subs_epu8(numers, q), 1), q);
+    return libdivide_u8_shift_right_vec256(t, denom->more);
+}
+
+////////// UINT16
+
+__m256i libdivide_u16_do_vec256(__m256i numers, const struct libdivide_u16_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return _mm256_srli_epi16(numers, more);
+    } else if (more & LIBDIVIDE_ADD_MARKER) {
+        // Round down, see libdivide_u16_do_vec128()
+        __m256i m_down = _mm256_set1_epi16(libdivide_u16_round_down_magic(denom->magic));
+        __m256i q = _mm256_mulhi_epu16(_mm256_adds_epu16(numers, _mm256_set1_epi16(1)), m_down);
+        return _mm256_srli_epi16(q, (more & LIBDIVIDE_16_SHIFT_MASK));
+    } else {
+        __m256i q = _mm256_mulhi_epu16(numers, _mm256_set1_epi16(denom->magic));
+        return _mm256_srli_epi16(q, more);
+    }
+}
+
+__m256i libdivide_u16_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_u16_branchfree_t *denom) {
+    __m256i q = _mm256_mulhi_epu16(numers, _mm256_set1_epi16(denom->magic));
+    __m256i t = _mm256_adds_epu16(_mm256_srli_epi16(_mm256_subs_epu16(numers, q), 1), q);
+    return _mm256_srli_epi16(t, denom->more);
+}
+
+////////// UINT32
+
+__m256i libdivide_u32_do_vec256(__m256i numers, const struct libdivide_u32_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return _mm256_srli_epi32(numers, more);
+    } else {
+        __m256i q = libdivide_mullhi_u32_vec256(numers, _mm256_set1_epi32(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // uint32_t t = ((numer - q) >> 1) + q;
+            // return t >> denom->shift;
+            uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+            __m256i t = _mm256_add_epi32(_mm256_srli_epi32(_mm256_sub_epi32(numers, q), 1), q);
+            return _mm256_srli_epi32(t, shift);
+        } else {
+            return _mm256_srli_epi32(q, more);
+        }
+    }
+}
+
+__m256i libdivide_u32_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_u32_branchfree_t *denom) {
+    __m256i q = libdivide_mullhi_u32_vec256(numers, _mm256_set1_epi32(denom->magic));
+    __m256i t = _mm256_add_epi32(_mm256_srli_epi32(_mm256_sub_epi32(numers, q), 1), q);
+    return _mm256_srli_epi32(t, denom->more);
+}
+
+////////// UINT64
+
+__m256i libdivide_u64_do_vec256(__m256i numers, const struct libdivide_u64_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return _mm256_srli_epi64(numers, more);
+    } else if (more & LIBDIVIDE_NARROW_MARKER) {
+        // The numerators are < 2^32 and magic is m * 2^32
+        __m256i q = _mm256_mul_epu32(numers, _mm256_set1_epi64x(denom->magic >> 32));
+        return _mm256_srli_epi64(q, 32 + (more & LIBDIVIDE_64_SHIFT_MASK));
+    } else if (more & LIBDIVIDE_ADD_MARKER) {
+        // Round down: q = (n * m_down + m_down) >> 64, see
+        // libdivide_u16_round_down_magic()
+        uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+        __m256i m_down = _mm256_set1_epi64x(libdivide_u64_round_down_magic(denom->magic));
+        return _mm256_srli_epi64(libdivide_mullhi_add_u64_vec256(numers, m_down), shift);
+    } else {
+        __m256i q = libdivide_mullhi_u64_vec256(numers, _mm256_set1_epi64x(denom->magic));
+        return _mm256_srli_epi64(q, more);
+    }
+}
+
+__m256i libdivide_u64_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_u64_branchfree_t *denom) {
+    __m256i q = libdivide_mullhi_u64_vec256(numers, _mm256_set1_epi64x(denom->magic));
+    __m256i t = _mm256_add_epi64(_mm256_srli_epi64(_mm256_sub_epi64(numers, q), 1), q);
+    return _mm256_srli_epi64(t, denom->more);
+}
+
+////////// SINT8
+
+__m256i libdivide_s8_do_vec256(__m256i numers, const struct libdivide_s8_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        uint8_t shift = more & LIBDIVIDE_8_SHIFT_MASK;
+        uint8_t mask = (uint8_t)((1 << shift) - 1);
+        __m256i roundToZeroTweak = _mm256_set1_epi8((char)mask);
+        // q = numer + ((numer >> 7) & roundToZeroTweak);
+        __m256i q = _mm256_add_epi8(
+            numers, _mm256_and_si256(libdivide_s8_signbits_vec256(numers), roundToZeroTweak));
+        q = libdivide_s8_shift_right_vec256(q, shift);
+        __m256i sign = _mm256_set1_epi8((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = _mm256_sub_epi8(_mm256_xor_si256(q, sign), sign);
+        return q;
+    } else {
+        __m256i q = libdivide_mullhi_s8_vec256(numers, _mm256_set1_epi16(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            __m256i sign = _mm256_set1_epi8((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = _mm256_add_epi8(q, _mm256_sub_epi8(_mm256_xor_si256(numers, sign), sign));
+        }
+        // q >>= shift
+        q = libdivide_s8_shift_right_vec256(q, more & LIBDIVIDE_8_SHIFT_MASK);
+        q = _mm256_add_epi8(q, libdivide_u8_shift_right_vec256(q, 7));  // q += (q < 0)
+        return q;
+    }
+}
+
+__m256i libdivide_s8_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_s8_branchfree_t *denom) {
+    int8_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_8_SHIFT_MASK;
+    // must be arithmetic shift
+    __m256i sign = _mm256_set1_epi8((int8_t)more >> 7);
+    __m256i q = libdivide_mullhi_s8_vec256(numers, _mm256_set1_epi16(magic));
+    q = _mm256_add_epi8(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint8_t is_power_of_2 = (magic == 0);
+    __m256i q_sign = libdivide_s8_signbits_vec256(q);  // q_sign = q >> 7
+    __m256i mask = _mm256_set1_epi8((char)((1 << shift) - is_power_of_2));
+    q = _mm256_add_epi8(q, _mm256_and_si256(q_sign, mask));  // q = q + (q_sign & mask)
+    q = libdivide_s8_shift_right_vec256(q, shift);      // q >>= shift
+    q = _mm256_sub_epi8(_mm256_xor_si256(q, sign), sign);     // q = (q ^ sign) - sign
+    return q;
+}
+
+////////// SINT16
+
+__m256i libdivide_s16_do_vec256(__m256i numers, const struct libdivide_s16_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        uint16_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+        uint16_t mask = ((uint16_t)1 << shift) - 1;
+        __m256i roundToZeroTweak = _mm256_set1_epi16(mask);
+        // q = numer + ((numer >> 15) & roundToZeroTweak);
+        __m256i q = _mm256_add_epi16(
+            numers, _mm256_and_si256(_mm256_srai_epi16(numers, 15), roundToZeroTweak));
+        q = _mm256_srai_epi16(q, shift);
+        __m256i sign = _mm256_set1_epi16((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = _mm256_sub_epi16(_mm256_xor_si256(q, sign), sign);
+        return q;
+    } else {
+        __m256i q = _mm256_mulhi_epi16(numers, _mm256_set1_epi16(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            __m256i sign = _mm256_set1_epi16((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = _mm256_add_epi16(q, _mm256_sub_epi16(_mm256_xor_si256(numers, sign), sign));
+        }
+        // q >>= shift
+        q = _mm256_srai_epi16(q, more & LIBDIVIDE_16_SHIFT_MASK);
+        q = _mm256_add_epi16(q, _mm256_srli_epi16(q, 15));  // q += (q < 0)
+        return q;
+    }
+}
+
+__m256i libdivide_s16_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_s16_branchfree_t *denom) {
+    int16_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+    // must be arithmetic shift
+    __m256i sign = _mm256_set1_epi16((int8_t)more >> 7);
+    __m256i q = _mm256_mulhi_epi16(numers, _mm256_set1_epi16(magic));
+    q = _mm256_add_epi16(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint16_t is_power_of_2 = (magic == 0);
+    __m256i q_sign = _mm256_srai_epi16(q, 15);  // q_sign = q >> 15
+    __m256i mask = _mm256_set1_epi16(((uint16_t)1 << shift) - is_power_of_2);
+    q = _mm256_add_epi16(q, _mm256_and_si256(q_sign, mask));  // q = q + (q_sign & mask)
+    q = _mm256_srai_epi16(q, shift);                          // q >>= shift
+    q = _mm256_sub_epi16(_mm256_xor_si256(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+////////// SINT32
+
+__m256i libdivide_s32_do_vec256(__m256i numers, const struct libdivide_s32_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+        uint32_t mask = ((uint32_t)1 << shift) - 1;
+        __m256i roundToZeroTweak = _mm256_set1_epi32(mask);
+        // q = numer + ((numer >> 31) & roundToZeroTweak);
+        __m256i q = _mm256_add_epi32(
+            numers, _mm256_and_si256(_mm256_srai_epi32(numers, 31), roundToZeroTweak));
+        q = _mm256_srai_epi32(q, shift);
+        __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = _mm256_sub_epi32(_mm256_xor_si256(q, sign), sign);
+        return q;
+    } else {
+        __m256i q = libdivide_mullhi_s32_vec256(numers, _mm256_set1_epi32(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = _mm256_add_epi32(q, _mm256_sub_epi32(_mm256_xor_si256(numers, sign), sign));
+        }
+        // q >>= shift
+        q = _mm256_srai_epi32(q, more & LIBDIVIDE_32_SHIFT_MASK);
+        q = _mm256_add_epi32(q, _mm256_srli_epi32(q, 31));  // q += (q < 0)
+        return q;
+    }
+}
+
+__m256i libdivide_s32_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_s32_branchfree_t *denom) {
+    int32_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+    // must be arithmetic shift
+    __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
+    __m256i q = libdivide_mullhi_s32_vec256(numers, _mm256_set1_epi32(magic));
+    q = _mm256_add_epi32(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint32_t is_power_of_2 = (magic == 0);
+    __m256i q_sign = _mm256_srai_epi32(q, 31);  // q_sign = q >> 31
+    __m256i mask = _mm256_set1_epi32(((uint32_t)1 << shift) - is_power_of_2);
+    q = _mm256_add_epi32(q, _mm256_and_si256(q_sign, mask));  // q = q + (q_sign & mask)
+    q = _mm256_srai_epi32(q, shift);                          // q >>= shift
+    q = _mm256_sub_epi32(_mm256_xor_si256(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+////////// SINT64
+
+__m256i libdivide_s64_do_vec256(__m256i numers, const struct libdivide_s64_t *denom) {
+    uint8_t more = denom->more;
+    int64_t magic = denom->magic;
+    if (magic == 0) {  // shift path
+        uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+        uint64_t mask = ((uint64_t)1 << shift) - 1;
+        __m256i roundToZeroTweak = _mm256_set1_epi64x(mask);
+        // q = numer + ((numer >> 63) & roundToZeroTweak);
+        __m256i q = _mm256_add_epi64(
+            numers, _mm256_and_si256(libdivide_s64_signbits_vec256(numers), roundToZeroTweak));
+        q = libdivide_s64_shift_right_vec256(q, shift);
+        __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = _mm256_sub_epi64(_mm256_xor_si256(q, sign), sign);
+        return q;
+    } else {
+        __m256i q = libdivide_mullhi_s64_vec256(numers, _mm256_set1_epi64x(magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = _mm256_add_epi64(q, _mm256_sub_epi64(_mm256_xor_si256(numers, sign), sign));
+        }
+        // q >>= denom->mult_path.shift
+        q = libdivide_s64_shift_right_vec256(q, more & LIBDIVIDE_64_SHIFT_MASK);
+        q = _mm256_add_epi64(q, _mm256_srli_epi64(q, 63));  // q += (q < 0)
+        return q;
+    }
+}
+
+__m256i libdivide_s64_branchfree_do_vec256(
+    __m256i numers, const struct libdivide_s64_branchfree_t *denom) {
+    int64_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+    // must be arithmetic shift
+    __m256i sign = _mm256_set1_epi32((int8_t)more >> 7);
+
+    // libdivide_mullhi_s64(numers, magic);
+    __m256i q = libdivide_mullhi_s64_vec256(numers, _mm256_set1_epi64x(magic));
+    q = _mm256_add_epi64(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do.
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2.
+    uint32_t is_power_of_2 = (magic == 0);
+    __m256i q_sign = libdivide_s64_signbits_vec256(q);  // q_sign = q >> 63
+    __m256i mask = _mm256_set1_epi64x(((uint64_t)1 << shift) - is_power_of_2);
+    q = _mm256_add_epi64(q, _mm256_and_si256(q_sign, mask));  // q = q + (q_sign & mask)
+    q = libdivide_s64_shift_right_vec256(q, shift);           // q >>= shift
+    q = _mm256_sub_epi64(_mm256_xor_si256(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+////////// REMAINDER
+
+// Low 64 bits of the products: x0*y0 + ((x0*y1 + x1*y0) << 32)
+static LIBDIVIDE_INLINE __m256i libdivide_mullo_u64_vec256(__m256i x, __m256i y) {
+    __m256i x0y0 = _mm256_mul_epu32(x, y);
+    __m256i x0y1 = _mm256_mul_epu32(x, _mm256_srli_epi64(y, 32));
+    __m256i x1y0 = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), y);
+    __m256i cross = _mm256_slli_epi64(_mm256_add_epi64(x0y1, x1y0), 32);
+    return _mm256_add_epi64(x0y0, cross);
+}
+
+// Low 8 bits of the products, computed separately for the even and the odd
+// bytes with 16-bit multiplications.
+static LIBDIVIDE_INLINE __m256i libdivide_mullo_u8_vec256(__m256i a, __m256i b) {
+    __m256i even = _mm256_and_si256(_mm256_mullo_epi16(a, b), _mm256_set1_epi16(0xFF));
+    __m256i odd = _mm256_mullo_epi16(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8));
+    return _mm256_or_si256(even, _mm256_slli_epi16(odd, 8));
+}
+
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u8, uint8_t, __m256i, vec256, _mm256_set1_epi8, libdivide_mullo_u8_vec256, _mm256_sub_epi8)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s8, int8_t, __m256i, vec256, _mm256_set1_epi8, libdivide_mullo_u8_vec256, _mm256_sub_epi8)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u16, uint16_t, __m256i, vec256, _mm256_set1_epi16, _mm256_mullo_epi16, _mm256_sub_epi16)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s16, int16_t, __m256i, vec256, _mm256_set1_epi16, _mm256_mullo_epi16, _mm256_sub_epi16)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u32, uint32_t, __m256i, vec256, _mm256_set1_epi32, _mm256_mullo_epi32, _mm256_sub_epi32)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s32, int32_t, __m256i, vec256, _mm256_set1_epi32, _mm256_mullo_epi32, _mm256_sub_epi32)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u64, uint64_t, __m256i, vec256,
+    _mm256_set1_epi64x, libdivide_mullo_u64_vec256, _mm256_sub_epi64)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s64, int64_t, __m256i, vec256, _mm256_set1_epi64x, libdivide_mullo_u64_vec256, _mm256_sub_epi64)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u8_branchfree, uint8_t, __m256i, vec256,
+    _mm256_set1_epi8, libdivide_mullo_u8_vec256, _mm256_sub_epi8)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s8_branchfree, int8_t, __m256i, vec256,
+    _mm256_set1_epi8, libdivide_mullo_u8_vec256, _mm256_sub_epi8)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u16_branchfree, uint16_t, __m256i, vec256,
+    _mm256_set1_epi16, _mm256_mullo_epi16, _mm256_sub_epi16)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s16_branchfree, int16_t, __m256i, vec256,
+    _mm256_set1_epi16, _mm256_mullo_epi16, _mm256_sub_epi16)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u32_branchfree, uint32_t, __m256i, vec256,
+    _mm256_set1_epi32, _mm256_mullo_epi32, _mm256_sub_epi32)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s32_branchfree, int32_t, __m256i, vec256,
+    _mm256_set1_epi32, _mm256_mullo_epi32, _mm256_sub_epi32)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u64_branchfree, uint64_t, __m256i, vec256,
+    _mm256_set1_epi64x, libdivide_mullo_u64_vec256, _mm256_sub_epi64)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s64_branchfree, int64_t, __m256i, vec256,
+    _mm256_set1_epi64x, libdivide_mullo_u64_vec256, _mm256_sub_epi64)
+
+////////// FASTMOD
+
+// The 64-bit products are computed in the 64-bit lanes, for the even
+// (low 32 bits) numerators and then for the odd ones.
+
+// Low 64 bits of magic * numer for the numerators in the low 32 bits of
+// each 64-bit lane.
+static LIBDIVIDE_INLINE __m256i libdivide_u32_fastmod_lowbits_vec256(
+    __m256i numers, __m256i magic_lo, __m256i magic_hi) {
+    __m256i hi = _mm256_slli_epi64(_mm256_mul_epu32(numers, magic_hi), 32);
+    return _mm256_add_epi64(_mm256_mul_epu32(numers, magic_lo), hi);
+}
+
+// Same as above with the numerators sign extended to 64 bits, i.e.
+// magic << 32 is subtracted for negative numerators.
+static LIBDIVIDE_INLINE __m256i libdivide_s32_fastmod_lowbits_vec256(
+    __m256i numers, __m256i magic_lo, __m256i magic_hi) {
+    __m256i fix = _mm256_and_si256(_mm256_srai_epi32(numers, 31), magic_lo);
+    __m256i hi = _mm256_sub_epi32(_mm256_mul_epu32(numers, magic_hi), fix);
+    hi = _mm256_slli_epi64(hi, 32);
+    return _mm256_add_epi64(_mm256_mul_epu32(numers, magic_lo), hi);
+}
+
+// (lowbits * d) >> 64, returned in the high 32 bits of each 64-bit lane
+static LIBDIVIDE_INLINE __m256i libdivide_fastmod_highbits_vec256(__m256i lowbits, __m256i d) {
+    __m256i lo = _mm256_srli_epi64(_mm256_mul_epu32(lowbits, d), 32);
+    return _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(lowbits, 32), d), lo);
+}
+
+// Moves the results in the high 32 bits of the even and odd lanes back
+// into their 32-bit lanes.
+static LIBDIVIDE_INLINE __m256i libdivide_fastmod_merge_vec256(__m256i even, __m256i odd) {
+    return _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_u32_fastmod_mod_vec256(
+    __m256i numers, const struct libdivide_u32_fastmod_t *denom) {
+    __m256i magic_lo = _mm256_set1_epi32((int32_t)denom->magic);
+    __m256i magic_hi = _mm256_set1_epi32((int32_t)(denom->magic >> 32));
+    __m256i d = _mm256_set1_epi32((int32_t)denom->d);
+    __m256i even = libdivide_u32_fastmod_lowbits_vec256(numers, magic_lo, magic_hi);
+    __m256i odd =
+        libdivide_u32_fastmod_lowbits_vec256(_mm256_srli_epi64(numers, 32), magic_lo, magic_hi);
+    even = libdivide_fastmod_highbits_vec256(even, d);
+    odd = libdivide_fastmod_highbits_vec256(odd, d);
+    return libdivide_fastmod_merge_vec256(even, odd);
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_s32_fastmod_mod_vec256(
+    __m256i numers, const struct libdivide_s32_fastmod_t *denom) {
+    __m256i magic_lo = _mm256_set1_epi32((int32_t)denom->magic);
+    __m256i magic_hi = _mm256_set1_epi32((int32_t)(denom->magic >> 32));
+    __m256i d = _mm256_set1_epi32((int32_t)denom->d);
+    __m256i even = libdivide_s32_fastmod_lowbits_vec256(numers, magic_lo, magic_hi);
+    __m256i odd =
+        libdivide_s32_fastmod_lowbits_vec256(_mm256_srli_epi64(numers, 32), magic_lo, magic_hi);
+    even = libdivide_fastmod_highbits_vec256(even, d);
+    odd = libdivide_fastmod_highbits_vec256(odd, d);
+    __m256i rems = libdivide_fastmod_merge_vec256(even, odd);
+    // rems -= (d - 1) & (numers >> 31)
+    __m256i fix =
+        _mm256_and_si256(_mm256_set1_epi32((int32_t)(denom->d - 1)), _mm256_srai_epi32(numers, 31));
+    return _mm256_sub_epi32(rems, fix);
+}
+
+// Returns a mask with all bits set in the lanes of the multiples of d,
+// i.e. where the low 64 bits of numer * magic are <= magic - 1.
+static LIBDIVIDE_INLINE __m256i libdivide_u32_fastmod_is_divisible_vec256(
+    __m256i numers, const struct libdivide_u32_fastmod_t *denom) {
+    __m256i magic_lo = _mm256_set1_epi32((int32_t)denom->magic);
+    __m256i magic_hi = _mm256_set1_epi32((int32_t)(denom->magic >> 32));
+    // Unsigned comparison using the signed one, by flipping the sign bits
+    __m256i sign_bit = _mm256_set1_epi64x(INT64_MIN);
+    __m256i limit = _mm256_set1_epi64x((int64_t)((denom->magic - 1) ^ (UINT64_C(1) << 63)));
+    __m256i even = libdivide_u32_fastmod_lowbits_vec256(numers, magic_lo, magic_hi);
+    __m256i odd =
+        libdivide_u32_fastmod_lowbits_vec256(_mm256_srli_epi64(numers, 32), magic_lo, magic_hi);
+    even = _mm256_cmpgt_epi64(_mm256_xor_si256(even, sign_bit), limit);
+    odd = _mm256_cmpgt_epi64(_mm256_xor_si256(odd, sign_bit), limit);
+    __m256i not_divisible = _mm256_blend_epi32(even, odd, 0xAA);
+    return _mm256_xor_si256(not_divisible, _mm256_set1_epi32(-1));
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_s32_fastmod_is_divisible_vec256(
+    __m256i numers, const struct libdivide_s32_fastmod_t *denom) {
+    // The unsigned test works with the magic number of the absolute value.
+    const struct libdivide_u32_fastmod_t abs_denom = {denom->magic, denom->d};
+    __m256i abs_numers = _mm256_abs_epi32(numers);
+    return libdivide_u32_fastmod_is_divisible_vec256(abs_numers, &abs_denom);
+}
+
+////////// EXACT DIVISION
+
+// Unlike division, exact division needs no high half of the 64-bit
+// products, which would cost four _mm256_mul_epu32.
+LIBDIVIDE_EXACT_VEC_GEN(
+    u16, uint16_t, __m256i, vec256, _mm256_srli_epi16, _mm256_set1_epi16, _mm256_mullo_epi16)
+LIBDIVIDE_EXACT_VEC_GEN(
+    s16, int16_t, __m256i, vec256, _mm256_srai_epi16, _mm256_set1_epi16, _mm256_mullo_epi16)
+LIBDIVIDE_EXACT_VEC_GEN(
+    u32, uint32_t, __m256i, vec256, _mm256_srli_epi32, _mm256_set1_epi32, _mm256_mullo_epi32)
+LIBDIVIDE_EXACT_VEC_GEN(
+    s32, int32_t, __m256i, vec256, _mm256_srai_epi32, _mm256_set1_epi32, _mm256_mullo_epi32)
+LIBDIVIDE_EXACT_VEC_GEN(u64, uint64_t, __m256i, vec256, _mm256_srli_epi64, _mm256_set1_epi64x,
+    libdivide_mullo_u64_vec256)
+LIBDIVIDE_EXACT_VEC_GEN(s64, int64_t, __m256i, vec256, libdivide_s64_shift_right_vec256,
+    _mm256_set1_epi64x, libdivide_mullo_u64_vec256)
+
+////////// ROUNDING
+
+LIBDIVIDE_ROUND_VEC_GEN(16, __m256i, vec256, _mm256_set1_epi16, _mm256_add_epi16,
+    _mm256_sub_epi16, _mm256_xor_si256, _mm256_or_si256, _mm256_and_si256, _mm256_srli_epi16,
+    _mm256_srai_epi16, _mm256_mulhi_epu16)
+LIBDIVIDE_ROUND_VEC_GEN(32, __m256i, vec256, _mm256_set1_epi32, _mm256_add_epi32,
+    _mm256_sub_epi32, _mm256_xor_si256, _mm256_or_si256, _mm256_and_si256, _mm256_srli_epi32,
+    _mm256_srai_epi32, libdivide_mullhi_u32_vec256)
+LIBDIVIDE_ROUND_VEC_GEN(64, __m256i, vec256, _mm256_set1_epi64x, _mm256_add_epi64,
+    _mm256_sub_epi64, _mm256_xor_si256, _mm256_or_si256, _mm256_and_si256, _mm256_srli_epi64,
+    libdivide_s64_shift_right_vec256, libdivide_mullhi_u64_vec256)
+
+////////// FLOATING POINT RECIPROCAL
+
+LIBDIVIDE_FP16_VEC_GEN(__m256i, __m256, vec256, _mm256_set1_epi32, _mm256_set1_ps,
+    _mm256_and_si256, _mm256_or_si256, _mm256_slli_epi32, _mm256_srli_epi32, _mm256_srai_epi32,
+    _mm256_cvtepi32_ps, _mm256_cvttps_epi32, _mm256_mul_ps)
+
+// Unsigned lanes are biased by -2^31 to convert them as signed integers.
+// Only d == 1, the only divisor with recip >= 1, has quotients that do
+// not fit into int32_t.
+static LIBDIVIDE_INLINE __m256i libdivide_u32_fp_do_vec256(
+    __m256i numers, const struct libdivide_u32_fp_t *denom) {
+    if (denom->recip >= 1.0) {
+        return numers;
+    }
+    __m256d recip = _mm256_set1_pd(denom->recip);
+    __m256d bias = _mm256_set1_pd(2147483648.0);
+    __m256i x = _mm256_xor_si256(numers, _mm256_set1_epi32(INT32_MIN));
+    __m128i lo = _mm256_cvttpd_epi32(_mm256_mul_pd(
+        _mm256_add_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(x)), bias), recip));
+    __m128i hi = _mm256_cvttpd_epi32(_mm256_mul_pd(
+        _mm256_add_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(x, 1)), bias), recip));
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_s32_fp_do_vec256(
+    __m256i numers, const struct libdivide_s32_fp_t *denom) {
+    __m256d recip = _mm256_set1_pd(denom->recip);
+    __m128i lo = _mm256_cvttpd_epi32(
+        _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(numers)), recip));
+    __m128i hi = _mm256_cvttpd_epi32(
+        _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(numers, 1)), recip));
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+////////// PER-LANE DIVISORS
+
+// See libdivide_u32_branchfree_do_lanes_vec512(). AVX2 has no arithmetic
+// variable shift of 64-bit lanes, the s64 kernel shifts the one's complement
+// of negative lanes instead.
+
+// Like libdivide_mullhi_u32_vec256() but b holds one value per lane.
+static LIBDIVIDE_INLINE __m256i libdivide_mullhi_u32_lanes_vec256(__m256i a, __m256i b) {
+    __m256i hi_product_0Z2Z = _mm256_srli_epi64(_mm256_mul_epu32(a, b), 32);
+    __m256i a1X3X = _mm256_srli_epi64(a, 32);
+    __m256i b1X3X = _mm256_srli_epi64(b, 32);
+    __m256i mask = _mm256_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0);
+    __m256i hi_product_Z1Z3 = _mm256_and_si256(_mm256_mul_epu32(a1X3X, b1X3X), mask);
+    return _mm256_or_si256(hi_product_0Z2Z, hi_product_Z1Z3);
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_mullhi_s32_lanes_vec256(__m256i a, __m256i b) {
+    __m256i hi_product_0Z2Z = _mm256_srli_epi64(_mm256_mul_epi32(a, b), 32);
+    __m256i a1X3X = _mm256_srli_epi64(a, 32);
+    __m256i b1X3X = _mm256_srli_epi64(b, 32);
+    __m256i mask = _mm256_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0);
+    __m256i hi_product_Z1Z3 = _mm256_and_si256(_mm256_mul_epi32(a1X3X, b1X3X), mask);
+    return _mm256_or_si256(hi_product_0Z2Z, hi_product_Z1Z3);
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_u32_branchfree_do_lanes_vec256(
+    __m256i numers, __m256i magics, __m256i mores) {
+    __m256i q = libdivide_mullhi_u32_lanes_vec256(numers, magics);
+    __m256i t = _mm256_add_epi32(_mm256_srli_epi32(_mm256_sub_epi32(numers, q), 1), q);
+    return _mm256_srlv_epi32(t, mores);
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_u64_branchfree_do_lanes_vec256(
+    __m256i numers, __m256i magics, __m256i mores) {
+    __m256i q = libdivide_mullhi_u64_vec256(numers, magics);
+    __m256i t = _mm256_add_epi64(_mm256_srli_epi64(_mm256_sub_epi64(numers, q), 1), q);
+    return _mm256_srlv_epi64(t, mores);
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_s32_branchfree_do_lanes_vec256(
+    __m256i numers, __m256i magics, __m256i mores) {
+    __m256i shifts = _mm256_and_si256(mores, _mm256_set1_epi32(LIBDIVIDE_32_SHIFT_MASK));
+    // must be arithmetic shift
+    __m256i sign = _mm256_srai_epi32(_mm256_slli_epi32(mores, 24), 31);
+    __m256i q = libdivide_mullhi_s32_lanes_vec256(numers, magics);
+    q = _mm256_add_epi32(q, numers);  // q += numers
+
+    // mask = (1 << shift) - is_power_of_2, the comparison yields -1 if magic == 0
+    __m256i mask = _mm256_add_epi32(_mm256_sllv_epi32(_mm256_set1_epi32(1), shifts),
+        _mm256_cmpeq_epi32(magics, _mm256_setzero_si256()));
+    __m256i q_sign = _mm256_srai_epi32(q, 31);                // q_sign = q >> 31
+    q = _mm256_add_epi32(q, _mm256_and_si256(q_sign, mask));  // q = q + (q_sign & mask)
+    q = _mm256_srav_epi32(q, shifts);                         // q >>= shift
+    q = _mm256_sub_epi32(_mm256_xor_si256(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_s64_branchfree_do_lanes_vec256(
+    __m256i numers, __m256i magics, __m256i mores) {
+    __m256i shifts = _mm256_and_si256(mores, _mm256_set1_epi64x(LIBDIVIDE_64_SHIFT_MASK));
+    // must be arithmetic shift
+    __m256i sign = libdivide_s64_signbits_vec256(_mm256_slli_epi64(mores, 56));
+    __m256i q = libdivide_mullhi_s64_vec256(numers, magics);
+    q = _mm256_add_epi64(q, numers);  // q += numers
+
+    // mask = (1 << shift) - is_power_of_2, the comparison yields -1 if magic == 0
+    __m256i mask = _mm256_add_epi64(_mm256_sllv_epi64(_mm256_set1_epi64x(1), shifts),
+        _mm256_cmpeq_epi64(magics, _mm256_setzero_si256()));
+    __m256i q_sign = libdivide_s64_signbits_vec256(q);        // q_sign = q >> 63
+    q = _mm256_add_epi64(q, _mm256_and_si256(q_sign, mask));  // q = q + (q_sign & mask)
+    // q >>= shift, computed as ~(~q >> shift) if q is negative
+    q_sign = libdivide_s64_signbits_vec256(q);
+    q = _mm256_xor_si256(_mm256_srlv_epi64(_mm256_xor_si256(q, q_sign), shifts), q_sign);
+    q = _mm256_sub_epi64(_mm256_xor_si256(q, sign), sign);  // q = (q ^ sign) - sign
+    return q;
+}
+
+// See libdivide_u32_branchfree_do_table_vec512().
+#define LIBDIVIDE_TABLE_VEC256_GEN(ALGO, MagicT, IdxT, GatherT, GATHER, SET1)               \
+    static LIBDIVIDE_INLINE __m256i libdivide_##ALGO##_do_table_vec256(                     \
+        __m256i numers, IdxT indices, const MagicT *magics, const uint8_t *mores) {         \
+        __m256i m = GATHER((const GatherT *)(const void *)magics, indices, sizeof(MagicT)); \
+        __m256i more = _mm256_and_si256(                                                    \
+            GATHER((const GatherT *)(const void *)mores, indices, 1), SET1(0xFF));          \
+        return libdivide_##ALGO##_do_lanes_vec256(numers, m, more);                         \
+    }
+
+LIBDIVIDE_TABLE_VEC256_GEN(
+    u32_branchfree, uint32_t, __m256i, int, _mm256_i32gather_epi32, _mm256_set1_epi32)
+LIBDIVIDE_TABLE_VEC256_GEN(
+    s32_branchfree, int32_t, __m256i, int, _mm256_i32gather_epi32, _mm256_set1_epi32)
+LIBDIVIDE_TABLE_VEC256_GEN(
+    u64_branchfree, uint64_t, __m128i, long long, _mm256_i32gather_epi64, _mm256_set1_epi64x)
+LIBDIVIDE_TABLE_VEC256_GEN(
+    s64_branchfree, int64_t, __m128i, long long, _mm256_i32gather_epi64, _mm256_set1_epi64x)
+
+////////// MODULAR MULTIPLICATION
+
+// AVX2 has no unsigned comparisons, the operands are offset by the sign bit.
+static LIBDIVIDE_INLINE __m256i libdivide_u32_sub_fix_vec256(__m256i a, __m256i b, __m256i m) {
+    __m256i sign = _mm256_set1_epi32(INT32_MIN);
+    __m256i borrow = _mm256_cmpgt_epi32(_mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign));
+    return _mm256_add_epi32(_mm256_sub_epi32(a, b), _mm256_and_si256(borrow, m));
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_u64_sub_fix_vec256(__m256i a, __m256i b, __m256i m) {
+    __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    __m256i borrow = _mm256_cmpgt_epi64(_mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign));
+    return _mm256_add_epi64(_mm256_sub_epi64(a, b), _mm256_and_si256(borrow, m));
+}
+
+LIBDIVIDE_MODMUL_VEC_GEN(u32, __m256i, vec256, _mm256_set1_epi32, int32_t, _mm256_sub_epi32,
+    _mm256_mullo_epi32, libdivide_mullhi_u32_lanes_vec256, libdivide_u32_sub_fix_vec256)
+LIBDIVIDE_MODMUL_VEC_GEN(u64, __m256i, vec256, _mm256_set1_epi64x, int64_t, _mm256_sub_epi64,
+    libdivide_mullo_u64_vec256, libdivide_mullhi_u64_vec256, libdivide_u64_sub_fix_vec256)
+
+////////// RATIONAL SCALING
+
+LIBDIVIDE_SCALER_VEC_GEN(__m256i, vec256, _mm256_set1_epi64x, _mm256_add_epi64, _mm256_sub_epi64,
+    _mm256_and_si256, _mm256_or_si256, _mm256_andnot_si256, _mm256_srli_epi64, _mm256_slli_epi64,
+    _mm256_srl_epi64, _mm256_sll_epi64, _mm256_mul_epu32, libdivide_mullo_u64_vec256,
+    libdivide_mullhi_u64_vec256)
+
+////////// FIXED POINT DIVISION
+
+LIBDIVIDE_FIXED16_VEC_GEN(__m256i, vec256, _mm256_set1_epi16, _mm256_add_epi16, _mm256_and_si256,
+    _mm256_or_si256, _mm256_andnot_si256, _mm256_srli_epi16, _mm256_mullo_epi16,
+    _mm256_mulhi_epu16)
+LIBDIVIDE_FIXED_VEC_GEN(__m256i, vec256, _mm256_set1_epi64x, _mm256_add_epi64, _mm256_and_si256,
+    _mm256_or_si256, _mm256_srli_epi64, _mm256_slli_epi64, _mm256_mul_epu32,
+    libdivide_mullo_u64_vec256, libdivide_mullhi_u64_vec256)
+
+////////// DIVIDER GENERATION
+
+// See libdivide_internal_u32_gen_vec512(), generates 4 dividers in the
+// 64-bit lanes. AVX2 has no unsigned conversions and no truncation to
+// 64-bit integers: the divisors are offset by the sign bit, and adding
+// 2^52 to the rounded down quotient leaves it in the low mantissa bits.
+static LIBDIVIDE_INLINE __m256i libdivide_internal_u32_gen4_vec256(
+    __m128i divisors, int branchfree, __m256i *more) {
+    __m256i one = _mm256_set1_epi64x(1);
+    __m256i d = _mm256_cvtepu32_epi64(divisors);
+    __m256d d_pd =
+        _mm256_add_pd(_mm256_cvtepi32_pd(_mm_xor_si128(divisors, _mm_set1_epi32(INT32_MIN))),
+            _mm256_set1_pd(2147483648.0));
+    __m256i exponent =
+        _mm256_and_si256(_mm256_castpd_si256(d_pd), _mm256_set1_epi64x(0x7FF0000000000000));
+    __m256i floor_log_2_d =
+        _mm256_sub_epi64(_mm256_srli_epi64(exponent, 52), _mm256_set1_epi64x(1023));
+    __m256d power =
+        _mm256_castsi256_pd(_mm256_add_epi64(exponent, _mm256_set1_epi64x((int64_t)32 << 52)));
+
+    __m256d bias = _mm256_set1_pd(4503599627370496.0);
+    __m256d q_pd = _mm256_add_pd(_mm256_floor_pd(_mm256_div_pd(power, d_pd)), bias);
+    __m256i proposed_m =
+        _mm256_sub_epi64(_mm256_castpd_si256(q_pd), _mm256_castpd_si256(bias));
+    __m256i rem = _mm256_sub_epi64(
+        _mm256_sllv_epi64(one, _mm256_add_epi64(floor_log_2_d, _mm256_set1_epi64x(32))),
+        _mm256_mul_epu32(proposed_m, d));
+    __m256i fix = _mm256_cmpgt_epi64(_mm256_setzero_si256(), rem);
+    proposed_m = _mm256_add_epi64(proposed_m, fix);
+    rem = _mm256_add_epi64(rem, _mm256_and_si256(fix, d));
+    __m256i d_minus_1 = _mm256_sub_epi64(d, one);
+    fix = _mm256_cmpgt_epi64(rem, d_minus_1);
+    proposed_m = _mm256_sub_epi64(proposed_m, fix);
+    rem = _mm256_sub_epi64(rem, _mm256_and_si256(fix, d));
+
+    __m256i m = _mm256_add_epi64(_mm256_add_epi64(proposed_m, proposed_m), one);
+    m = _mm256_sub_epi64(m, _mm256_cmpgt_epi64(_mm256_add_epi64(rem, rem), d_minus_1));
+    __m256i mo = floor_log_2_d;
+    if (!branchfree) {
+        __m256i works = _mm256_cmpgt_epi64(
+            _mm256_sllv_epi64(one, floor_log_2_d), _mm256_sub_epi64(d, rem));
+        m = _mm256_blendv_epi8(m, _mm256_add_epi64(proposed_m, one), works);
+        mo = _mm256_or_si256(
+            mo, _mm256_andnot_si256(works, _mm256_set1_epi64x(LIBDIVIDE_ADD_MARKER)));
+    }
+
+    // Power of 2
+    __m256i pow2 = _mm256_cmpeq_epi64(_mm256_and_si256(d, d_minus_1), _mm256_setzero_si256());
+    *more = _mm256_blendv_epi8(
+        mo, _mm256_sub_epi64(floor_log_2_d, _mm256_set1_epi64x(branchfree != 0)), pow2);
+    return _mm256_andnot_si256(pow2, m);
+}
+
+// Generates the dividers of 8 divisors, see
+// libdivide_internal_u32_gen_vec512().
+static LIBDIVIDE_INLINE __m256i libdivide_internal_u32_gen_vec256(
+    __m256i divisors, int branchfree, __m128i *mores) {
+    __m256i more_lo, more_hi;
+    __m256i magic_lo =
+        libdivide_internal_u32_gen4_vec256(_mm256_castsi256_si128(divisors), branchfree, &more_lo);
+    __m256i magic_hi = libdivide_internal_u32_gen4_vec256(
+        _mm256_extracti128_si256(divisors, 1), branchfree, &more_hi);
+
+    // Keep the low 32 bits of the 64-bit lanes, then the low bytes of
+    // the more fields
+    __m256i even = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    __m256i magics = _mm256_permute2x128_si256(_mm256_permutevar8x32_epi32(magic_lo, even),
+        _mm256_permutevar8x32_epi32(magic_hi, even), 0x20);
+    __m256i more = _mm256_permute2x128_si256(_mm256_permutevar8x32_epi32(more_lo, even),
+        _mm256_permutevar8x32_epi32(more_hi, even), 0x20);
+    __m256i low_bytes = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, 0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    more = _mm256_shuffle_epi8(more, low_bytes);
+    *mores = _mm_unpacklo_epi32(_mm256_castsi256_si128(more), _mm256_extracti128_si256(more, 1));
+    return magics;
+}
+
+LIBDIVIDE_AVX2_TARGET_POP
+
+#endif
+
+#if defined(LIBDIVIDE_SSE2_KERNELS)
+
+LIBDIVIDE_SSE2_TARGET_PUSH
+
+static LIBDIVIDE_INLINE __m128i libdivide_u8_do_vec128(
+    __m128i numers, const struct libdivide_u8_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_s8_do_vec128(
+    __m128i numers, const struct libdivide_s8_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_u16_do_vec128(
+    __m128i numers, const struct libdivide_u16_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_s16_do_vec128(
+    __m128i numers, const struct libdivide_s16_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_u32_do_vec128(
+    __m128i numers, const struct libdivide_u32_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_s32_do_vec128(
+    __m128i numers, const struct libdivide_s32_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_u64_do_vec128(
+    __m128i numers, const struct libdivide_u64_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_s64_do_vec128(
+    __m128i numers, const struct libdivide_s64_t *denom);
+
+static LIBDIVIDE_INLINE __m128i libdivide_u8_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_u8_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_s8_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_s8_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_u16_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_u16_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_s16_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_s16_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_u32_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_u32_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_s32_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_s32_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_u64_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_u64_branchfree_t *denom);
+static LIBDIVIDE_INLINE __m128i libdivide_s64_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_s64_branchfree_t *denom);
+
+//////// Internal Utility Functions
+
+// Implementation of _mm_srai_epi64(v, 63) (from AVX512).
+static LIBDIVIDE_INLINE __m128i libdivide_s64_signbits_vec128(__m128i v) {
+    __m128i hiBitsDuped = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 1, 1));
+    __m128i signBits = _mm_srai_epi32(hiBitsDuped, 31);
+    return signBits;
+}
+
+// Implementation of _mm_srai_epi64 (from AVX512).
+static LIBDIVIDE_INLINE __m128i libdivide_s64_shift_right_vec128(__m128i v, int amt) {
+    const int b = 64 - amt;
+    __m128i m = _mm_set1_epi64x((uint64_t)1 << (b - 1));
+    __m128i x = _mm_srli_epi64(v, amt);
+    __m128i result = _mm_sub_epi64(_mm_xor_si128(x, m), m);
+    return result;
+}
+
+// Here, b is assumed to contain one 32-bit value repeated.
+static LIBDIVIDE_INLINE __m128i libdivide_mullhi_u32_vec128(__m128i a, __m128i b) {
+    __m128i hi_product_0Z2Z = _mm_srli_epi64(_mm_mul_epu32(a, b), 32);
+    __m128i a1X3X = _mm_srli_epi64(a, 32);
+    __m128i mask = _mm_set_epi32(-1, 0, -1, 0);
+    __m128i hi_product_Z1Z3 = _mm_and_si128(_mm_mul_epu32(a1X3X, b), mask);
+    return _mm_or_si128(hi_product_0Z2Z, hi_product_Z1Z3);
+}
+
+// The high halves of a * m + m, i.e. of the "round down" product
+// (a + 1) * m without a saturating increment. b is the 32-bit m zero
+// extended to 64 bits and repeated twice.
+static LIBDIVIDE_INLINE __m128i libdivide_mullhi_add_u32_vec128(__m128i a, __m128i b) {
+    __m128i hi_product_0Z2Z = _mm_srli_epi64(_mm_add_epi64(_mm_mul_epu32(a, b), b), 32);
+    __m128i a1X3X = _mm_srli_epi64(a, 32);
+    __m128i mask = _mm_set_epi32(-1, 0, -1, 0);
+    __m128i hi_product_Z1Z3 = _mm_and_si128(_mm_add_epi64(_mm_mul_epu32(a1X3X, b), b), mask);
+    return _mm_or_si128(hi_product_0Z2Z, hi_product_Z1Z3);
+}
+
+// SSE2 does not have a signed multiplication instruction, but we can convert
+// unsigned to signed pretty efficiently. Again, b is just a 32 bit value
+// repeated four times.
+static LIBDIVIDE_INLINE __m128i libdivide_mullhi_s32_vec128(__m128i a, __m128i b) {
+    __m128i p = libdivide_mullhi_u32_vec128(a, b);
+    // t1 = (a >> 31) & y, arithmetic shift
+    __m128i t1 = _mm_and_si128(_mm_srai_epi32(a, 31), b);
+    __m128i t2 = _mm_and_si128(_mm_srai_epi32(b, 31), a);
+    p = _mm_sub_epi32(p, t1);
+    p = _mm_sub_epi32(p, t2);
+    return p;
+}
+
+// Here, y is assumed to contain one 64-bit value repeated.
+static LIBDIVIDE_INLINE __m128i libdivide_mullhi_u64_vec128(__m128i x, __m128i y) {
+    // full 128 bits product is:
+    // x0*y0 + (x0*y1 << 32) + (x1*y0 << 32) + (x1*y1 << 64)
+    // Note x0,y0,x1,y1 are all conceptually uint32, products are 32x32->64.
+
+    // Compute x0*y0.
+    // Note x1, y1 are ignored by mul_epu32.
+    __m128i x0y0 = _mm_mul_epu32(x, y);
+    __m128i x0y0_hi = _mm_srli_epi64(x0y0, 32);
+
+    // Get x1, y1 in the low bits.
+    // We could shuffle or right shift. Shuffles are preferred as they preserve
+    // the source register for the next computation.
+    __m128i x1 = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 1, 1));
+    __m128i y1 = _mm_shuffle_epi32(y, _MM_SHUFFLE(3, 3, 1, 1));
+
+    // No need to mask off top 32 bits for mul_epu32.
+    __m128i x0y1 = _mm_mul_epu32(x, y1);
+    __m128i x1y0 = _mm_mul_epu32(x1, y);
+    __m128i x1y1 = _mm_mul_epu32(x1, y1);
+
+    // Mask here selects low bits only.
+    __m128i mask = _mm_set1_epi64x(0xFFFFFFFF);
+    __m128i temp = _mm_add_epi64(x1y0, x0y0_hi);
+    __m128i temp_lo = _mm_and_si128(temp, mask);
+    __m128i temp_hi = _mm_srli_epi64(temp, 32);
+
+    temp_lo = _mm_srli_epi64(_mm_add_epi64(temp_lo, x0y1), 32);
+    temp_hi = _mm_add_epi64(x1y1, temp_hi);
+    return _mm_add_epi64(temp_lo, temp_hi);
+}
+
+// The high halves of x * y + y, y is one 64-bit value repeated. The halves
+// of y are added to x0*y0 and x0*y1, which cannot overflow.
+static LIBDIVIDE_INLINE __m128i libdivide_mullhi_add_u64_vec128(__m128i x, __m128i y) {
+    __m128i mask = _mm_set1_epi64x(0xFFFFFFFF);
+    __m128i x1 = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 1, 1));
+    __m128i y1 = _mm_srli_epi64(y, 32);
+
+    __m128i x0y0 = _mm_add_epi64(_mm_mul_epu32(x, y), _mm_and_si128(y, mask));
+    __m128i x0y0_hi = _mm_srli_epi64(x0y0, 32);
+    __m128i x0y1 = _mm_add_epi64(_mm_mul_epu32(x, y1), y1);
+    __m128i x1y0 = _mm_mul_epu32(x1, y);
+    __m128i x1y1 = _mm_mul_epu32(x1, y1);
+
+    __m128i temp = _mm_add_epi64(x1y0, x0y0_hi);
+    __m128i temp_lo = _mm_and_si128(temp, mask);
+    __m128i temp_hi = _mm_srli_epi64(temp, 32);
+
+    temp_lo = _mm_srli_epi64(_mm_add_epi64(temp_lo, x0y1), 32);
+    temp_hi = _mm_add_epi64(x1y1, temp_hi);
+    return _mm_add_epi64(temp_lo, temp_hi);
+}
+
+// y is one 64-bit value repeated.
+static LIBDIVIDE_INLINE __m128i libdivide_mullhi_s64_vec128(__m128i x, __m128i y) {
+    __m128i p = libdivide_mullhi_u64_vec128(x, y);
+    __m128i t1 = _mm_and_si128(libdivide_s64_signbits_vec128(x), y);
+    __m128i t2 = _mm_and_si128(libdivide_s64_signbits_vec128(y), x);
+    p = _mm_sub_epi64(p, t1);
+    p = _mm_sub_epi64(p, t2);
+    return p;
+}
+
+// 8-bit lanes: x86 has no 8-bit multiplications or shifts. The numerators
+// are unpacked into the high bytes of 16-bit lanes, so that the high half
+// of the 16-bit products with the magic number (y, one 16-bit value
+// repeated) is the high byte of the 8-bit products.
+static LIBDIVIDE_INLINE __m128i libdivide_mullhi_u8_vec128(__m128i x, __m128i y) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_mulhi_epu16(_mm_unpacklo_epi8(zero, x), y);
+    __m128i hi = _mm_mulhi_epu16(_mm_unpackhi_epi8(zero, x), y);
+    return _mm_packus_epi16(lo, hi);
+}
+
+// y is one sign extended 8-bit value repeated in the 16-bit lanes.
+static LIBDIVIDE_INLINE __m128i libdivide_mullhi_s8_vec128(__m128i x, __m128i y) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_mulhi_epi16(_mm_unpacklo_epi8(zero, x), y);
+    __m128i hi = _mm_mulhi_epi16(_mm_unpackhi_epi8(zero, x), y);
+    return _mm_packs_epi16(lo, hi);
+}
+
+// Logical right shift of 8-bit lanes: shift 16-bit lanes and clear the
+// bits shifted in from the neighbouring byte.
+static LIBDIVIDE_INLINE __m128i libdivide_u8_shift_right_vec128(__m128i v, int amt) {
+    return _mm_and_si128(_mm_srli_epi16(v, amt), _mm_set1_epi8((char)(0xFF >> amt)));
+}
+
+// Arithmetic right shift of 8-bit lanes.
+static LIBDIVIDE_INLINE __m128i libdivide_s8_shift_right_vec128(__m128i v, int amt) {
+    __m128i m = _mm_set1_epi8((char)(0x80 >> amt));
+    __m128i x = libdivide_u8_shift_right_vec128(v, amt);
+    return _mm_sub_epi8(_mm_xor_si128(x, m), m);
+}
+
+// All bits set in the negative 8-bit lanes.
+static LIBDIVIDE_INLINE __m128i libdivide_s8_signbits_vec128(__m128i v) {
+    return _mm_cmpgt_epi8(_mm_setzero_si128(), v);
+}
+
+////////// UINT8
+
+__m128i libdivide_u8_do_vec128(__m128i numers, const struct libdivide_u8_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return libdivide_u8_shift_right_vec128(numers, more);
+    } else {
+        __m128i q = libdivide_mullhi_u8_vec128(numers, _mm_set1_epi16(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            __m128i t = _mm_adds_epu8(libdivide_u8_shift_right_vec128(_mm_subs_epu8(numers, q), 1), q);
+            return libdivide_u8_shift_right_vec128(t, (more & LIBDIVIDE_8_SHIFT_MASK));
+        } else {
+            return libdivide_u8_shift_right_vec128(q, more);
+        }
+    }
+}
+
+__m128i libdivide_u8_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_u8_branchfree_t *denom) {
+    __m128i q = libdivide_mullhi_u8_vec128(numers, _mm_set1_epi16(denom->magic));
+    __m128i t = _mm_adds_epu8(libdivide_u8_shift_right_vec128(_mm_subs_epu8(numers, q), 1), q);
+    return libdivide_u8_shift_right_vec128(t, denom->more);
+}
+
+////////// UINT16
+
+__m128i libdivide_u16_do_vec128(__m128i numers, const struct libdivide_u16_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return _mm_srli_epi16(numers, more);
+    } else if (more & LIBDIVIDE_ADD_MARKER) {
+        // Round down: q = (n + 1) * m_down >> 16 with a saturating increment,
+        // see libdivide_u16_round_down_magic()
+        __m128i m_down = _mm_set1_epi16(libdivide_u16_round_down_magic(denom->magic));
+        __m128i q = _mm_mulhi_epu16(_mm_adds_epu16(numers, _mm_set1_epi16(1)), m_down);
+        return _mm_srli_epi16(q, (more & LIBDIVIDE_16_SHIFT_MASK));
+    } else {
+        __m128i q = _mm_mulhi_epu16(numers, _mm_set1_epi16(denom->magic));
+        return _mm_srli_epi16(q, more);
+    }
+}
+
+__m128i libdivide_u16_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_u16_branchfree_t *denom) {
+    __m128i q = _mm_mulhi_epu16(numers, _mm_set1_epi16(denom->magic));
+    __m128i t = _mm_adds_epu16(_mm_srli_epi16(_mm_subs_epu16(numers, q), 1), q);
+    return _mm_srli_epi16(t, denom->more);
+}
+
+////////// UINT32
+
+__m128i libdivide_u32_do_vec128(__m128i numers, const struct libdivide_u32_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return _mm_srli_epi32(numers, more);
+    } else if (more & LIBDIVIDE_ADD_MARKER) {
+        // Round down: q = (n * m_down + m_down) >> 32, see
+        // libdivide_u16_round_down_magic()
+        uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+        __m128i m_down = _mm_set1_epi64x(libdivide_u32_round_down_magic(denom->magic));
+        return _mm_srli_epi32(libdivide_mullhi_add_u32_vec128(numers, m_down), shift);
+    } else {
+        __m128i q = libdivide_mullhi_u32_vec128(numers, _mm_set1_epi32(denom->magic));
+        return _mm_srli_epi32(q, more);
+    }
+}
+
+__m128i libdivide_u32_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_u32_branchfree_t *denom) {
+    __m128i q = libdivide_mullhi_u32_vec128(numers, _mm_set1_epi32(denom->magic));
+    __m128i t = _mm_add_epi32(_mm_srli_epi32(_mm_sub_epi32(numers, q), 1), q);
+    return _mm_srli_epi32(t, denom->more);
+}
+
+////////// UINT64
+
+__m128i libdivide_u64_do_vec128(__m128i numers, const struct libdivide_u64_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        return _mm_srli_epi64(numers, more);
+    } else if (more & LIBDIVIDE_NARROW_MARKER) {
+        // The numerators are < 2^32 and magic is m * 2^32
+        __m128i q = _mm_mul_epu32(numers, _mm_set1_epi64x(denom->magic >> 32));
+        return _mm_srli_epi64(q, 32 + (more & LIBDIVIDE_64_SHIFT_MASK));
+    } else if (more & LIBDIVIDE_ADD_MARKER) {
+        // Round down: q = (n * m_down + m_down) >> 64, see
+        // libdivide_u16_round_down_magic()
+        uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+        __m128i m_down = _mm_set1_epi64x(libdivide_u64_round_down_magic(denom->magic));
+        return _mm_srli_epi64(libdivide_mullhi_add_u64_vec128(numers, m_down), shift);
+    } else {
+        __m128i q = libdivide_mullhi_u64_vec128(numers, _mm_set1_epi64x(denom->magic));
+        return _mm_srli_epi64(q, more);
+    }
+}
+
+__m128i libdivide_u64_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_u64_branchfree_t *denom) {
+    __m128i q = libdivide_mullhi_u64_vec128(numers, _mm_set1_epi64x(denom->magic));
+    __m128i t = _mm_add_epi64(_mm_srli_epi64(_mm_sub_epi64(numers, q), 1), q);
+    return _mm_srli_epi64(t, denom->more);
+}
+
+////////// SINT8
+
+__m128i libdivide_s8_do_vec128(__m128i numers, const struct libdivide_s8_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        uint8_t shift = more & LIBDIVIDE_8_SHIFT_MASK;
+        uint8_t mask = (uint8_t)((1 << shift) - 1);
+        __m128i roundToZeroTweak = _mm_set1_epi8((char)mask);
+        // q = numer + ((numer >> 7) & roundToZeroTweak);
+        __m128i q = _mm_add_epi8(
+            numers, _mm_and_si128(libdivide_s8_signbits_vec128(numers), roundToZeroTweak));
+        q = libdivide_s8_shift_right_vec128(q, shift);
+        __m128i sign = _mm_set1_epi8((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = _mm_sub_epi8(_mm_xor_si128(q, sign), sign);
+        return q;
+    } else {
+        __m128i q = libdivide_mullhi_s8_vec128(numers, _mm_set1_epi16(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            __m128i sign = _mm_set1_epi8((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = _mm_add_epi8(q, _mm_sub_epi8(_mm_xor_si128(numers, sign), sign));
+        }
+        // q >>= shift
+        q = libdivide_s8_shift_right_vec128(q, more & LIBDIVIDE_8_SHIFT_MASK);
+        q = _mm_add_epi8(q, libdivide_u8_shift_right_vec128(q, 7));  // q += (q < 0)
+        return q;
+    }
+}
+
+__m128i libdivide_s8_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_s8_branchfree_t *denom) {
+    int8_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_8_SHIFT_MASK;
+    // must be arithmetic shift
+    __m128i sign = _mm_set1_epi8((int8_t)more >> 7);
+    __m128i q = libdivide_mullhi_s8_vec128(numers, _mm_set1_epi16(magic));
+    q = _mm_add_epi8(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint8_t is_power_of_2 = (magic == 0);
+    __m128i q_sign = libdivide_s8_signbits_vec128(q);  // q_sign = q >> 7
+    __m128i mask = _mm_set1_epi8((char)((1 << shift) - is_power_of_2));
+    q = _mm_add_epi8(q, _mm_and_si128(q_sign, mask));  // q = q + (q_sign & mask)
+    q = libdivide_s8_shift_right_vec128(q, shift);      // q >>= shift
+    q = _mm_sub_epi8(_mm_xor_si128(q, sign), sign);     // q = (q ^ sign) - sign
+    return q;
+}
+
+////////// SINT16
+
+__m128i libdivide_s16_do_vec128(__m128i numers, const struct libdivide_s16_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        uint16_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+        uint16_t mask = ((uint16_t)1 << shift) - 1;
+        __m128i roundToZeroTweak = _mm_set1_epi16(mask);
+        // q = numer + ((numer >> 15) & roundToZeroTweak);
+        __m128i q =
+            _mm_add_epi16(numers, _mm_and_si128(_mm_srai_epi16(numers, 15), roundToZeroTweak));
+        q = _mm_srai_epi16(q, shift);
+        __m128i sign = _mm_set1_epi16((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = _mm_sub_epi16(_mm_xor_si128(q, sign), sign);
+        return q;
+    } else {
+        __m128i q = _mm_mulhi_epi16(numers, _mm_set1_epi16(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            __m128i sign = _mm_set1_epi16((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = _mm_add_epi16(q, _mm_sub_epi16(_mm_xor_si128(numers, sign), sign));
+        }
+        // q >>= shift
+        q = _mm_srai_epi16(q, more & LIBDIVIDE_16_SHIFT_MASK);
+        q = _mm_add_epi16(q, _mm_srli_epi16(q, 15));  // q += (q < 0)
+        return q;
+    }
+}
+
+__m128i libdivide_s16_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_s16_branchfree_t *denom) {
+    int16_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_16_SHIFT_MASK;
+    // must be arithmetic shift
+    __m128i sign = _mm_set1_epi16((int8_t)more >> 7);
+    __m128i q = _mm_mulhi_epi16(numers, _mm_set1_epi16(magic));
+    q = _mm_add_epi16(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint16_t is_power_of_2 = (magic == 0);
+    __m128i q_sign = _mm_srai_epi16(q, 15);  // q_sign = q >> 15
+    __m128i mask = _mm_set1_epi16(((uint16_t)1 << shift) - is_power_of_2);
+    q = _mm_add_epi16(q, _mm_and_si128(q_sign, mask));  // q = q + (q_sign & mask)
+    q = _mm_srai_epi16(q, shift);                       // q >>= shift
+    q = _mm_sub_epi16(_mm_xor_si128(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+////////// SINT32
+
+__m128i libdivide_s32_do_vec128(__m128i numers, const struct libdivide_s32_t *denom) {
+    uint8_t more = denom->more;
+    if (!denom->magic) {
+        uint32_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+        uint32_t mask = ((uint32_t)1 << shift) - 1;
+        __m128i roundToZeroTweak = _mm_set1_epi32(mask);
+        // q = numer + ((numer >> 31) & roundToZeroTweak);
+        __m128i q =
+            _mm_add_epi32(numers, _mm_and_si128(_mm_srai_epi32(numers, 31), roundToZeroTweak));
+        q = _mm_srai_epi32(q, shift);
+        __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = _mm_sub_epi32(_mm_xor_si128(q, sign), sign);
+        return q;
+    } else {
+        __m128i q = libdivide_mullhi_s32_vec128(numers, _mm_set1_epi32(denom->magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = _mm_add_epi32(q, _mm_sub_epi32(_mm_xor_si128(numers, sign), sign));
+        }
+        // q >>= shift
+        q = _mm_srai_epi32(q, more & LIBDIVIDE_32_SHIFT_MASK);
+        q = _mm_add_epi32(q, _mm_srli_epi32(q, 31));  // q += (q < 0)
+        return q;
+    }
+}
+
+__m128i libdivide_s32_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_s32_branchfree_t *denom) {
+    int32_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_32_SHIFT_MASK;
+    // must be arithmetic shift
+    __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
+    __m128i q = libdivide_mullhi_s32_vec128(numers, _mm_set1_epi32(magic));
+    q = _mm_add_epi32(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2
+    uint32_t is_power_of_2 = (magic == 0);
+    __m128i q_sign = _mm_srai_epi32(q, 31);  // q_sign = q >> 31
+    __m128i mask = _mm_set1_epi32(((uint32_t)1 << shift) - is_power_of_2);
+    q = _mm_add_epi32(q, _mm_and_si128(q_sign, mask));  // q = q + (q_sign & mask)
+    q = _mm_srai_epi32(q, shift);                       // q >>= shift
+    q = _mm_sub_epi32(_mm_xor_si128(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+////////// SINT64
+
+__m128i libdivide_s64_do_vec128(__m128i numers, const struct libdivide_s64_t *denom) {
+    uint8_t more = denom->more;
+    int64_t magic = denom->magic;
+    if (magic == 0) {  // shift path
+        uint32_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+        uint64_t mask = ((uint64_t)1 << shift) - 1;
+        __m128i roundToZeroTweak = _mm_set1_epi64x(mask);
+        // q = numer + ((numer >> 63) & roundToZeroTweak);
+        __m128i q = _mm_add_epi64(
+            numers, _mm_and_si128(libdivide_s64_signbits_vec128(numers), roundToZeroTweak));
+        q = libdivide_s64_shift_right_vec128(q, shift);
+        __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
+        // q = (q ^ sign) - sign;
+        q = _mm_sub_epi64(_mm_xor_si128(q, sign), sign);
+        return q;
+    } else {
+        __m128i q = libdivide_mullhi_s64_vec128(numers, _mm_set1_epi64x(magic));
+        if (more & LIBDIVIDE_ADD_MARKER) {
+            // must be arithmetic shift
+            __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
+            // q += ((numer ^ sign) - sign);
+            q = _mm_add_epi64(q, _mm_sub_epi64(_mm_xor_si128(numers, sign), sign));
+        }
+        // q >>= denom->mult_path.shift
+        q = libdivide_s64_shift_right_vec128(q, more & LIBDIVIDE_64_SHIFT_MASK);
+        q = _mm_add_epi64(q, _mm_srli_epi64(q, 63));  // q += (q < 0)
+        return q;
+    }
+}
+
+__m128i libdivide_s64_branchfree_do_vec128(
+    __m128i numers, const struct libdivide_s64_branchfree_t *denom) {
+    int64_t magic = denom->magic;
+    uint8_t more = denom->more;
+    uint8_t shift = more & LIBDIVIDE_64_SHIFT_MASK;
+    // must be arithmetic shift
+    __m128i sign = _mm_set1_epi32((int8_t)more >> 7);
+
+    // libdivide_mullhi_s64(numers, magic);
+    __m128i q = libdivide_mullhi_s64_vec128(numers, _mm_set1_epi64x(magic));
+    q = _mm_add_epi64(q, numers);  // q += numers
+
+    // If q is non-negative, we have nothing to do.
+    // If q is negative, we want to add either (2**shift)-1 if d is
+    // a power of 2, or (2**shift) if it is not a power of 2.
+    uint32_t is_power_of_2 = (magic == 0);
+    __m128i q_sign = libdivide_s64_signbits_vec128(q);  // q_sign = q >> 63
+    __m128i mask = _mm_set1_epi64x(((uint64_t)1 << shift) - is_power_of_2);
+    q = _mm_add_epi64(q, _mm_and_si128(q_sign, mask));  // q = q + (q_sign & mask)
+    q = libdivide_s64_shift_right_vec128(q, shift);     // q >>= shift
+    q = _mm_sub_epi64(_mm_xor_si128(q, sign), sign);    // q = (q ^ sign) - sign
+    return q;
+}
+
+////////// REMAINDER
+
+// Low 32 bits of the products, SSE2 lacks _mm_mullo_epi32 (SSE4.1).
+static LIBDIVIDE_INLINE __m128i libdivide_mullo_u32_vec128(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    even = _mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0));
+    odd = _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0));
+    return _mm_unpacklo_epi32(even, odd);
+}
+
+// Low 64 bits of the products: x0*y0 + ((x0*y1 + x1*y0) << 32)
+static LIBDIVIDE_INLINE __m128i libdivide_mullo_u64_vec128(__m128i x, __m128i y) {
+    __m128i x0y0 = _mm_mul_epu32(x, y);
+    __m128i x0y1 = _mm_mul_epu32(x, _mm_srli_epi64(y, 32));
+    __m128i x1y0 = _mm_mul_epu32(_mm_srli_epi64(x, 32), y);
+    __m128i cross = _mm_slli_epi64(_mm_add_epi64(x0y1, x1y0), 32);
+    return _mm_add_epi64(x0y0, cross);
+}
+
+// Low 8 bits of the products, computed separately for the even and the odd
+// bytes with 16-bit multiplications.
+static LIBDIVIDE_INLINE __m128i libdivide_mullo_u8_vec128(__m128i a, __m128i b) {
+    __m128i even = _mm_and_si128(_mm_mullo_epi16(a, b), _mm_set1_epi16(0xFF));
+    __m128i odd = _mm_mullo_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+    return _mm_or_si128(even, _mm_slli_epi16(odd, 8));
+}
+
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u8, uint8_t, __m128i, vec128, _mm_set1_epi8, libdivide_mullo_u8_vec128, _mm_sub_epi8)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s8, int8_t, __m128i, vec128, _mm_set1_epi8, libdivide_mullo_u8_vec128, _mm_sub_epi8)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u16, uint16_t, __m128i, vec128, _mm_set1_epi16, _mm_mullo_epi16, _mm_sub_epi16)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s16, int16_t, __m128i, vec128, _mm_set1_epi16, _mm_mullo_epi16, _mm_sub_epi16)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u32, uint32_t, __m128i, vec128, _mm_set1_epi32, libdivide_mullo_u32_vec128, _mm_sub_epi32)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s32, int32_t, __m128i, vec128, _mm_set1_epi32, libdivide_mullo_u32_vec128, _mm_sub_epi32)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u64, uint64_t, __m128i, vec128, _mm_set1_epi64x, libdivide_mullo_u64_vec128, _mm_sub_epi64)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s64, int64_t, __m128i, vec128, _mm_set1_epi64x, libdivide_mullo_u64_vec128, _mm_sub_epi64)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u8_branchfree, uint8_t, __m128i, vec128,
+    _mm_set1_epi8, libdivide_mullo_u8_vec128, _mm_sub_epi8)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s8_branchfree, int8_t, __m128i, vec128,
+    _mm_set1_epi8, libdivide_mullo_u8_vec128, _mm_sub_epi8)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u16_branchfree, uint16_t, __m128i, vec128, _mm_set1_epi16, _mm_mullo_epi16, _mm_sub_epi16)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s16_branchfree, int16_t, __m128i, vec128, _mm_set1_epi16, _mm_mullo_epi16, _mm_sub_epi16)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u32_branchfree, uint32_t, __m128i, vec128,
+    _mm_set1_epi32, libdivide_mullo_u32_vec128, _mm_sub_epi32)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s32_branchfree, int32_t, __m128i, vec128,
+    _mm_set1_epi32, libdivide_mullo_u32_vec128, _mm_sub_epi32)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    u64_branchfree, uint64_t, __m128i, vec128,
+    _mm_set1_epi64x, libdivide_mullo_u64_vec128, _mm_sub_epi64)
+LIBDIVIDE_DIVMOD_VEC_GEN(
+    s64_branchfree, int64_t, __m128i, vec128,
+    _mm_set1_epi64x, libdivide_mullo_u64_vec128, _mm_sub_epi64)
+
+////////// FASTMOD
+
+// The 64-bit products are computed in the 64-bit lanes, for the even
+// (low 32 bits) numerators and then for the odd ones.
+
+// Low 64 bits of magic * numer for the numerators in the low 32 bits of
+// each 64-bit lane.
+static LIBDIVIDE_INLINE __m128i libdivide_u32_fastmod_lowbits_vec128(
+    __m128i numers, __m128i magic_lo, __m128i magic_hi) {
+    __m128i hi = _mm_slli_epi64(_mm_mul_epu32(numers, magic_hi), 32);
+    return _mm_add_epi64(_mm_mul_epu32(numers, magic_lo), hi);
+}
+
+// Same as above with the numerators sign extended to 64 bits, i.e.
+// magic << 32 is subtracted for negative numerators.
+static LIBDIVIDE_INLINE __m128i libdivide_s32_fastmod_lowbits_vec128(
+    __m128i numers, __m128i magic_lo, __m128i magic_hi) {
+    __m128i fix = _mm_and_si128(_mm_srai_epi32(numers, 31), magic_lo);
+    __m128i hi = _mm_sub_epi32(_mm_mul_epu32(numers, magic_hi), fix);
+    hi = _mm_slli_epi64(hi, 32);
+    return _mm_add_epi64(_mm_mul_epu32(numers, magic_lo), hi);
+}
+
+// (lowbits * d) >> 64, returned in the high 32 bits of each 64-bit lane
+static LIBDIVIDE_INLINE __m128i libdivide_fastmod_highbits_vec128(__m128i lowbits, __m128i d) {
+    __m128i lo = _mm_srli_epi64(_mm_mul_epu32(lowbits, d), 32);
+    return _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(lowbits, 32), d), lo);
+}
+
+// Moves the results in the high 32 bits of the even and odd lanes back
+// into their 32-bit lanes.
+static LIBDIVIDE_INLINE __m128i libdivide_fastmod_merge_vec128(__m128i even, __m128i odd) {
+    return _mm_or_si128(_mm_srli_epi64(even, 32), _mm_and_si128(odd, _mm_set_epi32(-1, 0, -1, 0)));
+}
+
+static LIBDIVIDE_INLINE __m128i libdivide_u32_fastmod_mod_vec128(
+    __m128i numers, const struct libdivide_u32_fastmod_t *denom) {
+    __m128i magic_lo = _mm_set1_epi32((int32_t)denom->magic);
+    __m128i magic_hi = _mm_set1_epi32((int32_t)(denom->magic >> 32));
+    __m128i d = _mm_set1_epi32((int32_t)denom->d);
+    __m128i even = libdivide_u32_fastmod_lowbits_vec128(numers, magic_lo, magic_hi);
+    __m128i odd =
+        libdivide_u32_fastmod_lowbits_vec128(_mm_srli_epi64(numers, 32), magic_lo, magic_hi);
+    even = libdivide_fastmod_highbits_vec128(even, d);
+    odd = libdivide_fastmod_highbits_vec128(odd, d);
+    return libdivide_fastmod_merge_vec128(even, odd);
+}
+
+static LIBDIVIDE_INLINE __m128i libdivide_s32_fastmod_mod_vec128(
+    __m128i numers, const struct libdivide_s32_fastmod_t *denom) {
+    __m128i magic_lo = _mm_set1_epi32((int32_t)denom->magic);
+    __m128i magic_hi = _mm_set1_epi32((int32_t)(denom->magic >> 32));
+    __m128i d = _mm_set1_epi32((int32_t)denom->d);
+    __m128i even = libdivide_s32_fastmod_lowbits_vec128(numers, magic_lo, magic_hi);
+    __m128i odd =
+        libdivide_s32_fastmod_lowbits_vec128(_mm_srli_epi64(numers, 32), magic_lo, magic_hi);
+    even = libdivide_fastmod_highbits_vec128(even, d);
+    odd = libdivide_fastmod_highbits_vec128(odd, d);
+    __m128i rems = libdivide_fastmod_merge_vec128(even, odd);
+    // rems -= (d - 1) & (numers >> 31)
+    __m128i fix =
+        _mm_and_si128(_mm_set1_epi32((int32_t)(denom->d - 1)), _mm_srai_epi32(numers, 31));
+    return _mm_sub_epi32(rems, fix);
+}
+
+// SSE2 has no 64-bit comparison, hence the remainders are compared to 0.
+// Returns a mask with all bits set in the lanes of the multiples of d.
+static LIBDIVIDE_INLINE __m128i libdivide_u32_fastmod_is_divisible_vec128(
+    __m128i numers, const struct libdivide_u32_fastmod_t *denom) {
+    __m128i rems = libdivide_u32_fastmod_mod_vec128(numers, denom);
+    return _mm_cmpeq_epi32(rems, _mm_setzero_si128());
+}
+
+static LIBDIVIDE_INLINE __m128i libdivide_s32_fastmod_is_divisible_vec128(
+    __m128i numers, const struct libdivide_s32_fastmod_t *denom) {
+    // The unsigned test works with the magic number of the absolute value.
+    const struct libdivide_u32_fastmod_t abs_denom = {denom->magic, denom->d};
+    __m128i sign = _mm_srai_epi32(numers, 31);
+    __m128i abs_numers = _mm_sub_epi32(_mm_xor_si128(numers, sign), sign);
+    return libdivide_u32_fastmod_is_divisible_vec128(abs_numers, &abs_denom);
+}
+
+////////// EXACT DIVISION
+
+LIBDIVIDE_EXACT_VEC_GEN(
+    u16, uint16_t, __m128i, vec128, _mm_srli_epi16, _mm_set1_epi16, _mm_mullo_epi16)
+LIBDIVIDE_EXACT_VEC_GEN(
+    s16, int16_t, __m128i, vec128, _mm_srai_epi16, _mm_set1_epi16, _mm_mullo_epi16)
+LIBDIVIDE_EXACT_VEC_GEN(
+    u32, uint32_t, __m128i, vec128, _mm_srli_epi32, _mm_set1_epi32, libdivide_mullo_u32_vec128)
+LIBDIVIDE_EXACT_VEC_GEN(
+    s32, int32_t, __m128i, vec128, _mm_srai_epi32, _mm_set1_epi32, libdivide_mullo_u32_vec128)
+LIBDIVIDE_EXACT_VEC_GEN(u64, uint64_t, __m128i, vec128, _mm_srli_epi64, _mm_set1_epi64x,
+    libdivide_mullo_u64_vec128)
+LIBDIVIDE_EXACT_VEC_GEN(s64, int64_t, __m128i, vec128, libdivide_s64_shift_right_vec128,
+    _mm_set1_epi64x, libdivide_mullo_u64_vec128)
+
+////////// ROUNDING
+
+LIBDIVIDE_ROUND_VEC_GEN(16, __m128i, vec128, _mm_set1_epi16, _mm_add_epi16, _mm_sub_epi16,
+    _mm_xor_si128, _mm_or_si128, _mm_and_si128, _mm_srli_epi16, _mm_srai_epi16, _mm_mulhi_epu16)
+LIBDIVIDE_ROUND_VEC_GEN(32, __m128i, vec128, _mm_set1_epi32, _mm_add_epi32, _mm_sub_epi32,
+    _mm_xor_si128, _mm_or_si128, _mm_and_si128, _mm_srli_epi32, _mm_srai_epi32,
+    libdivide_mullhi_u32_vec128)
+LIBDIVIDE_ROUND_VEC_GEN(64, __m128i, vec128, _mm_set1_epi64x, _mm_add_epi64, _mm_sub_epi64,
+    _mm_xor_si128, _mm_or_si128, _mm_and_si128, _mm_srli_epi64, libdivide_s64_shift_right_vec128,
+    libdivide_mullhi_u64_vec128)
+
+////////// FLOATING POINT RECIPROCAL
+
+LIBDIVIDE_FP16_VEC_GEN(__m128i, __m128, vec128, _mm_set1_epi32, _mm_set1_ps, _mm_and_si128,
+    _mm_or_si128, _mm_slli_epi32, _mm_srli_epi32, _mm_srai_epi32, _mm_cvtepi32_ps,
+    _mm_cvttps_epi32, _mm_mul_ps)
+
+// See libdivide_u32_fp_do_vec256(). _mm_cvtepi32_pd() converts the low
+// two lanes, _mm_cvttpd_epi32() zeroes the high two lanes of its result.
+static LIBDIVIDE_INLINE __m128i libdivide_u32_fp_do_vec128(
+    __m128i numers, const struct libdivide_u32_fp_t *denom) {
+    if (denom->recip >= 1.0) {
+        return numers;
+    }
+    __m128d recip = _mm_set1_pd(denom->recip);
+    __m128d bias = _mm_set1_pd(2147483648.0);
+    __m128i x = _mm_xor_si128(numers, _mm_set1_epi32(INT32_MIN));
+    __m128i lo = _mm_cvttpd_epi32(_mm_mul_pd(_mm_add_pd(_mm_cvtepi32_pd(x), bias), recip));
+    __m128i hi = _mm_cvttpd_epi32(
+        _mm_mul_pd(_mm_add_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(x, x)), bias), recip));
+    return _mm_unpacklo_epi64(lo, hi);
+}
+
+static LIBDIVIDE_INLINE __m128i libdivide_s32_fp_do_vec128(
+    __m128i numers, const struct libdivide_s32_fp_t *denom) {
+    __m128d recip = _mm_set1_pd(denom->recip);
+    __m128i lo = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(numers), recip));
+    __m128i hi =
+        _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(numers, numers)), recip));
+    return _mm_unpacklo_epi64(lo, hi);
+}
+
+////////// MODULAR MULTIPLICATION
+
+// Like libdivide_mullhi_u32_vec128() but b holds one value per lane.
+static LIBDIVIDE_INLINE __m128i libdivide_mullhi_u32_lanes_vec128(__m128i a, __m128i b) {
+    __m128i hi_product_0Z2Z = _mm_srli_epi64(_mm_mul_epu32(a, b), 32);
+    __m128i a1X3X = _mm_srli_epi64(a, 32);
+    __m128i b1X3X = _mm_srli_epi64(b, 32);
+    __m128i mask = _mm_set_epi32(-1, 0, -1, 0);
+    __m128i hi_product_Z1Z3 = _mm_and_si128(_mm_mul_epu32(a1X3X, b1X3X), mask);
+    return _mm_or_si128(hi_product_0Z2Z, hi_product_Z1Z3);
+}
+
+// See libdivide_u32_sub_fix_vec256(). SSE2 has no 64-bit comparisons,
+// 64-bit integers use the scalar kernels.
+static LIBDIVIDE_INLINE __m128i libdivide_u32_sub_fix_vec128(__m128i a, __m128i b, __m128i m) {
+    __m128i sign = _mm_set1_epi32(INT32_MIN);
+    __m128i borrow = _mm_cmpgt_epi32(_mm_xor_si128(b, sign), _mm_xor_si128(a, sign));
+    return _mm_add_epi32(_mm_sub_epi32(a, b), _mm_and_si128(borrow, m));
+}
+
+LIBDIVIDE_MODMUL_VEC_GEN(u32, __m128i, vec128, _mm_set1_epi32, int32_t, _mm_sub_epi32,
+    libdivide_mullo_u32_vec128, libdivide_mullhi_u32_lanes_vec128, libdivide_u32_sub_fix_vec128)
+
+////////// RATIONAL SCALING
+
+LIBDIVIDE_SCALER_VEC_GEN(__m128i, vec128, _mm_set1_epi64x, _mm_add_epi64, _mm_sub_epi64,
+    _mm_and_si128, _mm_or_si128, _mm_andnot_si128, _mm_srli_epi64, _mm_slli_epi64, _mm_srl_epi64,
+    _mm_sll_epi64, _mm_mul_epu32, libdivide_mullo_u64_vec128, libdivide_mullhi_u64_vec128)
+
+////////// FIXED POINT DIVISION
+
+LIBDIVIDE_FIXED16_VEC_GEN(__m128i, vec128, _mm_set1_epi16, _mm_add_epi16, _mm_and_si128,
+    _mm_or_si128, _mm_andnot_si128, _mm_srli_epi16, _mm_mullo_epi16, _mm_mulhi_epu16)
+LIBDIVIDE_FIXED_VEC_GEN(__m128i, vec128, _mm_set1_epi64x, _mm_add_epi64, _mm_and_si128,
+    _mm_or_si128, _mm_srli_epi64, _mm_slli_epi64, _mm_mul_epu32, libdivide_mullo_u64_vec128,
+    libdivide_mullhi_u64_vec128)
+
+LIBDIVIDE_SSE2_TARGET_POP
+
+#endif
+
+////////// Runtime dispatch
+
+#if defined(LIBDIVIDE_X86_DISPATCH)
+
+// Instruction sets used by the bulk (array) functions, from narrowest to widest.
+enum libdivide_isa {
+    LIBDIVIDE_ISA_SCALAR = 0,
+    LIBDIVIDE_ISA_SSE2 = 1,
+    LIBDIVIDE_ISA_AVX2 = 2,
+    LIBDIVIDE_ISA_AVX512 = 3
+};
+
+// Returns the widest instruction set supported by the CPU (and the OS).
+static LIBDIVIDE_INLINE int libdivide_cpu_isa(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return __builtin_cpu_supports("avx512f") ? LIBDIVIDE_ISA_AVX512 : LIBDIVIDE_ISA_AVX2;
+    }
+    return __builtin_cpu_supports("sse2") ? LIBDIVIDE_ISA_SSE2 : LIBDIVIDE_ISA_SCALAR;
+}
+
+// Parses the LIBDIVIDE_ISA environment variable (scalar, sse2, avx2 or
+// avx512), returns -1 if it is not set or invalid.
+static LIBDIVIDE_INLINE int libdivide_env_isa(void) {
+#if __STDC_HOSTED__ != 0
+    static const char *const names[] = {"scalar", "sse2", "avx2", "avx512"};
+    const char *env = getenv("LIBDIVIDE_ISA");
+    int isa, i;
+    if (env == NULL) {
+        return -1;
+    }
+    for (isa = 0; isa < 4; isa++) {
+        for (i = 0; names[isa][i] != '\0' && names[isa][i] == env[i]; i++) {
+        }
+        if (names[isa][i] == '\0' && env[i] == '\0') {
+            return isa;
+        }
+    }
+#endif
+    return -1;
+}
+
+// The selected instruction set, -1 until it has been detected. In C++
+// all translation units share the same state, in C each translation
+// unit has its own copy.
+#if defined(__cplusplus)
+inline int *libdivide_isa_state() {
+#else
+static LIBDIVIDE_INLINE int *libdivide_isa_state(void) {
+#endif
+    static int isa = -1;
+    return &isa;
+}
+
+// Returns the instruction set used by the bulk (array) functions. Unless
+// it has been overridden using libdivide_set_isa(), this is the widest one
+// supported by the CPU, lowered to LIBDIVIDE_ISA from the environment.
+static LIBDIVIDE_INLINE enum libdivide_isa libdivide_get_isa(void) {
+    int isa = __atomic_load_n(libdivide_isa_state(), __ATOMIC_RELAXED);
+    if (isa < 0) {
+        int env = libdivide_env_isa();
+        isa = libdivide_cpu_isa();
+        if (env >= 0 && env < isa) {
+            isa = env;
+        }
+        __atomic_store_n(libdivide_isa_state(), isa, __ATOMIC_RELAXED);
+    }
+    return (enum libdivide_isa)isa;
+}
+
+// Overrides the instruction set used by the bulk (array) functions. The
+// request is lowered to the widest instruction set supported by the CPU.
+// Returns the instruction set that is used from now on.
+static LIBDIVIDE_INLINE enum libdivide_isa libdivide_set_isa(enum libdivide_isa isa) {
+    int cpu = libdivide_cpu_isa();
+    int sel = ((int)isa < cpu) ? (int)isa : cpu;
+    if (sel < 0) {
+        sel = LIBDIVIDE_ISA_SCALAR;
+    }
+    __atomic_store_n(libdivide_isa_state(), sel, __ATOMIC_RELAXED);
+    return (enum libdivide_isa)sel;
+}
+
+#endif
+
+////////// Bulk (array) division
+
+// The do_array functions divide count numerators read from numers by the
+// same divider and store the quotients in quots. numers and quots may point
+// to the same array (in-place division) but must not otherwise overlap.
+//
+// The widest vector kernel enabled at compile time is used, or with
+// LIBDIVIDE_RUNTIME_DISPATCH the widest one supported by the CPU. A scalar head
+// loop first aligns the quotient pointer to the vector size, the main loop
+// then divides 4 vectors per iteration so that the latencies of the
+// independent multiplications overlap, and the remaining elements are handled
+// by a masked vector (AVX512) or by a scalar tail loop.
+//
+// The remainder_array and divmod_array functions additionally take the
+// divisor d and compute the remainders in the same pass. Their output
+// arrays may be numers but must not otherwise overlap.
+
+// With runtime dispatch the kernels are called from functions compiled for
+// a different target, hence they cannot be force inlined.
+#if defined(LIBDIVIDE_X86_DISPATCH)
+#define LIBDIVIDE_DO_ARRAY_INLINE inline
+#else
+#define LIBDIVIDE_DO_ARRAY_INLINE LIBDIVIDE_INLINE
+#endif
+
+// Generates libdivide_<ALGO>_do_array_<SUFFIX>() which divides as many
+// elements as possible using full vectors and returns the number of
+// elements it has processed.
+#define LIBDIVIDE_DO_ARRAY_VEC(ALGO, IntT, VecT, SUFFIX, LOADU, STORE)                  \
+    static LIBDIVIDE_DO_ARRAY_INLINE size_t libdivide_##ALGO##_do_array_##SUFFIX(       \
+        const IntT *numers, IntT *quots, size_t count,                                  \
+        const struct libdivide_##ALGO##_t *denom) {                                     \
+        const size_t lanes = sizeof(VecT) / sizeof(IntT);                               \
+        size_t i = 0;                                                                   \
+        for (; i < count && ((uintptr_t)(quots + i) % sizeof(VecT)) != 0; i++) {        \
+            quots[i] = libdivide_##ALGO##_do(numers[i], denom);                         \
+        }                                                                               \
+        for (; i + 4 * lanes <= count; i += 4 * lanes) {                                \
+            VecT n0 = LOADU(numers + i);                                                \
+            VecT n1 = LOADU(numers + i + lanes);                                        \
+            VecT n2 = LOADU(numers + i + 2 * lanes);                                    \
+            VecT n3 = LOADU(numers + i + 3 * lanes);                                    \
+            n0 = libdivide_##ALGO##_do_##SUFFIX(n0, denom);                             \
+            n1 = libdivide_##ALGO##_do_##SUFFIX(n1, denom);                             \
+            n2 = libdivide_##ALGO##_do_##SUFFIX(n2, denom);                             \
+            n3 = libdivide_##ALGO##_do_##SUFFIX(n3, denom);                             \
+            STORE(quots + i, n0);                                                       \
+            STORE(quots + i + lanes, n1);                                               \
+            STORE(quots + i + 2 * lanes, n2);                                           \
+            STORE(quots + i + 3 * lanes, n3);                                           \
+        }                                                                               \
+        for (; i + lanes <= count; i += lanes) {                                        \
+            STORE(quots + i, libdivide_##ALGO##_do_##SUFFIX(LOADU(numers + i), denom)); \
+        }                                                                               \
+        return i;                                                                       \
+    }
+
+// Like LIBDIVIDE_DO_ARRAY_VEC but the last partial vector is divided using
+// masked loads and stores, so all elements are processed.
+#define LIBDIVIDE_DO_ARRAY_VEC512_MASKED(ALGO, IntT, MaskT, EPI)                               \
+    static LIBDIVIDE_DO_ARRAY_INLINE size_t libdivide_##ALGO##_do_array_vec512_masked(         \
+        const IntT *numers, IntT *quots, size_t count,                                         \
+        const struct libdivide_##ALGO##_t *denom) {                                            \
+        size_t i = libdivide_##ALGO##_do_array_vec512(numers, quots, count, denom);            \
+        if (i < count) {                                                                       \
+            MaskT mask = (MaskT)(((uint32_t)1 << (count - i)) - 1);                            \
+            __m512i n = _mm512_maskz_loadu_##EPI(mask, numers + i);                            \
+            _mm512_mask_storeu_##EPI(quots + i, mask, libdivide_##ALGO##_do_vec512(n, denom)); \
+        }                                                                                      \
+        return count;                                                                          \
+    }
+
+// Generates libdivide_<ALGO>_do_each_<SUFFIX>() which divides as many
+// elements as possible by their own dividers using full vectors and returns
+// the number of elements it has processed. GATHER loads a vector from the
+// byte offsets i * stride relative to a pointer. The more field is the last
+// byte of the packed divider structs, it is gathered as the top byte of the
+// preceding lane sized word so that no load crosses the end of the dividers.
+#define LIBDIVIDE_DO_EACH_VEC(                                                               \
+    ALGO, IntT, VecT, IdxT, SUFFIX, LOADU, STOREU, OFFSETS, GATHER, SRLI)                    \
+    static LIBDIVIDE_DO_ARRAY_INLINE size_t libdivide_##ALGO##_do_each_##SUFFIX(             \
+        const IntT *numers, IntT *quots, size_t count,                                       \
+        const struct libdivide_##ALGO##_t *denoms, size_t stride) {                          \
+        const size_t lanes = sizeof(VecT) / sizeof(IntT);                                    \
+        const size_t more_offset = sizeof(*denoms) - sizeof(IntT);                           \
+        IdxT offsets = OFFSETS((int)stride);                                                 \
+        size_t i = 0;                                                                        \
+        for (; i + lanes <= count; i += lanes) {                                             \
+            const char *p = (const char *)denoms + i * stride;                               \
+            VecT magics = GATHER(p, offsets);                                                \
+            VecT mores = SRLI(GATHER(p + more_offset, offsets), 8 * sizeof(IntT) - 8);       \
+            VecT q = libdivide_##ALGO##_do_lanes_##SUFFIX(LOADU(numers + i), magics, mores); \
+            STOREU(quots + i, q);                                                            \
+        }                                                                                    \
+        return i;                                                                            \
+    }
+
+// Generates libdivide_<ALGO>_do_by_each_<SUFFIX>(), the counterpart of
+// do_each_<SUFFIX>() that divides the same numerator by all the dividers.
+#define LIBDIVIDE_DO_BY_EACH_VEC(                                                           \
+    ALGO, IntT, VecT, IdxT, SUFFIX, SET1, SetT, STOREU, OFFSETS, GATHER, SRLI)              \
+    static LIBDIVIDE_DO_ARRAY_INLINE size_t libdivide_##ALGO##_do_by_each_##SUFFIX(         \
+        IntT numer, IntT *quots, size_t count, const struct libdivide_##ALGO##_t *denoms,   \
+        size_t stride) {                                                                    \
+        const size_t lanes = sizeof(VecT) / sizeof(IntT);                                   \
+        const size_t more_offset = sizeof(*denoms) - sizeof(IntT);                          \
+        IdxT offsets = OFFSETS((int)stride);                                                \
+        VecT numers = SET1((SetT)numer);                                                    \
+        size_t i = 0;                                                                       \
+        for (; i + lanes <= count; i += lanes) {                                            \
+            const char *p = (const char *)denoms + i * stride;                              \
+            VecT magics = GATHER(p, offsets);                                               \
+            VecT mores = SRLI(GATHER(p + more_offset, offsets), 8 * sizeof(IntT) - 8);      \
+            STOREU(quots + i, libdivide_##ALGO##_do_lanes_##SUFFIX(numers, magics, mores)); \
+        }                                                                                   \
+        return i;                                                                           \
+    }
+
+// Generates libdivide_<ALGO>_dict_do_<SUFFIX>(), which divides lane i of
+// numers by the divider number codes[i] of a dictionary, and the array
+// kernel libdivide_<ALGO>_dict_do_array_<SUFFIX>(). The helpers
+// libdivide_dict_*<BITS>_<SUFFIX>() load the codes and the tables of the
+// dictionary, and select the entries of the lanes from the tables with
+// permutations instead of gathers.
+#define LIBDIVIDE_DICT_VEC(ALGO, IntT, VecT, SUFFIX, BITS, LOADU, STOREU)                \
+    static LIBDIVIDE_INLINE void libdivide_##ALGO##_dict_tables_##SUFFIX(                \
+        const struct libdivide_##ALGO##_dict_t *dict, VecT *magics, VecT *mores) {       \
+        const size_t lanes = sizeof(VecT) / sizeof(IntT);                                \
+        for (size_t k = 0; k < 16 / lanes; k++) {                                        \
+            magics[k] = LOADU(dict->magic + k * lanes);                                  \
+        }                                                                                \
+        libdivide_dict_mores##BITS##_##SUFFIX(dict->more, mores);                        \
+    }                                                                                    \
+    static LIBDIVIDE_INLINE VecT libdivide_##ALGO##_dict_do_tables_##SUFFIX(             \
+        VecT numers, VecT codes, const VecT *magics, const VecT *mores) {                \
+        return libdivide_##ALGO##_do_lanes_##SUFFIX(numers,                              \
+            libdivide_dict_select##BITS##_##SUFFIX(magics, codes),                       \
+            libdivide_dict_select_more##BITS##_##SUFFIX(mores, codes));                  \
+    }                                                                                    \
+    static LIBDIVIDE_INLINE VecT libdivide_##ALGO##_dict_do_##SUFFIX(                    \
+        VecT numers, VecT codes, const struct libdivide_##ALGO##_dict_t *dict) {         \
+        VecT magics[4], mores[2];                                                        \
+        libdivide_##ALGO##_dict_tables_##SUFFIX(dict, magics, mores);                    \
+        return libdivide_##ALGO##_dict_do_tables_##SUFFIX(numers, codes, magics, mores); \
+    }                                                                                    \
+    static LIBDIVIDE_DO_ARRAY_INLINE size_t libdivide_##ALGO##_dict_do_array_##SUFFIX(   \
+        const IntT *numers, const uint8_t *codes, IntT *quots, size_t count,             \
+        const struct libdivide_##ALGO##_dict_t *dict) {                                  \
+        const size_t lanes = sizeof(VecT) / sizeof(IntT);                                \
+        VecT magics[4], mores[2];                                                        \
+        libdivide_##ALGO##_dict_tables_##SUFFIX(dict, magics, mores);                    \
+        size_t i = 0;                                                                    \
+        for (; i + lanes <= count; i += lanes) {                                         \
+            VecT c = libdivide_dict_codes##BITS##_##SUFFIX(codes + i);                   \
+            STOREU(quots + i, libdivide_##ALGO##_dict_do_tables_##SUFFIX(                \
+                                  LOADU(numers + i), c, magics, mores));                 \
+        }                                                                                \
+        return i;                                                                        \
+    }
+
+// The 16-bit array kernels extend the numerators to 32 bits with WIDEN and
+// truncate the quotients with NARROW_STORE.
+#define LIBDIVIDE_DICT16_VEC(ALGO, IntT, WALGO, VecT, SUFFIX, WIDEN, NARROW_STORE)     \
+    static LIBDIVIDE_DO_ARRAY_INLINE size_t libdivide_##ALGO##_dict_do_array_##SUFFIX( \
+        const IntT *numers, const uint8_t *codes, IntT *quots, size_t count,           \
+        const struct libdivide_##ALGO##_dict_t *dict) {                                \
+        const size_t lanes = sizeof(VecT) / sizeof(int32_t);                           \
+        VecT magics[4], mores[2];                                                      \
+        libdivide_##WALGO##_dict_tables_##SUFFIX(&dict->wide, magics, mores);          \
+        size_t i = 0;                                                                  \
+        for (; i + lanes <= count; i += lanes) {                                       \
+            VecT c = libdivide_dict_codes32_##SUFFIX(codes + i);                       \
+            NARROW_STORE(quots + i, libdivide_##WALGO##_dict_do_tables_##SUFFIX(       \
+                                        WIDEN(numers + i), c, magics, mores));         \
+        }                                                                              \
+        return i;                                                                      \
+    }
+
+// Generates libdivide_<ALGO>_do_table_array_<SUFFIX>() which divides as
+// many elements as possible by the dividers of a table selected by indices
+// using full vectors and returns the number of elements it has processed.
+#define LIBDIVIDE_DO_TABLE_VEC(ALGO, IntT, VecT, IdxT, SUFFIX, LOADU, STOREU, LOADU_IDX) \
+    static LIBDIVIDE_DO_ARRAY_INLINE size_t libdivide_##ALGO##_do_table_array_##SUFFIX(  \
+        const IntT *numers, const uint32_t *indices, IntT *quots, size_t count,          \
+        const IntT *magics, const uint8_t *mores) {                                      \
+        const size_t lanes = sizeof(VecT) / sizeof(IntT);                                \
+        size_t i = 0;                                                                    \
+        for (; i + lanes <= count; i += lanes) {                                         \
+            IdxT idx = LOADU_IDX((const IdxT *)(const void *)(indices + i));             \
+            VecT n = LOADU(numers + i);                                                  \
+            VecT q = libdivide_##ALGO##_do_table_##SUFFIX(n, idx, magics, mores);        \
+            STOREU(quots + i, q);                                                        \
+        }                                                                                \
+        return i;                                                                        \
+    }
+
+// Generates libdivide_<ALGO>_iota_divmod_scalar() which computes the
+// quotients and remainders of start + i * step by d for i < count. Only
+// start and step are divided, adding step to a numerator adds the quotient
+// of step to its quotient and the remainder of step to its remainder,
+// plus a carry if the remainder reaches d. The numerators must not wrap
+// around. The vector kernels seed their lanes using the scalar kernels,
+// hence these are generated here.
+#define LIBDIVIDE_IOTA_DIVMOD_SCALAR(ALGO, IntT)                                     \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_iota_divmod_scalar(IntT start, \
+        IntT step, size_t count, IntT d, const struct libdivide_##ALGO##_t *denom,   \
+        IntT *quots, IntT *rems) {                                                   \
+        IntT q = libdivide_##ALGO##_do(start, denom);                                \
+        IntT r = (IntT)(start - q * d);                                              \
+        IntT q_step = libdivide_##ALGO##_do(step, denom);                            \
+        IntT r_step = (IntT)(step - q_step * d);                                     \
+        IntT threshold = (IntT)(d - r_step);                                         \
+        for (size_t i = 0; i < count; i++) {                                         \
+            quots[i] = q;                                                            \
+            rems[i] = r;                                                             \
+            IntT carry = (IntT)(r >= threshold);                                     \
+            q = (IntT)(q + q_step + carry);                                          \
+            r = (IntT)(carry ? r - threshold : r + r_step);                          \
+        }                                                                            \
+        return count;                                                                \
+    }
+
+LIBDIVIDE_IOTA_DIVMOD_SCALAR(u8, uint8_t)
+LIBDIVIDE_IOTA_DIVMOD_SCALAR(u16, uint16_t)
+LIBDIVIDE_IOTA_DIVMOD_SCALAR(u32, uint32_t)
+LIBDIVIDE_IOTA_DIVMOD_SCALAR(u64, uint64_t)
+
+// Generates libdivide_<ALGO>_iota_divmod_<SUFFIX>() which computes the
+// quotients and remainders of start + i * step for as many elements as
+// possible using 4 vectors and returns the number of elements it has
+// processed. The first 4 vectors are seeded by the scalar kernel, then
+// each lane advances by 4 * lanes * step per iteration using additions, a
+// comparison and a mask instead of a multiplication. The remainders are
+// kept offset by the sign bit, so that the signed comparison CMPGT orders
+// them as unsigned integers.
+#define LIBDIVIDE_IOTA_DIVMOD_VEC(                                                            \
+    ALGO, IntT, VecT, SUFFIX, SET1, SetT, ADD, AND, XOR, CMPGT, LOADU, STOREU)                \
+    static LIBDIVIDE_DO_ARRAY_INLINE size_t libdivide_##ALGO##_iota_divmod_##SUFFIX(          \
+        IntT start, IntT step, size_t count, IntT d,                                          \
+        const struct libdivide_##ALGO##_t *denom, IntT *quots, IntT *rems) {                  \
+        const size_t lanes = sizeof(VecT) / sizeof(IntT);                                     \
+        if (count < 8 * lanes) {                                                              \
+            return 0;                                                                         \
+        }                                                                                     \
+        libdivide_##ALGO##_iota_divmod_scalar(start, step, 4 * lanes, d, denom, quots, rems); \
+        IntT big_step = (IntT)(step * (IntT)(4 * lanes));                                     \
+        IntT q_big = libdivide_##ALGO##_do(big_step, denom);                                  \
+        IntT r_big = (IntT)(big_step - q_big * d);                                            \
+        const VecT sign = SET1((SetT)((IntT)1 << (8 * sizeof(IntT) - 1)));                    \
+        const VecT q_inc = SET1((SetT)(q_big + 1));                                           \
+        const VecT r_inc = SET1((SetT)(r_big - d));                                           \
+        const VecT divisor = SET1((SetT)d);                                                   \
+        const VecT threshold = XOR(SET1((SetT)(d - r_big)), sign);                            \
+        VecT q[4], r[4];                                                                      \
+        for (size_t k = 0; k < 4; k++) {                                                      \
+            q[k] = LOADU(quots + k * lanes);                                                  \
+            r[k] = XOR(LOADU(rems + k * lanes), sign);                                        \
+        }                                                                                     \
+        size_t i = 4 * lanes;                                                                 \
+        for (; i + 4 * lanes <= count; i += 4 * lanes) {                                      \
+            for (size_t k = 0; k < 4; k++) {                                                  \
+                VecT no_carry = CMPGT(threshold, r[k]);                                       \
+                q[k] = ADD(ADD(q[k], q_inc), no_carry);                                       \
+                r[k] = ADD(ADD(r[k], r_inc), AND(no_carry, divisor));                         \
+                STOREU(quots + i + k * lanes, q[k]);                                          \
+                STOREU(rems + i + k * lanes, XOR(r[k], sign));                                \
+            }                                                                                 \
+        }                                                                                     \
+        return i;                                                                             \
+    }
+
+// Generates libdivide_<ALGO>_decompose_array_<SUFFIX>() and
+// libdivide_<ALGO>_remap_array_<SUFFIX>(), which split the indices into
+// coordinates by dividing them by the extents from the innermost one
+// outwards. Two vectors are processed per iteration as the divisions of
+// each vector depend on each other. The remap kernels multiply the
+// coordinates by the strides using MULLO and sum them up using ADD.
+#define LIBDIVIDE_DECOMPOSE_VEC(ALGO, IntT, VecT, SUFFIX, SET1, MULLO, ADD, LOADU, STOREU) \
+    static LIBDIVIDE_DO_ARRAY_INLINE size_t libdivide_##ALGO##_decompose_array_##SUFFIX(   \
+        const IntT *indices, size_t count, const IntT *extents,                            \
+        const struct libdivide_##ALGO##_t *denoms, size_t rank, IntT *const *coords) {     \
+        const size_t lanes = sizeof(VecT) / sizeof(IntT);                                  \
+        size_t i = 0;                                                                      \
+        for (; i + 2 * lanes <= count; i += 2 * lanes) {                                   \
+            VecT n0 = LOADU(indices + i);                                                  \
+            VecT n1 = LOADU(indices + i + lanes);                                          \
+            for (size_t k = rank - 1; k > 0; k--) {                                        \
+                VecT r0, r1;                                                               \
+                n0 = libdivide_##ALGO##_divmod_##SUFFIX(n0, extents[k], &denoms[k], &r0);  \
+                n1 = libdivide_##ALGO##_divmod_##SUFFIX(n1, extents[k], &denoms[k], &r1);  \
+                STOREU(coords[k] + i, r0);                                                 \
+                STOREU(coords[k] + i + lanes, r1);                                         \
+            }                                                                              \
+            STOREU(coords[0] + i, n0);                                                     \
+            STOREU(coords[0] + i + lanes, n1);                                             \
+        }                                                                                  \
+        return i;                                                                          \
+    }                                                                                      \
+    static LIBDIVIDE_DO_ARRAY_INLINE size_t libdivide_##ALGO##_remap_array_##SUFFIX(       \
+        const IntT *indices, size_t count, const IntT *extents,                            \
+        const struct libdivide_##ALGO##_t *denoms, size_t rank, const IntT *strides,       \
+        IntT *out) {                                                                       \
+        const size_t lanes = sizeof(VecT) / sizeof(IntT);                                  \
+        size_t i = 0;                                                                      \
+        for (; i + 2 * lanes <= count; i += 2 * lanes) {                                   \
+            VecT n0 = LOADU(indices + i);                                                  \
+            VecT n1 = LOADU(indices + i + lanes);                                          \
+            VecT sum0 = SET1(0);                                                           \
+            VecT sum1 = SET1(0);                                                           \
+            for (size_t k = rank - 1; k > 0; k--) {                                        \
+                VecT r0, r1;                                                               \
+                VecT stride = SET1(strides[k]);                                            \
+                n0 = libdivide_##ALGO##_divmod_##SUFFIX(n0, extents[k], &denoms[k], &r0);  \
+                n1 = libdivide_##ALGO##_divmod_##SUFFIX(n1, extents[k], &denoms[k], &r1);  \
+                sum0 = ADD(sum0, MULLO(r0, stride));                                       \
+                sum1 = ADD(sum1, MULLO(r1, stride));                                       \
+            }                                                                              \
+            VecT stride = SET1(strides[0]);                                                \
+            STOREU(out + i, ADD(sum0, MULLO(n0, stride)));                                 \
+            STOREU(out + i + lanes, ADD(sum1, MULLO(n1, stride)));                         \
+        }                                                                                  \
+        return i;                                                                          \
+    }
+
+// Generates libdivide_<ALGO>_{mulmod,addmod,submod}_array_<SUFFIX>() and
+// libdivide_<ALGO>_powmod_array_<SUFFIX>(). mulmod and powmod compute in
+// Montgomery form, for an even m they return 0 and the elements are left
+// to the scalar kernels. powmod processes two vectors per iteration, as
+// the multiplications of each vector depend on each other, the bases are
+// converted into Montgomery form by multiplying them with r2.
+#define LIBDIVIDE_MODMUL_ARRAY_VEC(ALGO, IntT, VecT, SUFFIX, SET1, SetT, LOADU, STOREU)            \
+    static LIBDIVIDE_DO_ARRAY_INLINE size_t libdivide_##ALGO##_mulmod_array_##SUFFIX(              \
+        const IntT *a, const IntT *b, IntT *c, size_t count,                                       \
+        const struct libdivide_##ALGO##_reducer_t *reducer) {                                      \
+        const size_t lanes = sizeof(VecT) / sizeof(IntT);                                          \
+        if (!(reducer->m & 1)) {                                                                   \
+            return 0;                                                                              \
+        }                                                                                          \
+        size_t i = 0;                                                                              \
+        for (; i + lanes <= count; i += lanes) {                                                   \
+            VecT ci = libdivide_##ALGO##_mulmod_##SUFFIX(LOADU(a + i), LOADU(b + i), reducer);     \
+            STOREU(c + i, ci);                                                                     \
+        }                                                                                          \
+        return i;                                                                                  \
+    }                                                                                              \
+    static LIBDIVIDE_DO_ARRAY_INLINE size_t libdivide_##ALGO##_addmod_array_##SUFFIX(              \
+        const IntT *a, const IntT *b, IntT *c, size_t count,                                       \
+        const struct libdivide_##ALGO##_reducer_t *reducer) {                                      \
+        const size_t lanes = sizeof(VecT) / sizeof(IntT);                                          \
+        size_t i = 0;                                                                              \
+        for (; i + lanes <= count; i += lanes) {                                                   \
+            VecT ci = libdivide_##ALGO##_addmod_##SUFFIX(LOADU(a + i), LOADU(b + i), reducer);     \
+            STOREU(c + i, ci);                                                                     \
+        }                                                                                          \
+        return i;                                                                                  \
+    }                                                                                              \
+    static LIBDIVIDE_DO_ARRAY_INLINE size_t libdivide_##ALGO##_submod_array_##SUFFIX(              \
+        const IntT *a, const IntT *b, IntT *c, size_t count,                                       \
+        const struct libdivide_##ALGO##_reducer_t *reducer) {                                      \
+        const size_t lanes = sizeof(VecT) / sizeof(IntT);                                          \
+        size_t i = 0;                                                                              \
+        for (; i + lanes <= count; i += lanes) {                                                   \
+            VecT ci = libdivide_##ALGO##_submod_##SUFFIX(LOADU(a + i), LOADU(b + i), reducer);     \
+            STOREU(c + i, ci);                                                                     \
+        }                                                                                          \
+        return i;                                                                                  \
+    }                                                                                              \
+    static LIBDIVIDE_DO_ARRAY_INLINE size_t libdivide_##ALGO##_powmod_array_##SUFFIX(              \
+        const IntT *bases, IntT *powers, size_t count, uint64_t exp,                               \
+        const struct libdivide_##ALGO##_reducer_t *reducer) {                                      \
+        const size_t lanes = sizeof(VecT) / sizeof(IntT);                                          \
+        if (!(reducer->m & 1)) {                                                                   \
+            return 0;                                                                              \
+        }                                                                                          \
+        const VecT r2 = SET1((SetT)reducer->r2);                                                   \
+        const VecT one = SET1(1);                                                                  \
+        const VecT unit = SET1((SetT)libdivide_##ALGO##_to_montgomery(1, reducer));                \
+        size_t i = 0;                                                                              \
+        for (; i + 2 * lanes <= count; i += 2 * lanes) {                                           \
+            VecT x0 = libdivide_##ALGO##_montgomery_mul_##SUFFIX(LOADU(bases + i), r2, reducer);   \
+            VecT x1 =                                                                              \
+                libdivide_##ALGO##_montgomery_mul_##SUFFIX(LOADU(bases + i + lanes), r2, reducer); \
+            VecT p0 = unit;                                                                        \
+            VecT p1 = unit;                                                                        \
+            for (uint64_t e = exp; e != 0; e >>= 1) {                                              \
+                if (e & 1) {                                                                       \
+                    p0 = libdivide_##ALGO##_montgomery_mul_##SUFFIX(p0, x0, reducer);              \
+                    p1 = libdivide_##ALGO##_montgomery_mul_##SUFFIX(p1, x1, reducer);              \
+                }                                                                                  \
+                x0 = libdivide_##ALGO##_montgomery_mul_##SUFFIX(x0, x0, reducer);                  \
+                x1 = libdivide_##ALGO##_montgomery_mul_##SUFFIX(x1, x1, reducer);                  \
+            }                                                                                      \
+            p0 = libdivide_##ALGO##_montgomery_mul_##SUFFIX(p0, one, reducer);                     \
+            STOREU(powers + i, p0);                                                                \
+            p1 = libdivide_##ALGO##_montgomery_mul_##SUFFIX(p1, one, reducer);                     \
+            STOREU(powers + i + lanes, p1);                                                        \
+        }                                                                                          \
+        for (; i + lanes <= count; i += lanes) {                                                   \
+            VecT x = libdivide_##ALGO##_montgomery_mul_##SUFFIX(LOADU(bases + i), r2, reducer);    \
+            VecT p = unit;                                                                         \
+            for (uint64_t e = exp; e != 0; e >>= 1) {                                              \
+                if (e & 1) {                                                                       \
+                    p = libdivide_##ALGO##_montgomery_mul_##SUFFIX(p, x, reducer);                 \
+                }                                                                                  \
+                x = libdivide_##ALGO##_montgomery_mul_##SUFFIX(x, x, reducer);                     \
+            }                                                                                      \
+            STOREU(powers + i, libdivide_##ALGO##_montgomery_mul_##SUFFIX(p, one, reducer));       \
+        }                                                                                          \
+        return i;                                                                                  \
+    }
+
+// Generates libdivide_<ALGO>_scaler_do_array_<SUFFIX>().
+#define LIBDIVIDE_SCALER_ARRAY_VEC(ALGO, IntT, VecT, SUFFIX, LOADU, STOREU)                   \
+    static LIBDIVIDE_DO_ARRAY_INLINE size_t libdivide_##ALGO##_scaler_do_array_##SUFFIX(      \
+        const IntT *x, IntT *results, size_t count,                                           \
+        const struct libdivide_##ALGO##_scaler_t *scaler) {                                   \
+        const size_t lanes = sizeof(VecT) / sizeof(IntT);                                     \
+        size_t i = 0;                                                                         \
+        for (; i + lanes <= count; i += lanes) {                                              \
+            STOREU(results + i, libdivide_##ALGO##_scaler_do_##SUFFIX(LOADU(x + i), scaler)); \
+        }                                                                                     \
+        return i;                                                                             \
+    }
+
+// Generates libdivide_<ALGO>_gen_array_<SUFFIX>() for 32-bit unsigned
+// dividers, 8 divisors per iteration. It stops at the first 8 divisors
+// that contain 0 (or 1 for branchfree dividers), so that the scalar loop
+// reports the error.
+#define LIBDIVIDE_GEN_ARRAY_VEC(ALGO, BRANCHFREE, SUFFIX)                                    \
+    static LIBDIVIDE_DO_ARRAY_INLINE size_t libdivide_##ALGO##_gen_array_##SUFFIX(           \
+        const uint32_t *divisors, uint32_t *magics, uint8_t *mores, size_t count) {          \
+        __m256i invalid = _mm256_set1_epi32(BRANCHFREE);                                     \
+        size_t i = 0;                                                                        \
+        for (; i + 8 <= count; i += 8) {                                                     \
+            __m256i d = _mm256_loadu_si256((const __m256i *)(const void *)(divisors + i));   \
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_min_epu32(d, invalid), d))) { \
+                break;                                                                       \
+            }                                                                                \
+            __m128i more;                                                                    \
+            __m256i magic = libdivide_internal_u32_gen_##SUFFIX(d, BRANCHFREE, &more);       \
+            _mm256_storeu_si256((__m256i *)(void *)(magics + i), magic);                     \
+            _mm_storel_epi64((__m128i *)(void *)(mores + i), more);                          \
+        }                                                                                    \
+        return i;                                                                            \
+    }
+
+// Generates libdivide_<ALGO>_remainder_array_<SUFFIX>() and
+// libdivide_<ALGO>_divmod_array_<SUFFIX>(). Two vectors are processed per
+// iteration, the results are written using unaligned stores as the
+// quotient and remainder arrays are usually not aligned to each other.
+#define LIBDIVIDE_DIVMOD_ARRAY_VEC(ALGO, IntT, VecT, SUFFIX, LOADU, STOREU)               \
+    static LIBDIVIDE_DO_ARRAY_INLINE size_t libdivide_##ALGO##_remainder_array_##SUFFIX(  \
+        const IntT *numers, IntT *rems, size_t count, IntT d,                             \
+        const struct libdivide_##ALGO##_t *denom) {                                       \
+        const size_t lanes = sizeof(VecT) / sizeof(IntT);                                 \
+        size_t i = 0;                                                                     \
+        for (; i + 2 * lanes <= count; i += 2 * lanes) {                                  \
+            VecT n0 = LOADU(numers + i);                                                  \
+            VecT n1 = LOADU(numers + i + lanes);                                          \
+            n0 = libdivide_##ALGO##_remainder_##SUFFIX(n0, d, denom);                     \
+            n1 = libdivide_##ALGO##_remainder_##SUFFIX(n1, d, denom);                     \
+            STOREU(rems + i, n0);                                                         \
+            STOREU(rems + i + lanes, n1);                                                 \
+        }                                                                                 \
+        for (; i + lanes <= count; i += lanes) {                                          \
+            VecT r0 = libdivide_##ALGO##_remainder_##SUFFIX(LOADU(numers + i), d, denom); \
+            STOREU(rems + i, r0);                                                         \
+        }                                                                                 \
+        return i;                                                                         \
+    }                                                                                     \
+    static LIBDIVIDE_DO_ARRAY_INLINE size_t libdivide_##ALGO##_divmod_array_##SUFFIX(     \
+        const IntT *numers, IntT *quots, IntT *rems, size_t count, IntT d,                \
+        const struct libdivide_##ALGO##_t *denom) {                                       \
+        const size_t lanes = sizeof(VecT) / sizeof(IntT);                                 \
+        size_t i = 0;                                                                     \
+        for (; i + 2 * lanes <= count; i += 2 * lanes) {                                  \
+            VecT r0, r1;                                                                  \
+            VecT n0 = LOADU(numers + i);                                                  \
+            VecT n1 = LOADU(numers + i + lanes);                                          \
+            n0 = libdivide_##ALGO##_divmod_##SUFFIX(n0, d, denom, &r0);                   \
+            n1 = libdivide_##ALGO##_divmod_##SUFFIX(n1, d, denom, &r1);                   \
+            STOREU(quots + i, n0);                                                        \
+            STOREU(quots + i + lanes, n1);                                                \
+            STOREU(rems + i, r0);                                                         \
+            STOREU(rems + i + lanes, r1);                                                 \
+        }                                                                                 \
+        for (; i + lanes <= count; i += lanes) {                                          \
+            VecT r0;                                                                      \
+            VecT n0 = LOADU(numers + i);                                                  \
+            n0 = libdivide_##ALGO##_divmod_##SUFFIX(n0, d, denom, &r0);                   \
+            STOREU(quots + i, n0);                                                        \
+            STOREU(rems + i, r0);                                                         \
+        }                                                                                 \
+        return i;                                                                         \
+    }
+
+// Scalar kernels, used if no vector instruction set is enabled.
+#define LIBDIVIDE_DO_ARRAY_SCALAR(ALGO, IntT)                                    \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_do_array_scalar(           \
+        const IntT *numers, IntT *quots, size_t count,                           \
+        const struct libdivide_##ALGO##_t *denom) {                              \
+        for (size_t i = 0; i < count; i++) {                                     \
+            quots[i] = libdivide_##ALGO##_do(numers[i], denom);                  \
+        }                                                                        \
+        return count;                                                            \
+    }                                                                            \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_remainder_array_scalar(    \
+        const IntT *numers, IntT *rems, size_t count, IntT d,                    \
+        const struct libdivide_##ALGO##_t *denom) {                              \
+        for (size_t i = 0; i < count; i++) {                                     \
+            rems[i] = libdivide_##ALGO##_remainder(numers[i], d, denom);         \
+        }                                                                        \
+        return count;                                                            \
+    }                                                                            \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_divmod_array_scalar(       \
+        const IntT *numers, IntT *quots, IntT *rems, size_t count, IntT d,       \
+        const struct libdivide_##ALGO##_t *denom) {                              \
+        for (size_t i = 0; i < count; i++) {                                     \
+            quots[i] = libdivide_##ALGO##_divmod(numers[i], d, denom, &rems[i]); \
+        }                                                                        \
+        return count;                                                            \
+    }
+
+#define LIBDIVIDE_ARRAY_KERNEL(NAME, SUFFIX) LIBDIVIDE_ARRAY_KERNEL_(NAME, SUFFIX)
+#define LIBDIVIDE_ARRAY_KERNEL_(NAME, SUFFIX) NAME##_##SUFFIX
+
+// Generates the public libdivide_<ALGO>_do_array(), remainder_array() and
+// divmod_array() functions on top of the kernels selected by SUFFIX and
+// DIVMOD_SUFFIX.
+#define LIBDIVIDE_DO_ARRAY_GEN(ALGO, IntT, SUFFIX, DIVMOD_SUFFIX)                             \
+    void libdivide_##ALGO##_do_array(const IntT *numers, IntT *quots, size_t count,           \
+        const struct libdivide_##ALGO##_t *denom) {                                           \
+        size_t i = LIBDIVIDE_ARRAY_KERNEL(libdivide_##ALGO##_do_array, SUFFIX)(               \
+            numers, quots, count, denom);                                                     \
+        for (; i < count; i++) {                                                              \
+            quots[i] = libdivide_##ALGO##_do(numers[i], denom);                               \
+        }                                                                                     \
+    }                                                                                         \
+    void libdivide_##ALGO##_remainder_array(const IntT *numers, IntT *rems, size_t count,     \
+        IntT d, const struct libdivide_##ALGO##_t *denom) {                                   \
+        size_t i = LIBDIVIDE_ARRAY_KERNEL(libdivide_##ALGO##_remainder_array, DIVMOD_SUFFIX)( \
+            numers, rems, count, d, denom);                                                   \
+        for (; i < count; i++) {                                                              \
+            rems[i] = libdivide_##ALGO##_remainder(numers[i], d, denom);                      \
+        }                                                                                     \
+    }                                                                                         \
+    void libdivide_##ALGO##_divmod_array(const IntT *numers, IntT *quots, IntT *rems,         \
+        size_t count, IntT d, const struct libdivide_##ALGO##_t *denom) {                     \
+        size_t i = LIBDIVIDE_ARRAY_KERNEL(libdivide_##ALGO##_divmod_array, DIVMOD_SUFFIX)(    \
+            numers, quots, rems, count, d, denom);                                            \
+        for (; i < count; i++) {                                                              \
+            quots[i] = libdivide_##ALGO##_divmod(numers[i], d, denom, &rems[i]);              \
+        }                                                                                     \
+    }
+
+#if defined(LIBDIVIDE_AVX512_KERNELS)
+
+LIBDIVIDE_AVX512_TARGET_PUSH
+
+#define LIBDIVIDE_LOADU_VEC512(p) _mm512_loadu_si512((const void *)(p))
+#define LIBDIVIDE_STORE_VEC512(p, v) _mm512_store_si512((void *)(p), v)
+#define LIBDIVIDE_STOREU_VEC512(p, v) _mm512_storeu_si512((void *)(p), v)
+
+LIBDIVIDE_DO_ARRAY_VEC(
+    u32, uint32_t, __m512i, vec512, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STORE_VEC512)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s32, int32_t, __m512i, vec512, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STORE_VEC512)
+LIBDIVIDE_DO_ARRAY_VEC(
+    u64, uint64_t, __m512i, vec512, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STORE_VEC512)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s64, int64_t, __m512i, vec512, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STORE_VEC512)
+LIBDIVIDE_DO_ARRAY_VEC(
+    u32_branchfree, uint32_t, __m512i, vec512, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STORE_VEC512)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s32_branchfree, int32_t, __m512i, vec512, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STORE_VEC512)
+LIBDIVIDE_DO_ARRAY_VEC(
+    u64_branchfree, uint64_t, __m512i, vec512, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STORE_VEC512)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s64_branchfree, int64_t, __m512i, vec512, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STORE_VEC512)
+
+LIBDIVIDE_DO_ARRAY_VEC512_MASKED(u32, uint32_t, __mmask16, epi32)
+LIBDIVIDE_DO_ARRAY_VEC512_MASKED(s32, int32_t, __mmask16, epi32)
+LIBDIVIDE_DO_ARRAY_VEC512_MASKED(u64, uint64_t, __mmask8, epi64)
+LIBDIVIDE_DO_ARRAY_VEC512_MASKED(s64, int64_t, __mmask8, epi64)
+LIBDIVIDE_DO_ARRAY_VEC512_MASKED(u32_branchfree, uint32_t, __mmask16, epi32)
+LIBDIVIDE_DO_ARRAY_VEC512_MASKED(s32_branchfree, int32_t, __mmask16, epi32)
+LIBDIVIDE_DO_ARRAY_VEC512_MASKED(u64_branchfree, uint64_t, __mmask8, epi64)
+LIBDIVIDE_DO_ARRAY_VEC512_MASKED(s64_branchfree, int64_t, __mmask8, epi64)
+
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u32, uint32_t, __m512i, vec512, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STOREU_VEC512)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s32, int32_t, __m512i, vec512, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STOREU_VEC512)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u64, uint64_t, __m512i, vec512, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STOREU_VEC512)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s64, int64_t, __m512i, vec512, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STOREU_VEC512)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u32_branchfree, uint32_t, __m512i, vec512, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STOREU_VEC512)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s32_branchfree, int32_t, __m512i, vec512, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STOREU_VEC512)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u64_branchfree, uint64_t, __m512i, vec512, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STOREU_VEC512)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s64_branchfree, int64_t, __m512i, vec512, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STOREU_VEC512)
+
+// Byte offsets i * stride of the dividers of the lanes
+static LIBDIVIDE_INLINE __m512i libdivide_each_offsets32_vec512(int stride) {
+    return _mm512_mullo_epi32(
+        _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+        _mm512_set1_epi32(stride));
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_each_offsets64_vec512(int stride) {
+    return _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_gather32_vec512(const char *p, __m512i offsets) {
+    return _mm512_i32gather_epi32(offsets, (const void *)p, 1);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_gather64_vec512(const char *p, __m256i offsets) {
+    return _mm512_i32gather_epi64(offsets, (const void *)p, 1);
+}
+
+LIBDIVIDE_DO_EACH_VEC(u32_branchfree, uint32_t, __m512i, __m512i, vec512, LIBDIVIDE_LOADU_VEC512,
+    LIBDIVIDE_STOREU_VEC512, libdivide_each_offsets32_vec512, libdivide_gather32_vec512,
+    _mm512_srli_epi32)
+LIBDIVIDE_DO_EACH_VEC(s32_branchfree, int32_t, __m512i, __m512i, vec512, LIBDIVIDE_LOADU_VEC512,
+    LIBDIVIDE_STOREU_VEC512, libdivide_each_offsets32_vec512, libdivide_gather32_vec512,
+    _mm512_srli_epi32)
+LIBDIVIDE_DO_EACH_VEC(u64_branchfree, uint64_t, __m512i, __m256i, vec512, LIBDIVIDE_LOADU_VEC512,
+    LIBDIVIDE_STOREU_VEC512, libdivide_each_offsets64_vec512, libdivide_gather64_vec512,
+    _mm512_srli_epi64)
+LIBDIVIDE_DO_EACH_VEC(s64_branchfree, int64_t, __m512i, __m256i, vec512, LIBDIVIDE_LOADU_VEC512,
+    LIBDIVIDE_STOREU_VEC512, libdivide_each_offsets64_vec512, libdivide_gather64_vec512,
+    _mm512_srli_epi64)
+
+LIBDIVIDE_DO_BY_EACH_VEC(u32_branchfree, uint32_t, __m512i, __m512i, vec512,
+    _mm512_set1_epi32, int32_t, LIBDIVIDE_STOREU_VEC512, libdivide_each_offsets32_vec512,
+    libdivide_gather32_vec512, _mm512_srli_epi32)
+LIBDIVIDE_DO_BY_EACH_VEC(s32_branchfree, int32_t, __m512i, __m512i, vec512,
+    _mm512_set1_epi32, int32_t, LIBDIVIDE_STOREU_VEC512, libdivide_each_offsets32_vec512,
+    libdivide_gather32_vec512, _mm512_srli_epi32)
+LIBDIVIDE_DO_BY_EACH_VEC(u64_branchfree, uint64_t, __m512i, __m256i, vec512,
+    _mm512_set1_epi64, int64_t, LIBDIVIDE_STOREU_VEC512, libdivide_each_offsets64_vec512,
+    libdivide_gather64_vec512, _mm512_srli_epi64)
+LIBDIVIDE_DO_BY_EACH_VEC(s64_branchfree, int64_t, __m512i, __m256i, vec512,
+    _mm512_set1_epi64, int64_t, LIBDIVIDE_STOREU_VEC512, libdivide_each_offsets64_vec512,
+    libdivide_gather64_vec512, _mm512_srli_epi64)
+
+LIBDIVIDE_DO_TABLE_VEC(u32_branchfree, uint32_t, __m512i, __m512i, vec512, LIBDIVIDE_LOADU_VEC512,
+    LIBDIVIDE_STOREU_VEC512, _mm512_loadu_si512)
+LIBDIVIDE_DO_TABLE_VEC(s32_branchfree, int32_t, __m512i, __m512i, vec512, LIBDIVIDE_LOADU_VEC512,
+    LIBDIVIDE_STOREU_VEC512, _mm512_loadu_si512)
+LIBDIVIDE_DO_TABLE_VEC(u64_branchfree, uint64_t, __m512i, __m256i, vec512, LIBDIVIDE_LOADU_VEC512,
+    LIBDIVIDE_STOREU_VEC512, _mm256_loadu_si256)
+LIBDIVIDE_DO_TABLE_VEC(s64_branchfree, int64_t, __m512i, __m256i, vec512, LIBDIVIDE_LOADU_VEC512,
+    LIBDIVIDE_STOREU_VEC512, _mm256_loadu_si256)
+
+// Selects entry codes[i] of a 16 entry dictionary table in lane i
+static LIBDIVIDE_INLINE __m512i libdivide_dict_select32_vec512(
+    const __m512i *table, __m512i codes) {
+    return _mm512_permutexvar_epi32(codes, table[0]);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_dict_select64_vec512(
+    const __m512i *table, __m512i codes) {
+    return _mm512_permutex2var_epi64(table[0], codes, table[1]);
+}
+
+// The more fields are extended to the lane size, there are no byte
+// shuffles without AVX512BW.
+static LIBDIVIDE_INLINE void libdivide_dict_mores32_vec512(const uint8_t *more, __m512i *table) {
+    table[0] = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i *)(const void *)more));
+}
+
+static LIBDIVIDE_INLINE void libdivide_dict_mores64_vec512(const uint8_t *more, __m512i *table) {
+    table[0] = _mm512_cvtepu8_epi64(_mm_loadl_epi64((const __m128i *)(const void *)more));
+    table[1] = _mm512_cvtepu8_epi64(_mm_loadl_epi64((const __m128i *)(const void *)(more + 8)));
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_dict_select_more32_vec512(
+    const __m512i *table, __m512i codes) {
+    return libdivide_dict_select32_vec512(table, codes);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_dict_select_more64_vec512(
+    const __m512i *table, __m512i codes) {
+    return libdivide_dict_select64_vec512(table, codes);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_dict_codes32_vec512(const uint8_t *codes) {
+    return _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i *)(const void *)codes));
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_dict_codes64_vec512(const uint8_t *codes) {
+    return _mm512_cvtepu8_epi64(_mm_loadl_epi64((const __m128i *)(const void *)codes));
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_dict_widen_u16_vec512(const uint16_t *numers) {
+    return _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *)(const void *)numers));
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_dict_widen_s16_vec512(const int16_t *numers) {
+    return _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i *)(const void *)numers));
+}
+
+static LIBDIVIDE_INLINE void libdivide_dict_narrow_store_vec512(void *quots, __m512i q) {
+    _mm256_storeu_si256((__m256i *)quots, _mm512_cvtepi32_epi16(q));
+}
+
+LIBDIVIDE_DICT_VEC(u32_branchfree, uint32_t, __m512i, vec512, 32, LIBDIVIDE_LOADU_VEC512,
+    LIBDIVIDE_STOREU_VEC512)
+LIBDIVIDE_DICT_VEC(s32_branchfree, int32_t, __m512i, vec512, 32, LIBDIVIDE_LOADU_VEC512,
+    LIBDIVIDE_STOREU_VEC512)
+LIBDIVIDE_DICT_VEC(u64_branchfree, uint64_t, __m512i, vec512, 64, LIBDIVIDE_LOADU_VEC512,
+    LIBDIVIDE_STOREU_VEC512)
+LIBDIVIDE_DICT_VEC(s64_branchfree, int64_t, __m512i, vec512, 64, LIBDIVIDE_LOADU_VEC512,
+    LIBDIVIDE_STOREU_VEC512)
+LIBDIVIDE_DICT16_VEC(u16_branchfree, uint16_t, u32_branchfree, __m512i, vec512,
+    libdivide_dict_widen_u16_vec512, libdivide_dict_narrow_store_vec512)
+LIBDIVIDE_DICT16_VEC(s16_branchfree, int16_t, s32_branchfree, __m512i, vec512,
+    libdivide_dict_widen_s16_vec512, libdivide_dict_narrow_store_vec512)
+
+// Signed comparisons returning a vector mask like SSE2 and AVX2
+static LIBDIVIDE_INLINE __m512i libdivide_cmpgt32_vec512(__m512i a, __m512i b) {
+    return _mm512_maskz_set1_epi32(_mm512_cmpgt_epi32_mask(a, b), -1);
+}
+
+static LIBDIVIDE_INLINE __m512i libdivide_cmpgt64_vec512(__m512i a, __m512i b) {
+    return _mm512_maskz_set1_epi64(_mm512_cmpgt_epi64_mask(a, b), -1);
+}
+
+LIBDIVIDE_IOTA_DIVMOD_VEC(u32, uint32_t, __m512i, vec512, _mm512_set1_epi32, int32_t,
+    _mm512_add_epi32, _mm512_and_si512, _mm512_xor_si512, libdivide_cmpgt32_vec512,
+    LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STOREU_VEC512)
+LIBDIVIDE_IOTA_DIVMOD_VEC(u64, uint64_t, __m512i, vec512, _mm512_set1_epi64, int64_t,
+    _mm512_add_epi64, _mm512_and_si512, _mm512_xor_si512, libdivide_cmpgt64_vec512,
+    LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STOREU_VEC512)
+
+LIBDIVIDE_DECOMPOSE_VEC(u32, uint32_t, __m512i, vec512, _mm512_set1_epi32, _mm512_mullo_epi32,
+    _mm512_add_epi32, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STOREU_VEC512)
+LIBDIVIDE_DECOMPOSE_VEC(u64, uint64_t, __m512i, vec512, _mm512_set1_epi64,
+    libdivide_mullo_u64_vec512, _mm512_add_epi64, LIBDIVIDE_LOADU_VEC512,
+    LIBDIVIDE_STOREU_VEC512)
+
+LIBDIVIDE_MODMUL_ARRAY_VEC(u32, uint32_t, __m512i, vec512, _mm512_set1_epi32, int32_t,
+    LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STOREU_VEC512)
+LIBDIVIDE_MODMUL_ARRAY_VEC(u64, uint64_t, __m512i, vec512, _mm512_set1_epi64, int64_t,
+    LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STOREU_VEC512)
+
+LIBDIVIDE_SCALER_ARRAY_VEC(
+    u32, uint32_t, __m512i, vec512, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STOREU_VEC512)
+LIBDIVIDE_SCALER_ARRAY_VEC(
+    u64, uint64_t, __m512i, vec512, LIBDIVIDE_LOADU_VEC512, LIBDIVIDE_STOREU_VEC512)
+
+LIBDIVIDE_GEN_ARRAY_VEC(u32, 0, vec512)
+LIBDIVIDE_GEN_ARRAY_VEC(u32_branchfree, 1, vec512)
+
+LIBDIVIDE_AVX512_TARGET_POP
+
+#endif
+
+#if defined(LIBDIVIDE_AVX2_KERNELS)
+
+LIBDIVIDE_AVX2_TARGET_PUSH
+
+#define LIBDIVIDE_LOADU_VEC256(p) _mm256_loadu_si256((const __m256i *)(const void *)(p))
+#define LIBDIVIDE_STORE_VEC256(p, v) _mm256_store_si256((__m256i *)(void *)(p), v)
+#define LIBDIVIDE_STOREU_VEC256(p, v) _mm256_storeu_si256((__m256i *)(void *)(p), v)
+
+LIBDIVIDE_DO_ARRAY_VEC(
+    u8, uint8_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STORE_VEC256)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s8, int8_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STORE_VEC256)
+LIBDIVIDE_DO_ARRAY_VEC(
+    u16, uint16_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STORE_VEC256)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s16, int16_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STORE_VEC256)
+LIBDIVIDE_DO_ARRAY_VEC(
+    u32, uint32_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STORE_VEC256)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s32, int32_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STORE_VEC256)
+LIBDIVIDE_DO_ARRAY_VEC(
+    u64, uint64_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STORE_VEC256)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s64, int64_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STORE_VEC256)
+LIBDIVIDE_DO_ARRAY_VEC(
+    u8_branchfree, uint8_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STORE_VEC256)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s8_branchfree, int8_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STORE_VEC256)
+LIBDIVIDE_DO_ARRAY_VEC(
+    u16_branchfree, uint16_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STORE_VEC256)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s16_branchfree, int16_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STORE_VEC256)
+LIBDIVIDE_DO_ARRAY_VEC(
+    u32_branchfree, uint32_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STORE_VEC256)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s32_branchfree, int32_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STORE_VEC256)
+LIBDIVIDE_DO_ARRAY_VEC(
+    u64_branchfree, uint64_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STORE_VEC256)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s64_branchfree, int64_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STORE_VEC256)
+
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u8, uint8_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s8, int8_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u16, uint16_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s16, int16_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u32, uint32_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s32, int32_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u64, uint64_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s64, int64_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u8_branchfree, uint8_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s8_branchfree, int8_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u16_branchfree, uint16_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s16_branchfree, int16_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u32_branchfree, uint32_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s32_branchfree, int32_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u64_branchfree, uint64_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s64_branchfree, int64_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+
+// Byte offsets i * stride of the dividers of the lanes
+static LIBDIVIDE_INLINE __m256i libdivide_each_offsets32_vec256(int stride) {
+    return _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+}
+
+static LIBDIVIDE_INLINE __m128i libdivide_each_offsets64_vec256(int stride) {
+    return _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(stride));
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_gather32_vec256(const char *p, __m256i offsets) {
+    return _mm256_i32gather_epi32((const int *)(const void *)p, offsets, 1);
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_gather64_vec256(const char *p, __m128i offsets) {
+    return _mm256_i32gather_epi64((const long long *)(const void *)p, offsets, 1);
+}
+
+LIBDIVIDE_DO_EACH_VEC(u32_branchfree, uint32_t, __m256i, __m256i, vec256, LIBDIVIDE_LOADU_VEC256,
+    LIBDIVIDE_STOREU_VEC256, libdivide_each_offsets32_vec256, libdivide_gather32_vec256,
+    _mm256_srli_epi32)
+LIBDIVIDE_DO_EACH_VEC(s32_branchfree, int32_t, __m256i, __m256i, vec256, LIBDIVIDE_LOADU_VEC256,
+    LIBDIVIDE_STOREU_VEC256, libdivide_each_offsets32_vec256, libdivide_gather32_vec256,
+    _mm256_srli_epi32)
+LIBDIVIDE_DO_EACH_VEC(u64_branchfree, uint64_t, __m256i, __m128i, vec256, LIBDIVIDE_LOADU_VEC256,
+    LIBDIVIDE_STOREU_VEC256, libdivide_each_offsets64_vec256, libdivide_gather64_vec256,
+    _mm256_srli_epi64)
+LIBDIVIDE_DO_EACH_VEC(s64_branchfree, int64_t, __m256i, __m128i, vec256, LIBDIVIDE_LOADU_VEC256,
+    LIBDIVIDE_STOREU_VEC256, libdivide_each_offsets64_vec256, libdivide_gather64_vec256,
+    _mm256_srli_epi64)
+
+LIBDIVIDE_DO_BY_EACH_VEC(u32_branchfree, uint32_t, __m256i, __m256i, vec256,
+    _mm256_set1_epi32, int32_t, LIBDIVIDE_STOREU_VEC256, libdivide_each_offsets32_vec256,
+    libdivide_gather32_vec256, _mm256_srli_epi32)
+LIBDIVIDE_DO_BY_EACH_VEC(s32_branchfree, int32_t, __m256i, __m256i, vec256,
+    _mm256_set1_epi32, int32_t, LIBDIVIDE_STOREU_VEC256, libdivide_each_offsets32_vec256,
+    libdivide_gather32_vec256, _mm256_srli_epi32)
+LIBDIVIDE_DO_BY_EACH_VEC(u64_branchfree, uint64_t, __m256i, __m128i, vec256,
+    _mm256_set1_epi64x, int64_t, LIBDIVIDE_STOREU_VEC256, libdivide_each_offsets64_vec256,
+    libdivide_gather64_vec256, _mm256_srli_epi64)
+LIBDIVIDE_DO_BY_EACH_VEC(s64_branchfree, int64_t, __m256i, __m128i, vec256,
+    _mm256_set1_epi64x, int64_t, LIBDIVIDE_STOREU_VEC256, libdivide_each_offsets64_vec256,
+    libdivide_gather64_vec256, _mm256_srli_epi64)
+
+LIBDIVIDE_DO_TABLE_VEC(u32_branchfree, uint32_t, __m256i, __m256i, vec256, LIBDIVIDE_LOADU_VEC256,
+    LIBDIVIDE_STOREU_VEC256, _mm256_loadu_si256)
+LIBDIVIDE_DO_TABLE_VEC(s32_branchfree, int32_t, __m256i, __m256i, vec256, LIBDIVIDE_LOADU_VEC256,
+    LIBDIVIDE_STOREU_VEC256, _mm256_loadu_si256)
+LIBDIVIDE_DO_TABLE_VEC(u64_branchfree, uint64_t, __m256i, __m128i, vec256, LIBDIVIDE_LOADU_VEC256,
+    LIBDIVIDE_STOREU_VEC256, _mm_loadu_si128)
+LIBDIVIDE_DO_TABLE_VEC(s64_branchfree, int64_t, __m256i, __m128i, vec256, LIBDIVIDE_LOADU_VEC256,
+    LIBDIVIDE_STOREU_VEC256, _mm_loadu_si128)
+
+// Selects entry codes[i] of a 16 entry dictionary table in lane i. The
+// permutations only use the low 3 bits of the indices, bit 3 of the codes
+// selects one of the two halves of the table.
+static LIBDIVIDE_INLINE __m256i libdivide_dict_select32_vec256(
+    const __m256i *table, __m256i codes) {
+    __m256 lo = _mm256_castsi256_ps(_mm256_permutevar8x32_epi32(table[0], codes));
+    __m256 hi = _mm256_castsi256_ps(_mm256_permutevar8x32_epi32(table[1], codes));
+    __m256 high_half = _mm256_castsi256_ps(_mm256_slli_epi32(codes, 28));
+    return _mm256_castps_si256(_mm256_blendv_ps(lo, hi, high_half));
+}
+
+// The 64-bit table has 4 vectors of 4 entries, lane i picks the 32-bit
+// halves 2 * codes[i] and 2 * codes[i] + 1 (modulo 8) from each vector,
+// bits 2 and 3 of the codes select the vector.
+static LIBDIVIDE_INLINE __m256i libdivide_dict_select64_vec256(
+    const __m256i *table, __m256i codes) {
+    __m256i idx = _mm256_shuffle_epi32(_mm256_add_epi32(codes, codes), _MM_SHUFFLE(2, 2, 0, 0));
+    idx = _mm256_add_epi32(idx, _mm256_set1_epi64x((int64_t)1 << 32));
+    __m256d e0 = _mm256_castsi256_pd(_mm256_permutevar8x32_epi32(table[0], idx));
+    __m256d e1 = _mm256_castsi256_pd(_mm256_permutevar8x32_epi32(table[1], idx));
+    __m256d e2 = _mm256_castsi256_pd(_mm256_permutevar8x32_epi32(table[2], idx));
+    __m256d e3 = _mm256_castsi256_pd(_mm256_permutevar8x32_epi32(table[3], idx));
+    __m256d bit2 = _mm256_castsi256_pd(_mm256_slli_epi64(codes, 61));
+    __m256d bit3 = _mm256_castsi256_pd(_mm256_slli_epi64(codes, 60));
+    __m256d lo = _mm256_blendv_pd(e0, e1, bit2);
+    __m256d hi = _mm256_blendv_pd(e2, e3, bit2);
+    return _mm256_castpd_si256(_mm256_blendv_pd(lo, hi, bit3));
+}
+
+// The 16 more fields fit in both 128-bit halves of one vector, they are
+// selected with a byte shuffle. The indices of the upper bytes of the lanes
+// have their top bit set so that the shuffle zeroes those bytes.
+static LIBDIVIDE_INLINE void libdivide_dict_mores32_vec256(const uint8_t *more, __m256i *table) {
+    table[0] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(const void *)more));
+}
+
+static LIBDIVIDE_INLINE void libdivide_dict_mores64_vec256(const uint8_t *more, __m256i *table) {
+    libdivide_dict_mores32_vec256(more, table);
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_dict_select_more32_vec256(
+    const __m256i *table, __m256i codes) {
+    return _mm256_shuffle_epi8(table[0], _mm256_or_si256(codes, _mm256_set1_epi32(-256)));
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_dict_select_more64_vec256(
+    const __m256i *table, __m256i codes) {
+    return _mm256_shuffle_epi8(table[0], _mm256_or_si256(codes, _mm256_set1_epi64x(-256)));
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_dict_codes32_vec256(const uint8_t *codes) {
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(const void *)codes));
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_dict_codes64_vec256(const uint8_t *codes) {
+    uint32_t c = (uint32_t)codes[0] | (uint32_t)codes[1] << 8 | (uint32_t)codes[2] << 16 |
+                 (uint32_t)codes[3] << 24;
+    return _mm256_cvtepu8_epi64(_mm_cvtsi32_si128((int)c));
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_dict_widen_u16_vec256(const uint16_t *numers) {
+    return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(const void *)numers));
+}
+
+static LIBDIVIDE_INLINE __m256i libdivide_dict_widen_s16_vec256(const int16_t *numers) {
+    return _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(const void *)numers));
+}
+
+// Stores the low 16 bits of the 32-bit lanes
+static LIBDIVIDE_INLINE void libdivide_dict_narrow_store_vec256(void *quots, __m256i q) {
+    const __m256i low_halves = _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1,
+        -1, -1, -1, 0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+    q = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(q, low_halves), 0x08);
+    _mm_storeu_si128((__m128i *)quots, _mm256_castsi256_si128(q));
+}
+
+LIBDIVIDE_DICT_VEC(u32_branchfree, uint32_t, __m256i, vec256, 32, LIBDIVIDE_LOADU_VEC256,
+    LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DICT_VEC(s32_branchfree, int32_t, __m256i, vec256, 32, LIBDIVIDE_LOADU_VEC256,
+    LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DICT_VEC(u64_branchfree, uint64_t, __m256i, vec256, 64, LIBDIVIDE_LOADU_VEC256,
+    LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DICT_VEC(s64_branchfree, int64_t, __m256i, vec256, 64, LIBDIVIDE_LOADU_VEC256,
+    LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DICT16_VEC(u16_branchfree, uint16_t, u32_branchfree, __m256i, vec256,
+    libdivide_dict_widen_u16_vec256, libdivide_dict_narrow_store_vec256)
+LIBDIVIDE_DICT16_VEC(s16_branchfree, int16_t, s32_branchfree, __m256i, vec256,
+    libdivide_dict_widen_s16_vec256, libdivide_dict_narrow_store_vec256)
+
+LIBDIVIDE_IOTA_DIVMOD_VEC(u32, uint32_t, __m256i, vec256, _mm256_set1_epi32, int32_t,
+    _mm256_add_epi32, _mm256_and_si256, _mm256_xor_si256, _mm256_cmpgt_epi32,
+    LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_IOTA_DIVMOD_VEC(u64, uint64_t, __m256i, vec256, _mm256_set1_epi64x, int64_t,
+    _mm256_add_epi64, _mm256_and_si256, _mm256_xor_si256, _mm256_cmpgt_epi64,
+    LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+
+LIBDIVIDE_DECOMPOSE_VEC(u32, uint32_t, __m256i, vec256, _mm256_set1_epi32, _mm256_mullo_epi32,
+    _mm256_add_epi32, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_DECOMPOSE_VEC(u64, uint64_t, __m256i, vec256, _mm256_set1_epi64x,
+    libdivide_mullo_u64_vec256, _mm256_add_epi64, LIBDIVIDE_LOADU_VEC256,
+    LIBDIVIDE_STOREU_VEC256)
+
+LIBDIVIDE_MODMUL_ARRAY_VEC(u32, uint32_t, __m256i, vec256, _mm256_set1_epi32, int32_t,
+    LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_MODMUL_ARRAY_VEC(u64, uint64_t, __m256i, vec256, _mm256_set1_epi64x, int64_t,
+    LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+
+LIBDIVIDE_SCALER_ARRAY_VEC(
+    u32, uint32_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+LIBDIVIDE_SCALER_ARRAY_VEC(
+    u64, uint64_t, __m256i, vec256, LIBDIVIDE_LOADU_VEC256, LIBDIVIDE_STOREU_VEC256)
+
+LIBDIVIDE_GEN_ARRAY_VEC(u32, 0, vec256)
+LIBDIVIDE_GEN_ARRAY_VEC(u32_branchfree, 1, vec256)
+
+LIBDIVIDE_AVX2_TARGET_POP
+
+#endif
+
+#if defined(LIBDIVIDE_SSE2_KERNELS)
+
+LIBDIVIDE_SSE2_TARGET_PUSH
+
+#define LIBDIVIDE_LOADU_VEC128(p) _mm_loadu_si128((const __m128i *)(const void *)(p))
+#define LIBDIVIDE_STORE_VEC128(p, v) _mm_store_si128((__m128i *)(void *)(p), v)
+#define LIBDIVIDE_STOREU_VEC128(p, v) _mm_storeu_si128((__m128i *)(void *)(p), v)
+
+LIBDIVIDE_DO_ARRAY_VEC(
+    u8, uint8_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STORE_VEC128)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s8, int8_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STORE_VEC128)
+LIBDIVIDE_DO_ARRAY_VEC(
+    u16, uint16_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STORE_VEC128)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s16, int16_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STORE_VEC128)
+LIBDIVIDE_DO_ARRAY_VEC(
+    u32, uint32_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STORE_VEC128)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s32, int32_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STORE_VEC128)
+LIBDIVIDE_DO_ARRAY_VEC(
+    u64, uint64_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STORE_VEC128)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s64, int64_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STORE_VEC128)
+LIBDIVIDE_DO_ARRAY_VEC(
+    u8_branchfree, uint8_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STORE_VEC128)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s8_branchfree, int8_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STORE_VEC128)
+LIBDIVIDE_DO_ARRAY_VEC(
+    u16_branchfree, uint16_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STORE_VEC128)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s16_branchfree, int16_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STORE_VEC128)
+LIBDIVIDE_DO_ARRAY_VEC(
+    u32_branchfree, uint32_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STORE_VEC128)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s32_branchfree, int32_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STORE_VEC128)
+LIBDIVIDE_DO_ARRAY_VEC(
+    u64_branchfree, uint64_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STORE_VEC128)
+LIBDIVIDE_DO_ARRAY_VEC(
+    s64_branchfree, int64_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STORE_VEC128)
+
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u8, uint8_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s8, int8_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u16, uint16_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s16, int16_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u32, uint32_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s32, int32_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u64, uint64_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s64, int64_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u8_branchfree, uint8_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s8_branchfree, int8_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u16_branchfree, uint16_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s16_branchfree, int16_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u32_branchfree, uint32_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s32_branchfree, int32_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    u64_branchfree, uint64_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(
+    s64_branchfree, int64_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+
+
+// SSE2 has no 64-bit comparisons, 64-bit integers use the scalar kernel.
+LIBDIVIDE_IOTA_DIVMOD_VEC(u32, uint32_t, __m128i, vec128, _mm_set1_epi32, int32_t,
+    _mm_add_epi32, _mm_and_si128, _mm_xor_si128, _mm_cmpgt_epi32, LIBDIVIDE_LOADU_VEC128,
+    LIBDIVIDE_STOREU_VEC128)
+
+LIBDIVIDE_DECOMPOSE_VEC(u32, uint32_t, __m128i, vec128, _mm_set1_epi32,
+    libdivide_mullo_u32_vec128, _mm_add_epi32, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+LIBDIVIDE_DECOMPOSE_VEC(u64, uint64_t, __m128i, vec128, _mm_set1_epi64x,
+    libdivide_mullo_u64_vec128, _mm_add_epi64, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+
+LIBDIVIDE_MODMUL_ARRAY_VEC(u32, uint32_t, __m128i, vec128, _mm_set1_epi32, int32_t,
+    LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+
+LIBDIVIDE_SCALER_ARRAY_VEC(
+    u32, uint32_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+LIBDIVIDE_SCALER_ARRAY_VEC(
+    u64, uint64_t, __m128i, vec128, LIBDIVIDE_LOADU_VEC128, LIBDIVIDE_STOREU_VEC128)
+
+LIBDIVIDE_SSE2_TARGET_POP
+
+#endif
+
+#if defined(LIBDIVIDE_NEON)
+
+LIBDIVIDE_DO_ARRAY_VEC(u16, uint16_t, uint16x8_t, vec128, vld1q_u16, vst1q_u16)
+LIBDIVIDE_DO_ARRAY_VEC(s16, int16_t, int16x8_t, vec128, vld1q_s16, vst1q_s16)
+LIBDIVIDE_DO_ARRAY_VEC(u32, uint32_t, uint32x4_t, vec128, vld1q_u32, vst1q_u32)
+LIBDIVIDE_DO_ARRAY_VEC(s32, int32_t, int32x4_t, vec128, vld1q_s32, vst1q_s32)
+LIBDIVIDE_DO_ARRAY_VEC(u64, uint64_t, uint64x2_t, vec128, vld1q_u64, vst1q_u64)
+LIBDIVIDE_DO_ARRAY_VEC(s64, int64_t, int64x2_t, vec128, vld1q_s64, vst1q_s64)
+LIBDIVIDE_DO_ARRAY_VEC(u16_branchfree, uint16_t, uint16x8_t, vec128, vld1q_u16, vst1q_u16)
+LIBDIVIDE_DO_ARRAY_VEC(s16_branchfree, int16_t, int16x8_t, vec128, vld1q_s16, vst1q_s16)
+LIBDIVIDE_DO_ARRAY_VEC(u32_branchfree, uint32_t, uint32x4_t, vec128, vld1q_u32, vst1q_u32)
+LIBDIVIDE_DO_ARRAY_VEC(s32_branchfree, int32_t, int32x4_t, vec128, vld1q_s32, vst1q_s32)
+LIBDIVIDE_DO_ARRAY_VEC(u64_branchfree, uint64_t, uint64x2_t, vec128, vld1q_u64, vst1q_u64)
+LIBDIVIDE_DO_ARRAY_VEC(s64_branchfree, int64_t, int64x2_t, vec128, vld1q_s64, vst1q_s64)
+
+LIBDIVIDE_DIVMOD_ARRAY_VEC(u16, uint16_t, uint16x8_t, vec128, vld1q_u16, vst1q_u16)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(s16, int16_t, int16x8_t, vec128, vld1q_s16, vst1q_s16)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(u32, uint32_t, uint32x4_t, vec128, vld1q_u32, vst1q_u32)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(s32, int32_t, int32x4_t, vec128, vld1q_s32, vst1q_s32)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(u64, uint64_t, uint64x2_t, vec128, vld1q_u64, vst1q_u64)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(s64, int64_t, int64x2_t, vec128, vld1q_s64, vst1q_s64)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(u16_branchfree, uint16_t, uint16x8_t, vec128, vld1q_u16, vst1q_u16)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(s16_branchfree, int16_t, int16x8_t, vec128, vld1q_s16, vst1q_s16)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(u32_branchfree, uint32_t, uint32x4_t, vec128, vld1q_u32, vst1q_u32)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(s32_branchfree, int32_t, int32x4_t, vec128, vld1q_s32, vst1q_s32)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(u64_branchfree, uint64_t, uint64x2_t, vec128, vld1q_u64, vst1q_u64)
+LIBDIVIDE_DIVMOD_ARRAY_VEC(s64_branchfree, int64_t, int64x2_t, vec128, vld1q_s64, vst1q_s64)
+
+// NEON has no 64-bit multiplication, 64-bit indices use the scalar kernel.
+LIBDIVIDE_DECOMPOSE_VEC(
+    u32, uint32_t, uint32x4_t, vec128, vdupq_n_u32, vmulq_u32, vaddq_u32, vld1q_u32, vst1q_u32)
+
+#endif
+
+LIBDIVIDE_DO_ARRAY_SCALAR(u8, uint8_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(s8, int8_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(u16, uint16_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(s16, int16_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(u32, uint32_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(s32, int32_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(u64, uint64_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(s64, int64_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(u8_branchfree, uint8_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(s8_branchfree, int8_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(u16_branchfree, uint16_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(s16_branchfree, int16_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(u32_branchfree, uint32_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(s32_branchfree, int32_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(u64_branchfree, uint64_t)
+LIBDIVIDE_DO_ARRAY_SCALAR(s64_branchfree, int64_t)
+
+// Select the widest kernel for each integer width. For 8-bit and 16-bit
+// integers AVX512 is skipped because its kernels are not vectorized.
+#if defined(LIBDIVIDE_X86_DISPATCH)
+
+// Generates NAME_dispatch() which calls the kernel of the instruction set
+// returned by libdivide_get_isa().
+#define LIBDIVIDE_ARRAY_DISPATCH(NAME, VEC512, PARAMS, ARGS) \
+    static LIBDIVIDE_INLINE size_t NAME##_dispatch PARAMS {  \
+        switch (libdivide_get_isa()) {                       \
+            case LIBDIVIDE_ISA_AVX512:                       \
+                return NAME##_##VEC512 ARGS;                 \
+            case LIBDIVIDE_ISA_AVX2:                         \
+                return NAME##_vec256 ARGS;                   \
+            case LIBDIVIDE_ISA_SSE2:                         \
+                return NAME##_vec128 ARGS;                   \
+            default:                                         \
+                return NAME##_scalar ARGS;                   \
+        }                                                    \
+    }
+
+#define LIBDIVIDE_DO_ARRAY_DISPATCH(ALGO, IntT, DO_VEC512, DIVMOD_VEC512)       \
+    LIBDIVIDE_ARRAY_DISPATCH(libdivide_##ALGO##_do_array, DO_VEC512,            \
+        (const IntT *numers, IntT *quots, size_t count,                         \
+            const struct libdivide_##ALGO##_t *denom),                          \
+        (numers, quots, count, denom))                                          \
+    LIBDIVIDE_ARRAY_DISPATCH(libdivide_##ALGO##_remainder_array, DIVMOD_VEC512, \
+        (const IntT *numers, IntT *rems, size_t count, IntT d,                  \
+            const struct libdivide_##ALGO##_t *denom),                          \
+        (numers, rems, count, d, denom))                                        \
+    LIBDIVIDE_ARRAY_DISPATCH(libdivide_##ALGO##_divmod_array, DIVMOD_VEC512,    \
+        (const IntT *numers, IntT *quots, IntT *rems, size_t count, IntT d,     \
+            const struct libdivide_##ALGO##_t *denom),                          \
+        (numers, quots, rems, count, d, denom))
+
+LIBDIVIDE_DO_ARRAY_DISPATCH(u8, uint8_t, vec256, vec256)
+LIBDIVIDE_DO_ARRAY_DISPATCH(s8, int8_t, vec256, vec256)
+LIBDIVIDE_DO_ARRAY_DISPATCH(u16, uint16_t, vec256, vec256)
+LIBDIVIDE_DO_ARRAY_DISPATCH(s16, int16_t, vec256, vec256)
+LIBDIVIDE_DO_ARRAY_DISPATCH(u32, uint32_t, vec512_masked, vec512)
+LIBDIVIDE_DO_ARRAY_DISPATCH(s32, int32_t, vec512_masked, vec512)
+LIBDIVIDE_DO_ARRAY_DISPATCH(u64, uint64_t, vec512_masked, vec512)
+LIBDIVIDE_DO_ARRAY_DISPATCH(s64, int64_t, vec512_masked, vec512)
+LIBDIVIDE_DO_ARRAY_DISPATCH(u8_branchfree, uint8_t, vec256, vec256)
+LIBDIVIDE_DO_ARRAY_DISPATCH(s8_branchfree, int8_t, vec256, vec256)
+LIBDIVIDE_DO_ARRAY_DISPATCH(u16_branchfree, uint16_t, vec256, vec256)
+LIBDIVIDE_DO_ARRAY_DISPATCH(s16_branchfree, int16_t, vec256, vec256)
+LIBDIVIDE_DO_ARRAY_DISPATCH(u32_branchfree, uint32_t, vec512_masked, vec512)
+LIBDIVIDE_DO_ARRAY_DISPATCH(s32_branchfree, int32_t, vec512_masked, vec512)
+LIBDIVIDE_DO_ARRAY_DISPATCH(u64_branchfree, uint64_t, vec512_masked, vec512)
+LIBDIVIDE_DO_ARRAY_DISPATCH(s64_branchfree, int64_t, vec512_masked, vec512)
+
+#define LIBDIVIDE_DO_ARRAY_8 dispatch
+#define LIBDIVIDE_DO_ARRAY_16 dispatch
+#define LIBDIVIDE_DO_ARRAY_32_64 dispatch
+#define LIBDIVIDE_DIVMOD_ARRAY_8 dispatch
+#define LIBDIVIDE_DIVMOD_ARRAY_16 dispatch
+#define LIBDIVIDE_DIVMOD_ARRAY_32_64 dispatch
+#else
+
+// There are no NEON kernels for 8-bit integers.
+#if defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_DO_ARRAY_8 vec256
+#elif defined(LIBDIVIDE_SSE2)
+#define LIBDIVIDE_DO_ARRAY_8 vec128
+#else
+#define LIBDIVIDE_DO_ARRAY_8 scalar
+#endif
+
+#if defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_DO_ARRAY_16 vec256
+#elif defined(LIBDIVIDE_SSE2) || defined(LIBDIVIDE_NEON)
+#define LIBDIVIDE_DO_ARRAY_16 vec128
+#else
+#define LIBDIVIDE_DO_ARRAY_16 scalar
+#endif
+
+#if defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_DO_ARRAY_32_64 vec512_masked
+#elif defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_DO_ARRAY_32_64 vec256
+#elif defined(LIBDIVIDE_SSE2) || defined(LIBDIVIDE_NEON)
+#define LIBDIVIDE_DO_ARRAY_32_64 vec128
+#else
+#define LIBDIVIDE_DO_ARRAY_32_64 scalar
+#endif
+
+#define LIBDIVIDE_DIVMOD_ARRAY_8 LIBDIVIDE_DO_ARRAY_8
+#define LIBDIVIDE_DIVMOD_ARRAY_16 LIBDIVIDE_DO_ARRAY_16
+#if defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_DIVMOD_ARRAY_32_64 vec512
+#else
+#define LIBDIVIDE_DIVMOD_ARRAY_32_64 LIBDIVIDE_DO_ARRAY_32_64
+#endif
+
+#endif
+
+LIBDIVIDE_DO_ARRAY_GEN(u8, uint8_t, LIBDIVIDE_DO_ARRAY_8, LIBDIVIDE_DIVMOD_ARRAY_8)
+LIBDIVIDE_DO_ARRAY_GEN(s8, int8_t, LIBDIVIDE_DO_ARRAY_8, LIBDIVIDE_DIVMOD_ARRAY_8)
+LIBDIVIDE_DO_ARRAY_GEN(u16, uint16_t, LIBDIVIDE_DO_ARRAY_16, LIBDIVIDE_DIVMOD_ARRAY_16)
+LIBDIVIDE_DO_ARRAY_GEN(s16, int16_t, LIBDIVIDE_DO_ARRAY_16, LIBDIVIDE_DIVMOD_ARRAY_16)
+LIBDIVIDE_DO_ARRAY_GEN(u32, uint32_t, LIBDIVIDE_DO_ARRAY_32_64, LIBDIVIDE_DIVMOD_ARRAY_32_64)
+LIBDIVIDE_DO_ARRAY_GEN(s32, int32_t, LIBDIVIDE_DO_ARRAY_32_64, LIBDIVIDE_DIVMOD_ARRAY_32_64)
+LIBDIVIDE_DO_ARRAY_GEN(u64, uint64_t, LIBDIVIDE_DO_ARRAY_32_64, LIBDIVIDE_DIVMOD_ARRAY_32_64)
+LIBDIVIDE_DO_ARRAY_GEN(s64, int64_t, LIBDIVIDE_DO_ARRAY_32_64, LIBDIVIDE_DIVMOD_ARRAY_32_64)
+LIBDIVIDE_DO_ARRAY_GEN(u8_branchfree, uint8_t, LIBDIVIDE_DO_ARRAY_8, LIBDIVIDE_DIVMOD_ARRAY_8)
+LIBDIVIDE_DO_ARRAY_GEN(s8_branchfree, int8_t, LIBDIVIDE_DO_ARRAY_8, LIBDIVIDE_DIVMOD_ARRAY_8)
+LIBDIVIDE_DO_ARRAY_GEN(u16_branchfree, uint16_t, LIBDIVIDE_DO_ARRAY_16, LIBDIVIDE_DIVMOD_ARRAY_16)
+LIBDIVIDE_DO_ARRAY_GEN(s16_branchfree, int16_t, LIBDIVIDE_DO_ARRAY_16, LIBDIVIDE_DIVMOD_ARRAY_16)
+LIBDIVIDE_DO_ARRAY_GEN(
+    u32_branchfree, uint32_t, LIBDIVIDE_DO_ARRAY_32_64, LIBDIVIDE_DIVMOD_ARRAY_32_64)
+LIBDIVIDE_DO_ARRAY_GEN(
+    s32_branchfree, int32_t, LIBDIVIDE_DO_ARRAY_32_64, LIBDIVIDE_DIVMOD_ARRAY_32_64)
+LIBDIVIDE_DO_ARRAY_GEN(
+    u64_branchfree, uint64_t, LIBDIVIDE_DO_ARRAY_32_64, LIBDIVIDE_DIVMOD_ARRAY_32_64)
+LIBDIVIDE_DO_ARRAY_GEN(
+    s64_branchfree, int64_t, LIBDIVIDE_DO_ARRAY_32_64, LIBDIVIDE_DIVMOD_ARRAY_32_64)
+
+////////// Bulk division by run-length encoded divisors
+
+// The do_runs functions divide numerators by divisors that change rarely,
+// e.g. per partition scale factors. The divisors are run-length encoded:
+// the first lengths[0] numerators are divided by denoms[0], the next
+// lengths[1] numerators by denoms[1] and so on. numers and quots may point
+// to the same array. A divider is generated once per run and the run is
+// divided by the do_array kernels. Generating a divider costs about as
+// much as a few hardware divisions, so runs shorter than
+// LIBDIVIDE_SHORT_RUN elements are divided by the hardware instead.
+// INT_MIN / -1 wraps in both cases, a divisor of 0 is an error in both
+// cases, as in libdivide_<ALGO>_gen(), rather than a hardware trap.
+#if !defined(LIBDIVIDE_SHORT_RUN)
+#define LIBDIVIDE_SHORT_RUN 8
+#endif
+
+#define LIBDIVIDE_DO_RUNS_GEN(ALGO, IntT, UIntT, IS_SIGNED)                                   \
+    void libdivide_##ALGO##_do_runs(const IntT *numers, IntT *quots, const uint32_t *lengths, \
+        const IntT *denoms, size_t run_count) {                                               \
+        for (size_t r = 0; r < run_count; r++) {                                              \
+            size_t length = lengths[r];                                                       \
+            IntT d = denoms[r];                                                               \
+            if (d == 0) {                                                                     \
+                LIBDIVIDE_ERROR("divider must be != 0");                                      \
+            }                                                                                 \
+            if (length >= LIBDIVIDE_SHORT_RUN) {                                              \
+                struct libdivide_##ALGO##_t denom = libdivide_##ALGO##_gen(d);                \
+                libdivide_##ALGO##_do_array(numers, quots, length, &denom);                   \
+            } else if (IS_SIGNED && d == (IntT)-1) {                                          \
+                for (size_t i = 0; i < length; i++) {                                         \
+                    quots[i] = (IntT)(0 - (UIntT)numers[i]);                                  \
+                }                                                                             \
+            } else {                                                                          \
+                for (size_t i = 0; i < length; i++) {                                         \
+                    quots[i] = (IntT)(numers[i] / d);                                         \
+                }                                                                             \
+            }                                                                                 \
+            numers += length;                                                                 \
+            quots += length;                                                                  \
+        }                                                                                     \
+    }
+
+LIBDIVIDE_DO_RUNS_GEN(u8, uint8_t, uint8_t, 0)
+LIBDIVIDE_DO_RUNS_GEN(s8, int8_t, uint8_t, 1)
+LIBDIVIDE_DO_RUNS_GEN(u16, uint16_t, uint16_t, 0)
+LIBDIVIDE_DO_RUNS_GEN(s16, int16_t, uint16_t, 1)
+LIBDIVIDE_DO_RUNS_GEN(u32, uint32_t, uint32_t, 0)
+LIBDIVIDE_DO_RUNS_GEN(s32, int32_t, uint32_t, 1)
+LIBDIVIDE_DO_RUNS_GEN(u64, uint64_t, uint64_t, 0)
+LIBDIVIDE_DO_RUNS_GEN(s64, int64_t, uint64_t, 1)
+
+////////// Bulk division by per-element dividers
+
+// The do_each functions divide numers[i] by the branchfree divider denoms[i]
+// and store the quotients in quots. The do_each_strided variants read the
+// divider of element i at (const char *)denoms + i * stride, e.g. from an
+// array of records. numers and quots may point to the same array.
+//
+// The AVX512 and AVX2 kernels gather the magic numbers and the more fields
+// of the dividers into vectors and use variable shifts, so they are only
+// available for 32-bit and 64-bit integers. SSE2 has no variable shifts,
+// 8-bit and 16-bit integers and SSE2 use the scalar loop.
+
+#define LIBDIVIDE_DO_EACH_SCALAR(ALGO, IntT)                                                   \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_do_each_scalar(const IntT *numers,       \
+        IntT *quots, size_t count, const struct libdivide_##ALGO##_t *denoms, size_t stride) { \
+        const char *p = (const char *)denoms;                                                  \
+        for (size_t i = 0; i < count; i++, p += stride) {                                      \
+            quots[i] = libdivide_##ALGO##_do(                                                  \
+                numers[i], (const struct libdivide_##ALGO##_t *)(const void *)p);              \
+        }                                                                                      \
+        return count;                                                                          \
+    }
+
+LIBDIVIDE_DO_EACH_SCALAR(u8_branchfree, uint8_t)
+LIBDIVIDE_DO_EACH_SCALAR(s8_branchfree, int8_t)
+LIBDIVIDE_DO_EACH_SCALAR(u16_branchfree, uint16_t)
+LIBDIVIDE_DO_EACH_SCALAR(s16_branchfree, int16_t)
+LIBDIVIDE_DO_EACH_SCALAR(u32_branchfree, uint32_t)
+LIBDIVIDE_DO_EACH_SCALAR(s32_branchfree, int32_t)
+LIBDIVIDE_DO_EACH_SCALAR(u64_branchfree, uint64_t)
+LIBDIVIDE_DO_EACH_SCALAR(s64_branchfree, int64_t)
+
+#if defined(LIBDIVIDE_X86_DISPATCH)
+
+#define LIBDIVIDE_DO_EACH_DISPATCH(ALGO, IntT)                                                  \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_do_each_dispatch(const IntT *numers,      \
+        IntT *quots, size_t count, const struct libdivide_##ALGO##_t *denoms, size_t stride) {  \
+        switch (libdivide_get_isa()) {                                                          \
+            case LIBDIVIDE_ISA_AVX512:                                                          \
+                return libdivide_##ALGO##_do_each_vec512(numers, quots, count, denoms, stride); \
+            case LIBDIVIDE_ISA_AVX2:                                                            \
+                return libdivide_##ALGO##_do_each_vec256(numers, quots, count, denoms, stride); \
+            default:                                                                            \
+                return libdivide_##ALGO##_do_each_scalar(numers, quots, count, denoms, stride); \
+        }                                                                                       \
+    }
+
+LIBDIVIDE_DO_EACH_DISPATCH(u32_branchfree, uint32_t)
+LIBDIVIDE_DO_EACH_DISPATCH(s32_branchfree, int32_t)
+LIBDIVIDE_DO_EACH_DISPATCH(u64_branchfree, uint64_t)
+LIBDIVIDE_DO_EACH_DISPATCH(s64_branchfree, int64_t)
+
+#define LIBDIVIDE_DO_EACH_32_64 dispatch
+#elif defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_DO_EACH_32_64 vec512
+#elif defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_DO_EACH_32_64 vec256
+#else
+#define LIBDIVIDE_DO_EACH_32_64 scalar
+#endif
+
+// Generates the public libdivide_<ALGO>_do_each() and do_each_strided()
+// functions on top of the kernel selected by SUFFIX.
+#define LIBDIVIDE_DO_EACH_GEN(ALGO, IntT, SUFFIX)                                              \
+    void libdivide_##ALGO##_do_each_strided(const IntT *numers, IntT *quots, size_t count,     \
+        const struct libdivide_##ALGO##_t *denoms, size_t stride) {                            \
+        size_t i = LIBDIVIDE_ARRAY_KERNEL(libdivide_##ALGO##_do_each, SUFFIX)(                 \
+            numers, quots, count, denoms, stride);                                             \
+        if (i < count) {                                                                       \
+            const struct libdivide_##ALGO##_t *tail =                                          \
+                (const struct libdivide_##ALGO##_t *)(const void *)((const char *)denoms +     \
+                                                                    i * stride);               \
+            libdivide_##ALGO##_do_each_scalar(numers + i, quots + i, count - i, tail, stride); \
+        }                                                                                      \
+    }                                                                                          \
+    void libdivide_##ALGO##_do_each(const IntT *numers, IntT *quots, size_t count,             \
+        const struct libdivide_##ALGO##_t *denoms) {                                           \
+        libdivide_##ALGO##_do_each_strided(numers, quots, count, denoms, sizeof(*denoms));     \
+    }
+
+LIBDIVIDE_DO_EACH_GEN(u8_branchfree, uint8_t, scalar)
+LIBDIVIDE_DO_EACH_GEN(s8_branchfree, int8_t, scalar)
+LIBDIVIDE_DO_EACH_GEN(u16_branchfree, uint16_t, scalar)
+LIBDIVIDE_DO_EACH_GEN(s16_branchfree, int16_t, scalar)
+LIBDIVIDE_DO_EACH_GEN(u32_branchfree, uint32_t, LIBDIVIDE_DO_EACH_32_64)
+LIBDIVIDE_DO_EACH_GEN(s32_branchfree, int32_t, LIBDIVIDE_DO_EACH_32_64)
+LIBDIVIDE_DO_EACH_GEN(u64_branchfree, uint64_t, LIBDIVIDE_DO_EACH_32_64)
+LIBDIVIDE_DO_EACH_GEN(s64_branchfree, int64_t, LIBDIVIDE_DO_EACH_32_64)
+
+// The do_by_each functions divide numer by each of the branchfree dividers
+// in denoms, using the same kernels as do_each with the numerator broadcast
+// to all the lanes, e.g. for trial division.
+
+#define LIBDIVIDE_DO_BY_EACH_SCALAR(ALGO, IntT)                                                  \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_do_by_each_scalar(IntT numer, IntT *quots, \
+        size_t count, const struct libdivide_##ALGO##_t *denoms, size_t stride) {                \
+        const char *p = (const char *)denoms;                                                    \
+        for (size_t i = 0; i < count; i++, p += stride) {                                        \
+            quots[i] = libdivide_##ALGO##_do(                                                    \
+                numer, (const struct libdivide_##ALGO##_t *)(const void *)p);                    \
+        }                                                                                        \
+        return count;                                                                            \
+    }
+
+LIBDIVIDE_DO_BY_EACH_SCALAR(u8_branchfree, uint8_t)
+LIBDIVIDE_DO_BY_EACH_SCALAR(s8_branchfree, int8_t)
+LIBDIVIDE_DO_BY_EACH_SCALAR(u16_branchfree, uint16_t)
+LIBDIVIDE_DO_BY_EACH_SCALAR(s16_branchfree, int16_t)
+LIBDIVIDE_DO_BY_EACH_SCALAR(u32_branchfree, uint32_t)
+LIBDIVIDE_DO_BY_EACH_SCALAR(s32_branchfree, int32_t)
+LIBDIVIDE_DO_BY_EACH_SCALAR(u64_branchfree, uint64_t)
+LIBDIVIDE_DO_BY_EACH_SCALAR(s64_branchfree, int64_t)
+
+#if defined(LIBDIVIDE_X86_DISPATCH)
+
+#define LIBDIVIDE_DO_BY_EACH_DISPATCH(ALGO, IntT)                                                 \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_do_by_each_dispatch(IntT numer,             \
+        IntT *quots, size_t count, const struct libdivide_##ALGO##_t *denoms, size_t stride) {    \
+        switch (libdivide_get_isa()) {                                                            \
+            case LIBDIVIDE_ISA_AVX512:                                                            \
+                return libdivide_##ALGO##_do_by_each_vec512(numer, quots, count, denoms, stride); \
+            case LIBDIVIDE_ISA_AVX2:                                                              \
+                return libdivide_##ALGO##_do_by_each_vec256(numer, quots, count, denoms, stride); \
+            default:                                                                              \
+                return libdivide_##ALGO##_do_by_each_scalar(numer, quots, count, denoms, stride); \
+        }                                                                                         \
+    }
+
+LIBDIVIDE_DO_BY_EACH_DISPATCH(u32_branchfree, uint32_t)
+LIBDIVIDE_DO_BY_EACH_DISPATCH(s32_branchfree, int32_t)
+LIBDIVIDE_DO_BY_EACH_DISPATCH(u64_branchfree, uint64_t)
+LIBDIVIDE_DO_BY_EACH_DISPATCH(s64_branchfree, int64_t)
+
+#endif
+
+// Generates the public libdivide_<ALGO>_do_by_each() and
+// do_by_each_strided() functions on top of the kernel selected by SUFFIX.
+#define LIBDIVIDE_DO_BY_EACH_GEN(ALGO, IntT, SUFFIX)                                         \
+    void libdivide_##ALGO##_do_by_each_strided(IntT numer, IntT *quots, size_t count,        \
+        const struct libdivide_##ALGO##_t *denoms, size_t stride) {                          \
+        size_t i = LIBDIVIDE_ARRAY_KERNEL(libdivide_##ALGO##_do_by_each, SUFFIX)(            \
+            numer, quots, count, denoms, stride);                                            \
+        if (i < count) {                                                                     \
+            const struct libdivide_##ALGO##_t *tail =                                        \
+                (const struct libdivide_##ALGO##_t *)(const void *)((const char *)denoms +   \
+                                                                    i * stride);             \
+            libdivide_##ALGO##_do_by_each_scalar(numer, quots + i, count - i, tail, stride); \
+        }                                                                                    \
+    }                                                                                        \
+    void libdivide_##ALGO##_do_by_each(                                                      \
+        IntT numer, IntT *quots, size_t count, const struct libdivide_##ALGO##_t *denoms) {  \
+        libdivide_##ALGO##_do_by_each_strided(numer, quots, count, denoms, sizeof(*denoms)); \
+    }
+
+LIBDIVIDE_DO_BY_EACH_GEN(u8_branchfree, uint8_t, scalar)
+LIBDIVIDE_DO_BY_EACH_GEN(s8_branchfree, int8_t, scalar)
+LIBDIVIDE_DO_BY_EACH_GEN(u16_branchfree, uint16_t, scalar)
+LIBDIVIDE_DO_BY_EACH_GEN(s16_branchfree, int16_t, scalar)
+LIBDIVIDE_DO_BY_EACH_GEN(u32_branchfree, uint32_t, LIBDIVIDE_DO_EACH_32_64)
+LIBDIVIDE_DO_BY_EACH_GEN(s32_branchfree, int32_t, LIBDIVIDE_DO_EACH_32_64)
+LIBDIVIDE_DO_BY_EACH_GEN(u64_branchfree, uint64_t, LIBDIVIDE_DO_EACH_32_64)
+LIBDIVIDE_DO_BY_EACH_GEN(s64_branchfree, int64_t, LIBDIVIDE_DO_EACH_32_64)
+
+////////// Bulk division by dictionary dividers
+
+// The dict_do_array functions divide numers[i] by the divider number
+// codes[i] of a dictionary and store the quotients in quots, numers and
+// quots may point to the same array. The codes must be less than the number
+// of dividers of the dictionary. The AVX512 and AVX2 kernels exist for all
+// the dictionaries, SSE2 has no variable shuffles and shifts and uses the
+// scalar loop. The AVX2 kernels of the 64-bit dictionaries are bound by the
+// emulated 64-bit high multiply and were slower than the scalar loop, so the
+// bulk functions use the scalar loop for them.
+
+#define LIBDIVIDE_DICT_SCALAR(ALGO, IntT)                                                      \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_dict_do_array_scalar(const IntT *numers, \
+        const uint8_t *codes, IntT *quots, size_t count,                                       \
+        const struct libdivide_##ALGO##_dict_t *dict) {                                        \
+        for (size_t i = 0; i < count; i++) {                                                   \
+            quots[i] = libdivide_##ALGO##_dict_do(numers[i], codes[i], dict);                  \
+        }                                                                                      \
+        return count;                                                                          \
+    }
+
+LIBDIVIDE_DICT_SCALAR(u16_branchfree, uint16_t)
+LIBDIVIDE_DICT_SCALAR(s16_branchfree, int16_t)
+LIBDIVIDE_DICT_SCALAR(u32_branchfree, uint32_t)
+LIBDIVIDE_DICT_SCALAR(s32_branchfree, int32_t)
+LIBDIVIDE_DICT_SCALAR(u64_branchfree, uint64_t)
+LIBDIVIDE_DICT_SCALAR(s64_branchfree, int64_t)
+
+#if defined(LIBDIVIDE_X86_DISPATCH)
+
+#define LIBDIVIDE_DICT_DISPATCH(ALGO, IntT, AVX2)                                                  \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_dict_do_array_dispatch(const IntT *numers,   \
+        const uint8_t *codes, IntT *quots, size_t count,                                           \
+        const struct libdivide_##ALGO##_dict_t *dict) {                                            \
+        switch (libdivide_get_isa()) {                                                             \
+            case LIBDIVIDE_ISA_AVX512:                                                             \
+                return libdivide_##ALGO##_dict_do_array_vec512(numers, codes, quots, count, dict); \
+            case LIBDIVIDE_ISA_AVX2:                                                               \
+                return libdivide_##ALGO##_dict_do_array_##AVX2(numers, codes, quots, count, dict); \
+            default:                                                                               \
+                return libdivide_##ALGO##_dict_do_array_scalar(numers, codes, quots, count, dict); \
+        }                                                                                          \
+    }
+
+LIBDIVIDE_DICT_DISPATCH(u16_branchfree, uint16_t, vec256)
+LIBDIVIDE_DICT_DISPATCH(s16_branchfree, int16_t, vec256)
+LIBDIVIDE_DICT_DISPATCH(u32_branchfree, uint32_t, vec256)
+LIBDIVIDE_DICT_DISPATCH(s32_branchfree, int32_t, vec256)
+LIBDIVIDE_DICT_DISPATCH(u64_branchfree, uint64_t, scalar)
+LIBDIVIDE_DICT_DISPATCH(s64_branchfree, int64_t, scalar)
+
+#define LIBDIVIDE_DICT_16_32 dispatch
+#define LIBDIVIDE_DICT_64 dispatch
+#elif defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_DICT_16_32 vec512
+#define LIBDIVIDE_DICT_64 vec512
+#elif defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_DICT_16_32 vec256
+#define LIBDIVIDE_DICT_64 scalar
+#else
+#define LIBDIVIDE_DICT_16_32 scalar
+#define LIBDIVIDE_DICT_64 scalar
+#endif
+
+// Generates the public libdivide_<ALGO>_dict_do_array() function on top of
+// the kernel selected by SUFFIX.
+#define LIBDIVIDE_DICT_ARRAY_GEN(ALGO, IntT, SUFFIX)                                 \
+    void libdivide_##ALGO##_dict_do_array(const IntT *numers, const uint8_t *codes,  \
+        IntT *quots, size_t count, const struct libdivide_##ALGO##_dict_t *dict) {   \
+        size_t i = LIBDIVIDE_ARRAY_KERNEL(libdivide_##ALGO##_dict_do_array, SUFFIX)( \
+            numers, codes, quots, count, dict);                                      \
+        libdivide_##ALGO##_dict_do_array_scalar(                                     \
+            numers + i, codes + i, quots + i, count - i, dict);                      \
+    }
+
+LIBDIVIDE_DICT_ARRAY_GEN(u16_branchfree, uint16_t, LIBDIVIDE_DICT_16_32)
+LIBDIVIDE_DICT_ARRAY_GEN(s16_branchfree, int16_t, LIBDIVIDE_DICT_16_32)
+LIBDIVIDE_DICT_ARRAY_GEN(u32_branchfree, uint32_t, LIBDIVIDE_DICT_16_32)
+LIBDIVIDE_DICT_ARRAY_GEN(s32_branchfree, int32_t, LIBDIVIDE_DICT_16_32)
+LIBDIVIDE_DICT_ARRAY_GEN(u64_branchfree, uint64_t, LIBDIVIDE_DICT_64)
+LIBDIVIDE_DICT_ARRAY_GEN(s64_branchfree, int64_t, LIBDIVIDE_DICT_64)
+
+////////// Bulk division by dividers from a table
+
+// The do_table_array functions divide numers[i] by the divider number
+// indices[i] of a table stored as separate arrays of magic numbers and more
+// fields, as in libdivide::divider_table, and store the quotients in quots.
+// numers and quots may point to the same array. The vector kernels gather
+// the more fields as lane sized words, mores must be readable for 7 bytes
+// past the last divider. The gathers treat the indices as signed 32-bit
+// integers, so they must be less than 2^31.
+//
+// As for do_each, only the branchfree dividers of 32-bit and 64-bit
+// integers have AVX512 and AVX2 kernels, the other ones use the scalar loop.
+
+#define LIBDIVIDE_DO_TABLE_SCALAR(ALGO, IntT)                                                   \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_do_table_array_scalar(const IntT *numers, \
+        const uint32_t *indices, IntT *quots, size_t count, const IntT *magics,                 \
+        const uint8_t *mores) {                                                                 \
+        for (size_t i = 0; i < count; i++) {                                                    \
+            struct libdivide_##ALGO##_t denom;                                                  \
+            denom.magic = magics[indices[i]];                                                   \
+            denom.more = mores[indices[i]];                                                     \
+            quots[i] = libdivide_##ALGO##_do(numers[i], &denom);                                \
+        }                                                                                       \
+        return count;                                                                           \
+    }
+
+LIBDIVIDE_DO_TABLE_SCALAR(u8, uint8_t)
+LIBDIVIDE_DO_TABLE_SCALAR(s8, int8_t)
+LIBDIVIDE_DO_TABLE_SCALAR(u16, uint16_t)
+LIBDIVIDE_DO_TABLE_SCALAR(s16, int16_t)
+LIBDIVIDE_DO_TABLE_SCALAR(u32, uint32_t)
+LIBDIVIDE_DO_TABLE_SCALAR(s32, int32_t)
+LIBDIVIDE_DO_TABLE_SCALAR(u64, uint64_t)
+LIBDIVIDE_DO_TABLE_SCALAR(s64, int64_t)
+LIBDIVIDE_DO_TABLE_SCALAR(u8_branchfree, uint8_t)
+LIBDIVIDE_DO_TABLE_SCALAR(s8_branchfree, int8_t)
+LIBDIVIDE_DO_TABLE_SCALAR(u16_branchfree, uint16_t)
+LIBDIVIDE_DO_TABLE_SCALAR(s16_branchfree, int16_t)
+LIBDIVIDE_DO_TABLE_SCALAR(u32_branchfree, uint32_t)
+LIBDIVIDE_DO_TABLE_SCALAR(s32_branchfree, int32_t)
+LIBDIVIDE_DO_TABLE_SCALAR(u64_branchfree, uint64_t)
+LIBDIVIDE_DO_TABLE_SCALAR(s64_branchfree, int64_t)
+
+#if defined(LIBDIVIDE_X86_DISPATCH)
+
+#define LIBDIVIDE_DO_TABLE_DISPATCH(ALGO, IntT)                                                   \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_do_table_array_dispatch(const IntT *numers, \
+        const uint32_t *indices, IntT *quots, size_t count, const IntT *magics,                   \
+        const uint8_t *mores) {                                                                   \
+        switch (libdivide_get_isa()) {                                                            \
+            case LIBDIVIDE_ISA_AVX512:                                                            \
+                return libdivide_##ALGO##_do_table_array_vec512(                                  \
+                    numers, indices, quots, count, magics, mores);                                \
+            case LIBDIVIDE_ISA_AVX2:                                                              \
+                return libdivide_##ALGO##_do_table_array_vec256(                                  \
+                    numers, indices, quots, count, magics, mores);                                \
+            default:                                                                              \
+                return libdivide_##ALGO##_do_table_array_scalar(                                  \
+                    numers, indices, quots, count, magics, mores);                                \
+        }                                                                                         \
+    }
+
+LIBDIVIDE_DO_TABLE_DISPATCH(u32_branchfree, uint32_t)
+LIBDIVIDE_DO_TABLE_DISPATCH(s32_branchfree, int32_t)
+LIBDIVIDE_DO_TABLE_DISPATCH(u64_branchfree, uint64_t)
+LIBDIVIDE_DO_TABLE_DISPATCH(s64_branchfree, int64_t)
+
+#endif
+
+// Generates the public libdivide_<ALGO>_do_table_array() function on top
+// of the kernel selected by SUFFIX.
+#define LIBDIVIDE_DO_TABLE_GEN(ALGO, IntT, SUFFIX)                                      \
+    void libdivide_##ALGO##_do_table_array(const IntT *numers, const uint32_t *indices, \
+        IntT *quots, size_t count, const IntT *magics, const uint8_t *mores) {          \
+        for (size_t j = 0; j < count; j++) {                                            \
+            LIBDIVIDE_ASSERT(indices[j] <= INT32_MAX);                                  \
+        }                                                                               \
+        size_t i = LIBDIVIDE_ARRAY_KERNEL(libdivide_##ALGO##_do_table_array, SUFFIX)(   \
+            numers, indices, quots, count, magics, mores);                              \
+        libdivide_##ALGO##_do_table_array_scalar(                                       \
+            numers + i, indices + i, quots + i, count - i, magics, mores);              \
+    }
+
+LIBDIVIDE_DO_TABLE_GEN(u8, uint8_t, scalar)
+LIBDIVIDE_DO_TABLE_GEN(s8, int8_t, scalar)
+LIBDIVIDE_DO_TABLE_GEN(u16, uint16_t, scalar)
+LIBDIVIDE_DO_TABLE_GEN(s16, int16_t, scalar)
+LIBDIVIDE_DO_TABLE_GEN(u32, uint32_t, scalar)
+LIBDIVIDE_DO_TABLE_GEN(s32, int32_t, scalar)
+LIBDIVIDE_DO_TABLE_GEN(u64, uint64_t, scalar)
+LIBDIVIDE_DO_TABLE_GEN(s64, int64_t, scalar)
+LIBDIVIDE_DO_TABLE_GEN(u8_branchfree, uint8_t, scalar)
+LIBDIVIDE_DO_TABLE_GEN(s8_branchfree, int8_t, scalar)
+LIBDIVIDE_DO_TABLE_GEN(u16_branchfree, uint16_t, scalar)
+LIBDIVIDE_DO_TABLE_GEN(s16_branchfree, int16_t, scalar)
+LIBDIVIDE_DO_TABLE_GEN(u32_branchfree, uint32_t, LIBDIVIDE_DO_EACH_32_64)
+LIBDIVIDE_DO_TABLE_GEN(s32_branchfree, int32_t, LIBDIVIDE_DO_EACH_32_64)
+LIBDIVIDE_DO_TABLE_GEN(u64_branchfree, uint64_t, LIBDIVIDE_DO_EACH_32_64)
+LIBDIVIDE_DO_TABLE_GEN(s64_branchfree, int64_t, LIBDIVIDE_DO_EACH_32_64)
+
+////////// Bulk divider generation
+
+// The gen_array functions generate the dividers by divisors[0], ...,
+// divisors[count - 1] and store them as separate arrays of magic numbers
+// and more fields, as in libdivide::divider_table. The results are the
+// same as those of libdivide_<ALGO>_gen(), e.g. for building tables of
+// many divisors at startup.
+//
+// The 32-bit unsigned dividers have AVX512 and AVX2 kernels which replace
+// the 64 / 32 bit hardware division by a double precision division of 8
+// divisors at once. 64-bit magic numbers need 128-bit dividends, these and
+// the other dividers use the scalar loop.
+
+#define LIBDIVIDE_GEN_ARRAY_SCALAR(ALGO, IntT)                                       \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_gen_array_scalar(              \
+        const IntT *divisors, IntT *magics, uint8_t *mores, size_t count) {          \
+        for (size_t i = 0; i < count; i++) {                                         \
+            struct libdivide_##ALGO##_t denom = libdivide_##ALGO##_gen(divisors[i]); \
+            magics[i] = denom.magic;                                                 \
+            mores[i] = denom.more;                                                   \
+        }                                                                            \
+        return count;                                                                \
+    }
+
+LIBDIVIDE_GEN_ARRAY_SCALAR(u8, uint8_t)
+LIBDIVIDE_GEN_ARRAY_SCALAR(s8, int8_t)
+LIBDIVIDE_GEN_ARRAY_SCALAR(u16, uint16_t)
+LIBDIVIDE_GEN_ARRAY_SCALAR(s16, int16_t)
+LIBDIVIDE_GEN_ARRAY_SCALAR(u32, uint32_t)
+LIBDIVIDE_GEN_ARRAY_SCALAR(s32, int32_t)
+LIBDIVIDE_GEN_ARRAY_SCALAR(u64, uint64_t)
+LIBDIVIDE_GEN_ARRAY_SCALAR(s64, int64_t)
+LIBDIVIDE_GEN_ARRAY_SCALAR(u8_branchfree, uint8_t)
+LIBDIVIDE_GEN_ARRAY_SCALAR(s8_branchfree, int8_t)
+LIBDIVIDE_GEN_ARRAY_SCALAR(u16_branchfree, uint16_t)
+LIBDIVIDE_GEN_ARRAY_SCALAR(s16_branchfree, int16_t)
+LIBDIVIDE_GEN_ARRAY_SCALAR(u32_branchfree, uint32_t)
+LIBDIVIDE_GEN_ARRAY_SCALAR(s32_branchfree, int32_t)
+LIBDIVIDE_GEN_ARRAY_SCALAR(u64_branchfree, uint64_t)
+LIBDIVIDE_GEN_ARRAY_SCALAR(s64_branchfree, int64_t)
+
+#if defined(LIBDIVIDE_X86_DISPATCH)
+
+#define LIBDIVIDE_GEN_ARRAY_DISPATCH(ALGO)                                                  \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_gen_array_dispatch(                   \
+        const uint32_t *divisors, uint32_t *magics, uint8_t *mores, size_t count) {         \
+        switch (libdivide_get_isa()) {                                                      \
+            case LIBDIVIDE_ISA_AVX512:                                                      \
+                return libdivide_##ALGO##_gen_array_vec512(divisors, magics, mores, count); \
+            case LIBDIVIDE_ISA_AVX2:                                                        \
+                return libdivide_##ALGO##_gen_array_vec256(divisors, magics, mores, count); \
+            default:                                                                        \
+                return libdivide_##ALGO##_gen_array_scalar(divisors, magics, mores, count); \
+        }                                                                                   \
+    }
+
+LIBDIVIDE_GEN_ARRAY_DISPATCH(u32)
+LIBDIVIDE_GEN_ARRAY_DISPATCH(u32_branchfree)
+
+#endif
+
+// Generates the public libdivide_<ALGO>_gen_array() function on top of
+// the kernel selected by SUFFIX.
+#define LIBDIVIDE_GEN_ARRAY_GEN(ALGO, IntT, SUFFIX)                                          \
+    void libdivide_##ALGO##_gen_array(                                                       \
+        const IntT *divisors, IntT *magics, uint8_t *mores, size_t count) {                  \
+        size_t i = LIBDIVIDE_ARRAY_KERNEL(libdivide_##ALGO##_gen_array, SUFFIX)(             \
+            divisors, magics, mores, count);                                                 \
+        libdivide_##ALGO##_gen_array_scalar(divisors + i, magics + i, mores + i, count - i); \
+    }
+
+LIBDIVIDE_GEN_ARRAY_GEN(u8, uint8_t, scalar)
+LIBDIVIDE_GEN_ARRAY_GEN(s8, int8_t, scalar)
+LIBDIVIDE_GEN_ARRAY_GEN(u16, uint16_t, scalar)
+LIBDIVIDE_GEN_ARRAY_GEN(s16, int16_t, scalar)
+LIBDIVIDE_GEN_ARRAY_GEN(u32, uint32_t, LIBDIVIDE_DO_EACH_32_64)
+LIBDIVIDE_GEN_ARRAY_GEN(s32, int32_t, scalar)
+LIBDIVIDE_GEN_ARRAY_GEN(u64, uint64_t, scalar)
+LIBDIVIDE_GEN_ARRAY_GEN(s64, int64_t, scalar)
+LIBDIVIDE_GEN_ARRAY_GEN(u8_branchfree, uint8_t, scalar)
+LIBDIVIDE_GEN_ARRAY_GEN(s8_branchfree, int8_t, scalar)
+LIBDIVIDE_GEN_ARRAY_GEN(u16_branchfree, uint16_t, scalar)
+LIBDIVIDE_GEN_ARRAY_GEN(s16_branchfree, int16_t, scalar)
+LIBDIVIDE_GEN_ARRAY_GEN(u32_branchfree, uint32_t, LIBDIVIDE_DO_EACH_32_64)
+LIBDIVIDE_GEN_ARRAY_GEN(s32_branchfree, int32_t, scalar)
+LIBDIVIDE_GEN_ARRAY_GEN(u64_branchfree, uint64_t, scalar)
+LIBDIVIDE_GEN_ARRAY_GEN(s64_branchfree, int64_t, scalar)
+
+////////// Strided quotients and remainders
+
+// The iota_divmod functions compute the quotients and remainders of the
+// numerators start + i * step by d for i < count, e.g. the rows and columns
+// of flat indices, where the numerators wrap around like unsigned integers.
+// Only the first numerator of each lane is divided, the next ones are
+// updated incrementally. The vector kernels exist for 32-bit integers and,
+// except for SSE2 which has no 64-bit comparisons, 64-bit integers.
+
+#if defined(LIBDIVIDE_X86_DISPATCH)
+
+LIBDIVIDE_ARRAY_DISPATCH(libdivide_u32_iota_divmod, vec512,
+    (uint32_t start, uint32_t step, size_t count, uint32_t d,
+        const struct libdivide_u32_t *denom, uint32_t *quots, uint32_t *rems),
+    (start, step, count, d, denom, quots, rems))
+
+static LIBDIVIDE_INLINE size_t libdivide_u64_iota_divmod_dispatch(uint64_t start, uint64_t step,
+    size_t count, uint64_t d, const struct libdivide_u64_t *denom, uint64_t *quots,
+    uint64_t *rems) {
+    switch (libdivide_get_isa()) {
+        case LIBDIVIDE_ISA_AVX512:
+            return libdivide_u64_iota_divmod_vec512(start, step, count, d, denom, quots, rems);
+        case LIBDIVIDE_ISA_AVX2:
+            return libdivide_u64_iota_divmod_vec256(start, step, count, d, denom, quots, rems);
+        default:
+            return libdivide_u64_iota_divmod_scalar(start, step, count, d, denom, quots, rems);
+    }
+}
+
+#define LIBDIVIDE_IOTA_32 dispatch
+#define LIBDIVIDE_IOTA_64 dispatch
+#elif defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_IOTA_32 vec512
+#define LIBDIVIDE_IOTA_64 vec512
+#elif defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_IOTA_32 vec256
+#define LIBDIVIDE_IOTA_64 vec256
+#elif defined(LIBDIVIDE_SSE2)
+#define LIBDIVIDE_IOTA_32 vec128
+#define LIBDIVIDE_IOTA_64 scalar
+#else
+#define LIBDIVIDE_IOTA_32 scalar
+#define LIBDIVIDE_IOTA_64 scalar
+#endif
+
+// Generates the public libdivide_<ALGO>_iota_divmod() function on top of
+// the kernel selected by SUFFIX. The kernels are called once per run of
+// numerators up to the next wrap around. If the numerators wrap around at
+// least every 256 elements they are divided by divmod_array() instead.
+#define LIBDIVIDE_IOTA_DIVMOD_GEN(ALGO, IntT, SUFFIX)                                   \
+    void libdivide_##ALGO##_iota_divmod(                                                \
+        IntT start, IntT step, size_t count, IntT d, IntT *quots, IntT *rems) {         \
+        struct libdivide_##ALGO##_t denom = libdivide_##ALGO##_gen(d);                  \
+        if (step > (IntT)((IntT)-1 / 256)) {                                            \
+            for (size_t i = 0; i < count; i++) {                                        \
+                quots[i] = (IntT)(start + (IntT)i * step);                              \
+            }                                                                           \
+            libdivide_##ALGO##_divmod_array(quots, quots, rems, count, d, &denom);      \
+            return;                                                                     \
+        }                                                                               \
+        while (count > 0) {                                                             \
+            size_t length = count;                                                      \
+            if (step != 0) {                                                            \
+                IntT steps_left = (IntT)((IntT)((IntT)-1 - start) / step);              \
+                if ((uint64_t)steps_left < (uint64_t)(count - 1)) {                     \
+                    length = (size_t)steps_left + 1;                                    \
+                }                                                                       \
+            }                                                                           \
+            size_t i = LIBDIVIDE_ARRAY_KERNEL(libdivide_##ALGO##_iota_divmod, SUFFIX)(  \
+                start, step, length, d, &denom, quots, rems);                           \
+            libdivide_##ALGO##_iota_divmod_scalar((IntT)(start + (IntT)i * step), step, \
+                length - i, d, &denom, quots + i, rems + i);                            \
+            start = (IntT)(start + (IntT)length * step);                                \
+            quots += length;                                                            \
+            rems += length;                                                             \
+            count -= length;                                                            \
+        }                                                                               \
+    }
+
+LIBDIVIDE_IOTA_DIVMOD_GEN(u8, uint8_t, scalar)
+LIBDIVIDE_IOTA_DIVMOD_GEN(u16, uint16_t, scalar)
+LIBDIVIDE_IOTA_DIVMOD_GEN(u32, uint32_t, LIBDIVIDE_IOTA_32)
+LIBDIVIDE_IOTA_DIVMOD_GEN(u64, uint64_t, LIBDIVIDE_IOTA_64)
+
+////////// Tensor index decomposition
+
+// The decompose functions split linear indices into the coordinates of a
+// row-major tensor of rank dimensions with the given extents, i.e. the
+// index is ((c[0] * extents[1] + c[1]) * extents[2] + c[2]) ... The
+// coordinates are computed from the innermost dimension outwards, each one
+// is the remainder of a division by its extent. denoms[k] must be
+// libdivide_<algo>_gen(extents[k]) for 0 < k < rank, extents[0] and
+// denoms[0] are not used, as the outermost coordinate is the quotient left
+// over. rank must be at least 1. decompose_array() stores coordinate k of
+// indices[i] in coords[k][i].
+//
+// The remap functions decompose the indices and recombine the coordinates
+// with other strides, out[i] = c[0] * strides[0] + ... + c[rank - 1] *
+// strides[rank - 1], as for transposing or permuting the dimensions of a
+// tensor. indices and out may point to the same array.
+
+#define LIBDIVIDE_DECOMPOSE_SCALAR(ALGO, IntT)                                                \
+    void libdivide_##ALGO##_decompose(IntT index, const IntT *extents,                        \
+        const struct libdivide_##ALGO##_t *denoms, size_t rank, IntT *coords) {               \
+        for (size_t k = rank - 1; k > 0; k--) {                                               \
+            IntT q = libdivide_##ALGO##_do(index, &denoms[k]);                                \
+            coords[k] = (IntT)(index - q * extents[k]);                                       \
+            index = q;                                                                        \
+        }                                                                                     \
+        coords[0] = index;                                                                    \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE void libdivide_##ALGO##_decompose_range(const IntT *indices,      \
+        size_t begin, size_t end, const IntT *extents,                                        \
+        const struct libdivide_##ALGO##_t *denoms, size_t rank, IntT *const *coords) {        \
+        for (size_t i = begin; i < end; i++) {                                                \
+            IntT index = indices[i];                                                          \
+            for (size_t k = rank - 1; k > 0; k--) {                                           \
+                IntT q = libdivide_##ALGO##_do(index, &denoms[k]);                            \
+                coords[k][i] = (IntT)(index - q * extents[k]);                                \
+                index = q;                                                                    \
+            }                                                                                 \
+            coords[0][i] = index;                                                             \
+        }                                                                                     \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_decompose_array_scalar(                 \
+        const IntT *indices, size_t count, const IntT *extents,                               \
+        const struct libdivide_##ALGO##_t *denoms, size_t rank, IntT *const *coords) {        \
+        libdivide_##ALGO##_decompose_range(indices, 0, count, extents, denoms, rank, coords); \
+        return count;                                                                         \
+    }                                                                                         \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_remap_array_scalar(const IntT *indices, \
+        size_t count, const IntT *extents, const struct libdivide_##ALGO##_t *denoms,         \
+        size_t rank, const IntT *strides, IntT *out) {                                        \
+        for (size_t i = 0; i < count; i++) {                                                  \
+            IntT index = indices[i];                                                          \
+            IntT sum = 0;                                                                     \
+            for (size_t k = rank - 1; k > 0; k--) {                                           \
+                IntT q = libdivide_##ALGO##_do(index, &denoms[k]);                            \
+                sum = (IntT)(sum + (IntT)(index - q * extents[k]) * strides[k]);              \
+                index = q;                                                                    \
+            }                                                                                 \
+            out[i] = (IntT)(sum + index * strides[0]);                                        \
+        }                                                                                     \
+        return count;                                                                         \
+    }
+
+LIBDIVIDE_DECOMPOSE_SCALAR(u32, uint32_t)
+LIBDIVIDE_DECOMPOSE_SCALAR(u64, uint64_t)
+
+#if defined(LIBDIVIDE_X86_DISPATCH)
+
+#define LIBDIVIDE_DECOMPOSE_DISPATCH(ALGO, IntT)                                          \
+    LIBDIVIDE_ARRAY_DISPATCH(libdivide_##ALGO##_decompose_array, vec512,                  \
+        (const IntT *indices, size_t count, const IntT *extents,                          \
+            const struct libdivide_##ALGO##_t *denoms, size_t rank, IntT *const *coords), \
+        (indices, count, extents, denoms, rank, coords))                                  \
+    LIBDIVIDE_ARRAY_DISPATCH(libdivide_##ALGO##_remap_array, vec512,                      \
+        (const IntT *indices, size_t count, const IntT *extents,                          \
+            const struct libdivide_##ALGO##_t *denoms, size_t rank, const IntT *strides,  \
+            IntT *out),                                                                   \
+        (indices, count, extents, denoms, rank, strides, out))
+
+LIBDIVIDE_DECOMPOSE_DISPATCH(u32, uint32_t)
+LIBDIVIDE_DECOMPOSE_DISPATCH(u64, uint64_t)
+
+#define LIBDIVIDE_DECOMPOSE_32 dispatch
+#define LIBDIVIDE_DECOMPOSE_64 dispatch
+#elif defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_DECOMPOSE_32 vec512
+#define LIBDIVIDE_DECOMPOSE_64 vec512
+#elif defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_DECOMPOSE_32 vec256
+#define LIBDIVIDE_DECOMPOSE_64 vec256
+#elif defined(LIBDIVIDE_SSE2)
+#define LIBDIVIDE_DECOMPOSE_32 vec128
+#define LIBDIVIDE_DECOMPOSE_64 vec128
+#elif defined(LIBDIVIDE_NEON)
+#define LIBDIVIDE_DECOMPOSE_32 vec128
+#define LIBDIVIDE_DECOMPOSE_64 scalar
+#else
+#define LIBDIVIDE_DECOMPOSE_32 scalar
+#define LIBDIVIDE_DECOMPOSE_64 scalar
+#endif
+
+// Generates the public libdivide_<ALGO>_decompose_array() and
+// libdivide_<ALGO>_remap_array() functions on top of the kernels selected
+// by SUFFIX.
+#define LIBDIVIDE_DECOMPOSE_GEN(ALGO, IntT, SUFFIX)                                    \
+    void libdivide_##ALGO##_decompose_array(const IntT *indices, size_t count,         \
+        const IntT *extents, const struct libdivide_##ALGO##_t *denoms, size_t rank,   \
+        IntT *const *coords) {                                                         \
+        size_t i = LIBDIVIDE_ARRAY_KERNEL(libdivide_##ALGO##_decompose_array, SUFFIX)( \
+            indices, count, extents, denoms, rank, coords);                            \
+        libdivide_##ALGO##_decompose_range(                                            \
+            indices, i, count, extents, denoms, rank, coords);                         \
+    }                                                                                  \
+    void libdivide_##ALGO##_remap_array(const IntT *indices, size_t count,             \
+        const IntT *extents, const struct libdivide_##ALGO##_t *denoms, size_t rank,   \
+        const IntT *strides, IntT *out) {                                              \
+        size_t i = LIBDIVIDE_ARRAY_KERNEL(libdivide_##ALGO##_remap_array, SUFFIX)(     \
+            indices, count, extents, denoms, rank, strides, out);                      \
+        libdivide_##ALGO##_remap_array_scalar(                                         \
+            indices + i, count - i, extents, denoms, rank, strides, out + i);          \
+    }
+
+
+LIBDIVIDE_DECOMPOSE_GEN(u32, uint32_t, LIBDIVIDE_DECOMPOSE_32)
+LIBDIVIDE_DECOMPOSE_GEN(u64, uint64_t, LIBDIVIDE_DECOMPOSE_64)
+
+////////// Modular arithmetic arrays
+
+// The array functions compute c[i] = a[i] * b[i], a[i] + b[i] and a[i] -
+// b[i] modulo the modulus of the reducer, and powers[i] = bases[i]^exp mod
+// m, e.g. for number theoretic transforms and polynomial hashing. The
+// elements of a and b must be less than m, the bases may be any integers.
+// The vector kernels compute the products in Montgomery form, with an even
+// modulus mulmod and powmod use the scalar Barrett reduction. The outputs
+// may be the same arrays as the inputs.
+
+#define LIBDIVIDE_MODMUL_ARRAY_SCALAR(ALGO, IntT)                                            \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_mulmod_array_scalar(const IntT *a,     \
+        const IntT *b, IntT *c, size_t count,                                                \
+        const struct libdivide_##ALGO##_reducer_t *reducer) {                                \
+        for (size_t i = 0; i < count; i++) {                                                 \
+            c[i] = libdivide_##ALGO##_mulmod(a[i], b[i], reducer);                           \
+        }                                                                                    \
+        return count;                                                                        \
+    }                                                                                        \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_addmod_array_scalar(const IntT *a,     \
+        const IntT *b, IntT *c, size_t count,                                                \
+        const struct libdivide_##ALGO##_reducer_t *reducer) {                                \
+        for (size_t i = 0; i < count; i++) {                                                 \
+            c[i] = libdivide_##ALGO##_addmod(a[i], b[i], reducer);                           \
+        }                                                                                    \
+        return count;                                                                        \
+    }                                                                                        \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_submod_array_scalar(const IntT *a,     \
+        const IntT *b, IntT *c, size_t count,                                                \
+        const struct libdivide_##ALGO##_reducer_t *reducer) {                                \
+        for (size_t i = 0; i < count; i++) {                                                 \
+            c[i] = libdivide_##ALGO##_submod(a[i], b[i], reducer);                           \
+        }                                                                                    \
+        return count;                                                                        \
+    }                                                                                        \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_powmod_array_scalar(const IntT *bases, \
+        IntT *powers, size_t count, uint64_t exp,                                            \
+        const struct libdivide_##ALGO##_reducer_t *reducer) {                                \
+        for (size_t i = 0; i < count; i++) {                                                 \
+            powers[i] = libdivide_##ALGO##_powmod(bases[i], exp, reducer);                   \
+        }                                                                                    \
+        return count;                                                                        \
+    }
+
+LIBDIVIDE_MODMUL_ARRAY_SCALAR(u32, uint32_t)
+LIBDIVIDE_MODMUL_ARRAY_SCALAR(u64, uint64_t)
+
+#if defined(LIBDIVIDE_X86_DISPATCH)
+
+// Like LIBDIVIDE_ARRAY_DISPATCH(), VEC128 is scalar for 64-bit integers.
+#define LIBDIVIDE_MODMUL_DISPATCH(NAME, VEC128, PARAMS, ARGS) \
+    static LIBDIVIDE_INLINE size_t NAME##_dispatch PARAMS {   \
+        switch (libdivide_get_isa()) {                        \
+            case LIBDIVIDE_ISA_AVX512:                        \
+                return NAME##_vec512 ARGS;                    \
+            case LIBDIVIDE_ISA_AVX2:                          \
+                return NAME##_vec256 ARGS;                    \
+            case LIBDIVIDE_ISA_SSE2:                          \
+                return NAME##_##VEC128 ARGS;                  \
+            default:                                          \
+                return NAME##_scalar ARGS;                    \
+        }                                                     \
+    }
+
+#define LIBDIVIDE_MODMUL_ARRAY_DISPATCH(ALGO, IntT, VEC128)            \
+    LIBDIVIDE_MODMUL_DISPATCH(libdivide_##ALGO##_mulmod_array, VEC128, \
+        (const IntT *a, const IntT *b, IntT *c, size_t count,          \
+            const struct libdivide_##ALGO##_reducer_t *reducer),       \
+        (a, b, c, count, reducer))                                     \
+    LIBDIVIDE_MODMUL_DISPATCH(libdivide_##ALGO##_addmod_array, VEC128, \
+        (const IntT *a, const IntT *b, IntT *c, size_t count,          \
+            const struct libdivide_##ALGO##_reducer_t *reducer),       \
+        (a, b, c, count, reducer))                                     \
+    LIBDIVIDE_MODMUL_DISPATCH(libdivide_##ALGO##_submod_array, VEC128, \
+        (const IntT *a, const IntT *b, IntT *c, size_t count,          \
+            const struct libdivide_##ALGO##_reducer_t *reducer),       \
+        (a, b, c, count, reducer))                                     \
+    LIBDIVIDE_MODMUL_DISPATCH(libdivide_##ALGO##_powmod_array, VEC128, \
+        (const IntT *bases, IntT *powers, size_t count, uint64_t exp,  \
+            const struct libdivide_##ALGO##_reducer_t *reducer),       \
+        (bases, powers, count, exp, reducer))
+
+LIBDIVIDE_MODMUL_ARRAY_DISPATCH(u32, uint32_t, vec128)
+LIBDIVIDE_MODMUL_ARRAY_DISPATCH(u64, uint64_t, scalar)
+
+#define LIBDIVIDE_MODMUL_32 dispatch
+#define LIBDIVIDE_MODMUL_64 dispatch
+#elif defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_MODMUL_32 vec512
+#define LIBDIVIDE_MODMUL_64 vec512
+#elif defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_MODMUL_32 vec256
+#define LIBDIVIDE_MODMUL_64 vec256
+#elif defined(LIBDIVIDE_SSE2)
+#define LIBDIVIDE_MODMUL_32 vec128
+#define LIBDIVIDE_MODMUL_64 scalar
+#else
+#define LIBDIVIDE_MODMUL_32 scalar
+#define LIBDIVIDE_MODMUL_64 scalar
+#endif
+
+// Generates the public modular arithmetic array functions on top of the
+// kernels selected by SUFFIX.
+#define LIBDIVIDE_MODMUL_ARRAY_GEN(ALGO, IntT, SUFFIX)                                        \
+    void libdivide_##ALGO##_mulmod_array(const IntT *a, const IntT *b, IntT *c, size_t count, \
+        const struct libdivide_##ALGO##_reducer_t *reducer) {                                 \
+        size_t i = LIBDIVIDE_ARRAY_KERNEL(libdivide_##ALGO##_mulmod_array, SUFFIX)(           \
+            a, b, c, count, reducer);                                                         \
+        libdivide_##ALGO##_mulmod_array_scalar(a + i, b + i, c + i, count - i, reducer);      \
+    }                                                                                         \
+    void libdivide_##ALGO##_addmod_array(const IntT *a, const IntT *b, IntT *c, size_t count, \
+        const struct libdivide_##ALGO##_reducer_t *reducer) {                                 \
+        size_t i = LIBDIVIDE_ARRAY_KERNEL(libdivide_##ALGO##_addmod_array, SUFFIX)(           \
+            a, b, c, count, reducer);                                                         \
+        libdivide_##ALGO##_addmod_array_scalar(a + i, b + i, c + i, count - i, reducer);      \
+    }                                                                                         \
+    void libdivide_##ALGO##_submod_array(const IntT *a, const IntT *b, IntT *c, size_t count, \
+        const struct libdivide_##ALGO##_reducer_t *reducer) {                                 \
+        size_t i = LIBDIVIDE_ARRAY_KERNEL(libdivide_##ALGO##_submod_array, SUFFIX)(           \
+            a, b, c, count, reducer);                                                         \
+        libdivide_##ALGO##_submod_array_scalar(a + i, b + i, c + i, count - i, reducer);      \
+    }                                                                                         \
+    void libdivide_##ALGO##_powmod_array(const IntT *bases, IntT *powers, size_t count,       \
+        uint64_t exp, const struct libdivide_##ALGO##_reducer_t *reducer) {                   \
+        size_t i = LIBDIVIDE_ARRAY_KERNEL(libdivide_##ALGO##_powmod_array, SUFFIX)(           \
+            bases, powers, count, exp, reducer);                                              \
+        libdivide_##ALGO##_powmod_array_scalar(                                               \
+            bases + i, powers + i, count - i, exp, reducer);                                  \
+    }
+
+LIBDIVIDE_MODMUL_ARRAY_GEN(u32, uint32_t, LIBDIVIDE_MODMUL_32)
+LIBDIVIDE_MODMUL_ARRAY_GEN(u64, uint64_t, LIBDIVIDE_MODMUL_64)
+
+////////// Rational scaling arrays
+
+// results[i] = x[i] * num / den for i < count, e.g. to convert audio
+// samples or timestamps. The SIMD kernels process all vectors, the scalar
+// kernel the remaining elements. results may be the same array as x.
+
+#define LIBDIVIDE_SCALER_ARRAY_SCALAR(ALGO, IntT)                                           \
+    static LIBDIVIDE_INLINE size_t libdivide_##ALGO##_scaler_do_array_scalar(const IntT *x, \
+        IntT *results, size_t count, const struct libdivide_##ALGO##_scaler_t *scaler) {    \
+        for (size_t i = 0; i < count; i++) {                                                \
+            results[i] = libdivide_##ALGO##_scaler_do(x[i], scaler);                        \
+        }                                                                                   \
+        return count;                                                                       \
+    }
+
+LIBDIVIDE_SCALER_ARRAY_SCALAR(u32, uint32_t)
+LIBDIVIDE_SCALER_ARRAY_SCALAR(u64, uint64_t)
+
+#if defined(LIBDIVIDE_X86_DISPATCH)
+
+#define LIBDIVIDE_SCALER_DISPATCH(ALGO, IntT)                            \
+    LIBDIVIDE_ARRAY_DISPATCH(libdivide_##ALGO##_scaler_do_array, vec512, \
+        (const IntT *x, IntT *results, size_t count,                     \
+            const struct libdivide_##ALGO##_scaler_t *scaler),           \
+        (x, results, count, scaler))
+
+LIBDIVIDE_SCALER_DISPATCH(u32, uint32_t)
+LIBDIVIDE_SCALER_DISPATCH(u64, uint64_t)
+
+#define LIBDIVIDE_SCALER_32 dispatch
+#define LIBDIVIDE_SCALER_64 dispatch
+#elif defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_SCALER_32 vec512
+#define LIBDIVIDE_SCALER_64 vec512
+#elif defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_SCALER_32 vec256
+#define LIBDIVIDE_SCALER_64 vec256
+#elif defined(LIBDIVIDE_SSE2)
+#define LIBDIVIDE_SCALER_32 vec128
+#define LIBDIVIDE_SCALER_64 vec128
+#else
+#define LIBDIVIDE_SCALER_32 scalar
+#define LIBDIVIDE_SCALER_64 scalar
+#endif
+
+// Generates the public libdivide_<ALGO>_scaler_do_array() on top of the
+// kernel selected by SUFFIX.
+#define LIBDIVIDE_SCALER_ARRAY_GEN(ALGO, IntT, SUFFIX)                                    \
+    void libdivide_##ALGO##_scaler_do_array(const IntT *x, IntT *results, size_t count,   \
+        const struct libdivide_##ALGO##_scaler_t *scaler) {                               \
+        size_t i = LIBDIVIDE_ARRAY_KERNEL(libdivide_##ALGO##_scaler_do_array, SUFFIX)(    \
+            x, results, count, scaler);                                                   \
+        libdivide_##ALGO##_scaler_do_array_scalar(x + i, results + i, count - i, scaler); \
+    }
+
+LIBDIVIDE_SCALER_ARRAY_GEN(u32, uint32_t, LIBDIVIDE_SCALER_32)
+LIBDIVIDE_SCALER_ARRAY_GEN(u64, uint64_t, LIBDIVIDE_SCALER_64)
+
+////////// C++ stuff
+
+#ifdef __cplusplus
+
+enum Branching {
+    BRANCHFULL,  // use branching algorithms
+    BRANCHFREE   // use branchfree algorithms
+};
+
+// Rounding modes of rounding_divider, muldiv_divider and rational_scaler
+enum Rounding {
+    ROUND_FLOOR = LIBDIVIDE_ROUND_FLOOR,    // toward -infinity
+    ROUND_CEIL = LIBDIVIDE_ROUND_CEIL,      // toward +infinity
+    ROUND_EUCLID = LIBDIVIDE_ROUND_EUCLID,  // such that the remainder is >= 0
+    ROUND_NEAREST = LIBDIVIDE_ROUND_NEAREST  // halfway cases away from zero, not rounding_divider
+};
+
+namespace detail {
+enum Signedness {
+    SIGNED,
+    UNSIGNED,
+};
+
+#if defined(LIBDIVIDE_NEON)
+// Helper to deduce NEON vector type for integral type.
+template <int _WIDTH, Signedness _SIGN>
+struct NeonVec {};
+
+// There are no NEON kernels for 8-bit integers, the types only declare
+// the vector methods of divider<int8_t> and divider<uint8_t>.
+template <>
+struct NeonVec<8, UNSIGNED> {
+    typedef uint8x16_t type;
+};
+
+template <>
+struct NeonVec<8, SIGNED> {
+    typedef int8x16_t type;
+};
+
+template <>
+struct NeonVec<16, UNSIGNED> {
+    typedef uint16x8_t type;
+};
+
+template <>
+struct NeonVec<16, SIGNED> {
+    typedef int16x8_t type;
+};
+
+template <>
+struct NeonVec<32, UNSIGNED> {
+    typedef uint32x4_t type;
+};
+
+template <>
+struct NeonVec<32, SIGNED> {
+    typedef int32x4_t type;
+};
+
+template <>
+struct NeonVec<64, UNSIGNED> {
+    typedef uint64x2_t type;
+};
+
+template <>
+struct NeonVec<64, SIGNED> {
+    typedef int64x2_t type;
+};
+
+template <typename T>
+struct NeonVecFor {
+    // See 'class divider' for an explanation of these template parameters.
+    typedef typename NeonVec<sizeof(T) * 8, (((T)0 >> 0) > (T)(-1) ? SIGNED : UNSIGNED)>::type type;
+};
+
+#define LIBDIVIDE_DIVIDE_NEON(ALGO, INT_TYPE)                                           \
+    LIBDIVIDE_INLINE typename NeonVecFor<INT_TYPE>::type divide(                        \
+        typename NeonVecFor<INT_TYPE>::type n) const {                                  \
+        return libdivide_##ALGO##_do_vec128(n, &denom);                                 \
+    }                                                                                   \
+    LIBDIVIDE_INLINE typename NeonVecFor<INT_TYPE>::type remainder(                     \
+        typename NeonVecFor<INT_TYPE>::type n) const {                                  \
+        return libdivide_##ALGO##_remainder_vec128(n, divisor, &denom);                 \
+    }                                                                                   \
+    LIBDIVIDE_INLINE void divmod(typename NeonVecFor<INT_TYPE>::type n,                 \
+        typename NeonVecFor<INT_TYPE>::type *q, typename NeonVecFor<INT_TYPE>::type *r) \
+        const {                                                                         \
+        *q = libdivide_##ALGO##_divmod_vec128(n, divisor, &denom, r);                   \
+    }
+#else
+#define LIBDIVIDE_DIVIDE_NEON(ALGO, INT_TYPE)
+#endif
+
+#if defined(LIBDIVIDE_SVE)
+// Helper to deduce SVE vector type for integral type.
+template <int _WIDTH, Signedness _SIGN>
+struct SveVec {};
+
+// Like NeonVec, there are no SVE kernels for 8-bit integers.
+template <>
+struct SveVec<8, UNSIGNED> {
+    typedef svuint8_t type;
+};
+
+template <>
+struct SveVec<8, SIGNED> {
+    typedef svint8_t type;
+};
+
+template <>
+struct SveVec<16, UNSIGNED> {
+    typedef svuint16_t type;
+};
+
+template <>
+struct SveVec<16, SIGNED> {
+    typedef svint16_t type;
+};
+
+template <>
+struct SveVec<32, UNSIGNED> {
+    typedef svuint32_t type;
+};
+
+template <>
+struct SveVec<32, SIGNED> {
+    typedef svint32_t type;
+};
+
+template <>
+struct SveVec<64, UNSIGNED> {
+    typedef svuint64_t type;
+};
+
+template <>
+struct SveVec<64, SIGNED> {
+    typedef svint64_t type;
+};
+
+template <typename T>
+struct SveVecFor {
+    // See 'class divider' for an explanation of these template parameters.
+    typedef typename SveVec<sizeof(T) * 8, (((T)0 >> 0) > (T)(-1) ? SIGNED : UNSIGNED)>::type type;
+};
+
+#define LIBDIVIDE_DIVIDE_SVE(ALGO, INT_TYPE)                    \
+    LIBDIVIDE_INLINE typename SveVecFor<INT_TYPE>::type divide( \
+        typename SveVecFor<INT_TYPE>::type n) const {           \
+        return libdivide_##ALGO##_do_sve(n, &denom);            \
+    }
+#else
+#define LIBDIVIDE_DIVIDE_SVE(ALGO, INT_TYPE)
+#endif
+
+#if defined(LIBDIVIDE_SSE2)
+#define LIBDIVIDE_DIVIDE_SSE2(ALGO)                                         \
+    LIBDIVIDE_INLINE __m128i divide(__m128i n) const {                      \
+        return libdivide_##ALGO##_do_vec128(n, &denom);                     \
+    }                                                                       \
+    LIBDIVIDE_INLINE __m128i remainder(__m128i n) const {                   \
+        return libdivide_##ALGO##_remainder_vec128(n, divisor, &denom);     \
+    }                                                                       \
+    LIBDIVIDE_INLINE void divmod(__m128i n, __m128i *q, __m128i *r) const { \
+        *q = libdivide_##ALGO##_divmod_vec128(n, divisor, &denom, r);       \
+    }
+#else
+#define LIBDIVIDE_DIVIDE_SSE2(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_DIVIDE_AVX2(ALGO)                                         \
+    LIBDIVIDE_INLINE __m256i divide(__m256i n) const {                      \
+        return libdivide_##ALGO##_do_vec256(n, &denom);                     \
+    }                                                                       \
+    LIBDIVIDE_INLINE __m256i remainder(__m256i n) const {                   \
+        return libdivide_##ALGO##_remainder_vec256(n, divisor, &denom);     \
+    }                                                                       \
+    LIBDIVIDE_INLINE void divmod(__m256i n, __m256i *q, __m256i *r) const { \
+        *q = libdivide_##ALGO##_divmod_vec256(n, divisor, &denom, r);       \
+    }
+#else
+#define LIBDIVIDE_DIVIDE_AVX2(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_DIVIDE_AVX512(ALGO)                                       \
+    LIBDIVIDE_INLINE __m512i divide(__m512i n) const {                      \
+        return libdivide_##ALGO##_do_vec512(n, &denom);                     \
+    }                                                                       \
+    LIBDIVIDE_INLINE __m512i remainder(__m512i n) const {                   \
+        return libdivide_##ALGO##_remainder_vec512(n, divisor, &denom);     \
+    }                                                                       \
+    LIBDIVIDE_INLINE void divmod(__m512i n, __m512i *q, __m512i *r) const { \
+        *q = libdivide_##ALGO##_divmod_vec512(n, divisor, &denom, r);       \
+    }
+#else
+#define LIBDIVIDE_DIVIDE_AVX512(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_SSE2)
+#define LIBDIVIDE_FASTMOD_SSE2(ALGO)                                      \
+    LIBDIVIDE_INLINE __m128i mod(__m128i n) const {                       \
+        return libdivide_##ALGO##_fastmod_mod_vec128(n, &denom);          \
+    }                                                                     \
+    LIBDIVIDE_INLINE __m128i is_divisible(__m128i n) const {              \
+        return libdivide_##ALGO##_fastmod_is_divisible_vec128(n, &denom); \
+    }
+#else
+#define LIBDIVIDE_FASTMOD_SSE2(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_FASTMOD_AVX2(ALGO)                                      \
+    LIBDIVIDE_INLINE __m256i mod(__m256i n) const {                       \
+        return libdivide_##ALGO##_fastmod_mod_vec256(n, &denom);          \
+    }                                                                     \
+    LIBDIVIDE_INLINE __m256i is_divisible(__m256i n) const {              \
+        return libdivide_##ALGO##_fastmod_is_divisible_vec256(n, &denom); \
+    }
+#else
+#define LIBDIVIDE_FASTMOD_AVX2(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_FASTMOD_AVX512(ALGO)                                    \
+    LIBDIVIDE_INLINE __m512i mod(__m512i n) const {                       \
+        return libdivide_##ALGO##_fastmod_mod_vec512(n, &denom);          \
+    }                                                                     \
+    LIBDIVIDE_INLINE __m512i is_divisible(__m512i n) const {              \
+        return libdivide_##ALGO##_fastmod_is_divisible_vec512(n, &denom); \
+    }
+#else
+#define LIBDIVIDE_FASTMOD_AVX512(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_NEON)
+#define LIBDIVIDE_EXACT_NEON(ALGO, INT_TYPE)                     \
+    LIBDIVIDE_INLINE typename NeonVecFor<INT_TYPE>::type divide( \
+        typename NeonVecFor<INT_TYPE>::type n) const {           \
+        return libdivide_##ALGO##_exact_do_vec128(n, &denom);    \
+    }
+#else
+#define LIBDIVIDE_EXACT_NEON(ALGO, INT_TYPE)
+#endif
+
+#if defined(LIBDIVIDE_SSE2)
+#define LIBDIVIDE_EXACT_SSE2(ALGO)                            \
+    LIBDIVIDE_INLINE __m128i divide(__m128i n) const {        \
+        return libdivide_##ALGO##_exact_do_vec128(n, &denom); \
+    }
+#else
+#define LIBDIVIDE_EXACT_SSE2(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_EXACT_AVX2(ALGO)                            \
+    LIBDIVIDE_INLINE __m256i divide(__m256i n) const {        \
+        return libdivide_##ALGO##_exact_do_vec256(n, &denom); \
+    }
+#else
+#define LIBDIVIDE_EXACT_AVX2(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_EXACT_AVX512(ALGO)                          \
+    LIBDIVIDE_INLINE __m512i divide(__m512i n) const {        \
+        return libdivide_##ALGO##_exact_do_vec512(n, &denom); \
+    }
+#else
+#define LIBDIVIDE_EXACT_AVX512(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_SSE2)
+#define LIBDIVIDE_ROUND_SSE2(ALGO)                      \
+    LIBDIVIDE_INLINE __m128i divide(__m128i n) const {  \
+        return libdivide_##ALGO##_do_vec128(n, &denom); \
+    }
+#else
+#define LIBDIVIDE_ROUND_SSE2(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_ROUND_AVX2(ALGO)                      \
+    LIBDIVIDE_INLINE __m256i divide(__m256i n) const {  \
+        return libdivide_##ALGO##_do_vec256(n, &denom); \
+    }
+#else
+#define LIBDIVIDE_ROUND_AVX2(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_ROUND_AVX512(ALGO)                    \
+    LIBDIVIDE_INLINE __m512i divide(__m512i n) const {  \
+        return libdivide_##ALGO##_do_vec512(n, &denom); \
+    }
+#else
+#define LIBDIVIDE_ROUND_AVX512(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_SSE2)
+#define LIBDIVIDE_SCALER_SSE2(ALGO)                             \
+    LIBDIVIDE_INLINE __m128i scale(__m128i x) const {           \
+        return libdivide_##ALGO##_scaler_do_vec128(x, &scaler); \
+    }
+#else
+#define LIBDIVIDE_SCALER_SSE2(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_SCALER_AVX2(ALGO)                             \
+    LIBDIVIDE_INLINE __m256i scale(__m256i x) const {           \
+        return libdivide_##ALGO##_scaler_do_vec256(x, &scaler); \
+    }
+#else
+#define LIBDIVIDE_SCALER_AVX2(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_SCALER_AVX512(ALGO)                           \
+    LIBDIVIDE_INLINE __m512i scale(__m512i x) const {           \
+        return libdivide_##ALGO##_scaler_do_vec512(x, &scaler); \
+    }
+#else
+#define LIBDIVIDE_SCALER_AVX512(ALGO)
+#endif
+
+// The DISPATCHER_GEN() macro generates C++ methods (for the given integer
+// and algorithm types) that redirect to libdivide's C API.
+// DISPATCHER_SCALAR_GEN() and DISPATCHER_ARRAY_GEN() generate the subsets
+// for the types that lack some of the vector kernels.
+#define DISPATCHER_SCALAR_GEN(T, ALGO)                                                 \
+    libdivide_##ALGO##_t denom;                                                        \
+    T divisor;                                                                         \
+    LIBDIVIDE_INLINE dispatcher() {}                                                   \
+    explicit LIBDIVIDE_CONSTEXPR_INLINE dispatcher(decltype(nullptr))                  \
+        : denom{}, divisor{} {}                                                        \
+    LIBDIVIDE_INLINE dispatcher(T d) : denom(libdivide_##ALGO##_gen(d)), divisor(d) {} \
+    LIBDIVIDE_INLINE T divide(T n) const { return libdivide_##ALGO##_do(n, &denom); }  \
+    LIBDIVIDE_INLINE T recover() const { return libdivide_##ALGO##_recover(&denom); }  \
+    LIBDIVIDE_INLINE T remainder(T n) const {                                          \
+        return libdivide_##ALGO##_remainder(n, divisor, &denom);                       \
+    }                                                                                  \
+    LIBDIVIDE_INLINE void divmod(T n, T *q, T *r) const {                              \
+        *q = libdivide_##ALGO##_divmod(n, divisor, &denom, r);                         \
+    }
+
+#define DISPATCHER_ARRAY_GEN(T, ALGO)                                          \
+    LIBDIVIDE_INLINE void divide(const T *n, T *q, size_t count) const {       \
+        libdivide_##ALGO##_do_array(n, q, count, &denom);                      \
+    }                                                                          \
+    LIBDIVIDE_INLINE void remainder(const T *n, T *r, size_t count) const {    \
+        libdivide_##ALGO##_remainder_array(n, r, count, divisor, &denom);      \
+    }                                                                          \
+    LIBDIVIDE_INLINE void divmod(const T *n, T *q, T *r, size_t count) const { \
+        libdivide_##ALGO##_divmod_array(n, q, r, count, divisor, &denom);      \
+    }
+
+// DISPATCHER_EACH_GEN() generates the division by per-element dividers,
+// which only exists for the branchfree dividers. stride is the distance
+// between the dispatchers in bytes, see divider::divide_each().
+#define DISPATCHER_EACH_GEN(T, ALGO)                                               \
+    static LIBDIVIDE_INLINE void divide_each(                                      \
+        const T *n, const dispatcher *divs, size_t stride, T *q, size_t count) {   \
+        libdivide_##ALGO##_do_each_strided(n, q, count, &divs->denom, stride);     \
+    }                                                                              \
+    static LIBDIVIDE_INLINE void divide_by_each(                                   \
+        T n, const dispatcher *divs, size_t stride, T *q, size_t count) {          \
+        libdivide_##ALGO##_do_by_each_strided(n, q, count, &divs->denom, stride);  \
+    }
+
+// DISPATCHER_RUNS_GEN() generates the division by run-length encoded
+// divisors, see divider::divide_runs().
+#define DISPATCHER_RUNS_GEN(T, ALGO)                                                    \
+    static LIBDIVIDE_INLINE void divide_runs(const T *n, T *q, const uint32_t *lengths, \
+        const T *denoms, size_t run_count) {                                            \
+        libdivide_##ALGO##_do_runs(n, q, lengths, denoms, run_count);                   \
+    }
+
+// DISPATCHER_IOTA_GEN() generates the quotients and remainders of strided
+// numerators, see divider::iota_divmod().
+#define DISPATCHER_IOTA_GEN(T, ALGO)                                 \
+    static LIBDIVIDE_INLINE void iota_divmod(                        \
+        T start, T step, size_t count, T d, T *q, T *r) {            \
+        libdivide_##ALGO##_iota_divmod(start, step, count, d, q, r); \
+    }
+
+// DISPATCHER_BOUNDED_GEN() generates the constructor of dividers for
+// numerators <= max_numer, see libdivide_u32_gen_bounded().
+#define DISPATCHER_BOUNDED_GEN(T, ALGO)                                      \
+    LIBDIVIDE_INLINE dispatcher(T d, T max_numer)                            \
+        : denom(libdivide_##ALGO##_gen_bounded(d, max_numer)), divisor(d) {}
+
+#define DISPATCHER_GEN(T, ALGO)       \
+    DISPATCHER_SCALAR_GEN(T, ALGO)    \
+    DISPATCHER_ARRAY_GEN(T, ALGO)     \
+    LIBDIVIDE_DIVIDE_NEON(ALGO, T)    \
+    LIBDIVIDE_DIVIDE_SVE(ALGO, T)     \
+    LIBDIVIDE_DIVIDE_SSE2(ALGO)       \
+    LIBDIVIDE_DIVIDE_AVX2(ALGO)       \
+    LIBDIVIDE_DIVIDE_AVX512(ALGO)
+
+// 8-bit dividers have no NEON and SVE kernels.
+#define DISPATCHER8_GEN(T, ALGO)      \
+    DISPATCHER_SCALAR_GEN(T, ALGO)    \
+    DISPATCHER_ARRAY_GEN(T, ALGO)     \
+    LIBDIVIDE_DIVIDE_SSE2(ALGO)       \
+    LIBDIVIDE_DIVIDE_AVX2(ALGO)       \
+    LIBDIVIDE_DIVIDE_AVX512(ALGO)
+
+// The dispatcher selects a specific division algorithm for a given
+// width, signedness, and ALGO using partial template specialization.
+template <int _WIDTH, Signedness _SIGN, Branching _ALGO>
+struct dispatcher {};
+
+template <>
+struct dispatcher<8, SIGNED, BRANCHFULL> {
+    DISPATCHER8_GEN(int8_t, s8)
+    DISPATCHER_RUNS_GEN(int8_t, s8)
+};
+template <>
+struct dispatcher<8, SIGNED, BRANCHFREE> {
+    DISPATCHER8_GEN(int8_t, s8_branchfree)
+    DISPATCHER_EACH_GEN(int8_t, s8_branchfree)
+};
+template <>
+struct dispatcher<8, UNSIGNED, BRANCHFULL> {
+    DISPATCHER8_GEN(uint8_t, u8)
+    DISPATCHER_RUNS_GEN(uint8_t, u8)
+    DISPATCHER_IOTA_GEN(uint8_t, u8)
+};
+template <>
+struct dispatcher<8, UNSIGNED, BRANCHFREE> {
+    DISPATCHER8_GEN(uint8_t, u8_branchfree)
+    DISPATCHER_EACH_GEN(uint8_t, u8_branchfree)
+};
+template <>
+struct dispatcher<16, SIGNED, BRANCHFULL> {
+    DISPATCHER_GEN(int16_t, s16)
+    DISPATCHER_RUNS_GEN(int16_t, s16)
+};
+template <>
+struct dispatcher<16, SIGNED, BRANCHFREE> {
+    DISPATCHER_GEN(int16_t, s16_branchfree)
+    DISPATCHER_EACH_GEN(int16_t, s16_branchfree)
+};
+template <>
+struct dispatcher<16, UNSIGNED, BRANCHFULL> {
+    DISPATCHER_GEN(uint16_t, u16)
+    DISPATCHER_RUNS_GEN(uint16_t, u16)
+    DISPATCHER_IOTA_GEN(uint16_t, u16)
+    DISPATCHER_BOUNDED_GEN(uint16_t, u16)
+};
+template <>
+struct dispatcher<16, UNSIGNED, BRANCHFREE> {
+    DISPATCHER_GEN(uint16_t, u16_branchfree)
+    DISPATCHER_EACH_GEN(uint16_t, u16_branchfree)
+};
+template <>
+struct dispatcher<32, SIGNED, BRANCHFULL> {
+    DISPATCHER_GEN(int32_t, s32)
+    DISPATCHER_RUNS_GEN(int32_t, s32)
+};
+template <>
+struct dispatcher<32, SIGNED, BRANCHFREE> {
+    DISPATCHER_GEN(int32_t, s32_branchfree)
+    DISPATCHER_EACH_GEN(int32_t, s32_branchfree)
+};
+template <>
+struct dispatcher<32, UNSIGNED, BRANCHFULL> {
+    DISPATCHER_GEN(uint32_t, u32)
+    DISPATCHER_RUNS_GEN(uint32_t, u32)
+    DISPATCHER_IOTA_GEN(uint32_t, u32)
+    DISPATCHER_BOUNDED_GEN(uint32_t, u32)
+};
+template <>
+struct dispatcher<32, UNSIGNED, BRANCHFREE> {
+    DISPATCHER_GEN(uint32_t, u32_branchfree)
+    DISPATCHER_EACH_GEN(uint32_t, u32_branchfree)
+};
+template <>
+struct dispatcher<64, SIGNED, BRANCHFULL> {
+    DISPATCHER_GEN(int64_t, s64)
+    DISPATCHER_RUNS_GEN(int64_t, s64)
+};
+template <>
+struct dispatcher<64, SIGNED, BRANCHFREE> {
+    DISPATCHER_GEN(int64_t, s64_branchfree)
+    DISPATCHER_EACH_GEN(int64_t, s64_branchfree)
+};
+template <>
+struct dispatcher<64, UNSIGNED, BRANCHFULL> {
+    DISPATCHER_GEN(uint64_t, u64)
+    DISPATCHER_RUNS_GEN(uint64_t, u64)
+    DISPATCHER_IOTA_GEN(uint64_t, u64)
+    DISPATCHER_BOUNDED_GEN(uint64_t, u64)
+};
+template <>
+struct dispatcher<64, UNSIGNED, BRANCHFREE> {
+    DISPATCHER_GEN(uint64_t, u64_branchfree)
+    DISPATCHER_EACH_GEN(uint64_t, u64_branchfree)
+};
+
+#if defined(HAS_INT128_T)
+// 128-bit dividers have no array or vector kernels.
+template <>
+struct dispatcher<128, SIGNED, BRANCHFULL> {
+    DISPATCHER_SCALAR_GEN(__int128_t, s128)
+};
+template <>
+struct dispatcher<128, SIGNED, BRANCHFREE> {
+    DISPATCHER_SCALAR_GEN(__int128_t, s128_branchfree)
+};
+template <>
+struct dispatcher<128, UNSIGNED, BRANCHFULL> {
+    DISPATCHER_SCALAR_GEN(__uint128_t, u128)
+};
+template <>
+struct dispatcher<128, UNSIGNED, BRANCHFREE> {
+    DISPATCHER_SCALAR_GEN(__uint128_t, u128_branchfree)
+};
+#endif
+
+// FASTMOD_DISPATCHER_GEN() is the fastmod_divider counterpart of
+// DISPATCHER_GEN(), fastmod dividers only exist for 32-bit integers.
+#define FASTMOD_DISPATCHER_GEN(T, ALGO)                                                    \
+    libdivide_##ALGO##_fastmod_t denom;                                                    \
+    LIBDIVIDE_INLINE fastmod_dispatcher() {}                                               \
+    LIBDIVIDE_INLINE fastmod_dispatcher(T d) : denom(libdivide_##ALGO##_fastmod_gen(d)) {} \
+    LIBDIVIDE_INLINE T mod(T n) const {                                                    \
+        return libdivide_##ALGO##_fastmod_mod(n, &denom);                                  \
+    }                                                                                      \
+    LIBDIVIDE_INLINE bool is_divisible(T n) const {                                        \
+        return libdivide_##ALGO##_fastmod_is_divisible(n, &denom) != 0;                    \
+    }                                                                                      \
+    LIBDIVIDE_FASTMOD_SSE2(ALGO)                                                           \
+    LIBDIVIDE_FASTMOD_AVX2(ALGO)                                                           \
+    LIBDIVIDE_FASTMOD_AVX512(ALGO)
+
+template <int _WIDTH, Signedness _SIGN>
+struct fastmod_dispatcher {};
+
+template <>
+struct fastmod_dispatcher<32, SIGNED> {
+    FASTMOD_DISPATCHER_GEN(int32_t, s32)
+};
+template <>
+struct fastmod_dispatcher<32, UNSIGNED> {
+    FASTMOD_DISPATCHER_GEN(uint32_t, u32)
+};
+
+// EXACT_DISPATCHER_GEN() is the exact_divider counterpart of
+// DISPATCHER_GEN().
+#define EXACT_DISPATCHER_GEN(T, ALGO)                                                       \
+    libdivide_##ALGO##_exact_t denom;                                                       \
+    LIBDIVIDE_INLINE exact_dispatcher() {}                                                  \
+    LIBDIVIDE_INLINE exact_dispatcher(T d) : denom(libdivide_##ALGO##_exact_gen(d)) {}      \
+    LIBDIVIDE_INLINE T divide(T n) const { return libdivide_##ALGO##_exact_do(n, &denom); } \
+    LIBDIVIDE_INLINE T recover() const { return libdivide_##ALGO##_exact_recover(&denom); } \
+    LIBDIVIDE_EXACT_NEON(ALGO, T)                                                           \
+    LIBDIVIDE_EXACT_SSE2(ALGO)                                                              \
+    LIBDIVIDE_EXACT_AVX2(ALGO)                                                              \
+    LIBDIVIDE_EXACT_AVX512(ALGO)
+
+template <int _WIDTH, Signedness _SIGN>
+struct exact_dispatcher {};
+
+template <>
+struct exact_dispatcher<16, SIGNED> {
+    EXACT_DISPATCHER_GEN(int16_t, s16)
+};
+template <>
+struct exact_dispatcher<16, UNSIGNED> {
+    EXACT_DISPATCHER_GEN(uint16_t, u16)
+};
+template <>
+struct exact_dispatcher<32, SIGNED> {
+    EXACT_DISPATCHER_GEN(int32_t, s32)
+};
+template <>
+struct exact_dispatcher<32, UNSIGNED> {
+    EXACT_DISPATCHER_GEN(uint32_t, u32)
+};
+template <>
+struct exact_dispatcher<64, SIGNED> {
+    EXACT_DISPATCHER_GEN(int64_t, s64)
+};
+template <>
+struct exact_dispatcher<64, UNSIGNED> {
+    EXACT_DISPATCHER_GEN(uint64_t, u64)
+};
+
+// ROUND_DISPATCHER_GEN() is the rounding_divider counterpart of
+// DISPATCHER_GEN(), ALGO is e.g. s32_round or s32_round_branchfree.
+#define ROUND_DISPATCHER_GEN(T, ALGO)                                                   \
+    libdivide_##ALGO##_t denom;                                                         \
+    LIBDIVIDE_INLINE round_dispatcher() {}                                              \
+    LIBDIVIDE_INLINE round_dispatcher(T d, libdivide_rounding rounding)                 \
+        : denom(libdivide_##ALGO##_gen(d, rounding)) {}                                 \
+    LIBDIVIDE_INLINE T divide(T n) const { return libdivide_##ALGO##_do(n, &denom); }   \
+    LIBDIVIDE_INLINE T recover() const { return libdivide_##ALGO##_recover(&denom); }   \
+    LIBDIVIDE_ROUND_SSE2(ALGO)                                                          \
+    LIBDIVIDE_ROUND_AVX2(ALGO)                                                          \
+    LIBDIVIDE_ROUND_AVX512(ALGO)
+
+template <int _WIDTH, Signedness _SIGN, Branching _ALGO>
+struct round_dispatcher {};
+
+template <>
+struct round_dispatcher<16, SIGNED, BRANCHFULL> {
+    ROUND_DISPATCHER_GEN(int16_t, s16_round)
+};
+template <>
+struct round_dispatcher<16, SIGNED, BRANCHFREE> {
+    ROUND_DISPATCHER_GEN(int16_t, s16_round_branchfree)
+};
+template <>
+struct round_dispatcher<16, UNSIGNED, BRANCHFULL> {
+    ROUND_DISPATCHER_GEN(uint16_t, u16_round)
+};
+template <>
+struct round_dispatcher<16, UNSIGNED, BRANCHFREE> {
+    ROUND_DISPATCHER_GEN(uint16_t, u16_round_branchfree)
+};
+template <>
+struct round_dispatcher<32, SIGNED, BRANCHFULL> {
+    ROUND_DISPATCHER_GEN(int32_t, s32_round)
+};
+template <>
+struct round_dispatcher<32, SIGNED, BRANCHFREE> {
+    ROUND_DISPATCHER_GEN(int32_t, s32_round_branchfree)
+};
+template <>
+struct round_dispatcher<32, UNSIGNED, BRANCHFULL> {
+    ROUND_DISPATCHER_GEN(uint32_t, u32_round)
+};
+template <>
+struct round_dispatcher<32, UNSIGNED, BRANCHFREE> {
+    ROUND_DISPATCHER_GEN(uint32_t, u32_round_branchfree)
+};
+template <>
+struct round_dispatcher<64, SIGNED, BRANCHFULL> {
+    ROUND_DISPATCHER_GEN(int64_t, s64_round)
+};
+template <>
+struct round_dispatcher<64, SIGNED, BRANCHFREE> {
+    ROUND_DISPATCHER_GEN(int64_t, s64_round_branchfree)
+};
+template <>
+struct round_dispatcher<64, UNSIGNED, BRANCHFULL> {
+    ROUND_DISPATCHER_GEN(uint64_t, u64_round)
+};
+template <>
+struct round_dispatcher<64, UNSIGNED, BRANCHFREE> {
+    ROUND_DISPATCHER_GEN(uint64_t, u64_round_branchfree)
+};
+
+// FP_DISPATCHER_GEN() is the fp_divider counterpart of DISPATCHER_GEN(),
+// the vector methods are generated like the rounding_divider ones.
+#define FP_DISPATCHER_GEN(T, ALGO)                                                \
+    libdivide_##ALGO##_t denom;                                                   \
+    LIBDIVIDE_INLINE fp_dispatcher() {}                                           \
+    LIBDIVIDE_INLINE fp_dispatcher(T d) : denom(libdivide_##ALGO##_gen(d)) {}     \
+    LIBDIVIDE_INLINE T divide(T n) const { return libdivide_##ALGO##_do(n, &denom); } \
+    LIBDIVIDE_INLINE T recover() const { return libdivide_##ALGO##_recover(&denom); } \
+    LIBDIVIDE_ROUND_SSE2(ALGO)                                                    \
+    LIBDIVIDE_ROUND_AVX2(ALGO)                                                    \
+    LIBDIVIDE_ROUND_AVX512(ALGO)
+
+template <int _WIDTH, Signedness _SIGN>
+struct fp_dispatcher {};
+
+template <>
+struct fp_dispatcher<16, SIGNED> {
+    FP_DISPATCHER_GEN(int16_t, s16_fp)
+};
+template <>
+struct fp_dispatcher<16, UNSIGNED> {
+    FP_DISPATCHER_GEN(uint16_t, u16_fp)
+};
+template <>
+struct fp_dispatcher<32, SIGNED> {
+    FP_DISPATCHER_GEN(int32_t, s32_fp)
+};
+template <>
+struct fp_dispatcher<32, UNSIGNED> {
+    FP_DISPATCHER_GEN(uint32_t, u32_fp)
+};
+
+// REDUCER_DISPATCHER_GEN() generates the mod_reducer methods shared by
+// 32-bit and 64-bit moduli, the reductions of wide numbers differ.
+#define REDUCER_DISPATCHER_GEN(T, ALGO)                                                         \
+    libdivide_##ALGO##_reducer_t reducer;                                                       \
+    LIBDIVIDE_INLINE reducer_dispatcher() {}                                                    \
+    LIBDIVIDE_INLINE reducer_dispatcher(T m) : reducer(libdivide_##ALGO##_reducer_gen(m)) {}    \
+    LIBDIVIDE_INLINE T mulmod(T a, T b) const {                                                 \
+        return libdivide_##ALGO##_mulmod(a, b, &reducer);                                       \
+    }                                                                                           \
+    LIBDIVIDE_INLINE T addmod(T a, T b) const {                                                 \
+        return libdivide_##ALGO##_addmod(a, b, &reducer);                                       \
+    }                                                                                           \
+    LIBDIVIDE_INLINE T submod(T a, T b) const {                                                 \
+        return libdivide_##ALGO##_submod(a, b, &reducer);                                       \
+    }                                                                                           \
+    LIBDIVIDE_INLINE T powmod(T base, uint64_t exp) const {                                     \
+        return libdivide_##ALGO##_powmod(base, exp, &reducer);                                  \
+    }                                                                                           \
+    LIBDIVIDE_INLINE void mulmod(const T *a, const T *b, T *c, size_t count) const {            \
+        libdivide_##ALGO##_mulmod_array(a, b, c, count, &reducer);                              \
+    }                                                                                           \
+    LIBDIVIDE_INLINE void addmod(const T *a, const T *b, T *c, size_t count) const {            \
+        libdivide_##ALGO##_addmod_array(a, b, c, count, &reducer);                              \
+    }                                                                                           \
+    LIBDIVIDE_INLINE void submod(const T *a, const T *b, T *c, size_t count) const {            \
+        libdivide_##ALGO##_submod_array(a, b, c, count, &reducer);                              \
+    }                                                                                           \
+    LIBDIVIDE_INLINE void powmod(const T *bases, T *powers, size_t count, uint64_t exp) const { \
+        libdivide_##ALGO##_powmod_array(bases, powers, count, exp, &reducer);                   \
+    }                                                                                           \
+    LIBDIVIDE_INLINE T to_montgomery(T a) const {                                               \
+        return libdivide_##ALGO##_to_montgomery(a, &reducer);                                   \
+    }                                                                                           \
+    LIBDIVIDE_INLINE T from_montgomery(T a) const {                                             \
+        return libdivide_##ALGO##_from_montgomery(a, &reducer);                                 \
+    }                                                                                           \
+    LIBDIVIDE_INLINE T montgomery_mul(T a, T b) const {                                         \
+        return libdivide_##ALGO##_montgomery_mul(a, b, &reducer);                               \
+    }
+
+
+template <int _WIDTH, Signedness _SIGN>
+struct reducer_dispatcher {};
+
+template <>
+struct reducer_dispatcher<32, UNSIGNED> {
+    REDUCER_DISPATCHER_GEN(uint32_t, u32)
+    LIBDIVIDE_INLINE uint32_t reduce(uint64_t n) const { return libdivide_u32_reduce(n, &reducer); }
+    // {hi, lo} is reduced 32 bits at a time, starting with hi % m
+    LIBDIVIDE_INLINE uint32_t reduce(uint64_t hi, uint64_t lo) const {
+        uint64_t r = libdivide_u32_reduce(hi, &reducer);
+        r = libdivide_u32_reduce((r << 32) | (lo >> 32), &reducer);
+        return libdivide_u32_reduce((r << 32) | (lo & 0xFFFFFFFF), &reducer);
+    }
+};
+template <>
+struct reducer_dispatcher<64, UNSIGNED> {
+    REDUCER_DISPATCHER_GEN(uint64_t, u64)
+    LIBDIVIDE_INLINE uint64_t reduce(uint64_t n) const {
+        return libdivide_u64_reduce(0, n, &reducer);
+    }
+    LIBDIVIDE_INLINE uint64_t reduce(uint64_t hi, uint64_t lo) const {
+        return libdivide_u64_reduce(hi, lo, &reducer);
+    }
+};
+
+#define MULDIV_DISPATCHER_GEN(T, ALGO)                                                       \
+    libdivide_##ALGO##_muldiv_t denom;                                                       \
+    LIBDIVIDE_INLINE muldiv_dispatcher() {}                                                  \
+    LIBDIVIDE_INLINE muldiv_dispatcher(T c, libdivide_rounding rounding)                     \
+        : denom(libdivide_##ALGO##_muldiv_gen(c, rounding)) {}                               \
+    LIBDIVIDE_INLINE T muldiv(T a, T b) const {                                              \
+        return libdivide_##ALGO##_muldiv_do(a, b, &denom);                                   \
+    }                                                                                        \
+    LIBDIVIDE_INLINE void muldiv(const T *a, T b, T *results, size_t count) const {          \
+        libdivide_##ALGO##_muldiv_array(a, b, results, count, &denom);                       \
+    }                                                                                        \
+    LIBDIVIDE_INLINE T recover() const { return libdivide_##ALGO##_muldiv_recover(&denom); }
+
+template <int _WIDTH, Signedness _SIGN>
+struct muldiv_dispatcher {};
+
+template <>
+struct muldiv_dispatcher<64, SIGNED> {
+    MULDIV_DISPATCHER_GEN(int64_t, s64)
+};
+template <>
+struct muldiv_dispatcher<64, UNSIGNED> {
+    MULDIV_DISPATCHER_GEN(uint64_t, u64)
+};
+
+#define SCALER_DISPATCHER_GEN(T, ALGO)                                                           \
+    libdivide_##ALGO##_scaler_t scaler;                                                          \
+    LIBDIVIDE_INLINE scaler_dispatcher() {}                                                      \
+    LIBDIVIDE_INLINE scaler_dispatcher(T num, T den, libdivide_rounding rounding, bool saturate) \
+        : scaler(libdivide_##ALGO##_scaler_gen(num, den, rounding, saturate)) {}                 \
+    LIBDIVIDE_INLINE T scale(T x) const { return libdivide_##ALGO##_scaler_do(x, &scaler); }     \
+    LIBDIVIDE_INLINE void scale(const T *x, T *results, size_t count) const {                    \
+        libdivide_##ALGO##_scaler_do_array(x, results, count, &scaler);                          \
+    }                                                                                            \
+    LIBDIVIDE_SCALER_SSE2(ALGO)                                                                  \
+    LIBDIVIDE_SCALER_AVX2(ALGO)                                                                  \
+    LIBDIVIDE_SCALER_AVX512(ALGO)
+
+template <int _WIDTH, Signedness _SIGN>
+struct scaler_dispatcher {};
+
+template <>
+struct scaler_dispatcher<32, UNSIGNED> {
+    SCALER_DISPATCHER_GEN(uint32_t, u32)
+};
+template <>
+struct scaler_dispatcher<64, UNSIGNED> {
+    SCALER_DISPATCHER_GEN(uint64_t, u64)
+};
+
+// FIXED_DISPATCHER_GEN() is the fixed_divider counterpart of
+// DISPATCHER_GEN(), the vector methods are generated like the
+// rounding_divider ones.
+#define FIXED_DISPATCHER_GEN(T, ALGO)                                                 \
+    libdivide_##ALGO##_t denom;                                                       \
+    LIBDIVIDE_INLINE fixed_dispatcher() {}                                            \
+    LIBDIVIDE_INLINE fixed_dispatcher(T d, int frac_bits)                             \
+        : denom(libdivide_##ALGO##_gen(d, frac_bits)) {}                              \
+    LIBDIVIDE_INLINE T divide(T n) const { return libdivide_##ALGO##_do(n, &denom); } \
+    LIBDIVIDE_ROUND_SSE2(ALGO)                                                        \
+    LIBDIVIDE_ROUND_AVX2(ALGO)                                                        \
+    LIBDIVIDE_ROUND_AVX512(ALGO)
+
+template <int _WIDTH, Signedness _SIGN>
+struct fixed_dispatcher {};
+
+template <>
+struct fixed_dispatcher<16, UNSIGNED> {
+    FIXED_DISPATCHER_GEN(uint16_t, u16_fixed)
+};
+template <>
+struct fixed_dispatcher<32, UNSIGNED> {
+    FIXED_DISPATCHER_GEN(uint32_t, u32_fixed)
+};
+template <>
+struct fixed_dispatcher<64, UNSIGNED> {
+    FIXED_DISPATCHER_GEN(uint64_t, u64_fixed)
+};
+
+// TABLE_DISPATCHER_GEN() is the divider_table counterpart of
+// DISPATCHER_GEN(), the magic number of every divider has type T.
+#define TABLE_DISPATCHER_GEN(T, ALGO)                                              \
+    static LIBDIVIDE_INLINE void gen(T d, T *magic, uint8_t *more) {               \
+        libdivide_##ALGO##_t denom = libdivide_##ALGO##_gen(d);                    \
+        *magic = denom.magic;                                                      \
+        *more = denom.more;                                                        \
+    }                                                                              \
+    static LIBDIVIDE_INLINE void gen(                                              \
+        const T *d, T *magics, uint8_t *mores, size_t count) {                     \
+        libdivide_##ALGO##_gen_array(d, magics, mores, count);                     \
+    }                                                                              \
+    static LIBDIVIDE_INLINE libdivide_##ALGO##_t load(T magic, uint8_t more) {     \
+        libdivide_##ALGO##_t denom;                                                \
+        denom.magic = magic;                                                       \
+        denom.more = more;                                                         \
+        return denom;                                                              \
+    }                                                                              \
+    static LIBDIVIDE_INLINE T divide(T n, T magic, uint8_t more) {                 \
+        libdivide_##ALGO##_t denom = load(magic, more);                            \
+        return libdivide_##ALGO##_do(n, &denom);                                   \
+    }                                                                              \
+    static LIBDIVIDE_INLINE T recover(T magic, uint8_t more) {                     \
+        libdivide_##ALGO##_t denom = load(magic, more);                            \
+        return libdivide_##ALGO##_recover(&denom);                                 \
+    }                                                                              \
+    static LIBDIVIDE_INLINE void divide(const T *n, const uint32_t *indices, T *q, \
+        size_t count, const T *magics, const uint8_t *mores) {                     \
+        libdivide_##ALGO##_do_table_array(n, indices, q, count, magics, mores);    \
+    }
+
+#if defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_TABLE_AVX2(ALGO, T, IdxT)                                   \
+    static LIBDIVIDE_INLINE __m256i divide(                                   \
+        __m256i n, IdxT indices, const T *magics, const uint8_t *mores) {     \
+        return libdivide_##ALGO##_do_table_vec256(n, indices, magics, mores); \
+    }
+#else
+#define LIBDIVIDE_TABLE_AVX2(ALGO, T, IdxT)
+#endif
+
+#if defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_TABLE_AVX512(ALGO, T, IdxT)                                 \
+    static LIBDIVIDE_INLINE __m512i divide(                                   \
+        __m512i n, IdxT indices, const T *magics, const uint8_t *mores) {     \
+        return libdivide_##ALGO##_do_table_vec512(n, indices, magics, mores); \
+    }
+#else
+#define LIBDIVIDE_TABLE_AVX512(ALGO, T, IdxT)
+#endif
+
+template <int _WIDTH, Signedness _SIGN, Branching _ALGO>
+struct table_dispatcher {};
+
+template <>
+struct table_dispatcher<8, SIGNED, BRANCHFULL> {
+    TABLE_DISPATCHER_GEN(int8_t, s8)
+};
+template <>
+struct table_dispatcher<8, SIGNED, BRANCHFREE> {
+    TABLE_DISPATCHER_GEN(int8_t, s8_branchfree)
+};
+template <>
+struct table_dispatcher<8, UNSIGNED, BRANCHFULL> {
+    TABLE_DISPATCHER_GEN(uint8_t, u8)
+};
+template <>
+struct table_dispatcher<8, UNSIGNED, BRANCHFREE> {
+    TABLE_DISPATCHER_GEN(uint8_t, u8_branchfree)
+};
+template <>
+struct table_dispatcher<16, SIGNED, BRANCHFULL> {
+    TABLE_DISPATCHER_GEN(int16_t, s16)
+};
+template <>
+struct table_dispatcher<16, SIGNED, BRANCHFREE> {
+    TABLE_DISPATCHER_GEN(int16_t, s16_branchfree)
+};
+template <>
+struct table_dispatcher<16, UNSIGNED, BRANCHFULL> {
+    TABLE_DISPATCHER_GEN(uint16_t, u16)
+};
+template <>
+struct table_dispatcher<16, UNSIGNED, BRANCHFREE> {
+    TABLE_DISPATCHER_GEN(uint16_t, u16_branchfree)
+};
+template <>
+struct table_dispatcher<32, SIGNED, BRANCHFULL> {
+    TABLE_DISPATCHER_GEN(int32_t, s32)
+};
+template <>
+struct table_dispatcher<32, SIGNED, BRANCHFREE> {
+    TABLE_DISPATCHER_GEN(int32_t, s32_branchfree)
+    LIBDIVIDE_TABLE_AVX2(s32_branchfree, int32_t, __m256i)
+    LIBDIVIDE_TABLE_AVX512(s32_branchfree, int32_t, __m512i)
+};
+template <>
+struct table_dispatcher<32, UNSIGNED, BRANCHFULL> {
+    TABLE_DISPATCHER_GEN(uint32_t, u32)
+};
+template <>
+struct table_dispatcher<32, UNSIGNED, BRANCHFREE> {
+    TABLE_DISPATCHER_GEN(uint32_t, u32_branchfree)
+    LIBDIVIDE_TABLE_AVX2(u32_branchfree, uint32_t, __m256i)
+    LIBDIVIDE_TABLE_AVX512(u32_branchfree, uint32_t, __m512i)
+};
+template <>
+struct table_dispatcher<64, SIGNED, BRANCHFULL> {
+    TABLE_DISPATCHER_GEN(int64_t, s64)
+};
+template <>
+struct table_dispatcher<64, SIGNED, BRANCHFREE> {
+    TABLE_DISPATCHER_GEN(int64_t, s64_branchfree)
+    LIBDIVIDE_TABLE_AVX2(s64_branchfree, int64_t, __m128i)
+    LIBDIVIDE_TABLE_AVX512(s64_branchfree, int64_t, __m256i)
+};
+template <>
+struct table_dispatcher<64, UNSIGNED, BRANCHFULL> {
+    TABLE_DISPATCHER_GEN(uint64_t, u64)
+};
+template <>
+struct table_dispatcher<64, UNSIGNED, BRANCHFREE> {
+    TABLE_DISPATCHER_GEN(uint64_t, u64_branchfree)
+    LIBDIVIDE_TABLE_AVX2(u64_branchfree, uint64_t, __m128i)
+    LIBDIVIDE_TABLE_AVX512(u64_branchfree, uint64_t, __m256i)
+};
+
+// DICT_DISPATCHER_GEN() wraps a dictionary of up to 16 branchfree dividers
+// of type T, the dictionaries only exist for branchfree dividers.
+#define DICT_DISPATCHER_GEN(T, ALGO)                                                           \
+    libdivide_##ALGO##_dict_t dict;                                                            \
+    LIBDIVIDE_INLINE dict_dispatcher() {}                                                      \
+    LIBDIVIDE_INLINE dict_dispatcher(const T *d, size_t count)                                 \
+        : dict(libdivide_##ALGO##_dict_gen(d, count)) {}                                       \
+    LIBDIVIDE_INLINE T divide(T n, uint8_t code) const {                                       \
+        return libdivide_##ALGO##_dict_do(n, code, &dict);                                     \
+    }                                                                                          \
+    LIBDIVIDE_INLINE void divide(const T *n, const uint8_t *codes, T *q, size_t count) const { \
+        libdivide_##ALGO##_dict_do_array(n, codes, q, count, &dict);                           \
+    }
+
+#if defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_DICT_AVX2(ALGO)                                     \
+    LIBDIVIDE_INLINE __m256i divide(__m256i n, __m256i codes) const { \
+        return libdivide_##ALGO##_dict_do_vec256(n, codes, &dict);    \
+    }
+#else
+#define LIBDIVIDE_DICT_AVX2(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_DICT_AVX512(ALGO)                                   \
+    LIBDIVIDE_INLINE __m512i divide(__m512i n, __m512i codes) const { \
+        return libdivide_##ALGO##_dict_do_vec512(n, codes, &dict);    \
+    }
+#else
+#define LIBDIVIDE_DICT_AVX512(ALGO)
+#endif
+
+template <int _WIDTH, Signedness _SIGN>
+struct dict_dispatcher {};
+
+template <>
+struct dict_dispatcher<16, SIGNED> {
+    DICT_DISPATCHER_GEN(int16_t, s16_branchfree)
+};
+template <>
+struct dict_dispatcher<16, UNSIGNED> {
+    DICT_DISPATCHER_GEN(uint16_t, u16_branchfree)
+};
+template <>
+struct dict_dispatcher<32, SIGNED> {
+    DICT_DISPATCHER_GEN(int32_t, s32_branchfree)
+    LIBDIVIDE_DICT_AVX2(s32_branchfree)
+    LIBDIVIDE_DICT_AVX512(s32_branchfree)
+};
+template <>
+struct dict_dispatcher<32, UNSIGNED> {
+    DICT_DISPATCHER_GEN(uint32_t, u32_branchfree)
+    LIBDIVIDE_DICT_AVX2(u32_branchfree)
+    LIBDIVIDE_DICT_AVX512(u32_branchfree)
+};
+template <>
+struct dict_dispatcher<64, SIGNED> {
+    DICT_DISPATCHER_GEN(int64_t, s64_branchfree)
+    LIBDIVIDE_DICT_AVX2(s64_branchfree)
+    LIBDIVIDE_DICT_AVX512(s64_branchfree)
+};
+template <>
+struct dict_dispatcher<64, UNSIGNED> {
+    DICT_DISPATCHER_GEN(uint64_t, u64_branchfree)
+    LIBDIVIDE_DICT_AVX2(u64_branchfree)
+    LIBDIVIDE_DICT_AVX512(u64_branchfree)
+};
+
+// DECOMPOSE_DISPATCHER_GEN() holds the extents of a tensor of up to MaxRank
+// dimensions and the dividers by them, see index_decomposer.
+#define DECOMPOSE_DISPATCHER_GEN(T, ALGO)                                                     \
+    T extents[MaxRank];                                                                       \
+    libdivide_##ALGO##_t denoms[MaxRank];                                                     \
+    size_t rank;                                                                              \
+    LIBDIVIDE_INLINE decompose_dispatcher() : rank(0) {}                                      \
+    LIBDIVIDE_INLINE decompose_dispatcher(const T *e, size_t r) : rank(r) {                   \
+        if (r == 0 || r > MaxRank) {                                                          \
+            LIBDIVIDE_ERROR("rank must be between 1 and MaxRank");                            \
+        }                                                                                     \
+        extents[0] = e[0];                                                                    \
+        denoms[0] = libdivide_##ALGO##_t();                                                   \
+        for (size_t k = 1; k < r; k++) {                                                      \
+            extents[k] = e[k];                                                                \
+            denoms[k] = libdivide_##ALGO##_gen(e[k]);                                         \
+        }                                                                                     \
+    }                                                                                         \
+    LIBDIVIDE_INLINE void decompose(T index, T *coords) const {                               \
+        libdivide_##ALGO##_decompose(index, extents, denoms, rank, coords);                   \
+    }                                                                                         \
+    LIBDIVIDE_INLINE void decompose(const T *indices, size_t count, T *const *coords) const { \
+        libdivide_##ALGO##_decompose_array(indices, count, extents, denoms, rank, coords);    \
+    }                                                                                         \
+    LIBDIVIDE_INLINE void remap(                                                              \
+        const T *indices, size_t count, const T *strides, T *out) const {                     \
+        libdivide_##ALGO##_remap_array(indices, count, extents, denoms, rank, strides, out);  \
+    }
+
+
+#if defined(LIBDIVIDE_AVX2)
+#define LIBDIVIDE_DECOMPOSE_AVX2(ALGO)                                        \
+    LIBDIVIDE_INLINE void decompose(__m256i indices, __m256i *coords) const { \
+        for (size_t k = rank - 1; k > 0; k--) {                               \
+            indices = libdivide_##ALGO##_divmod_vec256(                       \
+                indices, extents[k], &denoms[k], &coords[k]);                 \
+        }                                                                     \
+        coords[0] = indices;                                                  \
+    }
+
+#else
+#define LIBDIVIDE_DECOMPOSE_AVX2(ALGO)
+#endif
+
+#if defined(LIBDIVIDE_AVX512)
+#define LIBDIVIDE_DECOMPOSE_AVX512(ALGO)                                      \
+    LIBDIVIDE_INLINE void decompose(__m512i indices, __m512i *coords) const { \
+        for (size_t k = rank - 1; k > 0; k--) {                               \
+            indices = libdivide_##ALGO##_divmod_vec512(                       \
+                indices, extents[k], &denoms[k], &coords[k]);                 \
+        }                                                                     \
+        coords[0] = indices;                                                  \
+    }
+
+#else
+#define LIBDIVIDE_DECOMPOSE_AVX512(ALGO)
+#endif
+
+template <int _WIDTH, Signedness _SIGN, size_t MaxRank>
+struct decompose_dispatcher {};
+
+template <size_t MaxRank>
+struct decompose_dispatcher<32, UNSIGNED, MaxRank> {
+    DECOMPOSE_DISPATCHER_GEN(uint32_t, u32)
+    LIBDIVIDE_DECOMPOSE_AVX2(u32)
+    LIBDIVIDE_DECOMPOSE_AVX512(u32)
+};
+template <size_t MaxRank>
+struct decompose_dispatcher<64, UNSIGNED, MaxRank> {
+    DECOMPOSE_DISPATCHER_GEN(uint64_t, u64)
+    LIBDIVIDE_DECOMPOSE_AVX2(u64)
+    LIBDIVIDE_DECOMPOSE_AVX512(u64)
+};
+}  // namespace detail
+
+#if defined(LIBDIVIDE_NEON)
+// Allow NeonVecFor outside of detail namespace.
+template <typename T>
+struct NeonVecFor {
+    typedef typename detail::NeonVecFor<T>::type type;
+};
+#endif
+
+#if defined(LIBDIVIDE_SVE)
+// Allow SveVecFor outside of detail namespace.
+template <typename T>
+struct SveVecFor {
+    typedef typename detail::SveVecFor<T>::type type;
+};
+#endif
+
+// This is the main divider class for use by the user (C++ API).
+// The actual division algorithm is selected using the dispatcher struct
+// based on the integer width and algorithm template parameters.
+template <typename T, Branching ALGO = BRANCHFULL>
+class divider {
+   private:
+    // Dispatch based on the size and signedness.
+    // We avoid using type_traits as it's not available in AVR.
+    // Detect signedness by checking if T(-1) is less than T(0).
+    // Also throw in a shift by 0, which prevents floating point types from being passed.
+    typedef detail::dispatcher<sizeof(T) * 8,
+        (((T)0 >> 0) > (T)(-1) ? detail::SIGNED : detail::UNSIGNED), ALGO>
+        dispatcher_t;
+
+   public:
+    // We leave the default constructor empty so that creating
+    // an array of dividers and then initializing them
+    // later doesn't slow us down.
+    divider() {}
+
+    // constexpr zero-initialization to allow for use w/ static constinit
+    explicit LIBDIVIDE_CONSTEXPR_INLINE divider(decltype(nullptr)) : div(nullptr) {}
+
+    // Constructor that takes the divisor as a parameter
+    LIBDIVIDE_INLINE divider(T d) : div(d) {}
+
+    // Constructor for numerators that never exceed max_numerator, only
+    // for unsigned 16, 32 and 64-bit branchfull dividers. Picks a cheaper
+    // magic number if one is exact up to max_numerator, dividing larger
+    // numerators gives wrong quotients.
+    LIBDIVIDE_INLINE divider(T d, T max_numerator) : div(d, max_numerator) {}
+
+    // Divides n by the divisor
+    LIBDIVIDE_INLINE T divide(T n) const { return div.divide(n); }
+
+    // Divides count numerators from numers and stores the quotients
+    // in quots. Uses the widest vector instruction set available and
+    // handles unaligned arrays of arbitrary length.
+    LIBDIVIDE_INLINE void divide(const T *numers, T *quots, size_t count) const {
+        div.divide(numers, quots, count);
+    }
+
+    // In-place variant of the above, overwrites each numerator with its quotient.
+    LIBDIVIDE_INLINE void divide(T *numers, size_t count) const {
+        div.divide(numers, numers, count);
+    }
+
+    // Computes n % divisor, the remainder has the same sign as n
+    // (like the built-in % operator).
+    LIBDIVIDE_INLINE T remainder(T n) const { return div.remainder(n); }
+
+    // Computes both the quotient and the remainder of n / divisor.
+    LIBDIVIDE_INLINE void divmod(T n, T *q, T *r) const { div.divmod(n, q, r); }
+
+    // Bulk variants of remainder() and divmod(), the output arrays
+    // may be numers but must not otherwise overlap.
+    LIBDIVIDE_INLINE void remainder(const T *numers, T *rems, size_t count) const {
+        div.remainder(numers, rems, count);
+    }
+
+    LIBDIVIDE_INLINE void divmod(const T *numers, T *quots, T *rems, size_t count) const {
+        div.divmod(numers, quots, rems, count);
+    }
+
+    // Divides numers[i] by divs[i] for each i < count and stores the
+    // quotients in quots, only for branchfree dividers. The AVX512 and
+    // AVX2 kernels gather the dividers of the lanes from divs.
+    static LIBDIVIDE_INLINE void divide_each(
+        const T *numers, const divider *divs, T *quots, size_t count) {
+        dispatcher_t::divide_each(numers, &divs->div, sizeof(divider), quots, count);
+    }
+
+    // Divides numer by divs[i] for each i < count and stores the quotients
+    // in quots, only for branchfree dividers. The AVX512 and AVX2 kernels
+    // broadcast numer and divide it by a different divider in each lane.
+    static LIBDIVIDE_INLINE void divide_by_each(
+        T numer, const divider *divs, T *quots, size_t count) {
+        dispatcher_t::divide_by_each(numer, &divs->div, sizeof(divider), quots, count);
+    }
+
+    // Divides numers by run-length encoded divisors: the first lengths[0]
+    // numerators by denoms[0], the next lengths[1] by denoms[1] and so on,
+    // only for branchfull dividers. A divider is generated once per run.
+    static LIBDIVIDE_INLINE void divide_runs(const T *numers, T *quots,
+        const uint32_t *lengths, const T *denoms, size_t run_count) {
+        dispatcher_t::divide_runs(numers, quots, lengths, denoms, run_count);
+    }
+
+    // Computes the quotients and remainders of start + i * step by d for
+    // i < count, only for unsigned branchfull dividers. The numerators
+    // wrap around like unsigned integers. Only the first numerator of each
+    // vector lane is divided, the next ones are updated incrementally.
+    static LIBDIVIDE_INLINE void iota_divmod(
+        T start, T step, size_t count, T d, T *quots, T *rems) {
+        dispatcher_t::iota_divmod(start, step, count, d, quots, rems);
+    }
+
+    // Recovers the divisor, returns the value that was
+    // used to initialize this divider object.
+    T recover() const { return div.recover(); }
+
+    bool operator==(const divider<T, ALGO> &other) const {
+        return div.denom.magic == other.div.denom.magic && div.denom.more == other.div.denom.more;
+    }
+
+    bool operator!=(const divider<T, ALGO> &other) const { return !(*this == other); }
+
+    // Vector variants treat the input as packed integer values with the same type as the divider
+    // (e.g. s32, u32, s64, u64) and divides each of them by the divider, returning the packed
+    // quotients.
+#if defined(LIBDIVIDE_SSE2)
+    LIBDIVIDE_INLINE __m128i divide(__m128i n) const { return div.divide(n); }
+    LIBDIVIDE_INLINE __m128i remainder(__m128i n) const { return div.remainder(n); }
+    LIBDIVIDE_INLINE void divmod(__m128i n, __m128i *q, __m128i *r) const { div.divmod(n, q, r); }
+#endif
+#if defined(LIBDIVIDE_AVX2)
+    LIBDIVIDE_INLINE __m256i divide(__m256i n) const { return div.divide(n); }
+    LIBDIVIDE_INLINE __m256i remainder(__m256i n) const { return div.remainder(n); }
+    LIBDIVIDE_INLINE void divmod(__m256i n, __m256i *q, __m256i *r) const { div.divmod(n, q, r); }
+#endif
+#if defined(LIBDIVIDE_AVX512)
+    LIBDIVIDE_INLINE __m512i divide(__m512i n) const { return div.divide(n); }
+    LIBDIVIDE_INLINE __m512i remainder(__m512i n) const { return div.remainder(n); }
+    LIBDIVIDE_INLINE void divmod(__m512i n, __m512i *q, __m512i *r) const { div.divmod(n, q, r); }
+#endif
+#if defined(LIBDIVIDE_NEON)
+    LIBDIVIDE_INLINE typename NeonVecFor<T>::type divide(typename NeonVecFor<T>::type n) const {
+        return div.divide(n);
+    }
+    LIBDIVIDE_INLINE typename NeonVecFor<T>::type remainder(typename NeonVecFor<T>::type n) const {
+        return div.remainder(n);
+    }
+    LIBDIVIDE_INLINE void divmod(typename NeonVecFor<T>::type n, typename NeonVecFor<T>::type *q,
+        typename NeonVecFor<T>::type *r) const {
+        div.divmod(n, q, r);
+    }
+#endif
+#if defined(LIBDIVIDE_SVE)
+    LIBDIVIDE_INLINE typename SveVecFor<T>::type divide(typename SveVecFor<T>::type n) const {
+        return div.divide(n);
+    }
+#endif
+
+   private:
+    // Storage for the actual divisor
+    dispatcher_t div;
+};
+
+// Overload of operator / for scalar division
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE T operator/(T n, const divider<T, ALGO> &div) {
+    return div.divide(n);
+}
+
+// Overload of operator /= for scalar division
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE T &operator/=(T &n, const divider<T, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+// Division by per-element dividers, out[i] = numers[i] / divs[i]
+template <typename T>
+LIBDIVIDE_INLINE void divide_each(
+    const T *numers, const divider<T, BRANCHFREE> *divs, T *out, size_t n) {
+    divider<T, BRANCHFREE>::divide_each(numers, divs, out, n);
+}
+
+// Division of one numerator by many dividers, out[i] = numer / divs[i]
+template <typename T>
+LIBDIVIDE_INLINE void divide_by_each(
+    T numer, const divider<T, BRANCHFREE> *divs, T *out, size_t n) {
+    divider<T, BRANCHFREE>::divide_by_each(numer, divs, out, n);
+}
+
+// Division by run-length encoded divisors, the run r of lengths[r]
+// numerators is divided by denoms[r]
+template <typename T>
+LIBDIVIDE_INLINE void divide_runs(
+    const T *numers, T *out, const uint32_t *lengths, const T *denoms, size_t run_count) {
+    divider<T>::divide_runs(numers, out, lengths, denoms, run_count);
+}
+
+// Quotients and remainders of strided numerators, q_out[i] = (start + i *
+// step) / d and r_out[i] = (start + i * step) % d for unsigned T
+template <typename T>
+LIBDIVIDE_INLINE void iota_divmod(T start, T step, size_t n, T d, T *q_out, T *r_out) {
+    divider<T>::iota_divmod(start, step, n, d, q_out, r_out);
+}
+
+// Overload of operator % for scalar remainder
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE T operator%(T n, const divider<T, ALGO> &div) {
+    return div.remainder(n);
+}
+
+// Overload of operator %= for scalar remainder
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE T &operator%=(T &n, const divider<T, ALGO> &div) {
+    n = div.remainder(n);
+    return n;
+}
+
+// Overloads for vector types.
+#if defined(LIBDIVIDE_SSE2)
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE __m128i operator/(__m128i n, const divider<T, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE __m128i operator/=(__m128i &n, const divider<T, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE __m128i operator%(__m128i n, const divider<T, ALGO> &div) {
+    return div.remainder(n);
+}
+
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE __m128i operator%=(__m128i &n, const divider<T, ALGO> &div) {
+    n = div.remainder(n);
+    return n;
+}
+#endif
+#if defined(LIBDIVIDE_AVX2)
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE __m256i operator/(__m256i n, const divider<T, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE __m256i operator/=(__m256i &n, const divider<T, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE __m256i operator%(__m256i n, const divider<T, ALGO> &div) {
+    return div.remainder(n);
+}
+
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE __m256i operator%=(__m256i &n, const divider<T, ALGO> &div) {
+    n = div.remainder(n);
+    return n;
+}
+#endif
+#if defined(LIBDIVIDE_AVX512)
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE __m512i operator/(__m512i n, const divider<T, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE __m512i operator/=(__m512i &n, const divider<T, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE __m512i operator%(__m512i n, const divider<T, ALGO> &div) {
+    return div.remainder(n);
+}
+
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE __m512i operator%=(__m512i &n, const divider<T, ALGO> &div) {
+    n = div.remainder(n);
+    return n;
+}
+#endif
+
+#if defined(LIBDIVIDE_NEON)
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE typename NeonVecFor<T>::type operator/(
+    typename NeonVecFor<T>::type n, const divider<T, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE typename NeonVecFor<T>::type operator/=(
+    typename NeonVecFor<T>::type &n, const divider<T, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE typename NeonVecFor<T>::type operator%(
+    typename NeonVecFor<T>::type n, const divider<T, ALGO> &div) {
+    return div.remainder(n);
+}
+
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE typename NeonVecFor<T>::type operator%=(
+    typename NeonVecFor<T>::type &n, const divider<T, ALGO> &div) {
+    n = div.remainder(n);
+    return n;
+}
+#endif
+
+#if defined(LIBDIVIDE_SVE)
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE typename SveVecFor<T>::type operator/(
+    typename SveVecFor<T>::type n, const divider<T, ALGO> &div) {
+    return div.divide(n);
+}
+
+template <typename T, Branching ALGO>
+LIBDIVIDE_INLINE typename SveVecFor<T>::type operator/=(
+    typename SveVecFor<T>::type &n, const divider<T, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
+#endif
+
+// Computes remainders and divisibility tests by a runtime constant
+// using Lemire's fastmod algorithm, only for int32_t and uint32_t.
+// This is faster than divider::remainder() but cannot divide.
+template <typename T>
+class fastmod_divider {
+   private:
+    typedef detail::fastmod_dispatcher<sizeof(T) * 8,
+        (((T)0 >> 0) > (T)(-1) ? detail::SIGNED : detail::UNSIGNED)>
+        dispatcher_t;
+
+   public:
+    fastmod_divider() {}
+
+    // Constructor that takes the divisor as a parameter
+    LIBDIVIDE_INLINE fastmod_divider(T d) : div(d) {}
+
+    // Computes n % divisor, the remainder has the same sign as n
+    LIBDIVIDE_INLINE T mod(T n) const { return div.mod(n); }
+
+    // Returns true if n is a multiple of the divisor
+    LIBDIVIDE_INLINE bool is_divisible(T n) const { return div.is_divisible(n); }
+
+    // Vector variants, is_divisible() returns a mask with all bits set
+    // in the lanes of the multiples of the divisor.
+#if defined(LIBDIVIDE_SSE2)
+    LIBDIVIDE_INLINE __m128i mod(__m128i n) const { return div.mod(n); }
+    LIBDIVIDE_INLINE __m128i is_divisible(__m128i n) const { return div.is_divisible(n); }
+#endif
+#if defined(LIBDIVIDE_AVX2)
+    LIBDIVIDE_INLINE __m256i mod(__m256i n) const { return div.mod(n); }
+    LIBDIVIDE_INLINE __m256i is_divisible(__m256i n) const { return div.is_divisible(n); }
+#endif
+#if defined(LIBDIVIDE_AVX512)
+    LIBDIVIDE_INLINE __m512i mod(__m512i n) const { return div.mod(n); }
+    LIBDIVIDE_INLINE __m512i is_divisible(__m512i n) const { return div.is_divisible(n); }
+#endif
+
+   private:
+    dispatcher_t div;
+};
+
+// Overload of operator % for fastmod remainder
+template <typename T>
+LIBDIVIDE_INLINE T operator%(T n, const fastmod_divider<T> &div) {
+    return div.mod(n);
+}
+
+// Overload of operator %= for fastmod remainder
+template <typename T>
+LIBDIVIDE_INLINE T &operator%=(T &n, const fastmod_divider<T> &div) {
+    n = div.mod(n);
+    return n;
+}
+
+// Divides numbers that are known to be multiples of a runtime constant,
+// e.g. pointer differences or sizes of arrays of records, using a shift
+// and a multiplication by the inverse of the divisor. The quotient of a
+// numerator that is not a multiple of the divisor is meaningless.
+template <typename T>
+class exact_divider {
+   private:
+    typedef detail::exact_dispatcher<sizeof(T) * 8,
+        (((T)0 >> 0) > (T)(-1) ? detail::SIGNED : detail::UNSIGNED)>
+        dispatcher_t;
+
+   public:
+    exact_divider() {}
+
+    // Constructor that takes the divisor as a parameter
+    LIBDIVIDE_INLINE exact_divider(T d) : div(d) {}
+
+    // Divides n, which must be a multiple of the divisor
+    LIBDIVIDE_INLINE T divide(T n) const { return div.divide(n); }
+
+    // Recovers the divisor, returns the value that was
+    // used to initialize this divider object.
+    T recover() const { return div.recover(); }
+
+    bool operator==(const exact_divider<T> &other) const {
+        return div.denom.inverse == other.div.denom.inverse &&
+               div.denom.shift == other.div.denom.shift;
+    }
+
+    bool operator!=(const exact_divider<T> &other) const { return !(*this == other); }
+
+    // Vector variants treat the input as packed integer values with the
+    // same type as the divider, all of them must be multiples of the
+    // divisor.
+#if defined(LIBDIVIDE_SSE2)
+    LIBDIVIDE_INLINE __m128i divide(__m128i n) const { return div.divide(n); }
+#endif
+#if defined(LIBDIVIDE_AVX2)
+    LIBDIVIDE_INLINE __m256i divide(__m256i n) const { return div.divide(n); }
+#endif
+#if defined(LIBDIVIDE_AVX512)
+    LIBDIVIDE_INLINE __m512i divide(__m512i n) const { return div.divide(n); }
+#endif
+#if defined(LIBDIVIDE_NEON)
+    LIBDIVIDE_INLINE typename NeonVecFor<T>::type divide(typename NeonVecFor<T>::type n) const {
+        return div.divide(n);
+    }
+#endif
+
+   private:
+    dispatcher_t div;
+};
+
+// Overload of operator / for exact division
+template <typename T>
+LIBDIVIDE_INLINE T operator/(T n, const exact_divider<T> &div) {
+    return div.divide(n);
+}
+
+// Overload of operator /= for exact division
+template <typename T>
+LIBDIVIDE_INLINE T &operator/=(T &n, const exact_divider<T> &div) {
+    n = div.divide(n);
+    return n;
+}
+
+#if defined(LIBDIVIDE_SSE2)
+template <typename T>
+LIBDIVIDE_INLINE __m128i operator/(__m128i n, const exact_divider<T> &div) {
+    return div.divide(n);
+}
+#endif
+#if defined(LIBDIVIDE_AVX2)
+template <typename T>
+LIBDIVIDE_INLINE __m256i operator/(__m256i n, const exact_divider<T> &div) {
+    return div.divide(n);
+}
+#endif
+#if defined(LIBDIVIDE_AVX512)
+template <typename T>
+LIBDIVIDE_INLINE __m512i operator/(__m512i n, const exact_divider<T> &div) {
+    return div.divide(n);
+}
+#endif
+#if defined(LIBDIVIDE_NEON)
+template <typename T>
+LIBDIVIDE_INLINE typename NeonVecFor<T>::type operator/(
+    typename NeonVecFor<T>::type n, const exact_divider<T> &div) {
+    return div.divide(n);
+}
+#endif
+
+// Divides by a runtime constant rounding the quotients toward -infinity
+// (ROUND_FLOOR), toward +infinity (ROUND_CEIL) or such that the remainder
+// is non-negative (ROUND_EUCLID). The rounding mode is a template
+// parameter, the correction is part of the division sequence.
+template <typename T, Rounding R, Branching ALGO = BRANCHFULL>
+class rounding_divider {
+   private:
+    typedef detail::round_dispatcher<sizeof(T) * 8,
+        (((T)0 >> 0) > (T)(-1) ? detail::SIGNED : detail::UNSIGNED), ALGO>
+        dispatcher_t;
+
+   public:
+    rounding_divider() {}
 
-#ifdef __cplusplus
+    // Constructor that takes the divisor as a parameter
+    LIBDIVIDE_INLINE rounding_divider(T d) : div(d, (libdivide_rounding)R) {}
 
-enum Branching {
-    BRANCHFULL,  // use branching algorithms
-    BRANCHFREE   // use branchfree algorithms
-};
+    // Divides n by the divisor
+    LIBDIVIDE_INLINE T divide(T n) const { return div.divide(n); }
 
-namespace detail {
-enum Signedness {
-    SIGNED,
-    UNSIGNED,
-};
+    // Recovers the divisor, returns the value that was
+    // used to initialize this divider object.
+    T recover() const { return div.recover(); }
 
-#if defined(LIBDIVIDE_NEON)
-// Helper to deduce NEON vector type for integral type.
-template <int _WIDTH, Signedness _SIGN>
-struct NeonVec {};
+    bool operator==(const rounding_divider<T, R, ALGO> &other) const {
+        return div.denom.magic == other.div.denom.magic &&
+               div.denom.more == other.div.denom.more &&
+               div.denom.round == other.div.denom.round;
+    }
 
-template <>
-struct NeonVec<16, UNSIGNED> {
-    typedef uint16x8_t type;
-};
+    bool operator!=(const rounding_divider<T, R, ALGO> &other) const {
+        return !(*this == other);
+    }
 
-template <>
-struct NeonVec<16, SIGNED> {
-    typedef int16x8_t type;
-};
+    // Vector variants treat the input as packed integer values with the
+    // same type as the divider.
+#if defined(LIBDIVIDE_SSE2)
+    LIBDIVIDE_INLINE __m128i divide(__m128i n) const { return div.divide(n); }
+#endif
+#if defined(LIBDIVIDE_AVX2)
+    LIBDIVIDE_INLINE __m256i divide(__m256i n) const { return div.divide(n); }
+#endif
+#if defined(LIBDIVIDE_AVX512)
+    LIBDIVIDE_INLINE __m512i divide(__m512i n) const { return div.divide(n); }
+#endif
 
-template <>
-struct NeonVec<32, UNSIGNED> {
-    typedef uint32x4_t type;
+   private:
+    dispatcher_t div;
 };
 
-template <>
-struct NeonVec<32, SIGNED> {
-    typedef int32x4_t type;
-};
+// Overload of operator / for rounding division
+template <typename T, Rounding R, Branching ALGO>
+LIBDIVIDE_INLINE T operator/(T n, const rounding_divider<T, R, ALGO> &div) {
+    return div.divide(n);
+}
 
-template <>
-struct NeonVec<64, UNSIGNED> {
-    typedef uint64x2_t type;
-};
+// Overload of operator /= for rounding division
+template <typename T, Rounding R, Branching ALGO>
+LIBDIVIDE_INLINE T &operator/=(T &n, const rounding_divider<T, R, ALGO> &div) {
+    n = div.divide(n);
+    return n;
+}
 
-template <>
-struct NeonVec<64, SIGNED> {
-    typedef int64x2_t type;
-};
+#if defined(LIBDIVIDE_SSE2)
+template <typename T, Rounding R, Branching ALGO>
+LIBDIVIDE_INLINE __m128i operator/(__m128i n, const rounding_divider<T, R, ALGO> &div) {
+    return div.divide(n);
+}
+#endif
+#if defined(LIBDIVIDE_AVX2)
+template <typename T, Rounding R, Branching ALGO>
+LIBDIVIDE_INLINE __m256i operator/(__m256i n, const rounding_divider<T, R, ALGO> &div) {
+    return div.divide(n);
+}
+#endif
+#if defined(LIBDIVIDE_AVX512)
+template <typename T, Rounding R, Branching ALGO>
+LIBDIVIDE_INLINE __m512i operator/(__m512i n, const rounding_divider<T, R, ALGO> &div) {
+    return div.divide(n);
+}
+#endif
 
+// Divides 16-bit and 32-bit integers by multiplying with the floating
+// point reciprocal of the divisor. The quotients are the same as divider's,
+// which of the two is faster for vectors depends on the CPU, see
+// test/benchmark.h.
 template <typename T>
-struct NeonVecFor {
-    // See 'class divider' for an explanation of these template parameters.
-    typedef typename NeonVec<sizeof(T) * 8, (((T)0 >> 0) > (T)(-1) ? SIGNED : UNSIGNED)>::type type;
-};
+class fp_divider {
+   private:
+    typedef detail::fp_dispatcher<sizeof(T) * 8,
+        (((T)0 >> 0) > (T)(-1) ? detail::SIGNED : detail::UNSIGNED)>
+        dispatcher_t;
 
-#define LIBDIVIDE_DIVIDE_NEON(ALGO, INT_TYPE)                    \
-    LIBDIVIDE_INLINE typename NeonVecFor<INT_TYPE>::type divide( \
-        typename NeonVecFor<INT_TYPE>::type n) const {           \
-        return libdivide_##ALGO##_do_vec128(n, &denom);          \
-    }
-#else
-#define LIBDIVIDE_DIVIDE_NEON(ALGO, INT_TYPE)
-#endif
+   public:
+    fp_divider() {}
 
-#if defined(LIBDIVIDE_SVE)
-// Helper to deduce SVE vector type for integral type.
-template <int _WIDTH, Signedness _SIGN>
-struct SveVec {};
+    // Constructor that takes the divisor as a parameter
+    LIBDIVIDE_INLINE fp_divider(T d) : div(d) {}
 
-template <>
-struct SveVec<16, UNSIGNED> {
-    typedef svuint16_t type;
-};
+    // Divides n by the divisor
+    LIBDIVIDE_INLINE T divide(T n) const { return div.divide(n); }
 
-template <>
-struct SveVec<16, SIGNED> {
-    typedef svint16_t type;
-};
+    // Recovers the divisor, returns the value that was
+    // used to initialize this divider object.
+    T recover() const { return div.recover(); }
 
-template <>
-struct SveVec<32, UNSIGNED> {
-    typedef svuint32_t type;
-};
+    bool operator==(const fp_divider<T> &other) const {
+        return div.denom.recip == other.div.denom.recip;
+    }
 
-template <>
-struct SveVec<32, SIGNED> {
-    typedef svint32_t type;
-};
+    bool operator!=(const fp_divider<T> &other) const { return !(*this == other); }
 
-template <>
-struct SveVec<64, UNSIGNED> {
-    typedef svuint64_t type;
-};
+    // Vector variants treat the input as packed integer values with the
+    // same type as the divider.
+#if defined(LIBDIVIDE_SSE2)
+    LIBDIVIDE_INLINE __m128i divide(__m128i n) const { return div.divide(n); }
+#endif
+#if defined(LIBDIVIDE_AVX2)
+    LIBDIVIDE_INLINE __m256i divide(__m256i n) const { return div.divide(n); }
+#endif
+#if defined(LIBDIVIDE_AVX512)
+    LIBDIVIDE_INLINE __m512i divide(__m512i n) const { return div.divide(n); }
+#endif
 
-template <>
-struct SveVec<64, SIGNED> {
-    typedef svint64_t type;
+   private:
+    dispatcher_t div;
 };
 
+// Overload of operator / for fp division
 template <typename T>
-struct SveVecFor {
-    // See 'class divider' for an explanation of these template parameters.
-    typedef typename SveVec<sizeof(T) * 8, (((T)0 >> 0) > (T)(-1) ? SIGNED : UNSIGNED)>::type type;
-};
+LIBDIVIDE_INLINE T operator/(T n, const fp_divider<T> &div) {
+    return div.divide(n);
+}
 
-#define LIBDIVIDE_DIVIDE_SVE(ALGO, INT_TYPE)                    \
-    LIBDIVIDE_INLINE typename SveVecFor<INT_TYPE>::type divide( \
-        typename SveVecFor<INT_TYPE>::type n) const {           \
-        return libdivide_##ALGO##_do_sve(n, &denom);            \
-    }
-#else
-#define LIBDIVIDE_DIVIDE_SVE(ALGO, INT_TYPE)
-#endif
+// Overload of operator /= for fp division
+template <typename T>
+LIBDIVIDE_INLINE T &operator/=(T &n, const fp_divider<T> &div) {
+    n = div.divide(n);
+    return n;
+}
 
 #if defined(LIBDIVIDE_SSE2)
-#define LIBDIVIDE_DIVIDE_SSE2(ALGO)                     \
-    LIBDIVIDE_INLINE __m128i divide(__m128i n) const {  \
-        return libdivide_##ALGO##_do_vec128(n, &denom); \
-    }
-#else
-#define LIBDIVIDE_DIVIDE_SSE2(ALGO)
+template <typename T>
+LIBDIVIDE_INLINE __m128i operator/(__m128i n, const fp_divider<T> &div) {
+    return div.divide(n);
+}
 #endif
-
 #if defined(LIBDIVIDE_AVX2)
-#define LIBDIVIDE_DIVIDE_AVX2(ALGO)                     \
-    LIBDIVIDE_INLINE __m256i divide(__m256i n) const {  \
-        return libdivide_##ALGO##_do_vec256(n, &denom); \
-    }
-#else
-#define LIBDIVIDE_DIVIDE_AVX2(ALGO)
+template <typename T>
+LIBDIVIDE_INLINE __m256i operator/(__m256i n, const fp_divider<T> &div) {
+    return div.divide(n);
+}
 #endif
-
 #if defined(LIBDIVIDE_AVX512)
-#define LIBDIVIDE_DIVIDE_AVX512(ALGO)                   \
-    LIBDIVIDE_INLINE __m512i divide(__m512i n) const {  \
-        return libdivide_##ALGO##_do_vec512(n, &denom); \
-    }
-#else
-#define LIBDIVIDE_DIVIDE_AVX512(ALGO)
+template <typename T>
+LIBDIVIDE_INLINE __m512i operator/(__m512i n, const fp_divider<T> &div) {
+    return div.divide(n);
+}
 #endif
 
-// The DISPATCHER_GEN() macro generates C++ methods (for the given integer
-// and algorithm types) that redirect to libdivide's C API.
-#define DISPATCHER_GEN(T, ALGO)                                                       \
-    libdivide_##ALGO##_t denom;                                                       \
-    LIBDIVIDE_INLINE dispatcher() {}                                                  \
-    explicit LIBDIVIDE_CONSTEXPR_INLINE dispatcher(decltype(nullptr)) : denom{} {}    \
-    LIBDIVIDE_INLINE dispatcher(T d) : denom(libdivide_##ALGO##_gen(d)) {}            \
-    LIBDIVIDE_INLINE T divide(T n) const { return libdivide_##ALGO##_do(n, &denom); } \
-    LIBDIVIDE_INLINE T recover() const { return libdivide_##ALGO##_recover(&denom); } \
-    LIBDIVIDE_DIVIDE_NEON(ALGO, T)                                                    \
-    LIBDIVIDE_DIVIDE_SVE(ALGO, T)                                                     \
-    LIBDIVIDE_DIVIDE_SSE2(ALGO)                                                       \
-    LIBDIVIDE_DIVIDE_AVX2(ALGO)                                                       \
-    LIBDIVIDE_DIVIDE_AVX512(ALGO)
+// Enumerates the quotients and remainders of the numerators start,
+// start + step, start + 2 * step, ... by d for unsigned T, e.g. the rows
+// and columns of flat indices. Only start and step are divided, advancing
+// adds the quotient and the remainder of step and a carry instead of
+// dividing. The numerators wrap around like unsigned integers, the
+// quotient is then recomputed by division. See iota_divmod() for arrays.
+template <typename T>
+class quotient_iterator {
+   public:
+    quotient_iterator() : d(1), step(0), numer(0), quot(0), rem(0), q_step(0), r_step(0) {}
+
+    // Constructor that takes the first numerator, the step and the divisor
+    LIBDIVIDE_INLINE quotient_iterator(T start, T step_, T d_)
+        : div(d_), d(d_), step(step_), numer(start) {
+        quot = div.divide(numer);
+        rem = (T)(numer - quot * d);
+        q_step = div.divide(step);
+        r_step = (T)(step - q_step * d);
+    }
 
-// The dispatcher selects a specific division algorithm for a given
-// width, signedness, and ALGO using partial template specialization.
-template <int _WIDTH, Signedness _SIGN, Branching _ALGO>
-struct dispatcher {};
+    // The current numerator, its quotient and its remainder
+    LIBDIVIDE_INLINE T value() const { return numer; }
+    LIBDIVIDE_INLINE T quotient() const { return quot; }
+    LIBDIVIDE_INLINE T remainder() const { return rem; }
+
+    // Advances to the next numerator
+    LIBDIVIDE_INLINE quotient_iterator &operator++() {
+        numer = (T)(numer + step);
+        if (numer < step) {
+            quot = div.divide(numer);
+            rem = (T)(numer - quot * d);
+        } else {
+            T carry = (T)(rem >= (T)(d - r_step));
+            quot = (T)(quot + q_step + carry);
+            rem = (T)(carry ? rem - (T)(d - r_step) : rem + r_step);
+        }
+        return *this;
+    }
 
-template <>
-struct dispatcher<16, SIGNED, BRANCHFULL> {
-    DISPATCHER_GEN(int16_t, s16)
-};
-template <>
-struct dispatcher<16, SIGNED, BRANCHFREE> {
-    DISPATCHER_GEN(int16_t, s16_branchfree)
-};
-template <>
-struct dispatcher<16, UNSIGNED, BRANCHFULL> {
-    DISPATCHER_GEN(uint16_t, u16)
-};
-template <>
-struct dispatcher<16, UNSIGNED, BRANCHFREE> {
-    DISPATCHER_GEN(uint16_t, u16_branchfree)
-};
-template <>
-struct dispatcher<32, SIGNED, BRANCHFULL> {
-    DISPATCHER_GEN(int32_t, s32)
-};
-template <>
-struct dispatcher<32, SIGNED, BRANCHFREE> {
-    DISPATCHER_GEN(int32_t, s32_branchfree)
-};
-template <>
-struct dispatcher<32, UNSIGNED, BRANCHFULL> {
-    DISPATCHER_GEN(uint32_t, u32)
-};
-template <>
-struct dispatcher<32, UNSIGNED, BRANCHFREE> {
-    DISPATCHER_GEN(uint32_t, u32_branchfree)
-};
-template <>
-struct dispatcher<64, SIGNED, BRANCHFULL> {
-    DISPATCHER_GEN(int64_t, s64)
-};
-template <>
-struct dispatcher<64, SIGNED, BRANCHFREE> {
-    DISPATCHER_GEN(int64_t, s64_branchfree)
-};
-template <>
-struct dispatcher<64, UNSIGNED, BRANCHFULL> {
-    DISPATCHER_GEN(uint64_t, u64)
-};
-template <>
-struct dispatcher<64, UNSIGNED, BRANCHFREE> {
-    DISPATCHER_GEN(uint64_t, u64_branchfree)
+    LIBDIVIDE_INLINE quotient_iterator operator++(int) {
+        quotient_iterator old = *this;
+        ++*this;
+        return old;
+    }
+
+   private:
+    divider<T> div;
+    T d;
+    T step;
+    T numer;
+    T quot;
+    T rem;
+    T q_step;
+    T r_step;
 };
-}  // namespace detail
 
-#if defined(LIBDIVIDE_NEON)
-// Allow NeonVecFor outside of detail namespace.
-template <typename T>
-struct NeonVecFor {
-    typedef typename detail::NeonVecFor<T>::type type;
+// index_decomposer splits linear indices into the coordinates of a
+// row-major tensor of up to MaxRank dimensions whose extents are only known
+// at runtime, the coordinates are the remainders of the divisions by the
+// extents from the innermost dimension outwards. It also recombines
+// coordinates into indices with other strides, e.g. to transpose or
+// permute the dimensions. T must be uint32_t or uint64_t.
+template <typename T, size_t MaxRank>
+class index_decomposer {
+   private:
+    typedef detail::decompose_dispatcher<sizeof(T) * 8,
+        (((T)0 >> 0) > (T)(-1) ? detail::SIGNED : detail::UNSIGNED), MaxRank>
+        dispatcher_t;
+
+   public:
+    index_decomposer() {}
+
+    // Creates the dividers by extents[1], ..., extents[rank - 1], rank must
+    // be between 1 and MaxRank. extents[0] is not divided by, indices past
+    // the end of the tensor get an outermost coordinate >= extents[0].
+    index_decomposer(const T *extents, size_t rank) : div(extents, rank) {}
+
+    LIBDIVIDE_INLINE size_t rank() const { return div.rank; }
+    LIBDIVIDE_INLINE T extent(size_t k) const { return div.extents[k]; }
+
+    // Stores the coordinates of index in coords[0], ..., coords[rank - 1]
+    LIBDIVIDE_INLINE void decompose(T index, T *coords) const { div.decompose(index, coords); }
+
+    // Stores coordinate k of indices[i] in coords[k][i]
+    LIBDIVIDE_INLINE void decompose(const T *indices, size_t count, T *const *coords) const {
+        div.decompose(indices, count, coords);
+    }
+
+    // Lane j of coords[k] is coordinate k of lane j of indices
+#if defined(LIBDIVIDE_AVX2)
+    LIBDIVIDE_INLINE void decompose(__m256i indices, __m256i *coords) const {
+        div.decompose(indices, coords);
+    }
+#endif
+#if defined(LIBDIVIDE_AVX512)
+    LIBDIVIDE_INLINE void decompose(__m512i indices, __m512i *coords) const {
+        div.decompose(indices, coords);
+    }
+#endif
+
+    // Returns the index of coords in this tensor, the inverse of decompose()
+    LIBDIVIDE_INLINE T linearize(const T *coords) const {
+        T index = coords[0];
+        for (size_t k = 1; k < div.rank; k++) {
+            index = (T)(index * div.extents[k] + coords[k]);
+        }
+        return index;
+    }
+
+    // Returns coords[0] * strides[0] + ... + coords[rank - 1] * strides[rank - 1]
+    LIBDIVIDE_INLINE T linearize(const T *coords, const T *strides) const {
+        T index = 0;
+        for (size_t k = 0; k < div.rank; k++) {
+            index = (T)(index + coords[k] * strides[k]);
+        }
+        return index;
+    }
+
+    // out[i] = linearize() of the coordinates coords[k][i] with strides
+    LIBDIVIDE_INLINE void linearize(
+        T *const *coords, size_t count, const T *strides, T *out) const {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = (T)(coords[0][i] * strides[0]);
+        }
+        for (size_t k = 1; k < div.rank; k++) {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = (T)(out[i] + coords[k][i] * strides[k]);
+            }
+        }
+    }
+
+    // Returns the index of the coordinates of index with strides
+    LIBDIVIDE_INLINE T remap(T index, const T *strides) const {
+        T coords[MaxRank];
+        div.decompose(index, coords);
+        return linearize(coords, strides);
+    }
+
+    // out[i] = remap(indices[i], strides) without storing the coordinates,
+    // indices and out may be the same array
+    LIBDIVIDE_INLINE void remap(const T *indices, size_t count, const T *strides, T *out) const {
+        div.remap(indices, count, strides, out);
+    }
+
+    // Stores in strides the strides of the dimensions of this tensor within
+    // the row-major tensor whose dimension j is dimension perm[j] of this
+    // one, for use with remap(). E.g. perm = {1, 0} transposes a matrix.
+    LIBDIVIDE_INLINE void permuted_strides(const size_t *perm, T *strides) const {
+        T stride = 1;
+        for (size_t j = div.rank; j-- > 0;) {
+            strides[perm[j]] = stride;
+            stride = (T)(stride * div.extents[perm[j]]);
+        }
+    }
+
+   private:
+    dispatcher_t div;
 };
-#endif
 
-#if defined(LIBDIVIDE_SVE)
-// Allow SveVecFor outside of detail namespace.
+// mod_reducer computes remainders modulo a runtime modulus m without
+// hardware division, for uint32_t and uint64_t: Barrett reduction of
+// double width numbers, e.g. the products of modular multiplications, and
+// for odd m Montgomery multiplication, which is cheaper for long chains of
+// multiplications such as powmod().
 template <typename T>
-struct SveVecFor {
-    typedef typename detail::SveVecFor<T>::type type;
+class mod_reducer {
+   private:
+    typedef detail::reducer_dispatcher<sizeof(T) * 8,
+        (((T)0 >> 0) > (T)(-1) ? detail::SIGNED : detail::UNSIGNED)>
+        dispatcher_t;
+
+   public:
+    mod_reducer() {}
+
+    // Constructor that takes the modulus m != 0 as a parameter
+    LIBDIVIDE_INLINE mod_reducer(T m) : div(m) {}
+
+    LIBDIVIDE_INLINE T modulus() const { return div.reducer.m; }
+
+    // n % m, n is a double width number for uint32_t
+    LIBDIVIDE_INLINE T reduce(uint64_t n) const { return div.reduce(n); }
+
+    // (hi * 2^64 + lo) % m
+    LIBDIVIDE_INLINE T reduce(uint64_t hi, uint64_t lo) const { return div.reduce(hi, lo); }
+
+    // a * b % m
+    LIBDIVIDE_INLINE T mulmod(T a, T b) const { return div.mulmod(a, b); }
+
+    // (a + b) % m and (a - b) % m, these require a < m and b < m
+    LIBDIVIDE_INLINE T addmod(T a, T b) const { return div.addmod(a, b); }
+    LIBDIVIDE_INLINE T submod(T a, T b) const { return div.submod(a, b); }
+
+    // base^exp % m, computed in Montgomery form if m is odd
+    LIBDIVIDE_INLINE T powmod(T base, uint64_t exp) const { return div.powmod(base, exp); }
+
+    // c[i] = a[i] * b[i] % m, (a[i] + b[i]) % m and (a[i] - b[i]) % m for
+    // i < count, using SIMD if available. The elements of a and b must be
+    // less than m, c may be the same array as a or b.
+    LIBDIVIDE_INLINE void mulmod(const T *a, const T *b, T *c, size_t count) const {
+        div.mulmod(a, b, c, count);
+    }
+    LIBDIVIDE_INLINE void addmod(const T *a, const T *b, T *c, size_t count) const {
+        div.addmod(a, b, c, count);
+    }
+    LIBDIVIDE_INLINE void submod(const T *a, const T *b, T *c, size_t count) const {
+        div.submod(a, b, c, count);
+    }
+
+    // powers[i] = bases[i]^exp % m for i < count
+    LIBDIVIDE_INLINE void powmod(const T *bases, T *powers, size_t count, uint64_t exp) const {
+        div.powmod(bases, powers, count, exp);
+    }
+
+    // Conversions into and out of Montgomery form a * 2^w % m (w is the
+    // width of T) and the product of two numbers in Montgomery form. These
+    // require an odd m, montgomery_mul() requires a < m or b < m.
+    LIBDIVIDE_INLINE T to_montgomery(T a) const { return div.to_montgomery(a); }
+    LIBDIVIDE_INLINE T from_montgomery(T a) const { return div.from_montgomery(a); }
+    LIBDIVIDE_INLINE T montgomery_mul(T a, T b) const { return div.montgomery_mul(a, b); }
+
+   private:
+    dispatcher_t div;
 };
-#endif
 
-// This is the main divider class for use by the user (C++ API).
-// The actual division algorithm is selected using the dispatcher struct
-// based on the integer width and algorithm template parameters.
-template <typename T, Branching ALGO = BRANCHFULL>
-class divider {
+// Computes a * b / c by a runtime constant c from the double width product,
+// so a * b may overflow T but the quotient must not, like av_rescale_rnd()
+// of FFmpeg. Only for int64_t and uint64_t. The quotients are rounded
+// toward -infinity by default, see Rounding for the other modes.
+template <typename T>
+class muldiv_divider {
    private:
-    // Dispatch based on the size and signedness.
-    // We avoid using type_traits as it's not available in AVR.
-    // Detect signedness by checking if T(-1) is less than T(0).
-    // Also throw in a shift by 0, which prevents floating point types from being passed.
-    typedef detail::dispatcher<sizeof(T) * 8,
-        (((T)0 >> 0) > (T)(-1) ? detail::SIGNED : detail::UNSIGNED), ALGO>
+    typedef detail::muldiv_dispatcher<sizeof(T) * 8,
+        (((T)0 >> 0) > (T)(-1) ? detail::SIGNED : detail::UNSIGNED)>
         dispatcher_t;
 
    public:
-    // We leave the default constructor empty so that creating
-    // an array of dividers and then initializing them
-    // later doesn't slow us down.
-    divider() {}
+    muldiv_divider() {}
 
-    // constexpr zero-initialization to allow for use w/ static constinit
-    explicit LIBDIVIDE_CONSTEXPR_INLINE divider(decltype(nullptr)) : div(nullptr) {}
+    // Constructor that takes the divisor c != 0 and the rounding mode
+    LIBDIVIDE_INLINE muldiv_divider(T c, Rounding rounding = ROUND_FLOOR)
+        : div(c, (libdivide_rounding)rounding) {}
 
-    // Constructor that takes the divisor as a parameter
-    LIBDIVIDE_INLINE divider(T d) : div(d) {}
+    // a * b / c
+    LIBDIVIDE_INLINE T muldiv(T a, T b) const { return div.muldiv(a, b); }
 
-    // Divides n by the divisor
-    LIBDIVIDE_INLINE T divide(T n) const { return div.divide(n); }
+    // results[i] = a[i] * b / c for i < count, results may be the same
+    // array as a
+    LIBDIVIDE_INLINE void muldiv(const T *a, T b, T *results, size_t count) const {
+        div.muldiv(a, b, results, count);
+    }
 
-    // Recovers the divisor, returns the value that was
-    // used to initialize this divider object.
+    // Recovers the divisor c
     T recover() const { return div.recover(); }
 
-    bool operator==(const divider<T, ALGO> &other) const {
-        return div.denom.magic == other.div.denom.magic && div.denom.more == other.div.denom.more;
+    bool operator==(const muldiv_divider<T> &other) const {
+        return div.denom.denom.d == other.div.denom.denom.d &&
+               div.denom.denom.shift == other.div.denom.denom.shift &&
+               div.denom.round == other.div.denom.round;
     }
 
-    bool operator!=(const divider<T, ALGO> &other) const { return !(*this == other); }
+    bool operator!=(const muldiv_divider<T> &other) const { return !(*this == other); }
 
-    // Vector variants treat the input as packed integer values with the same type as the divider
-    // (e.g. s32, u32, s64, u64) and divides each of them by the divider, returning the packed
-    // quotients.
+   private:
+    dispatcher_t div;
+};
+
+// Scales uint32_t and uint64_t integers by a runtime constant fraction
+// num / den, x * num / den is computed without overflow of the product,
+// e.g. to convert sample rates or units. The quotients are rounded toward
+// -infinity by default, see Rounding. Quotients that don't fit in T wrap
+// around unless saturate is true, then they are clamped to the maximum.
+template <typename T>
+class rational_scaler {
+   private:
+    typedef detail::scaler_dispatcher<sizeof(T) * 8,
+        (((T)0 >> 0) > (T)(-1) ? detail::SIGNED : detail::UNSIGNED)>
+        dispatcher_t;
+
+   public:
+    rational_scaler() {}
+
+    // Constructor that takes the fraction with den != 0, the rounding mode
+    // and whether the quotients saturate
+    LIBDIVIDE_INLINE rational_scaler(
+        T num, T den, Rounding rounding = ROUND_FLOOR, bool saturate = false)
+        : div(num, den, (libdivide_rounding)rounding, saturate) {}
+
+    // x * num / den
+    LIBDIVIDE_INLINE T scale(T x) const { return div.scale(x); }
+
+    // results[i] = x[i] * num / den for i < count, using SIMD if available.
+    // results may be the same array as x.
+    LIBDIVIDE_INLINE void scale(const T *x, T *results, size_t count) const {
+        div.scale(x, results, count);
+    }
+
+    // Vector variants treat the input as packed integer values of type T
+#if defined(LIBDIVIDE_SSE2)
+    LIBDIVIDE_INLINE __m128i scale(__m128i x) const { return div.scale(x); }
+#endif
+#if defined(LIBDIVIDE_AVX2)
+    LIBDIVIDE_INLINE __m256i scale(__m256i x) const { return div.scale(x); }
+#endif
+#if defined(LIBDIVIDE_AVX512)
+    LIBDIVIDE_INLINE __m512i scale(__m512i x) const { return div.scale(x); }
+#endif
+
+   private:
+    dispatcher_t div;
+};
+
+// Divides uint16_t, uint32_t and uint64_t integers into fixed-point
+// quotients with FRAC_BITS fraction bits, 0 <= FRAC_BITS <= the width of T:
+// divide(n) is (n << FRAC_BITS) / d computed without a wider integer type,
+// e.g. fixed_divider<uint32_t, 16> yields Q16.16 and fixed_divider<uint32_t,
+// 32> Q0.32 ratios n / d. Quotients that don't fit in T wrap around.
+template <typename T, int FRAC_BITS>
+class fixed_divider {
+   private:
+    typedef detail::fixed_dispatcher<sizeof(T) * 8,
+        (((T)0 >> 0) > (T)(-1) ? detail::SIGNED : detail::UNSIGNED)>
+        dispatcher_t;
+
+   public:
+    fixed_divider() {}
+
+    // Constructor that takes the divisor as a parameter
+    LIBDIVIDE_INLINE fixed_divider(T d) : div(d, FRAC_BITS) {}
+
+    // (n << FRAC_BITS) / d
+    LIBDIVIDE_INLINE T divide(T n) const { return div.divide(n); }
+
+    // Vector variants treat the input as packed integer values of type T
 #if defined(LIBDIVIDE_SSE2)
     LIBDIVIDE_INLINE __m128i divide(__m128i n) const { return div.divide(n); }
 #endif
@@ -3690,107 +12539,221 @@ class divider {
 #if defined(LIBDIVIDE_AVX512)
     LIBDIVIDE_INLINE __m512i divide(__m512i n) const { return div.divide(n); }
 #endif
-#if defined(LIBDIVIDE_NEON)
-    LIBDIVIDE_INLINE typename NeonVecFor<T>::type divide(typename NeonVecFor<T>::type n) const {
-        return div.divide(n);
-    }
-#endif
-#if defined(LIBDIVIDE_SVE)
-    LIBDIVIDE_INLINE typename SveVecFor<T>::type divide(typename SveVecFor<T>::type n) const {
-        return div.divide(n);
-    }
-#endif
 
    private:
-    // Storage for the actual divisor
     dispatcher_t div;
 };
 
-// Overload of operator / for scalar division
-template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE T operator/(T n, const divider<T, ALGO> &div) {
-    return div.divide(n);
-}
+#if !defined(__AVR__) && __STDC_HOSTED__ != 0
+// A table of dividers indexed by integers, e.g. per-group divisors
+// indexed by group id. The magic numbers and the more fields are stored in
+// separate cache line aligned arrays, which the AVX512 and AVX2 kernels can
+// gather by index, unlike arrays of the packed divider structs. The table
+// is limited to 2^31 - 1 dividers as the gathers use signed indices. It
+// defaults to branchfree dividers since the gather kernels exist only for
+// the branchfree dividers of 32-bit and 64-bit integers.
+template <typename T, Branching ALGO = BRANCHFREE>
+class divider_table {
+   private:
+    typedef detail::table_dispatcher<sizeof(T) * 8,
+        (((T)0 >> 0) > (T)(-1) ? detail::SIGNED : detail::UNSIGNED), ALGO>
+        dispatcher_t;
 
-// Overload of operator /= for scalar division
-template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE T &operator/=(T &n, const divider<T, ALGO> &div) {
-    n = div.divide(n);
-    return n;
-}
+   public:
+    divider_table() : storage(nullptr), magics(nullptr), mores(nullptr), len(0) {}
 
-// Overloads for vector types.
-#if defined(LIBDIVIDE_SSE2)
-template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE __m128i operator/(__m128i n, const divider<T, ALGO> &div) {
-    return div.divide(n);
-}
+    // Creates a table of count dividers by d
+    divider_table(size_t count, T d) : storage(nullptr) {
+        allocate(count);
+        for (size_t i = 0; i < count; i++) {
+            dispatcher_t::gen(d, &magics[i], &mores[i]);
+        }
+    }
 
-template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE __m128i operator/=(__m128i &n, const divider<T, ALGO> &div) {
-    n = div.divide(n);
-    return n;
-}
-#endif
-#if defined(LIBDIVIDE_AVX2)
-template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE __m256i operator/(__m256i n, const divider<T, ALGO> &div) {
-    return div.divide(n);
-}
+    // Creates a table of the dividers by divisors[0], ..., divisors[count - 1]
+    divider_table(const T *divisors, size_t count) : storage(nullptr) { build(divisors, count); }
 
-template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE __m256i operator/=(__m256i &n, const divider<T, ALGO> &div) {
-    n = div.divide(n);
-    return n;
-}
+    divider_table(const divider_table &other) : storage(nullptr) {
+        allocate(other.len);
+        for (size_t i = 0; i < len; i++) {
+            magics[i] = other.magics[i];
+            mores[i] = other.mores[i];
+        }
+    }
+
+    divider_table(divider_table &&other) noexcept
+        : storage(other.storage), magics(other.magics), mores(other.mores), len(other.len) {
+        other.storage = nullptr;
+        other.magics = nullptr;
+        other.mores = nullptr;
+        other.len = 0;
+    }
+
+    divider_table &operator=(divider_table other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~divider_table() { free(storage); }
+
+    void swap(divider_table &other) noexcept {
+        void *s = storage;
+        T *m = magics;
+        uint8_t *mo = mores;
+        size_t l = len;
+        storage = other.storage;
+        magics = other.magics;
+        mores = other.mores;
+        len = other.len;
+        other.storage = s;
+        other.magics = m;
+        other.mores = mo;
+        other.len = l;
+    }
+
+    // Returns the number of dividers
+    size_t size() const { return len; }
+
+    // Replaces all dividers by the dividers by divisors[0], ...,
+    // divisors[count - 1]. The dividers of 32-bit unsigned integers are
+    // generated 8 at a time with AVX2 or AVX512 if available, the other
+    // ones in a scalar loop.
+    void build(const T *divisors, size_t count) {
+        free(storage);
+        storage = nullptr;
+        allocate(count);
+        dispatcher_t::gen(divisors, magics, mores, count);
+    }
+
+    // Replaces the divider number i by the divider by d
+    LIBDIVIDE_INLINE void set(size_t i, T d) { dispatcher_t::gen(d, &magics[i], &mores[i]); }
+
+    // Recovers the divisor of the divider number i
+    T recover(size_t i) const { return dispatcher_t::recover(magics[i], mores[i]); }
+
+    // Divides n by the divider number i
+    LIBDIVIDE_INLINE T divide(T n, size_t i) const {
+        return dispatcher_t::divide(n, magics[i], mores[i]);
+    }
+
+    // Divides numers[j] by the divider number indices[j] for each j < count
+    // and stores the quotients in quots, numers may be quots. Branchfree
+    // dividers of 32-bit and 64-bit integers use the widest vector
+    // instruction set available, the other ones a scalar loop.
+    LIBDIVIDE_INLINE void divide(
+        const T *numers, const uint32_t *indices, T *quots, size_t count) const {
+        dispatcher_t::divide(numers, indices, quots, count, magics, mores);
+    }
+
+    // Vector variants, only for the branchfree dividers of 32-bit and
+    // 64-bit integers. Lane j of numers is divided by the divider number
+    // indices[j]. The indices are 32-bit integers, for 64-bit integers
+    // they fill the vector of half the size.
+#if defined(LIBDIVIDE_AVX2)
+    LIBDIVIDE_INLINE __m256i divide(__m256i numers, __m256i indices) const {
+        return dispatcher_t::divide(numers, indices, magics, mores);
+    }
+    LIBDIVIDE_INLINE __m256i divide(__m256i numers, __m128i indices) const {
+        return dispatcher_t::divide(numers, indices, magics, mores);
+    }
 #endif
 #if defined(LIBDIVIDE_AVX512)
-template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE __m512i operator/(__m512i n, const divider<T, ALGO> &div) {
-    return div.divide(n);
-}
-
-template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE __m512i operator/=(__m512i &n, const divider<T, ALGO> &div) {
-    n = div.divide(n);
-    return n;
-}
+    LIBDIVIDE_INLINE __m512i divide(__m512i numers, __m512i indices) const {
+        return dispatcher_t::divide(numers, indices, magics, mores);
+    }
+    LIBDIVIDE_INLINE __m512i divide(__m512i numers, __m256i indices) const {
+        return dispatcher_t::divide(numers, indices, magics, mores);
+    }
 #endif
 
-#if defined(LIBDIVIDE_NEON)
-template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE typename NeonVecFor<T>::type operator/(
-    typename NeonVecFor<T>::type n, const divider<T, ALGO> &div) {
-    return div.divide(n);
-}
+   private:
+    // Both arrays start on a cache line. The vector kernels gather the
+    // more fields as lane sized words, so 7 zero bytes follow the last one.
+    void allocate(size_t count) {
+        if (count > (size_t)INT32_MAX) {
+            LIBDIVIDE_ERROR("divider_table is limited to 2^31 - 1 dividers");
+        }
+        const size_t line = 64;
+        size_t magic_bytes = (count * sizeof(T) + line - 1) & ~(line - 1);
+        size_t more_bytes = (count + 7 + line - 1) & ~(line - 1);
+        storage = malloc(magic_bytes + more_bytes + line - 1);
+        if (!storage) {
+            LIBDIVIDE_ERROR("out of memory");
+        }
+        char *base = (char *)(((uintptr_t)storage + line - 1) & ~(uintptr_t)(line - 1));
+        magics = (T *)(void *)base;
+        mores = (uint8_t *)(base + magic_bytes);
+        len = count;
+        for (size_t i = count; i < count + 7; i++) {
+            mores[i] = 0;
+        }
+    }
 
-template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE typename NeonVecFor<T>::type operator/=(
-    typename NeonVecFor<T>::type &n, const divider<T, ALGO> &div) {
-    n = div.divide(n);
-    return n;
-}
+    void *storage;
+    T *magics;
+    uint8_t *mores;
+    size_t len;
+};
 #endif
 
-#if defined(LIBDIVIDE_SVE)
-template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE typename SveVecFor<T>::type operator/(
-    typename SveVecFor<T>::type n, const divider<T, ALGO> &div) {
-    return div.divide(n);
-}
+// Up to 16 branchfree dividers selected per element by a small code, e.g.
+// for dictionary encoded columns of divisors such as currency scales or
+// units. The AVX512 and AVX2 kernels keep the dictionary in registers and
+// select the dividers with permutations. 16-bit integers are divided with
+// 32-bit dividers, the vector overloads exist for 32 and 64-bit integers.
+template <typename T>
+class divider_dict {
+   private:
+    typedef detail::dict_dispatcher<sizeof(T) * 8,
+        (((T)0 >> 0) > (T)(-1) ? detail::SIGNED : detail::UNSIGNED)>
+        dispatcher_t;
 
-template <typename T, Branching ALGO>
-LIBDIVIDE_INLINE typename SveVecFor<T>::type operator/=(
-    typename SveVecFor<T>::type &n, const divider<T, ALGO> &div) {
-    n = div.divide(n);
-    return n;
-}
+   public:
+    divider_dict() {}
+
+    // Creates the dividers by divisors[0], ..., divisors[count - 1], count
+    // must be between 1 and 16
+    divider_dict(const T *divisors, size_t count) : div(divisors, count) {}
+
+    // Returns n / divisors[code], code must be less than count
+    LIBDIVIDE_INLINE T divide(T n, uint8_t code) const { return div.divide(n, code); }
+
+    // quots[i] = numers[i] / divisors[codes[i]], numers and quots may be the
+    // same array
+    LIBDIVIDE_INLINE void divide(
+        const T *numers, const uint8_t *codes, T *quots, size_t count) const {
+        div.divide(numers, codes, quots, count);
+    }
+
+    // Lane j of the result is lane j of numers divided by divisors[c], where
+    // c is lane j of codes, a vector of integers of type T.
+#if defined(LIBDIVIDE_AVX2)
+    LIBDIVIDE_INLINE __m256i divide(__m256i numers, __m256i codes) const {
+        return div.divide(numers, codes);
+    }
+#endif
+#if defined(LIBDIVIDE_AVX512)
+    LIBDIVIDE_INLINE __m512i divide(__m512i numers, __m512i codes) const {
+        return div.divide(numers, codes);
+    }
 #endif
 
+   private:
+    dispatcher_t div;
+};
+
 #if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900)
 // libdivide::branchfree_divider<T>
 template <typename T>
 using branchfree_divider = divider<T, BRANCHFREE>;
+
+// libdivide::floor_divider<T>, ceil_divider<T> and euclid_divider<T>
+template <typename T, Branching ALGO = BRANCHFULL>
+using floor_divider = rounding_divider<T, ROUND_FLOOR, ALGO>;
+template <typename T, Branching ALGO = BRANCHFULL>
+using ceil_divider = rounding_divider<T, ROUND_CEIL, ALGO>;
+template <typename T, Branching ALGO = BRANCHFULL>
+using euclid_divider = rounding_divider<T, ROUND_EUCLID, ALGO>;
 #endif
 
 }  // namespace libdivide
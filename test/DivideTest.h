@@ -18,6 +18,7 @@ using set_t = std::numeric_limits<IntT>;
 #include <limits>
 #include <random>
 #include <string>
+#include <type_traits>
 #include <vector>
 typedef std::string string_class;
 #include <set>
@@ -171,6 +172,30 @@ class DivideTest {
             PRINT_ERROR(F("\n"));
             TEST_FAIL();
         }
+
+        T expect_rem = numer % denom;
+        T rem = numer % the_divider;
+        T divmod_quot, divmod_rem;
+        the_divider.divmod(numer, &divmod_quot, &divmod_rem);
+
+        if (rem != expect_rem || divmod_quot != expect || divmod_rem != expect_rem) {
+            PRINT_ERROR(F("Remainder failure for "));
+            PRINT_ERROR(testcase_name(ALGO));
+            PRINT_ERROR(F(": "));
+            PRINT_ERROR(numer);
+            PRINT_ERROR(F(" % "));
+            PRINT_ERROR(denom);
+            PRINT_ERROR(F(" = "));
+            PRINT_ERROR(expect_rem);
+            PRINT_ERROR(F(", but got "));
+            PRINT_ERROR(rem);
+            PRINT_ERROR(F(" (divmod "));
+            PRINT_ERROR(divmod_quot);
+            PRINT_ERROR(F(", "));
+            PRINT_ERROR(divmod_rem);
+            PRINT_ERROR(F(")\n"));
+            TEST_FAIL();
+        }
     }
 
     template <typename VecType, Branching ALGO>
@@ -193,11 +218,38 @@ class DivideTest {
             type_pun_vec vec_result;
             vec_result.vec = vec_in.vec / div;
 
+            type_pun_vec vec_rem;
+            vec_rem.vec = vec_in.vec % div;
+
+            type_pun_vec vec_divmod_quot;
+            type_pun_vec vec_divmod_rem;
+            div.divmod(vec_in.vec, &vec_divmod_quot.vec, &vec_divmod_rem.vec);
+
             for (size_t i = 0; i < countTinVec; i++) {
                 T numer = numers[i];
                 T result = vec_result.arr[i];
                 T expect = numer / denom;
 
+                // INT_MIN / -1 is undefined behavior in C/C++
+                if (!(limits::is_signed && numer == (limits::min)() && denom == T(-1))) {
+                    T expect_rem = numer % denom;
+                    if (vec_rem.arr[i] != expect_rem || vec_divmod_rem.arr[i] != expect_rem ||
+                        vec_divmod_quot.arr[i] != expect) {
+                        PRINT_ERROR(F("Vector remainder failure for: "));
+                        PRINT_ERROR(testcase_name(ALGO));
+                        PRINT_ERROR(F(": "));
+                        PRINT_ERROR(numer);
+                        PRINT_ERROR(F(" % "));
+                        PRINT_ERROR(denom);
+                        PRINT_ERROR(F(" = "));
+                        PRINT_ERROR(expect_rem);
+                        PRINT_ERROR(F(", but got "));
+                        PRINT_ERROR(vec_rem.arr[i]);
+                        PRINT_ERROR(F("\n"));
+                        TEST_FAIL();
+                    }
+                }
+
                 if (result != expect) {
                     PRINT_ERROR(F("Vector failure for: "));
                     PRINT_ERROR(testcase_name(ALGO));
@@ -356,9 +408,15 @@ class DivideTest {
         size_t offset = 64 - (size_t)&mem % 64;
         T *numers = (T *)&mem[offset];
 
-        for (size_t i = 0; i < 10000; ++i) {
+        // The vectors of 8-bit integers are filled with all the numerators.
+        // Otherwise the first vector holds max, max - 1, ..., which the
+        // unsigned round down kernels increment with saturation.
+        const size_t iterations = sizeof(T) == 1 ? 256 / min_vector_count : 10000;
+        for (size_t i = 0; i < iterations; ++i) {
             for (size_t j = 0; j < min_vector_count; j++) {
-                numers[j] = get_random();
+                numers[j] = sizeof(T) == 1 ? (T)(i * min_vector_count + j)
+                            : i == 0       ? (T)(max - j)
+                                           : get_random();
             }
 #ifdef LIBDIVIDE_SSE2
             test_vec<__m128i>(numers, min_vector_count, denom, the_divider);
@@ -378,7 +436,7 @@ class DivideTest {
         std::vector<T> sve_numers(sve_count);
         for (size_t i = 0; i < 10000; ++i) {
             for (size_t j = 0; j < sve_count; j++) {
-                sve_numers[j] = get_random();
+                sve_numers[j] = i == 0 ? (T)(max - j) : get_random();
             }
             test_vec_sve(sve_numers.data(), denom, the_divider);
         }
@@ -389,11 +447,387 @@ class DivideTest {
 #endif
     }
 
+#if !defined(__AVR__)
+    template <Branching ALGO>
+    void check_array(const T *numers, const T *quots, size_t count, T denom) {
+        for (size_t i = 0; i < count; i++) {
+            T numer = numers[i];
+            // INT_MIN / -1 is undefined behavior in C/C++
+            if (limits::is_signed && numer == (limits::min)() && denom == T(-1)) {
+                continue;
+            }
+            T expect = numer / denom;
+            if (quots[i] != expect) {
+                PRINT_ERROR(F("Array failure for: "));
+                PRINT_ERROR(testcase_name(ALGO));
+                PRINT_ERROR(F(": "));
+                PRINT_ERROR(numer);
+                PRINT_ERROR(F(" / "));
+                PRINT_ERROR(denom);
+                PRINT_ERROR(F(" = "));
+                PRINT_ERROR(expect);
+                PRINT_ERROR(F(", but got "));
+                PRINT_ERROR(quots[i]);
+                PRINT_ERROR(F("\n"));
+                TEST_FAIL();
+            }
+        }
+    }
+
+    template <Branching ALGO>
+    void check_array_rem(const T *numers, const T *rems, size_t count, T denom) {
+        for (size_t i = 0; i < count; i++) {
+            T numer = numers[i];
+            if (limits::is_signed && numer == (limits::min)() && denom == T(-1)) {
+                continue;
+            }
+            T expect = numer % denom;
+            if (rems[i] != expect) {
+                PRINT_ERROR(F("Array remainder failure for: "));
+                PRINT_ERROR(testcase_name(ALGO));
+                PRINT_ERROR(F(": "));
+                PRINT_ERROR(numer);
+                PRINT_ERROR(F(" % "));
+                PRINT_ERROR(denom);
+                PRINT_ERROR(F(" = "));
+                PRINT_ERROR(expect);
+                PRINT_ERROR(F(", but got "));
+                PRINT_ERROR(rems[i]);
+                PRINT_ERROR(F("\n"));
+                TEST_FAIL();
+            }
+        }
+    }
+
+    template <Branching ALGO>
+    void test_array_numerators(T denom, const divider<T, ALGO> &the_divider) {
+        // Use an odd length and misaligned arrays so that the scalar head,
+        // the unrolled vector loop and the tail all get exercised.
+        const size_t count = 8 * min_vector_count + 7;
+        std::vector<T> numers(count + 1);
+        std::vector<T> quots(count + 1);
+        for (size_t i = 0; i < numers.size(); i++) {
+            numers[i] = get_random();
+        }
+
+        for (size_t offset = 0; offset < 2; offset++) {
+            const T *in = numers.data() + offset;
+            T *out = quots.data() + 1 - offset;
+            the_divider.divide(in, out, count);
+            check_array<ALGO>(in, out, count, denom);
+        }
+
+        // In-place division
+        std::vector<T> inplace(numers);
+        the_divider.divide(inplace.data() + 1, count);
+        check_array<ALGO>(numers.data() + 1, inplace.data() + 1, count, denom);
+
+        std::vector<T> rems(count + 1);
+        for (size_t offset = 0; offset < 2; offset++) {
+            const T *in = numers.data() + offset;
+            T *out = rems.data() + 1 - offset;
+            the_divider.remainder(in, out, count);
+            check_array_rem<ALGO>(in, out, count, denom);
+            the_divider.divmod(in, quots.data() + offset, out, count);
+            check_array<ALGO>(in, quots.data() + offset, count, denom);
+            check_array_rem<ALGO>(in, out, count, denom);
+        }
+
+        // In-place remainder
+        inplace = numers;
+        the_divider.remainder(inplace.data() + 1, inplace.data() + 1, count);
+        check_array_rem<ALGO>(numers.data() + 1, inplace.data() + 1, count, denom);
+    }
+
+    void check_fastmod(T numer, T denom, T rem, bool divisible, const char *kind) {
+        // INT_MIN % -1 is undefined behavior in C/C++
+        if (limits::is_signed && numer == (limits::min)() && denom == T(-1)) {
+            return;
+        }
+        T expect = numer % denom;
+        if (rem != expect || divisible != (expect == 0)) {
+            PRINT_ERROR(F("Fastmod "));
+            PRINT_ERROR(kind);
+            PRINT_ERROR(F(" failure for "));
+            PRINT_ERROR(type_tag<T>::get_tag());
+            PRINT_ERROR(F(": "));
+            PRINT_ERROR(numer);
+            PRINT_ERROR(F(" % "));
+            PRINT_ERROR(denom);
+            PRINT_ERROR(F(" = "));
+            PRINT_ERROR(expect);
+            PRINT_ERROR(F(", but got "));
+            PRINT_ERROR(rem);
+            PRINT_ERROR(F(", is_divisible "));
+            PRINT_ERROR(divisible);
+            PRINT_ERROR(F("\n"));
+            TEST_FAIL();
+        }
+    }
+
+    template <typename VecType>
+    void test_fastmod_vec(const T *numers, T denom, const fastmod_divider<T> &div) {
+        const size_t countTinVec = sizeof(VecType) / sizeof(T);
+        union type_pun_vec {
+            VecType vec = {};
+            T arr[countTinVec];
+        };
+
+        type_pun_vec vec_in, vec_rem, vec_divisible;
+        memcpy(vec_in.arr, numers, sizeof(VecType));
+        vec_rem.vec = div.mod(vec_in.vec);
+        vec_divisible.vec = div.is_divisible(vec_in.vec);
+        for (size_t i = 0; i < countTinVec; i++) {
+            check_fastmod(numers[i], denom, vec_rem.arr[i], vec_divisible.arr[i] == T(-1), "vector");
+            if (vec_divisible.arr[i] != 0 && vec_divisible.arr[i] != T(-1)) {
+                PRINT_ERROR(F("Fastmod vector is_divisible() did not return a mask\n"));
+                TEST_FAIL();
+            }
+        }
+    }
+
+    // fastmod_divider only exists for 32-bit integers.
+    void test_fastmod(T, std::false_type) {}
+
+    void test_fastmod(T denom, std::true_type) {
+        const fastmod_divider<T> div(denom);
+        std::vector<T> numers;
+        for (auto numerator : edgeCases) {
+            numers.push_back(numerator);
+        }
+        for (UT bits = (std::numeric_limits<UT>::max)(); bits != 0; bits <<= 1) {
+            numers.push_back((T)bits);
+        }
+        for (size_t i = 0; i < 10000; ++i) {
+            numers.push_back(get_random());
+        }
+        // A few multiples of denom
+        for (T i = 0; i < 64; ++i) {
+            numers.push_back((T)((UT)get_random() / (UT)denom * (UT)denom));
+        }
+        numers.resize(numers.size() + min_vector_count, T(0));
+
+        for (size_t i = 0; i < numers.size(); i++) {
+            check_fastmod(numers[i], denom, numers[i] % div, div.is_divisible(numers[i]), "scalar");
+        }
+        for (size_t i = 0; i + min_vector_count <= numers.size(); i += min_vector_count) {
+#ifdef LIBDIVIDE_SSE2
+            test_fastmod_vec<__m128i>(&numers[i], denom, div);
+#endif
+#ifdef LIBDIVIDE_AVX2
+            test_fastmod_vec<__m256i>(&numers[i], denom, div);
+#endif
+#ifdef LIBDIVIDE_AVX512
+            test_fastmod_vec<__m512i>(&numers[i], denom, div);
+#endif
+        }
+    }
+
+    void check_exact(T numer, T denom, T quot, const char *kind) {
+        // INT_MIN / -1 is undefined behavior in C/C++
+        if (limits::is_signed && numer == (limits::min)() && denom == T(-1)) {
+            return;
+        }
+        T expect = numer / denom;
+        if (quot != expect) {
+            PRINT_ERROR(F("Exact "));
+            PRINT_ERROR(kind);
+            PRINT_ERROR(F(" failure for "));
+            PRINT_ERROR(type_tag<T>::get_tag());
+            PRINT_ERROR(F(": "));
+            PRINT_ERROR(numer);
+            PRINT_ERROR(F(" / "));
+            PRINT_ERROR(denom);
+            PRINT_ERROR(F(" = "));
+            PRINT_ERROR(expect);
+            PRINT_ERROR(F(", but got "));
+            PRINT_ERROR(quot);
+            PRINT_ERROR(F("\n"));
+            TEST_FAIL();
+        }
+    }
+
+    template <typename VecType>
+    void test_exact_vec(const T *numers, T denom, const exact_divider<T> &div) {
+        const size_t countTinVec = sizeof(VecType) / sizeof(T);
+        union type_pun_vec {
+            VecType vec = {};
+            T arr[countTinVec];
+        };
+
+        type_pun_vec vec_in, vec_quot;
+        memcpy(vec_in.arr, numers, sizeof(VecType));
+        vec_quot.vec = vec_in.vec / div;
+        for (size_t i = 0; i < countTinVec; i++) {
+            check_exact(numers[i], denom, vec_quot.arr[i], "vector");
+        }
+    }
+
+    // exact_divider only divides multiples of the divisor, the quotients
+    // are chosen such that the multiples do not overflow.
+    void test_exact(T denom) {
+        const exact_divider<T> div(denom);
+        if (div.recover() != denom) {
+            PRINT_ERROR(F("Failed to recover exact divisor: "));
+            PRINT_ERROR(denom);
+            PRINT_ERROR(F(", but got "));
+            PRINT_ERROR(div.recover());
+            PRINT_ERROR(F("\n"));
+            TEST_FAIL();
+        }
+
+        const UT abs_denom = denom < 0 ? (UT)(0 - (UT)denom) : (UT)denom;
+        const UT max_quot = (UT)(limits::max)() / abs_denom;
+        std::vector<T> quots = {0, 1, (T)max_quot, (T)(max_quot / 2)};
+        for (size_t i = 0; i < 10000; ++i) {
+            UT quot = (UT)get_random();
+            quots.push_back((T)(max_quot == (UT)-1 ? quot : quot % (UT)(max_quot + 1)));
+        }
+        std::vector<T> numers;
+        for (T quot : quots) {
+            numers.push_back((T)((UT)quot * (UT)denom));
+            if (limits::is_signed) {
+                numers.push_back((T)((UT)0 - (UT)quot * (UT)denom));
+            }
+        }
+        if (limits::is_signed && (abs_denom & (abs_denom - 1)) == 0) {
+            numers.push_back((limits::min)());
+        }
+        numers.resize((numers.size() / min_vector_count + 1) * min_vector_count, T(0));
+
+        for (size_t i = 0; i < numers.size(); i++) {
+            check_exact(numers[i], denom, numers[i] / div, "scalar");
+        }
+        for (size_t i = 0; i < numers.size(); i += min_vector_count) {
+#ifdef LIBDIVIDE_SSE2
+            test_exact_vec<__m128i>(&numers[i], denom, div);
+#endif
+#ifdef LIBDIVIDE_AVX2
+            test_exact_vec<__m256i>(&numers[i], denom, div);
+#endif
+#ifdef LIBDIVIDE_AVX512
+            test_exact_vec<__m512i>(&numers[i], denom, div);
+#endif
+#ifdef LIBDIVIDE_NEON
+            test_exact_vec<typename NeonVecFor<T>::type>(&numers[i], denom, div);
+#endif
+        }
+    }
+
+    static T round_quotient(T numer, T denom, Rounding R) {
+        T quot = numer / denom;
+        T rem = numer % denom;
+        if (rem == 0) {
+            return quot;
+        }
+        if (R == ROUND_CEIL && (rem < 0) == (denom < 0)) {
+            return quot + 1;
+        }
+        if (R == ROUND_FLOOR && (rem < 0) != (denom < 0)) {
+            return quot - 1;
+        }
+        if (R == ROUND_EUCLID && rem < 0) {
+            return denom < 0 ? quot + 1 : quot - 1;
+        }
+        return quot;
+    }
+
+    void check_round(T numer, T denom, T quot, Rounding R, const char *kind) {
+        // INT_MIN / -1 is undefined behavior in C/C++
+        if (limits::is_signed && numer == (limits::min)() && denom == T(-1)) {
+            return;
+        }
+        T expect = round_quotient(numer, denom, R);
+        if (quot != expect) {
+            PRINT_ERROR(F("Rounding "));
+            PRINT_ERROR(kind);
+            PRINT_ERROR(F(" failure for "));
+            PRINT_ERROR(type_tag<T>::get_tag());
+            PRINT_ERROR(F(" mode "));
+            PRINT_ERROR((int)R);
+            PRINT_ERROR(F(": "));
+            PRINT_ERROR(numer);
+            PRINT_ERROR(F(" / "));
+            PRINT_ERROR(denom);
+            PRINT_ERROR(F(" = "));
+            PRINT_ERROR(expect);
+            PRINT_ERROR(F(", but got "));
+            PRINT_ERROR(quot);
+            PRINT_ERROR(F("\n"));
+            TEST_FAIL();
+        }
+    }
+
+    template <typename VecType, Rounding R, Branching ALGO>
+    void test_round_vec(const T *numers, T denom, const rounding_divider<T, R, ALGO> &div) {
+        const size_t countTinVec = sizeof(VecType) / sizeof(T);
+        union type_pun_vec {
+            VecType vec = {};
+            T arr[countTinVec];
+        };
+
+        type_pun_vec vec_in, vec_quot;
+        memcpy(vec_in.arr, numers, sizeof(VecType));
+        vec_quot.vec = vec_in.vec / div;
+        for (size_t i = 0; i < countTinVec; i++) {
+            check_round(numers[i], denom, vec_quot.arr[i], R, "vector");
+        }
+    }
+
+    template <Rounding R, Branching ALGO>
+    void test_round(T denom) {
+        const rounding_divider<T, R, ALGO> div(denom);
+        if (div.recover() != denom) {
+            PRINT_ERROR(F("Failed to recover rounding divisor: "));
+            PRINT_ERROR(denom);
+            PRINT_ERROR(F(", but got "));
+            PRINT_ERROR(div.recover());
+            PRINT_ERROR(F("\n"));
+            TEST_FAIL();
+        }
+
+        std::vector<T> numers;
+        for (auto numerator : edgeCases) {
+            numers.push_back(numerator);
+        }
+        for (UT bits = (std::numeric_limits<UT>::max)(); bits != 0; bits <<= 1) {
+            numers.push_back((T)bits);
+        }
+        // Multiples of denom and their neighbours
+        for (size_t i = 0; i < 64; ++i) {
+            T multiple = (T)((UT)get_random() / (UT)denom * (UT)denom);
+            numers.push_back(multiple);
+            numers.push_back((T)((UT)multiple - 1));
+            numers.push_back((T)((UT)multiple + 1));
+        }
+        for (size_t i = 0; i < 1000; ++i) {
+            numers.push_back(get_random());
+        }
+        numers.resize((numers.size() / min_vector_count + 1) * min_vector_count, T(0));
+
+        for (size_t i = 0; i < numers.size(); i++) {
+            check_round(numers[i], denom, numers[i] / div, R, "scalar");
+        }
+        for (size_t i = 0; i < numers.size(); i += min_vector_count) {
+#ifdef LIBDIVIDE_SSE2
+            test_round_vec<__m128i>(&numers[i], denom, div);
+#endif
+#ifdef LIBDIVIDE_AVX2
+            test_round_vec<__m256i>(&numers[i], denom, div);
+#endif
+#ifdef LIBDIVIDE_AVX512
+            test_round_vec<__m512i>(&numers[i], denom, div);
+#endif
+        }
+    }
+#endif
+
     template <Branching ALGO>
     void test_all_numerators(T denom, const divider<T, ALGO> &the_divider) {
         for (T numerator = (min); numerator != (max); ++numerator) {
             test_one((T)numerator, denom, the_divider);
         }
+        test_one((T)(max), denom, the_divider);
     }
 
     template <Branching ALGO>
@@ -421,11 +855,943 @@ class DivideTest {
         test_pow2_numerators(denom, the_divider);
         test_allbits_numerators(denom, the_divider);
 #if !defined(__AVR__)
-        test_random_numerators(denom, the_divider);
+        // 8-bit dividers are tested with all the numerators.
+        if (sizeof(T) == 1) {
+            test_all_numerators(denom, the_divider);
+        } else {
+            test_random_numerators(denom, the_divider);
+        }
+        test_extended(denom, the_divider, std::integral_constant<bool, sizeof(T) <= 8>());
+#endif
+    }
+
+#if !defined(__AVR__)
+    // 128-bit dividers only provide the scalar API.
+    template <Branching ALGO>
+    void test_extended(T, const divider<T, ALGO> &, std::false_type) {}
+
+    template <Branching ALGO>
+    void test_extended(T denom, const divider<T, ALGO> &the_divider, std::true_type) {
         test_vectordivide_numerators(denom, the_divider);
+        test_array_numerators(denom, the_divider);
+        if (ALGO == BRANCHFULL) {
+            test_fastmod(denom, std::integral_constant<bool, sizeof(T) == 4>());
+        }
+        test_exact_round<ALGO>(denom, std::integral_constant<bool, sizeof(T) >= 2>());
+    }
+
+    // There are no 8-bit exact and rounding dividers.
+    template <Branching ALGO>
+    void test_exact_round(T, std::false_type) {}
+
+    template <Branching ALGO>
+    void test_exact_round(T denom, std::true_type) {
+        if (ALGO == BRANCHFULL) {
+            test_exact(denom);
+        }
+        test_round<ROUND_FLOOR, ALGO>(denom);
+        test_round<ROUND_CEIL, ALGO>(denom);
+        test_round<ROUND_EUCLID, ALGO>(denom);
+    }
 #endif
+
+#if !defined(__AVR__)
+    // 128-bit dividers have no divide_each().
+    void test_divide_each(const set_t<T> &, std::false_type) {}
+
+    // Divides random numerators by all the tested denominators at once.
+    void test_divide_each(const set_t<T> &tested_denom, std::true_type) {
+        std::vector<T> denoms;
+        for (T denom : tested_denom) {
+            // Don't try dividing by 1 with unsigned branchfree
+            if (limits::is_signed || denom != 1) {
+                denoms.push_back(denom);
+            }
+        }
+        std::vector<branchfree_divider<T>> divs(denoms.begin(), denoms.end());
+        std::vector<T> numers(denoms.size());
+        for (size_t i = 0; i < numers.size(); i++) {
+            numers[i] = (i % 16 == 0) ? (limits::min)() : (i % 16 == 1) ? (limits::max)()
+                                                                       : get_random();
+        }
+
+        std::vector<T> quots(numers.size());
+        divide_each(numers.data(), divs.data(), quots.data(), numers.size());
+        for (size_t i = 0; i < numers.size(); i++) {
+            T numer = numers[i];
+            T denom = denoms[i];
+            // INT_MIN / -1 is undefined behavior in C/C++
+            if (limits::is_signed && numer == (limits::min)() && denom == T(-1)) {
+                continue;
+            }
+            T expect = numer / denom;
+            if (quots[i] != expect) {
+                PRINT_ERROR(F("Per-element failure for "));
+                PRINT_ERROR(type_tag<T>::get_tag());
+                PRINT_ERROR(F(": "));
+                PRINT_ERROR(numer);
+                PRINT_ERROR(F(" / "));
+                PRINT_ERROR(denom);
+                PRINT_ERROR(F(" = "));
+                PRINT_ERROR(expect);
+                PRINT_ERROR(F(", but got "));
+                PRINT_ERROR(quots[i]);
+                PRINT_ERROR(F("\n"));
+                TEST_FAIL();
+            }
+        }
+
+        // In-place division, starting at an odd index
+        std::vector<T> inplace(numers);
+        divide_each(inplace.data() + 1, divs.data() + 1, inplace.data() + 1, numers.size() - 1);
+        for (size_t i = 1; i < numers.size(); i++) {
+            if (inplace[i] != quots[i]) {
+                PRINT_ERROR(F("In-place per-element failure for "));
+                PRINT_ERROR(type_tag<T>::get_tag());
+                PRINT_ERROR(F(": "));
+                PRINT_ERROR(numers[i]);
+                PRINT_ERROR(F(" / "));
+                PRINT_ERROR(denoms[i]);
+                PRINT_ERROR(F("\n"));
+                TEST_FAIL();
+            }
+        }
+
+        // One numerator divided by all the dividers
+        for (size_t j = 0; j < 32; j++) {
+            T numer = numers[j % numers.size()];
+            divide_by_each(numer, divs.data(), quots.data(), divs.size());
+            for (size_t i = 0; i < divs.size(); i++) {
+                T denom = denoms[i];
+                if (limits::is_signed && numer == (limits::min)() && denom == T(-1)) {
+                    continue;
+                }
+                if (quots[i] != numer / denom) {
+                    PRINT_ERROR(F("Divide by each failure for "));
+                    PRINT_ERROR(type_tag<T>::get_tag());
+                    PRINT_ERROR(F(": "));
+                    PRINT_ERROR(numer);
+                    PRINT_ERROR(F(" / "));
+                    PRINT_ERROR(denom);
+                    PRINT_ERROR(F(" = "));
+                    PRINT_ERROR(numer / denom);
+                    PRINT_ERROR(F(", but got "));
+                    PRINT_ERROR(quots[i]);
+                    PRINT_ERROR(F("\n"));
+                    TEST_FAIL();
+                }
+            }
+        }
+    }
+
+    // 128-bit dividers have no divide_runs().
+    void test_divide_runs(const set_t<T> &, std::false_type) {}
+
+    // Divides random numerators by the tested denominators as runs of
+    // random lengths, short runs use hardware division.
+    void test_divide_runs(const set_t<T> &tested_denom, std::true_type) {
+        std::vector<T> denoms(tested_denom.begin(), tested_denom.end());
+        std::vector<uint32_t> lengths(denoms.size());
+        uint32_t r = 0;
+        size_t count = 0;
+        for (size_t i = 0; i < lengths.size(); i++) {
+            r = r * 1664525 + 1013904223;
+            lengths[i] = (r >> 8) % 40;
+            count += lengths[i];
+        }
+        std::vector<T> numers(count), quots(count);
+        for (size_t i = 0; i < count; i++) {
+            numers[i] = (i % 16 == 0) ? (limits::min)() : (i % 16 == 1) ? (limits::max)()
+                                                                       : get_random();
+        }
+
+        divide_runs(numers.data(), quots.data(), lengths.data(), denoms.data(), denoms.size());
+        size_t i = 0;
+        for (size_t run = 0; run < denoms.size(); run++) {
+            T denom = denoms[run];
+            for (size_t end = i + lengths[run]; i < end; i++) {
+                T numer = numers[i];
+                // INT_MIN / -1 is undefined behavior in C/C++
+                if (limits::is_signed && numer == (limits::min)() && denom == T(-1)) {
+                    continue;
+                }
+                T expect = numer / denom;
+                if (quots[i] != expect) {
+                    PRINT_ERROR(F("Run division failure for "));
+                    PRINT_ERROR(type_tag<T>::get_tag());
+                    PRINT_ERROR(F(": "));
+                    PRINT_ERROR(numer);
+                    PRINT_ERROR(F(" / "));
+                    PRINT_ERROR(denom);
+                    PRINT_ERROR(F(" = "));
+                    PRINT_ERROR(expect);
+                    PRINT_ERROR(F(", but got "));
+                    PRINT_ERROR(quots[i]);
+                    PRINT_ERROR(F(" (run length "));
+                    PRINT_ERROR(lengths[run]);
+                    PRINT_ERROR(F(")\n"));
+                    TEST_FAIL();
+                }
+            }
+        }
+    }
+
+    // 128-bit dividers have no divider_table.
+    template <Branching ALGO, typename Table = divider_table<T, ALGO>>
+    void test_divider_table(const set_t<T> &, std::false_type) {}
+
+    // Divides random numerators by the tested denominators, looked up in a
+    // Table (a divider_table<T, ALGO>) by random indices.
+    template <Branching ALGO, typename Table = divider_table<T, ALGO>>
+    void test_divider_table(const set_t<T> &tested_denom, std::true_type) {
+        std::vector<T> denoms;
+        for (T denom : tested_denom) {
+            // Don't try dividing by 1 with unsigned branchfree
+            if (limits::is_signed || ALGO == BRANCHFULL || denom != 1) {
+                denoms.push_back(denom);
+            }
+        }
+        // build() replaces the single divider of the table
+        Table table(1, denoms[0]);
+        table.build(denoms.data(), denoms.size());
+        std::vector<T> numers(4 * denoms.size() + 13);
+        std::vector<uint32_t> indices(numers.size());
+        uint32_t r = 0;
+        for (size_t i = 0; i < numers.size(); i++) {
+            numers[i] = (i % 16 == 0) ? (limits::min)() : (i % 16 == 1) ? (limits::max)()
+                                                                       : get_random();
+            r = r * 1664525 + 1013904223;
+            indices[i] = (uint32_t)((r >> 8) % denoms.size());
+        }
+        // The last divider is read by the vector kernels too
+        indices[numers.size() - 1] = (uint32_t)(denoms.size() - 1);
+
+        std::vector<T> quots(numers.size());
+        table.divide(numers.data(), indices.data(), quots.data(), numers.size());
+        for (size_t i = 0; i < numers.size(); i++) {
+            T numer = numers[i];
+            T denom = denoms[indices[i]];
+            // INT_MIN / -1 is undefined behavior in C/C++
+            if (limits::is_signed && numer == (limits::min)() && denom == T(-1)) {
+                continue;
+            }
+            T expect = numer / denom;
+            if (quots[i] != expect || table.divide(numer, indices[i]) != expect ||
+                table.recover(indices[i]) != denom) {
+                PRINT_ERROR(F("Divider table failure for "));
+                PRINT_ERROR(type_tag<T>::get_tag());
+                PRINT_ERROR(F(": "));
+                PRINT_ERROR(numer);
+                PRINT_ERROR(F(" / "));
+                PRINT_ERROR(denom);
+                PRINT_ERROR(F(" = "));
+                PRINT_ERROR(expect);
+                PRINT_ERROR(F(", but got "));
+                PRINT_ERROR(quots[i]);
+                PRINT_ERROR(F("\n"));
+                TEST_FAIL();
+            }
+        }
+    }
+
+    // Only 16, 32 and 64-bit integers have divider_dict.
+    void test_divider_dict(const set_t<T> &, std::false_type) {}
+
+    // Divides random numerators by dictionaries of up to 16 of the tested
+    // denominators, selected by random codes.
+    void test_divider_dict(const set_t<T> &tested_denom, std::true_type) {
+        std::vector<T> denoms;
+        for (T denom : tested_denom) {
+            // Don't try dividing by 1 with unsigned branchfree
+            if (limits::is_signed || denom != 1) {
+                denoms.push_back(denom);
+            }
+        }
+        std::vector<T> numers(77), quots(numers.size());
+        std::vector<uint8_t> codes(numers.size());
+        uint32_t r = 0;
+        for (size_t first = 0; first < denoms.size(); first += 16) {
+            size_t count = denoms.size() - first < 16 ? denoms.size() - first : 16;
+            divider_dict<T> dict(&denoms[first], count);
+            for (size_t i = 0; i < numers.size(); i++) {
+                numers[i] = (i % 16 == 0) ? (limits::min)() : (i % 16 == 1) ? (limits::max)()
+                                                                           : get_random();
+                r = r * 1664525 + 1013904223;
+                codes[i] = (uint8_t)((r >> 8) % count);
+            }
+            dict.divide(numers.data(), codes.data(), quots.data(), numers.size());
+            for (size_t i = 0; i < numers.size(); i++) {
+                T numer = numers[i];
+                T denom = denoms[first + codes[i]];
+                // INT_MIN / -1 is undefined behavior in C/C++
+                if (limits::is_signed && numer == (limits::min)() && denom == T(-1)) {
+                    continue;
+                }
+                T expect = numer / denom;
+                if (quots[i] != expect || dict.divide(numer, codes[i]) != expect) {
+                    PRINT_ERROR(F("Divider dictionary failure for "));
+                    PRINT_ERROR(type_tag<T>::get_tag());
+                    PRINT_ERROR(F(": "));
+                    PRINT_ERROR(numer);
+                    PRINT_ERROR(F(" / "));
+                    PRINT_ERROR(denom);
+                    PRINT_ERROR(F(" = "));
+                    PRINT_ERROR(expect);
+                    PRINT_ERROR(F(", but got "));
+                    PRINT_ERROR(quots[i]);
+                    PRINT_ERROR(F("\n"));
+                    TEST_FAIL();
+                }
+            }
+        }
+    }
+
+    // Only unsigned integers up to 64 bits have iota_divmod().
+    void test_iota_divmod(const set_t<T> &, std::false_type) {}
+
+    // Computes the quotients and remainders of strided numerators by the
+    // tested denominators, using steps of 1, small and random steps, and
+    // starts close to the maximum so that the numerators wrap around.
+    void test_iota_divmod(const set_t<T> &tested_denom, std::true_type) {
+        uint32_t r = 0;
+        size_t index = 0;
+        for (T denom : tested_denom) {
+            r = r * 1664525 + 1013904223;
+            size_t count = 100 + (r >> 8) % 200;
+            T start = get_random();
+            T step = (T)1;
+            switch (index++ % 4) {
+                case 1:
+                    step = (T)(get_random() % 1000);
+                    break;
+                case 2:
+                    step = get_random();
+                    break;
+                case 3:
+                    start = (T)((limits::max)() - get_random() % 1000);
+                    step = (T)(get_random() % 100);
+                    break;
+            }
+            std::vector<T> quots(count), rems(count);
+            iota_divmod(start, step, count, denom, quots.data(), rems.data());
+            quotient_iterator<T> it(start, step, denom);
+            T numer = start;
+            for (size_t i = 0; i < count; i++, numer = (T)(numer + step), ++it) {
+                T expect_q = numer / denom;
+                T expect_r = numer % denom;
+                if (quots[i] != expect_q || rems[i] != expect_r || it.value() != numer ||
+                    it.quotient() != expect_q || it.remainder() != expect_r) {
+                    PRINT_ERROR(F("Strided divmod failure for "));
+                    PRINT_ERROR(type_tag<T>::get_tag());
+                    PRINT_ERROR(F(": "));
+                    PRINT_ERROR(numer);
+                    PRINT_ERROR(F(" / "));
+                    PRINT_ERROR(denom);
+                    PRINT_ERROR(F(" = "));
+                    PRINT_ERROR(expect_q);
+                    PRINT_ERROR(F(" rem "));
+                    PRINT_ERROR(expect_r);
+                    PRINT_ERROR(F(", but got "));
+                    PRINT_ERROR(quots[i]);
+                    PRINT_ERROR(F(" rem "));
+                    PRINT_ERROR(rems[i]);
+                    PRINT_ERROR(F(" (iterator "));
+                    PRINT_ERROR(it.quotient());
+                    PRINT_ERROR(F(" rem "));
+                    PRINT_ERROR(it.remainder());
+                    PRINT_ERROR(F(", step "));
+                    PRINT_ERROR(step);
+                    PRINT_ERROR(F(")\n"));
+                    TEST_FAIL();
+                }
+            }
+        }
+    }
+
+    // Only unsigned 32 and 64-bit integers have index_decomposer.
+    void test_index_decomposer(const set_t<T> &, std::false_type) {}
+
+    template <typename VecT, size_t MaxRank>
+    void test_decompose_vec(const index_decomposer<T, MaxRank> &decomposer,
+        const std::vector<T> &indices, const std::vector<std::vector<T>> &coords) {
+        const size_t lanes = sizeof(VecT) / sizeof(T);
+        VecT vec_coords[MaxRank];
+        for (size_t i = 0; i + lanes <= indices.size(); i += lanes) {
+            VecT vec_indices;
+            memcpy(&vec_indices, &indices[i], sizeof(VecT));
+            decomposer.decompose(vec_indices, vec_coords);
+            for (size_t k = 0; k < decomposer.rank(); k++) {
+                if (memcmp(&vec_coords[k], &coords[k][i], sizeof(VecT)) != 0) {
+                    PRINT_ERROR(F("Vector index decomposition failure for "));
+                    PRINT_ERROR(type_tag<T>::get_tag());
+                    PRINT_ERROR(F(" at coordinate "));
+                    PRINT_ERROR(k);
+                    PRINT_ERROR(F("\n"));
+                    TEST_FAIL();
+                }
+            }
+        }
+    }
+
+    // Decomposes random indices into the coordinates of tensors whose
+    // extents are 1 to 4 of the tested denominators, and remaps them to the
+    // tensors with the dimensions in reverse order.
+    void test_index_decomposer(const set_t<T> &tested_denom, std::true_type) {
+        std::vector<T> extents(tested_denom.begin(), tested_denom.end());
+        std::vector<T> indices(77), remapped(indices.size()), relinearized(indices.size());
+        std::vector<std::vector<T>> coords(4, std::vector<T>(indices.size()));
+        T *coord_ptrs[4] = {coords[0].data(), coords[1].data(), coords[2].data(),
+            coords[3].data()};
+        size_t rank = 1;
+        for (size_t first = 0; first + 4 <= extents.size(); first += rank, rank = rank % 4 + 1) {
+            index_decomposer<T, 4> decomposer(&extents[first], rank);
+            for (size_t i = 0; i < indices.size(); i++) {
+                indices[i] = (i % 16 == 0) ? (limits::max)() : get_random();
+            }
+            decomposer.decompose(indices.data(), indices.size(), coord_ptrs);
+            size_t perm[4];
+            for (size_t j = 0; j < rank; j++) {
+                perm[j] = rank - 1 - j;
+            }
+            T strides[4];
+            decomposer.permuted_strides(perm, strides);
+            decomposer.remap(indices.data(), indices.size(), strides, remapped.data());
+            decomposer.linearize(coord_ptrs, indices.size(), strides, relinearized.data());
+            for (size_t i = 0; i < indices.size(); i++) {
+                T index = indices[i];
+                T expect[4], scalar[4];
+                for (size_t k = rank; k-- > 1;) {
+                    expect[k] = index % extents[first + k];
+                    index /= extents[first + k];
+                }
+                expect[0] = index;
+                decomposer.decompose(indices[i], scalar);
+                bool ok = decomposer.linearize(expect) == indices[i] &&
+                          remapped[i] == decomposer.linearize(expect, strides) &&
+                          relinearized[i] == remapped[i] &&
+                          decomposer.remap(indices[i], strides) == remapped[i];
+                for (size_t k = 0; k < rank; k++) {
+                    ok = ok && coords[k][i] == expect[k] && scalar[k] == expect[k];
+                }
+                if (!ok) {
+                    PRINT_ERROR(F("Index decomposition failure for "));
+                    PRINT_ERROR(type_tag<T>::get_tag());
+                    PRINT_ERROR(F(": index "));
+                    PRINT_ERROR(indices[i]);
+                    PRINT_ERROR(F(", rank "));
+                    PRINT_ERROR(rank);
+                    PRINT_ERROR(F(", innermost extent "));
+                    PRINT_ERROR(extents[first + rank - 1]);
+                    PRINT_ERROR(F("\n"));
+                    TEST_FAIL();
+                }
+            }
+#if defined(LIBDIVIDE_AVX2)
+            test_decompose_vec<__m256i>(decomposer, indices, coords);
+#endif
+#if defined(LIBDIVIDE_AVX512)
+            test_decompose_vec<__m512i>(decomposer, indices, coords);
+#endif
+        }
+    }
+
+    // Only unsigned 32 and 64-bit integers have mod_reducer.
+    void test_mod_reducer(const set_t<T> &, std::false_type) {}
+
+    // a * b % m computed by hardware division of the 128-bit product
+    static T reference_mulmod(T a, T b, T m) {
+        uint64_t rem;
+        uint64_t hi = libdivide_mullhi_u64(a, b);
+        libdivide_128_div_64_to_64(hi % m, (uint64_t)a * b, m, &rem);
+        return (T)rem;
+    }
+
+    // Uses the tested denominators as moduli of random multiplications,
+    // exponentiations and wide reductions.
+    void test_mod_reducer(const set_t<T> &tested_denom, std::true_type) {
+        for (T m : tested_denom) {
+            mod_reducer<T> reducer(m);
+            for (int i = 0; i < 8; i++) {
+                T a = get_random(), b = (i == 0) ? (limits::max)() : get_random();
+                uint64_t exp = (uint64_t)get_random() >> (i * 8);
+                uint64_t hi = ((uint64_t)get_random() << 32) | (uint32_t)get_random();
+                uint64_t lo = ((uint64_t)get_random() << 32) | (uint32_t)get_random();
+                T expect = reference_mulmod(a, b, m);
+                T expect_pow = (T)(1 % m);
+                for (uint64_t e = exp, x = a % m; e != 0; e >>= 1) {
+                    if (e & 1) expect_pow = reference_mulmod(expect_pow, (T)x, m);
+                    x = reference_mulmod((T)x, (T)x, m);
+                }
+                uint64_t expect_wide;
+                libdivide_128_div_64_to_64(hi % m, lo, m, &expect_wide);
+                bool ok = reducer.mulmod(a, b) == expect && reducer.powmod(a, exp) == expect_pow &&
+                          reducer.reduce(hi, lo) == (T)expect_wide &&
+                          reducer.reduce(lo) == (T)(lo % m) && reducer.modulus() == m;
+                if (m & 1) {
+                    T a_mont = reducer.to_montgomery(a);
+                    T b_mont = reducer.to_montgomery(b);
+                    ok = ok && a_mont < m && reducer.from_montgomery(a_mont) == a % m &&
+                         reducer.from_montgomery(reducer.montgomery_mul(a_mont, b_mont)) == expect;
+                }
+                if (!ok) {
+                    PRINT_ERROR(F("mod_reducer failure for "));
+                    PRINT_ERROR(type_tag<T>::get_tag());
+                    PRINT_ERROR(F(": "));
+                    PRINT_ERROR(a);
+                    PRINT_ERROR(F(" * "));
+                    PRINT_ERROR(b);
+                    PRINT_ERROR(F(" % "));
+                    PRINT_ERROR(m);
+                    PRINT_ERROR(F(" = "));
+                    PRINT_ERROR(expect);
+                    PRINT_ERROR(F(", but got "));
+                    PRINT_ERROR(reducer.mulmod(a, b));
+                    PRINT_ERROR(F(" (exponent "));
+                    PRINT_ERROR(exp);
+                    PRINT_ERROR(F(")\n"));
+                    TEST_FAIL();
+                }
+            }
+            test_mod_arrays(reducer);
+        }
     }
 
+    // Compares the array functions, whose vector kernels use Montgomery
+    // multiplication, with the scalar ones. 37 elements cover the kernels
+    // processing two vectors, one vector and the scalar remainder.
+    void test_mod_arrays(const mod_reducer<T> &reducer) {
+        const size_t count = 37;
+        const T m = reducer.modulus();
+        T a[count], b[count], c[count], expect[count];
+        for (size_t i = 0; i < count; i++) {
+            a[i] = (T)(get_random() % m);
+            b[i] = (T)((i == 0) ? m - 1 : get_random() % m);
+        }
+        uint64_t exp = ((uint64_t)get_random() << 32) | (uint32_t)get_random();
+        const char *const names[] = {"mulmod", "addmod", "submod", "powmod", "in-place mulmod"};
+        for (int op = 0; op < 5; op++) {
+            for (size_t i = 0; i < count; i++) {
+                switch (op) {
+                    case 1:
+                        expect[i] = reducer.addmod(a[i], b[i]);
+                        break;
+                    case 2:
+                        expect[i] = reducer.submod(a[i], b[i]);
+                        break;
+                    case 3:
+                        expect[i] = reducer.powmod(a[i], exp);
+                        break;
+                    default:
+                        expect[i] = reducer.mulmod(a[i], b[i]);
+                        break;
+                }
+            }
+            switch (op) {
+                case 0:
+                    reducer.mulmod(a, b, c, count);
+                    break;
+                case 1:
+                    reducer.addmod(a, b, c, count);
+                    break;
+                case 2:
+                    reducer.submod(a, b, c, count);
+                    break;
+                case 3:
+                    reducer.powmod(a, c, count, exp);
+                    break;
+                default:
+                    // The results may overwrite an input
+                    for (size_t i = 0; i < count; i++) c[i] = a[i];
+                    reducer.mulmod(c, b, c, count);
+                    break;
+            }
+            for (size_t i = 0; i < count; i++) {
+                // addmod and submod are checked against each other
+                bool ok = c[i] == expect[i] && expect[i] < m &&
+                          (op != 1 || reducer.submod(expect[i], b[i]) == a[i]) &&
+                          (op != 2 || reducer.addmod(expect[i], b[i]) == a[i]);
+                if (!ok) {
+                    PRINT_ERROR(F("mod_reducer array failure for "));
+                    PRINT_ERROR(type_tag<T>::get_tag());
+                    PRINT_ERROR(F(": "));
+                    PRINT_ERROR(names[op]);
+                    PRINT_ERROR(F(" of "));
+                    PRINT_ERROR(a[i]);
+                    PRINT_ERROR(F(" and "));
+                    PRINT_ERROR(b[i]);
+                    PRINT_ERROR(F(" modulo "));
+                    PRINT_ERROR(m);
+                    PRINT_ERROR(F(" (exponent "));
+                    PRINT_ERROR(exp);
+                    PRINT_ERROR(F(") = "));
+                    PRINT_ERROR(expect[i]);
+                    PRINT_ERROR(F(", but got "));
+                    PRINT_ERROR(c[i]);
+                    PRINT_ERROR(F("\n"));
+                    TEST_FAIL();
+                }
+            }
+        }
+    }
+
+    // Only 64-bit integers have muldiv_divider.
+    void test_muldiv(const set_t<T> &, std::false_type) {}
+
+    static UT magnitude(T x) { return x < 0 ? (UT)(0 - (UT)x) : (UT)x; }
+
+    // a * b / c rounded using the remainder of the hardware division of the
+    // 128-bit product of the magnitudes. The quotient must be < 2^64.
+    static T reference_muldiv(T a, T b, T c, Rounding rounding) {
+        UT abs_a = magnitude(a), abs_b = magnitude(b), abs_c = magnitude(c);
+        uint64_t rem;
+        UT q = (UT)libdivide_128_div_64_to_64(
+            libdivide_mullhi_u64(abs_a, abs_b), (uint64_t)abs_a * abs_b, abs_c, &rem);
+        bool numer_negative = (a < 0) != (b < 0);
+        bool negative = numer_negative != (c < 0);
+        bool increment;
+        switch (rounding) {
+            case ROUND_FLOOR:
+                increment = negative && rem != 0;
+                break;
+            case ROUND_CEIL:
+                increment = !negative && rem != 0;
+                break;
+            case ROUND_EUCLID:
+                increment = numer_negative && rem != 0;
+                break;
+            default:
+                increment = rem > (abs_c - 1) / 2;
+                break;
+        }
+        q = (UT)(q + increment);
+        return (T)(negative ? (UT)(0 - q) : q);
+    }
+
+    // Uses the tested denominators as divisors c of random products whose
+    // quotients fit in 62 bits, b is halved until they do.
+    void test_muldiv(const set_t<T> &tested_denom, std::true_type) {
+        const Rounding roundings[] = {ROUND_FLOOR, ROUND_CEIL, ROUND_EUCLID, ROUND_NEAREST};
+        const char *const names[] = {"floor", "ceil", "euclid", "nearest"};
+        for (T c : tested_denom) {
+            UT abs_c = magnitude(c);
+            for (int r = 0; r < 4; r++) {
+                muldiv_divider<T> div(c, roundings[r]);
+                if (div.recover() != c) {
+                    PRINT_ERROR(F("muldiv_divider failed to recover "));
+                    PRINT_ERROR(c);
+                    PRINT_ERROR(F("\n"));
+                    TEST_FAIL();
+                }
+                const size_t count = 9;
+                T a[count], results[count];
+                // a = c and a = c / 2 test exact and halfway quotients
+                T b = get_random();
+                for (size_t i = 0; i < count; i++) {
+                    a[i] = (i == 0) ? c : (i == 1) ? (T)(c / 2) : get_random();
+                    for (;;) {
+                        UT abs_a = magnitude(a[i]), abs_b = magnitude(b);
+                        uint64_t hi = libdivide_mullhi_u64(abs_a, abs_b), rem;
+                        if (hi < abs_c && libdivide_128_div_64_to_64(hi, (uint64_t)abs_a * abs_b,
+                                              abs_c, &rem) >> 62 == 0) {
+                            break;
+                        }
+                        b = (T)(b / 2);
+                    }
+                }
+                div.muldiv(a, b, results, count);
+                for (size_t i = 0; i < count; i++) {
+                    T expect = reference_muldiv(a[i], b, c, roundings[r]);
+                    if (div.muldiv(a[i], b) != expect || results[i] != expect) {
+                        PRINT_ERROR(F("muldiv_divider failure for "));
+                        PRINT_ERROR(type_tag<T>::get_tag());
+                        PRINT_ERROR(F(", rounding "));
+                        PRINT_ERROR(names[r]);
+                        PRINT_ERROR(F(": "));
+                        PRINT_ERROR(a[i]);
+                        PRINT_ERROR(F(" * "));
+                        PRINT_ERROR(b);
+                        PRINT_ERROR(F(" / "));
+                        PRINT_ERROR(c);
+                        PRINT_ERROR(F(" = "));
+                        PRINT_ERROR(expect);
+                        PRINT_ERROR(F(", but got "));
+                        PRINT_ERROR(div.muldiv(a[i], b));
+                        PRINT_ERROR(F(" and "));
+                        PRINT_ERROR(results[i]);
+                        PRINT_ERROR(F(" (array)\n"));
+                        TEST_FAIL();
+                    }
+                }
+            }
+        }
+    }
+
+    // Only uint32_t and uint64_t have rational_scaler.
+    void test_scaler(const set_t<T> &, std::false_type) {}
+
+    // x * num / den rounded using the remainder of the hardware division of
+    // the 128-bit product, wrapped modulo 2^w or saturated.
+    static T reference_scale(T x, T num, T den, Rounding rounding, bool saturate) {
+        uint64_t prod_hi = libdivide_mullhi_u64(x, num), prod_lo = (uint64_t)x * num;
+        uint64_t rem;
+        uint64_t q_hi = prod_hi / den;
+        uint64_t q_lo = libdivide_128_div_64_to_64(prod_hi % den, prod_lo, den, &rem);
+        bool increment = (rounding == ROUND_CEIL && rem != 0) ||
+                         (rounding == ROUND_NEAREST && rem > ((uint64_t)den - 1) / 2);
+        q_lo += increment;
+        q_hi += increment && q_lo == 0;
+        if (saturate && (q_hi != 0 || q_lo > (uint64_t)(limits::max)())) {
+            return (limits::max)();
+        }
+        return (T)q_lo;
+    }
+
+    // Uses the tested denominators as den, with random fractions and ones
+    // slightly above 1, 1/2 and 3/2. The x shrink with the index so that
+    // the saturated quotients are mixed with ones that fit. 37 elements
+    // cover the vector kernels and the scalar remainder.
+    void test_scaler(const set_t<T> &tested_denom, std::true_type) {
+        const Rounding roundings[] = {ROUND_FLOOR, ROUND_CEIL, ROUND_EUCLID, ROUND_NEAREST};
+        const char *const names[] = {"floor", "ceil", "euclid", "nearest"};
+        const char *const modes[] = {": ", ", saturating: "};
+        const int bits = (int)sizeof(T) * 8;
+        const size_t count = 37;
+        T x[count], results[count];
+        for (T den : tested_denom) {
+            const T nums[] = {get_random(), (T)(den + 1), (T)(den / 2), (T)(den + den / 2), 0};
+            for (T num : nums) {
+                for (size_t i = 0; i < count; i++) {
+                    x[i] = (i == 0)   ? (limits::max)()
+                           : (i == 1) ? 0
+                                      : (T)(get_random() >> (i % bits));
+                }
+                for (int r = 0; r < 4; r++) {
+                    for (int saturate = 0; saturate < 2; saturate++) {
+                        rational_scaler<T> scaler(num, den, roundings[r], saturate != 0);
+                        scaler.scale(x, results, count);
+                        for (size_t i = 0; i < count; i++) {
+                            T expect = reference_scale(x[i], num, den, roundings[r], saturate != 0);
+                            if (scaler.scale(x[i]) != expect || results[i] != expect) {
+                                PRINT_ERROR(F("rational_scaler failure for "));
+                                PRINT_ERROR(type_tag<T>::get_tag());
+                                PRINT_ERROR(F(", rounding "));
+                                PRINT_ERROR(names[r]);
+                                PRINT_ERROR(modes[saturate]);
+                                PRINT_ERROR(x[i]);
+                                PRINT_ERROR(F(" * "));
+                                PRINT_ERROR(num);
+                                PRINT_ERROR(F(" / "));
+                                PRINT_ERROR(den);
+                                PRINT_ERROR(F(" = "));
+                                PRINT_ERROR(expect);
+                                PRINT_ERROR(F(", but got "));
+                                PRINT_ERROR(scaler.scale(x[i]));
+                                PRINT_ERROR(F(" and "));
+                                PRINT_ERROR(results[i]);
+                                PRINT_ERROR(F(" (array)\n"));
+                                TEST_FAIL();
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Only unsigned 16, 32 and 64-bit integers have fixed_divider.
+    void test_fixed(const set_t<T> &, std::false_type) {}
+
+    // (numer << frac_bits) / denom modulo 2^w using hardware division of
+    // the wider numerator
+    static T reference_fixed(T numer, T denom, int frac_bits) {
+        if (sizeof(T) <= 4) {
+            return (T)(((uint64_t)numer << frac_bits) / denom);
+        }
+        uint64_t hi = frac_bits == 0 ? 0 : (uint64_t)numer >> (64 - frac_bits);
+        uint64_t lo = frac_bits == 64 ? 0 : (uint64_t)numer << frac_bits;
+        uint64_t rem;
+        return (T)libdivide_128_div_64_to_64(hi % denom, lo, denom, &rem);
+    }
+
+    void check_fixed(T numer, T denom, int frac_bits, T quot, const char *kind) {
+        T expect = reference_fixed(numer, denom, frac_bits);
+        if (quot != expect) {
+            PRINT_ERROR(F("fixed_divider "));
+            PRINT_ERROR(kind);
+            PRINT_ERROR(F(" failure for "));
+            PRINT_ERROR(type_tag<T>::get_tag());
+            PRINT_ERROR(F(": ("));
+            PRINT_ERROR(numer);
+            PRINT_ERROR(F(" << "));
+            PRINT_ERROR(frac_bits);
+            PRINT_ERROR(F(") / "));
+            PRINT_ERROR(denom);
+            PRINT_ERROR(F(" = "));
+            PRINT_ERROR(expect);
+            PRINT_ERROR(F(", but got "));
+            PRINT_ERROR(quot);
+            PRINT_ERROR(F("\n"));
+            TEST_FAIL();
+        }
+    }
+
+    template <typename VecType, int K>
+    void test_fixed_vec(const T *numers, T denom, const fixed_divider<T, K> &div) {
+        const size_t countTinVec = sizeof(VecType) / sizeof(T);
+        union type_pun_vec {
+            VecType vec = {};
+            T arr[countTinVec];
+        };
+
+        type_pun_vec vec_in, vec_quot;
+        memcpy(vec_in.arr, numers, sizeof(VecType));
+        vec_quot.vec = div.divide(vec_in.vec);
+        for (size_t i = 0; i < countTinVec; i++) {
+            check_fixed(numers[i], denom, K, vec_quot.arr[i], "vector");
+        }
+    }
+
+    template <int K>
+    void test_fixed_bits(T denom, const std::vector<T> &numers) {
+        const fixed_divider<T, K> div(denom);
+        for (size_t i = 0; i < numers.size(); i++) {
+            check_fixed(numers[i], denom, K, div.divide(numers[i]), "scalar");
+        }
+        for (size_t i = 0; i < numers.size(); i += min_vector_count) {
+#ifdef LIBDIVIDE_SSE2
+            test_fixed_vec<__m128i>(&numers[i], denom, div);
+#endif
+#ifdef LIBDIVIDE_AVX2
+            test_fixed_vec<__m256i>(&numers[i], denom, div);
+#endif
+#ifdef LIBDIVIDE_AVX512
+            test_fixed_vec<__m512i>(&numers[i], denom, div);
+#endif
+        }
+    }
+
+    // 16-bit dividers are tested with all the numerators, the others with
+    // edge cases, multiples of the divisor and random numerators.
+    void test_fixed(const set_t<T> &tested_denom, std::true_type) {
+        constexpr int w = limits::digits;
+        std::vector<T> all_numers;
+        if (sizeof(T) == 2) {
+            for (uint32_t numer = 0; numer < 65536; numer++) {
+                all_numers.push_back((T)numer);
+            }
+        }
+        for (T denom : tested_denom) {
+            std::vector<T> numers = all_numers;
+            if (numers.empty()) {
+                for (auto numerator : edgeCases) {
+                    numers.push_back(numerator);
+                }
+                for (UT bits = (std::numeric_limits<UT>::max)(); bits != 0; bits <<= 1) {
+                    numers.push_back((T)bits);
+                }
+                for (size_t i = 0; i < 16; ++i) {
+                    T multiple = (T)(get_random() / denom * denom);
+                    numers.push_back(multiple);
+                    numers.push_back((T)(multiple - 1));
+                }
+                for (size_t i = 0; i < 64; ++i) {
+                    numers.push_back(get_random());
+                }
+                numers.resize((numers.size() / min_vector_count + 1) * min_vector_count, T(0));
+            }
+            test_fixed_bits<0>(denom, numers);
+            test_fixed_bits<1>(denom, numers);
+            test_fixed_bits<w / 2>(denom, numers);
+            test_fixed_bits<w - 1>(denom, numers);
+            test_fixed_bits<w>(denom, numers);
+        }
+    }
+
+    // Only unsigned 16, 32 and 64-bit integers have bounded dividers.
+    void test_bounded(const set_t<T> &, std::false_type) {}
+
+    static uint8_t bounded_more(uint16_t denom, uint16_t bound) {
+        return libdivide_u16_gen_bounded(denom, bound).more;
+    }
+    static uint8_t bounded_more(uint32_t denom, uint32_t bound) {
+        return libdivide_u32_gen_bounded(denom, bound).more;
+    }
+    static uint8_t bounded_more(uint64_t denom, uint64_t bound) {
+        return libdivide_u64_gen_bounded(denom, bound).more;
+    }
+
+    // Bounded dividers below 2^(w-1) never need the add marker, 64-bit
+    // ones below 2^31 always use the narrow magic.
+    void check_bounded_path(T denom, T bound) {
+        constexpr int w = limits::digits;
+        T max_of_both = bound > denom ? bound : denom;
+        if ((denom & (denom - 1)) == 0 || (max_of_both >> (w - 1)) != 0) {
+            return;
+        }
+        uint8_t more = bounded_more(denom, bound);
+        bool narrow = sizeof(T) == 8 && (max_of_both >> 31) == 0;
+        if ((more & LIBDIVIDE_ADD_MARKER) || (narrow && !(more & LIBDIVIDE_NARROW_MARKER))) {
+            PRINT_ERROR(F("Bounded divider path failure for "));
+            PRINT_ERROR(type_tag<T>::get_tag());
+            PRINT_ERROR(F(": "));
+            PRINT_ERROR(denom);
+            PRINT_ERROR(F(" with numerators <= "));
+            PRINT_ERROR(bound);
+            PRINT_ERROR(F("\n"));
+            TEST_FAIL();
+        }
+    }
+
+    // Tests the numerators up to the bound, the largest ones with the
+    // remainder denom - 1 are the first to fail for a too small magic
+    // number.
+    void test_bounded(const set_t<T> &tested_denom, std::true_type) {
+        constexpr int w = limits::digits;
+        for (T denom : tested_denom) {
+            const T bounds[] = {1, (T)(max >> (w / 2 + 1)), (T)(max >> (w / 2)),
+                (T)(max >> (w / 4)), (T)(max >> 1), max, (T)(denom - 1), denom,
+                (T)(get_random() >> (get_random() % w))};
+            for (T bound : bounds) {
+                if (bound == 0) continue;
+                check_bounded_path(denom, bound);
+                const divider<T, BRANCHFULL> the_divider(denom, bound);
+                if (the_divider.recover() != denom) {
+                    PRINT_ERROR(F("Bounded divider recover failure for "));
+                    PRINT_ERROR(denom);
+                    PRINT_ERROR(F("\n"));
+                    TEST_FAIL();
+                }
+
+                std::vector<T> numers = {0, 1, bound, (T)(bound - 1)};
+                T last = (T)(bound - bound % denom);
+                if (last >= denom) {
+                    numers.push_back((T)(last - 1));
+                    numers.push_back((T)(last - denom));
+                }
+                for (size_t i = 0; i < 16; ++i) {
+                    numers.push_back((T)(get_random() % bound));
+                    numers.push_back((T)(bound - get_random() % bound));
+                }
+                numers.resize((numers.size() / min_vector_count + 1) * min_vector_count, T(0));
+                for (T numer : numers) {
+                    test_one(numer, denom, the_divider);
+                }
+#if defined(VECTOR_TESTS)
+#ifdef LIBDIVIDE_SSE2
+                test_vec<__m128i>(numers.data(), numers.size(), denom, the_divider);
+#endif
+#ifdef LIBDIVIDE_AVX2
+                test_vec<__m256i>(numers.data(), numers.size(), denom, the_divider);
+#endif
+#ifdef LIBDIVIDE_AVX512
+                test_vec<__m512i>(numers.data(), numers.size(), denom, the_divider);
+#endif
+#endif
+            }
+        }
+    }
+#endif
+
     static uint32_t randomSeed() {
 #if defined(__AVR__)
         return (uint32_t)analogRead(A0);
@@ -480,8 +1846,9 @@ class DivideTest {
             test_both_signs(primes[index], tested_denom);
         }
 #else
-        for (UT denom = 1; denom < 1024; ++denom) {
-            test_both_signs(denom, tested_denom);
+        // For 8-bit integers this tests all the denominators.
+        for (uint32_t denom = 1; denom < 1024 && (UT)denom == denom; ++denom) {
+            test_both_signs((UT)denom, tested_denom);
         }
 #endif
 
@@ -522,6 +1889,52 @@ class DivideTest {
         for (int i = 0; i < 10000; ++i) {
             test_all_algorithms(random_denominator(), tested_denom);
         }
+
+        PRINT_PROGRESS_MSG(F("Testing per-element dividers\n"));
+        test_divide_each(tested_denom, std::integral_constant<bool, sizeof(T) <= 8>());
+
+        PRINT_PROGRESS_MSG(F("Testing run-length encoded divisors\n"));
+        test_divide_runs(tested_denom, std::integral_constant<bool, sizeof(T) <= 8>());
+
+        PRINT_PROGRESS_MSG(F("Testing divider tables\n"));
+        std::integral_constant<bool, sizeof(T) <= 8> has_table;
+        test_divider_table<BRANCHFULL>(tested_denom, has_table);
+        // The default table is the branchfree one, which the vector kernels
+        // divide by with gathers
+        static_assert(std::is_same<divider_table<T>, divider_table<T, BRANCHFREE>>::value,
+            "divider_table must default to BRANCHFREE");
+        test_divider_table<BRANCHFREE, divider_table<T>>(tested_denom, has_table);
+
+        PRINT_PROGRESS_MSG(F("Testing divider dictionaries\n"));
+        std::integral_constant<bool, sizeof(T) >= 2 && sizeof(T) <= 8> has_dict;
+        test_divider_dict(tested_denom, has_dict);
+
+        PRINT_PROGRESS_MSG(F("Testing strided quotients and remainders\n"));
+        test_iota_divmod(tested_denom,
+            std::integral_constant<bool, !limits::is_signed && sizeof(T) <= 8>());
+
+        PRINT_PROGRESS_MSG(F("Testing index decomposition\n"));
+        test_index_decomposer(tested_denom,
+            std::integral_constant<bool, !limits::is_signed && sizeof(T) >= 4 && sizeof(T) <= 8>());
+
+        PRINT_PROGRESS_MSG(F("Testing modular multiplication\n"));
+        test_mod_reducer(tested_denom,
+            std::integral_constant<bool, !limits::is_signed && sizeof(T) >= 4 && sizeof(T) <= 8>());
+
+        PRINT_PROGRESS_MSG(F("Testing muldiv\n"));
+        test_muldiv(tested_denom, std::integral_constant<bool, sizeof(T) == 8>());
+
+        PRINT_PROGRESS_MSG(F("Testing rational scaling\n"));
+        test_scaler(tested_denom,
+            std::integral_constant<bool, !limits::is_signed && sizeof(T) >= 4 && sizeof(T) <= 8>());
+
+        PRINT_PROGRESS_MSG(F("Testing fixed-point division\n"));
+        test_fixed(tested_denom,
+            std::integral_constant<bool, !limits::is_signed && sizeof(T) >= 2 && sizeof(T) <= 8>());
+
+        PRINT_PROGRESS_MSG(F("Testing bounded numerators\n"));
+        test_bounded(tested_denom,
+            std::integral_constant<bool, !limits::is_signed && sizeof(T) >= 2 && sizeof(T) <= 8>());
 #endif
     }
 };
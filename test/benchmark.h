@@ -262,6 +262,43 @@ NOINLINE uint64_t sum_quotients_vec(const random_numerators<IntT> &vals, const D
 
 #endif
 
+// Helper - sums an array of quotients written by the bulk divide() API.
+template <typename IntT>
+inline uint64_t sum_array(const IntT *quots, size_t count) {
+#ifdef x86_VECTOR_TYPE
+    // Sum using vectors so that the summation does not dominate the time.
+    const size_t vec_count = sizeof(x86_VECTOR_TYPE) / sizeof(IntT);
+    x86_VECTOR_TYPE sumX4 = SETZERO_SI();
+    size_t i = 0;
+    for (; i + vec_count <= count; i += vec_count) {
+        sumX4 = add_vector<sizeof(IntT)>(sumX4, LOAD_SI((const x86_VECTOR_TYPE *)(quots + i)));
+    }
+    return unsigned_sum_vals((const IntT *)&sumX4, vec_count) +
+           unsigned_sum_vals(quots + i, count - i);
+#else
+    return unsigned_sum_vals(quots, count);
+#endif
+}
+
+template <typename IntT, typename Divisor>
+NOINLINE uint64_t sum_quotients_array(const random_numerators<IntT> &vals, const Divisor &div) {
+    typedef typename std::make_unsigned<IntT>::type UIntT;
+    // Divide in chunks so that the quotients stay in the L1 cache.
+#if defined(__AVR__)
+    IntT quots[32];
+#else
+    alignas(64) IntT quots[1024];
+#endif
+    const size_t chunk = sizeof(quots) / sizeof(quots[0]);
+    UIntT sum = 0;
+    for (size_t i = 0; i < vals.length(); i += chunk) {
+        size_t count = (std::min)(chunk, vals.length() - i);
+        div.divide(vals.begin() + i, quots, count);
+        sum += (UIntT)sum_array(quots, count);
+    }
+    return (uint64_t)sum;
+}
+
 // noinline to force compiler to emit this
 template <typename IntT>
 NOINLINE divider<IntT> generate_1_divisor(IntT d) {
@@ -302,6 +339,8 @@ struct TestResult {
     double branchfree_time;
     double vector_time;
     double vector_branchfree_time;
+    double vector_fp_time;
+    double array_time;
     double gen_time;
     int algo;
 };
@@ -316,6 +355,24 @@ inline void check_result(uint64_t expected, uint64_t actual, uint32_t line_no) {
     }
 }
 
+#ifdef x86_VECTOR_TYPE
+// fp_divider only exists for 16-bit and 32-bit integers.
+template <typename IntT>
+inline void time_vector_fp(
+    const random_numerators<IntT> &, IntT, uint64_t, uint64_t &min_time, std::false_type) {
+    min_time = 0;
+}
+
+template <typename IntT>
+inline void time_vector_fp(const random_numerators<IntT> &vals, IntT denom, uint64_t expected,
+    uint64_t &min_time, std::true_type) {
+    fp_divider<IntT> div_fp(denom);
+    time_double tresult = time_function(vals, div_fp, sum_quotients_vec);
+    min_time = (std::min)(min_time, tresult.time);
+    check_result(tresult.result, expected, __LINE__);
+}
+#endif
+
 template <typename IntT>
 NOINLINE TestResult test_one(const random_numerators<IntT> &vals, IntT denom) {
     const bool testBranchfree = (denom != 1);
@@ -324,7 +381,8 @@ NOINLINE TestResult test_one(const random_numerators<IntT> &vals, IntT denom) {
 
     uint64_t min_my_time = INT64_MAX, min_my_time_branchfree = INT64_MAX,
              min_my_time_vector = INT64_MAX, min_my_time_vector_branchfree = INT64_MAX,
-             min_his_time = INT64_MAX, min_gen_time = INT64_MAX;
+             min_my_time_vector_fp = INT64_MAX,
+             min_my_time_array = INT64_MAX, min_his_time = INT64_MAX, min_gen_time = INT64_MAX;
     time_double tresult;
     for (size_t iter = 0; iter < TEST_COUNT; iter++) {
         tresult = time_function(vals, denom, sum_quotients);
@@ -356,6 +414,17 @@ NOINLINE TestResult test_one(const random_numerators<IntT> &vals, IntT denom) {
         min_my_time_vector_branchfree = 0;
 #endif
 
+#ifdef x86_VECTOR_TYPE
+        time_vector_fp(vals, denom, expected, min_my_time_vector_fp,
+            std::integral_constant<bool, sizeof(IntT) == 2 || sizeof(IntT) == 4>());
+#else
+        min_my_time_vector_fp = 0;
+#endif
+
+        tresult = time_function(vals, div_bfull, sum_quotients_array);
+        min_my_time_array = (std::min)(min_my_time_array, tresult.time);
+        check_result(tresult.result, expected, __LINE__);
+
         {
             timer t;
             t.start();
@@ -372,6 +441,8 @@ NOINLINE TestResult test_one(const random_numerators<IntT> &vals, IntT denom) {
     result.vector_time = min_my_time_vector / (double)vals.length();
     result.vector_branchfree_time =
         testBranchfree ? min_my_time_vector_branchfree / (double)vals.length() : -1;
+    result.vector_fp_time = min_my_time_vector_fp / (double)vals.length();
+    result.array_time = min_my_time_array / (double)vals.length();
     result.hardware_time = min_his_time / (double)vals.length();
     return result;
 }
@@ -401,8 +472,9 @@ NOINLINE TestResult test_one(_IntT d, const random_numerators<_IntT> &data) {
 inline static void print_report_header(void) {
     char buffer[256];
     snprintf(buffer, sizeof buffer,
-        "%6s %" PRIcw "s %" PRIcw "s %" PRIcw "s %" PRIcw "s %" PRIcw "s %" PRIcw "s %6s\n", "#",
-        "system", "scalar", "scl_bf", "vector", "vec_bf", "gener", "algo");
+        "%6s %" PRIcw "s %" PRIcw "s %" PRIcw "s %" PRIcw "s %" PRIcw "s %" PRIcw "s %" PRIcw
+        "s %" PRIcw "s %6s\n",
+        "#", "system", "scalar", "scl_bf", "vector", "vec_bf", "vec_fp", "array", "gener", "algo");
     PRINT_INFO(buffer);
 }
 
@@ -416,9 +488,11 @@ static void print_report_result(_IntT d, struct TestResult result) {
 
     char report_buff[256];
     snprintf(report_buff, sizeof report_buff,
-        "%6s %" PRIrc " %" PRIrc " %" PRIrc " %" PRIrc " %" PRIrc " %" PRIrc " %4d\n", pDenom,
-        result.hardware_time, result.base_time, result.branchfree_time, result.vector_time,
-        result.vector_branchfree_time, result.gen_time, result.algo);
+        "%6s %" PRIrc " %" PRIrc " %" PRIrc " %" PRIrc " %" PRIrc " %" PRIrc " %" PRIrc " %" PRIrc
+        " %4d\n",
+        pDenom, result.hardware_time, result.base_time, result.branchfree_time,
+        result.vector_time, result.vector_branchfree_time, result.vector_fp_time,
+        result.array_time, result.gen_time, result.algo);
     PRINT_INFO(report_buff);
 }
 
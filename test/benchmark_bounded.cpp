@@ -0,0 +1,202 @@
+// Usage: benchmark_bounded [u32] [u64]
+//
+// Benchmarks dividers for bounded numerators, libdivide::divider(d,
+// max_numerator), against the dividers for all numerators. "system" uses
+// hardware division, "scalar" and "bounded" call divider::divide() for
+// every element and "array" and "bounded_array" use the SIMD kernels of the
+// instruction set libdivide was compiled for. The numerators are random
+// numbers <= the bound. The path column shows the path of the bounded
+// divider: "add" for the add marker path, "plain" for the magic number
+// without add fixup and "narrow" for the 32-bit magic of the 64-bit
+// dividers. All times are ns/element.
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "libdivide.h"
+#include "type_mappings.h"
+
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((__noinline__))
+#elif defined(_MSC_VER)
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE
+#endif
+
+enum method_t { SYSTEM, SCALAR, BOUNDED, ARRAY, BOUNDED_ARRAY };
+
+static const char *const method_names[] = {"system", "scalar", "bounded", "array", "bounded_array"};
+
+static uint8_t bounded_more(uint32_t d, uint32_t max_numer) {
+    return libdivide::libdivide_u32_gen_bounded(d, max_numer).more;
+}
+
+static uint8_t bounded_more(uint64_t d, uint64_t max_numer) {
+    return libdivide::libdivide_u64_gen_bounded(d, max_numer).more;
+}
+
+template <typename T>
+static const char *path_name(T d, T max_numer) {
+    uint8_t more = bounded_more(d, max_numer);
+    if (more & libdivide::LIBDIVIDE_ADD_MARKER) return "add";
+    if (sizeof(T) == 8 && (more & libdivide::LIBDIVIDE_NARROW_MARKER)) return "narrow";
+    return "plain";
+}
+
+template <typename T>
+NOINLINE void system_loop(const std::vector<T> &numers, T d, std::vector<T> &quots) {
+    for (size_t i = 0; i < numers.size(); i++) {
+        quots[i] = numers[i] / d;
+    }
+}
+
+template <typename T>
+NOINLINE void scalar_loop(
+    const std::vector<T> &numers, const libdivide::divider<T> &div, std::vector<T> &quots) {
+    for (size_t i = 0; i < numers.size(); i++) {
+        quots[i] = div.divide(numers[i]);
+    }
+}
+
+template <typename T>
+NOINLINE void array_loop(
+    const std::vector<T> &numers, const libdivide::divider<T> &div, std::vector<T> &quots) {
+    div.divide(numers.data(), quots.data(), numers.size());
+}
+
+struct result_t {
+    double duration;
+    uint64_t sum;
+};
+
+template <typename T>
+static uint64_t sum_results(const std::vector<T> &quots) {
+    uint64_t sum = 0;
+    for (T q : quots) sum += (uint64_t)q;
+    return sum;
+}
+
+template <typename F>
+result_t time_it(size_t iters, F f) {
+    auto t1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iters; i++) f();
+    auto t2 = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::nano> nanos = t2 - t1;
+    return result_t{nanos.count(), 0};
+}
+
+template <typename T>
+result_t benchmark_method(
+    method_t method, const std::vector<T> &numers, T d, T max_numer, size_t iters) {
+    const libdivide::divider<T> div(d);
+    const libdivide::divider<T> bounded(d, max_numer);
+    std::vector<T> quots(numers.size());
+    result_t result = time_it(iters, [&]() {
+        switch (method) {
+            case SYSTEM:
+                system_loop(numers, d, quots);
+                break;
+            case SCALAR:
+                scalar_loop(numers, div, quots);
+                break;
+            case BOUNDED:
+                scalar_loop(numers, bounded, quots);
+                break;
+            case ARRAY:
+                array_loop(numers, div, quots);
+                break;
+            default:
+                array_loop(numers, bounded, quots);
+        }
+    });
+    result.sum = sum_results(quots);
+    result.duration /= (double)iters * numers.size();
+    return result;
+}
+
+template <typename T>
+void benchmark_bound(T d, T max_numer, size_t iters) {
+    std::mt19937_64 gen(42);
+    std::uniform_int_distribution<T> dist(0, max_numer);
+    std::vector<T> numers(1 << 12);
+    for (T &numer : numers) numer = dist(gen);
+
+    std::cout << std::setw(21) << (uint64_t)d << std::setw(21) << (uint64_t)max_numer
+              << std::setw(8) << path_name(d, max_numer);
+    result_t system = benchmark_method(SYSTEM, numers, d, max_numer, iters);
+    for (int method = SYSTEM; method <= BOUNDED_ARRAY; method++) {
+        result_t result =
+            method == SYSTEM ? system
+                             : benchmark_method((method_t)method, numers, d, max_numer, iters);
+        if (result.sum != system.sum) {
+            std::cerr << "Error: " << type_tag<T>::get_tag() << " " << (uint64_t)d
+                      << " with numerators <= " << (uint64_t)max_numer << ": system sum "
+                      << system.sum << ", " << method_names[method] << " sum " << result.sum
+                      << std::endl;
+            std::exit(1);
+        }
+        std::cout << std::fixed << std::setprecision(3) << std::setw(14) << result.duration;
+    }
+    std::cout << std::endl;
+}
+
+template <typename T>
+void benchmark(const T *divisors, size_t divisor_count, const T *bounds, size_t bound_count,
+    size_t iters) {
+    std::cout << "----- " << type_tag<T>::get_tag() << " -----" << std::endl;
+    std::cout << std::setw(21) << "divisor" << std::setw(21) << "bound" << std::setw(8) << "path";
+    for (const char *name : method_names) std::cout << std::setw(14) << name;
+    std::cout << std::endl;
+    for (size_t i = 0; i < divisor_count; i++) {
+        for (size_t j = 0; j < bound_count; j++) {
+            benchmark_bound(divisors[i], bounds[j], iters);
+        }
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+    bool test_u32 = argc <= 1, test_u64 = argc <= 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == type_tag<uint32_t>::get_tag()) {
+            test_u32 = true;
+        } else if (arg == type_tag<uint64_t>::get_tag()) {
+            test_u64 = true;
+        } else {
+            std::cout << "Usage: benchmark_bounded [u32] [u64]\n"
+                         "\n"
+                         "Divides arrays of bounded numerators using hardware division, the\n"
+                         "dividers for all numerators and the dividers for bounded numerators.\n"
+                         "Without options u32 and u64 are tested."
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    size_t iters = 50;
+
+    // 7 and 641 need the add marker path for all 32-bit numerators, 7 and
+    // 1000000007 for all 64-bit numerators, 10 does not.
+    const uint32_t divisors32[] = {7, 10, 641};
+    const uint32_t bounds32[] = {UINT32_C(0xFFFF), UINT32_C(0xFFFFFF), UINT32_C(0x7FFFFFFF), UINT32_MAX};
+    const uint64_t divisors64[] = {7, 10, UINT64_C(1000000007)};
+    const uint64_t bounds64[] = {UINT64_C(0x7FFFFFFF), UINT64_C(0xFFFFFFFF), UINT64_C(0xFFFFFFFFFF),
+        UINT64_C(0x7FFFFFFFFFFFFFFF), UINT64_MAX};
+    if (test_u32) {
+        benchmark(divisors32, sizeof(divisors32) / sizeof(divisors32[0]), bounds32,
+            sizeof(bounds32) / sizeof(bounds32[0]), iters);
+    }
+    if (test_u64) {
+        benchmark(divisors64, sizeof(divisors64) / sizeof(divisors64[0]), bounds64,
+            sizeof(bounds64) / sizeof(bounds64[0]), iters);
+    }
+    return 0;
+}
@@ -1,4 +1,4 @@
-// Usage: benchmark_branchfree [u32] [u64] [s32] [s64] [branchfree] [branchfull] [sys|system]
+// Usage: benchmark_branchfree [u32] [u64] [s32] [s64] [branchfree] [branchfull] [each] [sys|system]
 //
 // The branchfree benchmark iterates over an array of dividers and computes
 // divisions. This is the use case where the branchfree divider generally
@@ -64,6 +64,20 @@ NOINLINE size_t sum_dividers(N numerator, const T& dividers) {
     return sum;
 }
 
+// Same as sum_dividers() but the quotients are computed at once by
+// libdivide::divide_by_each(), which divides the numerator by a different
+// divider in each vector lane.
+template <typename T>
+NOINLINE size_t sum_dividers_each(T numerator,
+    const std::vector<libdivide::branchfree_divider<T>>& dividers, std::vector<T>& quots) {
+    libdivide::divide_by_each(numerator, dividers.data(), quots.data(), dividers.size());
+
+    size_t sum = 0;
+    for (T quot : quots) sum += (size_t)quot;
+
+    return sum;
+}
+
 struct result_t {
     double duration;
     size_t sum;
@@ -85,6 +99,24 @@ NOINLINE result_t benchmark_sum_dividers(const D& dividers, size_t iters) {
     return result_t{seconds.count(), sum};
 }
 
+template <typename T>
+NOINLINE result_t benchmark_sum_dividers_each(
+    const std::vector<libdivide::branchfree_divider<T>>& dividers, size_t iters) {
+    std::vector<T> quots(dividers.size());
+    auto t1 = std::chrono::system_clock::now();
+    size_t sum = 0;
+
+    for (; iters > 0; iters--) {
+        // Unsigned branchfree divider cannot be 1
+        T numerator = std::max((T)2, (T)iters);
+        sum += sum_dividers_each(numerator, dividers, quots);
+    }
+
+    auto t2 = std::chrono::system_clock::now();
+    std::chrono::duration<double> seconds = t2 - t1;
+    return result_t{seconds.count(), sum};
+}
+
 enum {
     TEST_U16 = 1 << 0,
     TEST_U32 = 1 << 1,
@@ -96,7 +128,8 @@ enum {
     TEST_SYSTEM = 1 << 6,
     TEST_BRANCHFREE = 1 << 7,
     TEST_BRANCHFULL = 1 << 8,
-    TEST_ALL_ALGOS = (TEST_SYSTEM | TEST_BRANCHFREE | TEST_BRANCHFULL),
+    TEST_EACH = 1 << 9,
+    TEST_ALL_ALGOS = (TEST_SYSTEM | TEST_BRANCHFREE | TEST_BRANCHFULL | TEST_EACH),
 };
 
 using tasks_t = unsigned int;
@@ -108,10 +141,12 @@ void benchmark(tasks_t tasks, size_t max, size_t iters) {
     bool test_system = !!(tasks & TEST_SYSTEM);
     bool test_branchfull = !!(tasks & TEST_BRANCHFULL);
     bool test_branchfree = !!(tasks & TEST_BRANCHFREE);
+    bool test_each = !!(tasks & TEST_EACH);
 
     result_t sys = {0, 0};
     result_t branchfull = {0, 0};
     result_t branchfree = {0, 0};
+    result_t each = {0, 0};
 
     size_t st_max = std::min(max, (size_t)std::numeric_limits<T>::max());
     iters = iters * (max / st_max);
@@ -134,8 +169,16 @@ void benchmark(tasks_t tasks, size_t max, size_t iters) {
         using divider_type = libdivide::branchfree_divider<T>;
         auto dividers = get_primes<divider_type>(t_max);
         branchfree = benchmark_sum_dividers<T>(dividers, iters);
-        std::cout << '.' << std::endl;
+        std::cout << '.' << std::flush;
+    }
+
+    if (test_each) {
+        using divider_type = libdivide::branchfree_divider<T>;
+        auto dividers = get_primes<divider_type>(t_max);
+        each = benchmark_sum_dividers_each<T>(dividers, iters);
+        std::cout << '.' << std::flush;
     }
+    std::cout << std::endl;
 
     if (test_system && test_branchfull && branchfull.sum != sys.sum) {
         std::cerr << "Error: branchfull_divider<" << type_tag<T>::get_tag() << "> sum: " << branchfull.sum
@@ -149,25 +192,33 @@ void benchmark(tasks_t tasks, size_t max, size_t iters) {
         std::exit(1);
     }
 
+    if (test_system && test_each && each.sum != sys.sum) {
+        std::cerr << "Error: divide_by_each<" << type_tag<T>::get_tag() << "> sum: " << each.sum
+                  << ", but system sum: " << sys.sum << std::endl;
+        std::exit(1);
+    }
+
     if (test_system) std::cout << "    system: " << sys.duration << " seconds" << std::endl;
     if (test_branchfull)
         std::cout << "branchfull: " << branchfull.duration << " seconds" << std::endl;
     if (test_branchfree)
         std::cout << "branchfree: " << branchfree.duration << " seconds" << std::endl;
+    if (test_each) std::cout << "      each: " << each.duration << " seconds" << std::endl;
 
     std::cout << std::endl;
 }
 
 void usage() {
     std::cout << "Usage: benchmark_branchfree [uu16] [u32] [u64] [s16] [s32] [s64] [branchfree] "
-                 "[branchfull] "
+                 "[branchfull] [each] "
                  "[sys|system]\n"
                  "\n"
                  "The branchfree benchmark iterates over an array of dividers and computes\n"
                  "divisions. This is the use case where the branchfree divider generally\n"
                  "shines and where the default branchfull divider performs poorly because\n"
                  "the CPU is not able to correctly predict the branches of the many different\n"
-                 "dividers."
+                 "dividers. each divides the numerator by all the dividers at once using\n"
+                 "divide_by_each()."
               << std::endl;
 }
 
@@ -193,6 +244,8 @@ int main(int argc, const char* argv[]) {
             tasks |= TEST_BRANCHFREE;
         } else if (arg == "branchfull") {
             tasks |= TEST_BRANCHFULL;
+        } else if (arg == "each") {
+            tasks |= TEST_EACH;
         } else if (arg == "sys" || arg == "system") {
             tasks |= TEST_SYSTEM;
         } else {
@@ -1,7 +1,7 @@
-// Benchmark for divlu and divllu.
+// Benchmark for divlu, divllu and libdivide_u128_u64_do.
 // Runs continuously until interrupted. All times are ns/call.
 // To build standalone:
-//   cc -O2 -o benchmark_divlu test/benchmark_divlu.c doc/divlu.c
+//   cc -O2 -I. -o benchmark_divlu test/benchmark_divlu.c doc/divlu.c
 
 #include <stdint.h>
 #include <stdio.h>
@@ -11,6 +11,8 @@
 #include <windows.h>
 #endif
 
+#include "libdivide.h"
+
 uint32_t divlu(uint32_t numhi, uint32_t numlo, uint32_t den, uint32_t *r);
 uint64_t divllu(uint64_t numhi, uint64_t numlo, uint64_t den, uint64_t *r);
 
@@ -98,6 +100,18 @@ static uint64_t run_divllu(uint64_t den) {
     return sum;
 }
 
+// Precomputed reciprocal of den, the divider is generated once per den.
+static uint64_t run_u128_u64(const struct libdivide_u128_u64_t *divider) {
+    uint64_t sum = 0;
+    uint32_t i;
+    for (i = 0; i < ARRAY_LEN; i++) {
+        uint64_t rem;
+        sum += libdivide_u128_u64_do(numhi64[i], numlo64[i], divider, &rem);
+        sum += rem;
+    }
+    return sum;
+}
+
 // Hardware 128/64->64 narrowing divide using __uint128_t.
 // clang-cl on Windows does not support 128-bit division (same guard as libdivide.h).
 #if defined(__SIZEOF_INT128__) && !(defined(__clang__) && defined(_MSC_VER))
@@ -133,10 +147,12 @@ static volatile uint64_t sink;
 
 int main(void) {
     uint32_t den = 1;
-    printf("%10s %10s %10s %10s %10s\n", "den", "divlu", "hw(64b)", "divllu", "hw(128b)");
+    printf("%10s %10s %10s %10s %10s %10s\n", "den", "divlu", "hw(64b)", "divllu", "hw(128b)",
+           "u128_u64");
     while (1) {
-        double t_divlu, t_hw64, t_divllu, t_hw128;
-        uint64_t r_divlu, r_hw64, r_divllu, r_hw128;
+        double t_divlu, t_hw64, t_divllu, t_hw128, t_u128_u64;
+        uint64_t r_divlu, r_hw64, r_divllu, r_hw128, r_u128_u64;
+        struct libdivide_u128_u64_t divider = libdivide_u128_u64_gen(den);
 
         fill32(den);
         TIME_FUNC(t_divlu, r_divlu, run_divlu(den));
@@ -149,6 +165,12 @@ int main(void) {
 
         fill64(den);
         TIME_FUNC(t_divllu, r_divllu, run_divllu(den));
+        TIME_FUNC(t_u128_u64, r_u128_u64, run_u128_u64(&divider));
+        if (r_divllu != r_u128_u64) {
+            fprintf(stderr, "u128_u64 mismatch for den=%llu: divllu=%llu u128_u64=%llu\n",
+                    (ullong)den, (ullong)r_divllu, (ullong)r_u128_u64);
+            abort();
+        }
 #if defined(__SIZEOF_INT128__) && !(defined(__clang__) && defined(_MSC_VER))
         TIME_FUNC(t_hw128, r_hw128, run_hw128(den));
         if (r_divllu != r_hw128) {
@@ -162,8 +184,8 @@ int main(void) {
         t_hw128 = 0;
 #endif
 
-        printf("%10u %10.3f %10.3f %10.3f %10.3f\n",
-               den, t_divlu, t_hw64, t_divllu, t_hw128);
+        printf("%10u %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+               den, t_divlu, t_hw64, t_divllu, t_hw128, t_u128_u64);
         fflush(stdout);
 
         den = (den == UINT32_MAX) ? 1 : den + 1;
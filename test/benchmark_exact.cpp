@@ -0,0 +1,153 @@
+// Usage: benchmark_exact [OPTIONS]
+//
+// You can pass the benchmark_exact program one or more of the following
+// options: u16, s16, u32, s32, u64, s64. If benchmark_exact is run
+// without any options u64 is used as default option. benchmark_exact
+// sums the quotients of an array of random multiples of a divisor, as
+// e.g. when dividing pointer differences by the size of a record, using
+// hardware division, libdivide::divider and libdivide::exact_divider,
+// scalar and vector.
+
+// Silence MSVC sprintf unsafe warnings
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "benchmark.h"
+
+#include <string.h>
+
+struct ExactResult {
+    double hardware_time;
+    double base_time;
+    double exact_time;
+    double vector_time;
+    double exact_vector_time;
+};
+
+template <typename IntT>
+NOINLINE ExactResult test_exact(IntT denom) {
+    const random_numerators<IntT> vals(denom);
+    divider<IntT> div(denom);
+    exact_divider<IntT> exact_div(denom);
+
+    uint64_t min_his_time = INT64_MAX, min_my_time = INT64_MAX, min_exact_time = INT64_MAX,
+             min_my_time_vector = INT64_MAX, min_exact_time_vector = INT64_MAX;
+    time_double tresult;
+    for (size_t iter = 0; iter < TEST_COUNT; iter++) {
+        tresult = time_function(vals, denom, sum_quotients);
+        min_his_time = (std::min)(min_his_time, tresult.time);
+        const uint64_t expected = tresult.result;
+
+        tresult = time_function(vals, div, sum_quotients);
+        min_my_time = (std::min)(min_my_time, tresult.time);
+        check_result(tresult.result, expected, __LINE__);
+
+        tresult = time_function(vals, exact_div, sum_quotients);
+        min_exact_time = (std::min)(min_exact_time, tresult.time);
+        check_result(tresult.result, expected, __LINE__);
+
+#if defined(x86_VECTOR_TYPE) || defined(LIBDIVIDE_NEON)
+        tresult = time_function(vals, div, sum_quotients_vec);
+        min_my_time_vector = (std::min)(min_my_time_vector, tresult.time);
+        check_result(tresult.result, expected, __LINE__);
+
+        tresult = time_function(vals, exact_div, sum_quotients_vec);
+        min_exact_time_vector = (std::min)(min_exact_time_vector, tresult.time);
+        check_result(tresult.result, expected, __LINE__);
+#else
+        min_my_time_vector = 0;
+        min_exact_time_vector = 0;
+#endif
+    }
+
+    ExactResult result;
+    result.hardware_time = min_his_time / (double)vals.length();
+    result.base_time = min_my_time / (double)vals.length();
+    result.exact_time = min_exact_time / (double)vals.length();
+    result.vector_time = min_my_time_vector / (double)vals.length();
+    result.exact_vector_time = min_exact_time_vector / (double)vals.length();
+    return result;
+}
+
+template <typename IntT>
+void test_many_exact() {
+    print_banner<IntT>();
+
+    char buffer[256];
+    snprintf(buffer, sizeof buffer,
+        "%12s %" PRIcw "s %" PRIcw "s %" PRIcw "s %" PRIcw "s %" PRIcw "s\n", "#", "system",
+        "scalar", "exact", "vector", "vec_exact");
+    PRINT_INFO(buffer);
+
+    // Typical record sizes, odd divisors and large divisors
+    const int64_t denoms[] = {3, 7, 12, 24, 40, 100, 641, 1000, 4096, 65535, 2147483647,
+        INT64_C(1) << 40, INT64_C(0x7FFFFFFFFFFFFFE7), -7, -24, -641};
+
+    for (int64_t denom : denoms) {
+        const IntT d = (IntT)denom;
+        if ((int64_t)d != denom || (denom < 0 && !std::numeric_limits<IntT>::is_signed)) {
+            continue;
+        }
+
+        ExactResult result = test_exact(d);
+        char denom_buff[32];
+        snprintf(buffer, sizeof buffer,
+            "%12s %" PRIrc " %" PRIrc " %" PRIrc " %" PRIrc " %" PRIrc "\n",
+            to_str(denom_buff, d), result.hardware_time, result.base_time, result.exact_time,
+            result.vector_time, result.exact_vector_time);
+        PRINT_INFO(buffer);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // Disable printf buffering.
+    // This is mainly required for Windows.
+    setbuf(stdout, NULL);
+
+    bool u16 = 0;
+    bool s16 = 0;
+    bool u32 = 0;
+    bool s32 = 0;
+    bool u64 = 0;
+    bool s64 = 0;
+
+    if (argc == 1) {
+        // By default test only u64
+        u64 = 1;
+    } else {
+        for (int i = 1; i < argc; i++) {
+            if (!strcmp(argv[i], type_tag<uint16_t>::get_tag()))
+                u16 = true;
+            else if (!strcmp(argv[i], type_tag<uint32_t>::get_tag()))
+                u32 = true;
+            else if (!strcmp(argv[i], type_tag<uint64_t>::get_tag()))
+                u64 = true;
+            else if (!strcmp(argv[i], type_tag<int16_t>::get_tag()))
+                s16 = true;
+            else if (!strcmp(argv[i], type_tag<int32_t>::get_tag()))
+                s32 = true;
+            else if (!strcmp(argv[i], type_tag<int64_t>::get_tag()))
+                s64 = true;
+            else {
+                printf(
+                    "Usage: benchmark_exact [OPTIONS]\n"
+                    "\n"
+                    "You can pass the benchmark_exact program one or more of the following\n"
+                    "options: u16, s16, u32, s32, u64, s64. If benchmark_exact is run\n"
+                    "without any options u64 is used as default option. benchmark_exact\n"
+                    "sums the quotients of an array of random multiples of a divisor\n"
+                    "using hardware division, libdivide::divider and\n"
+                    "libdivide::exact_divider, scalar and vector.\n");
+                exit(1);
+            }
+        }
+    }
+
+    if (u16) test_many_exact<uint16_t>();
+    if (s16) test_many_exact<int16_t>();
+    if (u32) test_many_exact<uint32_t>();
+    if (s32) test_many_exact<int32_t>();
+    if (u64) test_many_exact<uint64_t>();
+    if (s64) test_many_exact<int64_t>();
+
+    return 0;
+}
@@ -0,0 +1,189 @@
+// Usage: benchmark_gen_array [u32] [u64]
+//
+// Benchmarks the generation of many dividers at once, e.g. for a
+// divider_table of per-group divisors. "gen" calls libdivide_*_gen() for every
+// divisor and "gen_array" calls libdivide_*_gen_array(), which computes the
+// dividers of 32-bit unsigned integers using the SIMD kernels of the
+// instruction set libdivide was compiled for. The divisors are random numbers
+// in [2, max]. All times are ns/divider.
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "libdivide.h"
+#include "type_mappings.h"
+
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((__noinline__))
+#elif defined(_MSC_VER)
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE
+#endif
+
+enum method_t { GEN, GEN_ARRAY, BRANCHFREE_GEN, BRANCHFREE_GEN_ARRAY };
+
+static const char *const method_names[] = {
+    "gen", "gen_array", "branchfree_gen", "branchfree_gen_array"};
+
+NOINLINE void gen_loop(const std::vector<uint32_t> &divisors, std::vector<uint32_t> &magics,
+    std::vector<uint8_t> &mores, bool branchfree) {
+    for (size_t i = 0; i < divisors.size(); i++) {
+        if (branchfree) {
+            libdivide::libdivide_u32_branchfree_t denom =
+                libdivide::libdivide_u32_branchfree_gen(divisors[i]);
+            magics[i] = denom.magic;
+            mores[i] = denom.more;
+        } else {
+            libdivide::libdivide_u32_t denom = libdivide::libdivide_u32_gen(divisors[i]);
+            magics[i] = denom.magic;
+            mores[i] = denom.more;
+        }
+    }
+}
+
+NOINLINE void gen_loop(const std::vector<uint64_t> &divisors, std::vector<uint64_t> &magics,
+    std::vector<uint8_t> &mores, bool branchfree) {
+    for (size_t i = 0; i < divisors.size(); i++) {
+        if (branchfree) {
+            libdivide::libdivide_u64_branchfree_t denom =
+                libdivide::libdivide_u64_branchfree_gen(divisors[i]);
+            magics[i] = denom.magic;
+            mores[i] = denom.more;
+        } else {
+            libdivide::libdivide_u64_t denom = libdivide::libdivide_u64_gen(divisors[i]);
+            magics[i] = denom.magic;
+            mores[i] = denom.more;
+        }
+    }
+}
+
+NOINLINE void gen_array(const std::vector<uint32_t> &divisors, std::vector<uint32_t> &magics,
+    std::vector<uint8_t> &mores, bool branchfree) {
+    if (branchfree) {
+        libdivide::libdivide_u32_branchfree_gen_array(
+            divisors.data(), magics.data(), mores.data(), divisors.size());
+    } else {
+        libdivide::libdivide_u32_gen_array(
+            divisors.data(), magics.data(), mores.data(), divisors.size());
+    }
+}
+
+NOINLINE void gen_array(const std::vector<uint64_t> &divisors, std::vector<uint64_t> &magics,
+    std::vector<uint8_t> &mores, bool branchfree) {
+    if (branchfree) {
+        libdivide::libdivide_u64_branchfree_gen_array(
+            divisors.data(), magics.data(), mores.data(), divisors.size());
+    } else {
+        libdivide::libdivide_u64_gen_array(
+            divisors.data(), magics.data(), mores.data(), divisors.size());
+    }
+}
+
+struct result_t {
+    double duration;
+    uint64_t sum;
+};
+
+template <typename T>
+static uint64_t sum_results(const std::vector<T> &magics, const std::vector<uint8_t> &mores) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < magics.size(); i++) sum += (uint64_t)magics[i] * 3 + mores[i];
+    return sum;
+}
+
+template <typename F>
+result_t time_it(size_t iters, F f) {
+    auto t1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iters; i++) f();
+    auto t2 = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::nano> nanos = t2 - t1;
+    return result_t{nanos.count(), 0};
+}
+
+template <typename T>
+result_t benchmark_method(method_t method, const std::vector<T> &divisors, size_t iters) {
+    std::vector<T> magics(divisors.size());
+    std::vector<uint8_t> mores(divisors.size());
+    bool branchfree = method == BRANCHFREE_GEN || method == BRANCHFREE_GEN_ARRAY;
+    result_t result = time_it(iters, [&]() {
+        if (method == GEN || method == BRANCHFREE_GEN) {
+            gen_loop(divisors, magics, mores, branchfree);
+        } else {
+            gen_array(divisors, magics, mores, branchfree);
+        }
+    });
+    result.sum = sum_results(magics, mores);
+    result.duration /= (double)iters * divisors.size();
+    return result;
+}
+
+template <typename T>
+void benchmark_bound(T max, size_t iters) {
+    std::mt19937_64 gen(42);
+    std::uniform_int_distribution<T> dist(2, max);
+    std::vector<T> divisors(1 << 12);
+    for (T &divisor : divisors) divisor = dist(gen);
+
+    std::cout << std::setw(21) << (uint64_t)max;
+    result_t expected[2];
+    for (int method = GEN; method <= BRANCHFREE_GEN_ARRAY; method++) {
+        result_t result = benchmark_method((method_t)method, divisors, iters);
+        if (method == GEN || method == BRANCHFREE_GEN) {
+            expected[method == BRANCHFREE_GEN] = result;
+        } else if (result.sum != expected[method == BRANCHFREE_GEN_ARRAY].sum) {
+            std::cerr << "Error: " << type_tag<T>::get_tag() << " divisors <= " << (uint64_t)max
+                      << ": " << method_names[method] << " differs from the scalar generation"
+                      << std::endl;
+            std::exit(1);
+        }
+        std::cout << std::fixed << std::setprecision(3) << std::setw(22) << result.duration;
+    }
+    std::cout << std::endl;
+}
+
+template <typename T>
+void benchmark(const T *bounds, size_t count, size_t iters) {
+    std::cout << "----- " << type_tag<T>::get_tag() << " -----" << std::endl;
+    std::cout << std::setw(21) << "max divisor";
+    for (const char *name : method_names) std::cout << std::setw(22) << name;
+    std::cout << std::endl;
+    for (size_t i = 0; i < count; i++) {
+        benchmark_bound(bounds[i], iters);
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+    bool test_u32 = argc <= 1, test_u64 = argc <= 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == type_tag<uint32_t>::get_tag()) {
+            test_u32 = true;
+        } else if (arg == type_tag<uint64_t>::get_tag()) {
+            test_u64 = true;
+        } else {
+            std::cout << "Usage: benchmark_gen_array [u32] [u64]\n"
+                         "\n"
+                         "Generates the dividers of arrays of random divisors one at a time\n"
+                         "and with the bulk generation.\n"
+                         "Without options u32 and u64 are tested."
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    size_t iters = 50;
+
+    const uint32_t bounds32[] = {UINT32_C(1000), UINT32_C(0xFFFFFF), UINT32_MAX};
+    const uint64_t bounds64[] = {UINT64_C(1000), UINT64_C(0xFFFFFFFF), UINT64_MAX};
+    if (test_u32) benchmark(bounds32, sizeof(bounds32) / sizeof(bounds32[0]), iters);
+    if (test_u64) benchmark(bounds64, sizeof(bounds64) / sizeof(bounds64[0]), iters);
+    return 0;
+}
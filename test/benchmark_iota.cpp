@@ -0,0 +1,157 @@
+// Usage: benchmark_iota [u16] [u32] [u64]
+//
+// Benchmarks the quotients and remainders of strided numerators
+// start + i * step, as e.g. the rows and columns of flat indices. For
+// several steps and divisors they are computed using hardware division,
+// libdivide::divider per index, libdivide::quotient_iterator and
+// libdivide::iota_divmod(). All times are ns/element.
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "libdivide.h"
+#include "type_mappings.h"
+
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((__noinline__))
+#elif defined(_MSC_VER)
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE
+#endif
+
+struct result_t {
+    double duration;
+    uint64_t sum;
+};
+
+// Checksum of the results, computed after the timing as it costs about as
+// much as computing the results.
+template <typename T>
+static uint64_t sum_results(const std::vector<T> &quots, const std::vector<T> &rems) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < quots.size(); i++) sum += (uint64_t)quots[i] * 31 + rems[i];
+    return sum;
+}
+
+template <typename T>
+NOINLINE void divmod_system(T start, T step, T d, std::vector<T> &quots, std::vector<T> &rems) {
+    T n = start;
+    for (size_t i = 0; i < quots.size(); i++, n = (T)(n + step)) {
+        quots[i] = (T)(n / d);
+        rems[i] = (T)(n % d);
+    }
+}
+
+template <typename T>
+NOINLINE void divmod_divider(T start, T step, T d, std::vector<T> &quots, std::vector<T> &rems) {
+    libdivide::divider<T> div(d);
+    T n = start;
+    for (size_t i = 0; i < quots.size(); i++, n = (T)(n + step)) {
+        T q = div.divide(n);
+        quots[i] = q;
+        rems[i] = (T)(n - q * d);
+    }
+}
+
+template <typename T>
+NOINLINE void divmod_iterator(T start, T step, T d, std::vector<T> &quots, std::vector<T> &rems) {
+    libdivide::quotient_iterator<T> it(start, step, d);
+    for (size_t i = 0; i < quots.size(); i++, ++it) {
+        quots[i] = it.quotient();
+        rems[i] = it.remainder();
+    }
+}
+
+template <typename T>
+NOINLINE void divmod_iota(T start, T step, T d, std::vector<T> &quots, std::vector<T> &rems) {
+    libdivide::iota_divmod(start, step, quots.size(), d, quots.data(), rems.data());
+}
+
+template <typename T, typename F>
+result_t time_it(size_t iters, const std::vector<T> &quots, const std::vector<T> &rems, F f) {
+    auto t1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iters; i++) f();
+    auto t2 = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::nano> nanos = t2 - t1;
+    return result_t{nanos.count(), sum_results(quots, rems)};
+}
+
+template <typename T>
+void benchmark_iota(T start, T step, T d, size_t count, size_t iters) {
+    std::vector<T> quots(count), rems(count);
+    result_t sys = time_it(iters, quots, rems, [&] { divmod_system(start, step, d, quots, rems); });
+    result_t scalar =
+        time_it(iters, quots, rems, [&] { divmod_divider(start, step, d, quots, rems); });
+    result_t iter =
+        time_it(iters, quots, rems, [&] { divmod_iterator(start, step, d, quots, rems); });
+    result_t bulk = time_it(iters, quots, rems, [&] { divmod_iota(start, step, d, quots, rems); });
+    if (scalar.sum != sys.sum || iter.sum != sys.sum || bulk.sum != sys.sum) {
+        std::cerr << "Error: " << type_tag<T>::get_tag() << " step " << (uint64_t)step
+                  << " divisor " << (uint64_t)d << ": system sum " << sys.sum
+                  << ", divider sum " << scalar.sum << ", quotient_iterator sum " << iter.sum
+                  << ", iota_divmod sum " << bulk.sum << std::endl;
+        std::exit(1);
+    }
+    const double elements = (double)iters * count;
+    std::cout << std::setw(21) << (uint64_t)step << std::setw(21) << (uint64_t)d << std::fixed
+              << std::setprecision(3) << std::setw(10) << sys.duration / elements
+              << std::setw(10) << scalar.duration / elements << std::setw(10)
+              << iter.duration / elements << std::setw(12) << bulk.duration / elements
+              << std::endl;
+}
+
+template <typename T>
+void benchmark(size_t iters) {
+    std::cout << "----- " << type_tag<T>::get_tag() << " -----" << std::endl;
+    std::cout << std::setw(21) << "step" << std::setw(21) << "divisor" << std::setw(10)
+              << "system" << std::setw(10) << "divider" << std::setw(10) << "iterator"
+              << std::setw(12) << "iota_divmod" << std::endl;
+
+    const size_t count = 1 << 14;
+    const T steps[] = {1, 3, 640};
+    const T divisors[] = {7, 1920, (T)((T)-1 / 3)};
+    for (T step : steps) {
+        for (T d : divisors) {
+            benchmark_iota<T>(0, step, d, count, iters);
+        }
+    }
+    // Numerators that wrap around every few elements
+    benchmark_iota<T>(0, (T)((T)-1 / 5), 1920, count, iters);
+    std::cout << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+    bool test_u16 = false, test_u32 = argc <= 1, test_u64 = argc <= 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == type_tag<uint16_t>::get_tag()) {
+            test_u16 = true;
+        } else if (arg == type_tag<uint32_t>::get_tag()) {
+            test_u32 = true;
+        } else if (arg == type_tag<uint64_t>::get_tag()) {
+            test_u64 = true;
+        } else {
+            std::cout << "Usage: benchmark_iota [u16] [u32] [u64]\n"
+                         "\n"
+                         "Computes the quotients and remainders of strided numerators using\n"
+                         "hardware division, a libdivide::divider per index,\n"
+                         "libdivide::quotient_iterator and libdivide::iota_divmod(). Without\n"
+                         "options u32 and u64 are tested."
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    size_t iters = 40;
+
+    if (test_u16) benchmark<uint16_t>(iters);
+    if (test_u32) benchmark<uint32_t>(iters);
+    if (test_u64) benchmark<uint64_t>(iters);
+    return 0;
+}
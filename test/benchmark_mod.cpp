@@ -0,0 +1,258 @@
+// Usage: benchmark_mod [u32] [s32]
+//
+// Benchmarks the remainder (n % d) and the divisibility test (n % d == 0)
+// of 32-bit integers, as used e.g. by hash tables to map hashes to
+// buckets. For each divisor the remainders of an array of random
+// numerators are summed using the % operator, libdivide::divider
+// (quotient followed by a multiply-subtract) and libdivide::fastmod_divider.
+//
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "libdivide.h"
+#include "type_mappings.h"
+
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((__noinline__))
+#elif defined(_MSC_VER)
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE
+#endif
+
+struct result_t {
+    double duration;
+    uint64_t sum;
+};
+
+// The numerators are xored with a different seed in each iteration so
+// that the compiler cannot hoist the work out of the benchmark loop.
+// Remainders are summed (as unsigned) and multiples of d are counted in
+// the high 32 bits of the sum.
+template <typename T>
+NOINLINE uint64_t sum_system(const std::vector<T> &numers, T seed, T d) {
+    uint64_t sum = 0;
+    for (T n : numers) sum += (uint32_t)((n ^ seed) % d);
+    return sum;
+}
+
+template <typename T>
+NOINLINE uint64_t sum_divider(
+    const std::vector<T> &numers, T seed, const libdivide::divider<T> &div) {
+    uint64_t sum = 0;
+    for (T n : numers) sum += (uint32_t)((n ^ seed) % div);
+    return sum;
+}
+
+template <typename T>
+NOINLINE uint64_t sum_fastmod(
+    const std::vector<T> &numers, T seed, const libdivide::fastmod_divider<T> &div) {
+    uint64_t sum = 0;
+    for (T n : numers) sum += (uint32_t)div.mod(n ^ seed);
+    return sum;
+}
+
+template <typename T>
+NOINLINE uint64_t count_system(const std::vector<T> &numers, T seed, T d) {
+    uint64_t count = 0;
+    for (T n : numers) count += ((n ^ seed) % d == 0);
+    return count << 32;
+}
+
+template <typename T>
+NOINLINE uint64_t count_fastmod(
+    const std::vector<T> &numers, T seed, const libdivide::fastmod_divider<T> &div) {
+    uint64_t count = 0;
+    for (T n : numers) count += div.is_divisible(n ^ seed);
+    return count << 32;
+}
+
+#if defined(LIBDIVIDE_AVX512)
+typedef __m512i vec_t;
+#define VEC_NAME "avx512"
+#define VEC_LOADU(p) _mm512_loadu_si512((const void *)(p))
+#define VEC_STOREU(p, v) _mm512_storeu_si512((void *)(p), v)
+#define VEC_SET1(x) _mm512_set1_epi32((int)(x))
+#define VEC_XOR(a, b) _mm512_xor_si512(a, b)
+#elif defined(LIBDIVIDE_AVX2)
+typedef __m256i vec_t;
+#define VEC_NAME "avx2"
+#define VEC_LOADU(p) _mm256_loadu_si256((const __m256i *)(p))
+#define VEC_STOREU(p, v) _mm256_storeu_si256((__m256i *)(p), v)
+#define VEC_SET1(x) _mm256_set1_epi32((int)(x))
+#define VEC_XOR(a, b) _mm256_xor_si256(a, b)
+#elif defined(LIBDIVIDE_SSE2)
+typedef __m128i vec_t;
+#define VEC_NAME "sse2"
+#define VEC_LOADU(p) _mm_loadu_si128((const __m128i *)(p))
+#define VEC_STOREU(p, v) _mm_storeu_si128((__m128i *)(p), v)
+#define VEC_SET1(x) _mm_set1_epi32((int)(x))
+#define VEC_XOR(a, b) _mm_xor_si128(a, b)
+#endif
+
+#if defined(VEC_NAME)
+// numers.size() must be a multiple of the vector width
+template <typename T, typename D>
+NOINLINE uint64_t sum_vector(const std::vector<T> &numers, T seed, const D &div) {
+    const size_t count = sizeof(vec_t) / sizeof(T);
+    const vec_t seeds = VEC_SET1(seed);
+    T rems[count];
+    uint64_t sum = 0;
+    for (size_t i = 0; i < numers.size(); i += count) {
+        VEC_STOREU(rems, div.mod(VEC_XOR(VEC_LOADU(&numers[i]), seeds)));
+        for (size_t j = 0; j < count; j++) sum += (uint32_t)rems[j];
+    }
+    return sum;
+}
+
+// Same as above using divider::remainder()
+template <typename T>
+NOINLINE uint64_t sum_vector(
+    const std::vector<T> &numers, T seed, const libdivide::divider<T> &div) {
+    const size_t count = sizeof(vec_t) / sizeof(T);
+    const vec_t seeds = VEC_SET1(seed);
+    T rems[count];
+    uint64_t sum = 0;
+    for (size_t i = 0; i < numers.size(); i += count) {
+        VEC_STOREU(rems, div.remainder(VEC_XOR(VEC_LOADU(&numers[i]), seeds)));
+        for (size_t j = 0; j < count; j++) sum += (uint32_t)rems[j];
+    }
+    return sum;
+}
+#endif
+
+template <typename T, typename F>
+result_t time_it(size_t iters, F f) {
+    auto t1 = std::chrono::system_clock::now();
+    uint64_t sum = 0;
+    for (size_t i = 0; i < iters; i++) sum += f((T)i);
+    auto t2 = std::chrono::system_clock::now();
+    std::chrono::duration<double> seconds = t2 - t1;
+    return result_t{seconds.count(), sum};
+}
+
+static void check(const char *name, const std::string &tag, const result_t &result,
+    const result_t &expect) {
+    if (result.sum != expect.sum) {
+        std::cerr << "Error: " << name << "<" << tag << "> sum: " << result.sum
+                  << ", but system sum: " << expect.sum << std::endl;
+        std::exit(1);
+    }
+}
+
+static void print(const char *name, const result_t &result) {
+    std::cout << std::setw(26) << name << ": " << result.duration << " seconds" << std::endl;
+}
+
+template <typename T>
+void benchmark(size_t iters) {
+    const std::string tag = type_tag<T>::get_tag();
+    std::cout << "----- " << tag << " -----" << std::endl;
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<T> dist;
+    std::vector<T> numers(1 << 12);
+    for (auto &n : numers) n = dist(gen);
+
+    // Typical hash table sizes: primes, powers of 2 and others
+    const T denoms[] = {7, 61, 97, 1024, 1543, 6151, 24593, 100000, 786433, 1 << 24, 50331653,
+        (T)2147483647};
+
+    result_t sys = {0, 0}, branchfull = {0, 0}, fastmod = {0, 0};
+    result_t sys_div = {0, 0}, fastmod_div = {0, 0};
+#if defined(VEC_NAME)
+    result_t branchfull_vec = {0, 0}, fastmod_vec = {0, 0};
+#endif
+
+    for (T d : denoms) {
+        libdivide::divider<T> div(d);
+        libdivide::fastmod_divider<T> fm(d);
+        result_t r;
+
+        r = time_it<T>(iters, [&](T seed) { return sum_system(numers, seed, d); });
+        sys.duration += r.duration;
+        sys.sum += r.sum;
+        r = time_it<T>(iters, [&](T seed) { return sum_divider(numers, seed, div); });
+        branchfull.duration += r.duration;
+        branchfull.sum += r.sum;
+        r = time_it<T>(iters, [&](T seed) { return sum_fastmod(numers, seed, fm); });
+        fastmod.duration += r.duration;
+        fastmod.sum += r.sum;
+        r = time_it<T>(iters, [&](T seed) { return count_system(numers, seed, d); });
+        sys_div.duration += r.duration;
+        sys_div.sum += r.sum;
+        r = time_it<T>(iters, [&](T seed) { return count_fastmod(numers, seed, fm); });
+        fastmod_div.duration += r.duration;
+        fastmod_div.sum += r.sum;
+#if defined(VEC_NAME)
+        r = time_it<T>(iters, [&](T seed) { return sum_vector(numers, seed, div); });
+        branchfull_vec.duration += r.duration;
+        branchfull_vec.sum += r.sum;
+        r = time_it<T>(iters, [&](T seed) { return sum_vector(numers, seed, fm); });
+        fastmod_vec.duration += r.duration;
+        fastmod_vec.sum += r.sum;
+#endif
+        std::cout << '.' << std::flush;
+    }
+    std::cout << std::endl;
+
+    check("divider", tag, branchfull, sys);
+    check("fastmod_divider", tag, fastmod, sys);
+    check("fastmod_divider::is_divisible", tag, fastmod_div, sys_div);
+#if defined(VEC_NAME)
+    check("divider " VEC_NAME, tag, branchfull_vec, sys);
+    check("fastmod_divider " VEC_NAME, tag, fastmod_vec, sys);
+#endif
+
+    print("system %", sys);
+    print("divider %", branchfull);
+    print("fastmod_divider %", fastmod);
+#if defined(VEC_NAME)
+    print("divider % " VEC_NAME, branchfull_vec);
+    print("fastmod_divider % " VEC_NAME, fastmod_vec);
+#endif
+    print("system % == 0", sys_div);
+    print("fastmod is_divisible", fastmod_div);
+    std::cout << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+    bool test_u32 = argc <= 1;
+    bool test_s32 = argc <= 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == type_tag<uint32_t>::get_tag()) {
+            test_u32 = true;
+        } else if (arg == type_tag<int32_t>::get_tag()) {
+            test_s32 = true;
+        } else {
+            std::cout << "Usage: benchmark_mod [u32] [s32]\n"
+                         "\n"
+                         "Benchmarks n % d and n % d == 0 using the % operator,\n"
+                         "libdivide::divider and libdivide::fastmod_divider."
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    size_t iters = 2000;
+
+    if (test_u32) {
+        benchmark<uint32_t>(iters);
+    }
+
+    if (test_s32) {
+        benchmark<int32_t>(iters);
+    }
+
+    std::cout << "All tests passed successfully!" << std::endl;
+
+    return 0;
+}
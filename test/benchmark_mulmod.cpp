@@ -0,0 +1,250 @@
+// Usage: benchmark_mulmod [u32] [u64]
+//
+// Benchmarks modular multiplication a * b % m by a runtime modulus m. The
+// remainders of the double width products are computed using hardware
+// division (%), libdivide_128_div_64_to_64() (u64 only),
+// libdivide::mod_reducer::mulmod() and, for odd moduli, Montgomery
+// multiplication. The factors of the Montgomery multiplications are
+// converted into Montgomery form beforehand, as e.g. the twiddle factors
+// of a number theoretic transform. "products" are independent
+// multiplications, "chain" multiplies the factors into one product and
+// "powmod" computes a^e % m for 64-bit exponents. All times are
+// ns/multiplication.
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "libdivide.h"
+#include "type_mappings.h"
+
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((__noinline__))
+#elif defined(_MSC_VER)
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE
+#endif
+
+// The modular multiplication methods, Montgomery multiplies a factor in
+// Montgomery form by one in normal form, which yields the normal form.
+enum method_t { SYSTEM, DIV_128_64, MULMOD, MONTGOMERY };
+
+static const char *const method_names[] = {"system", "128_div_64", "mulmod", "montgomery"};
+
+static uint32_t system_mulmod(uint32_t a, uint32_t b, uint32_t m) {
+    return (uint32_t)((uint64_t)a * b % m);
+}
+
+static uint64_t system_mulmod(uint64_t a, uint64_t b, uint64_t m) {
+#if defined(HAS_INT128_T) && defined(HAS_INT128_DIV)
+    return (uint64_t)((__uint128_t)a * b % m);
+#else
+    uint64_t rem;
+    libdivide::libdivide_128_div_64_to_64(libdivide::libdivide_mullhi_u64(a, b), a * b, m, &rem);
+    return rem;
+#endif
+}
+
+static uint64_t div_128_64_mulmod(uint64_t a, uint64_t b, uint64_t m) {
+    uint64_t rem;
+    libdivide::libdivide_128_div_64_to_64(libdivide::libdivide_mullhi_u64(a, b), a * b, m, &rem);
+    return rem;
+}
+
+template <typename T>
+static T mulmod(method_t method, T a, T b, T m, const libdivide::mod_reducer<T> &reducer) {
+    switch (method) {
+        case SYSTEM:
+            return system_mulmod(a, b, m);
+        case DIV_128_64:
+            return (T)div_128_64_mulmod(a, b, m);
+        case MULMOD:
+            return reducer.mulmod(a, b);
+        default:
+            return reducer.montgomery_mul(a, b);
+    }
+}
+
+// The method is a template parameter so that the loops are specialized
+template <typename T, method_t METHOD>
+NOINLINE void products(const std::vector<T> &a, const std::vector<T> &b, T m,
+    const libdivide::mod_reducer<T> &reducer, std::vector<T> &out) {
+    for (size_t i = 0; i < a.size(); i++) {
+        out[i] = mulmod(METHOD, a[i], b[i], m, reducer);
+    }
+}
+
+template <typename T, method_t METHOD>
+NOINLINE uint64_t chain(
+    const std::vector<T> &a, T m, const libdivide::mod_reducer<T> &reducer, T start) {
+    T x = METHOD == MONTGOMERY ? reducer.to_montgomery(start) : (T)(start % m);
+    for (size_t i = 0; i < a.size(); i++) {
+        x = mulmod(METHOD, x, a[i], m, reducer);
+    }
+    return METHOD == MONTGOMERY ? reducer.from_montgomery(x) : x;
+}
+
+template <typename T, method_t METHOD>
+NOINLINE void powmods(const std::vector<T> &a, const std::vector<uint64_t> &exps, T m,
+    const libdivide::mod_reducer<T> &reducer, std::vector<T> &out) {
+    for (size_t i = 0; i < exps.size(); i++) {
+        if (METHOD == MONTGOMERY) {
+            out[i] = reducer.powmod(a[i], exps[i]);
+            continue;
+        }
+        T x = a[i], result = (T)(1 % m);
+        for (uint64_t e = exps[i]; e != 0; e >>= 1) {
+            if (e & 1) result = mulmod(METHOD, result, x, m, reducer);
+            x = mulmod(METHOD, x, x, m, reducer);
+        }
+        out[i] = result;
+    }
+}
+
+struct result_t {
+    double duration;
+    uint64_t sum;
+};
+
+template <typename T>
+static uint64_t sum_results(const std::vector<T> &out) {
+    uint64_t sum = 0;
+    for (T x : out) sum += (uint64_t)x;
+    return sum;
+}
+
+// f receives the iteration so that the compiler cannot hoist calls out of
+// the timing loop.
+template <typename F>
+result_t time_it(size_t iters, F f) {
+    auto t1 = std::chrono::steady_clock::now();
+    uint64_t sum = 0;
+    for (size_t i = 0; i < iters; i++) sum += f(i);
+    auto t2 = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::nano> nanos = t2 - t1;
+    return result_t{nanos.count(), sum};
+}
+
+template <typename T, method_t METHOD>
+void benchmark_method(const std::vector<T> &a, const std::vector<T> &b,
+    const std::vector<uint64_t> &exps, T m, size_t iters, result_t results[3]) {
+    libdivide::mod_reducer<T> reducer(m);
+    // Montgomery multiplies the factors of a in Montgomery form
+    std::vector<T> a_in(a);
+    if (METHOD == MONTGOMERY) {
+        for (T &x : a_in) x = reducer.to_montgomery(x);
+    }
+    std::vector<T> out(a.size());
+    results[0] = time_it(iters, [&](size_t) {
+        products<T, METHOD>(a_in, b, m, reducer, out);
+        return (uint64_t)0;
+    });
+    results[0].sum = sum_results(out);
+    results[1] =
+        time_it(iters, [&](size_t i) { return chain<T, METHOD>(a_in, m, reducer, (T)(i + 1)); });
+    // powmod() converts into Montgomery form itself
+    out.resize(exps.size());
+    results[2] = time_it(iters, [&](size_t) {
+        powmods<T, METHOD>(a, exps, m, reducer, out);
+        return (uint64_t)0;
+    });
+    results[2].sum = sum_results(out);
+    results[0].duration /= (double)iters * a.size();
+    results[1].duration /= (double)iters * a.size();
+    // About 1.5 multiplications per exponent bit
+    results[2].duration /= (double)iters * exps.size() * 96;
+}
+
+template <typename T>
+void benchmark_modulus(T m, size_t iters) {
+    std::mt19937_64 gen(42);
+    std::vector<T> a(1 << 12), b(a.size());
+    std::vector<uint64_t> exps(a.size() / 16);
+    for (size_t i = 0; i < a.size(); i++) {
+        a[i] = (T)(gen() % m);
+        b[i] = (T)(gen() % m);
+    }
+    for (uint64_t &e : exps) e = gen() | ((uint64_t)1 << 63);
+
+    const int method_count = 4;
+    result_t results[method_count][3];
+    bool has_method[method_count] = {true, sizeof(T) == 8, true, (m & 1) != 0};
+    benchmark_method<T, SYSTEM>(a, b, exps, m, iters, results[SYSTEM]);
+    if (has_method[DIV_128_64]) {
+        benchmark_method<T, DIV_128_64>(a, b, exps, m, iters, results[DIV_128_64]);
+    }
+    benchmark_method<T, MULMOD>(a, b, exps, m, iters, results[MULMOD]);
+    if (has_method[MONTGOMERY]) {
+        benchmark_method<T, MONTGOMERY>(a, b, exps, m, iters, results[MONTGOMERY]);
+    }
+
+    const char *const modes[] = {"products", "chain", "powmod"};
+    for (int mode = 0; mode < 3; mode++) {
+        std::cout << std::setw(21) << (uint64_t)m << std::setw(10) << modes[mode];
+        for (int method = 0; method < method_count; method++) {
+            if (!has_method[method]) {
+                std::cout << std::setw(12) << "-";
+                continue;
+            }
+            if (results[method][mode].sum != results[SYSTEM][mode].sum) {
+                std::cerr << "Error: " << type_tag<T>::get_tag() << " modulus " << (uint64_t)m
+                          << " " << modes[mode] << ": system sum " << results[SYSTEM][mode].sum
+                          << ", " << method_names[method] << " sum "
+                          << results[method][mode].sum << std::endl;
+                std::exit(1);
+            }
+            std::cout << std::fixed << std::setprecision(3) << std::setw(12)
+                      << results[method][mode].duration;
+        }
+        std::cout << std::endl;
+    }
+}
+
+template <typename T>
+void benchmark(const T *moduli, size_t count, size_t iters) {
+    std::cout << "----- " << type_tag<T>::get_tag() << " -----" << std::endl;
+    std::cout << std::setw(21) << "modulus" << std::setw(10) << "mode";
+    for (const char *name : method_names) std::cout << std::setw(12) << name;
+    std::cout << std::endl;
+    for (size_t i = 0; i < count; i++) {
+        benchmark_modulus(moduli[i], iters);
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+    bool test_u32 = argc <= 1, test_u64 = argc <= 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == type_tag<uint32_t>::get_tag()) {
+            test_u32 = true;
+        } else if (arg == type_tag<uint64_t>::get_tag()) {
+            test_u64 = true;
+        } else {
+            std::cout << "Usage: benchmark_mulmod [u32] [u64]\n"
+                         "\n"
+                         "Computes modular products and powers using hardware division,\n"
+                         "libdivide_128_div_64_to_64(), libdivide::mod_reducer::mulmod() and\n"
+                         "Montgomery multiplication. Without options u32 and u64 are tested."
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    size_t iters = 20;
+
+    // Primes and an even modulus, which has no Montgomery form
+    const uint32_t moduli32[] = {1000000007u, 4294967291u, 1000000000u};
+    const uint64_t moduli64[] = {
+        UINT64_C(1000000007), UINT64_C(4611686018427387847), UINT64_C(18446744073709551557),
+        UINT64_C(1000000000000000000)};
+    if (test_u32) benchmark(moduli32, sizeof(moduli32) / sizeof(moduli32[0]), iters);
+    if (test_u64) benchmark(moduli64, sizeof(moduli64) / sizeof(moduli64[0]), iters);
+    return 0;
+}
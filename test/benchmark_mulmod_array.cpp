@@ -0,0 +1,247 @@
+// Usage: benchmark_mulmod_array [u32] [u64]
+//
+// Benchmarks the modular arithmetic array functions of
+// libdivide::mod_reducer (mulmod, addmod and powmod of whole arrays) by a
+// runtime modulus m. They are compared against loops using hardware
+// division (%) and loops calling the scalar mod_reducer functions. For odd
+// moduli the array functions use the SIMD kernels of the instruction set
+// libdivide was compiled for. All times are ns/element, powmod times are
+// ns/element/exponent bit.
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "libdivide.h"
+#include "type_mappings.h"
+
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((__noinline__))
+#elif defined(_MSC_VER)
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE
+#endif
+
+enum method_t { SYSTEM, SCALAR, ARRAY };
+
+static const char *const method_names[] = {"system", "scalar", "array"};
+
+enum op_t { MULMOD, ADDMOD, POWMOD };
+
+static const char *const op_names[] = {"mulmod", "addmod", "powmod"};
+
+// The exponent of powmod, 32 bits
+static const uint64_t exponent = UINT64_C(0xfedcba98);
+
+static uint32_t system_mulmod(uint32_t a, uint32_t b, uint32_t m) {
+    return (uint32_t)((uint64_t)a * b % m);
+}
+
+static uint64_t system_mulmod(uint64_t a, uint64_t b, uint64_t m) {
+#if defined(HAS_INT128_T) && defined(HAS_INT128_DIV)
+    return (uint64_t)((__uint128_t)a * b % m);
+#else
+    uint64_t rem;
+    libdivide::libdivide_128_div_64_to_64(libdivide::libdivide_mullhi_u64(a, b), a * b, m, &rem);
+    return rem;
+#endif
+}
+
+static uint32_t system_addmod(uint32_t a, uint32_t b, uint32_t m) {
+    return (uint32_t)(((uint64_t)a + b) % m);
+}
+
+static uint64_t system_addmod(uint64_t a, uint64_t b, uint64_t m) {
+#if defined(HAS_INT128_T) && defined(HAS_INT128_DIV)
+    return (uint64_t)(((__uint128_t)a + b) % m);
+#else
+    uint64_t rem;
+    libdivide::libdivide_128_div_64_to_64(a + b < a, a + b, m, &rem);
+    return rem;
+#endif
+}
+
+template <typename T>
+static T system_powmod(T a, T m) {
+    T result = (T)(1 % m);
+    for (uint64_t e = exponent; e != 0; e >>= 1) {
+        if (e & 1) result = system_mulmod(result, a, m);
+        a = system_mulmod(a, a, m);
+    }
+    return result;
+}
+
+template <typename T>
+NOINLINE void system_ops(
+    op_t op, const std::vector<T> &a, const std::vector<T> &b, T m, std::vector<T> &out) {
+    for (size_t i = 0; i < a.size(); i++) {
+        switch (op) {
+            case MULMOD:
+                out[i] = system_mulmod(a[i], b[i], m);
+                break;
+            case ADDMOD:
+                out[i] = system_addmod(a[i], b[i], m);
+                break;
+            default:
+                out[i] = system_powmod(a[i], m);
+        }
+    }
+}
+
+template <typename T>
+NOINLINE void scalar_ops(op_t op, const std::vector<T> &a, const std::vector<T> &b,
+    const libdivide::mod_reducer<T> &reducer, std::vector<T> &out) {
+    for (size_t i = 0; i < a.size(); i++) {
+        switch (op) {
+            case MULMOD:
+                out[i] = reducer.mulmod(a[i], b[i]);
+                break;
+            case ADDMOD:
+                out[i] = reducer.addmod(a[i], b[i]);
+                break;
+            default:
+                out[i] = reducer.powmod(a[i], exponent);
+        }
+    }
+}
+
+template <typename T>
+NOINLINE void array_ops(op_t op, const std::vector<T> &a, const std::vector<T> &b,
+    const libdivide::mod_reducer<T> &reducer, std::vector<T> &out) {
+    switch (op) {
+        case MULMOD:
+            reducer.mulmod(a.data(), b.data(), out.data(), a.size());
+            break;
+        case ADDMOD:
+            reducer.addmod(a.data(), b.data(), out.data(), a.size());
+            break;
+        default:
+            reducer.powmod(a.data(), out.data(), a.size(), exponent);
+    }
+}
+
+struct result_t {
+    double duration;
+    uint64_t sum;
+};
+
+template <typename T>
+static uint64_t sum_results(const std::vector<T> &out) {
+    uint64_t sum = 0;
+    for (T x : out) sum += (uint64_t)x;
+    return sum;
+}
+
+template <typename F>
+result_t time_it(size_t iters, F f) {
+    auto t1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iters; i++) f();
+    auto t2 = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::nano> nanos = t2 - t1;
+    return result_t{nanos.count(), 0};
+}
+
+template <typename T>
+result_t benchmark_op(method_t method, op_t op, const std::vector<T> &a, const std::vector<T> &b,
+    T m, size_t iters) {
+    libdivide::mod_reducer<T> reducer(m);
+    std::vector<T> out(a.size());
+    result_t result = time_it(iters, [&]() {
+        switch (method) {
+            case SYSTEM:
+                system_ops(op, a, b, m, out);
+                break;
+            case SCALAR:
+                scalar_ops(op, a, b, reducer, out);
+                break;
+            default:
+                array_ops(op, a, b, reducer, out);
+        }
+    });
+    result.sum = sum_results(out);
+    result.duration /= (double)iters * a.size();
+    if (op == POWMOD) result.duration /= 32;
+    return result;
+}
+
+template <typename T>
+void benchmark_modulus(T m, size_t iters) {
+    std::mt19937_64 gen(42);
+    std::vector<T> a(1 << 12), b(a.size());
+    for (size_t i = 0; i < a.size(); i++) {
+        a[i] = (T)(gen() % m);
+        b[i] = (T)(gen() % m);
+    }
+
+    for (int op = MULMOD; op <= POWMOD; op++) {
+        // powmod is slow using hardware division, use fewer elements
+        std::vector<T> a_op(a), b_op(b);
+        if (op == POWMOD) {
+            a_op.resize(a.size() / 16);
+            b_op.resize(a.size() / 16);
+        }
+        std::cout << std::setw(21) << (uint64_t)m << std::setw(10) << op_names[op];
+        result_t system = benchmark_op(SYSTEM, (op_t)op, a_op, b_op, m, iters);
+        for (int method = SYSTEM; method <= ARRAY; method++) {
+            result_t result = method == SYSTEM
+                                  ? system
+                                  : benchmark_op((method_t)method, (op_t)op, a_op, b_op, m, iters);
+            if (result.sum != system.sum) {
+                std::cerr << "Error: " << type_tag<T>::get_tag() << " modulus " << (uint64_t)m
+                          << " " << op_names[op] << ": system sum " << system.sum << ", "
+                          << method_names[method] << " sum " << result.sum << std::endl;
+                std::exit(1);
+            }
+            std::cout << std::fixed << std::setprecision(3) << std::setw(12) << result.duration;
+        }
+        std::cout << std::endl;
+    }
+}
+
+template <typename T>
+void benchmark(const T *moduli, size_t count, size_t iters) {
+    std::cout << "----- " << type_tag<T>::get_tag() << " -----" << std::endl;
+    std::cout << std::setw(21) << "modulus" << std::setw(10) << "op";
+    for (const char *name : method_names) std::cout << std::setw(12) << name;
+    std::cout << std::endl;
+    for (size_t i = 0; i < count; i++) {
+        benchmark_modulus(moduli[i], iters);
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+    bool test_u32 = argc <= 1, test_u64 = argc <= 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == type_tag<uint32_t>::get_tag()) {
+            test_u32 = true;
+        } else if (arg == type_tag<uint64_t>::get_tag()) {
+            test_u64 = true;
+        } else {
+            std::cout << "Usage: benchmark_mulmod_array [u32] [u64]\n"
+                         "\n"
+                         "Computes modular products, sums and powers of arrays using hardware\n"
+                         "division, the scalar libdivide::mod_reducer functions and the\n"
+                         "mod_reducer array functions. Without options u32 and u64 are tested."
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    size_t iters = 20;
+
+    // Primes and an even modulus, which uses the scalar array kernels
+    const uint32_t moduli32[] = {1000000007u, 4294967291u, 1000000000u};
+    const uint64_t moduli64[] = {
+        UINT64_C(1000000007), UINT64_C(18446744073709551557), UINT64_C(1000000000000000000)};
+    if (test_u32) benchmark(moduli32, sizeof(moduli32) / sizeof(moduli32[0]), iters);
+    if (test_u64) benchmark(moduli64, sizeof(moduli64) / sizeof(moduli64[0]), iters);
+    return 0;
+}
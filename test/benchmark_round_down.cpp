@@ -0,0 +1,251 @@
+// Usage: benchmark_round_down [u16] [u32] [u64]
+//
+// Benchmarks the two sequences for unsigned divisors that need the add
+// marker: the add marker sequence t = ((n - q) >> 1) + q, q = t >> shift and
+// the "round down" sequence q = (n + 1) * m_down >> shift, see
+// doc/divide_by_constants_codegen_reference.c. "system" uses hardware
+// division, "add" and "round_down" are scalar loops of the two sequences and
+// "scalar" calls divider::divide() for every element. "branchfree_array"
+// runs the add marker sequence in the SIMD kernels of the instruction set
+// libdivide was compiled for (branchfree dividers always use it) and "array"
+// runs the default kernels of the branchfull dividers. On x86 libdivide uses
+// the sequence that was faster for each type and instruction set, the NEON
+// and SVE kernels use the add marker sequence. All times are ns/element.
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "libdivide.h"
+#include "type_mappings.h"
+
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((__noinline__))
+#elif defined(_MSC_VER)
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE
+#endif
+
+enum method_t { SYSTEM, ADD, ROUND_DOWN, SCALAR, BRANCHFREE_ARRAY, ARRAY };
+
+static const char *const method_names[] = {
+    "system", "add", "round_down", "scalar", "branchfree_array", "array"};
+
+static libdivide::libdivide_u16_t branchfull_gen(uint16_t d) {
+    return libdivide::libdivide_u16_gen(d);
+}
+
+static libdivide::libdivide_u32_t branchfull_gen(uint32_t d) {
+    return libdivide::libdivide_u32_gen(d);
+}
+
+static libdivide::libdivide_u64_t branchfull_gen(uint64_t d) {
+    return libdivide::libdivide_u64_gen(d);
+}
+
+// The add marker sequence and the round down sequence of the scalar
+// libdivide_uXX_do_raw() functions
+static uint16_t add_divide(uint16_t n, uint16_t magic, uint8_t shift) {
+    uint16_t q = libdivide::libdivide_mullhi_u16(n, magic);
+    return (uint16_t)(((uint16_t)((n - q) >> 1) + q) >> shift);
+}
+
+static uint16_t round_down_divide(uint16_t n, uint16_t magic, uint8_t shift) {
+    uint32_t m_down = libdivide::libdivide_u16_round_down_magic(magic);
+    return (uint16_t)(((uint32_t)n * m_down + m_down) >> (16 + shift));
+}
+
+static uint32_t add_divide(uint32_t n, uint32_t magic, uint8_t shift) {
+    uint32_t q = libdivide::libdivide_mullhi_u32(n, magic);
+    return (((n - q) >> 1) + q) >> shift;
+}
+
+static uint32_t round_down_divide(uint32_t n, uint32_t magic, uint8_t shift) {
+    uint64_t m_down = libdivide::libdivide_u32_round_down_magic(magic);
+    return (uint32_t)((n * m_down + m_down) >> (32 + shift));
+}
+
+static uint64_t add_divide(uint64_t n, uint64_t magic, uint8_t shift) {
+    uint64_t q = libdivide::libdivide_mullhi_u64(n, magic);
+    return (((n - q) >> 1) + q) >> shift;
+}
+
+static uint64_t round_down_divide(uint64_t n, uint64_t magic, uint8_t shift) {
+    // (n + 1) * m_down >> 64, the increment saturates because n = 2^64 - 1
+    // is never a multiple of these divisors
+    uint64_t m_down = libdivide::libdivide_u64_round_down_magic(magic);
+    return libdivide::libdivide_mullhi_u64(n + (n != UINT64_MAX), m_down) >> shift;
+}
+
+template <typename T>
+NOINLINE void system_loop(const std::vector<T> &numers, T d, std::vector<T> &quots) {
+    for (size_t i = 0; i < numers.size(); i++) {
+        quots[i] = numers[i] / d;
+    }
+}
+
+template <typename T>
+NOINLINE void add_loop(
+    const std::vector<T> &numers, T magic, uint8_t shift, std::vector<T> &quots) {
+    for (size_t i = 0; i < numers.size(); i++) {
+        quots[i] = add_divide(numers[i], magic, shift);
+    }
+}
+
+template <typename T>
+NOINLINE void round_down_loop(
+    const std::vector<T> &numers, T magic, uint8_t shift, std::vector<T> &quots) {
+    for (size_t i = 0; i < numers.size(); i++) {
+        quots[i] = round_down_divide(numers[i], magic, shift);
+    }
+}
+
+template <typename T>
+NOINLINE void scalar_loop(
+    const std::vector<T> &numers, const libdivide::divider<T> &div, std::vector<T> &quots) {
+    for (size_t i = 0; i < numers.size(); i++) {
+        quots[i] = div.divide(numers[i]);
+    }
+}
+
+template <typename T, libdivide::Branching ALGO>
+NOINLINE void array_loop(const std::vector<T> &numers, const libdivide::divider<T, ALGO> &div,
+    std::vector<T> &quots) {
+    div.divide(numers.data(), quots.data(), numers.size());
+}
+
+struct result_t {
+    double duration;
+    uint64_t sum;
+};
+
+template <typename T>
+static uint64_t sum_results(const std::vector<T> &quots) {
+    uint64_t sum = 0;
+    for (T q : quots) sum += (uint64_t)q;
+    return sum;
+}
+
+template <typename F>
+result_t time_it(size_t iters, F f) {
+    auto t1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iters; i++) f();
+    auto t2 = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::nano> nanos = t2 - t1;
+    return result_t{nanos.count(), 0};
+}
+
+template <typename T>
+result_t benchmark_method(method_t method, const std::vector<T> &numers, T d, size_t iters) {
+    const libdivide::divider<T> div(d);
+    const libdivide::divider<T, libdivide::BRANCHFREE> branchfree(d);
+    T magic = branchfull_gen(d).magic;
+    uint8_t shift = branchfull_gen(d).more & (uint8_t)(sizeof(T) * 8 - 1);
+    std::vector<T> quots(numers.size());
+    result_t result = time_it(iters, [&]() {
+        switch (method) {
+            case SYSTEM:
+                system_loop(numers, d, quots);
+                break;
+            case ADD:
+                add_loop(numers, magic, shift, quots);
+                break;
+            case ROUND_DOWN:
+                round_down_loop(numers, magic, shift, quots);
+                break;
+            case SCALAR:
+                scalar_loop(numers, div, quots);
+                break;
+            case BRANCHFREE_ARRAY:
+                array_loop(numers, branchfree, quots);
+                break;
+            default:
+                array_loop(numers, div, quots);
+        }
+    });
+    result.sum = sum_results(quots);
+    result.duration /= (double)iters * numers.size();
+    return result;
+}
+
+template <typename T>
+void benchmark_divisor(T d, size_t iters) {
+    if (!(branchfull_gen(d).more & libdivide::LIBDIVIDE_ADD_MARKER)) {
+        std::cerr << "Error: " << type_tag<T>::get_tag() << " " << (uint64_t)d
+                  << " does not need the add marker" << std::endl;
+        std::exit(1);
+    }
+
+    // Random numerators, the maximum is included because the round down
+    // sequence increments it
+    std::mt19937_64 gen(42);
+    std::vector<T> numers(1 << 12);
+    for (T &numer : numers) numer = (T)gen();
+    numers[0] = (T)-1;
+
+    std::cout << std::setw(21) << (uint64_t)d;
+    result_t system = benchmark_method(SYSTEM, numers, d, iters);
+    for (int method = SYSTEM; method <= ARRAY; method++) {
+        result_t result =
+            method == SYSTEM ? system : benchmark_method((method_t)method, numers, d, iters);
+        if (result.sum != system.sum) {
+            std::cerr << "Error: " << type_tag<T>::get_tag() << " " << (uint64_t)d
+                      << ": system sum " << system.sum << ", " << method_names[method] << " sum "
+                      << result.sum << std::endl;
+            std::exit(1);
+        }
+        std::cout << std::fixed << std::setprecision(3) << std::setw(18) << result.duration;
+    }
+    std::cout << std::endl;
+}
+
+template <typename T>
+void benchmark(const T *divisors, size_t count, size_t iters) {
+    std::cout << "----- " << type_tag<T>::get_tag() << " -----" << std::endl;
+    std::cout << std::setw(21) << "divisor";
+    for (const char *name : method_names) std::cout << std::setw(18) << name;
+    std::cout << std::endl;
+    for (size_t i = 0; i < count; i++) {
+        benchmark_divisor(divisors[i], iters);
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+    bool test_u16 = argc <= 1, test_u32 = argc <= 1, test_u64 = argc <= 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == type_tag<uint16_t>::get_tag()) {
+            test_u16 = true;
+        } else if (arg == type_tag<uint32_t>::get_tag()) {
+            test_u32 = true;
+        } else if (arg == type_tag<uint64_t>::get_tag()) {
+            test_u64 = true;
+        } else {
+            std::cout << "Usage: benchmark_round_down [u16] [u32] [u64]\n"
+                         "\n"
+                         "Divides arrays by divisors that need the add marker using hardware\n"
+                         "division, the add marker sequence and the round down sequence.\n"
+                         "Without options u16, u32 and u64 are tested."
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    size_t iters = 50;
+
+    // All of these need the add marker
+    const uint16_t divisors16[] = {7, 641, 1000};
+    const uint32_t divisors32[] = {7, 641, UINT32_C(1000000007)};
+    const uint64_t divisors64[] = {7, 10007, UINT64_C(3000000019)};
+    if (test_u16) benchmark(divisors16, sizeof(divisors16) / sizeof(divisors16[0]), iters);
+    if (test_u32) benchmark(divisors32, sizeof(divisors32) / sizeof(divisors32[0]), iters);
+    if (test_u64) benchmark(divisors64, sizeof(divisors64) / sizeof(divisors64[0]), iters);
+    return 0;
+}
@@ -0,0 +1,199 @@
+// Usage: benchmark_runs [u16] [s16] [u32] [s32] [u64] [s64]
+//
+// Benchmarks the division of an array of random numerators by run-length
+// encoded divisors, as e.g. per partition scale factors of a column. For
+// several distributions of the run lengths the quotients are computed
+// using hardware division, a libdivide::divider generated per run followed
+// by a scalar loop (libdivide_*_do), and libdivide::divide_runs(). All
+// times are ns/element.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "libdivide.h"
+#include "type_mappings.h"
+
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((__noinline__))
+#elif defined(_MSC_VER)
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE
+#endif
+
+template <typename T>
+struct runs_t {
+    std::vector<uint32_t> lengths;
+    std::vector<T> denoms;
+};
+
+struct result_t {
+    double duration;
+    uint64_t sum;
+};
+
+template <typename T>
+static uint64_t sum_quotients(const std::vector<T> &quots) {
+    uint64_t sum = 0;
+    for (T q : quots) sum += (uint64_t)q;
+    return sum;
+}
+
+template <typename T>
+NOINLINE uint64_t divide_system(const std::vector<T> &numers, const runs_t<T> &runs,
+    std::vector<T> &quots) {
+    size_t i = 0;
+    for (size_t r = 0; r < runs.lengths.size(); r++) {
+        T d = runs.denoms[r];
+        for (size_t end = i + runs.lengths[r]; i < end; i++) {
+            quots[i] = (T)(numers[i] / d);
+        }
+    }
+    return sum_quotients(quots);
+}
+
+template <typename T>
+NOINLINE uint64_t divide_scalar(const std::vector<T> &numers, const runs_t<T> &runs,
+    std::vector<T> &quots) {
+    size_t i = 0;
+    for (size_t r = 0; r < runs.lengths.size(); r++) {
+        libdivide::divider<T> div(runs.denoms[r]);
+        for (size_t end = i + runs.lengths[r]; i < end; i++) {
+            quots[i] = numers[i] / div;
+        }
+    }
+    return sum_quotients(quots);
+}
+
+template <typename T>
+NOINLINE uint64_t divide_runs(const std::vector<T> &numers, const runs_t<T> &runs,
+    std::vector<T> &quots) {
+    libdivide::divide_runs(numers.data(), quots.data(), runs.lengths.data(),
+        runs.denoms.data(), runs.lengths.size());
+    return sum_quotients(quots);
+}
+
+// Splits count elements into runs whose lengths are drawn by next_length,
+// each run has a random divisor. 0 and -1 are skipped, as INT_MIN / -1 is
+// undefined behavior for the hardware division.
+template <typename T, typename F>
+runs_t<T> make_runs(size_t count, std::mt19937 &gen, F next_length) {
+    std::uniform_int_distribution<int64_t> dist(
+        (std::numeric_limits<T>::min)(), (std::numeric_limits<T>::max)());
+    runs_t<T> runs;
+    for (size_t i = 0; i < count;) {
+        uint32_t length = (uint32_t)(std::min)((size_t)next_length(), count - i);
+        T d;
+        do {
+            d = (T)(dist(gen) >> (gen() % (sizeof(T) * 8)));
+        } while (d == 0 || d == (T)-1);
+        runs.lengths.push_back(length);
+        runs.denoms.push_back(d);
+        i += length;
+    }
+    return runs;
+}
+
+template <typename F>
+result_t time_it(size_t iters, F f) {
+    auto t1 = std::chrono::steady_clock::now();
+    uint64_t sum = 0;
+    for (size_t i = 0; i < iters; i++) sum += f();
+    auto t2 = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::nano> nanos = t2 - t1;
+    return result_t{nanos.count(), sum};
+}
+
+template <typename T>
+void benchmark_runs(const char *name, const std::vector<T> &numers, const runs_t<T> &runs,
+    size_t iters) {
+    std::vector<T> quots(numers.size());
+    result_t sys = time_it(iters, [&] { return divide_system(numers, runs, quots); });
+    result_t scalar = time_it(iters, [&] { return divide_scalar(numers, runs, quots); });
+    result_t bulk = time_it(iters, [&] { return divide_runs(numers, runs, quots); });
+    if (scalar.sum != sys.sum || bulk.sum != sys.sum) {
+        std::cerr << "Error: " << type_tag<T>::get_tag() << " runs " << name
+                  << ": system sum " << sys.sum << ", divider sum " << scalar.sum
+                  << ", divide_runs sum " << bulk.sum << std::endl;
+        std::exit(1);
+    }
+    const double elements = (double)iters * numers.size();
+    std::cout << std::setw(12) << name << std::fixed << std::setprecision(3) << std::setw(10)
+              << sys.duration / elements << std::setw(10) << scalar.duration / elements
+              << std::setw(12) << bulk.duration / elements << std::endl;
+}
+
+template <typename T>
+void benchmark(size_t iters) {
+    std::cout << "----- " << type_tag<T>::get_tag() << " -----" << std::endl;
+    std::cout << std::setw(12) << "runs" << std::setw(10) << "system" << std::setw(10)
+              << "scalar" << std::setw(12) << "divide_runs" << std::endl;
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int64_t> dist(
+        (std::numeric_limits<T>::min)(), (std::numeric_limits<T>::max)());
+    std::vector<T> numers(1 << 14);
+    for (auto &n : numers) n = (T)dist(gen);
+
+    const uint32_t fixed[] = {1, 2, 3, 4, 8, 16, 64, 1024};
+    for (uint32_t length : fixed) {
+        std::string name = "fixed " + std::to_string(length);
+        benchmark_runs(name.c_str(), numers,
+            make_runs<T>(numers.size(), gen, [&] { return length; }), iters);
+    }
+    std::uniform_int_distribution<uint32_t> uniform(1, 16);
+    benchmark_runs(
+        "uniform 16", numers, make_runs<T>(numers.size(), gen, [&] { return uniform(gen); }),
+        iters);
+    // Mostly short runs with a few long ones
+    std::geometric_distribution<uint32_t> geometric(1.0 / 32);
+    benchmark_runs("geometric 32", numers,
+        make_runs<T>(numers.size(), gen, [&] { return geometric(gen) + 1; }), iters);
+    std::cout << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+    bool test_u16 = false, test_s16 = false, test_u32 = argc <= 1, test_s32 = false,
+         test_u64 = argc <= 1, test_s64 = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == type_tag<uint16_t>::get_tag()) {
+            test_u16 = true;
+        } else if (arg == type_tag<int16_t>::get_tag()) {
+            test_s16 = true;
+        } else if (arg == type_tag<uint32_t>::get_tag()) {
+            test_u32 = true;
+        } else if (arg == type_tag<int32_t>::get_tag()) {
+            test_s32 = true;
+        } else if (arg == type_tag<uint64_t>::get_tag()) {
+            test_u64 = true;
+        } else if (arg == type_tag<int64_t>::get_tag()) {
+            test_s64 = true;
+        } else {
+            std::cout << "Usage: benchmark_runs [u16] [s16] [u32] [s32] [u64] [s64]\n"
+                         "\n"
+                         "Divides random numerators by run-length encoded divisors using\n"
+                         "hardware division, a libdivide::divider per run and\n"
+                         "libdivide::divide_runs(). Without options u32 and u64 are tested."
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    size_t iters = 40;
+
+    if (test_u16) benchmark<uint16_t>(iters);
+    if (test_s16) benchmark<int16_t>(iters);
+    if (test_u32) benchmark<uint32_t>(iters);
+    if (test_s32) benchmark<int32_t>(iters);
+    if (test_u64) benchmark<uint64_t>(iters);
+    if (test_s64) benchmark<int64_t>(iters);
+    return 0;
+}
@@ -0,0 +1,201 @@
+// Usage: benchmark_scale [u32] [u64]
+//
+// Benchmarks the rational scaling of whole arrays x[i] * num / den by
+// libdivide::rational_scaler, e.g. sample rate and timestamp conversions.
+// "system" computes the double width products and divides them using
+// hardware division (unsigned __int128 for u64), "scalar" calls
+// rational_scaler::scale() for every element and "array" uses the SIMD
+// kernels of the instruction set libdivide was compiled for. The rounding
+// modes are floor, round to nearest and floor with saturation. All times
+// are ns/element.
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "libdivide.h"
+#include "type_mappings.h"
+
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((__noinline__))
+#elif defined(_MSC_VER)
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE
+#endif
+
+enum method_t { SYSTEM, SCALAR, ARRAY };
+
+static const char *const method_names[] = {"system", "scalar", "array"};
+
+enum scale_mode_t { FLOOR, NEAREST, SATURATE };
+
+static const char *const mode_names[] = {"floor", "nearest", "saturate"};
+
+// (x * num + bias) / den, saturated to UINT32_MAX if saturate is true
+static uint32_t system_scale(uint32_t x, uint32_t num, uint32_t den, uint32_t bias, bool saturate) {
+    uint64_t q = ((uint64_t)x * num + bias) / den;
+    return (saturate && q > UINT32_MAX) ? UINT32_MAX : (uint32_t)q;
+}
+
+static uint64_t system_scale(uint64_t x, uint64_t num, uint64_t den, uint64_t bias, bool saturate) {
+#if defined(HAS_INT128_T) && defined(HAS_INT128_DIV)
+    __uint128_t q = ((__uint128_t)x * num + bias) / den;
+    return (saturate && (q >> 64) != 0) ? UINT64_MAX : (uint64_t)q;
+#else
+    uint64_t lo = x * num, hi = libdivide::libdivide_mullhi_u64(x, num), rem;
+    lo += bias;
+    hi += lo < bias;
+    uint64_t q_hi = hi / den;
+    uint64_t q = libdivide::libdivide_128_div_64_to_64(hi % den, lo, den, &rem);
+    return (saturate && q_hi != 0) ? UINT64_MAX : q;
+#endif
+}
+
+template <typename T>
+NOINLINE void system_loop(
+    const std::vector<T> &x, T num, T den, scale_mode_t mode, std::vector<T> &out) {
+    T bias = mode == NEAREST ? (T)(den / 2) : 0;
+    bool saturate = mode == SATURATE;
+    for (size_t i = 0; i < x.size(); i++) {
+        out[i] = system_scale(x[i], num, den, bias, saturate);
+    }
+}
+
+template <typename T>
+NOINLINE void scalar_loop(
+    const std::vector<T> &x, const libdivide::rational_scaler<T> &scaler, std::vector<T> &out) {
+    for (size_t i = 0; i < x.size(); i++) {
+        out[i] = scaler.scale(x[i]);
+    }
+}
+
+template <typename T>
+NOINLINE void array_loop(
+    const std::vector<T> &x, const libdivide::rational_scaler<T> &scaler, std::vector<T> &out) {
+    scaler.scale(x.data(), out.data(), x.size());
+}
+
+struct result_t {
+    double duration;
+    uint64_t sum;
+};
+
+template <typename T>
+static uint64_t sum_results(const std::vector<T> &out) {
+    uint64_t sum = 0;
+    for (T x : out) sum += (uint64_t)x;
+    return sum;
+}
+
+template <typename F>
+result_t time_it(size_t iters, F f) {
+    auto t1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iters; i++) f();
+    auto t2 = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::nano> nanos = t2 - t1;
+    return result_t{nanos.count(), 0};
+}
+
+template <typename T>
+result_t benchmark_method(
+    method_t method, scale_mode_t mode, const std::vector<T> &x, T num, T den, size_t iters) {
+    libdivide::rational_scaler<T> scaler(num, den,
+        mode == NEAREST ? libdivide::ROUND_NEAREST : libdivide::ROUND_FLOOR, mode == SATURATE);
+    std::vector<T> out(x.size());
+    result_t result = time_it(iters, [&]() {
+        switch (method) {
+            case SYSTEM:
+                system_loop(x, num, den, mode, out);
+                break;
+            case SCALAR:
+                scalar_loop(x, scaler, out);
+                break;
+            default:
+                array_loop(x, scaler, out);
+        }
+    });
+    result.sum = sum_results(out);
+    result.duration /= (double)iters * x.size();
+    return result;
+}
+
+template <typename T>
+void benchmark_fraction(T num, T den, size_t iters) {
+    std::mt19937_64 gen(42);
+    std::vector<T> x(1 << 12);
+    // Mostly quotients that fit, every eighth x uses all bits and may
+    // saturate
+    const int bits = (int)sizeof(T) * 8;
+    for (size_t i = 0; i < x.size(); i++) {
+        x[i] = (T)(gen() >> (i % 8 == 0 ? 64 - bits : 80 - bits));
+    }
+
+    for (int mode = FLOOR; mode <= SATURATE; mode++) {
+        std::cout << std::setw(21) << (uint64_t)num << std::setw(12) << (uint64_t)den
+                  << std::setw(10) << mode_names[mode];
+        result_t system = benchmark_method(SYSTEM, (scale_mode_t)mode, x, num, den, iters);
+        for (int method = SYSTEM; method <= ARRAY; method++) {
+            result_t result = method == SYSTEM ? system
+                                               : benchmark_method((method_t)method,
+                                                     (scale_mode_t)mode, x, num, den, iters);
+            if (result.sum != system.sum) {
+                std::cerr << "Error: " << type_tag<T>::get_tag() << " " << (uint64_t)num << " / "
+                          << (uint64_t)den << " " << mode_names[mode] << ": system sum "
+                          << system.sum << ", " << method_names[method] << " sum " << result.sum
+                          << std::endl;
+                std::exit(1);
+            }
+            std::cout << std::fixed << std::setprecision(3) << std::setw(12) << result.duration;
+        }
+        std::cout << std::endl;
+    }
+}
+
+template <typename T>
+void benchmark(const T (*fractions)[2], size_t count, size_t iters) {
+    std::cout << "----- " << type_tag<T>::get_tag() << " -----" << std::endl;
+    std::cout << std::setw(21) << "num" << std::setw(12) << "den" << std::setw(10) << "mode";
+    for (const char *name : method_names) std::cout << std::setw(12) << name;
+    std::cout << std::endl;
+    for (size_t i = 0; i < count; i++) {
+        benchmark_fraction(fractions[i][0], fractions[i][1], iters);
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+    bool test_u32 = argc <= 1, test_u64 = argc <= 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == type_tag<uint32_t>::get_tag()) {
+            test_u32 = true;
+        } else if (arg == type_tag<uint64_t>::get_tag()) {
+            test_u64 = true;
+        } else {
+            std::cout << "Usage: benchmark_scale [u32] [u64]\n"
+                         "\n"
+                         "Computes x * num / den of arrays using hardware division, the scalar\n"
+                         "libdivide::rational_scaler::scale() and the rational_scaler array\n"
+                         "function. Without options u32 and u64 are tested."
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    size_t iters = 50;
+
+    // Sample rates and clock rates: 44.1 kHz to 48 kHz and back, MPEG 90 kHz
+    // ticks to nanoseconds and back
+    const uint32_t fractions32[][2] = {{48000, 44100}, {44100, 48000}, {1000, 1024}};
+    const uint64_t fractions64[][2] = {
+        {48000, 44100}, {UINT64_C(1000000000), 90000}, {90000, UINT64_C(1000000000)}};
+    if (test_u32) benchmark(fractions32, sizeof(fractions32) / sizeof(fractions32[0]), iters);
+    if (test_u64) benchmark(fractions64, sizeof(fractions64) / sizeof(fractions64[0]), iters);
+    return 0;
+}
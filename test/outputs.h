@@ -128,6 +128,30 @@ static inline char *to_str(char *buffer, int16_t n) {
     return buffer;
 }
 
+// iostreams print 8-bit integers as characters.
+static inline std::ostream &operator<<(std::ostream &os, uint8_t n) { return os << (unsigned)n; }
+static inline std::ostream &operator<<(std::ostream &os, int8_t n) { return os << (int)n; }
+
+#if defined(__SIZEOF_INT128__)
+// iostreams cannot print 128-bit integers.
+static inline std::ostream &operator<<(std::ostream &os, __uint128_t n) {
+    char buffer[40];
+    char *p = buffer + sizeof(buffer);
+    *--p = 0;
+    do {
+        *--p = (char)('0' + (int)(n % 10));
+        n /= 10;
+    } while (n);
+    return os << p;
+}
+static inline std::ostream &operator<<(std::ostream &os, __int128_t n) {
+    if (n < 0) {
+        return os << '-' << (__uint128_t)0 - (__uint128_t)n;
+    }
+    return os << (__uint128_t)n;
+}
+#endif
+
 #endif
 
 #if defined(PRINT_DETAIL_PROGRESS)
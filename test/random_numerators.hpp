@@ -65,6 +65,23 @@ private:
         }
     }
 
+    // Replaces the numerators by multiples of d, the quotients are in the
+    // range [-max / |d|, max / |d|] so that the multiples do not overflow.
+    void multiply_buffer(T d) {
+        typedef typename std::make_unsigned<T>::type U;
+        T *pData = (T *)_pData;
+        const U abs_d = (d < 0) ? (U)(0 - (U)d) : (U)d;
+        const U max_quot = (U)(std::numeric_limits<T>::max)() / abs_d;
+        for (size_t i = 0; i < length(); i++) {
+            U quot = (U)pData[i];
+            if (max_quot != (U)-1) {
+                quot = (U)(quot % (U)(max_quot + 1));
+            }
+            U multiple = (U)(quot * (U)d);
+            pData[i] = (pData[i] < 0) ? (T)(0 - multiple) : (T)multiple;
+        }
+    }
+
 public:
 
     using const_pointer   = const T *;
@@ -91,6 +108,12 @@ public:
         randomize_buffer();
     }
 
+    // Same as above with numerators that are multiples of d, for exact
+    // division.
+    explicit random_numerators(T multiple_of) : random_numerators() {
+        multiply_buffer(multiple_of);
+    }
+
     ~random_numerators() {
         deallocate(_pData);
     }
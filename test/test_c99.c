@@ -49,11 +49,163 @@
       } \
    }
 
+#define ARRAY_COUNT 1027
+/* Divides a misaligned array of odd length using the do_array and divmod_array API */
+#define TEST_ARRAY(type, ALGO, denom, format_spec) \
+   { \
+      type numers[ARRAY_COUNT + 1]; \
+      type quots[ARRAY_COUNT]; \
+      type rems[ARRAY_COUNT]; \
+      struct libdivide_##ALGO##_t array_divider = libdivide_##ALGO##_gen(denom); \
+      size_t i; \
+      for (i = 0; i < ARRAY_COUNT + 1; i++) \
+         numers[i] = (type)((uint64_t)i * UINT64_C(0x9E3779B97F4A7C15)); \
+      printf("Testing " #ALGO " array division, %" format_spec "\n", (type)denom); \
+      libdivide_##ALGO##_do_array(numers + 1, quots, ARRAY_COUNT, &array_divider); \
+      for (i = 0; i < ARRAY_COUNT; i++) \
+      { \
+         type numer = numers[i + 1]; \
+         type libdiv_result = quots[i]; \
+         type native_result = numer / denom; \
+         ASSERT_EQUAL(type, numer, denom, libdiv_result, native_result, format_spec) \
+      } \
+      printf("Testing " #ALGO " array divmod, %" format_spec "\n", (type)denom); \
+      libdivide_##ALGO##_divmod_array(numers + 1, quots, rems, ARRAY_COUNT, denom, &array_divider); \
+      for (i = 0; i < ARRAY_COUNT; i++) \
+      { \
+         type numer = numers[i + 1]; \
+         ASSERT_EQUAL(type, numer, denom, quots[i], (type)(numer / denom), format_spec) \
+         ASSERT_EQUAL(type, numer, denom, rems[i], (type)(numer % denom), format_spec) \
+      } \
+   }
+
+/* Checks the fastmod remainder and divisibility test of numerators around
+ * multiples of denom */
+#define TEST_FASTMOD(type, ALGO, denom, format_spec) \
+   { \
+      struct libdivide_##ALGO##_fastmod_t fastmod = libdivide_##ALGO##_fastmod_gen(denom); \
+      int64_t i; \
+      printf("Testing " #ALGO " fastmod, %" format_spec "\n", (type)denom); \
+      for (i = -5000; i < 5000; i++) \
+      { \
+         type numer = (type)(i * (int64_t)denom + i % 7); \
+         type native_result = numer % denom; \
+         ASSERT_EQUAL(type, numer, denom, libdivide_##ALGO##_fastmod_mod(numer, &fastmod), native_result, format_spec) \
+         if (libdivide_##ALGO##_fastmod_is_divisible(numer, &fastmod) != (native_result == 0)) \
+            fprintf(stderr, "Divisibility fail: " #type ", %" format_spec "/%" format_spec "\n", numer, (type)denom); \
+      } \
+   }
+
+/* Checks the exact division of the multiples q * denom, first <= q < first + 64 */
+#define TEST_EXACT(type, ALGO, denom, first, format_spec) \
+   { \
+      struct libdivide_##ALGO##_exact_t exact = libdivide_##ALGO##_exact_gen(denom); \
+      int64_t q; \
+      printf("Testing " #ALGO " exact division, %" format_spec "\n", (type)denom); \
+      if (libdivide_##ALGO##_exact_recover(&exact) != (type)denom) \
+         fprintf(stderr, "Exact recover fail: " #type ", %" format_spec "\n", (type)denom); \
+      for (q = first; q < first + 64; q++) \
+      { \
+         type numer = (type)(q * (int64_t)denom); \
+         ASSERT_EQUAL(type, numer, denom, libdivide_##ALGO##_exact_do(numer, &exact), (type)q, format_spec) \
+      } \
+   }
+
+/* Reference rounding division of small numerators */
+static int64_t round_ref(int64_t n, int64_t d, enum libdivide_rounding rounding) {
+   int64_t q = n / d;
+   int64_t r = n % d;
+   if (r != 0 && rounding == LIBDIVIDE_ROUND_FLOOR && (r < 0) != (d < 0))
+      q--;
+   if (r != 0 && rounding == LIBDIVIDE_ROUND_CEIL && (r < 0) == (d < 0))
+      q++;
+   if (r < 0 && rounding == LIBDIVIDE_ROUND_EUCLID)
+      q += d < 0 ? 1 : -1;
+   return q;
+}
+
+/* Checks the floor, ceiling and Euclidean division of q * denom - 1,
+ * q * denom and q * denom + 1, first <= q < first + 64 */
+#define TEST_ROUND(type, ALGO, denom, first, format_spec) \
+   { \
+      int mode; \
+      printf("Testing " #ALGO " rounding division, %" format_spec "\n", (type)denom); \
+      for (mode = LIBDIVIDE_ROUND_FLOOR; mode <= LIBDIVIDE_ROUND_EUCLID; mode++) \
+      { \
+         enum libdivide_rounding rounding = (enum libdivide_rounding)mode; \
+         struct libdivide_##ALGO##_round_t round = libdivide_##ALGO##_round_gen(denom, rounding); \
+         struct libdivide_##ALGO##_round_branchfree_t round_bf = \
+            libdivide_##ALGO##_round_branchfree_gen(denom, rounding); \
+         int64_t q, offset; \
+         if (libdivide_##ALGO##_round_recover(&round) != (type)denom || \
+             libdivide_##ALGO##_round_branchfree_recover(&round_bf) != (type)denom) \
+            fprintf(stderr, "Rounding recover fail: " #type ", %" format_spec "\n", (type)denom); \
+         for (q = first; q < first + 64; q++) \
+         { \
+            for (offset = -1; offset <= 1; offset++) \
+            { \
+               type numer = (type)(q * (int64_t)denom + offset); \
+               type native_result = (type)round_ref(q * (int64_t)denom + offset, (int64_t)denom, rounding); \
+               ASSERT_EQUAL(type, numer, denom, libdivide_##ALGO##_round_do(numer, &round), native_result, format_spec) \
+               ASSERT_EQUAL(type, numer, denom, libdivide_##ALGO##_round_branchfree_do(numer, &round_bf), native_result, format_spec) \
+            } \
+         } \
+      } \
+   }
+
+/* 8-bit dividers are small enough to check all the numerators and the
+ * divisors from first_denom */
+#define TEST_8(type, ALGO, first_denom, first, last, format_spec) \
+   { \
+      int d, n; \
+      printf("Testing " #ALGO ", all numerators and divisors\n"); \
+      for (d = first_denom; d <= last; d++) \
+      { \
+         struct libdivide_##ALGO##_t divider_8; \
+         type denom = (type)d; \
+         if (d == 0) continue; \
+         divider_8 = libdivide_##ALGO##_gen(denom); \
+         if (libdivide_##ALGO##_recover(&divider_8) != denom) \
+            fprintf(stderr, "Recover fail: " #type ", %" format_spec "\n", denom); \
+         for (n = first; n <= last; n++) \
+         { \
+            type numer = (type)n, rem; \
+            if (n == -128 && d == -1) continue; \
+            ASSERT_EQUAL(type, numer, denom, libdivide_##ALGO##_do(numer, &divider_8), (type)(numer / denom), format_spec) \
+            ASSERT_EQUAL(type, numer, denom, libdivide_##ALGO##_divmod(numer, denom, &divider_8, &rem), (type)(numer / denom), format_spec) \
+            ASSERT_EQUAL(type, numer, denom, rem, (type)(numer % denom), format_spec) \
+         } \
+      } \
+   }
+
+void test_u8(void) {
+   TEST_8(uint8_t, u8, 1, 0, UINT8_MAX, PRIu8)
+   TEST_8(uint8_t, u8_branchfree, 2, 0, UINT8_MAX, PRIu8)
+   TEST_ARRAY(uint8_t, u8, 7, PRIu8)
+   TEST_ARRAY(uint8_t, u8_branchfree, 7, PRIu8)
+}
+
+void test_s8(void) {
+   TEST_8(int8_t, s8, INT8_MIN, INT8_MIN, INT8_MAX, PRId8)
+   TEST_8(int8_t, s8_branchfree, INT8_MIN, INT8_MIN, INT8_MAX, PRId8)
+   TEST_ARRAY(int8_t, s8, -7, PRId8)
+   TEST_ARRAY(int8_t, s8_branchfree, -7, PRId8)
+}
+
 void test_u16(void) {
 #define U16_DENOM 953 // Prime
    struct libdivide_u16_t divider = libdivide_u16_gen(U16_DENOM);
 #define OP_U16_DO(numer, divider) libdivide_u16_do(numer, &divider)
    TEST_BODY(uint16_t, UINT16_MAX, U16_DENOM, divider, PRIu16, OP_U16_DO)
+   TEST_ARRAY(uint16_t, u16, U16_DENOM, PRIu16)
+   TEST_ARRAY(uint16_t, u16_branchfree, U16_DENOM, PRIu16)
+   TEST_EXACT(uint16_t, u16, 24, 0, PRIu16)
+   TEST_ROUND(uint16_t, u16, U16_DENOM, 1, PRIu16)
+
+   struct libdivide_u16_fp_t fp_divider = libdivide_u16_fp_gen(U16_DENOM);
+#define OP_U16_FP(numer, divider) libdivide_u16_fp_do(numer, &divider)
+   printf("Floating point division ");
+   TEST_BODY(uint16_t, UINT16_MAX, U16_DENOM, fp_divider, PRIu16, OP_U16_FP)
 
 #define CONSTANT_OP_U16(numer, denom) FAST_DIV16U(numer, denom)
    printf("Constant division ");
@@ -65,6 +217,15 @@ void test_s16(void) {
    struct libdivide_s16_t divider = libdivide_s16_gen(denom);
 #define OP_S16(numer, divider) libdivide_s16_do(numer, &divider)
    TEST_BODY(int16_t, INT16_MAX, denom, divider, PRId16, OP_S16)
+   TEST_ARRAY(int16_t, s16, denom, PRId16)
+   TEST_ARRAY(int16_t, s16_branchfree, denom, PRId16)
+   TEST_EXACT(int16_t, s16, -24, -32, PRId16)
+   TEST_ROUND(int16_t, s16, -401, -32, PRId16)
+
+   struct libdivide_s16_fp_t fp_divider = libdivide_s16_fp_gen(denom);
+#define OP_S16_FP(numer, divider) libdivide_s16_fp_do(numer, &divider)
+   printf("Floating point division ");
+   TEST_BODY(int16_t, INT16_MAX, denom, fp_divider, PRId16, OP_S16_FP)
 
 #define CONSTANT_OP_S16(numer, denom) FAST_DIV16(numer, denom)   
    printf("Constant division ");
@@ -80,6 +241,16 @@ void test_u32(void) {
    struct libdivide_u32_t divider = libdivide_u32_gen(denom);
 #define OP_U32(numer, divider) libdivide_u32_do(numer, &divider)
    TEST_BODY(uint32_t, UINT32_MAX, denom, divider, PRIu32, OP_U32)
+   TEST_ARRAY(uint32_t, u32, denom, PRIu32)
+   TEST_ARRAY(uint32_t, u32_branchfree, denom, PRIu32)
+   TEST_FASTMOD(uint32_t, u32, denom, PRIu32)
+   TEST_EXACT(uint32_t, u32, denom * 8, 0, PRIu32)
+   TEST_ROUND(uint32_t, u32, denom, 1, PRIu32)
+
+   struct libdivide_u32_fp_t fp_divider = libdivide_u32_fp_gen(denom);
+#define OP_U32_FP(numer, divider) libdivide_u32_fp_do(numer, &divider)
+   printf("Floating point division ");
+   TEST_BODY(uint32_t, UINT32_MAX, denom, fp_divider, PRIu32, OP_U32_FP)
 }
 
 void test_s32(void) {
@@ -87,6 +258,16 @@ void test_s32(void) {
    struct libdivide_s32_t divider = libdivide_s32_gen(denom);
 #define OP_S32(numer, divider) libdivide_s32_do(numer, &divider)
    TEST_BODY(int32_t, INT32_MAX, denom, divider, PRId32, OP_S32)
+   TEST_ARRAY(int32_t, s32, denom, PRId32)
+   TEST_ARRAY(int32_t, s32_branchfree, denom, PRId32)
+   TEST_FASTMOD(int32_t, s32, denom, PRId32)
+   TEST_EXACT(int32_t, s32, denom * 8, -32, PRId32)
+   TEST_ROUND(int32_t, s32, denom, -32, PRId32)
+
+   struct libdivide_s32_fp_t fp_divider = libdivide_s32_fp_gen(denom);
+#define OP_S32_FP(numer, divider) libdivide_s32_fp_do(numer, &divider)
+   printf("Floating point division ");
+   TEST_BODY(int32_t, INT32_MAX, denom, fp_divider, PRId32, OP_S32_FP)
 }
 
 void test_u64(void) {
@@ -94,6 +275,10 @@ void test_u64(void) {
    struct libdivide_u64_t divider = libdivide_u64_gen(denom);
 #define OP_U64(numer, divider) libdivide_u64_do(numer, &divider)
    TEST_BODY(uint64_t, (UINT64_MAX/2) /* For speed */, denom, divider, PRIu64, OP_U64)
+   TEST_ARRAY(uint64_t, u64, denom, PRIu64)
+   TEST_ARRAY(uint64_t, u64_branchfree, denom, PRIu64)
+   TEST_EXACT(uint64_t, u64, denom * 8, 0, PRIu64)
+   TEST_ROUND(uint64_t, u64, denom, 1, PRIu64)
 }
 
 void test_s64(void) {
@@ -101,18 +286,65 @@ void test_s64(void) {
    struct libdivide_s64_t divider = libdivide_s64_gen(denom);
 #define OP_S64(numer, divider) libdivide_s64_do(numer, &divider)
    TEST_BODY(int64_t, INT64_MAX, denom, divider, PRId64, OP_S64)
+   TEST_ARRAY(int64_t, s64, denom, PRId64)
+   TEST_ARRAY(int64_t, s64_branchfree, denom, PRId64)
+   TEST_EXACT(int64_t, s64, denom * 8, -32, PRId64)
+   TEST_ROUND(int64_t, s64, denom, -32, PRId64)
+}
+
+#if defined(HAS_INT128_DIV)
+/* printf() has no format for 128-bit integers, so print both halves in hex */
+#define PRINT_128(x) (uint64_t)((__uint128_t)(x) >> 64), (uint64_t)(x)
+#define TEST_128(type, ALGO, denom) \
+   { \
+      struct libdivide_##ALGO##_t divider_128 = libdivide_##ALGO##_gen(denom); \
+      type numer = 1; \
+      int i; \
+      printf("Testing " #ALGO "\n"); \
+      if (libdivide_##ALGO##_recover(&divider_128) != denom) { \
+         fprintf(stderr, "Recover fail: " #ALGO ", 0x%016" PRIx64 "%016" PRIx64 "\n", PRINT_128(denom)); \
+      } \
+      for (i = 0; i < 4096; i++) { \
+         type libdiv_result = libdivide_##ALGO##_do(numer, &divider_128); \
+         type native_result = numer / denom; \
+         if (libdiv_result != native_result) { \
+            fprintf(stderr, "Division fail: " #ALGO ", 0x%016" PRIx64 "%016" PRIx64 \
+               "/0x%016" PRIx64 "%016" PRIx64 "\n", PRINT_128(numer), PRINT_128(denom)); \
+         } \
+         /* multiply by an odd constant to walk through all bit lengths */ \
+         numer = (type)((__uint128_t)numer * 0x9E3779B97F4A7C15u + (__uint128_t)i); \
+      } \
+   }
+
+void test_u128(void) {
+   __uint128_t denom = ((__uint128_t)1 << 89) - 1;  // 2^89 - 1 is prime
+   TEST_128(__uint128_t, u128, denom)
+   TEST_128(__uint128_t, u128_branchfree, denom)
+}
+
+void test_s128(void) {
+   __int128_t denom = -(((__int128_t)1 << 107) - 1);  // 2^107 - 1 is prime
+   TEST_128(__int128_t, s128, denom)
+   TEST_128(__int128_t, s128_branchfree, denom)
 }
+#endif
 
 int main (int argc, char *argv[]) { 
    UNUSED(argc);
    UNUSED(argv);
    
+   test_u8();
+   test_s8();
    test_u16();
    test_s16();
    test_u32();
    test_s32();
    test_u64();
    test_s64();
+#if defined(HAS_INT128_DIV)
+   test_u128();
+   test_s128();
+#endif
 
    return 0;
 }
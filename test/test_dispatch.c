@@ -0,0 +1,286 @@
+/*
+ * Tests the runtime dispatch of the bulk (array) functions. The program is
+ * compiled without any vector instruction set flags and with
+ * LIBDIVIDE_RUNTIME_DISPATCH, each instruction set supported by the CPU is
+ * then forced using libdivide_set_isa().
+ *
+ * If the LIBDIVIDE_ISA environment variable is set, the instruction set
+ * selected at startup must not be wider than requested.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "libdivide.h"
+
+#undef UNUSED
+#define UNUSED(x) (void)(x)
+#define ARRAY_COUNT 1027
+
+static const char *const isa_names[] = {"scalar", "sse2", "avx2", "avx512"};
+static int failures = 0;
+
+/* Divides a misaligned array of odd length by denom, in place and out of
+ * place, and compares against the scalar division. Also checks the
+ * remainders computed by divmod_array. */
+#define TEST_ARRAY(type, ALGO, denom, format_spec) \
+   { \
+      type numers[ARRAY_COUNT + 1]; \
+      type quots[ARRAY_COUNT + 1]; \
+      type quots2[ARRAY_COUNT]; \
+      type rems[ARRAY_COUNT]; \
+      struct libdivide_##ALGO##_t divider = libdivide_##ALGO##_gen(denom); \
+      size_t i, offset; \
+      for (offset = 0; offset < 2; offset++) \
+      { \
+         for (i = 0; i < ARRAY_COUNT + 1; i++) \
+            numers[i] = (type)((uint64_t)(i + offset) * UINT64_C(0x9E3779B97F4A7C15)); \
+         libdivide_##ALGO##_do_array(numers + 1, quots + offset, ARRAY_COUNT, &divider); \
+         libdivide_##ALGO##_divmod_array(numers + 1, quots2, rems, ARRAY_COUNT, denom, &divider); \
+         libdivide_##ALGO##_do_array(numers + offset, numers + offset, ARRAY_COUNT, &divider); \
+         for (i = 0; i < ARRAY_COUNT; i++) \
+         { \
+            type numer = (type)((uint64_t)(i + 1 + offset) * UINT64_C(0x9E3779B97F4A7C15)); \
+            type expected = libdivide_##ALGO##_do(numer, &divider); \
+            type in_place = (type)((uint64_t)(i + offset + offset) * UINT64_C(0x9E3779B97F4A7C15)); \
+            if (quots[i + offset] != expected || \
+                numers[i + offset] != libdivide_##ALGO##_do(in_place, &divider) || \
+                quots2[i] != expected || rems[i] != (type)(numer - expected * denom)) \
+            { \
+               fprintf(stderr, "Array failure: " #ALGO ", %" format_spec "/%" format_spec "\n", \
+                   numer, (type)denom); \
+               failures++; \
+               break; \
+            } \
+         } \
+      } \
+   }
+
+#define TEST_TYPE(type, ALGO, format_spec, ...) \
+   { \
+      const type denoms[] = {__VA_ARGS__}; \
+      size_t d; \
+      for (d = 0; d < sizeof(denoms) / sizeof(denoms[0]); d++) \
+      { \
+         TEST_ARRAY(type, ALGO, denoms[d], format_spec) \
+         TEST_ARRAY(type, ALGO##_branchfree, denoms[d], format_spec) \
+      } \
+   }
+
+/* Computes the quotients and remainders of ARRAY_COUNT strided numerators
+ * starting close to the maximum, so that they wrap around, and compares
+ * against the scalar division. */
+#define TEST_IOTA(type, ALGO, denom, step, format_spec) \
+   { \
+      type quots[ARRAY_COUNT]; \
+      type rems[ARRAY_COUNT]; \
+      struct libdivide_##ALGO##_t divider = libdivide_##ALGO##_gen(denom); \
+      type numer = (type)((type)0 - (type)(step) * 700); \
+      size_t i; \
+      libdivide_##ALGO##_iota_divmod(numer, step, ARRAY_COUNT, denom, quots, rems); \
+      for (i = 0; i < ARRAY_COUNT; i++, numer = (type)(numer + (step))) \
+      { \
+         type expected = libdivide_##ALGO##_do(numer, &divider); \
+         if (quots[i] != expected || rems[i] != (type)(numer - expected * denom)) \
+         { \
+            fprintf(stderr, "Iota failure: " #ALGO ", %" format_spec "/%" format_spec "\n", \
+                numer, (type)denom); \
+            failures++; \
+            break; \
+         } \
+      } \
+   }
+
+// Decomposes the indices i * step into the coordinates of a tensor of
+// extents e0 x e1 x e2 and recombines them with other strides.
+#define TEST_DECOMPOSE(type, ALGO, e1, e2, step, format_spec) \
+   { \
+      type indices[ARRAY_COUNT]; \
+      type coords0[ARRAY_COUNT], coords1[ARRAY_COUNT], coords2[ARRAY_COUNT]; \
+      type *coords[3]; \
+      type remapped[ARRAY_COUNT]; \
+      const type extents[3] = {0, e1, e2}; \
+      const type strides[3] = {3, 1000, 1}; \
+      struct libdivide_##ALGO##_t denoms[3]; \
+      size_t i; \
+      coords[0] = coords0; \
+      coords[1] = coords1; \
+      coords[2] = coords2; \
+      denoms[1] = libdivide_##ALGO##_gen(e1); \
+      denoms[2] = libdivide_##ALGO##_gen(e2); \
+      for (i = 0; i < ARRAY_COUNT; i++) \
+         indices[i] = (type)((type)i * (step)); \
+      libdivide_##ALGO##_decompose_array(indices, ARRAY_COUNT, extents, denoms, 3, coords); \
+      libdivide_##ALGO##_remap_array(indices, ARRAY_COUNT, extents, denoms, 3, strides, remapped); \
+      for (i = 0; i < ARRAY_COUNT; i++) \
+      { \
+         type index = indices[i]; \
+         type c2 = (type)(index % (e2)), c1 = (type)(index / (e2) % (e1)); \
+         type c0 = (type)(index / (e2) / (e1)); \
+         if (coords0[i] != c0 || coords1[i] != c1 || coords2[i] != c2 || \
+             remapped[i] != (type)(c0 * 3 + c1 * 1000 + c2)) \
+         { \
+            fprintf(stderr, "Decompose failure: " #ALGO ", %" format_spec "\n", index); \
+            failures++; \
+            break; \
+         } \
+      } \
+   }
+
+/* Multiplies, adds and subtracts arrays of residues modulo m and raises them
+ * to a power, comparing against the scalar modular arithmetic. */
+#define TEST_MODMUL(type, ALGO, m, step, format_spec) \
+   { \
+      type a[ARRAY_COUNT], b[ARRAY_COUNT]; \
+      type prods[ARRAY_COUNT], sums[ARRAY_COUNT], diffs[ARRAY_COUNT], powers[ARRAY_COUNT]; \
+      struct libdivide_##ALGO##_reducer_t reducer = libdivide_##ALGO##_reducer_gen(m); \
+      size_t i; \
+      for (i = 0; i < ARRAY_COUNT; i++) \
+      { \
+         a[i] = (type)((type)i * (step) % (m)); \
+         b[i] = (type)((m) - 1 - (type)(i * 3) % (m)); \
+      } \
+      libdivide_##ALGO##_mulmod_array(a, b, prods, ARRAY_COUNT, &reducer); \
+      libdivide_##ALGO##_addmod_array(a, b, sums, ARRAY_COUNT, &reducer); \
+      libdivide_##ALGO##_submod_array(a, b, diffs, ARRAY_COUNT, &reducer); \
+      libdivide_##ALGO##_powmod_array(a, powers, ARRAY_COUNT, 65537, &reducer); \
+      for (i = 0; i < ARRAY_COUNT; i++) \
+      { \
+         if (prods[i] != libdivide_##ALGO##_mulmod(a[i], b[i], &reducer) || \
+             sums[i] != libdivide_##ALGO##_addmod(a[i], b[i], &reducer) || \
+             diffs[i] != libdivide_##ALGO##_submod(a[i], b[i], &reducer) || \
+             powers[i] != libdivide_##ALGO##_powmod(a[i], 65537, &reducer)) \
+         { \
+            fprintf(stderr, "Modular arithmetic failure: " #ALGO ", %" format_spec \
+                    " mod %" format_spec "\n", a[i], (type)(m)); \
+            failures++; \
+            break; \
+         } \
+      } \
+   }
+
+#define TEST_SCALER(type, ALGO, num, den, step, format_spec) \
+   { \
+      type x[ARRAY_COUNT], results[ARRAY_COUNT]; \
+      int rounding, saturate; \
+      size_t i; \
+      for (i = 0; i < ARRAY_COUNT; i++) \
+      { \
+         x[i] = (type)((type)i * (step)); \
+      } \
+      for (rounding = LIBDIVIDE_ROUND_FLOOR; rounding <= LIBDIVIDE_ROUND_NEAREST; rounding++) \
+      { \
+         for (saturate = 0; saturate < 2; saturate++) \
+         { \
+            struct libdivide_##ALGO##_scaler_t scaler = libdivide_##ALGO##_scaler_gen( \
+               num, den, (enum libdivide_rounding)rounding, saturate); \
+            libdivide_##ALGO##_scaler_do_array(x, results, ARRAY_COUNT, &scaler); \
+            for (i = 0; i < ARRAY_COUNT; i++) \
+            { \
+               if (results[i] != libdivide_##ALGO##_scaler_do(x[i], &scaler)) \
+               { \
+                  fprintf(stderr, "Rational scaling failure: " #ALGO ", %" format_spec \
+                          " * %" format_spec " / %" format_spec "\n", x[i], (type)(num), \
+                          (type)(den)); \
+                  failures++; \
+                  break; \
+               } \
+            } \
+         } \
+      } \
+   }
+
+/* Generates the dividers of a misaligned array of divisors, powers of 2,
+ * their neighbours and a sequence with the given step, and compares against
+ * the scalar generation. */
+#define TEST_GEN_ARRAY(ALGO, step) \
+   { \
+      uint32_t divisors[ARRAY_COUNT], magics[ARRAY_COUNT + 1]; \
+      uint8_t mores[ARRAY_COUNT + 1]; \
+      size_t i; \
+      for (i = 0; i < ARRAY_COUNT; i++) \
+      { \
+         uint32_t power = UINT32_C(1) << (i % 30 + 2); \
+         divisors[i] = (i % 3 == 0) ? power + (uint32_t)(i % 5) - 2 \
+                                    : (uint32_t)i * (step) + 2; \
+      } \
+      libdivide_##ALGO##_gen_array(divisors, magics + 1, mores + 1, ARRAY_COUNT); \
+      for (i = 0; i < ARRAY_COUNT; i++) \
+      { \
+         struct libdivide_##ALGO##_t denom = libdivide_##ALGO##_gen(divisors[i]); \
+         if (magics[i + 1] != denom.magic || mores[i + 1] != denom.more) \
+         { \
+            fprintf(stderr, "Divider generation failure: " #ALGO ", %" PRIu32 "\n", \
+                    divisors[i]); \
+            failures++; \
+            break; \
+         } \
+      } \
+   }
+
+static void test_all_types(void) {
+   TEST_TYPE(uint16_t, u16, PRIu16, 2, 3, 7, 953, 4096, UINT16_MAX)
+   TEST_TYPE(int16_t, s16, PRId16, 2, 3, -7, 953, -4096, INT16_MAX, INT16_MIN)
+   TEST_TYPE(uint32_t, u32, PRIu32, 2, 3, 7, 4194249, 65536, UINT32_MAX)
+   TEST_TYPE(int32_t, s32, PRId32, 2, 3, -7, -4194249, -65536, INT32_MAX, INT32_MIN)
+   TEST_TYPE(uint64_t, u64, PRIu64, 2, 3, 7, 1073741781, UINT64_C(1) << 40, UINT64_MAX)
+   TEST_TYPE(int64_t, s64, PRId64, 2, 3, -7, -1073741703, -(INT64_C(1) << 40), INT64_MAX, INT64_MIN)
+   TEST_IOTA(uint32_t, u32, 7, 3, PRIu32)
+   TEST_IOTA(uint32_t, u32, 4194249, 65537, PRIu32)
+   TEST_IOTA(uint64_t, u64, 7, 3, PRIu64)
+   TEST_IOTA(uint64_t, u64, 1073741781, UINT64_C(1) << 33, PRIu64)
+   TEST_DECOMPOSE(uint32_t, u32, 7, 640, 3, PRIu32)
+   TEST_DECOMPOSE(uint32_t, u32, 1, 65537, 4194249, PRIu32)
+   TEST_DECOMPOSE(uint64_t, u64, 7, 640, 3, PRIu64)
+   TEST_DECOMPOSE(uint64_t, u64, 1, 1073741781, UINT64_C(1) << 33, PRIu64)
+   TEST_MODMUL(uint32_t, u32, 4294967291u, 4194249, PRIu32)
+   TEST_MODMUL(uint32_t, u32, 1000000000u, 4194249, PRIu32)
+   TEST_MODMUL(uint64_t, u64, UINT64_C(18446744073709551557), UINT64_C(1073741781) << 20, PRIu64)
+   TEST_MODMUL(uint64_t, u64, UINT64_C(1000000000000000000), UINT64_C(1073741781) << 20, PRIu64)
+   TEST_SCALER(uint32_t, u32, 48000u, 44100u, 4194249, PRIu32)
+   TEST_SCALER(uint32_t, u32, 7u, 3u, 4194249, PRIu32)
+   TEST_SCALER(uint64_t, u64, UINT64_C(1000000000), UINT64_C(90000), UINT64_C(1073741781) << 20, PRIu64)
+   TEST_SCALER(uint64_t, u64, UINT64_C(3) << 62, UINT64_MAX, UINT64_C(1073741781) << 20, PRIu64)
+   TEST_GEN_ARRAY(u32, 3)
+   TEST_GEN_ARRAY(u32, 4194249)
+   TEST_GEN_ARRAY(u32_branchfree, 3)
+   TEST_GEN_ARRAY(u32_branchfree, 4194249)
+}
+
+int main (int argc, char *argv[]) {
+   const char *env = getenv("LIBDIVIDE_ISA");
+   enum libdivide_isa initial = libdivide_get_isa();
+   int isa;
+   UNUSED(argc);
+   UNUSED(argv);
+
+   printf("Initial instruction set: %s\n", isa_names[initial]);
+   if (env != NULL) {
+      for (isa = 0; isa < 4; isa++) {
+         if (strcmp(env, isa_names[isa]) == 0 && (int)initial > isa) {
+            fprintf(stderr, "LIBDIVIDE_ISA=%s ignored\n", env);
+            failures++;
+         }
+      }
+   }
+
+   test_all_types();
+
+   for (isa = LIBDIVIDE_ISA_SCALAR; isa <= LIBDIVIDE_ISA_AVX512; isa++) {
+      enum libdivide_isa selected = libdivide_set_isa((enum libdivide_isa)isa);
+      if ((int)selected != isa || libdivide_get_isa() != selected) {
+         printf("Skipping %s, not supported by the CPU\n", isa_names[isa]);
+         continue;
+      }
+      printf("Testing array division using %s\n", isa_names[isa]);
+      test_all_types();
+   }
+
+   if (failures != 0) {
+      fprintf(stderr, "%d failures\n", failures);
+      return 1;
+   }
+   printf("All tests passed successfully!\n");
+   return 0;
+}
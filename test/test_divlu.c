@@ -1,11 +1,13 @@
-// Unit tests for divlu and divllu.
+// Unit tests for divlu, divllu and libdivide_u128_u64_do.
 // To build standalone:
-//   cc -O1 -o test_divlu test/test_divlu.c doc/divlu.c
+//   cc -O1 -I. -o test_divlu test/test_divlu.c doc/divlu.c
 
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "libdivide.h"
+
 uint32_t divlu(uint32_t numhi, uint32_t numlo, uint32_t den, uint32_t *r);
 uint64_t divllu(uint64_t numhi, uint64_t numlo, uint64_t den, uint64_t *r);
 
@@ -89,6 +91,16 @@ static void verify64(uint64_t numhi, uint64_t numlo, uint64_t den) {
             (ullong)numhi, (ullong)numlo, (ullong)den, (ullong)quot, (ullong)rem);
         abort();
     }
+    // The divider with a precomputed reciprocal must agree with divllu.
+    struct libdivide_u128_u64_t divider = libdivide_u128_u64_gen(den);
+    uint64_t rec_rem;
+    uint64_t rec_quot = libdivide_u128_u64_do(numhi, numlo, &divider, &rec_rem);
+    if (rec_quot != quot || rec_rem != rem || libdivide_u128_u64_recover(&divider) != den) {
+        fprintf(stderr, "libdivide_u128_u64_do(%llu, %llu, %llu): got q=%llu r=%llu, expected q=%llu r=%llu\n",
+            (ullong)numhi, (ullong)numlo, (ullong)den, (ullong)rec_quot, (ullong)rec_rem,
+            (ullong)quot, (ullong)rem);
+        abort();
+    }
 }
 
 int main(void) {
@@ -131,6 +143,8 @@ int main(void) {
     // NULL remainder pointer: quotient must still be correct.
     if (divlu(0, 7, 3, NULL) != 2) abort();
     if (divllu(0, 5, 3, NULL) != 1) abort();
+    struct libdivide_u128_u64_t three = libdivide_u128_u64_gen(3);
+    if (libdivide_u128_u64_do(0, 5, &three, NULL) != 1) abort();
 
     // --- Cases that trigger the qhat -= 1 correction ---
     //
@@ -152,6 +166,21 @@ int main(void) {
     verify64(
         UINT64_C(0x7FFFFFFFFFFFFFFF), UINT64_C(0xFFFFFFFF00000000), UINT64_C(0x80000000FFFFFFFF));
 
+    // libdivide_u128_u64_do: normalized and unnormalized divisors near the
+    // powers of 2, with the largest numerators.
+    for (int shift = 0; shift < 64; shift++) {
+        uint64_t pow2 = (uint64_t)1 << shift;
+        uint64_t dens[] = {pow2, pow2 + 1, pow2 - 1, pow2 | (pow2 >> 1), UINT64_MAX >> shift};
+        for (size_t i = 0; i < sizeof(dens) / sizeof(dens[0]); i++) {
+            uint64_t den = dens[i];
+            if (den == 0) continue;
+            verify64(0, 0, den);
+            verify64(0, UINT64_MAX, den);
+            verify64(den - 1, 0, den);
+            verify64(den - 1, UINT64_MAX, den);
+            verify64(den / 2, UINT64_C(0x9E3779B97F4A7C15), den);
+        }
+    }
     // --- Systematic sweeps ---
 
     // divlu: all combinations with den, numhi, numlo < 256 (~8M calls).
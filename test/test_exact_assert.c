@@ -0,0 +1,73 @@
+/*
+ * Checks that exact division asserts that the numerator is a multiple of
+ * the divisor. The program is compiled with LIBDIVIDE_ASSERTIONS_ON, it
+ * divides the multiples of a divisor, which must not abort, and then a
+ * non-multiple, which must abort. Each case runs in its own process:
+ *
+ *    test_exact_assert u16|s16|u32|s32|u64|s64
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#ifndef LIBDIVIDE_ASSERTIONS_ON
+#define LIBDIVIDE_ASSERTIONS_ON
+#endif
+#include "libdivide.h"
+
+static void on_abort(int sig) {
+   (void)sig;
+   /* The assertion fired as expected */
+   _Exit(0);
+}
+
+/* Divides q * denom for small q, then numer which is not a multiple of
+ * denom and must abort. */
+#define TEST_EXACT_ASSERT(type, ALGO, denom, numer, format_spec) \
+   { \
+      struct libdivide_##ALGO##_exact_t exact = libdivide_##ALGO##_exact_gen(denom); \
+      int64_t q; \
+      for (q = -64; q < 64; q++) \
+      { \
+         type multiple = (type)(q * (int64_t)(denom)); \
+         if ((type)-1 > 0 && q < 0) \
+            continue; \
+         if (libdivide_##ALGO##_exact_do(multiple, &exact) != (type)q) \
+         { \
+            fprintf(stderr, "Exact division failure: " #ALGO ", %" format_spec " / %" \
+                    format_spec "\n", multiple, (type)(denom)); \
+            return 1; \
+         } \
+      } \
+      signal(SIGABRT, on_abort); \
+      printf("Dividing " #ALGO " %" format_spec " by %" format_spec ", must abort\n", \
+             (type)(numer), (type)(denom)); \
+      fflush(stdout); \
+      q = (int64_t)libdivide_##ALGO##_exact_do((type)(numer), &exact); \
+      fprintf(stderr, "No assertion for " #ALGO " %" format_spec " / %" format_spec \
+              ", got %" PRId64 "\n", (type)(numer), (type)(denom), q); \
+      return 1; \
+   }
+
+int main(int argc, char *argv[]) {
+   const char *type = argc > 1 ? argv[1] : "";
+
+   if (strcmp(type, "u16") == 0)
+      TEST_EXACT_ASSERT(uint16_t, u16, 3, 10, PRIu16)
+   if (strcmp(type, "s16") == 0)
+      TEST_EXACT_ASSERT(int16_t, s16, -7, 10, PRId16)
+   if (strcmp(type, "u32") == 0)
+      TEST_EXACT_ASSERT(uint32_t, u32, 3, 10, PRIu32)
+   if (strcmp(type, "s32") == 0)
+      TEST_EXACT_ASSERT(int32_t, s32, -7, 10, PRId32)
+   if (strcmp(type, "u64") == 0)
+      TEST_EXACT_ASSERT(uint64_t, u64, 12, 18, PRIu64)
+   if (strcmp(type, "s64") == 0)
+      TEST_EXACT_ASSERT(int64_t, s64, -7, 10, PRId64)
+
+   fprintf(stderr, "Usage: test_exact_assert u16|s16|u32|s32|u64|s64\n");
+   return 1;
+}
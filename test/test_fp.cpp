@@ -0,0 +1,207 @@
+// Exhaustive tests for fp_divider, the floating point reciprocal division.
+// All 16-bit divisor and numerator pairs are tested. For 32-bit integers
+// the quotient can only be wrong at numerators n = k * d - 1 (the product
+// must stay below k) and n = k * d (the product must reach k), and the
+// error of the product grows with n. So the largest such numerators are
+// tested for every divisor in [1, 2^20] and the 2^20 largest ones, plus
+// random pairs.
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "libdivide.h"
+
+using namespace libdivide;
+
+template <typename T>
+static void report(const char *kind, T numer, T denom, T expected, T quot) {
+    fprintf(stderr, "fp_divider %s failure for %" PRId64 " / %" PRId64 ": expected %" PRId64
+                    ", got %" PRId64 "\n",
+        kind, (int64_t)numer, (int64_t)denom, (int64_t)expected, (int64_t)quot);
+    exit(1);
+}
+
+// The quotient n / d of integers of type T, INT_MIN / -1 wraps like
+// libdivide's integer algorithm.
+template <typename T>
+static T expected_quotient(T numer, T denom) {
+    if (std::numeric_limits<T>::is_signed && denom == (T)-1) {
+        return (T)(0 - (typename std::make_unsigned<T>::type)numer);
+    }
+    return (T)(numer / denom);
+}
+
+template <typename T, typename VecT>
+static void check_vec(const std::vector<T> &numers, const std::vector<T> &quots, T denom,
+    const fp_divider<T> &div) {
+    const size_t count = sizeof(VecT) / sizeof(T);
+    union {
+        VecT vec;
+        T arr[sizeof(VecT) / sizeof(T)];
+    } in, out;
+    for (size_t i = 0; i + count <= numers.size(); i += count) {
+        memcpy(in.arr, &numers[i], sizeof(VecT));
+        out.vec = in.vec / div;
+        if (memcmp(out.arr, &quots[i], sizeof(VecT)) != 0) {
+            for (size_t j = 0; j < count; j++) {
+                if (out.arr[j] != quots[i + j]) {
+                    report("vector", numers[i + j], denom, quots[i + j], out.arr[j]);
+                }
+            }
+        }
+    }
+}
+
+// Checks the quotients of numers / denom against the expected quots.
+// numers.size() must be a multiple of the number of elements of the
+// largest vector type.
+template <typename T>
+static void check(const std::vector<T> &numers, const std::vector<T> &quots, T denom) {
+    const fp_divider<T> div(denom);
+    if (div.recover() != denom) {
+        report("recover", denom, denom, denom, div.recover());
+    }
+    for (size_t i = 0; i < numers.size(); i++) {
+        T quot = numers[i] / div;
+        if (quot != quots[i]) {
+            report("scalar", numers[i], denom, quots[i], quot);
+        }
+    }
+#if defined(LIBDIVIDE_SSE2)
+    check_vec<T, __m128i>(numers, quots, denom, div);
+#endif
+#if defined(LIBDIVIDE_AVX2)
+    check_vec<T, __m256i>(numers, quots, denom, div);
+#endif
+#if defined(LIBDIVIDE_AVX512)
+    check_vec<T, __m512i>(numers, quots, denom, div);
+#endif
+}
+
+template <typename T>
+static void check(const std::vector<T> &numers, T denom, std::vector<T> &quots) {
+    quots.resize(numers.size());
+    for (size_t i = 0; i < numers.size(); i++) {
+        quots[i] = expected_quotient(numers[i], denom);
+    }
+    check(numers, quots, denom);
+}
+
+// Hardware division of all the pairs would dominate the run time, so the
+// expected quotients are computed from the quotients of the absolute
+// values, which are counted up.
+template <typename T>
+static void test_all_pairs() {
+    typedef typename std::make_unsigned<T>::type UT;
+    std::vector<T> numers, quots;
+    T n = (std::numeric_limits<T>::min)();
+    do {
+        numers.push_back(n);
+    } while (n++ != (std::numeric_limits<T>::max)());
+    quots.resize(numers.size());
+
+    std::vector<UT> abs_quots(numers.size());
+    T d = (std::numeric_limits<T>::min)();
+    do {
+        if (d == 0) {
+            continue;
+        }
+        UT abs_d = d < 0 ? (UT)(0 - (UT)d) : (UT)d;
+        UT q = 0, r = 0;
+        for (size_t i = 0; i < abs_quots.size(); i++) {
+            abs_quots[i] = q;
+            if (++r == abs_d) {
+                r = 0;
+                q++;
+            }
+        }
+        for (size_t i = 0; i < numers.size(); i++) {
+            UT abs_n = numers[i] < 0 ? (UT)(0 - (UT)numers[i]) : (UT)numers[i];
+            UT abs_q = abs_quots[abs_n];
+            quots[i] = (T)((numers[i] < 0) != (d < 0) ? (UT)(0 - abs_q) : abs_q);
+        }
+        check(numers, quots, d);
+    } while (d++ != (std::numeric_limits<T>::max)());
+}
+
+// Adds the numerators k * d - 1 and k * d with the largest magnitudes
+// representable in T (for both signs if T is signed).
+template <typename T>
+static void add_worst_numerators(std::vector<T> &numers, T denom) {
+    typedef typename std::make_unsigned<T>::type UT;
+    UT abs_d = denom < 0 ? (UT)(0 - (UT)denom) : (UT)denom;
+    UT max = (UT)(std::numeric_limits<T>::max)();
+    UT multiple = max / abs_d * abs_d;
+    numers.push_back((T)multiple);
+    numers.push_back((T)(multiple - 1));
+    numers.push_back((T)max);
+    if (std::numeric_limits<T>::is_signed) {
+        // max + 1 is the magnitude of INT_MIN
+        UT neg_multiple = (max + 1) / abs_d * abs_d;
+        numers.push_back((T)(0 - neg_multiple));
+        numers.push_back((T)(0 - (neg_multiple - 1)));
+        numers.push_back((std::numeric_limits<T>::min)());
+    }
+}
+
+template <typename T>
+static void test_worst_numerators(T d, std::vector<T> &numers, std::vector<T> &quots) {
+    numers.clear();
+    add_worst_numerators(numers, d);
+    // Pad to a multiple of the largest vector size
+    while (numers.size() % 16 != 0) {
+        numers.push_back(numers[numers.size() % 3]);
+    }
+    check(numers, d, quots);
+    if (std::numeric_limits<T>::is_signed && d != (std::numeric_limits<T>::min)()) {
+        check(numers, (T)-d, quots);
+    }
+}
+
+template <typename T>
+static void test_32bit() {
+    typedef typename std::make_unsigned<T>::type UT;
+    const uint32_t range = 1u << 20;
+    std::vector<T> numers, quots;
+    // Smallest divisors
+    for (uint32_t d = 1; d <= range; d++) {
+        test_worst_numerators((T)(UT)d, numers, quots);
+    }
+    // Largest divisors, for signed types these are the negative ones
+    for (uint32_t d = 0; d < range; d++) {
+        UT abs_d = (UT)((UT)(std::numeric_limits<T>::max)() - d);
+        test_worst_numerators((T)abs_d, numers, quots);
+    }
+    if (std::numeric_limits<T>::is_signed) {
+        test_worst_numerators((std::numeric_limits<T>::min)(), numers, quots);
+    }
+
+    // Random divisors and numerators
+    std::mt19937 gen(42);
+    for (int i = 0; i < 100000; i++) {
+        T d = (T)gen();
+        if (d == 0) continue;
+        numers.clear();
+        for (int j = 0; j < 64; j++) {
+            numers.push_back((T)gen());
+        }
+        add_worst_numerators(numers, d);
+        numers.resize((numers.size() + 15) / 16 * 16, T(0));
+        check(numers, d, quots);
+    }
+}
+
+int main() {
+    test_all_pairs<uint16_t>();
+    test_all_pairs<int16_t>();
+    test_32bit<uint32_t>();
+    test_32bit<int32_t>();
+    printf("fp_divider tests passed\n");
+    return 0;
+}
@@ -1,7 +1,7 @@
 // Usage: tester [OPTIONS]
 //
 // You can pass the tester program one or more of the following options:
-// u32, s32, u64, s64 or run it without arguments to test all four.
+// u8, s8, u16, s16, u32, s32, u64, s64, u128, s128 or run it without arguments to test all.
 // The tester is multithreaded so it can test multiple cases simultaneously.
 // The tester will verify the correctness of libdivide via a set of
 // randomly chosen denominators, by comparing the result of libdivide's
@@ -21,11 +21,13 @@
 
 // This is simply a regression test for #96: that the following all compile (and don't crash).
 static void test_primitives_compile() {
+    libdivide::divider<signed char> c0(1);
     libdivide::divider<short> d0(1);
     libdivide::divider<int> d1(1);
     libdivide::divider<long> d2(1);
     libdivide::divider<long long> d3(1);
 
+    libdivide::divider<unsigned char> uc0(1);
     libdivide::divider<unsigned short> u0(1);
     libdivide::divider<unsigned int> u1(1);
     libdivide::divider<unsigned long> u2(1);
@@ -37,12 +39,16 @@ static void test_primitives_compile() {
 }
 
 enum TestType {
+    type_s8,
+    type_u8,
     type_s16,
     type_u16,
     type_s32,
     type_u32,
     type_s64,
     type_u64,
+    type_s128,
+    type_u128,
 };
 
 void wait_for_threads(std::vector<std::thread> &test_threads) {
@@ -66,7 +72,7 @@ void launch_test_thread(std::vector<std::thread> &test_threads) {
 
 int main(int argc, char *argv[]) {
     bool default_do_test = (argc <= 1);
-    std::vector<bool> do_tests(6, default_do_test);
+    std::vector<bool> do_tests(10, default_do_test);
 
     test_primitives_compile();
 
@@ -74,6 +80,12 @@ int main(int argc, char *argv[]) {
         const std::string arg(argv[i]);
         if (arg == type_tag<int16_t>::get_tag())
             do_tests[type_s16] = true;
+#if defined(LIBDIVIDE_TEST_INT8)
+        else if (arg == type_tag<int8_t>::get_tag())
+            do_tests[type_s8] = true;
+        else if (arg == type_tag<uint8_t>::get_tag())
+            do_tests[type_u8] = true;
+#endif
         else if (arg == type_tag<uint16_t>::get_tag())
             do_tests[type_u16] = true;
         else if (arg == type_tag<int32_t>::get_tag())
@@ -84,12 +96,18 @@ int main(int argc, char *argv[]) {
             do_tests[type_s64] = true;
         else if (arg == type_tag<uint64_t>::get_tag())
             do_tests[type_u64] = true;
+#if defined(LIBDIVIDE_TEST_INT128)
+        else if (arg == type_tag<__int128_t>::get_tag())
+            do_tests[type_s128] = true;
+        else if (arg == type_tag<__uint128_t>::get_tag())
+            do_tests[type_u128] = true;
+#endif
         else {
             std::cout
                 << "Usage: tester [OPTIONS]\n"
                    "\n"
                    "You can pass the tester program one or more of the following options:\n"
-                   "u16, s16, u32, s32, u64, s64 or run it without arguments to test all four.\n"
+                   "u8, s8, u16, s16, u32, s32, u64, s64, u128, s128 or run it without arguments to test all.\n"
                    "The tester is multithreaded so it can test multiple cases simultaneously.\n"
                    "The tester will verify the correctness of libdivide via a set of\n"
                    "randomly chosen denominators, by comparing the result of libdivide's\n"
@@ -129,6 +147,14 @@ int main(int argc, char *argv[]) {
     // Run tests in threads.
     std::vector<std::thread> test_threads;
 
+#if defined(LIBDIVIDE_TEST_INT8)
+    if (do_tests[type_s8]) {
+        launch_test_thread<int8_t>(test_threads);
+    }
+    if (do_tests[type_u8]) {
+        launch_test_thread<uint8_t>(test_threads);
+    }
+#endif
     if (do_tests[type_s16]) {
         launch_test_thread<int16_t>(test_threads);
     }
@@ -147,6 +173,14 @@ int main(int argc, char *argv[]) {
     if (do_tests[type_u64]) {
         launch_test_thread<uint64_t>(test_threads);
     }
+#if defined(LIBDIVIDE_TEST_INT128)
+    if (do_tests[type_s128]) {
+        launch_test_thread<__int128_t>(test_threads);
+    }
+    if (do_tests[type_u128]) {
+        launch_test_thread<__uint128_t>(test_threads);
+    }
+#endif
 
     wait_for_threads(test_threads);
 
@@ -3,6 +3,8 @@
 #include <stdint.h>
 
 #define LIB_DIVIDE_GENERATOR(GENERATOR, ...) \
+    GENERATOR(uint8_t, u8, __VA_ARGS__) \
+    GENERATOR(int8_t, s8, __VA_ARGS__) \
     GENERATOR(uint16_t, u16, __VA_ARGS__) \
     GENERATOR(int16_t, s16, __VA_ARGS__) \
     GENERATOR(uint32_t, u32, __VA_ARGS__) \
@@ -25,6 +27,23 @@ template <typename _IntT> struct type_name {};
     };
 LIB_DIVIDE_GENERATOR(DECLARE_NAME_TYPE, NULL)
 
+// 8-bit dividers have no NEON and SVE kernels, so the tester (which also
+// tests the vector API) skips them on these targets.
+#if !defined(LIBDIVIDE_NEON) && !defined(LIBDIVIDE_SVE)
+#define LIBDIVIDE_TEST_INT8
+#endif
+
+// 128-bit dividers only support the scalar API, so they are not part of
+// LIB_DIVIDE_GENERATOR. The tester needs hardware 128-bit division and
+// std::numeric_limits support (i.e. GNU extensions) as reference.
+#if defined(HAS_INT128_DIV) && !defined(__STRICT_ANSI__)
+#define LIBDIVIDE_TEST_INT128
+DECLARE_TAG_TYPE(__uint128_t, u128)
+DECLARE_TAG_TYPE(__int128_t, s128)
+DECLARE_NAME_TYPE(__uint128_t, u128)
+DECLARE_NAME_TYPE(__int128_t, s128)
+#endif
+
 template <typename _IntT> struct struct_selector {};
 #define DECLARE_STRUCT_SELECTOR(type, tag, ...) \
     template <> struct struct_selector<type> { \